@@ -0,0 +1,263 @@
+/*
+ * benchmark/AtomSpaceBenchmark.cc
+ *
+ * Micro-benchmarks for the basic AtomSpace operations.
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+using namespace opencog;
+
+// All of the threads of a threaded run share the one AtomSpace. It is
+// set up by thread zero, before the timed loop, and torn down by it,
+// after; Google Benchmark holds the other threads at a barrier, at the
+// start and at the end of the loop.
+static AtomSpacePtr _as;
+
+// The number of Atoms that are set up before the lookups, traversals
+// and reads.
+#define POOL 100000
+
+static HandleSeq _pool;
+
+static void make_pool(size_t n)
+{
+	_as = createAtomSpace();
+	_pool.clear();
+	_pool.reserve(n);
+	for (size_t i = 0; i < n; i++)
+		_pool.push_back(_as->add_node(CONCEPT_NODE, "pool-" + std::to_string(i)));
+}
+
+static void drop_pool(void)
+{
+	_pool.clear();
+	_as = nullptr;
+}
+
+// Names that no other thread uses, and that no earlier run used.
+static std::string fresh_name(const benchmark::State& state, size_t i)
+{
+	static std::atomic<size_t> _run(0);
+	static thread_local size_t run = 0;
+	if (0 == i) run = _run++;
+	return "new-" + std::to_string(run) + "-" +
+		std::to_string(state.thread_index()) + "-" + std::to_string(i);
+}
+
+// Pick Atoms from the pool, in a different order in each thread.
+static inline const Handle& pick(const benchmark::State& state, size_t i)
+{
+	return _pool[(i * 7919 + state.thread_index() * 104729) % _pool.size()];
+}
+
+// ==============================================================
+
+static void BM_AddNode(benchmark::State& state)
+{
+	if (0 == state.thread_index()) _as = createAtomSpace();
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(
+			_as->add_node(CONCEPT_NODE, fresh_name(state, i++)));
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) _as = nullptr;
+}
+BENCHMARK(BM_AddNode)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_AddLink(benchmark::State& state)
+{
+	if (0 == state.thread_index()) make_pool(POOL);
+
+	size_t i = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(
+			_as->add_link(LIST_LINK, pick(state, i), pick(state, i + 1)));
+		i++;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) drop_pool();
+}
+BENCHMARK(BM_AddLink)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_LookupHit(benchmark::State& state)
+{
+	if (0 == state.thread_index()) make_pool(POOL);
+
+	size_t i = 0;
+	for (auto _ : state)
+	{
+		const Handle& h(pick(state, i++));
+		benchmark::DoNotOptimize(
+			_as->get_node(CONCEPT_NODE, std::string(h->get_name())));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) drop_pool();
+}
+BENCHMARK(BM_LookupHit)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_LookupMiss(benchmark::State& state)
+{
+	if (0 == state.thread_index()) make_pool(POOL);
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(
+			_as->get_node(CONCEPT_NODE, "absent-" + std::to_string(i++)));
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) drop_pool();
+}
+BENCHMARK(BM_LookupMiss)->ThreadRange(1, 8)->UseRealTime();
+
+// Each hub is held by `range(0)` Links; walk the incoming set of one.
+static void BM_Incoming(benchmark::State& state)
+{
+	const size_t fanin = state.range(0);
+	if (0 == state.thread_index())
+	{
+		make_pool(fanin);
+		Handle hub(_as->add_node(CONCEPT_NODE, "hub"));
+		for (const Handle& h : _pool)
+			_as->add_link(LIST_LINK, hub, h);
+		_pool.assign({hub});
+	}
+
+	size_t total = 0;
+	for (auto _ : state)
+	{
+		for (const Handle& h : _pool[0]->getIncomingSet())
+			benchmark::DoNotOptimize(total += h->get_arity());
+	}
+
+	state.SetItemsProcessed(state.iterations() * fanin);
+	if (0 == state.thread_index()) drop_pool();
+}
+BENCHMARK(BM_Incoming)->Arg(10)->Arg(1000)->Arg(100000)
+	->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_GetValue(benchmark::State& state)
+{
+	static Handle key;
+	if (0 == state.thread_index())
+	{
+		make_pool(POOL);
+		key = _as->add_node(PREDICATE_NODE, "key");
+		ValuePtr vp(createFloatValue(std::vector<double>({1, 2, 3})));
+		for (const Handle& h : _pool) _as->set_value(h, key, vp);
+	}
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(_as->get_value(pick(state, i++), key));
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) { key = nullptr; drop_pool(); }
+}
+BENCHMARK(BM_GetValue)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_SetValue(benchmark::State& state)
+{
+	static Handle key;
+	if (0 == state.thread_index())
+	{
+		make_pool(POOL);
+		key = _as->add_node(PREDICATE_NODE, "key");
+	}
+	ValuePtr vp(createFloatValue(std::vector<double>({1, 2, 3})));
+
+	size_t i = 0;
+	for (auto _ : state)
+		_as->set_value(pick(state, i++), key, vp);
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) { key = nullptr; drop_pool(); }
+}
+BENCHMARK(BM_SetValue)->ThreadRange(1, 8)->UseRealTime();
+
+// An add and an extract, of a fresh Link over the pool.
+static void BM_Extract(benchmark::State& state)
+{
+	if (0 == state.thread_index()) make_pool(POOL);
+
+	size_t i = 0;
+	for (auto _ : state)
+	{
+		Handle h(_as->add_link(LIST_LINK, pick(state, i), pick(state, i + 3)));
+		benchmark::DoNotOptimize(_as->extract_atom(h));
+		i++;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) drop_pool();
+}
+BENCHMARK(BM_Extract)->ThreadRange(1, 8)->UseRealTime();
+
+// Create, use once, and drop a child frame.
+static void BM_ChildFrame(benchmark::State& state)
+{
+	if (0 == state.thread_index()) make_pool(POOL);
+
+	size_t i = 0;
+	for (auto _ : state)
+	{
+		AtomSpacePtr child(createAtomSpace(_as));
+		benchmark::DoNotOptimize(child->add_atom(pick(state, i++)));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	if (0 == state.thread_index()) drop_pool();
+}
+BENCHMARK(BM_ChildFrame)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_HandlesByType(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	if (0 == state.thread_index()) make_pool(n);
+
+	for (auto _ : state)
+	{
+		HandleSeq hs;
+		_as->get_handles_by_type(hs, CONCEPT_NODE);
+		benchmark::DoNotOptimize(hs.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * n);
+	if (0 == state.thread_index()) drop_pool();
+}
+BENCHMARK(BM_HandlesByType)->Arg(1000)->Arg(100000)
+	->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,308 @@
+/*
+ * benchmark/PatternBenchmark.cc
+ *
+ * Pattern matcher benchmarks, over synthetic AtomSpaces shaped like
+ * the data in the query unit tests.
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/pattern/QueryLink.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/Implicator.h>
+#include <opencog/query/Satisfier.h>
+
+using namespace opencog;
+
+typedef std::chrono::steady_clock Clock;
+
+static double secs(Clock::duration d)
+{
+	return std::chrono::duration<double>(d).count();
+}
+
+/// An Implicator that keeps track of how long it spent instantiating
+/// the rewrites, and of how many groundings it was handed.
+class TimedImplicator : public Implicator
+{
+public:
+	Clock::duration instantiate{0};
+	size_t groundings = 0;
+
+	TimedImplicator(AtomSpace* as) : Implicator(as) {}
+
+	virtual bool grounding(const GroundingMap& var_soln,
+	                       const GroundingMap& term_soln)
+	{
+		Clock::time_point start = Clock::now();
+		bool done = RewriteMixin::grounding(var_soln, term_soln);
+		instantiate += Clock::now() - start;
+		groundings++;
+		return done;
+	}
+};
+
+/// Run the query made by `make_query` against the AtomSpace. The
+/// time is split three ways: analysis (building the QueryLink, which
+/// is when the pattern is analyzed), instantiation (turning the
+/// groundings into the rewritten Atoms) and search (the rest of the
+/// time in the engine). All three, and the number of groundings, are
+/// reported as per-iteration counters.
+static void run_query(benchmark::State& state, const AtomSpacePtr& as,
+                      const std::function<Handle(void)>& make_query)
+{
+	double analysis = 0.0, search = 0.0, instantiate = 0.0;
+	double groundings = 0.0;
+	for (auto _ : state)
+	{
+		Clock::time_point t0 = Clock::now();
+		QueryLinkPtr qlp(QueryLinkCast(make_query()));
+		Clock::time_point t1 = Clock::now();
+
+		TimedImplicator impl(as.get());
+		impl.implicand = qlp->get_implicand();
+		impl.satisfy(qlp);
+		Clock::time_point t2 = Clock::now();
+
+		analysis += secs(t1 - t0);
+		instantiate += secs(impl.instantiate);
+		search += secs(t2 - t1 - impl.instantiate);
+		groundings += impl.groundings;
+	}
+
+	typedef benchmark::Counter Counter;
+	state.counters["analysis"] = Counter(analysis, Counter::kAvgIterations);
+	state.counters["search"] = Counter(search, Counter::kAvgIterations);
+	state.counters["instantiate"] =
+		Counter(instantiate, Counter::kAvgIterations);
+	state.counters["groundings"] =
+		Counter(groundings, Counter::kAvgIterations);
+}
+
+static Handle var(const char* name)
+{
+	return createNode(VARIABLE_NODE, name);
+}
+
+// ==============================================================
+// Chains, as in `deduct-einstein.scm` and `BiggerPatternUTest`:
+// `range(0)` concepts, each inheriting from three others, and a
+// query for the two-step paths.
+
+static AtomSpacePtr make_chains(size_t n)
+{
+	AtomSpacePtr as(createAtomSpace());
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<size_t> pick(0, n - 1);
+
+	HandleSeq concepts;
+	for (size_t i = 0; i < n; i++)
+		concepts.push_back(as->add_node(CONCEPT_NODE, "c-" + std::to_string(i)));
+	for (size_t i = 0; i < n; i++)
+		for (int k = 0; k < 3; k++)
+			as->add_link(INHERITANCE_LINK, concepts[i], concepts[pick(rng)]);
+	return as;
+}
+
+static void BM_Chain(benchmark::State& state)
+{
+	AtomSpacePtr as(make_chains(state.range(0)));
+	run_query(state, as, []()
+	{
+		Handle a(var("$a")), b(var("$b")), c(var("$c"));
+		return createLink(QUERY_LINK,
+			createLink(AND_LINK,
+				createLink(PRESENT_LINK,
+					createLink(INHERITANCE_LINK, a, b),
+					createLink(INHERITANCE_LINK, b, c))),
+			createLink(INHERITANCE_LINK, a, c));
+	});
+}
+BENCHMARK(BM_Chain)->RangeMultiplier(10)->Range(100, 10000)
+	->Unit(benchmark::kMillisecond);
+
+// The same data; is there a path of length three, through a concept
+// that has none? The Satisfier looks everywhere, finding nothing.
+static void BM_ChainSatisfy(benchmark::State& state)
+{
+	AtomSpacePtr as(make_chains(state.range(0)));
+	Handle orphan(as->add_node(CONCEPT_NODE, "orphan"));
+	for (auto _ : state)
+	{
+		Handle a(var("$a")), b(var("$b"));
+		PatternLinkPtr plp(PatternLinkCast(createLink(SATISFACTION_LINK,
+			createLink(PRESENT_LINK,
+				createLink(INHERITANCE_LINK, a, b),
+				createLink(INHERITANCE_LINK, b, orphan)))));
+		Satisfier sater(as.get());
+		sater.satisfy(plp);
+		benchmark::DoNotOptimize(sater._result);
+	}
+}
+BENCHMARK(BM_ChainSatisfy)->RangeMultiplier(10)->Range(100, 10000)
+	->Unit(benchmark::kMillisecond);
+
+// ==============================================================
+// Globs, as in the `glob-*.scm` tests: `range(0)` lists of one to
+// eight words, and a query for the words on either side of one word.
+
+static AtomSpacePtr make_sentences(size_t n)
+{
+	AtomSpacePtr as(createAtomSpace());
+	std::mt19937 rng(43);
+	std::uniform_int_distribution<int> len(1, 8);
+	std::uniform_int_distribution<int> word(0, 49);
+
+	Handle head(as->add_node(CONCEPT_NODE, "sentence"));
+	for (size_t i = 0; i < n; i++)
+	{
+		HandleSeq words({head});
+		int l = len(rng);
+		for (int j = 0; j < l; j++)
+			words.push_back(as->add_node(CONCEPT_NODE,
+				"w-" + std::to_string(word(rng))));
+		as->add_link(LIST_LINK, std::move(words));
+	}
+	return as;
+}
+
+static void BM_Glob(benchmark::State& state)
+{
+	AtomSpacePtr as(make_sentences(state.range(0)));
+	run_query(state, as, []()
+	{
+		Handle before(createNode(GLOB_NODE, "$before"));
+		Handle after(createNode(GLOB_NODE, "$after"));
+		return createLink(QUERY_LINK,
+			createLink(PRESENT_LINK,
+				createLink(LIST_LINK,
+					createNode(CONCEPT_NODE, "sentence"),
+					before,
+					createNode(CONCEPT_NODE, "w-7"),
+					after)),
+			createLink(LIST_LINK,
+				createLink(LIST_LINK, before),
+				createLink(LIST_LINK, after)));
+	});
+}
+BENCHMARK(BM_Glob)->RangeMultiplier(10)->Range(100, 10000)
+	->Unit(benchmark::kMillisecond);
+
+// ==============================================================
+// Unordered links, as in the `unordered-odo-*.scm` tests: `range(0)`
+// sets of three predicates, each under a list that names it, and a
+// query that has to try every permutation of each set.
+
+static AtomSpacePtr make_sets(size_t n)
+{
+	AtomSpacePtr as(createAtomSpace());
+	std::mt19937 rng(44);
+	std::uniform_int_distribution<int> pred(0, 19);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		Handle name(as->add_node(CONCEPT_NODE, "s-" + std::to_string(i)));
+		HandleSeq members({name});
+		for (int j = 0; j < 3; j++)
+			members.push_back(as->add_node(PREDICATE_NODE,
+				"p-" + std::to_string(3 * j + pred(rng) % 3)));
+		as->add_link(LIST_LINK, name, as->add_link(SET_LINK, std::move(members)));
+	}
+	return as;
+}
+
+static void BM_Unordered(benchmark::State& state)
+{
+	AtomSpacePtr as(make_sets(state.range(0)));
+	run_query(state, as, []()
+	{
+		Handle cpt(var("$cpt"));
+		Handle x(var("$x")), y(var("$y")), z(var("$z"));
+		return createLink(QUERY_LINK,
+			createLink(PRESENT_LINK,
+				createLink(LIST_LINK, cpt,
+					createLink(SET_LINK, cpt, x, y, z))),
+			createLink(ASSOCIATIVE_LINK, x, y, z));
+	});
+}
+BENCHMARK(BM_Unordered)->RangeMultiplier(10)->Range(100, 10000)
+	->Unit(benchmark::kMillisecond);
+
+// ==============================================================
+// Constraints, as in `sudoku-puzzle.scm`: `range(0)` cells, each a
+// member of a row and of a column, with a digit; find the pairs of
+// distinct cells that share a row or a column, and have the same
+// digit.
+
+static AtomSpacePtr make_grid(size_t n)
+{
+	AtomSpacePtr as(createAtomSpace());
+	std::mt19937 rng(45);
+	std::uniform_int_distribution<int> digit(1, 9);
+
+	size_t side = 1;
+	while (side * side < n) side++;
+	for (size_t i = 0; i < n; i++)
+	{
+		Handle cell(as->add_node(CONCEPT_NODE, "cell-" + std::to_string(i)));
+		as->add_link(MEMBER_LINK, cell,
+			as->add_node(CONCEPT_NODE, "row-" + std::to_string(i / side)));
+		as->add_link(MEMBER_LINK, cell,
+			as->add_node(CONCEPT_NODE, "col-" + std::to_string(i % side)));
+		as->add_link(EVALUATION_LINK,
+			as->add_node(PREDICATE_NODE, "digit"),
+			as->add_link(LIST_LINK, cell,
+				as->add_node(NUMBER_NODE, std::to_string(digit(rng)))));
+	}
+	return as;
+}
+
+static void BM_Constraint(benchmark::State& state)
+{
+	AtomSpacePtr as(make_grid(state.range(0)));
+	run_query(state, as, []()
+	{
+		Handle a(var("$a")), b(var("$b")), row(var("$row")), d(var("$d"));
+		Handle digit(createNode(PREDICATE_NODE, "digit"));
+		return createLink(QUERY_LINK,
+			createLink(AND_LINK,
+				createLink(PRESENT_LINK,
+					createLink(MEMBER_LINK, a, row),
+					createLink(MEMBER_LINK, b, row),
+					createLink(EVALUATION_LINK, digit,
+						createLink(LIST_LINK, a, d)),
+					createLink(EVALUATION_LINK, digit,
+						createLink(LIST_LINK, b, d))),
+				createLink(NOT_LINK, createLink(IDENTICAL_LINK, a, b))),
+			createLink(LIST_LINK, a, b));
+	});
+}
+BENCHMARK(BM_Constraint)->RangeMultiplier(10)->Range(100, 10000)
+	->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,378 @@
+/*
+ * benchmark/PersistBenchmark.cc
+ *
+ * Throughput and latency of the StorageNode API, for any StorageNode.
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <opencog/util/exceptions.h>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/persist/api/StorageNode.h>
+#include <opencog/persist/storage/storage_types.h>
+
+using namespace opencog;
+
+typedef std::chrono::steady_clock Clock;
+
+// The StorageNode under test; set with `--storage=` and `--uri=`.
+static Type _storage_type = FILE_STORAGE_NODE;
+static std::string _uri = "/tmp/persist-benchmark.data";
+
+static StorageNodePtr open_storage(const AtomSpacePtr& as)
+{
+	StorageNodePtr snp(StorageNodeCast(
+		as->add_node(_storage_type, std::string(_uri))));
+	if (nullptr == snp)
+		throw RuntimeException(TRACE_INFO,
+			"No factory for %s; is its library linked in?",
+			nameserver().getTypeName(_storage_type).c_str());
+	snp->open();
+	return snp;
+}
+
+// The resident set size of this process, in bytes.
+static double rss(void)
+{
+	long pages = 0, resident = 0;
+	FILE* fh = fopen("/proc/self/statm", "r");
+	if (nullptr == fh) return 0.0;
+	if (2 != fscanf(fh, "%ld %ld", &pages, &resident)) resident = 0;
+	fclose(fh);
+	return double(resident) * sysconf(_SC_PAGESIZE);
+}
+
+/// Per-operation latencies, gathered over all of the iterations, and
+/// reported as the `p50` and `p99` counters, in seconds.
+class Latencies
+{
+	std::vector<double> _samples;
+public:
+	template<typename F> void time(F&& f)
+	{
+		Clock::time_point start = Clock::now();
+		f();
+		_samples.push_back(
+			std::chrono::duration<double>(Clock::now() - start).count());
+	}
+
+	void report(benchmark::State& state)
+	{
+		if (_samples.empty()) return;
+		std::sort(_samples.begin(), _samples.end());
+		size_t n = _samples.size();
+		state.counters["p50"] = _samples[n / 2];
+		state.counters["p99"] = _samples[std::min(n - 1, (99 * n) / 100)];
+	}
+};
+
+// ==============================================================
+// The data is shaped like that of `persist/sql/README-perf.md`:
+// `(Evaluation (Predicate "pair") (List (Concept a) (Concept b)))`,
+// with a count on each pair. That is five Atoms per pair, less the
+// sharing of the words, of which there are a thousand.
+
+#define NWORDS 1000
+
+static Handle _key;
+
+static Handle word(int i)
+{
+	return createNode(CONCEPT_NODE, "w-" + std::to_string(i));
+}
+
+static HandleSeq make_pairs(const AtomSpacePtr& as, size_t n)
+{
+	std::mt19937 rng(46);
+	std::uniform_int_distribution<int> pick(0, NWORDS - 1);
+
+	_key = as->add_node(PREDICATE_NODE, "count");
+	Handle pred(as->add_node(PREDICATE_NODE, "pair"));
+	HandleSeq pairs;
+	pairs.reserve(n);
+	while (pairs.size() < n)
+	{
+		Handle pr(as->add_link(EVALUATION_LINK, pred,
+			as->add_link(LIST_LINK,
+				as->add_atom(word(pick(rng))),
+				as->add_atom(word(pick(rng))))));
+		as->set_value(pr, _key, createFloatValue(
+			std::vector<double>({1.0, 0.0, double(pairs.size())})));
+		pairs.push_back(pr);
+	}
+	return pairs;
+}
+
+// Write the pairs out to a freshly erased store.
+static void fill_storage(size_t n)
+{
+	AtomSpacePtr as(createAtomSpace());
+	make_pairs(as, n);
+	StorageNodePtr snp(open_storage(as));
+	snp->erase();
+	snp->store_atomspace();
+	snp->barrier();
+	snp->close();
+}
+
+// ==============================================================
+
+// One store_atom() per pair; the timing includes the final barrier,
+// the latencies do not.
+static void BM_StoreAtom(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	AtomSpacePtr as(createAtomSpace());
+	HandleSeq pairs(make_pairs(as, n));
+	StorageNodePtr snp(open_storage(as));
+
+	Latencies lat;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		snp->erase();
+		state.ResumeTiming();
+
+		for (const Handle& h : pairs)
+			lat.time([&] { snp->store_atom(h); });
+		snp->barrier();
+	}
+
+	snp->close();
+	state.SetItemsProcessed(state.iterations() * n);
+	lat.report(state);
+}
+BENCHMARK(BM_StoreAtom)->RangeMultiplier(10)->Range(1000, 100000)
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_StoreAtomSpace(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	AtomSpacePtr as(createAtomSpace());
+	make_pairs(as, n);
+	StorageNodePtr snp(open_storage(as));
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		snp->erase();
+		state.ResumeTiming();
+
+		snp->store_atomspace();
+		snp->barrier();
+	}
+
+	snp->close();
+	state.SetItemsProcessed(state.iterations() * as->get_size());
+}
+BENCHMARK(BM_StoreAtomSpace)->RangeMultiplier(10)->Range(1000, 100000)
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Load everything into an empty AtomSpace. The growth of the resident
+// set, divided by the number of Atoms loaded, is reported as the
+// `rss_per_atom` counter, in bytes.
+static void BM_LoadAtomSpace(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	fill_storage(n);
+
+	double grown = 0.0;
+	size_t loaded = 0;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		AtomSpacePtr as(createAtomSpace());
+		StorageNodePtr snp(open_storage(as));
+		size_t before_size = as->get_size();
+		double before = rss();
+		state.ResumeTiming();
+
+		snp->load_atomspace();
+		snp->barrier();
+
+		state.PauseTiming();
+		grown += rss() - before;
+		loaded += as->get_size() - before_size;
+		snp->close();
+		snp = nullptr;
+		as = nullptr;
+		state.ResumeTiming();
+	}
+
+	state.SetItemsProcessed(loaded);
+	if (0 < loaded) state.counters["rss_per_atom"] = grown / loaded;
+}
+BENCHMARK(BM_LoadAtomSpace)->RangeMultiplier(10)->Range(1000, 100000)
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The incoming set of every word, into an empty AtomSpace.
+static void BM_FetchIncoming(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	fill_storage(n);
+
+	Latencies lat;
+	size_t fetched = 0;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		AtomSpacePtr as(createAtomSpace());
+		StorageNodePtr snp(open_storage(as));
+		state.ResumeTiming();
+
+		for (int w = 0; w < NWORDS; w++)
+			lat.time([&] { snp->fetch_incoming_set(word(w)); });
+		snp->barrier();
+
+		state.PauseTiming();
+		fetched += NWORDS;
+		snp->close();
+		state.ResumeTiming();
+	}
+
+	state.SetItemsProcessed(fetched);
+	lat.report(state);
+}
+BENCHMARK(BM_FetchIncoming)->RangeMultiplier(10)->Range(1000, 100000)
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Change the count on every pair, and store just that Value.
+static void BM_StoreValue(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	AtomSpacePtr as(createAtomSpace());
+	HandleSeq pairs(make_pairs(as, n));
+	StorageNodePtr snp(open_storage(as));
+	snp->erase();
+	snp->store_atomspace();
+	snp->barrier();
+
+	Latencies lat;
+	double count = 0.0;
+	for (auto _ : state)
+	{
+		count += 1.0;
+		for (const Handle& h : pairs)
+		{
+			as->set_value(h, _key, createFloatValue(
+				std::vector<double>({1.0, 0.0, count})));
+			lat.time([&] { snp->store_value(h, _key); });
+		}
+		snp->barrier();
+	}
+
+	snp->close();
+	state.SetItemsProcessed(state.iterations() * n);
+	lat.report(state);
+}
+BENCHMARK(BM_StoreValue)->RangeMultiplier(10)->Range(1000, 100000)
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Ask the store for the left-hand words paired with a given word; the
+// backend runs the query (or, if it cannot, loads and runs it here).
+// There are `NWORDS / 10` queries per run, each one fresh.
+static void BM_FetchQuery(benchmark::State& state)
+{
+	const size_t n = state.range(0);
+	fill_storage(n);
+
+	Latencies lat;
+	size_t queries = 0;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		AtomSpacePtr as(createAtomSpace());
+		StorageNodePtr snp(open_storage(as));
+		Handle pred(as->add_node(PREDICATE_NODE, "pair"));
+		Handle key(as->add_node(PREDICATE_NODE, "query results"));
+		Handle x(as->add_node(VARIABLE_NODE, "$x"));
+		state.ResumeTiming();
+
+		for (int w = 0; w < NWORDS; w += 10)
+		{
+			Handle query(as->add_link(MEET_LINK,
+				as->add_link(PRESENT_LINK,
+					as->add_link(EVALUATION_LINK, pred,
+						as->add_link(LIST_LINK, x, as->add_atom(word(w)))))));
+			lat.time([&] {
+				snp->fetch_query(query, key, Handle::UNDEFINED, true);
+			});
+			queries++;
+		}
+		snp->barrier();
+
+		state.PauseTiming();
+		snp->close();
+		state.ResumeTiming();
+	}
+
+	state.SetItemsProcessed(queries);
+	lat.report(state);
+}
+BENCHMARK(BM_FetchQuery)->RangeMultiplier(10)->Range(1000, 100000)
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// ==============================================================
+
+int main(int argc, char** argv)
+{
+	// Pull out our own flags; the rest are for Google Benchmark.
+	int j = 1;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		if (0 == arg.compare(0, 10, "--storage="))
+			_storage_type = nameserver().getType(arg.substr(10));
+		else if (0 == arg.compare(0, 6, "--uri="))
+			_uri = arg.substr(6);
+		else
+			argv[j++] = argv[i];
+	}
+	argc = j;
+
+	if (not nameserver().isA(_storage_type, STORAGE_NODE))
+	{
+		fprintf(stderr, "Expecting --storage=<type of StorageNode>, "
+			"such as --storage=FileStorageNode\n");
+		return 1;
+	}
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+	benchmark::AddCustomContext("storage",
+		nameserver().getTypeName(_storage_type) + " " + _uri);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
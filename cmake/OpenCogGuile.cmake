@@ -31,6 +31,28 @@ ADD_DEFINITIONS(-DGUILE_SITE_DIR="${GUILE_SITE_DIR}")
 
 SET(GUILE_BIN_DIR "${CMAKE_BINARY_DIR}/opencog/scm")
 
+# Ahead-of-time compilation. Unless turned off with
+# `cmake -DGUILE_PRECOMPILE=OFF`, the installed modules are compiled
+# with `guild`, and the `.go` files are placed in guile's site ccache,
+# where guile looks for them before it considers compiling anything
+# itself. Without this, every user (and every fresh service container)
+# pays for compiling the modules, the atom types included, on first
+# use. When GUILE_SITE_DIR is overridden, GUILE_SITE_CCACHE_DIR should
+# be too, and it must be on the GUILE_LOAD_COMPILED_PATH.
+OPTION(GUILE_PRECOMPILE "Compile guile modules when installing them" ON)
+IF (HAVE_GUILE AND GUILE_PRECOMPILE)
+    FIND_PROGRAM(GUILD_EXECUTABLE NAMES guild guild-3.0 guild3.0 guild-2.2)
+    IF (NOT DEFINED GUILE_SITE_CCACHE_DIR)
+        EXECUTE_PROCESS(COMMAND guile -c "(display (%site-ccache-dir))"
+            OUTPUT_VARIABLE GUILE_SITE_CCACHE_DIR
+            OUTPUT_STRIP_TRAILING_WHITESPACE)
+    ENDIF()
+    IF (NOT GUILD_EXECUTABLE OR NOT GUILE_SITE_CCACHE_DIR)
+        MESSAGE(STATUS "guild not found; guile modules will not be precompiled")
+        SET(GUILE_PRECOMPILE OFF)
+    ENDIF()
+ENDIF()
+
 # -------------------------------------------------------------------
 #
 # This configures the install and binary paths for each file.
@@ -203,6 +225,13 @@ endif()
 
             INSTALL (FILES ${FILE_PATH}
                      DESTINATION ${FILE_INSTALL_PATH})
+
+            # Remember it for COMPILE_GUILE_MODULES(), below.
+            IF (GUILE_PRECOMPILE)
+                GET_FILENAME_COMPONENT(FILE_NAME ${FILE_PATH} NAME)
+                SET_PROPERTY(GLOBAL APPEND PROPERTY GUILE_INSTALLED_FILES
+                    "${FILE_INSTALL_PATH}/${FILE_NAME}")
+            ENDIF()
         ENDFOREACH()
 
     ELSE()
@@ -218,6 +247,44 @@ endif()
   ENDIF()
 ENDFUNCTION(ADD_GUILE_MODULE)
 
+# ---------------------------------------------------------------------
+# Compile all of the modules installed with ADD_GUILE_MODULE, together
+# with any other installed scheme files given as arguments. This has to
+# be called after everything they load is installed: the modules are
+# loaded, extensions and all, while their users are compiled. Files
+# that are only included into some module, and do not define a module
+# of their own, are skipped; they are compiled into the module that
+# includes them. A module that fails to compile is reported, and left
+# for guile to compile on first use, as it would be without this.
+FUNCTION(COMPILE_GUILE_MODULES)
+    IF (NOT GUILE_PRECOMPILE)
+        RETURN()
+    ENDIF()
+    GET_PROPERTY(SCM_FILES GLOBAL PROPERTY GUILE_INSTALLED_FILES)
+    LIST(APPEND SCM_FILES ${ARGN})
+    FOREACH(SCM_FILE ${SCM_FILES})
+        STRING(REGEX REPLACE "^${GUILE_SITE_DIR}" "${GUILE_SITE_CCACHE_DIR}"
+            GO_FILE ${SCM_FILE})
+        STRING(REGEX REPLACE "[.]scm$" ".go" GO_FILE ${GO_FILE})
+        INSTALL(CODE "
+            FILE(STRINGS \"\$ENV{DESTDIR}${SCM_FILE}\" IS_MODULE
+                REGEX \"^[(]define-module\")
+            IF (IS_MODULE)
+                MESSAGE(\"-- Compiling: \$ENV{DESTDIR}${GO_FILE}\")
+                EXECUTE_PROCESS(COMMAND ${GUILD_EXECUTABLE} compile
+                        -L \"\$ENV{DESTDIR}${GUILE_SITE_DIR}\"
+                        -o \"\$ENV{DESTDIR}${GO_FILE}\"
+                        \"\$ENV{DESTDIR}${SCM_FILE}\"
+                    RESULT_VARIABLE RC
+                    OUTPUT_QUIET ERROR_VARIABLE ERR)
+                IF (NOT RC EQUAL 0)
+                    MESSAGE(WARNING \"Could not compile ${SCM_FILE}: \${ERR}\")
+                ENDIF()
+            ENDIF()
+        ")
+    ENDFOREACH()
+ENDFUNCTION(COMPILE_GUILE_MODULES)
+
 FUNCTION(ADD_GUILE_TEST TEST_NAME FILE_NAME)
     # srfi-64 is installed in guile 2.2 and above, thus check for it.
     IF(HAVE_GUILE AND (GUILE_VERSION VERSION_GREATER 2.2))
@@ -29,6 +29,7 @@
 
 #include "NameServer.h"
 
+#include <algorithm>
 #include <exception>
 
 #include <opencog/atoms/atom_types/types.h>
@@ -49,6 +50,7 @@ NameServer::NameServer(void)
 	nValues = 1;
 	_maxDepth = 0;
 	_tmod = 0;
+	_mapSize = 0;
 }
 
 /**
@@ -89,11 +91,33 @@ bool NameServer::beginTypeDecls(const char * mod_name)
 
 void NameServer::endTypeDecls(void)
 {
+	std::vector<Type> added;
+	added.swap(_pending);
+
 	// Valid types are odd-numbered.
 	_tmod++;
 	_module_mutex.unlock();
 
 	classserver().update_factories();
+
+	for (Type t : added)
+		_addTypeSignal.emit(t);
+}
+
+/// Make room for types numbered below `n`. Called with the type_mutex
+/// held.
+void NameServer::reserveTypes(size_t n)
+{
+    _code2NameMap.resize(n);
+    _mod.resize(n);
+    if (n <= _mapSize) return;
+
+    size_t sz = std::max(n, 2 * _mapSize);
+    inheritanceMap.resize(sz);
+    recursiveMap.resize(sz);
+    for (auto& bv: inheritanceMap) bv.resize(sz, false);
+    for (auto& bv: recursiveMap) bv.resize(sz, false);
+    _mapSize = sz;
 }
 
 Type NameServer::declType(const Type parent, const std::string& name)
@@ -149,18 +173,12 @@ Type NameServer::declType(const Type parent, const std::string& name)
         type = nTypes++;
     }
 
-    // Resize inheritanceMap container.
-    inheritanceMap.resize(nTypes);
-    recursiveMap.resize(nTypes);
-    _code2NameMap.resize(nTypes);
-    _mod.resize(nTypes);
-
-    for (auto& bv: inheritanceMap) bv.resize(nTypes, false);
-    for (auto& bv: recursiveMap) bv.resize(nTypes, false);
+    reserveTypes(nTypes);
 
     inheritanceMap[type][type]   = true;
     inheritanceMap[parent][type] = true;
     recursiveMap[type][type]     = true;
+    setSuper(type, type);
     name2CodeMap[name]           = type;
     _code2NameMap[type]          = &(name2CodeMap.find(name)->first);
     _mod[type]                   = _tmod;
@@ -180,11 +198,8 @@ Type NameServer::declType(const Type parent, const std::string& name)
         name2CodeMap[short_name] = type;
     }
 
-    // unlock mutex before sending signal which could call
-    l.unlock();
-
-    // Emit add type signal.
-    _addTypeSignal.emit(type);
+    // The add-type signal is sent by endTypeDecls().
+    _pending.push_back(type);
 
     return type;
 }
@@ -201,6 +216,7 @@ void NameServer::setParentRecursively(Type parent, Type type, Type& maxd)
 
     bool incr = false;
     recursiveMap[parent][type] = true;
+    setSuper(parent, type);
     for (Type i = 0; i < parent; ++i) {
         if (recursiveMap[i][parent]) {
             incr = true;
@@ -215,6 +231,20 @@ TypeSignal& NameServer::typeAddedSignal()
     return _addTypeSignal;
 }
 
+TypeMask NameServer::getTypeMask(const TypeSet& ts)
+{
+    TypeMask m;
+    for (Type t : ts)
+    {
+        if (NAMESERVER_MAX_FLAT_TYPES <= t)
+            throw InvalidParamException(TRACE_INFO,
+                "Type %d does not fit in a TypeMask!\n"
+                "Increase NAMESERVER_MAX_FLAT_TYPES and recompile!\n", t);
+        m[t] = true;
+    }
+    return m;
+}
+
 bool NameServer::isAncestor(Type super, Type sub) const
 {
 	std::lock_guard<std::mutex> l(type_mutex);
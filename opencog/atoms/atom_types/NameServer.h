@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_CLASS_NAMESERVER_H
 #define _OPENCOG_CLASS_NAMESERVER_H
 
+#include <bitset>
 #include <mutex>
 #include <set>
 #include <unordered_map>
@@ -43,6 +44,15 @@ namespace opencog
 
 typedef SigSlot<Type> TypeSignal;
 
+// Number of types covered by the flat isA() bit-matrix. Types beyond
+// this are still handled, but take the slower path.
+#ifndef NAMESERVER_MAX_FLAT_TYPES
+#define NAMESERVER_MAX_FLAT_TYPES 1024
+#endif
+
+//! A set of types, as a bitmask indexed by type number.
+typedef std::bitset<NAMESERVER_MAX_FLAT_TYPES> TypeMask;
+
 /**
  * This class keeps track of the complete protoatom (value and atom)
  * class hierarchy.
@@ -76,13 +86,33 @@ private:
     Type nValues;
     Type _maxDepth;
 
+    // Both maps are square, and are grown geometrically, so that
+    // declaring a type does not have to grow every row.
     std::vector< std::vector<bool> > inheritanceMap;
     std::vector< std::vector<bool> > recursiveMap;
+    size_t _mapSize;
+    void reserveTypes(size_t);
+
+    // The same as the recursiveMap, transposed, and in one flat block
+    // of fixed size: row `sub` has a bit set for each ancestor of
+    // `sub`. The block is never reallocated, so readers need no lock,
+    // and each isA() is a single indexed bit-test.
+    alignas(64) TypeMask _supers[NAMESERVER_MAX_FLAT_TYPES];
+    void setSuper(Type super, Type sub)
+    {
+        if (sub < NAMESERVER_MAX_FLAT_TYPES and
+            super < NAMESERVER_MAX_FLAT_TYPES)
+            _supers[sub][super] = true;
+    }
     std::unordered_map<std::string, Type> name2CodeMap;
     std::vector<const std::string*> _code2NameMap;
     std::vector<int> _mod;
     TypeSignal _addTypeSignal;
 
+    // The types declared by the module being loaded; the signal is
+    // sent for them once it is done, and the hierarchy is complete.
+    std::vector<Type> _pending;
+
     void setParentRecursively(Type parent, Type type, Type& maxd);
 
 public:
@@ -243,9 +273,33 @@ public:
          */
         // std::lock_guard<std::mutex> l(type_mutex);
         if ((sub >= nTypes) || (super >= nTypes)) return false;
+        // Both must be inside the bit-matrix; else, use the map.
+        if (sub < NAMESERVER_MAX_FLAT_TYPES and
+            super < NAMESERVER_MAX_FLAT_TYPES)
+            return _supers[sub][super];
         return recursiveMap[super][sub];
     }
 
+    /**
+     * Returns true if `sub` is a subtype of any of the types in
+     * `supers`; that is, if isA(sub, t) for some t in the mask.
+     * This is one pass over one row of the bit-matrix.
+     */
+    bool isA(Type sub, const TypeMask& supers) const
+    {
+        if (sub >= nTypes) return false;
+        if (sub < NAMESERVER_MAX_FLAT_TYPES)
+            return (_supers[sub] & supers).any();
+
+        for (Type t = 0; t < NAMESERVER_MAX_FLAT_TYPES; t++)
+            if (supers[t] and recursiveMap[t][sub]) return true;
+        return false;
+    }
+
+    /// Build the mask for a set of types, for use with the above.
+    /// Throws if a type is too large to fit in a mask.
+    static TypeMask getTypeMask(const TypeSet&);
+
     bool isAncestor(Type super, Type sub) const;
 
     /**
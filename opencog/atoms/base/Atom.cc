@@ -33,10 +33,14 @@
 
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/CompactHandle.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/truthvalue/CountTruthValue.h>
+#include <opencog/atoms/value/ValueReads.h>
 
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspace/Snapshot.h>
 
 //#define DPRINTF printf
 #define DPRINTF(...)
@@ -45,6 +49,8 @@
 
 namespace opencog {
 
+AtomMutex Atom::_locks[ATOM_NUM_LOCK_STRIPES];
+
 Atom::~Atom()
 {
     _atom_space = nullptr;
@@ -60,14 +66,21 @@ Atom::~Atom()
          "Atom deletion failure; incoming set not empty for %s h=%x",
          nameserver().getTypeName(_type).c_str(), get_hash());
 #endif
-    drop_incoming_set();
+    // No one else can be holding this atom, so there is no need to
+    // lock. Locking here would also risk deadlock, as the lock stripe
+    // may already be held by whoever dropped the last reference.
+    _incoming_set = nullptr;
+
+    // Stale CompactHandles must not resolve to whatever is built
+    // at this address next.
+    if (_has_slot) AtomSlots::release(this);
 }
 
 // ==============================================================
 // Whole lotta truthiness going on here.  Does it really need to be
 // this complicated!?
 
-static const Handle& truth_key(void)
+const Handle& Atom::truth_key(void)
 {
 	static Handle tk(createNode(PREDICATE_NODE, "*-TruthValueKey-*"));
 	return tk;
@@ -91,10 +104,8 @@ void Atom::setTruthValue(const TruthValuePtr& newTV)
     // http://www.boost.org/doc/libs/1_53_0/libs/smart_ptr/shared_ptr.htm#ThreadSafety
     setValue (truth_key(), ValueCast(newTV));
 
-    if (_atom_space != nullptr) {
-        TVCHSigl& tvch = _atom_space->TVChangedSignal();
-        tvch.emit(get_handle(), oldTV, newTV);
-    }
+    if (_atom_space != nullptr)
+        _atom_space->emit_tv_changed(get_handle(), oldTV, newTV);
 }
 
 TruthValuePtr Atom::getTruthValue() const
@@ -112,24 +123,96 @@ void Atom::setValue(const Handle& key, const ValuePtr& value)
 	// This is rather irritating, but we fake it for the
 	// PredicateNode "*-TruthValueKey-*" because if we don't
 	// then load-from-file and load-from-network breaks.
-	if (key != truth_key() and *key == *truth_key())
+	if (key == truth_key() or *key == *truth_key())
 	{
-		KVP_UNIQUE_LOCK;
-		if (nullptr != value)
-			_values[truth_key()] = value;
-		else
-			_values.erase(truth_key());
+		{
+			KVP_UNIQUE_LOCK;
+			if (Snapshot::any_open())
+				Snapshot::changing(get_handle(), key, _truth_value);
+			_truth_value = value;
+		}
+		ValueReads::changed(this, truth_key()->get_hash());
 	}
 	else
+	{
+		{
+			KVP_UNIQUE_LOCK;
+			if (Snapshot::any_open())
+				Snapshot::changing(get_handle(), key, _values.get(key));
+			if (nullptr != value)
+				_values.set(key, value);
+			else
+				_values.erase(key);
+		}
+		ValueReads::changed(this, key->get_hash());
+	}
+
+	if (_atom_space != nullptr)
+		_atom_space->note_value_change(get_handle(), key);
+}
+
+ValuePtr Atom::incrementCount(const Handle& key, size_t ref, double delta)
+{
+	if (key == truth_key() or *key == *truth_key())
+		throw RuntimeException(TRACE_INFO,
+			"Use incrementCountTV() for the TruthValue");
+
+	ValuePtr vp;
 	{
 		KVP_UNIQUE_LOCK;
-		if (nullptr != value)
-			_values[key] = value;
-		else
-			_values.erase(key);
+		ValuePtr old(_values.get(key));
+		if (Snapshot::any_open())
+			Snapshot::changing(get_handle(), key, old);
+		vp = increment(old, ref, delta);
+		_values.set(key, vp);
 	}
+	ValueReads::changed(this, key->get_hash());
+
+	if (_atom_space != nullptr)
+		_atom_space->note_value_change(get_handle(), key);
+	return vp;
 }
 
+TruthValuePtr Atom::incrementCountTV(double delta)
+{
+	TruthValuePtr oldTV;
+	TruthValuePtr newTV;
+	{
+		KVP_UNIQUE_LOCK;
+		if (Snapshot::any_open())
+			Snapshot::changing(get_handle(), truth_key(), _truth_value);
+		oldTV = _truth_value ?
+			TruthValueCast(_truth_value) : TruthValue::DEFAULT_TV();
+		newTV = CountTruthValue::increment(oldTV, delta);
+		_truth_value = ValueCast(newTV);
+	}
+	ValueReads::changed(this, truth_key()->get_hash());
+
+	if (_atom_space != nullptr)
+	{
+		_atom_space->note_value_change(get_handle(), truth_key());
+		_atom_space->emit_tv_changed(get_handle(), oldTV, newTV);
+	}
+	return newTV;
+}
+
+uint8_t Atom::type_features(Type t)
+{
+	NameServer& ns(nameserver());
+	uint8_t f = 0;
+	if (ns.isA(t, VARIABLE_NODE)) f |= FEATURE_VARIABLE;
+	if (ns.isA(t, GLOB_NODE)) f |= FEATURE_GLOB;
+	if (ns.isA(t, QUOTE_LINK) or ns.isA(t, UNQUOTE_LINK) or
+	    ns.isA(t, LOCAL_QUOTE_LINK)) f |= FEATURE_QUOTE;
+	if (ns.isA(t, SCOPE_LINK)) f |= FEATURE_SCOPE;
+	if (ns.isA(t, TYPE_NODE) or ns.isA(t, TYPE_CHOICE) or
+	    ns.isA(t, TYPE_OUTPUT_LINK)) f |= FEATURE_TYPE;
+	if (ns.isA(t, EVALUATABLE_LINK)) f |= FEATURE_EVALUATABLE;
+	return f;
+}
+
+// ==============================================================
+
 ValuePtr Atom::getValue(const Handle& key) const
 {
     // OK. The atomic thread-safety of shared-pointers is subtle. See
@@ -143,32 +226,35 @@ ValuePtr Atom::getValue(const Handle& key) const
     // the multi-threaded async atom store in the SQL peristance backend.
     // Furthermore, we must make a copy while holding the lock! Got that?
 
-    ValuePtr pap;
-
     // This is rather irritating, but we fake it for the
     // PredicateNode "*-TruthValueKey-*" because if we don't
     // then load-from-file and load-from-network breaks.
-    if ((key != truth_key()) and (*key == *truth_key()))
+    //
+    // Formulas that want to know what they read get told about it;
+    // see ValueReads.
+    ValuePtr vp;
+    if (key == truth_key() or *key == *truth_key())
     {
+        ValueReads::reading(this, truth_key()->get_hash());
         KVP_SHARED_LOCK;
-        auto pr = _values.find(truth_key());
-        if (_values.end() != pr) pap = pr->second;
+        vp = _truth_value;
     }
     else
     {
+        ValueReads::reading(this, key->get_hash());
         KVP_SHARED_LOCK;
-        auto pr = _values.find(key);
-        if (_values.end() != pr) pap = pr->second;
+        vp = _values.get(key);
     }
-    return pap;
+    ValueReads::read(vp);
+    return vp;
 }
 
 HandleSet Atom::getKeys() const
 {
     HandleSet keyset;
     KVP_SHARED_LOCK;
-    for (const auto& pr : _values)
-        keyset.insert(pr.first);
+    if (_truth_value) keyset.insert(truth_key());
+    _values.foreach_key([&](const Handle& k) { keyset.insert(k); });
 
     return keyset;
 }
@@ -248,9 +334,17 @@ bool Atom::isAbsent() const
 /// idea.)
 bool Atom::setAbsent(void)
 {
-    KVP_SHARED_LOCK;
-    _values.clear();
-    return _absent.exchange(true);
+    HandleSet keys(getKeys());
+    bool was_absent;
+    {
+        KVP_UNIQUE_LOCK;
+        _truth_value = nullptr;
+        _values.clear();
+        was_absent = _absent.exchange(true);
+    }
+    for (const Handle& k : keys)
+        ValueReads::changed(this, k->get_hash());
+    return was_absent;
 }
 
 bool Atom::setPresent(void)
@@ -283,6 +377,35 @@ void Atom::setAtomSpace(AtomSpace *tb)
 	#define GET_PTR(a) a
 #endif // USE_BARE_BACKPOINTER
 
+/// True if the back-pointer `w` points at `a`.
+static inline bool points_to(const WinkPtr& w, const Handle& a)
+{
+#if USE_BARE_BACKPOINTER
+	return w == a.const_atom_ptr();
+#else // USE_BARE_BACKPOINTER
+	return not w.owner_before(a) and not a.owner_before(w);
+#endif // USE_BARE_BACKPOINTER
+}
+
+// Stack of recycled buffers, one per nesting level. These are held
+// by pointer, so that growing the stack does not move the buffers
+// that are in use by the outer levels.
+static thread_local std::vector<std::unique_ptr<IncomingSet>> _scratch_pool;
+static thread_local size_t _scratch_depth = 0;
+
+IncomingScratch::IncomingScratch()
+{
+    if (_scratch_pool.size() <= _scratch_depth)
+        _scratch_pool.emplace_back(new IncomingSet());
+    _buf = _scratch_pool[_scratch_depth++].get();
+}
+
+IncomingScratch::~IncomingScratch()
+{
+    _buf->clear();
+    _scratch_depth--;
+}
+
 /// Start tracking the incoming set for this atom.
 /// An atom can't know what it's incoming set is, until this method
 /// is called.  If this atom is added to any links before this call
@@ -318,6 +441,10 @@ void Atom::insert_atom(const Handle& a)
     INCOMING_UNIQUE_LOCK;
 
     Type at = a->get_type();
+#if USE_FLAT_INCOMING_SET
+    if (_incoming_set->_iset.insert(at, GET_PTR(a)))
+        _incoming_set->_size++;
+#else
     auto bucket = _incoming_set->_iset.find(at);
     if (bucket == _incoming_set->_iset.end())
     {
@@ -325,7 +452,9 @@ void Atom::insert_atom(const Handle& a)
                    std::make_pair(at, WincomingSet()));
         bucket = pr.first;
     }
-    bucket->second.insert(GET_PTR(a));
+    if (bucket->second.insert(GET_PTR(a)).second)
+        _incoming_set->_size++;
+#endif
 
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_addAtomSignal(shared_from_this(), a);
@@ -342,10 +471,14 @@ void Atom::remove_atom(const Handle& a)
 #endif /* INCOMING_SET_SIGNALS */
     Type at = a->get_type();
 
+#if USE_FLAT_INCOMING_SET
+    size_t erc = _incoming_set->_iset.erase(at, GET_PTR(a));
+#else
     const auto bucket = _incoming_set->_iset.find(at);
 
     OC_ASSERT(bucket != _incoming_set->_iset.end(), "No bucket!");
     size_t erc = bucket->second.erase(GET_PTR(a));
+#endif
 
     // std::set is a "true set", in that it either contains something,
     // or it does not.  Therefore, the erase count is either 1 (the
@@ -353,24 +486,36 @@ void Atom::remove_atom(const Handle& a)
     // because it was erased earlier, e.g. it had more than once in the
     // outgoing set. All other erase counts are ... unexpected.
     OC_ASSERT(2 > erc, "Unexpected erase count!");
+    _incoming_set->_size -= erc;
+
+    // The state goes with it.
+    if (STATE_LINK == at and points_to(_incoming_set->_state, a))
+        _incoming_set->_state = WinkPtr();
 }
 
 /// Remove old, and add new, atomically, so that every user
 /// will see either one or the other, but not both/neither in
-/// the incoming set. This is used to manage the StateLink.
+/// the incoming set. This is used to manage the StateLink; the
+/// new one also becomes the state, in the same step.
 void Atom::swap_atom(const Handle& old, const Handle& neu)
 {
     if (nullptr == _incoming_set) return;
     INCOMING_UNIQUE_LOCK;
+    _incoming_set->_state = GET_PTR(neu);
 
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_removeAtomSignal(shared_from_this(), old);
 #endif /* INCOMING_SET_SIGNALS */
     Type ot = old->get_type();
+    Type nt = neu->get_type();
+#if USE_FLAT_INCOMING_SET
+    _incoming_set->_size -= _incoming_set->_iset.erase(ot, GET_PTR(old));
+    if (_incoming_set->_iset.insert(nt, GET_PTR(neu)))
+        _incoming_set->_size++;
+#else
     auto bucket = _incoming_set->_iset.find(ot);
-    bucket->second.erase(GET_PTR(old));
+    _incoming_set->_size -= bucket->second.erase(GET_PTR(old));
 
-    Type nt = neu->get_type();
     bucket = _incoming_set->_iset.find(nt);
     if (bucket == _incoming_set->_iset.end())
     {
@@ -378,13 +523,37 @@ void Atom::swap_atom(const Handle& old, const Handle& neu)
                    std::make_pair(nt, WincomingSet()));
         bucket = pr.first;
     }
-    bucket->second.insert(GET_PTR(neu));
+    if (bucket->second.insert(GET_PTR(neu)).second)
+        _incoming_set->_size++;
+#endif
 
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_addAtomSignal(shared_from_this(), neu);
 #endif /* INCOMING_SET_SIGNALS */
 }
 
+/// Record the StateLink that holds the current state of this atom.
+void Atom::set_state_link(const Handle& sl)
+{
+    if (nullptr == _incoming_set) return;
+    INCOMING_UNIQUE_LOCK;
+    _incoming_set->_state = GET_PTR(sl);
+}
+
+/// The StateLink last recorded with set_state_link() or swap_atom(),
+/// if it has not been removed since.
+Handle Atom::get_state_link(void) const
+{
+    if (nullptr == _incoming_set) return Handle::UNDEFINED;
+    INCOMING_SHARED_LOCK;
+#if USE_BARE_BACKPOINTER
+    if (nullptr == _incoming_set->_state) return Handle::UNDEFINED;
+    return _incoming_set->_state->get_handle();
+#else // USE_BARE_BACKPOINTER
+    return Handle(_incoming_set->_state.lock());
+#endif // USE_BARE_BACKPOINTER
+}
+
 void Atom::install() {}
 void Atom::remove() {}
 
@@ -438,11 +607,8 @@ size_t Atom::getIncomingSetSize(const AtomSpace* as) const
         return cnt;
     }
 
-    size_t cnt = 0;
     INCOMING_SHARED_LOCK;
-    for (const auto& pr : _incoming_set->_iset)
-        cnt += pr.second.size();
-    return cnt;
+    return _incoming_set->_size;
 }
 
 // We return a copy here, and not a reference, because the set itself
@@ -504,14 +670,22 @@ IncomingSet Atom::getIncomingSet(const AtomSpace* as) const
 
 IncomingSet Atom::getIncomingSetByType(Type type, const AtomSpace* as) const
 {
-    static IncomingSet empty_set;
-    if (nullptr == _incoming_set) return empty_set;
+    IncomingSet result;
+    copyIncomingSetByType(result, type, as);
+    return result;
+}
+
+void Atom::copyIncomingSetByType(IncomingSet& result, Type type,
+                                 const AtomSpace* as) const
+{
+    result.clear();
+    if (nullptr == _incoming_set) return;
 
     // Lock to prevent updates of the set of atoms.
     INCOMING_SHARED_LOCK;
 
     const auto bucket = _incoming_set->_iset.find(type);
-    if (bucket == _incoming_set->_iset.cend()) return empty_set;
+    if (bucket == _incoming_set->_iset.cend()) return;
 
     if (as) {
         // If the _copy_on_write flag is set, we need to
@@ -519,35 +693,28 @@ IncomingSet Atom::getIncomingSetByType(Type type, const AtomSpace* as) const
         if (as->get_copy_on_write())
         {
             HandleSet hs;
-            for (const auto& bucket : _incoming_set->_iset)
+            for (const WinkPtr& w : bucket->second)
             {
-                for (const WinkPtr& w : bucket.second)
-                {
-                    WEAKLY_DO(l, w, { if (as->in_environ(l)) hs.insert(l); })
-                }
+                WEAKLY_DO(l, w, { if (as->in_environ(l)) hs.insert(l); })
             }
 
             // Use lookupHandle to find the shallowest copy.
-            IncomingSet iset;
             for (const Handle& h: hs)
-                iset.push_back(as->lookupHandle(h));
-            return iset;
+                result.push_back(as->lookupHandle(h));
+            return;
         }
 
-        IncomingSet result;
         for (const WinkPtr& w : bucket->second)
         {
             WEAKLY_DO(l, w, { if (as->in_environ(l)) result.emplace_back(l); })
         }
-        return result;
+        return;
     }
 
-    IncomingSet result;
     for (const WinkPtr& w : bucket->second)
     {
         WEAKLY_DO(l, w, { result.emplace_back(l); })
     }
-    return result;
 }
 
 size_t Atom::getIncomingSetSizeByType(Type type, const AtomSpace* as) const
@@ -566,12 +733,9 @@ size_t Atom::getIncomingSetSizeByType(Type type, const AtomSpace* as) const
         if (as->get_copy_on_write())
         {
             HandleSet hs;
-            for (const auto& bucket : _incoming_set->_iset)
+            for (const WinkPtr& w : bucket->second)
             {
-                for (const WinkPtr& w : bucket.second)
-                {
-                    WEAKLY_DO(l, w, { if (as->in_environ(l)) hs.insert(l); })
-                }
+                WEAKLY_DO(l, w, { if (as->in_environ(l)) hs.insert(l); })
             }
             return hs.size();
         }
@@ -582,11 +746,9 @@ size_t Atom::getIncomingSetSizeByType(Type type, const AtomSpace* as) const
         return cnt;
     }
 
-    for (const WinkPtr& w : bucket->second)
-    {
-        WEAKLY_DO(l, w, { cnt++; })
-    }
-    return cnt;
+    // Links remove themselves from the incoming set when they are
+    // extracted, so the bucket size is the count; no need to walk it.
+    return bucket->second.size();
 }
 
 std::string Atom::id_to_string() const
@@ -28,7 +28,9 @@
 #define _OPENCOG_ATOM_H
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <shared_mutex>
 #include <string>
@@ -42,13 +44,28 @@
 #include <opencog/util/empty_string.h>
 #include <opencog/util/sigslot.h>
 #include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/base/FlatInSet.h>
+#include <opencog/atoms/base/LockStats.h>
+#include <opencog/atoms/base/ValueMap.h>
 #include <opencog/atoms/value/Value.h>
 #include <opencog/atoms/truthvalue/TruthValue.h>
 
-#define INCOMING_SHARED_LOCK std::shared_lock<std::shared_mutex> lck(_mtx);
-#define INCOMING_UNIQUE_LOCK std::unique_lock<std::shared_mutex> lck(_mtx);
-#define KVP_UNIQUE_LOCK std::unique_lock<std::shared_mutex> lck(_mtx);
-#define KVP_SHARED_LOCK std::shared_lock<std::shared_mutex> lck(_mtx);
+// Atoms do not carry a lock of their own; they share a global table
+// of striped locks, keyed by the address of the Atom. See `_mtx()`.
+#ifndef ATOM_NUM_LOCK_STRIPES
+#define ATOM_NUM_LOCK_STRIPES 4096
+#endif
+
+namespace opencog
+{
+inline constexpr char atom_lock_site[] = "Atom";
+typedef LOCK_SITE_SHARED_MUTEX(atom_lock_site) AtomMutex;
+}
+
+#define INCOMING_SHARED_LOCK std::shared_lock<AtomMutex> lck(_mtx());
+#define INCOMING_UNIQUE_LOCK std::unique_lock<AtomMutex> lck(_mtx());
+#define KVP_UNIQUE_LOCK std::unique_lock<AtomMutex> lck(_mtx());
+#define KVP_SHARED_LOCK std::shared_lock<AtomMutex> lck(_mtx());
 
 namespace opencog
 {
@@ -169,6 +186,24 @@ typedef std::size_t Arity;
 typedef HandleSeq IncomingSet;
 typedef SigSlot<Handle, Handle> AtomPairSignal;
 
+//! A reusable, per-thread buffer for holding a copy of an incoming
+//! set, while it is being walked. Buffers are kept in a stack, one
+//! per nesting level, so that recursive walks (as in the pattern
+//! engine) each get their own; the vectors keep their capacity
+//! between uses, so that, after warm-up, no allocation is done.
+//! The buffer is emptied when the scratch goes out of scope, so
+//! that it does not hold on to any atoms.
+class IncomingScratch
+{
+    IncomingSet* _buf;
+public:
+    IncomingScratch();
+    ~IncomingScratch();
+    IncomingScratch(const IncomingScratch&) = delete;
+    IncomingScratch& operator=(const IncomingScratch&) = delete;
+    IncomingSet& get(void) { return *_buf; }
+};
+
 #if HAVE_FOLLY
 // typedef folly::F14ValueSet<WinkPtr, std::owner_hash<WinkPtr> > WincomingSet;
 typedef folly::F14ValueSet<WinkPtr> WincomingSet;
@@ -177,6 +212,13 @@ typedef folly::F14ValueSet<WinkPtr> WincomingSet;
 typedef std::set<WinkPtr, std::owner_less<WinkPtr> > WincomingSet;
 #endif
 
+// Keep the incoming set as one contiguous, type-sorted vector of
+// back-pointers, instead of a map of sets. See FlatInSet.h for the
+// trade-offs. This is most effective together with USE_BARE_BACKPOINTER,
+// as then each entry is a bare Atom* with no weak_ptr control block;
+// the back-pointer is removed by the link, when it is extracted.
+// #define USE_FLAT_INCOMING_SET 1
+
 /**
  * Atoms are the basic implementational unit in the system that
  * represents nodes and links. In terms of C++ inheritance, nodes and
@@ -190,6 +232,9 @@ class Atom
     friend class TypeIndex;       // Needs to clear _atom_space
     friend class Link;            // Needs to call install_atom()
     friend class StateLink;       // Needs to call swap_atom()
+    friend class ClassServer;     // Needs to set _validated
+    friend class MemoryReport;    // Needs to measure the Values, InSet
+    friend class AtomSlots;       // Needs to set _has_slot
 
 protected:
     // Each atomic_flag chews up a byte.
@@ -198,6 +243,18 @@ protected:
     mutable std::atomic_bool _marked_for_removal;
     mutable std::atomic_bool _checked;
 
+    // Set once the outgoing set has passed the static type checks
+    // of the ClassServer; copies of the atom need not be checked again.
+    mutable std::atomic_bool _validated;
+
+    // Set once a CompactHandle has been made for this atom; the
+    // destructor then gives the slot back.
+    mutable std::atomic_bool _has_slot;
+
+    // The structural features of this atom and everything under it;
+    // see FEATURE_VARIABLE and friends, below. Set at construction.
+    uint8_t _features;
+
     /// Merkle-tree hash of the atom contents. Generically useful
     /// for indexing and comparison operations.
     mutable ContentHash _content_hash;
@@ -207,15 +264,25 @@ protected:
 
     AtomSpace *_atom_space;
 
-    /// All of the values on the atom, including the TV.
-    mutable std::map<const Handle, ValuePtr> _values;
+    /// The TruthValue has a slot of its own, since nearly every Atom
+    /// has one, and nothing else. All other values are in `_values`.
+    ValuePtr _truth_value;
+    mutable ValueMap _values;
 
     // Lock, used to serialize changes.
-    // This costs 40 bytes per atom.  Tried using a single, global lock,
-    // but there seemed to be too much contention for it, so instead,
-    // we are using a lock-per-atom, even though this makes the atom
-    // kind-of fat.
-    mutable std::shared_mutex _mtx;
+    // A lock-per-atom costs 56 bytes per atom, and a single, global
+    // lock had too much contention. So instead, the lock is picked out
+    // of a table of striped locks, by the address of the atom. Two
+    // atoms may share a stripe; thus, the lock of one atom must never
+    // be held while taking the lock of another. (The destructor takes
+    // no lock, so that atoms released while iterating under a lock do
+    // not deadlock.)
+    static AtomMutex _locks[ATOM_NUM_LOCK_STRIPES];
+    AtomMutex& _mtx() const
+    {
+        uintptr_t a = (uintptr_t) this;
+        return _locks[((a >> 6) ^ (a >> 18)) % ATOM_NUM_LOCK_STRIPES];
+    }
 
     /**
      * Constructor for this class. Protected; no user should call this
@@ -228,6 +295,9 @@ protected:
         _absent(false),
         _marked_for_removal(false),
         _checked(false),
+        _validated(false),
+        _has_slot(false),
+        _features(type_features(t)),
         _content_hash(Handle::INVALID_HASH),
         _atom_space(nullptr)
     {}
@@ -263,7 +333,23 @@ protected:
         // contain a hundred-million atoms, so the solution has to be
         // small. This rules out using a vector to store the
         // buckets (I tried).
+#if USE_FLAT_INCOMING_SET
+        FlatInSet<WinkPtr, std::owner_less<WinkPtr>> _iset;
+#else
         std::map<Type, WincomingSet> _iset;
+#endif
+
+        // Total number of entries in all of the buckets, kept up to
+        // date on insert and remove, so that the size is O(1). The
+        // per-type sizes are just the bucket sizes.
+        size_t _size = 0;
+
+        // The closed StateLink most recently installed with this Atom
+        // as its alias, if it is still in the incoming set; so that
+        // the current state can be found without looking through the
+        // incoming set. Guarded by the same lock as the buckets, so
+        // that it changes together with them. See StateLink.
+        WinkPtr _state{};
 
 #ifdef INCOMING_SET_SIGNALS
         // Some people want to know if the incoming set has changed...
@@ -283,6 +369,8 @@ protected:
     void insert_atom(const Handle&);
     void remove_atom(const Handle&);
     void swap_atom(const Handle&, const Handle&);
+    void set_state_link(const Handle&);
+    Handle get_state_link(void) const;
     virtual void install();
     virtual void remove();
 
@@ -316,6 +404,31 @@ public:
     //! Returns the AtomSpace in which this Atom is inserted.
     AtomSpace* getAtomSpace() const { return _atom_space; }
 
+    //! Returns whether this atom passed the static type checks.
+    bool isValidated() const { return _validated.load(); }
+
+    /// Structural features, gathered bottom-up as atoms are made, so
+    /// that tree walks can skip the subtrees that cannot hold what
+    /// they are looking for. A set bit means that this atom, or some
+    /// atom under it, is of that kind (quoted or not, scoped or not);
+    /// a clear bit means that none of them are.
+    static constexpr uint8_t FEATURE_VARIABLE = 0x01;  // and GlobNode
+    static constexpr uint8_t FEATURE_GLOB = 0x02;
+    static constexpr uint8_t FEATURE_QUOTE = 0x04;     // and (Local)Unquote
+    static constexpr uint8_t FEATURE_SCOPE = 0x08;
+    static constexpr uint8_t FEATURE_TYPE = 0x10;      // TypeNode, TypeChoice..
+    static constexpr uint8_t FEATURE_EVALUATABLE = 0x20;
+
+    /// The features of an atom of type `t`, by itself. These are
+    /// shared by all of the subtypes of `t`.
+    static uint8_t type_features(Type t);
+
+    uint8_t features() const { return _features; }
+
+    /// False if there is no atom under this one (or this one itself)
+    /// with all of the features `f`; true if there might be.
+    bool may_contain(uint8_t f) const { return f == (_features & f); }
+
     /// Merkle-tree hash of the atom contents. Generically useful
     /// for indexing and comparison operations.
     ///
@@ -389,11 +502,26 @@ public:
     //! Sets the TruthValue object of the atom.
     void setTruthValue(const TruthValuePtr&);
 
+    /// The key under which the TruthValue is stored, in the Atom and
+    /// in copy-on-write overlays of it.
+    static const Handle& truth_key(void);
+
     /// Associate `value` to `key` for this atom.
     void setValue(const Handle& key, const ValuePtr& value);
     /// Get value at `key` for this atom.
     ValuePtr getValue(const Handle& key) const;
 
+    /// Add `delta` to entry `ref` of the FloatValue at `key`, and
+    /// return the new Value. The read and the write are done under
+    /// one lock, so that concurrent increments are never lost. See
+    /// `increment()` in FloatValue.h for what happens when there is
+    /// no FloatValue at `key`.
+    ValuePtr incrementCount(const Handle& key, size_t ref, double delta);
+
+    /// Add `delta` to the count of the TruthValue, as above. See
+    /// `CountTruthValue::increment()`.
+    TruthValuePtr incrementCountTV(double delta);
+
     /// Get the set of all keys in use for this Atom.
     HandleSet getKeys() const;
 
@@ -402,8 +530,8 @@ public:
 
     /// Return true if the set of values on this atom isn't empty.
     bool haveValues() const {
-        // I think its safe to call empty() without holding a lock...!?
-        return not _values.empty();
+        // I think its safe to call this without holding a lock...!?
+        return nullptr != _truth_value or 0 < _values.size();
     }
 
     /// Print all of the key-value pairs.
@@ -456,14 +584,38 @@ public:
     inline bool foreach_incoming(bool (T::*cb)(const Handle&), T *data) const
     {
         // We make a copy of the set, so that we don't call the
-        // callback with locks held.
-        IncomingSet vh(getIncomingSet());
+        // callback with locks held. The copy goes into a recycled
+        // buffer, so that nothing is allocated.
+        IncomingScratch scratch;
+        IncomingSet& vh(scratch.get());
+        getIncomingIter(std::back_inserter(vh));
 
         for (const Handle& lp : vh)
             if ((data->*cb)(lp)) return true;
         return false;
     }
 
+    //! Invoke the callback on each atom of type `type` in the incoming
+    //! set, until one of them returns true, in which case iteration
+    //! stops and true is returned. Otherwise, false is returned.
+    //! If the AtomSpace is non-null, only the atoms visible in it are
+    //! visited. As above, the callback is not called with locks held,
+    //! and nothing is allocated, so that the callback may freely
+    //! recurse into other incoming sets.
+    template<class F>
+    inline bool foreach_incoming_by_type(Type type, const F& cb,
+                                         const AtomSpace* as = nullptr) const
+    {
+        if (nullptr == _incoming_set) return false;
+        IncomingScratch scratch;
+        IncomingSet& vh(scratch.get());
+        copyIncomingSetByType(vh, type, as);
+
+        for (const Handle& lp : vh)
+            if (cb(lp)) return true;
+        return false;
+    }
+
     /**
      * Return all atoms of type `type` that contain this atom.
      * That is, return all atoms that contain this atom, and are
@@ -491,6 +643,14 @@ public:
     /** Functional version of getIncomingSetByType.  */
     IncomingSet getIncomingSetByType(Type, const AtomSpace* = nullptr) const;
 
+    /**
+     * Same as above, but the result is placed into `iset`, which is
+     * first cleared. Passing a buffer that is reused from call to
+     * call avoids allocating a fresh vector each time.
+     */
+    void copyIncomingSetByType(IncomingSet& iset, Type,
+                               const AtomSpace* = nullptr) const;
+
     /** Return the size of the incoming set, for the given type. */
     size_t getIncomingSetSizeByType(Type type, const AtomSpace* = nullptr) const;
 
@@ -64,20 +64,23 @@ void ClassServer::splice(std::vector<T>& methods, Type t, T fact)
 	methods.resize(_nameServer.getNumberOfClasses());
 
 	// Find all the factories that belong to parents of this type.
+	// The lock-free isA() is used here, and not isAncestor(), as
+	// this runs for every type, at load time.
 	std::set<T> ok_to_clobber;
 	for (Type parent=0; parent < t; parent++)
 	{
-		if (_nameServer.isAncestor(parent, t) and methods[parent])
+		if (_nameServer.isA(t, parent) and methods[parent])
 			ok_to_clobber.insert(methods[parent]);
 	}
 
 	// Set the factory for t and all children of its type. Be careful
 	// not to clobber any factories that might have been previously
 	// declared.
-	for (Type chi=t; chi < _nameServer.getNumberOfClasses(); chi++)
+	if (not _nameServer.isDefined(t)) return;
+	Type ntypes = _nameServer.getNumberOfClasses();
+	for (Type chi=t; chi < ntypes; chi++)
 	{
-		if (not _nameServer.isDefined(t)) continue;
-		if (_nameServer.isAncestor(t, chi) and
+		if (_nameServer.isA(chi, t) and
 		    (nullptr == methods[chi] or
 		     ok_to_clobber.end() != ok_to_clobber.find(methods[chi])))
 		{
@@ -102,7 +105,7 @@ void ClassServer::update(std::vector<T>& methods, Type t)
 {
 	for (Type parent=0; parent < t; parent++)
 	{
-		if (_nameServer.isAncestor(parent, t) and methods[parent])
+		if (_nameServer.isA(t, parent) and methods[parent])
 			methods[t] = methods[parent];
 	}
 }
@@ -145,7 +148,7 @@ ClassServer::Validator* ClassServer::getValidator(Type t) const
 	return t < _validator.size() ? _validator[t] : nullptr;
 }
 
-Handle ClassServer::factory(const Handle& h) const
+Handle ClassServer::factory(const Handle& h, bool trusted) const
 {
 	Handle result;
 
@@ -156,6 +159,13 @@ Handle ClassServer::factory(const Handle& h) const
 	else
 		result = h;
 
+	/* Checked once, it stays checked. */
+	if (trusted or result->_validated.load())
+	{
+		result->_validated = true;
+		return result;
+	}
+
 	/* Look to see if we have static typechecking to do */
 	Validator* checker =
 		classserver().getValidator(result->get_type());
@@ -165,6 +175,7 @@ Handle ClassServer::factory(const Handle& h) const
 		throw SyntaxException(TRACE_INFO,
 				"Invalid Atom syntax: %s", result->to_string().c_str());
 
+	result->_validated = true;
 	return result;
 }
 
@@ -106,9 +106,10 @@ public:
 
     /**
      * Convert the indicated Atom into a C++ instance of the
-     * same type.
+     * same type. The outgoing set is checked, unless it passed the
+     * checks already, or the caller vouches for it, with `trusted`.
      */
-    Handle factory(const Handle&) const;
+    Handle factory(const Handle&, bool trusted=false) const;
 };
 
 ClassServer& classserver();
@@ -0,0 +1,135 @@
+/*
+ * opencog/atoms/base/CompactHandle.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/CompactHandle.h>
+
+using namespace opencog;
+
+namespace {
+
+struct Slot
+{
+    Atom* atom;
+    uint32_t gen;
+};
+
+// Never destroyed, so that Atoms destroyed during program shutdown
+// can still give their slot back.
+struct Table
+{
+    std::shared_mutex mtx;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free;
+    std::unordered_map<const Atom*, uint32_t> index;
+};
+
+Table& table(void)
+{
+    static Table* t = new Table();
+    return *t;
+}
+
+}
+
+CompactHandle AtomSlots::enter(Atom* atom)
+{
+    Table& t(table());
+    if (atom->_has_slot.load(std::memory_order_acquire))
+    {
+        std::shared_lock<std::shared_mutex> lck(t.mtx);
+        auto it = t.index.find(atom);
+        if (t.index.end() != it)
+            return CompactHandle(it->second, t.slots[it->second].gen);
+    }
+
+    std::unique_lock<std::shared_mutex> lck(t.mtx);
+    auto it = t.index.find(atom);
+    if (t.index.end() != it)
+        return CompactHandle(it->second, t.slots[it->second].gen);
+
+    uint32_t slot;
+    if (not t.free.empty())
+    {
+        slot = t.free.back();
+        t.free.pop_back();
+    }
+    else
+    {
+        if (UINT32_MAX <= t.slots.size())
+            throw RuntimeException(TRACE_INFO,
+                "CompactHandle: out of slots");
+        slot = t.slots.size();
+        t.slots.push_back({nullptr, 0});
+    }
+
+    // Generation zero is the null reference.
+    Slot& s(t.slots[slot]);
+    s.atom = atom;
+    if (0 == ++s.gen) s.gen = 1;
+    t.index.insert({atom, slot});
+    atom->_has_slot.store(true, std::memory_order_release);
+    return CompactHandle(slot, s.gen);
+}
+
+Handle AtomSlots::resolve(uint32_t slot, uint32_t gen)
+{
+    // The Atom may be on its way out: its count is zero, and its
+    // destructor has yet to release the slot. Then lock() fails.
+    ValuePtr vp;
+    {
+        Table& t(table());
+        std::shared_lock<std::shared_mutex> lck(t.mtx);
+        if (t.slots.size() <= slot) return Handle::UNDEFINED;
+        const Slot& s(t.slots[slot]);
+        if (s.gen != gen or nullptr == s.atom) return Handle::UNDEFINED;
+        vp = s.atom->weak_from_this().lock();
+    }
+    return Handle(std::static_pointer_cast<Atom>(vp));
+}
+
+void AtomSlots::release(const Atom* atom)
+{
+    Table& t(table());
+    std::unique_lock<std::shared_mutex> lck(t.mtx);
+    auto it = t.index.find(atom);
+    if (t.index.end() == it) return;
+
+    Slot& s(t.slots[it->second]);
+    s.atom = nullptr;
+    if (0 == ++s.gen) s.gen = 1;
+    t.free.push_back(it->second);
+    t.index.erase(it);
+}
+
+size_t AtomSlots::size(void)
+{
+    Table& t(table());
+    std::shared_lock<std::shared_mutex> lck(t.mtx);
+    return t.index.size();
+}
@@ -0,0 +1,133 @@
+/*
+ * opencog/atoms/base/CompactHandle.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_COMPACT_HANDLE_H
+#define _OPENCOG_COMPACT_HANDLE_H
+
+#include <cstdint>
+#include <functional>
+
+#include <opencog/atoms/base/Handle.h>
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+namespace opencog
+{
+
+/**
+ * A compact, non-owning reference to an Atom: a 32-bit slot number,
+ * and the 32-bit generation of that slot. It is eight bytes, half
+ * the size of a Handle, and copying it touches no reference count.
+ *
+ * Atoms get a slot the first time that compact() is called on them,
+ * and give it back when they are destroyed; the generation of the
+ * slot is then bumped, so that stale references resolve to nothing.
+ * Atoms that are never made compact pay nothing; they do not use
+ * a slot.
+ *
+ * This does not keep the Atom alive. It is meant for large tables of
+ * references to Atoms that are held alive elsewhere, e.g. by the
+ * AtomSpace, where a Handle per entry costs too much memory and too
+ * much refcount traffic. Outgoing sets still hold Handles: a Link
+ * that is in no AtomSpace must keep the Atoms it holds alive.
+ *
+ * The 64-bit value() is a name for the Atom that is unique for as
+ * long as the Atom exists, and can be used as a UUID.
+ */
+class CompactHandle
+{
+    uint32_t _slot;
+    uint32_t _gen;
+
+    friend class AtomSlots;
+    CompactHandle(uint32_t slot, uint32_t gen) : _slot(slot), _gen(gen) {}
+
+public:
+    /// The null reference; it never resolves.
+    CompactHandle(void) : _slot(0), _gen(0) {}
+    explicit CompactHandle(uint64_t v) :
+        _slot(v >> 32), _gen(v & 0xffffffff) {}
+
+    uint64_t value(void) const
+        { return (((uint64_t) _slot) << 32) | _gen; }
+
+    explicit operator bool() const { return 0 != _gen; }
+    bool operator==(const CompactHandle& o) const
+        { return _slot == o._slot and _gen == o._gen; }
+    bool operator!=(const CompactHandle& o) const
+        { return not operator==(o); }
+
+    /// The compact reference to the Atom; null for a null Handle.
+    static CompactHandle compact(const Handle&);
+
+    /// The Atom, if it still exists; else Handle::UNDEFINED.
+    Handle get(void) const;
+};
+
+/**
+ * The table of slots. Atoms are entered into it by
+ * CompactHandle::compact(), and removed by their destructor.
+ */
+class AtomSlots
+{
+    friend class Atom;
+    friend class CompactHandle;
+
+    static CompactHandle enter(Atom*);
+    static Handle resolve(uint32_t slot, uint32_t gen);
+    static void release(const Atom*);
+
+public:
+    /// Number of slots in use.
+    static size_t size(void);
+};
+
+inline CompactHandle CompactHandle::compact(const Handle& h)
+{
+    if (nullptr == h) return CompactHandle();
+    return AtomSlots::enter(h.get());
+}
+
+inline Handle CompactHandle::get(void) const
+{
+    if (0 == _gen) return Handle::UNDEFINED;
+    return AtomSlots::resolve(_slot, _gen);
+}
+
+} // namespace opencog
+
+namespace std {
+
+template<>
+struct hash<opencog::CompactHandle>
+{
+    size_t operator()(const opencog::CompactHandle& ch) const noexcept
+    {
+        return hash<uint64_t>()(ch.value());
+    }
+};
+
+} // namespace std
+
+/** @}*/
+#endif // _OPENCOG_COMPACT_HANDLE_H
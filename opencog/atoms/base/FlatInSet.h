@@ -0,0 +1,183 @@
+/*
+ * opencog/atoms/base/FlatInSet.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_FLAT_IN_SET_H
+#define _OPENCOG_FLAT_IN_SET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <opencog/atoms/atom_types/types.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A compact incoming set. All of the back-pointers are kept in one
+ * contiguous vector, grouped into runs by the type of the link; the
+ * runs are indexed by a small sorted vector of (type, offset) pairs.
+ * Within a run, the pointers are kept sorted, so that uniqueness can
+ * be checked with a binary search.
+ *
+ * Iteration and lookup present the same shape as the default
+ * `std::map<Type, WincomingSet>`: iterating gives (type, bucket)
+ * pairs, and `find(type)` gives an iterator to one of these, where
+ * the bucket is a span that can be iterated and sized.
+ *
+ * This uses far less memory, and is much more cache-friendly to walk,
+ * than a map of sets. The cost is that insertion and removal must
+ * shift the tail of the vector, so that this is a poor choice for
+ * Atoms with incoming sets of many thousands of links that change
+ * often.
+ */
+template<typename P, typename Less>
+class FlatInSet
+{
+	public:
+		/// One bucket of the incoming set: all links of the same type.
+		class Span
+		{
+			const P* _begin;
+			const P* _end;
+		public:
+			Span(const P* b, const P* e) : _begin(b), _end(e) {}
+			const P* begin() const { return _begin; }
+			const P* end() const { return _end; }
+			size_t size() const { return _end - _begin; }
+			bool empty() const { return _end == _begin; }
+		};
+		typedef std::pair<Type, Span> value_type;
+
+		class const_iterator
+		{
+			const FlatInSet* _set;
+			size_t _run;
+			mutable value_type _val;
+		public:
+			const_iterator(const FlatInSet* s, size_t r) :
+				_set(s), _run(r), _val(0, Span(nullptr, nullptr)) {}
+			const value_type& operator*() const
+			{
+				_val = _set->bucket(_run);
+				return _val;
+			}
+			const value_type* operator->() const { return &operator*(); }
+			const_iterator& operator++() { _run++; return *this; }
+			bool operator==(const const_iterator& o) const
+				{ return _run == o._run; }
+			bool operator!=(const const_iterator& o) const
+				{ return _run != o._run; }
+		};
+
+	private:
+		std::vector<P> _links;
+		std::vector<std::pair<Type, uint32_t>> _runs;
+
+		size_t run_end(size_t r) const
+		{
+			if (r+1 < _runs.size()) return _runs[r+1].second;
+			return _links.size();
+		}
+
+		value_type bucket(size_t r) const
+		{
+			const P* base = _links.data();
+			return value_type(_runs[r].first,
+				Span(base + _runs[r].second, base + run_end(r)));
+		}
+
+		size_t find_run(Type t) const
+		{
+			auto it = std::lower_bound(_runs.begin(), _runs.end(), t,
+				[](const std::pair<Type, uint32_t>& r, Type t)
+				{ return r.first < t; });
+			return it - _runs.begin();
+		}
+
+	public:
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end() const
+			{ return const_iterator(this, _runs.size()); }
+		const_iterator cend() const { return end(); }
+
+		const_iterator find(Type t) const
+		{
+			size_t r = find_run(t);
+			if (r < _runs.size() and _runs[r].first == t)
+				return const_iterator(this, r);
+			return end();
+		}
+
+		/// Add `p` to the bucket for type `t`, unless it is already
+		/// there. Return true if it was added.
+		bool insert(Type t, const P& p)
+		{
+			size_t r = find_run(t);
+			if (r == _runs.size() or _runs[r].first != t)
+			{
+				uint32_t off = (r < _runs.size()) ?
+					_runs[r].second : _links.size();
+				_runs.insert(_runs.begin() + r, {t, off});
+			}
+
+			auto b = _links.begin() + _runs[r].second;
+			auto e = _links.begin() + run_end(r);
+			auto pos = std::lower_bound(b, e, p, Less());
+			if (pos != e and not Less()(p, *pos)) return false;
+
+			_links.insert(pos, p);
+			for (size_t i = r+1; i < _runs.size(); i++)
+				_runs[i].second++;
+			return true;
+		}
+
+		/// Remove `p` from the bucket for type `t`; return the number
+		/// of entries removed (zero or one).
+		size_t erase(Type t, const P& p)
+		{
+			size_t r = find_run(t);
+			if (r == _runs.size() or _runs[r].first != t) return 0;
+
+			auto b = _links.begin() + _runs[r].second;
+			auto e = _links.begin() + run_end(r);
+			auto pos = std::lower_bound(b, e, p, Less());
+			if (pos == e or Less()(p, *pos)) return 0;
+
+			_links.erase(pos);
+			for (size_t i = r+1; i < _runs.size(); i++)
+				_runs[i].second--;
+
+			if (_runs[r].second == run_end(r))
+				_runs.erase(_runs.begin() + r);
+			return 1;
+		}
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_FLAT_IN_SET_H
@@ -0,0 +1,101 @@
+/*
+ * opencog/atoms/base/InternedName.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include "InternedName.h"
+
+using namespace opencog;
+
+// The table is split into shards, each with its own lock, so that
+// threads creating nodes in parallel rarely contend.
+#define NAME_TABLE_SHARDS 64
+
+namespace {
+struct Shard
+{
+	std::mutex mtx;
+	// The key views the string held in the entry itself.
+	std::unordered_map<std::string_view, void*> map;
+};
+
+// Never destroyed, so that names held by static atoms can still
+// be released during program shutdown.
+Shard* shards(void)
+{
+	static Shard* s = new Shard[NAME_TABLE_SHARDS];
+	return s;
+}
+}
+
+InternedName::Entry* InternedName::acquire(const std::string& s)
+{
+	size_t h = std::hash<std::string>()(s);
+	Shard& sh = shards()[h % NAME_TABLE_SHARDS];
+
+	std::lock_guard<std::mutex> lck(sh.mtx);
+	auto it = sh.map.find(std::string_view(s));
+	if (sh.map.end() != it)
+	{
+		Entry* e = static_cast<Entry*>(it->second);
+		e->refs.fetch_add(1, std::memory_order_relaxed);
+		return e;
+	}
+
+	Entry* e = new Entry{s, h, {1}};
+	sh.map.emplace(std::string_view(e->str), e);
+	return e;
+}
+
+void InternedName::release(Entry* e)
+{
+	// Fast path: not the last reference. The count only ever drops
+	// to zero under the shard lock, so that a concurrent acquire()
+	// cannot resurrect an entry that is being deleted.
+	size_t r = e->refs.load(std::memory_order_relaxed);
+	while (1 < r)
+	{
+		if (e->refs.compare_exchange_weak(r, r-1,
+		         std::memory_order_acq_rel, std::memory_order_relaxed))
+			return;
+	}
+
+	Shard& sh = shards()[e->hash % NAME_TABLE_SHARDS];
+	std::lock_guard<std::mutex> lck(sh.mtx);
+	if (0 < e->refs.fetch_sub(1, std::memory_order_acq_rel) - 1) return;
+	sh.map.erase(std::string_view(e->str));
+	delete e;
+}
+
+size_t InternedName::table_size(void)
+{
+	size_t n = 0;
+	for (size_t i = 0; i < NAME_TABLE_SHARDS; i++)
+	{
+		Shard& sh = shards()[i];
+		std::lock_guard<std::mutex> lck(sh.mtx);
+		n += sh.map.size();
+	}
+	return n;
+}
@@ -0,0 +1,97 @@
+/*
+ * opencog/atoms/base/InternedName.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_INTERNED_NAME_H
+#define _OPENCOG_INTERNED_NAME_H
+
+#include <atomic>
+#include <string>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A string, stored once in a global, thread-safe table, and shared
+ * by everyone holding the same text. Thus, a WordNode "dog" and a
+ * ConceptNode "dog" share one copy of "dog", and its hash is computed
+ * only once. Two InternedNames are equal exactly when they point at
+ * the same table entry, so comparison is a pointer compare.
+ *
+ * Entries are reference counted, and are removed from the table when
+ * the last holder goes away.
+ */
+class InternedName
+{
+	struct Entry
+	{
+		std::string str;
+		size_t hash;
+		std::atomic<size_t> refs;
+	};
+	Entry* _e;
+
+	static Entry* acquire(const std::string&);
+	static void release(Entry*);
+
+public:
+	InternedName() : _e(acquire(std::string())) {}
+	InternedName(const std::string& s) : _e(acquire(s)) {}
+	InternedName(const InternedName& o) : _e(o._e)
+		{ _e->refs.fetch_add(1, std::memory_order_relaxed); }
+	~InternedName() { release(_e); }
+
+	InternedName& operator=(const InternedName& o)
+	{
+		if (_e == o._e) return *this;
+		o._e->refs.fetch_add(1, std::memory_order_relaxed);
+		release(_e);
+		_e = o._e;
+		return *this;
+	}
+	InternedName& operator=(const std::string& s)
+	{
+		Entry* e = acquire(s);
+		release(_e);
+		_e = e;
+		return *this;
+	}
+
+	const std::string& str() const { return _e->str; }
+	operator const std::string&() const { return _e->str; }
+	const char* c_str() const { return _e->str.c_str(); }
+	size_t length() const { return _e->str.length(); }
+	size_t hash() const { return _e->hash; }
+
+	bool operator==(const InternedName& o) const { return _e == o._e; }
+	bool operator!=(const InternedName& o) const { return _e != o._e; }
+
+	/// Number of distinct strings in the table; for diagnostics.
+	static size_t table_size(void);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_INTERNED_NAME_H
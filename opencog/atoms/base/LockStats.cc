@@ -0,0 +1,96 @@
+/*
+ * opencog/atoms/base/LockStats.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "LockStats.h"
+
+using namespace opencog;
+
+// The sites, in a list that is only ever pushed onto; sites are
+// function-local statics, and live until the end of the program.
+static std::atomic<LockSite*> _sites{nullptr};
+
+LockSite::LockSite(const char* n) : name(n), next(nullptr)
+{
+	next = _sites.load();
+	while (not _sites.compare_exchange_weak(next, this)) {}
+}
+
+void LockSite::reset(void)
+{
+	locks = 0;
+	contended = 0;
+	wait_ns = 0;
+	hold_ns = 0;
+	shared_locks = 0;
+	shared_contended = 0;
+	shared_wait_ns = 0;
+}
+
+void LockSite::reset_all(void)
+{
+	for (LockSite* s = _sites.load(); s; s = s->next)
+		s->reset();
+}
+
+std::string LockSite::report(void)
+{
+#if not USE_LOCK_STATS
+	return "Lock statistics are not compiled in; "
+		"configure with -DLOCK_STATS=ON\n";
+#else
+	std::vector<const LockSite*> sites;
+	for (const LockSite* s = _sites.load(); s; s = s->next)
+		sites.push_back(s);
+	std::sort(sites.begin(), sites.end(),
+		[](const LockSite* a, const LockSite* b)
+		{
+			return a->wait_ns + a->shared_wait_ns >
+				b->wait_ns + b->shared_wait_ns;
+		});
+
+	char buf[256];
+	snprintf(buf, sizeof(buf),
+		"%-24s %12s %10s %10s %10s %12s %10s %10s\n",
+		"site", "locks", "contended", "wait-ms", "hold-ms",
+		"shared", "contended", "wait-ms");
+	std::string out(buf);
+	for (const LockSite* s : sites)
+	{
+		snprintf(buf, sizeof(buf),
+			"%-24s %12lu %10lu %10.3f %10.3f %12lu %10lu %10.3f\n",
+			s->name,
+			(unsigned long) s->locks, (unsigned long) s->contended,
+			s->wait_ns * 1e-6, s->hold_ns * 1e-6,
+			(unsigned long) s->shared_locks,
+			(unsigned long) s->shared_contended,
+			s->shared_wait_ns * 1e-6);
+		out += buf;
+	}
+	return out;
+#endif
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,174 @@
+/*
+ * opencog/atoms/base/LockStats.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_LOCK_STATS_H
+#define _OPENCOG_LOCK_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+// Count and time the acquisitions of the major locks. This costs two
+// clock reads per lock taken, and a few shared counters, so it is off
+// by default; configure with -DLOCK_STATS=ON (which defines
+// USE_LOCK_STATS) to turn it on. All of the code must be built the
+// same way, as this changes the layout of the classes holding locks.
+//
+// Locks are declared with LOCK_SITE_MUTEX(site) or
+// LOCK_SITE_SHARED_MUTEX(site), where `site` names a
+// `constexpr char[]`; all of the locks naming the same site (such as
+// the stripes of a striped lock) are counted together. Without
+// USE_LOCK_STATS these are just std::mutex and std::shared_mutex.
+
+/**
+ * The statistics gathered for one lock site. Exclusive and shared
+ * acquisitions are counted apart; an acquisition is contended if the
+ * lock could not be had at once, and only then is the wait timed.
+ * Hold times are kept for exclusive holds only.
+ */
+struct LockSite
+{
+	const char* name;
+	LockSite* next;
+
+	std::atomic<uint64_t> locks{0};
+	std::atomic<uint64_t> contended{0};
+	std::atomic<uint64_t> wait_ns{0};
+	std::atomic<uint64_t> hold_ns{0};
+	std::atomic<uint64_t> shared_locks{0};
+	std::atomic<uint64_t> shared_contended{0};
+	std::atomic<uint64_t> shared_wait_ns{0};
+
+	/// Sites add themselves to a global list, when first used.
+	LockSite(const char*);
+
+	void reset(void);
+
+	/// A table of all of the sites used so far, one per line, most
+	/// waited-on first. Times are in milliseconds.
+	static std::string report(void);
+
+	/// Zero the counts of all of the sites.
+	static void reset_all(void);
+
+	static uint64_t now(void)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+};
+
+/**
+ * A mutex that counts and times its use, as the lock site SITE. It
+ * can be used wherever the mutex M can be, including with the
+ * standard lock guards.
+ */
+template<class M, const char* SITE>
+class CountedMutex
+{
+	M _m;
+	uint64_t _since = 0;
+
+public:
+	static LockSite& site(void)
+	{
+		static LockSite s(SITE);
+		return s;
+	}
+
+	void lock(void)
+	{
+		LockSite& s(site());
+		if (not _m.try_lock())
+		{
+			uint64_t start = LockSite::now();
+			_m.lock();
+			s.contended.fetch_add(1, std::memory_order_relaxed);
+			s.wait_ns.fetch_add(LockSite::now() - start,
+			                    std::memory_order_relaxed);
+		}
+		s.locks.fetch_add(1, std::memory_order_relaxed);
+		_since = LockSite::now();
+	}
+
+	bool try_lock(void)
+	{
+		if (not _m.try_lock()) return false;
+		site().locks.fetch_add(1, std::memory_order_relaxed);
+		_since = LockSite::now();
+		return true;
+	}
+
+	void unlock(void)
+	{
+		uint64_t held = LockSite::now() - _since;
+		_m.unlock();
+		site().hold_ns.fetch_add(held, std::memory_order_relaxed);
+	}
+
+	void lock_shared(void)
+	{
+		LockSite& s(site());
+		if (not _m.try_lock_shared())
+		{
+			uint64_t start = LockSite::now();
+			_m.lock_shared();
+			s.shared_contended.fetch_add(1, std::memory_order_relaxed);
+			s.shared_wait_ns.fetch_add(LockSite::now() - start,
+			                           std::memory_order_relaxed);
+		}
+		s.shared_locks.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool try_lock_shared(void)
+	{
+		if (not _m.try_lock_shared()) return false;
+		site().shared_locks.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void unlock_shared(void) { _m.unlock_shared(); }
+};
+
+#if USE_LOCK_STATS
+#define LOCK_SITE_MUTEX(SITE) \
+	opencog::CountedMutex<std::mutex, SITE>
+#define LOCK_SITE_SHARED_MUTEX(SITE) \
+	opencog::CountedMutex<std::shared_mutex, SITE>
+#else
+#define LOCK_SITE_MUTEX(SITE) std::mutex
+#define LOCK_SITE_SHARED_MUTEX(SITE) std::shared_mutex
+#endif
+
+/** @}*/
+}
+
+#endif // _OPENCOG_LOCK_STATS_H
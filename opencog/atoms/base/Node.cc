@@ -45,31 +45,32 @@ void Node::init()
 /// any trailing newlines.
 std::string Node::to_short_string(const std::string& indent) const
 {
-    size_t len = _name.length();
+    const std::string& name(get_name());
+    size_t len = name.length();
     std::string answer;
     answer.reserve(2*len);
     answer = indent + '(' + nameserver().getTypeName(_type) + " \"";
     for (unsigned int i=0; i < len; i++)
     {
-        if ('"' == _name[i] or '\\' == _name[i])
+        if ('"' == name[i] or '\\' == name[i])
         {
             answer += '\\';
-            answer += _name[i];
+            answer += name[i];
         }
-        else if ((unsigned char) _name[i] < 0x20)
+        else if ((unsigned char) name[i] < 0x20)
         {
             // Characters that control printing.
-            if ('\a' == _name[i]) answer += "\a";
-            else if ('\b' == _name[i]) answer += "\\b";
-            else if ('\t' == _name[i]) answer += "\\t";
-            else if ('\n' == _name[i]) answer += "\\n";
-            else if ('\v' == _name[i]) answer += "\\v";
-            else if ('\f' == _name[i]) answer += "\\f";
-            else if ('\r' == _name[i]) answer += "\\r";
-            else answer += _name[i];
+            if ('\a' == name[i]) answer += "\a";
+            else if ('\b' == name[i]) answer += "\\b";
+            else if ('\t' == name[i]) answer += "\\t";
+            else if ('\n' == name[i]) answer += "\\n";
+            else if ('\v' == name[i]) answer += "\\v";
+            else if ('\f' == name[i]) answer += "\\f";
+            else if ('\r' == name[i]) answer += "\\r";
+            else answer += name[i];
         }
         else
-            answer += _name[i];
+            answer += name[i];
     }
     answer += '\"';
 
@@ -91,7 +92,7 @@ std::string Node::to_string_esc() const
     std::stringstream ss;
 
     ss << "(" << nameserver().getTypeName(_type) << " "
-       << std::quoted(_name) << ")";
+       << std::quoted(get_name()) << ")";
 
     return ss.str();
 }
@@ -110,7 +111,12 @@ bool Node::operator==(const Atom& other) const
     if (get_hash() != other.get_hash()) return false;
 
     if (get_type() != other.get_type()) return false;
+#if USE_INTERNED_NAMES
+    // Same type, so the other is a Node, too.
+    return _name == static_cast<const Node&>(other)._name;
+#else
     return get_name() == other.get_name();
+#endif
 }
 
 bool Node::operator<(const Atom& other) const
@@ -132,7 +138,11 @@ bool Node::operator<(const Atom& other) const
 
 ContentHash Node::compute_hash() const
 {
+#if USE_INTERNED_NAMES
+	ContentHash hsh = _name.hash();
+#else
 	ContentHash hsh = std::hash<std::string>()(get_name());
+#endif
 
 	// 1<<43 - 369 is a prime number.
 	hsh += (hsh<<5) + ((1ULL<<43)-369) * get_type();
@@ -28,6 +28,8 @@
 
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atoms/base/InternedName.h>
+#include <opencog/atoms/value/SlabAllocator.h>
 
 namespace opencog
 {
@@ -35,6 +37,14 @@ namespace opencog
  *  @{
  */
 
+// Store node names in a shared, global string table, so that nodes
+// with the same name (of any type) share one copy of it, and name
+// compares and hashes are constant-time. This costs a table lookup
+// each time a Node is made, including the temporary Nodes made when
+// looking up a name in the AtomSpace; thus it is off by default.
+// It pays off for very large, name-heavy datasets, e.g. word lists.
+// #define USE_INTERNED_NAMES 1
+
 /**
  * This is a subclass of Atom. It represents the most basic kind of
  * pattern known to the OpenCog system.
@@ -43,7 +53,11 @@ class Node : public Atom
 {
 protected:
     // properties
+#if USE_INTERNED_NAMES
+    InternedName _name;
+#else
     std::string _name;
+#endif
     void init();
 
     virtual ContentHash compute_hash() const;
@@ -118,7 +132,7 @@ NODE_PTR_DECL(Node)
 template< class... Args >
 Handle createNode( Args&&... args )
 {
-   Handle tmp(std::make_shared<Node>(std::forward<Args>(args) ...));
+   Handle tmp(slab_make_shared<Node>(std::forward<Args>(args) ...));
    return classserver().factory(tmp);
 }
 
@@ -0,0 +1,244 @@
+/*
+ * opencog/atoms/base/Trace.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/atom_types/NameServer.h>
+
+#include "Atom.h"
+#include "Trace.h"
+
+using namespace opencog;
+
+std::atomic<bool> Tracer::_running{false};
+
+// Each thread writes to a ring of its own, so that recording a span
+// takes no locks, and shares no cache lines. The rings are kept in a
+// list that is only ever pushed onto; when a thread exits, its ring is
+// handed on to the next new thread, spans and all.
+struct Ring
+{
+	Ring* next = nullptr;
+	std::atomic<bool> owned{true};
+	uint32_t tid = 0;
+	std::atomic<uint64_t> head{0};    // Spans ever written here
+	std::atomic<uint64_t> flushed{0}; // Spans already flushed, or dropped
+	TraceEvent events[Tracer::RING_SIZE];
+};
+
+static std::atomic<Ring*> _rings{nullptr};
+static std::atomic<uint32_t> _next_tid{1};
+static std::mutex _flush_mtx;
+
+struct RingHolder
+{
+	Ring* ring = nullptr;
+	~RingHolder() { if (ring) ring->owned = false; }
+};
+
+static thread_local RingHolder _mine;
+static thread_local uint32_t _depth = 0;
+
+static Ring* my_ring(void)
+{
+	if (_mine.ring) return _mine.ring;
+
+	for (Ring* r = _rings.load(); r; r = r->next)
+	{
+		bool owned = false;
+		if (r->owned.compare_exchange_strong(owned, true))
+			return _mine.ring = r;
+	}
+
+	Ring* r = new Ring();
+	r->tid = _next_tid++;
+	r->next = _rings.load();
+	while (not _rings.compare_exchange_weak(r->next, r)) {}
+	return _mine.ring = r;
+}
+
+// ==============================================================
+
+bool Tracer::compiled_in(void)
+{
+#if USE_TRACE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Tracer::start(void)
+{
+	_running = true;
+}
+
+void Tracer::stop(void)
+{
+	_running = false;
+}
+
+void Tracer::record(const TraceEvent& ev)
+{
+	Ring* r = my_ring();
+	uint64_t h = r->head.load(std::memory_order_relaxed);
+	r->events[h % RING_SIZE] = ev;
+	r->head.store(h + 1, std::memory_order_release);
+}
+
+void Tracer::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_flush_mtx);
+	for (Ring* r = _rings.load(); r; r = r->next)
+		r->flushed = r->head.load();
+}
+
+static void json_string(std::string& out, const char* s)
+{
+	out += '"';
+	for (; *s; s++)
+	{
+		unsigned char c = *s;
+		if ('"' == c or '\\' == c)
+		{
+			out += '\\';
+			out += c;
+		}
+		else if (c < 0x20)
+		{
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", c);
+			out += buf;
+		}
+		else
+			out += c;
+	}
+	out += '"';
+}
+
+static std::string to_json(size_t& count)
+{
+	std::lock_guard<std::mutex> lck(_flush_mtx);
+	NameServer& ns(nameserver());
+	int pid = getpid();
+
+	std::string out("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	count = 0;
+	for (Ring* r = _rings.load(); r; r = r->next)
+	{
+		uint64_t head = r->head.load(std::memory_order_acquire);
+		uint64_t from = r->flushed.load();
+		if (Tracer::RING_SIZE < head - from)
+			from = head - Tracer::RING_SIZE;
+
+		for (uint64_t i = from; i < head; i++)
+		{
+			const TraceEvent& ev(r->events[i % Tracer::RING_SIZE]);
+			char buf[160];
+			snprintf(buf, sizeof(buf),
+				"%s\n{\"cat\":\"atomese\",\"ph\":\"X\",\"pid\":%d,"
+				"\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+				0 < count ? "," : "", pid, r->tid,
+				ev.start_ns / 1000.0, ev.dur_ns / 1000.0);
+			out += buf;
+			json_string(out, ev.what);
+
+			snprintf(buf, sizeof(buf), ",\"args\":{\"depth\":%u", ev.depth);
+			out += buf;
+			if (NOTYPE != ev.type)
+			{
+				out += ",\"type\":";
+				json_string(out, ns.getTypeName(ev.type).c_str());
+			}
+			if (ev.name[0])
+			{
+				out += ",\"atom\":";
+				json_string(out, ev.name);
+			}
+			out += "}}";
+			count++;
+		}
+		r->flushed = head;
+	}
+	out += "\n]}\n";
+	return out;
+}
+
+std::string Tracer::flush(void)
+{
+	size_t count;
+	return to_json(count);
+}
+
+size_t Tracer::flush(const std::string& filename)
+{
+	FILE* fh = fopen(filename.c_str(), "w");
+	if (nullptr == fh)
+		throw IOException(TRACE_INFO, "Cannot open %s: %s",
+			filename.c_str(), strerror(errno));
+
+	size_t count;
+	std::string json(to_json(count));
+	size_t wrote = fwrite(json.data(), 1, json.size(), fh);
+	fclose(fh);
+	if (wrote != json.size())
+		throw IOException(TRACE_INFO, "Cannot write %s", filename.c_str());
+	return count;
+}
+
+// ==============================================================
+
+void TraceSpan::begin(const char* what, const Atom* atom)
+{
+	_ev.what = what;
+	_ev.depth = _depth++;
+	_ev.type = NOTYPE;
+	_ev.name[0] = 0;
+	if (atom)
+	{
+		_ev.type = atom->get_type();
+		if (atom->is_node())
+		{
+			const std::string& name(atom->get_name());
+			size_t len = std::min(name.size(), sizeof(_ev.name) - 1);
+			memcpy(_ev.name, name.data(), len);
+			_ev.name[len] = 0;
+		}
+	}
+	_ev.start_ns = Tracer::now();
+}
+
+void TraceSpan::end(void)
+{
+	_ev.dur_ns = Tracer::now() - _ev.start_ns;
+	_depth--;
+	Tracer::record(_ev);
+}
+
+/* ===================== END OF FILE ===================== */
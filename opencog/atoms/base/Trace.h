@@ -0,0 +1,146 @@
+/*
+ * opencog/atoms/base/Trace.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_TRACE_H
+#define _OPENCOG_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+// Execution tracing: nested, timed spans around the evaluation of
+// Atomese, the pattern searches, the calls out to grounded code and
+// the StorageNode operations. The spans are kept in a ring buffer, one
+// per thread, and written out on demand in the Chrome trace-event
+// format, which chrome://tracing and Perfetto can display.
+//
+// The spans are compiled out by default; configure with -DTRACE=ON
+// (which defines USE_TRACE) to compile them in. Even then, nothing is
+// recorded until Tracer::start() is called; until then, each span
+// costs one atomic load.
+
+/// One finished span.
+struct TraceEvent
+{
+	const char* what;   // The operation; a string constant
+	uint64_t start_ns;
+	uint64_t dur_ns;
+	uint32_t depth;     // How many spans enclose this one
+	Type type;          // The type of the Atom worked on, if any
+	char name[46];      // The name of that Atom, if a Node; truncated
+};
+
+class Tracer
+{
+public:
+	/// The number of spans each thread keeps; older ones are dropped.
+	static constexpr size_t RING_SIZE = 16384;
+
+	/// True if the spans were compiled in.
+	static bool compiled_in(void);
+
+	static void start(void);
+	static void stop(void);
+	static bool is_running(void)
+	{
+		return _running.load(std::memory_order_relaxed);
+	}
+
+	/// All of the spans recorded since the last flush, as a Chrome
+	/// trace (a JSON object with a `traceEvents` array). The buffers
+	/// are emptied. Spans that finish while this runs may or may not
+	/// be included; stop the tracer first, to get a clean cut.
+	static std::string flush(void);
+
+	/// As above, written to a file. Returns the number of spans.
+	static size_t flush(const std::string& filename);
+
+	/// Drop all of the spans recorded so far.
+	static void clear(void);
+
+	static void record(const TraceEvent&);
+
+	static uint64_t now(void)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+private:
+	static std::atomic<bool> _running;
+};
+
+/**
+ * A span, from construction to destruction. The Atom, if given, is
+ * recorded by type, and by name if it is a Node; it need not outlive
+ * the span.
+ */
+class TraceSpan
+{
+	TraceEvent _ev;
+	bool _on;
+
+	void begin(const char*, const Atom*);
+	void end(void);
+
+public:
+	TraceSpan(const char* what, const Atom* atom = nullptr)
+		: _on(Tracer::is_running())
+	{
+		if (_on) begin(what, atom);
+	}
+	TraceSpan(const char* what, const Handle& h)
+		: _on(Tracer::is_running())
+	{
+		if (_on) begin(what, h.get());
+	}
+	~TraceSpan()
+	{
+		if (_on) end();
+	}
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#if USE_TRACE
+#define TRACE_SPAN_CAT(A,B) A##B
+#define TRACE_SPAN_VAR(L) TRACE_SPAN_CAT(_trace_span_, L)
+#define TRACE_SPAN(...) \
+	opencog::TraceSpan TRACE_SPAN_VAR(__LINE__)(__VA_ARGS__)
+#else
+#define TRACE_SPAN(...)
+#endif
+
+/** @}*/
+}
+
+#endif // _OPENCOG_TRACE_H
@@ -0,0 +1,175 @@
+/*
+ * opencog/atoms/base/ValueMap.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_VALUE_MAP_H
+#define _OPENCOG_VALUE_MAP_H
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+// Number of keys kept in the flat vector, before switching over
+// to a hash table.
+#ifndef VALUE_MAP_FLAT_MAX
+#define VALUE_MAP_FLAT_MAX 8
+#endif
+
+/**
+ * The key-value store on an Atom. Almost all Atoms carry only one or
+ * two keys, and so these are kept in a flat vector, searched linearly:
+ * this costs one allocation, instead of one tree node per key, and
+ * almost always hits on the first compare, since keys are usually the
+ * very same Atom. Atoms with more than VALUE_MAP_FLAT_MAX keys switch
+ * over to a hash table.
+ *
+ * Keys are compared by content, as they were in std::map.
+ * This class does no locking; the owning Atom does that.
+ */
+class ValueMap
+{
+	private:
+		typedef std::pair<Handle, ValuePtr> KVP;
+		typedef std::unordered_map<Handle, ValuePtr> HashMap;
+
+		std::vector<KVP> _flat;
+		std::unique_ptr<HashMap> _hash;
+
+		static bool same_key(const Handle& a, const Handle& b)
+		{
+			return std::equal_to<Handle>()(a, b);
+		}
+
+	public:
+		ValuePtr get(const Handle& key) const
+		{
+			if (_hash)
+			{
+				auto it = _hash->find(key);
+				if (_hash->end() == it) return nullptr;
+				return it->second;
+			}
+			for (const KVP& kv : _flat)
+				if (same_key(kv.first, key)) return kv.second;
+			return nullptr;
+		}
+
+		void set(const Handle& key, const ValuePtr& value)
+		{
+			if (_hash)
+			{
+				(*_hash)[key] = value;
+				return;
+			}
+			for (KVP& kv : _flat)
+			{
+				if (same_key(kv.first, key))
+				{
+					kv.second = value;
+					return;
+				}
+			}
+			if (_flat.size() < VALUE_MAP_FLAT_MAX)
+			{
+				_flat.emplace_back(key, value);
+				return;
+			}
+
+			_hash.reset(new HashMap(_flat.begin(), _flat.end()));
+			(*_hash)[key] = value;
+			std::vector<KVP>().swap(_flat);
+		}
+
+		void erase(const Handle& key)
+		{
+			if (_hash)
+			{
+				_hash->erase(key);
+				return;
+			}
+			for (size_t i = 0; i < _flat.size(); i++)
+			{
+				if (same_key(_flat[i].first, key))
+				{
+					_flat[i] = std::move(_flat.back());
+					_flat.pop_back();
+					return;
+				}
+			}
+		}
+
+		void clear(void)
+		{
+			_hash.reset();
+			std::vector<KVP>().swap(_flat);
+		}
+
+		size_t size(void) const
+		{
+			if (_hash) return _hash->size();
+			return _flat.size();
+		}
+
+		/// Call `cb` on each key.
+		template<typename F>
+		void foreach_key(F cb) const
+		{
+			if (_hash)
+				for (const auto& kv : *_hash) cb(kv.first);
+			else
+				for (const KVP& kv : _flat) cb(kv.first);
+		}
+
+		/// Call `cb` on each key, and the Value on it.
+		template<typename F>
+		void foreach_value(F cb) const
+		{
+			if (_hash)
+				for (const auto& kv : *_hash) cb(kv.first, kv.second);
+			else
+				for (const KVP& kv : _flat) cb(kv.first, kv.second);
+		}
+
+		/// Estimated heap bytes taken by the map itself; that is, not
+		/// counting the keys and Values it points at.
+		size_t bytes(void) const
+		{
+			if (nullptr == _hash) return _flat.capacity() * sizeof(KVP);
+			return sizeof(HashMap) +
+				_hash->bucket_count() * sizeof(void*) +
+				_hash->size() * (2 * sizeof(void*) + sizeof(KVP));
+		}
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_VALUE_MAP_H
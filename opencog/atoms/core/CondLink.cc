@@ -88,28 +88,43 @@ CondLink::CondLink(const HandleSeq &&oset, Type t)
 	init();
 }
 
+static ValuePtr execute_exp(AtomSpace* scratch, bool silent,
+                            const Handle& exp)
+{
+	if (exp->is_executable())
+		return exp->execute(scratch, silent);
+
+	// At this time, not every Atom type knows how to execute
+	// itself. So if the above didn't work, try again, forcing
+	// further reduction.
+	Instantiator inst(scratch);
+	return inst.execute(exp);
+}
+
 ValuePtr CondLink::execute(AtomSpace *scratch, bool silent)
 {
 	for (unsigned i = 0; i < conds.size(); ++i)
 	{
 		TruthValuePtr tvp(EvaluationLink::do_evaluate(scratch, conds[i]));
 		if (tvp->get_mean() > 0.5)
-		{
-			if (exps[i]->is_executable())
-				return exps[i]->execute(scratch, silent);
-
-			// At this time, not every Atom type knows how to execute
-			// itself. So if the above didn't work, try again, forcing
-			// further reduction.
-			Instantiator inst(scratch);
-			return inst.execute(exps[i]);
-		}
+			return execute_exp(scratch, silent, exps[i]);
 	}
 
-	if (default_exp->is_executable())
-		return default_exp->execute(scratch, silent);
-	Instantiator inst(scratch);
-	return inst.execute(default_exp);
+	return execute_exp(scratch, silent, default_exp);
+}
+
+ValuePtr CondLink::execute(AtomSpace *scratch, bool silent,
+                           const Reducer& reduce)
+{
+	for (unsigned i = 0; i < conds.size(); ++i)
+	{
+		TruthValuePtr tvp(EvaluationLink::do_evaluate(scratch,
+		                                              reduce(conds[i])));
+		if (tvp->get_mean() > 0.5)
+			return execute_exp(scratch, silent, reduce(exps[i]));
+	}
+
+	return execute_exp(scratch, silent, reduce(default_exp));
 }
 
 DEFINE_LINK_FACTORY(CondLink, COND_LINK)
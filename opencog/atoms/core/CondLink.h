@@ -23,6 +23,8 @@
 #ifndef _OPENCOG_COND_LINK_H
 #define _OPENCOG_COND_LINK_H
 
+#include <functional>
+
 #include <opencog/atoms/core/FunctionLink.h>
 #include <opencog/atoms/core/ScopeLink.h>
 #include <opencog/atoms/core/Quotation.h>
@@ -45,6 +47,14 @@ public:
 
 	virtual ValuePtr execute(AtomSpace*, bool);
 
+	/// Same as execute(), except that the conditions and expressions
+	/// are first passed through `reduce` (typically, to plug in the
+	/// groundings of free variables). Only the conditions that get
+	/// evaluated, and the one expression that is taken, are reduced;
+	/// the branches not taken are never touched.
+	typedef std::function<Handle(const Handle&)> Reducer;
+	ValuePtr execute(AtomSpace*, bool, const Reducer&);
+
 	static Handle factory(const Handle&);
 };
 
@@ -22,6 +22,7 @@
  */
 
 #include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atomspace/AtomSpace.h>
 
 #include "DefineLink.h"
 
@@ -66,6 +67,22 @@ DefineLink::DefineLink(const Handle& name, const Handle& defn)
 	init();
 }
 
+/// Called when the AtomSpace adds this link.
+void DefineLink::install()
+{
+	Link::install();
+	if (_atom_space)
+		_atom_space->set_definition(_outgoing[0], get_handle());
+}
+
+/// Called when the AtomSpace extracts this link.
+void DefineLink::remove()
+{
+	if (_atom_space)
+		_atom_space->clear_definition(_outgoing[0], get_handle());
+	Link::remove();
+}
+
 /**
  * Get the definition associated with the alias.
  * This will be the second atom of some DefineLink, where
@@ -73,13 +90,20 @@ DefineLink::DefineLink(const Handle& name, const Handle& defn)
  */
 Handle DefineLink::get_definition(const Handle& alias, const AtomSpace* as)
 {
-	Handle uniq(get_unique(alias, DEFINE_LINK, false, as));
-	return uniq->getOutgoingAtom(1);
+	return get_link(alias, as)->getOutgoingAtom(1);
 }
 
 Handle DefineLink::get_link(const Handle& alias, const AtomSpace* as)
 {
-	return get_unique(alias, DEFINE_LINK, false, as);
+	if (as)
+	{
+		Handle defl(as->get_definition(alias));
+		if (defl) return defl;
+	}
+
+	throw InvalidParamException(TRACE_INFO,
+	                            "Cannot find definition for atom %s",
+	                            alias->to_string().c_str());
 }
 
 DEFINE_LINK_FACTORY(DefineLink, DEFINE_LINK)
@@ -61,6 +61,8 @@ class DefineLink : public UniqueLink
 {
 protected:
 	void init();
+	virtual void install();
+	virtual void remove();
 public:
 	DefineLink(const HandleSeq&&, Type=DEFINE_LINK);
 
@@ -79,7 +81,8 @@ public:
 	 *    <name>
 	 *    <body>
 	 *
-	 * return <body>
+	 * return <body>. The lookup goes through the definitions kept by
+	 * the AtomSpace; see AtomSpace::get_definition().
 	 */
 	static Handle get_definition(const Handle& alias, const AtomSpace*);
 	static Handle get_definition(const Handle& alias)
@@ -39,6 +39,7 @@ FindAtoms::FindAtoms(Type t, bool subclass)
 	{
 		nameserver().getChildrenRecursive(t, inserter(_target_types));
 	}
+	init_features();
 }
 
 FindAtoms::FindAtoms(Type ta, Type tb, bool subclass)
@@ -48,17 +49,35 @@ FindAtoms::FindAtoms(Type ta, Type tb, bool subclass)
 	{
 		nameserver().getChildrenRecursive(tb, inserter(_target_types));
 	}
+	init_features();
 }
 
 FindAtoms::FindAtoms(const Handle& atom)
 	: _target_types(),
 	  _target_atoms({atom})
-{}
+{
+	init_features();
+}
 
 FindAtoms::FindAtoms(const HandleSet& selection)
 	: _target_types(),
 	  _target_atoms(selection)
-{}
+{
+	init_features();
+}
+
+/// The features that every one of the targets has. Subtrees that lack
+/// any of them cannot hold a target, and need not be searched.
+void FindAtoms::init_features(void)
+{
+	_target_features = 0xff;
+	for (Type t : _target_types)
+		_target_features &= Atom::type_features(t);
+	for (const Handle& h : _target_atoms)
+		_target_features &= h->features();
+	if (_target_types.empty() and _target_atoms.empty())
+		_target_features = 0;
+}
 
 void FindAtoms::search_set(const Handle& h)
 {
@@ -72,6 +91,9 @@ void FindAtoms::search_set(const HandleSeq& hlist)
 
 FindAtoms::Loco FindAtoms::find_rec(const Handle& h, Quotation quotation)
 {
+	// Nothing down there that we are looking for.
+	if (not h->may_contain(_target_features)) return NOPE;
+
 	Type t = h->get_type();
 	if (quotation.is_unquoted() and
 	    (1 == _target_types.count(t) or _target_atoms.count(h) == 1))
@@ -111,6 +133,7 @@ bool is_atom_in_tree(const Handle& tree, const Handle& atom)
 {
 	if (tree == atom) return true;
 	if (not tree->is_link()) return false;
+	if (not tree->may_contain(atom->features())) return false;
 
 	// Recurse downwards...
 	for (const Handle& h: tree->getOutgoingSet()) {
@@ -135,7 +158,8 @@ int min_quotation_level(const Handle& tree,
 {
 	// Base case
 	if (content_eq(tree, atom)) return quotation.level();
-	if (not tree->is_link()) return std::numeric_limits<int>::max();
+	if (not tree->is_link() or not tree->may_contain(atom->features()))
+		return std::numeric_limits<int>::max();
 
 	// Recursive case
 	quotation.update(tree->get_type());
@@ -151,7 +175,8 @@ int max_quotation_level(const Handle& tree,
 {
 	// Base case
 	if (tree == atom) return quotation.level();
-	if (not tree->is_link()) return std::numeric_limits<int>::min();
+	if (not tree->is_link() or not tree->may_contain(atom->features()))
+		return std::numeric_limits<int>::min();
 
 	// Recursive case
 	quotation.update(tree->get_type());
@@ -166,6 +191,7 @@ bool is_unscoped_in_tree(const Handle& tree, const Handle& atom)
 	// Base cases
 	if (content_eq(tree, atom)) return true;
 	if (not tree->is_link()) return false;
+	if (not tree->may_contain(atom->features())) return false;
 	if (nameserver().isA(tree->get_type(), SCOPE_LINK))
 	{
 		ScopeLinkPtr stree(ScopeLinkCast(tree));
@@ -186,6 +212,7 @@ bool is_constant_in_tree(const Handle& tree, const Handle& atom)
 	// Base cases
 	if (content_eq(tree, atom)) return true;
 	if (not tree->is_link()) return false;
+	if (not tree->may_contain(atom->features())) return false;
 
 	// Halt recursion if the term is executable.
 	if (tree->is_executable()) return false;
@@ -205,6 +232,7 @@ static bool found_helper(const Handle& tree,
 	// Base cases
 	if (content_eq(subtree, atom)) return true;
 	if (not subtree->is_link()) return false;
+	if (not subtree->may_contain(atom->features())) return false;
 	if (reject(tree, subtree, atom)) return false;
 
 	// Recursive case
@@ -234,7 +262,8 @@ bool is_free_in_tree(const Handle& tree, const Handle& atom)
 	 [](const Handle& tree, const Handle& subtr, const Handle& ato)
 	{
 		// Plow through any quotes.
-		if (is_quoted_in_tree(tree, subtr)) return false;
+		if (tree->may_contain(Atom::FEATURE_QUOTE) and
+		    is_quoted_in_tree(tree, subtr)) return false;
 
 		// Halt recursion if scoped.
 		if (nameserver().isA(subtr->get_type(), SCOPE_LINK))
@@ -365,6 +394,9 @@ bool is_unquoted_in_any_tree(const HandleSeq& trees,
 bool contains_atomtype(const Handle& clause, Type atom_type,
                        Quotation quotation)
 {
+	if (not clause->may_contain(Atom::type_features(atom_type)))
+		return false;
+
 	Type clause_type = clause->get_type();
 	if (quotation.is_unquoted() and nameserver().isA(clause_type, atom_type))
 		return true;
@@ -383,6 +415,9 @@ bool contains_atomtype(const Handle& clause, Type atom_type,
 size_t contains_atomtype_count(const Handle& clause, Type atom_type,
                                Quotation quotation)
 {
+	if (not clause->may_contain(Atom::type_features(atom_type)))
+		return 0;
+
 	size_t cnt = 0;
 
 	Type clause_type = clause->get_type();
@@ -407,7 +442,7 @@ HandleSet get_free_variables(const Handle& h, Quotation quotation)
 	// Base cases
 	if ((t == VARIABLE_NODE or t == GLOB_NODE) and quotation.is_unquoted())
 		return {h};
-	if (h->is_node())
+	if (h->is_node() or not h->may_contain(Atom::FEATURE_VARIABLE))
 		return {};
 
 	// Recursive cases
@@ -465,6 +500,9 @@ bool is_closed(const Handle& h, Quotation quotation)
 
 bool is_constant(const Handle& h, Quotation quotation)
 {
+	if (not h->may_contain(Atom::FEATURE_VARIABLE) and
+	    not h->may_contain(Atom::FEATURE_TYPE)) return true;
+
 	if (not is_closed(h, quotation)) return false;
 
 	if (contains_atomtype(h, TYPE_NODE, quotation)) return false;
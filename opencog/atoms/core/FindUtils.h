@@ -118,6 +118,8 @@ private:
 private:
 	TypeSet _target_types;
 	HandleSet _target_atoms;
+	uint8_t _target_features;
+	void init_features(void);
 };
 
 /**
@@ -371,11 +371,60 @@ FreeVariables::FreeVariables(const std::initializer_list<Handle>& variables)
 	init_index();
 }
 
+// Content hashes are not well spread in their low bits.
+static inline size_t slot_hash(const Handle& h, size_t mask)
+{
+	return ((h->get_hash() * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+}
+
 void FreeVariables::init_index()
 {
 	index.clear();
 	for (unsigned i = 0; i < varseq.size(); i++)
 		index[varseq[i]] = i;
+
+	slots.clear();
+	slot_table.clear();
+	if (varseq.empty() and varset.empty()) return;
+
+	// A power of two, at most half full, so that misses end quickly.
+	size_t sz = 4;
+	while (sz < 2 * (varseq.size() + varset.size())) sz <<= 1;
+	slot_table.assign(sz, -1);
+
+	// A variable that appears twice in the varseq is found at its
+	// last slot, just as in the index.
+	auto add_slot = [&](const Handle& var, bool in_varseq)
+	{
+		size_t mask = slot_table.size() - 1;
+		size_t i = slot_hash(var, mask);
+		for (; 0 <= slot_table[i]; i = (i + 1) & mask)
+		{
+			if (not content_eq(slots[slot_table[i]], var)) continue;
+			if (not in_varseq) return;
+			break;
+		}
+		slot_table[i] = slots.size();
+		slots.push_back(var);
+	};
+	for (const Handle& var : varseq) add_slot(var, true);
+	for (const Handle& var : varset) add_slot(var, false);
+}
+
+int FreeVariables::find_slot(const Handle& var) const
+{
+	if (slot_table.empty() or nullptr == var) return -1;
+
+	size_t mask = slot_table.size() - 1;
+	for (size_t i = slot_hash(var, mask); 0 <= slot_table[i];
+	     i = (i + 1) & mask)
+	{
+		const Handle& h(slots[slot_table[i]]);
+		if (h == var or
+		    (h->get_hash() == var->get_hash() and *h == *var))
+			return slot_table[i];
+	}
+	return -1;
 }
 
 bool FreeVariables::is_identical(const FreeVariables& other) const
@@ -392,7 +441,7 @@ bool FreeVariables::is_identical(const FreeVariables& other) const
 
 bool FreeVariables::varset_contains(const Handle& v) const
 {
-	return varset.end() != varset.find(v);
+	return 0 <= find_slot(v);
 }
 
 void FreeVariables::find_variables(const Handle& body)
@@ -440,36 +489,77 @@ void FreeVariables::erase(const Handle& var)
 	// Remove from varset
 	varset.erase(var);
 
-	// Remove from index
-	index.erase(var);
-
-	// Remove from varseq and update all arguments in the subsequent
-	// index as they have changed.
+	// Remove from varseq
 	auto content_eq_var = [&var](const Handle& h) {
 		return content_eq(var, h);
 	};
 	auto it = std::find_if(varseq.begin(), varseq.end(), content_eq_var);
-	if (it != varseq.end()) {
-		it = varseq.erase(it);
-		for (; it != varseq.end(); ++it)
-			index.find(*it)->second--;
-	}
+	if (it != varseq.end())
+		varseq.erase(it);
+
+	// The ordinals of all the variables after it have changed.
+	init_index();
 }
 
 /* ================================================================= */
 
+/// Add every link holding a variable to the spine, and return true if
+/// there was a variable in `h`.
+static bool plan_walk(const Handle& h, const HandleSet& vars,
+                      FreeVariables::Spine& spine)
+{
+	if (h->is_node()) return vars.find(h) != vars.end();
+	if (spine.find(h.get()) != spine.end()) return true;
+
+	bool found = false;
+	for (const Handle& ho : h->getOutgoingSet())
+		found = plan_walk(ho, vars, spine) or found;
+	if (found) spine.insert(h.get());
+	return found;
+}
+
+void FreeVariables::make_plan(const HandleSeq& terms)
+{
+	std::shared_ptr<Plan> pln(std::make_shared<Plan>());
+	pln->vars = varset;
+	for (const Handle& h : terms)
+	{
+		if (nullptr == h) continue;
+		pln->roots.push_back(h);
+		plan_walk(h, varset, pln->spine);
+	}
+	plan = pln;
+}
+
+/// Return the spine to use, if `term` is one that was planned for,
+/// and the variables are still the same.
+/// The roots are held, so that the spine cannot dangle.
+static const FreeVariables::Spine* planned(const FreeVariables& fv,
+                                           const Handle& term)
+{
+	const auto& plan = fv.plan;
+	if (nullptr == plan) return nullptr;
+	if (plan->roots.end() ==
+	    std::find(plan->roots.begin(), plan->roots.end(), term))
+		return nullptr;
+	if (plan->vars != fv.varset) return nullptr;
+	return &plan->spine;
+}
+
 Handle FreeVariables::substitute_nocheck(const Handle& term,
                                          const HandleSeq& args,
                                          bool silent) const
 {
-	return substitute_scoped(term, args, index);
+	return substitute_scoped(term, args, index, Quotation(),
+	                         planned(*this, term));
 }
 
 Handle FreeVariables::substitute_nocheck(const Handle& term,
                                          const HandleMap& vm,
                                          bool silent) const
 {
-	return substitute_scoped(term, make_sequence(vm), index);
+	return substitute_scoped(term, make_sequence(vm), index, Quotation(),
+	                         planned(*this, term));
 }
 
 bool FreeVariables::operator<(const FreeVariables& other) const
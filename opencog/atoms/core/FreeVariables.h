@@ -24,7 +24,9 @@
 #define _OPENCOG_FREE_VARIABLES_H
 
 #include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include <opencog/util/empty_string.h>
 #include <opencog/atoms/base/Handle.h>
@@ -62,13 +64,46 @@ struct FreeVariables : Replacement
 	HandleSet varset;
 	IndexMap index;
 
+	/// A substitution plan for the terms that these variables are
+	/// bound in: the links, in those terms, that hold a variable
+	/// somewhere below them (quoted or not). Substitution returns
+	/// all other links as they are, without walking them. The plan
+	/// is shared by copies, and ignored, once the variables change.
+	struct Plan
+	{
+		HandleSet vars;
+		HandleSeq roots;
+		Spine spine;
+	};
+	std::shared_ptr<const Plan> plan;
+
+	/// A dense index over the variables, for the lookups made in the
+	/// inner loops of type checking and of the pattern matcher. There
+	/// is one slot per variable: slot i holds varseq[i], and after
+	/// those come any members of the varset that are not in the varseq.
+	/// The slots are found through an open-addressed table, on the
+	/// content hash that each Atom caches; a lookup is a probe or two
+	/// and a pointer compare, instead of the walk down the std::set or
+	/// std::map, with a content compare at every step, that the varset
+	/// and the index cost.
+	///
+	/// The slots are rebuilt by init_index(); code that changes the
+	/// varseq or the varset directly must call it afterwards.
+	HandleSeq slots;
+	std::vector<int> slot_table;
+
 	// CTor, mostly convenient for unit tests
 	FreeVariables() {}
 	FreeVariables(const std::initializer_list<Handle>& variables);
+	virtual ~FreeVariables() {}
 
-	// Construct index. FreeVariables::varseq must be previously
-	// defined.
-	void init_index();
+	// Construct index and slots. FreeVariables::varseq must be
+	// previously defined.
+	virtual void init_index();
+
+	/// Return the slot of variable `var`, or -1 if it is not one of
+	/// these variables.
+	int find_slot(const Handle& var) const;
 
 	/// Return true if the variables in this, and other, are the same
 	/// variables (have exactly the same variable names.)
@@ -126,6 +161,9 @@ struct FreeVariables : Replacement
 	/// Erase the given variable, if it exists.
 	void erase(const Handle&);
 
+	/// Make a substitution plan for the given terms.
+	void make_plan(const HandleSeq& terms);
+
 	/// Given the tree `tree` containing variables in it, create and
 	/// return a new tree with the indicated arguments `args` substituted
 	/// for the variables.  "nocheck" == no type checking is done.
@@ -28,6 +28,7 @@ using namespace opencog;
 void ImplicationScopeLink::init(void)
 {
 	extract_variables(_outgoing);
+	make_plan();
 }
 
 ImplicationScopeLink::ImplicationScopeLink(const HandleSeq&& hseq, Type t)
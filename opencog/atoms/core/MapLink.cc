@@ -19,10 +19,20 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <opencog/util/concurrent_queue.h>
+#include <opencog/util/platform.h>
 #include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/core/FindUtils.h>
+#include <opencog/atoms/core/NumberNode.h>
 #include <opencog/atoms/execution/Instantiator.h>
 #include <opencog/atoms/core/VariableSet.h>
+#include <opencog/atomspace/AtomSpace.h>
 
 #include "MapLink.h"
 
@@ -33,10 +43,23 @@ void MapLink::init(void)
 	// Maps consist of a function, and the data to apply the function to.
 	// The function can be explicit (inheriting from ScopeLink) or
 	// implicit (we automatically fish out free variables).
-	if (2 != _outgoing.size())
+	size_t sz = _outgoing.size();
+	if (2 != sz and 3 != sz)
 		throw SyntaxException(TRACE_INFO,
 			"MapLink is expected to be arity-2 only!");
 
+	// The optional thread count.
+	_nthreads = 1;
+	if (3 == sz)
+	{
+		if (NUMBER_NODE != _outgoing[2]->get_type())
+			throw SyntaxException(TRACE_INFO,
+				"MapLink expects a thread count, got %s",
+				_outgoing[2]->to_short_string().c_str());
+		double nthr = std::floor(NumberNodeCast(_outgoing[2])->get_value());
+		if (1.0 < nthr) _nthreads = nthr;
+	}
+
 	// First argument must be a function of some kind.  All functions
 	// are specified using a ScopeLink, to bind the input-variables.
 	Type tscope = _outgoing[0]->get_type();
@@ -304,11 +327,10 @@ bool MapLink::extract(const Handle& termpat,
 	return (ip == tsz) and (jg == gsz);
 }
 
-Handle MapLink::rewrite_one(const Handle& cterm, AtomSpace* scratch) const
+Handle MapLink::rewrite_one(const Handle& cterm, Instantiator& inst) const
 {
 	// Execute the ground, including consuming its quotation as part of
 	// the MapLink semantics
-	Instantiator inst(scratch);
 	Handle term(HandleCast(inst.instantiate(cterm, GroundingMap())));
 
 	// Extract values for variables.
@@ -357,6 +379,65 @@ Handle MapLink::rewrite_one(const Handle& cterm, AtomSpace* scratch) const
 	return Handle::UNDEFINED;
 }
 
+/// Apply the map to each of the terms, dropping those that don't
+/// match. Each thread uses one Instantiator for all of its terms. As
+/// in ExecuteThreadedLink, the threads take their work from a shared
+/// queue; here, the results are put back in the original order.
+HandleSeq MapLink::rewrite_all(const HandleSeq& terms,
+                               AtomSpace* scratch) const
+{
+	size_t nterms = terms.size();
+	HandleSeq remap(nterms);
+
+	size_t nthreads = std::min(_nthreads, nterms);
+	if (nthreads <= 1)
+	{
+		Instantiator inst(scratch);
+		for (size_t i = 0; i < nterms; i++)
+			remap[i] = rewrite_one(terms[i], inst);
+	}
+	else
+	{
+		concurrent_queue<size_t> todo_list;
+		for (size_t i = 0; i < nterms; i++)
+			todo_list.push(i);
+
+		std::mutex mtx;
+		std::exception_ptr ex;
+		auto worker = [&](void)
+		{
+			set_thread_name("atoms:maplink");
+			Instantiator inst(scratch);
+			size_t i;
+			while (todo_list.try_get(i))
+			{
+				try
+				{
+					remap[i] = rewrite_one(terms[i], inst);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					ex = std::current_exception();
+					return;
+				}
+			}
+		};
+
+		std::vector<std::thread> thread_set;
+		for (size_t i = 0; i < nthreads; i++)
+			thread_set.push_back(std::thread(worker));
+		for (std::thread& t : thread_set) t.join();
+
+		if (ex) std::rethrow_exception(ex);
+	}
+
+	// Drop the terms that did not match.
+	remap.erase(std::remove(remap.begin(), remap.end(), Handle::UNDEFINED),
+	            remap.end());
+	return remap;
+}
+
 ValuePtr MapLink::execute(AtomSpace* scratch, bool silent)
 {
 	const Handle& valh = _outgoing[1];
@@ -368,17 +449,17 @@ ValuePtr MapLink::execute(AtomSpace* scratch, bool silent)
 	Type argtype = valh->get_type();
 	if (SET_LINK == argtype or LIST_LINK == argtype)
 	{
-		HandleSeq remap;
-		for (const Handle& h : valh->getOutgoingSet())
-		{
-			Handle mone = rewrite_one(h, scratch);
-			if (nullptr != mone) remap.emplace_back(mone);
-		}
+		HandleSeq remap(rewrite_all(valh->getOutgoingSet(), scratch));
+
+		// Add all of the results in one go; this is much faster than
+		// having them added one by one, along with the wrapping link.
+		if (scratch) remap = scratch->add_atoms(std::move(remap));
 		return createLink(std::move(remap), argtype);
 	}
 
 	// Its a singleton. Just remap that.
-	Handle mone = rewrite_one(valh, scratch);
+	Instantiator inst(scratch);
+	Handle mone = rewrite_one(valh, inst);
 	if (mone) return mone;
 
 	// Avoid returning null handle.  This is broken.
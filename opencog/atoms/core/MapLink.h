@@ -29,6 +29,8 @@
 
 namespace opencog
 {
+class Instantiator;
+
 /** \addtogroup grp_atomspace
  *  @{
  */
@@ -40,6 +42,9 @@ namespace opencog
 /// a template pattern, which can be compared to an input, and values 
 /// are extracted for the variable locations.
 ///
+/// An optional third argument, a NumberNode, gives the number of
+/// threads to use, when the map is applied to a set or list.
+///
 class MapLink : public FunctionLink
 {
 protected:
@@ -52,6 +57,7 @@ protected:
 
 	bool _is_impl;
 	Handle _rewrite;
+	size_t _nthreads;
 
 	void init(void);
 
@@ -60,7 +66,8 @@ protected:
 	bool extract(const Handle&, const Handle&, GroundingMap&,
 	             Quotation quotation=Quotation()) const;
 
-	Handle rewrite_one(const Handle&, AtomSpace*) const;
+	Handle rewrite_one(const Handle&, Instantiator&) const;
+	HandleSeq rewrite_all(const HandleSeq&, AtomSpace*) const;
 
 public:
 	MapLink(const HandleSeq&&, Type=MAP_LINK);
@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: AGPL-3.0-or-later
  */
 
+#include <cmath>
+#include <cstring>
 #include <sstream>
 
 #include <opencog/util/exceptions.h>
@@ -67,35 +69,31 @@ std::vector<double> NumberNode::to_vector(const std::string& str)
 // Constructors
 
 NumberNode::NumberNode(Type t, const std::string&& s)
-	: Node(t, std::move(s))
+	: Node(t, "")
 {
-	// Convert to number and back to string to avoid miscompares.
+	// The name is printed back from the number, to avoid miscompares.
 	_value = to_vector(s);
-	_name = vector_to_plain(_value);
 
 	OC_ASSERT(nameserver().isA(_type, NUMBER_NODE),
 		"Bad NumberNode constructor!");
 }
 
 NumberNode::NumberNode(const std::string&& s)
-	: Node(NUMBER_NODE, std::move(s))
+	: Node(NUMBER_NODE, "")
 {
 	_value = to_vector(s);
-	_name = vector_to_plain(_value);
 }
 
 NumberNode::NumberNode(const std::vector<double>& vec)
 	: Node(NUMBER_NODE, "")
 {
 	_value = vec;
-	_name = vector_to_plain(_value);
 }
 
 NumberNode::NumberNode(const FloatValuePtr& fv)
 	: Node(NUMBER_NODE, "")
 {
 	_value = fv->value();
-	_name = vector_to_plain(_value);
 }
 
 NumberNode::NumberNode(const ValuePtr& vp)
@@ -105,14 +103,12 @@ NumberNode::NumberNode(const ValuePtr& vp)
 	{
 		NumberNodePtr fv = NumberNodeCast(vp);
 		_value = fv->value();
-		_name = vector_to_plain(_value);
 		return;
 	}
 	if (nameserver().isA(vp->get_type(), FLOAT_VALUE))
 	{
 		FloatValuePtr fv = FloatValueCast(vp);
 		_value = fv->value();
-		_name = vector_to_plain(_value);
 		return;
 	}
 	throw RuntimeException(TRACE_INFO,
@@ -121,6 +117,54 @@ NumberNode::NumberNode(const ValuePtr& vp)
 
 // ============================================================
 
+const std::string& NumberNode::get_name() const
+{
+	std::call_once(_named, [this]()
+	{
+		const_cast<NumberNode*>(this)->_name = vector_to_plain(_value);
+	});
+	return Node::get_name();
+}
+
+ContentHash NumberNode::compute_hash() const
+{
+	// The hash is that of the name; make sure there is one.
+	get_name();
+	return Node::compute_hash();
+}
+
+/// Two doubles print the same exactly when they are the same bits;
+/// except for NaNs, which print the same no matter what. So compare
+/// the numbers, and the names only if there are NaNs.
+bool NumberNode::operator==(const Atom& other) const
+{
+	if (this == &other) return true;
+	if (get_type() != other.get_type()) return false;
+
+	const NumberNode* onn = dynamic_cast<const NumberNode*>(&other);
+	if (nullptr == onn) return Node::operator==(other);
+
+	const std::vector<double>& ov(onn->_value);
+	size_t sz = _value.size();
+	if (sz != ov.size()) return false;
+
+	bool nan = false;
+	for (size_t i = 0; i < sz; i++)
+	{
+		if (std::isnan(_value[i]) or std::isnan(ov[i]))
+		{
+			nan = true;
+			continue;
+		}
+		if (0 != memcmp(&_value[i], &ov[i], sizeof(double)))
+			return false;
+	}
+	if (not nan) return true;
+	return get_name() == other.get_name();
+}
+
+// ============================================================
+
 /// Scalar addition
 ValuePtr opencog::plus(double f, const ValuePtr& vj, bool silent)
 {
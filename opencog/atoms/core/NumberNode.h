@@ -9,6 +9,8 @@
 #ifndef _OPENCOG_NUMBER_NODE_H
 #define _OPENCOG_NUMBER_NODE_H
 
+#include <mutex>
+
 #include <boost/lexical_cast.hpp>
 #include <opencog/atoms/base/Node.h>
 #include <opencog/atoms/value/FloatValue.h>
@@ -48,6 +50,13 @@ private:
 protected:
 	std::vector<double> _value;
 
+	// The name is printed from the value the first time that it is
+	// needed: for printing, or for hashing. Arithmetic does not need
+	// it, and so never pays for it.
+	mutable std::once_flag _named;
+
+	virtual ContentHash compute_hash() const;
+
 public:
 	// Please to NOT use this constructor!
 	NumberNode(Type, const std::string&&);
@@ -59,7 +68,7 @@ public:
 	NumberNode(const ValuePtr&);
 
 	NumberNode(double vvv)
-		: Node(NUMBER_NODE, double_to_string(vvv))
+		: Node(NUMBER_NODE, "")
 	{ _value.push_back(vvv); }
 
 	NumberNode(NumberNode&) = delete;
@@ -74,6 +83,9 @@ public:
 		return vector_to_plain(to_vector(str));
 	}
 
+	virtual const std::string& get_name() const;
+	virtual bool operator==(const Atom&) const;
+
 	size_t size() const { return _value.size(); }
 	const std::vector<double>& value(void) const { return _value; }
 	double get_value(void) const { return _value[0]; }
@@ -473,10 +473,11 @@ Handle PutLink::do_reduce(void) const
 
 		// If the arguments are given in a set, then iterate over the set...
 		HandleSeq bset;
+		bset.reserve(args->get_arity());
+		HandleSeq oset(1);
 		for (const Handle& h : args->getOutgoingSet())
 		{
-			HandleSeq oset;
-			oset.emplace_back(h);
+			oset[0] = h;
 			try
 			{
 				bset.emplace_back(reddy(subs, oset));
@@ -531,6 +532,7 @@ Handle PutLink::do_reduce(void) const
 	}
 
 	HandleSeq bset;
+	bset.reserve(args->get_arity());
 	for (const Handle& h : args->getOutgoingSet())
 	{
 		const HandleSeq& oset = h->getOutgoingSet();
@@ -21,6 +21,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <atomic>
+#include <cmath>
+
 #include <opencog/util/mt19937ar.h>
 
 #include "FunctionLink.h"
@@ -29,7 +32,14 @@
 
 using namespace opencog;
 
-static MT19937RandGen randy(43);
+// Each thread draws from a generator of its own. The first thread to
+// draw gets the seed that a single, shared generator used to have.
+static MT19937RandGen& randy(void)
+{
+	static std::atomic<unsigned long> seeds(43);
+	static thread_local MT19937RandGen rng(seeds++);
+	return rng;
+}
 
 RandomChoiceLink::RandomChoiceLink(const HandleSeq&& oset, Type t)
 	: FunctionLink(std::move(oset), t)
@@ -40,6 +50,108 @@ RandomChoiceLink::RandomChoiceLink(const HandleSeq&& oset, Type t)
 		throw InvalidParamException(TRACE_INFO,
 			"Expecting an RandomChoiceLink, got %s", tname.c_str());
 	}
+	init();
+}
+
+/// If the weights are all NumberNodes, then they will be the same on
+/// every draw; set up the alias table for them now. Anything else is
+/// left for execute(), which also reports any errors.
+void RandomChoiceLink::init(void)
+{
+	size_t ary = _outgoing.size();
+	if (0 == ary) return;
+
+	const Handle& ofirst(_outgoing[0]);
+	Type ot = ofirst->get_type();
+
+	HandleSeq choices;
+	std::vector<double> weights;
+	if (1 == ary and (SET_LINK == ot or LIST_LINK == ot))
+	{
+		for (const Handle& h : ofirst->getOutgoingSet())
+		{
+			if (LIST_LINK != h->get_type()) return;
+			const HandleSeq& oset = h->getOutgoingSet();
+			if (2 != oset.size()) return;
+
+			NumberNodePtr nn(NumberNodeCast(oset[0]));
+			if (nullptr == nn) return;
+			weights.push_back(nn->get_value());
+			choices.push_back(oset[1]);
+		}
+	}
+	else if (2 == ary and LIST_LINK == ot)
+	{
+		const Handle& hchoices(_outgoing[1]);
+		if (ofirst->get_arity() != hchoices->get_arity()) return;
+		for (const Handle& h : ofirst->getOutgoingSet())
+		{
+			NumberNodePtr nn(NumberNodeCast(h));
+			if (nullptr == nn) return;
+			weights.push_back(nn->get_value());
+		}
+		if (hchoices->is_link()) choices = hchoices->getOutgoingSet();
+	}
+	else return;
+
+	if (choices.empty() or not make_alias(weights)) return;
+	_choices = std::move(choices);
+}
+
+/// Vose's alias method. Each of the n columns holds a share of one
+/// choice, and the rest of it, if any, goes to its alias; picking a
+/// column, and then one of the two, is then a pick in proportion to
+/// the weights. Returns false if the weights are not a distribution.
+bool RandomChoiceLink::make_alias(const std::vector<double>& weights)
+{
+	size_t n = weights.size();
+	double sum = 0.0;
+	for (double w : weights)
+	{
+		if (not std::isfinite(w) or w < 0.0) return false;
+		sum += w;
+	}
+	if (not (0.0 < sum) or not std::isfinite(sum)) return false;
+
+	std::vector<double> scaled(n);
+	std::vector<size_t> small, large;
+	for (size_t i = 0; i < n; i++)
+	{
+		scaled[i] = weights[i] * n / sum;
+		if (scaled[i] < 1.0) small.push_back(i);
+		else large.push_back(i);
+	}
+
+	_prob.assign(n, 1.0);
+	_alias.resize(n);
+	for (size_t i = 0; i < n; i++) _alias[i] = i;
+
+	while (not small.empty() and not large.empty())
+	{
+		size_t s = small.back();
+		small.pop_back();
+		size_t l = large.back();
+
+		_prob[s] = scaled[s];
+		_alias[s] = l;
+		scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+		if (scaled[l] < 1.0)
+		{
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+
+	// Whatever is left over is full, up to rounding.
+	return true;
+}
+
+size_t RandomChoiceLink::draw_alias(void) const
+{
+	MT19937RandGen& rng(randy());
+	size_t i = rng.randint(_prob.size());
+	if (_prob[i] <= rng.randdouble()) return _alias[i];
+	return i;
 }
 
 // ---------------------------------------------------------------
@@ -111,6 +223,9 @@ RandomChoiceLink::RandomChoiceLink(const HandleSeq&& oset, Type t)
 // out of a vector of values.
 ValuePtr RandomChoiceLink::execute(AtomSpace* as, bool silent)
 {
+	if (not _choices.empty())
+		return _choices[draw_alias()];
+
 	size_t ary = _outgoing.size();
 	if (0 == ary) return ValuePtr();
 
@@ -152,14 +267,14 @@ ValuePtr RandomChoiceLink::execute(AtomSpace* as, bool silent)
 		if (0 == weights.size())
 			throw RuntimeException(TRACE_INFO,
 				"Asked to choose element from empty set!");
-		return choices[randy.rand_discrete(weights)];
+		return choices[randy().rand_discrete(weights)];
 
 uniform:
 		ary = ofirst->get_arity();
 		if (0 == ary)
 			throw RuntimeException(TRACE_INFO,
 				"Asked to choose element from empty set!");
-		return ofirst->getOutgoingAtom(randy.randint(ary));
+		return ofirst->getOutgoingAtom(randy().randint(ary));
 	}
 
 	// Weighted choices cannot be sets, since sets are unordered.
@@ -190,13 +305,13 @@ uniform:
 		if (0 == weights.size())
 			throw RuntimeException(TRACE_INFO,
 				"Asked to choose element from empty set!");
-		return choices->getOutgoingAtom(randy.rand_discrete(weights));
+		return choices->getOutgoingAtom(randy().rand_discrete(weights));
 	}
 
 	if (0 == ary)
 		throw RuntimeException(TRACE_INFO,
 			"Asked to choose element from empty set!");
-	return _outgoing.at(randy.randint(ary));
+	return _outgoing.at(randy().randint(ary));
 }
 
 DEFINE_LINK_FACTORY(RandomChoiceLink, RANDOM_CHOICE_LINK)
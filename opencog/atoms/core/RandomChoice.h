@@ -61,6 +61,17 @@ namespace opencog
 ///
 class RandomChoiceLink : public FunctionLink
 {
+protected:
+	// When the weights are constants, the choices and Vose's alias
+	// table for them are made up front; a draw is then O(1).
+	HandleSeq _choices;
+	std::vector<double> _prob;
+	std::vector<size_t> _alias;
+
+	void init(void);
+	bool make_alias(const std::vector<double>&);
+	size_t draw_alias(void) const;
+
 public:
 	RandomChoiceLink(const HandleSeq&&, Type=RANDOM_CHOICE_LINK);
 	RandomChoiceLink(const RandomChoiceLink&) = delete;
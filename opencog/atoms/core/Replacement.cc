@@ -59,10 +59,14 @@ Handle Replacement::replace_nocheck(const Handle& term,
 ///    any scoped variables with the same name as the free variables
 ///    are alpha-hidden, possibly alpha-converted if the substituting
 ///    values are variables of the same name.
+///
+/// If a spine is given, then it holds all of the links, below `term`,
+/// that have variables in them; the others are not walked.
 Handle Replacement::substitute_scoped(Handle term,
                                       const HandleSeq& args,
                                       const IndexMap& index_map,
-                                      Quotation quotation)
+                                      Quotation quotation,
+                                      const Spine* spine)
 {
 	bool unquoted = quotation.is_unquoted();
 
@@ -79,6 +83,9 @@ Handle Replacement::substitute_scoped(Handle term,
 	// and just return that.
 	if (not term->is_link()) return term;
 
+	// Nothing to substitute, if there are no variables down there.
+	if (spine and spine->find(term.get()) == spine->end()) return term;
+
 	Type ty = term->get_type();
 
 	// Update for subsequent recursive calls of substitute_scoped
@@ -96,8 +103,12 @@ Handle Replacement::substitute_scoped(Handle term,
 		// If a substituting value is equal to a variable of that scope,
 		// then alpha-convert the scope to avoid variable name
 		// collision. Loop in the rare case the new names collide.
+		// The converted scope is not in the spine.
 		while (must_alpha_convert(term, args))
+		{
 			term = ScopeLinkCast(term)->alpha_convert();
+			spine = nullptr;
+		}
 
 		// Hide any variables of the scope that are to be substituted,
 		// that is remove them from the index.
@@ -125,7 +136,7 @@ Handle Replacement::substitute_scoped(Handle term,
 		// that wraps them up.  See MapLinkUTest for examples.
 		if (GLOB_NODE == h->get_type())
 		{
-			Handle glst(substitute_scoped(h, args, *index_map_ptr, quotation));
+			Handle glst(substitute_scoped(h, args, *index_map_ptr, quotation, spine));
 			changed = true;
 
 			// Also unwrap any ListLinks that were inserted by
@@ -138,7 +149,7 @@ Handle Replacement::substitute_scoped(Handle term,
 		}
 		else
 		{
-			Handle sub(substitute_scoped(h, args, *index_map_ptr, quotation));
+			Handle sub(substitute_scoped(h, args, *index_map_ptr, quotation, spine));
 			if (sub != h) changed = true;
 			oset.emplace_back(sub);
 		}
@@ -24,6 +24,7 @@
 #define _OPENCOG_REPLACEMENT_H
 
 #include <map>
+#include <unordered_set>
 
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/atoms/base/Atom.h>
@@ -52,6 +53,10 @@ struct Replacement
 {
 	typedef std::map<Handle, unsigned int> IndexMap;
 
+	/// Atoms, by address. Content-based sets won't do, as they treat
+	/// alpha-equivalent scopes as the same.
+	typedef std::unordered_set<const Atom*> Spine;
+
 	/// Walk the tree given in the first argument, and replace
 	/// any atoms that occur in the map by their mapped value.
 	/// It has the name "nocheck" because no type-checking is
@@ -61,7 +66,8 @@ struct Replacement
 protected:
 	static Handle substitute_scoped(Handle, const HandleSeq&,
 	                                const IndexMap&,
-	                                Quotation quotation=Quotation());
+	                                Quotation quotation=Quotation(),
+	                                const Spine* spine=nullptr);
 	static bool must_alpha_convert(const Handle& scope, const HandleSeq& args);
 	static bool must_alpha_hide(const Handle& scope, const IndexMap& index_map);
 	static IndexMap alpha_hide(const Handle& scope, const IndexMap& index_map);
@@ -44,6 +44,16 @@ void ScopeLink::init(void)
 	// and so nothing to be done. Skip variable extraction.
 	if (_quoted) return;
 	extract_variables(_outgoing);
+	make_plan();
+}
+
+/// Plan the substitution of the variables into the scoped terms.
+void ScopeLink::make_plan(void)
+{
+	HandleSeq terms(_outgoing);
+	if (_vardecl) terms.erase(terms.begin());
+	terms.push_back(_body);
+	_variables.make_plan(terms);
 }
 
 ScopeLink::ScopeLink(const Handle& vars, const Handle& body)
@@ -244,6 +254,72 @@ Handle ScopeLink::alpha_convert(const HandleMap& vsmap) const
 	return alpha_convert(vars);
 }
 
+/* ================================================================= */
+
+/// Walk two terms side by side, and return true if they are the same,
+/// up to a renaming of the bound variables: wherever one term has a
+/// bound variable, the other must have the variable bound at the same
+/// position. Unlike alpha-conversion, no new atoms are created.
+///
+/// Unordered links are a problem: their outgoing sets are sorted in
+/// an order that depends on the variable names, so that a difference
+/// found below one proves nothing. In that case, `punt` is set, and
+/// false is returned; the caller has to check some other way.
+static bool alpha_walk(const Handle& h, const Handle& oh,
+                       const FreeVariables::IndexMap& index,
+                       const FreeVariables::IndexMap& oindex,
+                       Quotation quotation, bool& punt)
+{
+	Type t = h->get_type();
+	if (t != oh->get_type()) return false;
+
+	if ((VARIABLE_NODE == t or GLOB_NODE == t) and quotation.is_unquoted())
+	{
+		auto it = index.find(h);
+		auto oit = oindex.find(oh);
+		if (it != index.end() or oit != oindex.end())
+			return it != index.end() and oit != oindex.end()
+				and it->second == oit->second;
+	}
+
+	if (h->is_node()) return *h == *oh;
+
+	if (h->get_arity() != oh->get_arity()) return false;
+
+	// Nested scopes: number their variables after ours, just as
+	// term_hash() does.
+	if (nameserver().isA(t, SCOPE_LINK) and quotation.is_unquoted())
+	{
+		FreeVariables::IndexMap new_index(index);
+		for (const auto& vi : ScopeLinkCast(h)->get_variables().index)
+			new_index[vi.first] = vi.second + index.size();
+		FreeVariables::IndexMap new_oindex(oindex);
+		for (const auto& vi : ScopeLinkCast(oh)->get_variables().index)
+			new_oindex[vi.first] = vi.second + oindex.size();
+
+		quotation.update(t);
+		const HandleSeq& oset(h->getOutgoingSet());
+		const HandleSeq& ooset(oh->getOutgoingSet());
+		for (size_t i = 0; i < oset.size(); i++)
+			if (not alpha_walk(oset[i], ooset[i], new_index, new_oindex,
+			                   quotation, punt))
+				return false;
+		return true;
+	}
+
+	quotation.update(t);
+	const HandleSeq& oset(h->getOutgoingSet());
+	const HandleSeq& ooset(oh->getOutgoingSet());
+	for (size_t i = 0; i < oset.size(); i++)
+	{
+		if (alpha_walk(oset[i], ooset[i], index, oindex, quotation, punt))
+			continue;
+		if (h->is_unordered_link()) punt = true;
+		return false;
+	}
+	return true;
+}
+
 /* ================================================================= */
 ///
 /// Compare other ScopeLink, return true if it is equal to this one,
@@ -289,9 +365,26 @@ bool ScopeLink::is_equal(const Handle& other, bool silent) const
 		return true;
 	}
 
-	// If we are here, we need to perform alpha conversion to test
-	// equality.  Other terms, with our variables in place of its
-	// variables, should be same as our terms.
+	// Compare the terms side by side, matching up the variables
+	// by position.
+	bool punt = false;
+	const HandleSeq& otho(other->getOutgoingSet());
+	for (Arity i = 0; i < n_scoped_terms; ++i)
+	{
+		if (alpha_walk(_outgoing[i + vardecl_offset],
+		               otho[i + other_vardecl_offset],
+		               _variables.index, scother->_variables.index,
+		               Quotation(), punt))
+			continue;
+		if (not punt) return false;
+		break;
+	}
+	if (not punt) return true;
+
+	// If we are here, there are unordered links holding variables,
+	// and we need to perform alpha conversion to test equality.
+	// Other terms, with our variables in place of its variables,
+	// should be same as our terms.
 	for (Arity i = 0; i < n_scoped_terms; ++i)
 	{
 		Handle h = getOutgoingAtom(i + vardecl_offset);
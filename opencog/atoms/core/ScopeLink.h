@@ -62,6 +62,7 @@ protected:
 	void init(void);
 	void extract_variables(const HandleSeq& oset);
 	void init_scoped_variables(const Handle& vardecl);
+	void make_plan(void);
 
 	bool skip_init(Type);
 	virtual ContentHash compute_hash() const;
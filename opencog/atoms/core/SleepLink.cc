@@ -54,9 +54,7 @@ SleepLink::SleepLink(const HandleSeq&& oset, Type t)
 
 // ---------------------------------------------------------------
 
-/// Return number of seconds left to sleep.
-/// Normally, this is zero, unless the sleep was interrupted.
-ValuePtr SleepLink::execute(AtomSpace*as, bool silent)
+double SleepLink::get_seconds(AtomSpace* as, bool silent)
 {
 	// Try to come up with a number, either from executing, or directly
 	Handle time(_outgoing.at(0));
@@ -86,6 +84,15 @@ ValuePtr SleepLink::execute(AtomSpace*as, bool silent)
 
 		length = nsle->get_value();
 	}
+	return length;
+}
+
+/// Return number of seconds left to sleep.
+/// Normally, this is zero, unless the sleep was interrupted.
+ValuePtr SleepLink::execute(AtomSpace*as, bool silent)
+{
+	double length = get_seconds(as, silent);
+	if (length < 0.0) length = 0.0;
 	unsigned int secs = floor(length);
 	useconds_t usec = 1000000 * (length - secs);
 	
@@ -42,6 +42,9 @@ public:
 	SleepLink(const SleepLink &) = delete;
 	SleepLink& operator=(const SleepLink &) = delete;
 
+	// The number of seconds to sleep for, without sleeping.
+	double get_seconds(AtomSpace*, bool silent=false);
+
 	// Return number of seconds left to sleep.
 	virtual ValuePtr execute(AtomSpace*, bool);
 
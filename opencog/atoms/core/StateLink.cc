@@ -48,6 +48,17 @@ StateLink::StateLink(const Handle& name, const Handle& defn)
 	init();
 }
 
+/// The shallowest closed StateLink for the alias, as seen from `as`,
+/// or null, if there is none. If the one that the alias points at is
+/// in `as` itself, then nothing can hide it.
+Handle StateLink::find_link(const Handle& alias, const AtomSpace* as)
+{
+	Handle cur(alias->get_state_link());
+	if (cur and cur->getAtomSpace() == as and not cur->isAbsent())
+		return cur;
+	return get_unique_nt(alias, STATE_LINK, true, as);
+}
+
 /**
  * Get the state associated with the alias.
  * This will be the second atom of some StateLink, where
@@ -55,8 +66,7 @@ StateLink::StateLink(const Handle& name, const Handle& defn)
  */
 Handle StateLink::get_state(const Handle& alias, const AtomSpace* as)
 {
-	Handle uniq(get_unique(alias, STATE_LINK, true, as));
-	return uniq->getOutgoingAtom(1);
+	return get_link(alias, as)->getOutgoingAtom(1);
 }
 
 /**
@@ -65,13 +75,19 @@ Handle StateLink::get_state(const Handle& alias, const AtomSpace* as)
  */
 Handle StateLink::get_link(const Handle& alias, const AtomSpace* as)
 {
-	return get_unique(alias, STATE_LINK, true, as);
+	Handle uniq(find_link(alias, as));
+	if (uniq) return uniq;
+
+	// There is no definition for the alias.
+	throw InvalidParamException(TRACE_INFO,
+	                            "Cannot find definition for atom %s",
+	                            alias->to_string().c_str());
 }
 
 /// Return this if not found.
 Handle StateLink::get_link(const AtomSpace* as)
 {
-	Handle shallowest(get_unique_nt(_outgoing[0], STATE_LINK, true, as));
+	Handle shallowest(find_link(_outgoing[0], as));
 	if (shallowest) return shallowest;
 	return get_handle();
 }
@@ -109,7 +125,7 @@ void StateLink::install()
 		AtomSpace *as = old_state->getAtomSpace();
 		setAtomSpace(as);
 
-		// Atomic update of the incoming set.
+		// Atomic update of the incoming set, and of the state.
 		const Handle& new_state(get_handle());
 		alias->swap_atom(defl, new_state);
 
@@ -121,7 +137,10 @@ void StateLink::install()
 		swapped = true;
 	}
 
-	if (not swapped) Link::install();
+	if (swapped) return;
+
+	Link::install();
+	alias->set_state_link(get_handle());
 }
 
 DEFINE_LINK_FACTORY(StateLink, STATE_LINK);
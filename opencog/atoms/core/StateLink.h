@@ -46,11 +46,19 @@ namespace opencog
 /// new one; they will never see two StateLinks, and they will never
 /// see zero StateLinks.
 ///
+/// The alias keeps a pointer to the current closed StateLink, swapped
+/// together with its incoming set. Looking up the state in the same
+/// AtomSpace as that StateLink is thus a single read, and does not
+/// search the incoming set of the alias. In other AtomSpaces, such as
+/// a child that does not override the state, the incoming set is
+/// searched, as before.
+///
 class StateLink : public UniqueLink
 {
 protected:
 	void init();
 	virtual void install();
+	static Handle find_link(const Handle& alias, const AtomSpace*);
 public:
 	StateLink(const HandleSeq&&, Type=STATE_LINK);
 	StateLink(const Handle& alias, const Handle& body);
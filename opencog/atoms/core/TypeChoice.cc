@@ -84,6 +84,7 @@ void TypeChoice::post_analyze(bool glob)
 		_deep_typeset = tcp->get_deep_typeset();
 		_sect_typeset = tcp->_sect_typeset;
 		_glob_interval = tcp->get_glob_interval();
+		make_bitmaps();
 		return;
 	}
 
@@ -97,6 +98,50 @@ void TypeChoice::post_analyze(bool glob)
 	{
 		_simple_typeset.insert({NOTYPE});
 	}
+
+	make_bitmaps();
+}
+
+/// Precompute the type checks, so that each one is a bit test.
+/// Types created after this are not in the bitmaps, and are checked
+/// the long way.
+void TypeChoice::make_bitmaps(void)
+{
+	NameServer& ns = nameserver();
+	Type ntypes = ns.getNumberOfClasses();
+
+	_simple_bits.assign(ntypes, false);
+	for (Type t : _simple_typeset)
+		if (t < ntypes) _simple_bits[t] = true;
+
+	// Most deep types accept only one type of thing, or a few, at
+	// the top; anything else need not be looked at any further.
+	_deep_bits.assign(ntypes, false);
+	_deep_any = false;
+	for (const Handle& sig : _deep_typeset)
+	{
+		Handle deep(sig);
+		if (SIGNATURE_LINK == deep->get_type())
+			deep = deep->getOutgoingAtom(0);
+
+		Type dpt = deep->get_type();
+		if (TYPE_NODE == dpt)
+		{
+			Type k = TypeNodeCast(deep)->get_kind();
+			if (k < ntypes) _deep_bits[k] = true;
+		}
+		else if (TYPE_INH_NODE == dpt or TYPE_CO_INH_NODE == dpt)
+		{
+			Type k = TypeNodeCast(deep)->get_kind();
+			for (Type t = 0; t < ntypes; t++)
+				if ((TYPE_INH_NODE == dpt) ? ns.isA(t, k) : ns.isA(k, t))
+					_deep_bits[t] = true;
+		}
+		else if (DEFINED_TYPE_NODE == dpt or ns.isA(dpt, TYPE_CHOICE))
+			_deep_any = true;
+		else
+			_deep_bits[dpt] = true;
+	}
 }
 
 void TypeChoice::init(bool glob)
@@ -320,7 +365,9 @@ bool TypeChoice::is_upper_bound(size_t n) const
 /// Returns true if `h` satisfies the type restrictions.
 bool TypeChoice::is_type(Type t) const
 {
-	return _is_untyped or _simple_typeset.end() != _simple_typeset.find(t);
+	if (_is_untyped) return true;
+	if (t < _simple_bits.size()) return _simple_bits[t];
+	return _simple_typeset.end() != _simple_typeset.find(t);
 }
 
 /// Returns true if `h` satisfies the type restrictions.
@@ -358,12 +405,19 @@ bool TypeChoice::is_nonglob_type(const ValuePtr& vp) const
 	// If the argument has the simple type, then we are good to go;
 	// we are done.  Else, fall through, and see if one of the
 	// others accept the match.
-	if (_simple_typeset.find(vp->get_type()) != _simple_typeset.end())
+	Type vt = vp->get_type();
+	if (vt < _simple_bits.size())
+	{
+		if (_simple_bits[vt]) return true;
+	}
+	else if (_simple_typeset.find(vt) != _simple_typeset.end())
 		return true;
 
-	// Deep type restrictions?
-	for (const Handle& sig : _deep_typeset)
-		if (value_is_type(sig, vp)) return true;
+	// Deep type restrictions? Skip them, if none can accept
+	// this type at the top.
+	if (_deep_any or _deep_bits.size() <= vt or _deep_bits[vt])
+		for (const Handle& sig : _deep_typeset)
+			if (value_is_type(sig, vp)) return true;
 
 	// True, only if there were no type restrictions...
 	return _is_untyped;
@@ -56,6 +56,13 @@ protected:
 	GlobInterval _glob_interval;
 	bool _is_untyped;
 
+	// The types in _simple_typeset, and the types that some deep type
+	// might accept at the top, as bitmaps indexed by type.
+	std::vector<bool> _simple_bits;
+	std::vector<bool> _deep_bits;
+	bool _deep_any = true;
+	void make_bitmaps(void);
+
 	void init(bool);
 	bool pre_analyze(bool);
 	void analyze(Handle);
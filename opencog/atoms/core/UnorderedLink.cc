@@ -21,12 +21,43 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 #include <opencog/util/mt19937ar.h>
 
 #include "UnorderedLink.h"
 
 using namespace opencog;
 
+/// Place into arbitrary, but deterministic order. We use content
+/// (hash) based less, to avoid variations due to address-space
+/// randomization. The hashes are looked up once, and compared as
+/// plain numbers; the contents are compared only when they tie.
+/// Input that is in order already, such as sets read back from
+/// storage, is left as it is, after a single pass.
+static void canonical_order(HandleSeq& oset)
+{
+	size_t sz = oset.size();
+	if (sz < 2) return;
+
+	typedef std::pair<ContentHash, Handle> Keyed;
+	std::vector<Keyed> keyed;
+	keyed.reserve(sz);
+	for (const Handle& h : oset)
+		keyed.emplace_back(h->get_hash(), h);
+
+	auto less = [](const Keyed& a, const Keyed& b) -> bool
+	{
+		if (a.first != b.first) return a.first < b.first;
+		return content_based_handle_less()(a.second, b.second);
+	};
+	if (std::is_sorted(keyed.begin(), keyed.end(), less)) return;
+
+	std::sort(keyed.begin(), keyed.end(), less);
+	for (size_t i = 0; i < sz; i++)
+		oset[i] = std::move(keyed[i].second);
+}
+
 UnorderedLink::UnorderedLink(const HandleSeq&& oset, Type t)
 	: Link(std::move(oset), t)
 {
@@ -37,11 +68,7 @@ UnorderedLink::UnorderedLink(const HandleSeq&& oset, Type t)
 			"Expecting an UnorderedLink, got %s", tname.c_str());
 	}
 
-	// Place into arbitrary, but deterministic order. We use
-	// content (hash) based less, to avoid variations due to
-	// address-space randomization.
-	std::sort(_outgoing.begin(), _outgoing.end(),
-		content_based_handle_less());
+	canonical_order(_outgoing);
 }
 
 UnorderedLink::UnorderedLink(const HandleSet& oset, Type t)
@@ -61,9 +88,8 @@ UnorderedLink::UnorderedLink(const HandleSet& oset, Type t)
 	// Place into arbitrary, but deterministic order.
 	// Actually, this should already be in sorted order, because
 	// HandleSet is already sorted by content_based_handle_less().
-	// But it can't hurt to do it again, to avoid insanity.
-	std::sort(_outgoing.begin(), _outgoing.end(),
-		content_based_handle_less());
+	// But it can't hurt to check, to avoid insanity.
+	canonical_order(_outgoing);
 }
 
 // ---------------------------------------------------------------
@@ -205,10 +205,10 @@ bool Variables::is_alpha_convertible(const Handle& var,
                                      const Variables& other,
                                      bool check_type) const
 {
-	IndexMap::const_iterator idx = other.index.find(othervar);
-	return other.index.end() != idx
-		and varseq.at(idx->second) == var
-		and (not check_type or is_equal(other, idx->second));
+	int idx = other.find_slot(othervar);
+	return 0 <= idx and (size_t) idx < other.varseq.size()
+		and varseq.at(idx) == var
+		and (not check_type or is_equal(other, idx));
 }
 
 bool Variables::is_well_typed() const
@@ -247,13 +247,14 @@ bool Variables::is_type(const Handle& h) const
 bool Variables::is_type(const Handle& var, const Handle& val) const
 {
 	// If not holding, then fail.
-	if (varset.end() == varset.find(var)) return false;
+	int slot = find_slot(var);
+	if (slot < 0) return false;
 
 	// If no type restrictions, then success.
-	VariableTypeMap::const_iterator tit = _typemap.find(var);
-	if (_typemap.end() == tit) return true;
+	const TypedVariableLink* tvl = _slot_decls[slot];
+	if (nullptr == tvl) return true;
 
-	return tit->second->is_type(val);
+	return tvl->is_type(val);
 }
 
 /**
@@ -266,12 +267,11 @@ bool Variables::is_type(Type gtype) const
 	if (1 != varseq.size()) return false;
 
 	// Are there any type restrictions?
-	const Handle& var = varseq[0];
-	VariableTypeMap::const_iterator tit = _typemap.find(var);
-	if (_typemap.end() == tit) return true;
+	const TypedVariableLink* tvl = _slot_decls[0];
+	if (nullptr == tvl) return true;
 
 	// There are type restrictions; do they match?
-	return tit->second->is_type(gtype);
+	return tvl->is_type(gtype);
 }
 
 /**
@@ -290,10 +290,11 @@ bool Variables::is_type(const HandleSeq& hseq) const
 	size_t len = hseq.size();
 	if (varset.size() != len) return false;
 
-	// Check the type restrictions.
+	// Check the type restrictions, slot by slot.
 	for (size_t i=0; i<len; i++)
 	{
-		if (not is_type(varseq[i], hseq[i])) return false;
+		const TypedVariableLink* tvl = _slot_decls[i];
+		if (tvl and not tvl->is_type(hseq[i])) return false;
 	}
 	return true;
 }
@@ -347,12 +348,32 @@ static const GlobInterval& default_interval(Type t)
 
 const GlobInterval Variables::get_interval(const Handle& var) const
 {
-	const auto& decl = _typemap.find(var);
+	int slot = find_slot(var);
 
-	if (decl == _typemap.end())
+	if (slot < 0)
 		return default_interval(var->get_type());
 
-	return decl->second->get_glob_interval();
+	return _slot_intervals[slot];
+}
+
+void Variables::init_index()
+{
+	FreeVariables::init_index();
+
+	size_t nslots = slots.size();
+	_slot_decls.assign(nslots, nullptr);
+	_slot_intervals.resize(nslots);
+	for (size_t i = 0; i < nslots; i++)
+	{
+		const auto& decl = _typemap.find(slots[i]);
+		if (decl == _typemap.end())
+		{
+			_slot_intervals[i] = default_interval(slots[i]->get_type());
+			continue;
+		}
+		_slot_decls[i] = decl->second.get();
+		_slot_intervals[i] = decl->second->get_glob_interval();
+	}
 }
 
 /* ================================================================= */
@@ -469,6 +490,7 @@ void Variables::extend(const Variables& vset)
 			varset.insert(h);
 		}
 	}
+	init_index();
 
 	// If either this or the other are ordered then the result is ordered
 	_ordered = _ordered or vset._ordered;
@@ -527,6 +549,7 @@ void Variables::extend_intersect(const Variables& vset)
 			}
 		}
 	}
+	init_index();
 
 	// If either this or the other are ordered then the result is ordered
 	_ordered = _ordered or vset._ordered;
@@ -71,6 +71,17 @@ struct Variables : public FreeVariables
 	/// Anchor, if present, else undefined.
 	Handle _anchor;
 
+	/// The type restriction and the glob interval of each slot (see
+	/// FreeVariables::slots), filled in by init_index(). The decl is
+	/// null if the variable is untyped; the _typemap keeps it alive.
+	std::vector<const TypedVariableLink*> _slot_decls;
+	std::vector<GlobInterval> _slot_intervals;
+
+	/// Rebuild the index and slots, and the two above. Must be called
+	/// after validate_vardecl() or unpack_vartype(), if those are used
+	/// directly.
+	virtual void init_index();
+
 	// Validate the variable decls
 	void validate_vardecl(const Handle&);
 	void validate_vardecl(const HandleSeq&);
@@ -22,6 +22,7 @@
  */
 
 #include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Trace.h>
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/LambdaLink.h>
 #include <opencog/atoms/core/NumberNode.h>
@@ -178,9 +179,9 @@ static bool is_outgoing_true(AtomSpace* scratch, const Handle& h)
 	// So make sure that the Atom is in the AtomSpace.
 	Handle hs(scratch->add_atom(h));
 	const HandleSeq& oset = hs->getOutgoingSet();
+	const TruthValuePtr want(TruthValue::TRUE_TV());
 	return std::all_of(oset.begin(), oset.end(),
-		[](const Handle& o)
-			{ return *o->getTruthValue() == *TruthValue::TRUE_TV(); });
+		[&want](const Handle& o) { return *o->getTruthValue() == *want; });
 }
 
 /// Perform the IsFalseLink check
@@ -190,9 +191,9 @@ static bool is_outgoing_false(AtomSpace* scratch, const Handle& h)
 	// So make sure that the Atom is in the AtomSpace.
 	Handle hs(scratch->add_atom(h));
 	const HandleSeq& oset = hs->getOutgoingSet();
+	const TruthValuePtr want(TruthValue::FALSE_TV());
 	return std::all_of(oset.begin(), oset.end(),
-		[](const Handle& o)
-			{ return *o->getTruthValue() == *TruthValue::FALSE_TV(); });
+		[&want](const Handle& o) { return *o->getTruthValue() == *want; });
 }
 
 static ValuePtr exec_or_eval(AtomSpace* as,
@@ -465,6 +466,12 @@ static bool crispy_eval_scratch(AtomSpace* as,
                                 AtomSpace* scratch,
                                 bool silent);
 
+static TruthValuePtr tv_eval_scratch(AtomSpace* as,
+                                     const Handle& evelnk,
+                                     AtomSpace* scratch,
+                                     bool silent,
+                                     bool& try_crispy);
+
 static bool crispy_maybe(AtomSpace* as,
                          const Handle& evelnk,
                          AtomSpace* scratch,
@@ -601,10 +608,15 @@ static bool crispy_maybe(AtomSpace* as,
 		return false;
 	}
 
+	// The definition is evaluated crisply, too, so that a crisp
+	// tree does not get turned into a TruthValue and back again.
+	if (DEFINED_PREDICATE_NODE == t)
+		return crispy_eval_scratch(as,
+			DefineLink::get_definition(evelnk), scratch, silent);
+
 	// A handful of link types that should be auto-converted into
 	// crisp truth values.
-	if (EVALUATION_LINK == t or
-	    DEFINED_PREDICATE_NODE == t)
+	if (EVALUATION_LINK == t)
 	{
 		TruthValuePtr tv(EvaluationLink::do_eval_scratch(as,
 		                 evelnk, scratch, silent));
@@ -626,6 +638,13 @@ static bool crispy_eval_scratch(AtomSpace* as,
 	if (not failed)
 		return tf;
 
+	// Anything else that has a truth value, such as a PutLink or a
+	// SatisfactionLink under an AndLink, is cut at one-half, the same
+	// way the EvaluationLinks are, above.
+	TruthValuePtr tvp(tv_eval_scratch(as, evelnk, scratch, silent, failed));
+	if (not failed and tvp)
+		return 0.5 < tvp->get_mean();
+
 	throwSyntaxException(silent,
 		"Either incorrect or not implemented yet. Cannot evaluate %s",
 		evelnk->to_string().c_str());
@@ -909,6 +928,8 @@ TruthValuePtr EvaluationLink::do_eval_scratch(AtomSpace* as,
                                               AtomSpace* scratch,
                                               bool silent)
 {
+	TRACE_SPAN("evaluate", evelnk);
+
 	// Try the probabilistic ones first, then the crispy ones.
 	bool fail;
 	TruthValuePtr tvp = tv_eval_scratch(as, evelnk, scratch,
@@ -168,7 +168,7 @@ ValuePtr ExecutionOutputLink::execute_once(AtomSpace* as, bool silent)
 	Handle sn(_outgoing[0]);
 	Handle args(_outgoing[1]);
 	Type snt = sn->get_type();
-	if (GROUNDED_SCHEMA_NODE == snt)
+	if (nameserver().isA(snt, GROUNDED_SCHEMA_NODE))
 	{
 		GroundedProcedureNodePtr gsn = GroundedProcedureNodeCast(sn);
 		return gsn->execute(as, args, silent);
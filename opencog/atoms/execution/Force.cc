@@ -50,18 +50,43 @@ using namespace opencog;
 ///
 Handle opencog::force_execute(AtomSpace* as, const Handle& cargs, bool silent)
 {
-	Instantiator inst(as);
-
 	if (LIST_LINK != cargs->get_type())
 	{
+		Instantiator inst(as);
 		Handle args(HandleCast(inst.execute(cargs, silent)));
 		if (nullptr != args and args != cargs)
 			args = as->add_atom(args);
 		return args;
 	}
 
-	Handle args(cargs);
 	HandleSeq new_oset;
+	if (force_execute(as, cargs, new_oset, silent))
+		return as->add_link(LIST_LINK, std::move(new_oset));
+	return cargs;
+}
+
+/// As above, but the arguments of the ListLink are handed back as
+/// they are, without being wrapped up in a new ListLink. Returns true
+/// if any of them changed. The ones that changed are in the AtomSpace;
+/// a single argument, not in a ListLink, is forced as such.
+bool opencog::force_execute(AtomSpace* as, const Handle& cargs,
+                            HandleSeq& new_oset, bool silent)
+{
+	Instantiator inst(as);
+
+	if (LIST_LINK != cargs->get_type())
+	{
+		Handle args(HandleCast(inst.execute(cargs, silent)));
+		if (nullptr == args) return true;
+		if (args == cargs)
+		{
+			new_oset.emplace_back(cargs);
+			return false;
+		}
+		new_oset.emplace_back(as->add_atom(args));
+		return true;
+	}
+
 	bool changed = false;
 	for (const Handle& ho : cargs->getOutgoingSet())
 	{
@@ -90,11 +115,41 @@ Handle opencog::force_execute(AtomSpace* as, const Handle& cargs, bool silent)
 		if (DONT_EXEC_LINK == nh->get_type())
 			nh = nh->getOutgoingAtom(0);
 
+		if (nh != ho)
+		{
+			nh = as->add_atom(nh);
+			changed = true;
+		}
 		new_oset.emplace_back(nh);
-		if (nh != ho) changed = true;
 	}
+	return changed;
+}
+
+/// As above, but the arguments are handed back as whatever they
+/// executed to, Atoms or not. Nothing is added to the AtomSpace;
+/// this is for C++ callees, which can take Values as they are.
+void opencog::force_execute(AtomSpace* as, const Handle& cargs,
+                            ValueSeq& new_oset, bool silent)
+{
+	Instantiator inst(as);
 
-	if (changed)
-		args = as->add_link(LIST_LINK, std::move(new_oset));
-	return args;
+	if (LIST_LINK != cargs->get_type())
+	{
+		ValuePtr vp(inst.execute(cargs, silent));
+		if (nullptr != vp) new_oset.emplace_back(vp);
+		return;
+	}
+
+	const HandleSeq& oset = cargs->getOutgoingSet();
+	new_oset.reserve(oset.size());
+	for (const Handle& ho : oset)
+	{
+		ValuePtr vp(inst.execute(ho, silent));
+		// vp might be NULL if ho was a DeleteLink
+		if (nullptr == vp) continue;
+
+		if (DONT_EXEC_LINK == vp->get_type())
+			vp = HandleCast(vp)->getOutgoingAtom(0);
+		new_oset.emplace_back(vp);
+	}
 }
@@ -33,6 +33,8 @@ namespace opencog
 
 // Handy-dandy utility function
 Handle force_execute(AtomSpace*, const Handle&, bool silent=false);
+bool force_execute(AtomSpace*, const Handle&, HandleSeq&, bool silent=false);
+void force_execute(AtomSpace*, const Handle&, ValueSeq&, bool silent=false);
 
 /** @}*/
 }
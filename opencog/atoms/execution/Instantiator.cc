@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <opencog/atoms/base/Trace.h>
+#include <opencog/atoms/core/CondLink.h>
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/LambdaLink.h>
 #include <opencog/atoms/core/PutLink.h>
@@ -62,6 +64,51 @@ static Handle beta_reduce(const Handle& expr, const GroundingMap& vmap)
 	return crud.substitute_nocheck(expr, vals);
 }
 
+/// Return INERT if walk_tree() would return `expr` itself, without
+/// substituting or executing anything, no matter what the groundings
+/// are. Return INERT_EVALUATABLE if, in addition, the walk would have
+/// passed through an evaluatable link, and NOT_INERT otherwise. This
+/// only holds in an unquoted context.
+char Instantiator::inertness(const Handle& expr) const
+{
+	const auto& it = _inert.find(expr);
+	if (_inert.end() != it) return it->second;
+
+	char rv = INERT;
+	Type t = expr->get_type();
+	if (expr->is_node())
+	{
+		if (VARIABLE_NODE == t or GLOB_NODE == t or
+		    DEFINED_SCHEMA_NODE == t)
+			rv = NOT_INERT;
+	}
+	else if (Quotation::is_quotation_type(t) or
+	         PUT_LINK == t or LAMBDA_LINK == t or DELETE_LINK == t or
+	         PREDICATE_FORMULA_LINK == t or DONT_EXEC_LINK == t or
+	         nameserver().isA(t, VIRTUAL_LINK) or
+	         nameserver().isA(t, EXECUTION_OUTPUT_LINK) or
+	         nameserver().isA(t, FUNCTION_LINK) or
+	         nameserver().isA(t, SATISFYING_LINK) or
+	         nameserver().isA(t, JOIN_LINK))
+	{
+		rv = NOT_INERT;
+	}
+	else
+	{
+		if (nameserver().isA(t, EVALUATABLE_LINK))
+			rv = INERT_EVALUATABLE;
+		for (const Handle& h : expr->getOutgoingSet())
+		{
+			char c = inertness(h);
+			if (NOT_INERT == c) { rv = NOT_INERT; break; }
+			if (INERT_EVALUATABLE == c) rv = INERT_EVALUATABLE;
+		}
+	}
+
+	_inert.emplace(expr, rv);
+	return rv;
+}
+
 /// Same as walk tree, except that it operates on a handle sequence,
 /// instead of a single handle. The returned result is in oset_results.
 /// Returns `true` if the results differ from the input, i.e. if the
@@ -230,6 +277,15 @@ Handle Instantiator::reduce_exout(const Handle& expr,
 Handle Instantiator::walk_tree(const Handle& expr,
                                Instate& ist) const
 {
+	// Nothing in here to substitute or to run; hand it back as it is.
+	// Walking it would have noted any evaluatable links on the way.
+	if (not ist._context.is_quoted())
+	{
+		char inert = inertness(expr);
+		if (INERT_EVALUATABLE == inert) ist._inside_evaluation = true;
+		if (NOT_INERT != inert) return expr;
+	}
+
 	Type t = expr->get_type();
 
 	// Store the current context so we can update it for subsequent
@@ -447,6 +503,24 @@ Handle Instantiator::walk_tree(const Handle& expr,
 	if (nameserver().isA(t, VIRTUAL_LINK))
 		return beta_reduce(expr, ist._varmap);
 
+	// The sequential connectives run their terms one at a time, and
+	// stop as soon as the outcome is known. Walking into them would
+	// execute every term, up front, including those that are never
+	// reached. Just plug in the groundings, and leave the rest to
+	// the evaluation.
+	if (SEQUENTIAL_AND_LINK == t or SEQUENTIAL_OR_LINK == t)
+		return beta_reduce(expr, ist._varmap);
+
+	// Likewise, plug groundings into the branch of a CondLink only
+	// once it is known to be taken.
+	if (COND_LINK == t and not ist._varmap.empty())
+	{
+		CondLinkPtr clp(CondLinkCast(expr));
+		if (clp)
+			return HandleCast(clp->execute(_as, ist._silent,
+				[&](const Handle& h) { return beta_reduce(h, ist._varmap); }));
+	}
+
 	// ExecutionOutputLinks
 	if (nameserver().isA(t, EXECUTION_OUTPUT_LINK))
 	{
@@ -556,6 +630,7 @@ ValuePtr Instantiator::instantiate(const Handle& expr,
 		throw InvalidParamException(TRACE_INFO,
 			"Asked to ground a null expression");
 
+	TRACE_SPAN("instantiate", expr);
 	Instate ist(varmap);
 	ist._inside_evaluation = false;
 	ist._silent = silent;
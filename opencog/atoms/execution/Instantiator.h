@@ -24,6 +24,8 @@
 #ifndef _OPENCOG_INSTANTIATOR_H
 #define _OPENCOG_INSTANTIATOR_H
 
+#include <unordered_map>
+
 #include <opencog/atomspace/AtomSpace.h>
 
 #include <opencog/atoms/core/Context.h>
@@ -130,6 +132,18 @@ private:
 	bool walk_sequence(HandleSeq&, const HandleSeq&,
 	                   Instate&) const;
 
+	/**
+	 * Subtrees that walk_tree() would hand back as they are, whatever
+	 * the groundings: those with no variables, globs, quotations or
+	 * executable links in them. Rewriting with the same implicand,
+	 * over and over, meets the same subtrees each time; remembering
+	 * which ones these are lets walk_tree() skip them, instead of
+	 * walking them all the way down, every time.
+	 */
+	enum Inertness : char { NOT_INERT, INERT, INERT_EVALUATABLE };
+	mutable std::unordered_map<Handle, char> _inert;
+	char inertness(const Handle&) const;
+
 	/// Substitute, but do not execute ExecutionOutputLinks
 	Handle reduce_exout(const Handle& exout,
 	                    Instate&) const;
@@ -0,0 +1,208 @@
+/*
+ * opencog/atoms/execution/QueryLog.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/LinkValue.h>
+#include <opencog/atoms/value/QueueValue.h>
+#include <opencog/atoms/value/StringValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "QueryLog.h"
+
+using namespace opencog;
+
+// The key that MeetLink and QueryLink look at, to decide whether to
+// gather search statistics; this is SearchStats::key(), which cannot
+// be reached from here, as the query engine is built on top of us.
+static const Handle& stats_key(void)
+{
+	static Handle key(createNode(PREDICATE_NODE, "*-query-stats-*"));
+	return key;
+}
+
+const Handle& QueryLog::key(void)
+{
+	static Handle key(createNode(PREDICATE_NODE, "*-slow-query-*"));
+	return key;
+}
+
+QueryLog& opencog::query_log(void)
+{
+	static QueryLog log;
+	return log;
+}
+
+ValuePtr QueryRecord::to_value(void) const
+{
+	ValuePtr st(stats);
+	if (nullptr == st) st = createLinkValue(ValueSeq());
+	return createLinkValue(ValueSeq({
+		createFloatValue(std::vector<double>(
+			{seconds, (double) results, (double) when})),
+		createStringValue(source),
+		st}));
+}
+
+// ==============================================================
+
+void QueryLog::enable(double threshold, size_t capacity, size_t sample)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_threshold = threshold;
+	_sample = sample;
+	_capacity = capacity;
+	while (_capacity < _records.size())
+	{
+		_records.pop_front();
+		_dropped++;
+	}
+	_on = true;
+}
+
+bool QueryLog::sample_this(void)
+{
+	size_t every = _sample.load(std::memory_order_relaxed);
+	if (0 == every) return false;
+	return 0 == _seen.fetch_add(1, std::memory_order_relaxed) % every;
+}
+
+void QueryLog::add(QueryRecord&& rec)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (0 == _capacity) { _dropped++; return; }
+	if (_capacity <= _records.size())
+	{
+		_records.pop_front();
+		_dropped++;
+	}
+	_records.emplace_back(std::move(rec));
+}
+
+std::vector<QueryRecord> QueryLog::records(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return std::vector<QueryRecord>(_records.begin(), _records.end());
+}
+
+size_t QueryLog::dropped(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _dropped;
+}
+
+void QueryLog::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_records.clear();
+	_dropped = 0;
+}
+
+HandleSeq QueryLog::export_to(AtomSpace* as)
+{
+	std::deque<QueryRecord> recs;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		recs.swap(_records);
+	}
+
+	HandleSet seen;
+	HandleSeq queries;
+	for (const QueryRecord& rec : recs)
+	{
+		Handle h(as->add_atom(rec.query));
+		if (nullptr == h) continue; // if read-only, then cannot update.
+
+		ValueSeq vs;
+		ValuePtr old(h->getValue(key()));
+		if (old and old->is_type(LINK_VALUE))
+			vs = LinkValueCast(old)->value();
+		vs.push_back(rec.to_value());
+		h = as->set_value(h, key(), createLinkValue(std::move(vs)));
+
+		if (seen.insert(h).second) queries.push_back(h);
+	}
+	return queries;
+}
+
+// ==============================================================
+
+// Queries return a QueueValue, or, in the older style, a SetLink.
+static size_t count_results(const ValuePtr& vp)
+{
+	if (nullptr == vp) return 0;
+	if (vp->is_type(QUEUE_VALUE))
+		return ((const QueueValue*) vp.get())->concurrent_queue<ValuePtr>::size();
+	if (vp->is_atom())
+	{
+		if (vp->is_type(SET_LINK)) return HandleCast(vp)->get_arity();
+		return 1;
+	}
+	return vp->size();
+}
+
+QueryProbe::QueryProbe(const Handle& query, const char* source)
+	: _on(query_log().is_enabled() and nullptr != query)
+{
+	if (not _on) return;
+
+	_query = query;
+	_source = source;
+
+	// Ask for search statistics, unless someone already has.
+	Type t = query->get_type();
+	NameServer& ns(nameserver());
+	if ((ns.isA(t, MEET_LINK) or ns.isA(t, QUERY_LINK)) and
+	    nullptr == query->getValue(stats_key()) and
+	    query_log().sample_this())
+	{
+		query->setValue(stats_key(), createLinkValue(ValueSeq()));
+		_added_key = true;
+	}
+
+	_start = std::chrono::steady_clock::now();
+}
+
+void QueryProbe::done(const ValuePtr& result)
+{
+	if (not _on) return;
+
+	double secs = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - _start).count();
+
+	ValuePtr stats(_query->getValue(stats_key()));
+	if (_added_key) _query->setValue(stats_key(), nullptr);
+
+	if (secs < query_log().threshold()) return;
+
+	QueryRecord rec;
+	rec.query = _query;
+	rec.source = _source;
+	rec.seconds = secs;
+	rec.results = count_results(result);
+	rec.when = time(nullptr);
+	rec.stats = stats;
+	query_log().add(std::move(rec));
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,146 @@
+/*
+ * opencog/atoms/execution/QueryLog.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_QUERY_LOG_H
+#define _OPENCOG_QUERY_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+class AtomSpace;
+
+/// One slow request.
+struct QueryRecord
+{
+	Handle query;
+	std::string source;   // The command or primitive that ran it
+	double seconds = 0.0;
+	size_t results = 0;
+	time_t when = 0;      // When it finished
+	ValuePtr stats;       // The search statistics, if they were gathered
+
+	/// The record, as
+	///
+	///    LinkValue
+	///       FloatValue seconds results when
+	///       StringValue source
+	///       <the stats, as in SearchStats::to_value(), or an empty LinkValue>
+	ValuePtr to_value(void) const;
+};
+
+/**
+ * A slow-query log, like that of a database: every request run through
+ * a QueryProbe that takes longer than the threshold is kept, with the
+ * query, the time it took, and the number of results. The log holds
+ * the latest `capacity` of them; older ones are dropped.
+ *
+ * Search statistics (see SearchStats) are gathered for one in every
+ * `sample` MeetLinks and QueryLinks that are run, whether or not they
+ * turn out to be slow; zero turns this off. Gathering them costs a
+ * few percent, and touches the query's Values for the duration.
+ *
+ * The log is off until enabled. Disabled, each probe costs one atomic
+ * load.
+ */
+class QueryLog
+{
+	std::atomic<bool> _on{false};
+	std::atomic<double> _threshold{0.0};
+	std::atomic<size_t> _sample{0};
+	std::atomic<size_t> _seen{0};
+
+	mutable std::mutex _mtx;
+	size_t _capacity = 0;
+	size_t _dropped = 0;
+	std::deque<QueryRecord> _records;
+
+	friend class QueryProbe;
+	bool sample_this(void);
+	void add(QueryRecord&&);
+
+public:
+	void enable(double threshold, size_t capacity = 100, size_t sample = 1);
+	void disable(void) { _on = false; }
+	bool is_enabled(void) const
+	{
+		return _on.load(std::memory_order_relaxed);
+	}
+	double threshold(void) const { return _threshold; }
+
+	/// The records kept, oldest first.
+	std::vector<QueryRecord> records(void) const;
+
+	/// The number of records dropped, to stay within capacity, since
+	/// the last clear().
+	size_t dropped(void) const;
+
+	void clear(void);
+
+	/// Move the records into the AtomSpace, for storage: each query is
+	/// added, and its records appended to the LinkValue at key(). The
+	/// log is emptied. Returns the queries, one each; pass them to
+	/// StorageNode::store_value() to save the records.
+	HandleSeq export_to(AtomSpace*);
+
+	/// The key under which export_to() places the records.
+	static const Handle& key(void);
+};
+
+/// The slow-query log of this process.
+QueryLog& query_log(void);
+
+/**
+ * Time one request, on behalf of the query log. Construct it just
+ * before running the query, and call done() with the result. Requests
+ * that throw are not logged.
+ */
+class QueryProbe
+{
+	bool _on;
+	bool _added_key = false;
+	Handle _query;
+	const char* _source;
+	std::chrono::steady_clock::time_point _start;
+
+public:
+	QueryProbe(const Handle& query, const char* source);
+	void done(const ValuePtr& result);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_QUERY_LOG_H
@@ -93,7 +93,8 @@ TruthValuePtr SetTVLink::evaluate(AtomSpace* as, bool silent)
 
 	// We cannot set TVs unless we are working with the unique
 	// version of the atom that sits in the AtomSpace!
-	Handle ah(as->get_atom(_outgoing[0]));
+	const Handle& oa(_outgoing[0]);
+	Handle ah(as == oa->getAtomSpace() ? oa : as->get_atom(oa));
 	if (ah)
 	{
 		ah->setTruthValue(tv);
@@ -92,9 +92,12 @@ ValuePtr SetValueLink::execute(AtomSpace* as, bool silent)
 	}
 
 	// We cannot set Values unless we are working with the unique
-	// version of the atom that sits in the AtomSpace!
-	Handle ah(as->get_atom(_outgoing[0]));
-	Handle ak(as->get_atom(_outgoing[1]));
+	// version of the atom that sits in the AtomSpace! Constant atoms
+	// and keys usually are that version already.
+	const Handle& oa(_outgoing[0]);
+	const Handle& ok(_outgoing[1]);
+	Handle ah(as == oa->getAtomSpace() ? oa : as->get_atom(oa));
+	Handle ak(as == ok->getAtomSpace() ? ok : as->get_atom(ok));
 	if (ah and ak)
 	{
 		ah->setValue(ak, pap);
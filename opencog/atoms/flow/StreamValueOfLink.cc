@@ -37,6 +37,9 @@ StreamValueOfLink::StreamValueOfLink(const HandleSeq&& oset, Type t)
 		throw InvalidParamException(TRACE_INFO,
 			"Expecting an StreamValueOfLink, got %s", tname.c_str());
 	}
+
+	if (2 != _outgoing.size())
+		throw SyntaxException(TRACE_INFO, "Expecting two atoms!");
 }
 
 // ---------------------------------------------------------------
@@ -45,20 +48,18 @@ StreamValueOfLink::StreamValueOfLink(const HandleSeq&& oset, Type t)
 /// indicated key.
 ValuePtr StreamValueOfLink::execute(AtomSpace* as, bool silent)
 {
-	size_t ary = _outgoing.size();
-	if (2 != ary)
-		throw SyntaxException(TRACE_INFO, "Expecting two atoms!");
-
 	// We cannot know the Value of the Atom unless we are
 	// working with the unique version that sits in the
 	// AtomSpace! It can happen, during evaluation e.g. of
 	// a PutLink, that we are given an Atom that is not in
 	// any AtomSpace. In this case, `as` will be a scratch
 	// space; we can add the Atom there, and things will
-	// trickle out properly in the end.
-	//
-	Handle ah(as->add_atom(_outgoing[0]));
-	Handle ak(as->add_atom(_outgoing[1]));
+	// trickle out properly in the end. Mostly, they are already
+	// there.
+	const Handle& oa(_outgoing[0]);
+	const Handle& ok(_outgoing[1]);
+	Handle ah(as == oa->getAtomSpace() ? oa : as->add_atom(oa));
+	Handle ak(as == ok->getAtomSpace() ? ok : as->add_atom(ok));
 
 	ValuePtr stream = ah->getValue(ak);
 	if (nullptr == stream)
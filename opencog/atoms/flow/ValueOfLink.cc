@@ -36,6 +36,9 @@ ValueOfLink::ValueOfLink(const HandleSeq&& oset, Type t)
 		throw InvalidParamException(TRACE_INFO,
 			"Expecting an ValueOfLink, got %s", tname.c_str());
 	}
+
+	if (VALUE_OF_LINK == t and 2 != _outgoing.size())
+		throw SyntaxException(TRACE_INFO, "Expecting two atoms!");
 }
 
 // ---------------------------------------------------------------
@@ -43,10 +46,6 @@ ValueOfLink::ValueOfLink(const HandleSeq&& oset, Type t)
 /// When executed, this will return the value at the indicated key.
 ValuePtr ValueOfLink::execute(AtomSpace* as, bool silent)
 {
-	size_t ary = _outgoing.size();
-	if (2 != ary)
-		throw SyntaxException(TRACE_INFO, "Expecting two atoms!");
-
 	// We cannot know the Value of the Atom unless we are
 	// working with the unique version that sits in the
 	// AtomSpace! It can happen, during evaluation e.g. of
@@ -55,8 +54,12 @@ ValuePtr ValueOfLink::execute(AtomSpace* as, bool silent)
 	// space; we can add the Atom there, and things will
 	// trickle out properly in the end.
 	//
-	Handle ah(as->add_atom(_outgoing[0]));
-	Handle ak(as->add_atom(_outgoing[1]));
+	// Usually, though, both are constants, already in the AtomSpace
+	// we are given; there is no need to look them up again.
+	const Handle& oa(_outgoing[0]);
+	const Handle& ok(_outgoing[1]);
+	Handle ah(as == oa->getAtomSpace() ? oa : as->add_atom(oa));
+	Handle ak(as == ok->getAtomSpace() ? ok : as->add_atom(ok));
 
 	ValuePtr pap = ah->getValue(ak);
 	if (pap) return pap;
@@ -47,9 +47,18 @@ SexprAST::SexprAST(const std::string& sexpr)
 	parse(sexpr);
 }
 
-void SexprAST::parse(const std::string& sexpr)
+SexprAST::SexprAST(Type t, const std::string& name)
+	: ForeignAST(t, name)
 {
-	size_t l = sexpr.find_first_not_of(" \t\n");
+	init();
+}
+
+static const char* WHITE = " \t\n";
+
+void SexprAST::parse(const std::string& str)
+{
+	std::string_view sexpr(str);
+	size_t l = sexpr.find_first_not_of(WHITE);
 	if (std::string::npos == l)
 	{
 		_name = "";
@@ -59,82 +68,82 @@ void SexprAST::parse(const std::string& sexpr)
 	// Look to see if it is a simple literal.
 	if ('(' != sexpr[l])
 	{
-		// If its a literal, we are done.
-		size_t r = sexpr.find_first_of(" \t\n", l);
-		if (std::string::npos == r)
-		{
-			_name = sexpr.substr(l);
-			return;
-		}
-
-		size_t l2 = sexpr.find_first_not_of(" \t\n", r+1);
-		if (std::string::npos == l2)
+		size_t r = sexpr.find_first_of(WHITE, l);
+		if (std::string::npos == r or
+		    std::string::npos == sexpr.find_first_not_of(WHITE, r))
 		{
 			_name = sexpr.substr(l, r-l);
 			return;
 		}
+		throw SyntaxException(TRACE_INFO,
+			"Expecting a single literal or a list, got \"%s\"", str.c_str());
 	}
 
 	// If we are here, l points to the open-paren.
-	l++; // step past open-paren
-	size_t r = 0;
-	while (std::string::npos != r)
-	{
-		Handle h(get_next_expr(sexpr, l, r));
-		_outgoing.emplace_back(h);
-	}
+	l++;
+	_outgoing = parse_list(sexpr, l);
 }
 
 // ---------------------------------------------------------------
 
-Handle SexprAST::get_next_expr(const std::string& sexpr, size_t& l, size_t &r)
+/// Parse the contents of a list, starting just past its open-paren,
+/// and return them. On return, `pos` is just past the matching
+/// close-paren; anything after that is left alone.
+///
+/// This is done in a single pass, with a stack of the lists still
+/// open, rather than by recursion, so that deeply nested expressions
+/// cannot blow the C stack. Each token becomes a leaf directly, and
+/// each finished list is moved into the Link holding it.
+HandleSeq SexprAST::parse_list(std::string_view sexpr, size_t& pos)
 {
-	l = sexpr.find_first_not_of(" \t\n", l);
-	if (std::string::npos == l)
-		throw SyntaxException(TRACE_INFO, "Unexpected blank line");
+	std::vector<HandleSeq> open;
+	open.emplace_back();
 
-	// If another opening paren, recurse
-	if ('(' == sexpr[l])
+	while (true)
 	{
-		l++; // step past open-paren
-		HandleSeq oset;
-		while (std::string::npos != r)
+		pos = sexpr.find_first_not_of(WHITE, pos);
+		if (std::string::npos == pos)
 		{
-			Handle h(get_next_expr(sexpr, l, r));
-			oset.emplace_back(h);
+			if (1 == open.size() and open.back().empty())
+				throw SyntaxException(TRACE_INFO, "Unexpected blank line");
+			throw SyntaxException(TRACE_INFO,
+				"Failed to find closing parenthesis");
 		}
 
-		// l will be pointing at the trailing paren, so move past that.
-		l++;
-		l = sexpr.find_first_not_of(" \t\n", l);
-		r = 0;
-		if (')' == sexpr[l]) r = std::string::npos;
-		return HandleCast(createSexprAST(std::move(oset)));
-	}
+		if ('(' == sexpr[pos])
+		{
+			open.emplace_back();
+			pos++;
+			continue;
+		}
 
-	// If its a literal, we are done.
-	r = sexpr.find_first_of(" \t\n)", l);
-	if (std::string::npos == r)
-		throw SyntaxException(TRACE_INFO, "Failed to find closing parenthesis");
+		if (')' == sexpr[pos])
+		{
+			pos++;
 
-	// Found the closing paren; just wrap the string.
-	if (')' == sexpr[r])
-	{
-		const std::string& tok = sexpr.substr(l, r-l);
-		l = sexpr.find_first_not_of(" \t\n", r);
-		r = std::string::npos;
-		return HandleCast(createSexprAST(tok));
-	}
+			// An empty list holds one blank literal.
+			HandleSeq& oset(open.back());
+			if (oset.empty())
+				oset.emplace_back(createSexprAST(SEXPR_AST, ""));
+
+			if (1 == open.size())
+				return std::move(oset);
 
-	// If we are here, r points to whitespace, and l points to the first
-	// thing after the initial opening paren.
-	while ('(' == sexpr[r-1]) r--;
-	const std::string& tok = sexpr.substr(l, r-l);
-	l = sexpr.find_first_not_of(" \t\n", r);
-	if (')' == sexpr[l])
-		r = std::string::npos;
+			Handle h(createSexprAST(std::move(oset)));
+			open.pop_back();
+			open.back().emplace_back(h);
+			continue;
+		}
 
-	return HandleCast(createSexprAST(tok));
+		size_t end = sexpr.find_first_of(" \t\n()", pos);
+		if (std::string::npos == end)
+			throw SyntaxException(TRACE_INFO,
+				"Failed to find closing parenthesis");
+
+		open.back().emplace_back(createSexprAST(SEXPR_AST,
+			std::string(sexpr.substr(pos, end-pos))));
+		pos = end;
+	}
 }
 
 // ---------------------------------------------------------------
@@ -23,6 +23,8 @@
 #ifndef _OPENCOG_SEXPR_AST_H
 #define _OPENCOG_SEXPR_AST_H
 
+#include <string_view>
+
 #include <opencog/atoms/foreign/ForeignAST.h>
 
 namespace opencog
@@ -39,7 +41,7 @@ class SexprAST : public ForeignAST
 	void init();
 	void parse(const std::string&);
 
-	static Handle get_next_expr(const std::string&, size_t& l, size_t& r);
+	static HandleSeq parse_list(std::string_view, size_t& pos);
 
 	virtual ContentHash compute_hash() const;
 
@@ -50,6 +52,9 @@ public:
 
 	SexprAST(const std::string&);
 
+	/// A literal; the name is taken as-is, without being parsed.
+	SexprAST(Type, const std::string&);
+
 	virtual std::string to_string(const std::string& indent) const;
 	virtual std::string to_short_string(const std::string& indent) const;
 
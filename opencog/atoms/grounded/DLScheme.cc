@@ -21,6 +21,7 @@
  */
 
 #include <dlfcn.h>
+#include <atomic>
 #include <mutex>
 #include <opencog/util/exceptions.h>
 #include "DLScheme.h"
@@ -30,8 +31,11 @@ using namespace opencog;
 SchemeEval* opencog::get_evaluator_for_scheme(AtomSpace* as)
 {
 	typedef SchemeEval* (*SEGetter)(AtomSpace*);
-	static SEGetter getter = nullptr;
-	if (getter) return getter(as);
+	static std::atomic<SEGetter> getter(nullptr);
+
+	// Once loaded, this is the only thing done on each call.
+	SEGetter get = getter.load(std::memory_order_acquire);
+	if (get) return get(as);
 
 	static std::mutex mtx;
 	std::lock_guard<std::mutex> lock(mtx);
@@ -44,16 +48,17 @@ SchemeEval* opencog::get_evaluator_for_scheme(AtomSpace* as)
 			dlerror());
 
 	static void* getev = nullptr;
-	if (nullptr == getev) getev = dlsym(library, "get_scheme_evaluator");
+	if (nullptr == getev)
+		getev = dlsym(library, "get_grounded_scheme_evaluator");
 	if (nullptr == getev)
 		throw RuntimeException(TRACE_INFO,
 			"Unable to dynamically load scheme evaluator: %s",
 			dlerror());
 
-	// static SEGetter getter = std::reinterpret_cast<SEGetter>(getev);
-	getter = (SEGetter) getev;
+	get = (SEGetter) getev;
+	getter.store(get, std::memory_order_release);
 
-	return getter(as);
+	return get(as);
 }
 
 static __attribute__ ((destructor)) void fini(void)
@@ -27,6 +27,8 @@
 
 namespace opencog
 {
+// The per-thread evaluator for grounded functions; see
+// SchemeEval::get_grounded_evaluator().
 SchemeEval* get_evaluator_for_scheme(AtomSpace*);
 }
 
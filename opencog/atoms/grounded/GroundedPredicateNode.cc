@@ -22,6 +22,7 @@
  */
 
 #include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Trace.h>
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/NumberNode.h>
 #include <opencog/atoms/execution/Force.h>
@@ -204,6 +205,7 @@ ValuePtr GroundedPredicateNode::execute(AtomSpace* as,
                                         const Handle& cargs,
                                         bool silent)
 {
+	TRACE_SPAN("evaluate grounded", this);
 	if (_runner) return _runner->evaluate(as, cargs, silent);
 
 	// XXX FIXME -- can we get rid of the stuff from here on down?
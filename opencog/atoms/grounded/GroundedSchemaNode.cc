@@ -21,7 +21,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
 #include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Trace.h>
 #include <opencog/atomspace/AtomSpace.h>
 
 #include "GroundedSchemaNode.h"
@@ -31,6 +36,64 @@
 
 using namespace opencog;
 
+/// How many results a PureSchemaNode remembers.
+#define MEMO_SIZE 1024
+
+/// The most recent results, keyed by the content of the arguments;
+/// the least-recently used one is dropped when full.  Results are
+/// kept for one AtomSpace at a time; a call made in a different one
+/// starts over.
+struct GroundedSchemaNode::Memo
+{
+	typedef std::list<std::pair<Handle, ValuePtr>> Lru;
+
+	std::mutex mtx;
+	AtomSpace* as = nullptr;
+	Lru lru;
+	std::unordered_map<Handle, Lru::iterator> index;
+
+	bool find(AtomSpace* spc, const Handle& args, ValuePtr& vp)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if (spc != as) return false;
+		auto it = index.find(args);
+		if (index.end() == it) return false;
+		lru.splice(lru.begin(), lru, it->second);
+		vp = it->second->second;
+		return true;
+	}
+
+	void insert(AtomSpace* spc, const Handle& args, const ValuePtr& vp)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if (spc != as)
+		{
+			index.clear();
+			lru.clear();
+			as = spc;
+		}
+		if (index.end() != index.find(args)) return;
+		lru.emplace_front(args, vp);
+		index.emplace(args, lru.begin());
+		if (MEMO_SIZE < lru.size())
+		{
+			index.erase(lru.back().first);
+			lru.pop_back();
+		}
+	}
+};
+
+/// Arguments that are executable may have a different value every
+/// time; results for them are not remembered.
+static bool is_constant(const Handle& h)
+{
+	if (h->is_executable()) return false;
+	if (h->is_node()) return true;
+	for (const Handle& ho : h->getOutgoingSet())
+		if (not is_constant(ho)) return false;
+	return true;
+}
+
 GroundedSchemaNode::GroundedSchemaNode(std::string s)
 	: GroundedProcedureNode(GROUNDED_SCHEMA_NODE, std::move(s))
 {
@@ -52,6 +115,9 @@ GroundedSchemaNode::GroundedSchemaNode(Type t, std::string s)
 void GroundedSchemaNode::init()
 {
 	_runner = nullptr;
+	_memo = nullptr;
+	if (nameserver().isA(get_type(), PURE_SCHEMA_NODE))
+		_memo = new Memo();
 
 	// Get the schema name.
 	const std::string& schema = get_name();
@@ -91,6 +157,7 @@ void GroundedSchemaNode::init()
 GroundedSchemaNode::~GroundedSchemaNode()
 {
 	if (_runner) delete _runner;
+	if (_memo) delete _memo;
 }
 
 /// execute -- execute the SchemaNode of the ExecutionOutputLink
@@ -105,6 +172,16 @@ ValuePtr GroundedSchemaNode::execute(AtomSpace* as,
 	LAZY_LOG_FINE << "Execute gsn: " << to_short_string()
 	              << "with arguments: " << oc_to_string(cargs);
 
+	TRACE_SPAN("execute grounded", this);
+	if (_runner and _memo and is_constant(cargs))
+	{
+		ValuePtr vp;
+		if (_memo->find(as, cargs, vp)) return vp;
+		vp = _runner->execute(as, cargs, silent);
+		_memo->insert(as, cargs, vp);
+		return vp;
+	}
+
 	if (_runner) return _runner->execute(as, cargs, silent);
 
 	// Unknown procedure type
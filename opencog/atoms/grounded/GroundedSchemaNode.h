@@ -41,6 +41,10 @@ class GroundedSchemaNode : public GroundedProcedureNode
 	Runner* _runner;
 	void init();
 
+	// Recent results, for PureSchemaNodes only.
+	struct Memo;
+	Memo* _memo;
+
 public:
 	GroundedSchemaNode(Type, const std::string);
 	GroundedSchemaNode(const std::string);
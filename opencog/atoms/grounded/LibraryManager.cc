@@ -28,20 +28,33 @@ using namespace opencog;
 
 std::unordered_map<std::string, void*> LibraryManager::_librarys;
 std::unordered_map<std::string, void*> LibraryManager::_functions;
+std::unordered_map<std::string, LibraryManager::ABI> LibraryManager::_abis;
 
-void LibraryManager::setLocalFunc(std::string libName, std::string funcName, void* func)
+void LibraryManager::setLocalFunc(const std::string& libName,
+                                  const std::string& funcName,
+                                  void* func, ABI abi)
 {
-	if (_librarys.count(libName) == 0) {
-		_librarys[libName] = NULL;
-	}
+	_librarys.emplace(libName, nullptr);
 	std::string funcID = libName + "\\" + funcName;
 	_functions[funcID] = func;
+	if (HANDLE == abi) _abis.erase(funcID);
+	else _abis[funcID] = abi;
 }
 
-void* LibraryManager::getFunc(std::string libName, std::string funcName)
+LibraryManager::ABI LibraryManager::getABI(const std::string& libName,
+                                           const std::string& funcName)
+{
+	auto it = _abis.find(libName + "\\" + funcName);
+	if (_abis.end() == it) return HANDLE;
+	return it->second;
+}
+
+void* LibraryManager::getFunc(const std::string& libName,
+                              const std::string& funcName)
 {
 	void* libHandle;
-	if (_librarys.count(libName) == 0) {
+	auto lit = _librarys.find(libName);
+	if (_librarys.end() == lit) {
 		// Try and load the library and function.
 		libHandle = dlopen(libName.c_str(), RTLD_LAZY);
 		if (nullptr == libHandle)
@@ -50,24 +63,21 @@ void* LibraryManager::getFunc(std::string libName, std::string funcName)
 		_librarys[libName] = libHandle;
 	}
 	else {
-		libHandle = _librarys[libName];
+		libHandle = lit->second;
 	}
 
 	std::string funcID = libName + "\\" + funcName;
 
-	void* sym;
-	if (_functions.count(funcID) == 0){
-		sym = dlsym(libHandle, funcName.c_str());
-		if (nullptr == sym)
-			throw RuntimeException(TRACE_INFO,
-			                       "Cannot find symbol %s in library: %s - %s",
-			                       funcName.c_str(), libName.c_str(), dlerror());
-		_functions[funcID] = sym;
-	}
-	else {
-		sym = _functions[funcID];
-	}
+	auto fit = _functions.find(funcID);
+	if (_functions.end() != fit)
+		return fit->second;
 
+	void* sym = dlsym(libHandle, funcName.c_str());
+	if (nullptr == sym)
+		throw RuntimeException(TRACE_INFO,
+		                       "Cannot find symbol %s in library: %s - %s",
+		                       funcName.c_str(), libName.c_str(), dlerror());
+	_functions[funcID] = sym;
 	return sym;
 }
 
@@ -111,3 +121,23 @@ void opencog::setLocalPredicate(std::string funcName,
 {
    LibraryManager::setLocalFunc("", funcName, reinterpret_cast<void*>(func));
 }
+
+void opencog::setLocalSchemaDirect(const std::string& funcName,
+                                   ValuePtr (*func)(AtomSpace *, const HandleSeq&))
+{
+	LibraryManager::setLocalFunc("", funcName,
+		reinterpret_cast<void*>(func), LibraryManager::SEQ);
+}
+
+void opencog::setLocalPredicateDirect(const std::string& funcName,
+                                      TruthValuePtr (*func)(AtomSpace *, const HandleSeq&))
+{
+	LibraryManager::setLocalFunc("", funcName,
+		reinterpret_cast<void*>(func), LibraryManager::SEQ);
+}
+
+void opencog::setLocalSpan(const std::string& funcName,
+                           LibraryManager::SpanFunc func)
+{
+	LibraryManager::setLocalFunc("", funcName, func);
+}
@@ -23,17 +23,45 @@
 #ifndef _OPENCOG_LIBRARAY_MANAGER_H
 #define _OPENCOG_LIBRARAY_MANAGER_H
 
+
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/atomspace/AtomSpace.h>
 
 class LibraryManager
 {
+public:
+	/// How a function wants to be called.
+	/// `HANDLE` -- `Handle* f(AtomSpace*, Handle*)`, with the arguments
+	///     in a ListLink, and the result malloc'ed. Anything found with
+	///     dlsym() is assumed to be of this kind.
+	/// `SEQ` -- `ValuePtr f(AtomSpace*, const HandleSeq&)`, or returning
+	///     a TruthValuePtr, for predicates.
+	/// `SPAN` -- `ValuePtr f(AtomSpace*, const ValuePtr* args, size_t n)`.
+	///     The arguments are whatever they executed to, Atoms or not;
+	///     they are not added to the AtomSpace.
+	enum ABI { HANDLE, SEQ, SPAN };
+
+	typedef opencog::ValuePtr (*SpanFunc)(opencog::AtomSpace*,
+	                                     const opencog::ValuePtr*, size_t);
+
 private:
 	static std::unordered_map<std::string, void*> _librarys;
 	static std::unordered_map<std::string, void*> _functions;
+	static std::unordered_map<std::string, ABI> _abis;
 public:
-	static void* getFunc(std::string libName,std::string funcName);
-	static void setLocalFunc(std::string libName, std::string funcName, void* func);
+	static void* getFunc(const std::string& libName,
+	                     const std::string& funcName);
+	static void setLocalFunc(const std::string& libName,
+	                         const std::string& funcName, void* func,
+	                         ABI abi = HANDLE);
+	static void setLocalFunc(const std::string& libName,
+	                         const std::string& funcName, SpanFunc func)
+	{
+		setLocalFunc(libName, funcName, reinterpret_cast<void*>(func), SPAN);
+	}
+
+	static ABI getABI(const std::string& libName,
+	                  const std::string& funcName);
 
 	/**
 	 * Given a grounded schema name like "py: foo", extract
@@ -65,5 +93,23 @@ void setLocalPredicate(std::string funcName,
  */
 void setLocalSchema(std::string funcName,
                     Handle* (*func)(AtomSpace *, Handle*));
+
+/**
+ * As above, but the function is called directly with the arguments,
+ * after forcing, with no ListLink built around them, and nothing to
+ * be malloc'ed for the result.
+ */
+void setLocalSchemaDirect(const std::string& funcName,
+                          ValuePtr (*func)(AtomSpace *, const HandleSeq&));
+void setLocalPredicateDirect(const std::string& funcName,
+                             TruthValuePtr (*func)(AtomSpace *, const HandleSeq&));
+
+/**
+ * As above, but the arguments are handed over as an array of Values,
+ * as they came out of execution, and need not be Atoms. This is the
+ * cheapest way to call out to C++. For schemas, the result is returned
+ * as is; for predicates, it should be a TruthValue.
+ */
+void setLocalSpan(const std::string& funcName, LibraryManager::SpanFunc func);
 };
 #endif //_OPENCOG_LIBRARAY_MANAGER_H
@@ -40,6 +40,7 @@ LibraryRunner::LibraryRunner(std::string s)
 	LibraryManager::parse_schema(_fname, lang, lib, fun);
 
 	sym = LibraryManager::getFunc(lib,fun);
+	_abi = LibraryManager::getABI(lib,fun);
 }
 
 // ----------------------------------------------------------
@@ -56,6 +57,20 @@ static void throwSyntaxException(bool silent, const char* message...)
 
 // ----------------------------------------------------------
 
+ValuePtr LibraryRunner::call_span(AtomSpace* as,
+                                  const Handle& cargs,
+                                  bool silent)
+{
+	ValueSeq args;
+	force_execute(as, cargs, args, silent);
+
+	LibraryManager::SpanFunc func =
+		reinterpret_cast<LibraryManager::SpanFunc>(sym);
+	return func(as, args.data(), args.size());
+}
+
+// ----------------------------------------------------------
+
 /// `execute()` -- evaluate a LibraryRunner with arguments.
 ///
 /// Expects "args" to be a ListLink. These arguments will be
@@ -75,6 +90,34 @@ ValuePtr LibraryRunner::execute(AtomSpace* as,
 	// to do lazy execution correctly. Right now, forcing is the policy.
 	// We could add "scm-lazy:" and "py-lazy:" URI's for user-defined
 	// functions smart enough to do lazy evaluation.
+	if (LibraryManager::SPAN == _abi)
+	{
+		ValuePtr result(call_span(as, cargs, silent));
+		if (nullptr == result)
+			throwSyntaxException(silent,
+			    "Invalid return value from grounded schema %s\nArgs: %s",
+			        _fname.c_str(),
+			        cargs->to_short_string().c_str());
+		return result;
+	}
+
+	if (LibraryManager::SEQ == _abi)
+	{
+		HandleSeq args;
+		force_execute(as, cargs, args, silent);
+
+		ValuePtr (*func)(AtomSpace*, const HandleSeq&);
+		func = reinterpret_cast<ValuePtr (*)(AtomSpace*, const HandleSeq&)>(sym);
+
+		ValuePtr result(func(as, args));
+		if (nullptr == result)
+			throwSyntaxException(silent,
+			    "Invalid return value from grounded schema %s\nArgs: %s",
+			        _fname.c_str(),
+			        cargs->to_short_string().c_str());
+		return result;
+	}
+
 	Handle args(force_execute(as, cargs, silent));
 
 	// Convert the void* pointer to the correct function type.
@@ -109,6 +152,34 @@ ValuePtr LibraryRunner::evaluate(AtomSpace* as,
 	// to do lazy execution correctly. Right now, forcing is the policy.
 	// We could add "scm-lazy:" and "py-lazy:" URI's for user-defined
 	// functions smart enough to do lazy evaluation.
+	if (LibraryManager::SPAN == _abi)
+	{
+		ValuePtr result(call_span(as, cargs, silent));
+		if (nullptr == result or not result->is_type(TRUTH_VALUE))
+			throwSyntaxException(silent,
+			    "Invalid return value from grounded predicate %s\nArgs: %s",
+			        _fname.c_str(),
+			        cargs->to_short_string().c_str());
+		return result;
+	}
+
+	if (LibraryManager::SEQ == _abi)
+	{
+		HandleSeq args;
+		force_execute(as, cargs, args, silent);
+
+		TruthValuePtr (*func)(AtomSpace*, const HandleSeq&);
+		func = reinterpret_cast<TruthValuePtr (*)(AtomSpace*, const HandleSeq&)>(sym);
+
+		TruthValuePtr result(func(as, args));
+		if (nullptr == result)
+			throwSyntaxException(silent,
+			    "Invalid return value from grounded predicate %s\nArgs: %s",
+			        _fname.c_str(),
+			        cargs->to_short_string().c_str());
+		return CastToValue(result);
+	}
+
 	Handle args(force_execute(as, cargs, silent));
 
 	// Convert the void* pointer to the correct function type.
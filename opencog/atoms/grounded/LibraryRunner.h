@@ -25,6 +25,7 @@
 #define _OPENCOG_LIBRARY_RUNNER_H
 
 #include <string>
+#include <opencog/atoms/grounded/LibraryManager.h>
 #include <opencog/atoms/grounded/Runner.h>
 
 namespace opencog
@@ -40,6 +41,11 @@ class LibraryRunner : public Runner
 	std::string _fname;
 	void* sym;
 
+	// How the function wants to be called.
+	LibraryManager::ABI _abi;
+
+	ValuePtr call_span(AtomSpace*, const Handle&, bool);
+
 public:
 	LibraryRunner(const std::string);
 	LibraryRunner(const LibraryRunner&) = delete;
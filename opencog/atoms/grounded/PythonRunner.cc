@@ -34,7 +34,7 @@
 using namespace opencog;
 
 PythonRunner::PythonRunner(std::string s)
-	: _fname(s)
+	: _fname(s), _func(nullptr)
 {
 }
 
@@ -59,11 +59,7 @@ ValuePtr PythonRunner::execute(AtomSpace* as,
 	// to do lazy execution correctly. Right now, forcing is the policy.
 	// We could add "scm-lazy:" and "py-lazy:" URI's for user-defined
 	// functions smart enough to do lazy evaluation.
-	Handle args(force_execute(as, cargs, silent));
-
-	PythonEval* applier = get_evaluator_for_python(as);
-
-	return applier->apply_v(as, _fname, args);
+	return apply(as, cargs, silent);
 }
 
 ValuePtr PythonRunner::evaluate(AtomSpace* as,
@@ -75,9 +71,35 @@ ValuePtr PythonRunner::evaluate(AtomSpace* as,
 	// to do lazy execution correctly. Right now, forcing is the policy.
 	// We could add "scm-lazy:" and "py-lazy:" URI's for user-defined
 	// functions smart enough to do lazy evaluation.
-	Handle args(force_execute(as, cargs, silent));
+	return CastToValue(TruthValueCast(apply(as, cargs, silent)));
+}
+
+// ----------------------------------------------------------
 
+/// Force the arguments, and call the python function on them.
+///
+/// The arguments in a ListLink are handed over as they are, without
+/// being wrapped up in a new ListLink first, to a function that was
+/// looked up only once. Anything else is forced as a whole, and goes
+/// by name, as before, so that the result must be a ListLink.
+ValuePtr PythonRunner::apply(AtomSpace* as,
+                             const Handle& cargs,
+                             bool silent)
+{
 	PythonEval* applier = get_evaluator_for_python(as);
 
-	return CastToValue(applier->apply_tv(as, _fname, args));
+	if (LIST_LINK != cargs->get_type())
+		return applier->apply_v(as, _fname,
+			force_execute(as, cargs, silent));
+
+	HandleSeq args;
+	force_execute(as, cargs, args, silent);
+
+	void* func = _func.load(std::memory_order_acquire);
+	if (nullptr == func)
+	{
+		func = applier->lookup_function(_fname);
+		_func.store(func, std::memory_order_release);
+	}
+	return applier->apply_function(as, func, args);
 }
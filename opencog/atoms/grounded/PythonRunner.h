@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_PYTHON_RUNNER_H
 #define _OPENCOG_PYTHON_RUNNER_H
 
+#include <atomic>
 #include <string>
 #include <opencog/atoms/grounded/Runner.h>
 
@@ -33,11 +34,19 @@ namespace opencog
  *  @{
  */
 
+class PythonEval;
+
 /// Base class for executing Python code.
 class PythonRunner : public Runner
 {
 	std::string _fname;
 
+	// The python function, once it has been looked up; see
+	// PythonEval::lookup_function(). Null until then.
+	std::atomic<void*> _func;
+
+	ValuePtr apply(AtomSpace*, const Handle&, bool);
+
 public:
 	PythonRunner(const std::string);
 	PythonRunner(const PythonRunner&) = delete;
@@ -32,7 +32,7 @@
 using namespace opencog;
 
 SCMRunner::SCMRunner(std::string s)
-	: _fname(s)
+	: _fname(s), _proc(nullptr)
 {
 }
 
@@ -70,7 +70,17 @@ ValuePtr SCMRunner::execute(AtomSpace* as,
 	Handle args(force_execute(as, cargs, silent));
 
 	SchemeEval* applier = get_evaluator_for_scheme(as);
-	ValuePtr vp = applier->apply_v(_fname, args);
+
+	// Look up the procedure the first time; after that, call it
+	// directly. If it is not defined yet, keep trying by name, so
+	// that the error message is the usual one.
+	void* proc = _proc.load(std::memory_order_acquire);
+	if (nullptr == proc)
+	{
+		proc = applier->lookup_procedure(_fname);
+		if (proc) _proc.store(proc, std::memory_order_release);
+	}
+	ValuePtr vp = applier->apply_proc(proc, _fname, args);
 
 	// Hmmm... well, a bad scheme function can end up returning a
 	// null pointer. We can convert this to a VoidValue... or we
@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_SCM_RUNNER_H
 #define _OPENCOG_SCM_RUNNER_H
 
+#include <atomic>
 #include <string>
 #include <opencog/atoms/grounded/Runner.h>
 
@@ -38,6 +39,10 @@ class SCMRunner : public Runner
 {
 	std::string _fname;
 
+	// The scheme procedure, once it has been looked up; see
+	// SchemeEval::lookup_procedure(). Null until then.
+	std::atomic<void*> _proc;
+
 public:
 	SCMRunner(const std::string);
 	SCMRunner(const SCMRunner&) = delete;
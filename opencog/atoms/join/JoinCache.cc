@@ -0,0 +1,552 @@
+/*
+ * opencog/atoms/join/JoinCache.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/core/FreeVariables.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "JoinCache.h"
+
+using namespace opencog;
+
+/* ================================================================= */
+
+JoinCache::JoinCache(JoinLink* jl, AtomSpace* as) :
+	_join(jl), _as(as), _type(jl->get_type()),
+	_local(jl->_top_clauses.empty()), _any_type(false),
+	_stale(true), _rebuilds(0), _busy(false)
+{
+	setup_principals();
+
+	// Listen first, so that nothing is missed; changes made while
+	// the first build runs are queued up, until it is done.
+	_add_sig = as->atomAddedSignal().connect(
+		[this](const Handle& h) { changed(h, true); });
+	_remove_sig = as->atomRemovedSignal().connect(
+		[this](const Handle& h) { changed(h, false); });
+	_adds_sig = as->atomsAddedSignal().connect(
+		[this](const HandleSeq& hs) { changed(hs, true); });
+	_removes_sig = as->atomsRemovedSignal().connect(
+		[this](const HandleSeq& hs) { changed(hs, false); });
+
+	try
+	{
+		std::unique_lock<std::mutex> lck(_mtx);
+		refresh(lck);
+	}
+	catch (...)
+	{
+		as->atomAddedSignal().disconnect(_add_sig);
+		as->atomRemovedSignal().disconnect(_remove_sig);
+		as->atomsAddedSignal().disconnect(_adds_sig);
+		as->atomsRemovedSignal().disconnect(_removes_sig);
+		throw;
+	}
+}
+
+JoinCache::~JoinCache()
+{
+	_as->atomAddedSignal().disconnect(_add_sig);
+	_as->atomRemovedSignal().disconnect(_remove_sig);
+	_as->atomsAddedSignal().disconnect(_adds_sig);
+	_as->atomsRemovedSignal().disconnect(_removes_sig);
+}
+
+/* ================================================================= */
+
+/// Work out which changes might change what the MeetLink finds.
+void JoinCache::setup_principals(void)
+{
+	// No variables; the principal elements are the constant terms,
+	// and nothing else.
+	const Handle& meet = _join->_meet;
+	if (nullptr == meet) return;
+
+	const HandleSet& varset = _join->_variables.varset;
+	const HandleSeq& clauses = meet->getOutgoingAtom(1)->getOutgoingSet();
+
+	// Variables found in PresentLinks are grounded by the Atoms that
+	// the PresentLinks are grounded by, or, if they stand alone, by
+	// any Atom of the right type.
+	HandleSet present;
+	for (const Handle& cl : clauses)
+	{
+		if (PRESENT_LINK != cl->get_type()) continue;
+		for (const Handle& term : cl->getOutgoingSet())
+		{
+			if (varset.end() != varset.find(term))
+			{
+				_bare.push_back(term);
+				present.insert(term);
+				continue;
+			}
+			collect(term);
+			FreeVariables fv;
+			fv.find_variables(term);
+			present.merge(fv.varset);
+		}
+	}
+
+	// Anything else is evaluated, and the variables in it had better
+	// be grounded by the above, or else they could be anything at all.
+	for (const Handle& cl : clauses)
+	{
+		if (PRESENT_LINK == cl->get_type()) continue;
+		collect(cl);
+		FreeVariables fv;
+		fv.find_variables(cl);
+		for (const Handle& var : fv.varset)
+			if (present.end() == present.find(var)) _any_type = true;
+	}
+
+	// The usual case: a single variable, in a PresentLink of its own.
+	if (1 == clauses.size() and 1 == _bare.size() and
+	    1 == clauses[0]->get_arity())
+	{
+		_single = _bare[0];
+
+		JoinLink::Traverse trav;
+		trav.replace_map.insert({_single, _single});
+		_join->fixup_replacements(trav);
+		_single_rep = trav.replace_map[_single];
+	}
+}
+
+/// Note the link types and the nodes in a term of the MeetLink. Any
+/// grounding of it is made of links of those types, and of those very
+/// nodes, besides whatever grounds the variables in it.
+void JoinCache::collect(const Handle& term)
+{
+	if (term->is_node())
+	{
+		const HandleSet& varset = _join->_variables.varset;
+		if (varset.end() == varset.find(term))
+			_meet_atoms.insert(term);
+		return;
+	}
+
+	_meet_types.insert(term->get_type());
+	for (const Handle& ho : term->getOutgoingSet())
+		collect(ho);
+}
+
+/// Might this Atom, coming or going, change what the MeetLink finds?
+/// A single variable is dealt with by add() and remove(), instead.
+bool JoinCache::moves_principals(const Handle& h) const
+{
+	const HandleSet& consts = _join->_const_terms;
+	if (consts.end() != consts.find(h)) return true;
+	if (_single) return false;
+	if (_any_type) return true;
+	if (_princes.end() != _princes.find(h)) return true;
+	if (_meet_types.end() != _meet_types.find(h->get_type())) return true;
+	if (_meet_atoms.end() != _meet_atoms.find(h)) return true;
+
+	for (const Handle& var : _bare)
+		if (_join->_variables.is_type(var, h)) return true;
+	return false;
+}
+
+/* ================================================================= */
+
+void JoinCache::changed(const Handle& h, bool added)
+{
+	{
+		std::lock_guard<std::mutex> lck(_pend_mtx);
+		_pending.push_back({h, added});
+		if (_busy) return;
+		_busy = true;
+	}
+	drain();
+}
+
+/// A whole batch of changes is handled together, so that the Atoms
+/// removed in one go are all known to be leaving, in whatever order
+/// they come.
+void JoinCache::changed(const HandleSeq& hs, bool added)
+{
+	{
+		std::lock_guard<std::mutex> lck(_pend_mtx);
+		for (const Handle& h : hs)
+			_pending.push_back({h, added});
+		if (_busy) return;
+		_busy = true;
+	}
+	drain();
+}
+
+/// Handle the pending changes, a batch at a time, until there are
+/// none left.
+void JoinCache::drain(void)
+{
+	while (true)
+	{
+		std::deque<std::pair<Handle, bool>> batch;
+		{
+			std::lock_guard<std::mutex> lck(_pend_mtx);
+			if (_pending.empty())
+			{
+				_busy = false;
+				return;
+			}
+			batch.swap(_pending);
+		}
+
+		// If it is to be done over anyway, there is nothing to do now.
+		std::lock_guard<std::mutex> lck(_mtx);
+		if (_stale) continue;
+
+		for (const auto& chg : batch)
+			if (not chg.second) _leaving.insert(chg.first);
+
+		try
+		{
+			UnorderedHandleSet touched;
+			for (const auto& chg : batch)
+			{
+				if (not _local or moves_principals(chg.first))
+					_stale = true;
+				else if (chg.second)
+					add(chg.first, touched);
+				else
+					remove(chg.first, touched);
+				if (_stale) break;
+			}
+			if (not _stale) settle(touched);
+		}
+		catch (const std::exception& ex)
+		{
+			// Not thrown at whoever changed the AtomSpace; the next
+			// read will try again, and throw, if it has to.
+			logger().warn("JoinCache: failed to update, will recompute:\n%s",
+			              ex.what());
+			_stale = true;
+		}
+		_leaving.clear();
+	}
+}
+
+/// Do the join over, in full. Changes made meanwhile are queued up,
+/// and applied on top of it, after. Call with `_mtx` held by `lck`.
+void JoinCache::refresh(std::unique_lock<std::mutex>& lck)
+{
+	bool mine;
+	{
+		std::lock_guard<std::mutex> plck(_pend_mtx);
+		mine = not _busy;
+		_busy = true;
+	}
+
+	try
+	{
+		rebuild();
+	}
+	catch (...)
+	{
+		if (mine)
+		{
+			std::lock_guard<std::mutex> plck(_pend_mtx);
+			_busy = false;
+		}
+		throw;
+	}
+
+	// Otherwise, whoever is busy will get to them.
+	if (not mine) return;
+	lck.unlock();
+	drain();
+	lck.lock();
+}
+
+void JoinCache::rebuild(void)
+{
+	_princes.clear();
+	_replace_map.clear();
+	_join_map.clear();
+	_upset.clear();
+	_joined.clear();
+	_minimal.clear();
+	_above.clear();
+	_tops.clear();
+	_reps.clear();
+	_counts.clear();
+	_rebuilds++;
+
+	DefaultJoinCallback djcb;
+	if (not _local)
+	{
+		for (const Handle& h : _join->container(_as, &djcb, false))
+			_counts.insert({h, 1});
+		_stale = false;
+		return;
+	}
+
+	JoinLink::Traverse trav;
+	trav.jcb = &djcb;
+	_princes = _join->principals(_as, trav);
+	_join->fixup_replacements(trav);
+	_replace_map.swap(trav.replace_map);
+	_join_map.swap(trav.join_map);
+
+	UnorderedHandleSet touched;
+	for (const Handle& pr : _princes)
+		admit(pr, touched);
+	settle(touched);
+	_stale = false;
+}
+
+/* ================================================================= */
+
+bool JoinCache::is_leaving(const Handle& h) const
+{
+	return _leaving.end() != _leaving.find(h);
+}
+
+/// As in JoinLink::find_top(): above the minimal ones, with nothing
+/// at all above it.
+bool JoinCache::is_top(const Handle& h) const
+{
+	if (_above.end() == _above.find(h)) return false;
+	for (const Handle& ih : h->getIncomingSet())
+		if (not is_leaving(ih)) return false;
+	return true;
+}
+
+/// As in JoinLink::container().
+bool JoinCache::is_container(const Handle& h) const
+{
+	const UnorderedHandleSet* from = &_minimal;
+	if (UPPER_SET_LINK == _type) from = &_joined;
+	else if (MAXIMAL_JOIN_LINK == _type and not _tops.empty()) from = &_tops;
+
+	if (from->end() == from->find(h)) return false;
+	return _join->has_top_type(h);
+}
+
+/* ================================================================= */
+
+/// Bring `h`, which is either a principal element, or holds a member
+/// of the upper set, into the upper set, together with everything
+/// above it; and then into whichever of the other sets it belongs to.
+/// Everything whose standing might have changed is put in `touched`.
+void JoinCache::admit(const Handle& h, UnorderedHandleSet& touched)
+{
+	HandleSeq fresh;
+	HandleSeq todo({h});
+	while (not todo.empty())
+	{
+		Handle a(todo.back());
+		todo.pop_back();
+		if (JoinLink::is_ignored(a) or is_leaving(a)) continue;
+		if (not _upset.insert(a).second) continue;
+		fresh.push_back(a);
+		for (const Handle& ia : a->getIncomingSet())
+			todo.push_back(ia);
+	}
+
+	HandleSeq joined;
+	for (const Handle& a : fresh)
+	{
+		if (not _join->is_joined(_join_map, a)) continue;
+		_joined.insert(a);
+		joined.push_back(a);
+		touched.insert(a);
+	}
+	if (UPPER_SET_LINK == _type) return;
+
+	HandleSeq lowest;
+	for (const Handle& a : joined)
+	{
+		// Whatever was minimal, just above it, no longer is.
+		for (const Handle& ia : a->getIncomingSet())
+			if (_minimal.erase(ia)) touched.insert(ia);
+
+		bool low = true;
+		if (a->is_link())
+			for (const Handle& ao : a->getOutgoingSet())
+				if (_joined.end() != _joined.find(ao)) { low = false; break; }
+		if (not low) continue;
+
+		_minimal.insert(a);
+		lowest.push_back(a);
+	}
+	if (MAXIMAL_JOIN_LINK != _type) return;
+
+	// Those no longer minimal are above the new ones, so nothing
+	// leaves the set above the minimal ones.
+	for (const Handle& a : lowest)
+		raise(a, touched);
+}
+
+/// Bring `h`, and everything above it, into the set of the Atoms
+/// above the minimal ones. As in find_top(), JoinLinks are not
+/// walked through.
+void JoinCache::raise(const Handle& h, UnorderedHandleSet& touched)
+{
+	HandleSeq todo({h});
+	while (not todo.empty())
+	{
+		Handle a(todo.back());
+		todo.pop_back();
+		if (nameserver().isA(a->get_type(), JOIN_LINK) or is_leaving(a))
+			continue;
+		if (not _above.insert(a).second) continue;
+		touched.insert(a);
+		for (const Handle& ia : a->getIncomingSet())
+			todo.push_back(ia);
+	}
+}
+
+void JoinCache::add(const Handle& h, UnorderedHandleSet& touched)
+{
+	// Gone again, before we got to it.
+	if (nullptr == h->getAtomSpace()) return;
+
+	// What it holds is no longer at the top.
+	bool held = false;
+	if (h->is_link())
+	{
+		for (const Handle& ho : h->getOutgoingSet())
+		{
+			touched.insert(ho);
+			if (_upset.end() != _upset.find(ho)) held = true;
+		}
+	}
+
+	if (_single and _princes.end() == _princes.find(h) and
+	    _join->_variables.is_type(_single, h))
+	{
+		// Nothing above it yet, so nothing else holds it, and the
+		// rest of the sets stay as they are. Unless changes have
+		// been coming in out of order.
+		if (_upset.end() != _upset.find(h))
+		{
+			_stale = true;
+			return;
+		}
+		_princes.insert(h);
+		_replace_map.insert({h, _single_rep});
+		_join_map.back().insert(h);
+		admit(h, touched);
+	}
+	else if (held)
+		admit(h, touched);
+
+	if (MAXIMAL_JOIN_LINK != _type or not h->is_link()) return;
+	for (const Handle& ho : h->getOutgoingSet())
+	{
+		if (_above.end() == _above.find(ho)) continue;
+		raise(h, touched);
+		break;
+	}
+}
+
+void JoinCache::remove(const Handle& h, UnorderedHandleSet& touched)
+{
+	// It should have nothing above it, by now. If it does, then it's
+	// easier to start over, than to walk down from there.
+	for (const Handle& ih : h->getIncomingSet())
+	{
+		if (is_leaving(ih)) continue;
+		_stale = true;
+		return;
+	}
+
+	if (_princes.erase(h))
+	{
+		_replace_map.erase(h);
+		_join_map.back().erase(h);
+	}
+
+	// What it holds might now be at the top.
+	touched.insert(h);
+	if (h->is_link())
+		for (const Handle& ho : h->getOutgoingSet())
+			touched.insert(ho);
+
+	_upset.erase(h);
+	_joined.erase(h);
+	_minimal.erase(h);
+	_above.erase(h);
+}
+
+/// Bring the results up to date, for those Atoms whose standing might
+/// have changed.
+void JoinCache::settle(UnorderedHandleSet& touched)
+{
+	if (MAXIMAL_JOIN_LINK == _type)
+	{
+		bool had_tops = not _tops.empty();
+		for (const Handle& h : touched)
+		{
+			if (is_top(h)) _tops.insert(h);
+			else _tops.erase(h);
+		}
+
+		// If there is nothing at the top, then the minimal ones are
+		// the results; so these come and go all at once.
+		if (had_tops == _tops.empty())
+			touched.insert(_minimal.begin(), _minimal.end());
+	}
+
+	for (const Handle& h : touched)
+	{
+		bool is = is_container(h);
+		const auto& it = _reps.find(h);
+		if (is == (_reps.end() != it)) continue;
+
+		if (is)
+		{
+			Handle rep(Replacement::replace_nocheck(h, _replace_map));
+			_reps.insert({h, rep});
+			_counts[rep]++;
+			continue;
+		}
+
+		const auto& ct = _counts.find(it->second);
+		if (0 == --ct->second) _counts.erase(ct);
+		_reps.erase(it);
+	}
+}
+
+/* ================================================================= */
+
+HandleSeq JoinCache::get_results(void)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (_stale) refresh(lck);
+
+	HandleSeq res;
+	for (const auto& ct : _counts)
+		res.push_back(ct.first);
+	return res;
+}
+
+size_t JoinCache::rebuilds(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _rebuilds;
+}
+
+/* ===================== END OF FILE ===================== */
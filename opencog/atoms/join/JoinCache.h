@@ -0,0 +1,169 @@
+/*
+ * opencog/atoms/join/JoinCache.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_JOIN_CACHE_H
+#define _OPENCOG_JOIN_CACHE_H
+
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include <opencog/atoms/join/JoinLink.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * The results of a JoinLink, kept up to date as Atoms are added to,
+ * and removed from, one AtomSpace. See JoinLink::materialize().
+ *
+ * The join is computed once, keeping each of the sets that it passes
+ * through on the way: the upper set of the principal elements, those
+ * members of it that join all of the terms, the minimal ones among
+ * those, and, for a MaximalJoinLink, everything above the minimal
+ * ones. After that, an Atom that is added can only be in these sets if
+ * something that it holds already is; and there is nothing above it,
+ * as yet. So it is enough to walk up from the Atom itself. Likewise,
+ * by the time that an Atom is removed, there is nothing left above it.
+ * The cost of a change is thus that of looking at the one Atom, and
+ * not that of walking up from every principal element.
+ *
+ * This holds as long as the principal elements stay the same. They
+ * are found by a MeetLink, and most changes cannot change what it
+ * finds: only those to Atoms of the link types in its clauses, and
+ * to the nodes named in them. A single variable, standing alone in its
+ * PresentLink, is also followed Atom by Atom. Any other change to the
+ * principal elements, as well as any change at all, if there are
+ * evaluatable clauses on the top, means that the join is done over,
+ * in full, the next time that the results are asked for. That is, at
+ * most once for each time that they are read, and not once for each
+ * change.
+ *
+ * Only changes to the given AtomSpace are looked at; not those in its
+ * parents or children, nor changes to Values, which evaluatable
+ * clauses might depend on. Changes are handled in the thread that
+ * makes them; those made while others are being handled are queued
+ * up, and handled after them. The cache must not be destroyed while a
+ * change is being handled.
+ */
+class JoinCache
+{
+	JoinLink* _join;
+	AtomSpace* _as;
+	Type _type;
+
+	// If false, the changes are not followed one by one; the join is
+	// simply done over again, after any change.
+	bool _local;
+
+	// Changes to the Atoms of these types, or to these very Atoms, or
+	// to those that these variables accept as groundings, might change
+	// what the MeetLink finds.
+	TypeSet _meet_types;
+	HandleSet _meet_atoms;
+	HandleSeq _bare;
+	bool _any_type;
+
+	// The variable, if there is only one, standing alone; and what it
+	// gets replaced by.
+	Handle _single;
+	Handle _single_rep;
+
+	// Guards everything below, up to the pending changes.
+	std::mutex _mtx;
+	bool _stale;
+	size_t _rebuilds;
+
+	HandleSet _princes;
+	HandleMap _replace_map;
+	HandleSetSeq _join_map;
+
+	UnorderedHandleSet _upset;
+	UnorderedHandleSet _joined;
+	UnorderedHandleSet _minimal;
+	UnorderedHandleSet _above;
+	UnorderedHandleSet _tops;
+
+	// Each container, and what it is rewritten to; and, for each
+	// result, the number of containers that are rewritten to it. The
+	// results are not in the AtomSpace, so they are compared by
+	// content.
+	UnorderedHandleMap _reps;
+	std::map<Handle, size_t> _counts;
+
+	// Atoms on their way out, still in the incoming sets of others.
+	UnorderedHandleSet _leaving;
+
+	// Pending changes; true for an addition.
+	std::mutex _pend_mtx;
+	std::deque<std::pair<Handle, bool>> _pending;
+	bool _busy;
+
+	int _add_sig;
+	int _remove_sig;
+	int _adds_sig;
+	int _removes_sig;
+
+	void setup_principals(void);
+	void collect(const Handle&);
+	bool moves_principals(const Handle&) const;
+
+	void changed(const Handle&, bool);
+	void changed(const HandleSeq&, bool);
+	void drain(void);
+	void refresh(std::unique_lock<std::mutex>&);
+	void rebuild(void);
+
+	bool is_leaving(const Handle&) const;
+	bool is_top(const Handle&) const;
+	bool is_container(const Handle&) const;
+
+	void admit(const Handle&, UnorderedHandleSet&);
+	void raise(const Handle&, UnorderedHandleSet&);
+	void add(const Handle&, UnorderedHandleSet&);
+	void remove(const Handle&, UnorderedHandleSet&);
+	void settle(UnorderedHandleSet&);
+
+public:
+	JoinCache(JoinLink*, AtomSpace*);
+	~JoinCache();
+
+	JoinCache(const JoinCache&) = delete;
+	JoinCache& operator=(const JoinCache&) = delete;
+
+	AtomSpace* get_atomspace(void) const { return _as; }
+
+	/// The results, as JoinLink::execute() would find them, right now.
+	/// They are not added to the AtomSpace.
+	HandleSeq get_results(void);
+
+	/// The number of times that the join was done over, in full.
+	size_t rebuilds(void);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_JOIN_CACHE_H
@@ -21,29 +21,59 @@
 
 #include <algorithm>
 #include <iterator>
+#include <mutex>
 
+#include <opencog/util/Logger.h>
 #include <opencog/util/oc_assert.h>
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/atom_types/atom_types.h>
 #include <opencog/atoms/core/FindUtils.h>
 #include <opencog/atoms/core/TypeUtils.h>
 #include <opencog/atoms/execution/EvaluationLink.h>
+#include <opencog/atoms/parallel/ThreadPool.h>
 #include <opencog/atoms/value/LinkValue.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atomspace/Transient.h>
 
+#include "JoinCache.h"
 #include "JoinLink.h"
 
 using namespace opencog;
 
-class DefaultJoinCallback : public JoinCallback
+/// A set of Atoms that many threads can add to at once. It is split
+/// into shards, by hash, each with its own lock, so that the threads
+/// seldom wait on one another.
+struct JoinLink::Visited
 {
-	IncomingSet get_incoming_set(const Handle& h)
+	static const size_t NSHARDS = 64;
+	struct Shard
 	{
-		return h->getIncomingSet();
+		std::mutex mtx;
+		UnorderedHandleSet atoms;
+	};
+	Shard _shards[NSHARDS];
+
+	/// Return false if `h` was already there.
+	bool insert(const Handle& h)
+	{
+		Shard& sh = _shards[h->get_hash() % NSHARDS];
+		std::lock_guard<std::mutex> lck(sh.mtx);
+		return sh.atoms.insert(h).second;
+	}
+
+	void move_into(HandleSet& hs)
+	{
+		for (Shard& sh : _shards)
+		{
+			hs.insert(sh.atoms.begin(), sh.atoms.end());
+			sh.atoms.clear();
+		}
 	}
 };
 
+// Incoming sets bigger than this are split up, and walked in parallel.
+#define FANOUT_CHUNK 512
+
 
 void JoinLink::init(void)
 {
@@ -418,47 +448,79 @@ HandleSet JoinLink::principals(AtomSpace* as,
 
 /* ================================================================= */
 
+/// Ignore type specifications, other containers!
+bool JoinLink::is_ignored(const Handle& h)
+{
+	Type t = h->get_type();
+	return nameserver().isA(t, PRESENT_LINK) or
+	       nameserver().isA(t, TYPE_OUTPUT_LINK) or
+	       nameserver().isA(t, JOIN_LINK);
+}
+
+/// Does `h` hold at least one of the principal elements for each of
+/// the terms being joined?
+bool JoinLink::is_joined(const HandleSetSeq& join_map,
+                         const Handle& h) const
+{
+	if (1 >= _jsize) return true;
+	for (size_t i=0; i<_jsize; i++)
+		if (not any_atom_in_tree(h, join_map[i])) return false;
+	return true;
+}
+
+/* ================================================================= */
+
 /// principal_filter() - Get everything that contains `h`.
 /// This is the "principal filter" on the "principal element" `h`.
 /// Algorithmically: walk upwards from h and insert everything in
-/// it's incoming tree into the handle-set. This recursively walks to
+/// it's incoming tree into the visited set. This recursively walks to
 /// the top, till there is no more. Of course, this can get large.
+/// Atoms that were already visited, by this walk or any other, are
+/// not walked through again. If `par` is set, then big incoming sets
+/// are split up, and walked in parallel.
 void JoinLink::principal_filter(Traverse& trav,
-                                HandleSet& containers,
+                                Visited& visited, bool par,
                                 const Handle& h) const
 {
-	// Ignore type specifications, other containers!
-	Type t = h->get_type();
-	if (nameserver().isA(t, PRESENT_LINK) or
-	    nameserver().isA(t, TYPE_OUTPUT_LINK) or
-	    nameserver().isA(t, JOIN_LINK))
-		return;
+	if (is_ignored(h)) return;
 
-	containers.insert(h);
+	if (not visited.insert(h)) return;
 
 	IncomingSet is(trav.jcb->get_incoming_set(h));
-	for (const Handle& ih: is)
-		principal_filter(trav, containers, ih);
+	size_t nis = is.size();
+	if (not par or nis < 2 * FANOUT_CHUNK)
+	{
+		for (const Handle& ih: is)
+			principal_filter(trav, visited, par, ih);
+		return;
+	}
+
+	size_t nchunks = (nis + FANOUT_CHUNK - 1) / FANOUT_CHUNK;
+	thread_pool().parallel_for(nchunks, [&](size_t c)
+	{
+		size_t end = std::min(nis, (c+1) * FANOUT_CHUNK);
+		for (size_t i = c * FANOUT_CHUNK; i < end; i++)
+			principal_filter(trav, visited, par, is[i]);
+	});
 }
 
 void JoinLink::principal_filter_map(Traverse& trav,
                                     const HandleSeq& base,
+                                    UnorderedHandleSet& seen,
                                     HandleSet& containers,
                                     const Handle& h) const
 {
-	// Ignore type specifications, other containers!
-	Type t = h->get_type();
-	if (nameserver().isA(t, PRESENT_LINK) or
-	    nameserver().isA(t, TYPE_OUTPUT_LINK) or
-	    nameserver().isA(t, JOIN_LINK))
-		return;
+	if (is_ignored(h)) return;
 
+	// Already walked through; whatever is above was reached, too,
+	// and was paired with the first base that reached it.
+	if (not seen.insert(h).second) return;
 	containers.insert(h);
 	trav.top_map.insert({h, base});
 
 	IncomingSet is(trav.jcb->get_incoming_set(h));
 	for (const Handle& ih: is)
-		principal_filter_map(trav, base, containers, ih);
+		principal_filter_map(trav, base, seen, containers, ih);
 }
 
 /* ================================================================= */
@@ -472,29 +534,46 @@ HandleSet JoinLink::upper_set(AtomSpace* as, bool silent,
 	HandleSet princes(principals(as, trav));
 
 	// Get a principal filter for each principal element,
-	// and union all of them together.
-	HandleSet containers;
+	// and union all of them together. The walks upwards from the
+	// different principal elements are done in parallel, if the
+	// callback allows it.
+	HandleSeq roots;
 	if (not _need_top_map)
-	{
-		for (const Handle& pr: princes)
-			principal_filter(trav, containers, pr);
-	}
+		roots.insert(roots.end(), princes.begin(), princes.end());
 	else
 	{
 		// Argh. This is complicated. Un-named, anonymous terms
 		// are just like above.
 		size_t ncon = _const_terms.size();
 		for (size_t i=0; i<ncon; i++)
+			roots.insert(roots.end(),
+				trav.join_map[i].begin(), trav.join_map[i].end());
+	}
+
+	Visited visited;
+	bool par = trav.jcb->is_thread_safe();
+	if (par and 1 < roots.size())
+		thread_pool().parallel_for(roots.size(), [&](size_t i)
 		{
-			for (const Handle& prc: trav.join_map[i])
-				principal_filter(trav, containers, prc);
-		}
+			principal_filter(trav, visited, par, roots[i]);
+		});
+	else
+		for (const Handle& pr: roots)
+			principal_filter(trav, visited, par, pr);
+
+	HandleSet containers;
+	visited.move_into(containers);
 
+	if (_need_top_map)
+	{
 		// Named terms -- we need to build a lookup table,
 		// so that we can pass them into any evaluatable predicates.
+		// This one is walked in a single thread.
 		HandleSeqMap base_map(trav.top_map);
+		UnorderedHandleSet seen;
 		for (const auto& pare: base_map)
-			principal_filter_map(trav, pare.second, containers, pare.first);
+			principal_filter_map(trav, pare.second, seen, containers,
+			                     pare.first);
 	}
 
 	if (1 >= _jsize)
@@ -509,16 +588,8 @@ HandleSet JoinLink::upper_set(AtomSpace* as, bool silent,
 	// So - two steps. First, create a set of unjoined elements.
 	HandleSet unjoined;
 	for (const Handle& h : containers)
-	{
-		for (size_t i=0; i<_jsize; i++)
-		{
-			if (not any_atom_in_tree(h, trav.join_map[i]))
-			{
-				unjoined.insert(h);
-				break;
-			}
-		}
-	}
+		if (not is_joined(trav.join_map, h))
+			unjoined.insert(h);
 
 	// and now banish them
 	HandleSet joined;
@@ -601,6 +672,14 @@ void JoinLink::find_top(Traverse& trav, const Handle& h) const
 
 /* ================================================================= */
 
+/// Is `h` of one of the types that the top is constrained to?
+bool JoinLink::has_top_type(const Handle& h) const
+{
+	for (const Handle& toty : _top_types)
+		if (not value_is_type(toty, h)) return false;
+	return true;
+}
+
 /// Apply constraints that involve the top-most, containing
 /// term.  This include type constraints, as well as evaluatable
 /// terms that name the top variable.
@@ -616,12 +695,8 @@ HandleSet JoinLink::constrain(AtomSpace* as, bool silent,
 	for (const Handle& h : trav.containers)
 	{
 		// Weed out anything that is the wrong type
-		for (const Handle& toty : _top_types)
-		{
-			if (value_is_type(toty, h)) continue;
+		if (not has_top_type(h))
 			rejects.insert(h);
-			break;
-		}
 
 		// Run the evaluatable constraint clauses
 		for (const Handle& toc : _top_clauses)
@@ -661,8 +736,11 @@ HandleSet JoinLink::constrain(AtomSpace* as, bool silent,
 
 /* ================================================================= */
 
+/// Compute the join. If `stream` is given, the results are also
+/// pushed onto it, one by one, as they are made.
 HandleSet JoinLink::container(AtomSpace* as, JoinCallback* jcb,
-                              bool silent) const
+                              bool silent,
+                              const QueueValuePtr& stream) const
 {
 	Traverse trav;
 	trav.jcb = jcb;
@@ -687,15 +765,18 @@ HandleSet JoinLink::container(AtomSpace* as, JoinCallback* jcb,
 
 	// Perform the actual rewriting.
 	fixup_replacements(trav);
-	return replace(trav);
+	return replace(trav, as, stream);
 }
 
 /* ================================================================= */
 
 /// Given a top-level set of containing links, perform
 /// replacements, substituting the bottom-most atoms as requested,
-/// while honoring all scoping and quoting.
-HandleSet JoinLink::replace(const Traverse& trav) const
+/// while honoring all scoping and quoting. If there is a stream,
+/// each distinct result is added to the AtomSpace, and pushed onto
+/// it, as soon as it is made.
+HandleSet JoinLink::replace(const Traverse& trav, AtomSpace* as,
+                            const QueueValuePtr& stream) const
 {
 	// Use the Replacement utility, so that all scoping and
 	// quoting is handled correctly.
@@ -703,7 +784,8 @@ HandleSet JoinLink::replace(const Traverse& trav) const
 	for (const Handle& top: trav.containers)
 	{
 		Handle rep = Replacement::replace_nocheck(top, trav.replace_map);
-		replaced.insert(rep);
+		if (replaced.insert(rep).second and stream)
+			stream->push(as->add_atom(rep));
 	}
 
 	return replaced;
@@ -728,8 +810,45 @@ QueueValuePtr JoinLink::do_execute(AtomSpace* as,
 	return qvp;
 }
 
+QueueValuePtr JoinLink::execute_stream(AtomSpace* as, bool silent)
+{
+	if (nullptr == as) as = _atom_space;
+
+	// Hold on to this link, until the join is done.
+	JoinLinkPtr self(JoinLinkCast(get_handle()));
+	QueueValuePtr qvp(createQueueValue());
+	thread_pool().submit([self, as, silent, qvp]()
+	{
+		DefaultJoinCallback djcb;
+		try
+		{
+			self->container(as, &djcb, silent, qvp);
+		}
+		catch (const std::exception& ex)
+		{
+			logger().warn("JoinLink stream failed:\n%s", ex.what());
+		}
+		qvp->close();
+	});
+	return qvp;
+}
+
 ValuePtr JoinLink::execute(AtomSpace* as, bool silent)
 {
+	if (nullptr == as) as = _atom_space;
+
+	std::shared_ptr<JoinCache> cache(get_cache());
+	if (cache and cache->get_atomspace() == as)
+	{
+		// Not under any lock: adding the results may well call
+		// back into the cache.
+		QueueValuePtr qvp(createQueueValue());
+		for (const Handle& h : cache->get_results())
+			qvp->push(as->add_atom(h));
+		qvp->close();
+		return qvp;
+	}
+
 	DefaultJoinCallback djcb;
 	return do_execute(as, &djcb, silent);
 }
@@ -739,6 +858,38 @@ ValuePtr JoinLink::execute_cb(AtomSpace* as, JoinCallback* jcb)
 	return do_execute(as, jcb, false);
 }
 
+/* ================================================================= */
+
+std::shared_ptr<JoinCache> JoinLink::get_cache(void)
+{
+	std::lock_guard<std::mutex> lck(_cache_mtx);
+	return _cache;
+}
+
+void JoinLink::materialize(AtomSpace* as)
+{
+	if (nullptr == as) as = _atom_space;
+	if (nullptr == as)
+		throw RuntimeException(TRACE_INFO,
+			"JoinLink: no AtomSpace to keep the results for!");
+
+	std::lock_guard<std::mutex> lck(_cache_mtx);
+	if (_cache and _cache->get_atomspace() == as) return;
+	_cache = nullptr;
+	_cache = std::make_shared<JoinCache>(this, as);
+}
+
+void JoinLink::dematerialize(void)
+{
+	std::lock_guard<std::mutex> lck(_cache_mtx);
+	_cache = nullptr;
+}
+
+bool JoinLink::is_materialized(void)
+{
+	return nullptr != get_cache();
+}
+
 DEFINE_LINK_FACTORY(JoinLink, JOIN_LINK)
 
 /* ===================== END OF FILE ===================== */
@@ -22,6 +22,9 @@
 #ifndef _OPENCOG_JOIN_LINK_H
 #define _OPENCOG_JOIN_LINK_H
 
+#include <memory>
+#include <mutex>
+
 #include <opencog/atoms/core/PrenexLink.h>
 #include <opencog/atoms/value/QueueValue.h>
 
@@ -40,10 +43,30 @@ public:
 
 	/// Callback to get the IncomgingSet of the given Handle.
 	virtual IncomingSet get_incoming_set(const Handle&) = 0;
+
+	/// Return true if get_incoming_set() may be called from several
+	/// threads at once. If so, the upward walks are done in parallel.
+	virtual bool is_thread_safe(void) const { return false; }
+};
+
+/// Get the IncomingSet from the Atom itself.
+class DefaultJoinCallback : public JoinCallback
+{
+public:
+	IncomingSet get_incoming_set(const Handle& h)
+	{
+		return h->getIncomingSet();
+	}
+
+	bool is_thread_safe(void) const { return true; }
 };
 
+class JoinCache;
+
 class JoinLink : public PrenexLink
 {
+	friend class JoinCache;
+
 protected:
 	void init(void);
 
@@ -80,9 +103,18 @@ protected:
 		HandleSeqMap top_map;
 	};
 
+	// The Atoms already walked through, shared by all the threads
+	// walking upwards; see JoinLink.cc
+	struct Visited;
+
+	static bool is_ignored(const Handle&);
+	bool is_joined(const HandleSetSeq&, const Handle&) const;
+	bool has_top_type(const Handle&) const;
+
 	HandleSet principals(AtomSpace*, Traverse&) const;
-	void principal_filter(Traverse&, HandleSet&, const Handle&) const;
+	void principal_filter(Traverse&, Visited&, bool, const Handle&) const;
 	void principal_filter_map(Traverse&, const HandleSeq&,
+	                          UnorderedHandleSet&,
 	                          HandleSet&, const Handle&) const;
 
 	HandleSet upper_set(AtomSpace*, bool, Traverse&) const;
@@ -91,14 +123,21 @@ protected:
 	HandleSet constrain(AtomSpace*, bool, Traverse&) const;
 
 	void fixup_replacements(Traverse&) const;
-	HandleSet replace(const Traverse&) const;
+	HandleSet replace(const Traverse&, AtomSpace*,
+	                  const QueueValuePtr&) const;
 
 	void find_top(Traverse&, const Handle&) const;
-	HandleSet container(AtomSpace*, JoinCallback*, bool) const;
+	HandleSet container(AtomSpace*, JoinCallback*, bool,
+	                    const QueueValuePtr& = nullptr) const;
 
 	virtual QueueValuePtr do_execute(AtomSpace*,
 	                                 JoinCallback*,  bool silent);
 
+	// The results, if they are being kept up to date.
+	std::mutex _cache_mtx;
+	std::shared_ptr<JoinCache> _cache;
+	std::shared_ptr<JoinCache> get_cache(void);
+
 public:
 	JoinLink(const HandleSeq&&, Type=JOIN_LINK);
 
@@ -110,6 +149,20 @@ public:
 
 	ValuePtr execute_cb(AtomSpace*, JoinCallback*);
 
+	/// Like execute(), except that it returns at once. The join is
+	/// computed in the thread pool, and the results are pushed onto
+	/// the returned QueueValue as they are found; it is closed when
+	/// the join is done.
+	QueueValuePtr execute_stream(AtomSpace*, bool silent=false);
+
+	/// Keep the results for the given AtomSpace, and update them as
+	/// Atoms are added to it and removed from it, instead of computing
+	/// them anew on each execute(). See JoinCache for what this costs.
+	/// Only execute() in that AtomSpace uses them.
+	void materialize(AtomSpace*);
+	void dematerialize(void);
+	bool is_materialized(void);
+
 	static Handle factory(const Handle&);
 };
 
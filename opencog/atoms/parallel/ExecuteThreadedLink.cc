@@ -21,14 +21,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <thread>
-
-#include <opencog/util/platform.h>
 #include <opencog/util/concurrent_queue.h>
 
 #include <opencog/atoms/core/NumberNode.h>
 #include <opencog/atoms/execution/Instantiator.h>
 #include <opencog/atoms/parallel/ExecuteThreadedLink.h>
+#include <opencog/atoms/parallel/ThreadPool.h>
 #include <opencog/atoms/value/QueueValue.h>
 
 #include <opencog/atomspace/AtomSpace.h>
@@ -45,14 +43,15 @@ using namespace opencog;
 ///                ExecutableAtoms...
 ///
 /// When this link is executed, the `ExecutableAtoms...` are executed
-/// in parallel, in distinct threads, with the result of the execution
+/// in parallel, in the threads of the ThreadPool, with the result of the execution
 /// appended to a thread-safe queue, the QueueValue.  After all of the
 /// atoms have been executed, the QueueValue holding the results is
 /// returned. Execution blocks until all of the threads have finished.
 ///
-/// By default, the number of threads launched equals the number of
+/// By default, the number of threads used equals the number of
 /// Atoms in the set. If the NumberNode is present, then the number of
 /// threads is the smaller of the NumberNode and the seize of the Set.
+/// The thread that executes this link is one of them.
 ///
 /// XXX TODO: We could have a non-blocking version of this atom. We
 /// could just return the QueueValue immediately; the user could check
@@ -89,10 +88,8 @@ ExecuteThreadedLink::ExecuteThreadedLink(const HandleSeq&& oset, Type t)
 
 static void thread_exec(AtomSpace* as, bool silent,
                         concurrent_queue<Handle>* todo,
-                        QueueValuePtr qvp,
-                        std::exception_ptr* returned_ex)
+                        QueueValuePtr qvp)
 {
-	set_thread_name("atoms:execlink");
 	while (true)
 	{
 		Handle h;
@@ -100,18 +97,10 @@ static void thread_exec(AtomSpace* as, bool silent,
 
 		// This is "identical" to what cog-execute! would do...
 		Instantiator inst(as);
-		try
-		{
-			ValuePtr pap(inst.execute(h));
-			if (pap and pap->is_atom())
-				pap = as->add_atom(HandleCast(pap));
-			qvp->push(std::move(pap));
-		}
-		catch (const std::exception& ex)
-		{
-			*returned_ex = std::current_exception();
-			return;
-		}
+		ValuePtr pap(inst.execute(h));
+		if (pap and pap->is_atom())
+			pap = as->add_atom(HandleCast(pap));
+		qvp->push(std::move(pap));
 	}
 }
 
@@ -127,22 +116,12 @@ ValuePtr ExecuteThreadedLink::execute(AtomSpace* as,
 	// Where the results will be reported.
 	QueueValuePtr qvp(createQueueValue());
 
-	// Create a collection of joinable threads.
-	std::vector<std::thread> thread_set;
-	std::exception_ptr ex;
-
-	// Launch the workers
-	for (size_t i=0; i<_nthreads; i++)
+	// Run the workers, and wait for it all to come together.
+	// If any of them threw, this rethrows.
+	thread_pool().parallel_for(_nthreads, [&](size_t)
 	{
-		thread_set.push_back(std::thread(&thread_exec,
-			as, silent, &todo_list, qvp, &ex));
-	}
-
-	// Wait for it all to come together.
-	for (std::thread& t : thread_set) t.join();
-
-	// Were there any exceptions? If so, rethrow.
-	if (ex) std::rethrow_exception(ex);
+		thread_exec(as, silent, &todo_list, qvp);
+	});
 
 	qvp->close();
 	return qvp;
@@ -21,11 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <thread>
-
-#include <opencog/util/platform.h>
+#include <opencog/atoms/core/SleepLink.h>
 #include <opencog/atoms/execution/EvaluationLink.h>
 #include <opencog/atoms/parallel/ParallelLink.h>
+#include <opencog/atoms/parallel/ThreadPool.h>
 #include <opencog/atoms/truthvalue/SimpleTruthValue.h>
 
 #include <opencog/atomspace/AtomSpace.h>
@@ -41,7 +40,6 @@ static void thread_eval(AtomSpace* as,
                         const Handle& evelnk, AtomSpace* scratch,
                         bool silent)
 {
-	set_thread_name("atoms:parallel");
 	try
 	{
 		EvaluationLink::do_eval_scratch(as, evelnk, scratch, silent);
@@ -52,15 +50,68 @@ static void thread_eval(AtomSpace* as,
 	}
 }
 
+// The usual way of doing something later is
+//
+//    SequentialAnd
+//       True (Sleep (Number secs))
+//       <the rest...>
+//
+// Rather than have a worker sleep through that, the rest is put on
+// the timer wheel, to be submitted when it is due. If the rest starts
+// with a sleep of its own, that one is handled the same way.
+static bool leading_sleep(const Handle& h)
+{
+	if (SEQUENTIAL_AND_LINK != h->get_type() or h->get_arity() < 2)
+		return false;
+	const Handle& first(h->getOutgoingAtom(0));
+	return TRUE_LINK == first->get_type() and
+		1 == first->get_arity() and
+		SLEEP_LINK == first->getOutgoingAtom(0)->get_type();
+}
+
+static void branch_eval(AtomSpace* as,
+                        const Handle& evelnk, AtomSpace* scratch,
+                        bool silent)
+{
+	if (not leading_sleep(evelnk))
+	{
+		thread_eval(as, evelnk, scratch, silent);
+		return;
+	}
+
+	double secs;
+	try
+	{
+		SleepLinkPtr slp(SleepLinkCast(
+			evelnk->getOutgoingAtom(0)->getOutgoingAtom(0)));
+		secs = slp->get_seconds(scratch, silent);
+	}
+	catch (const std::exception& ex)
+	{
+		logger().warn("Caught exception in thread:\n%s", ex.what());
+		return;
+	}
+
+	const HandleSeq& oset(evelnk->getOutgoingSet());
+	Handle rest(createLink(HandleSeq(oset.begin()+1, oset.end()),
+	                       SEQUENTIAL_AND_LINK));
+	thread_pool().submit_after(secs, [as, rest, scratch, silent]()
+	{
+		branch_eval(as, rest, scratch, silent);
+	});
+}
+
 void ParallelLink::evaluate(AtomSpace* as,
                             bool silent,
                             AtomSpace* scratch)
 {
-	// Create and detach threads; return immediately.
+	// Hand them to the thread pool; return immediately.
 	for (const Handle& h : _outgoing)
 	{
-		std::thread thr(&thread_eval, as, h, scratch, silent);
-		thr.detach();
+		thread_pool().submit([as, h, scratch, silent]()
+		{
+			branch_eval(as, h, scratch, silent);
+		});
 	}
 }
 
@@ -21,12 +21,14 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <thread>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
 
-#include <opencog/util/platform.h>
 #include <opencog/atoms/core/NumberNode.h>
 #include <opencog/atoms/execution/EvaluationLink.h>
 #include <opencog/atoms/parallel/ThreadJoinLink.h>
+#include <opencog/atoms/parallel/ThreadPool.h>
 #include <opencog/atoms/truthvalue/SimpleTruthValue.h>
 #include <opencog/atoms/value/LinkValue.h>
 
@@ -35,47 +37,106 @@
 using namespace opencog;
 
 ThreadJoinLink::ThreadJoinLink(const HandleSeq&& oset, Type t)
-    : ParallelLink(std::move(oset), t)
+    : ParallelLink(std::move(oset), t), _quorum(0), _race(false)
 {
+	for (const Handle& h : _outgoing)
+	{
+		if (NUMBER_NODE != h->get_type())
+		{
+			_branches.push_back(h);
+			continue;
+		}
+		if (_race)
+			throw InvalidParamException(TRACE_INFO,
+				"Expecting at most one NumberNode!");
+
+		double k = NumberNodeCast(h)->get_value();
+		if (k < 1.0)
+			throw InvalidParamException(TRACE_INFO,
+				"Expecting a quorum of at least one, got %g", k);
+		_quorum = std::floor(k);
+		_race = true;
+	}
+
+	if (not _race or _branches.size() < _quorum)
+		_quorum = _branches.size();
 }
 
-static void thread_eval_tv(AtomSpace* as,
-                           const Handle& evelnk, AtomSpace* scratch,
-                           bool silent, TruthValuePtr* tv,
-                           std::exception_ptr* returned_ex)
+/// Evaluate the branches until the outcome is known; see the header.
+bool ThreadJoinLink::race(AtomSpace* as, bool silent, AtomSpace* scratch)
 {
-	set_thread_name("atoms:joinlink");
-	try
+	// The branches that lost the race can outlive this call; so
+	// whatever they touch is on the heap.
+	struct Race
 	{
-		*tv = EvaluationLink::do_eval_scratch(as, evelnk, scratch, silent);
-	}
-	catch (const std::exception& ex)
+		std::mutex mtx;
+		std::condition_variable decided;
+		size_t ntrue = 0;
+		size_t nfalse = 0;
+		bool over = false;
+		std::exception_ptr ex;
+	};
+	std::shared_ptr<Race> rc(std::make_shared<Race>());
+
+	size_t need = _quorum;
+	size_t spare = _branches.size() - _quorum;
+	if (0 == need) return true;
+	for (const Handle& h : _branches)
 	{
-		*returned_ex = std::current_exception();
+		thread_pool().submit([as, h, scratch, silent, rc, need, spare]()
+		{
+			{
+				std::lock_guard<std::mutex> lck(rc->mtx);
+				if (rc->over) return;
+			}
+
+			TruthValuePtr tv;
+			std::exception_ptr ex;
+			try
+			{
+				tv = EvaluationLink::do_eval_scratch(as, h, scratch, silent);
+			}
+			catch (const std::exception&)
+			{
+				ex = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lck(rc->mtx);
+			if (rc->over) return;
+			if (ex) rc->ex = ex;
+			else if (0.5 > tv->get_mean()) rc->nfalse++;
+			else rc->ntrue++;
+
+			if (ex or need <= rc->ntrue or spare < rc->nfalse)
+			{
+				rc->over = true;
+				rc->decided.notify_all();
+			}
+		});
 	}
+
+	std::unique_lock<std::mutex> lck(rc->mtx);
+	rc->decided.wait(lck, [&]() { return rc->over; });
+	if (rc->ex) std::rethrow_exception(rc->ex);
+	return need <= rc->ntrue;
 }
 
 bool ThreadJoinLink::evaluate(AtomSpace* as,
                               bool silent,
                               AtomSpace* scratch)
 {
+	if (_race) return race(as, silent, scratch);
+
 	size_t arity = _outgoing.size();
 	std::vector<TruthValuePtr> tvp(arity);
 
-	// Create a collection of joinable threads.
-	std::vector<std::thread> thread_set;
-	std::exception_ptr ex;
-	for (size_t i=0; i<arity; i++)
+	// Evaluate them all in the thread pool, and wait for it all to
+	// come together. If any of them threw, this rethrows.
+	thread_pool().parallel_for(arity, [&](size_t i)
 	{
-		thread_set.push_back(std::thread(&thread_eval_tv,
-			as, _outgoing[i], scratch, silent, &tvp[i], &ex));
-	}
-
-	// Wait for it all to come together.
-	for (std::thread& t : thread_set) t.join();
-
-	// Were there any exceptions? If so, rethrow.
-	if (ex) std::rethrow_exception(ex);
+		tvp[i] = EvaluationLink::do_eval_scratch(as, _outgoing[i],
+		                                         scratch, silent);
+	});
 
 	// Return the logical-AND of the returned truth values
 	for (const TruthValuePtr& tv: tvp)
@@ -88,7 +149,7 @@ TruthValuePtr ThreadJoinLink::evaluate(AtomSpace* as,
                                        bool silent)
 {
 	bool ok = evaluate(as, silent, as);
-	if (ok) SimpleTruthValue::TRUE_TV();
+	if (ok) return SimpleTruthValue::TRUE_TV();
 	return SimpleTruthValue::FALSE_TV();
 }
 
@@ -34,8 +34,24 @@ namespace opencog
 
 class AtomSpace;
 
+/// ThreadJoinLink evaluates all of its Atoms in parallel, waits for
+/// them, and returns the boolean And of their TruthValues.
+///
+/// If one of the Atoms is a NumberNode k, then it is a race instead:
+/// the result is true as soon as any k of the others have evaluated to
+/// true, and false as soon as so many are false that k can no longer
+/// be reached. With k=1, the first true answer wins. The stragglers
+/// that have not started yet are not run at all; those already running
+/// are left to finish on their own, and their results are discarded.
 class ThreadJoinLink : public ParallelLink
 {
+protected:
+	HandleSeq _branches;
+	size_t _quorum;
+	bool _race;
+
+	bool race(AtomSpace*, bool, AtomSpace*);
+
 public:
 	ThreadJoinLink(const HandleSeq&&, Type=THREAD_JOIN_LINK);
 	ThreadJoinLink(const ThreadJoinLink&) = delete;
@@ -0,0 +1,393 @@
+/*
+ * opencog/atoms/parallel/ThreadPool.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <opencog/util/Logger.h>
+#include <opencog/util/platform.h>
+
+#include <opencog/atoms/parallel/ThreadPool.h>
+#include <opencog/atoms/parallel/TimerWheel.h>
+
+using namespace opencog;
+
+thread_local ThreadPool::Worker* ThreadPool::_self = nullptr;
+
+ThreadPool::ThreadPool(void) :
+	_total(0),
+	_max(1024),
+	_grow_msec(2),
+	_idle_secs(30),
+	_next_cpu(0),
+	_queued(0),
+	_idle(0),
+	_taken(0),
+	_started(0)
+{
+	_min = std::thread::hardware_concurrency();
+	if (0 == _min) _min = 1;
+	std::thread(&ThreadPool::watch, this).detach();
+}
+
+ThreadPool& ThreadPool::instance(void)
+{
+	// Never deleted; see the comment in the header.
+	static ThreadPool* pool = new ThreadPool();
+	return *pool;
+}
+
+void ThreadPool::set_bounds(size_t min, size_t max,
+                            unsigned int grow_msec, unsigned int idle_secs)
+{
+	if (min < 1) min = 1;
+	if (max < min) max = min;
+	if (grow_msec < 1) grow_msec = 1;
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	_min = min;
+	_max = max;
+	_grow_msec = grow_msec;
+	_idle_secs = idle_secs;
+}
+
+#ifdef __linux__
+// The socket that the CPU is on, as the kernel reports it.
+static int package_of(int cpu)
+{
+	std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+	                 "/topology/physical_package_id");
+	int pkg = 0;
+	if (not (in >> pkg)) return 0;
+	return pkg;
+}
+#endif
+
+void ThreadPool::set_affinity(bool pin)
+{
+	std::vector<std::pair<int, int>> cpus;
+#ifdef __linux__
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (pin and 0 == sched_getaffinity(0, sizeof(allowed), &allowed))
+	{
+		for (int c = 0; c < CPU_SETSIZE; c++)
+			if (CPU_ISSET(c, &allowed))
+				cpus.push_back({package_of(c), c});
+	}
+	std::sort(cpus.begin(), cpus.end());
+#endif
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	_cpus.clear();
+	_packages.clear();
+	for (const auto& pc : cpus)
+	{
+		_packages.push_back(pc.first);
+		_cpus.push_back(pc.second);
+	}
+	_next_cpu = 0;
+}
+
+size_t ThreadPool::size(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _total;
+}
+
+/* ================================================================ */
+
+/// Start one more worker. Call with `_mtx` held.
+void ThreadPool::grow(void)
+{
+	std::shared_ptr<Worker> wrk(std::make_shared<Worker>());
+	if (not _cpus.empty())
+	{
+		size_t i = _next_cpu++ % _cpus.size();
+		wrk->cpu = _cpus[i];
+		wrk->package = _packages[i];
+	}
+	_workers.push_back(wrk);
+	_total++;
+
+	// Count it as idle right away, so that the submits that follow,
+	// before it gets going, do not start even more of them.
+	_idle++;
+	_started++;
+	std::thread(&ThreadPool::work, this, wrk).detach();
+}
+
+void ThreadPool::submit(Task task)
+{
+	push(std::move(task), nullptr);
+}
+
+void ThreadPool::submit_after(double secs, Task task)
+{
+	timer_wheel().schedule(secs, [this, task]()
+	{
+		submit(task);
+	});
+}
+
+void ThreadPool::push(Task&& task, const void* tag)
+{
+	_queued++;
+	if (_self)
+	{
+		std::lock_guard<std::mutex> lck(_self->mtx);
+		_self->tasks.push_back({std::move(task), tag});
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_inject.push_back({std::move(task), tag});
+	}
+
+	// If there are more tasks waiting than there are workers to take
+	// them, then start another, or, past `min`, have the watcher keep
+	// an eye on it; otherwise, wake one that is asleep.
+	if (_idle < _queued)
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		if (_idle < _queued)
+		{
+			if (_total < _min) grow();
+			else _stalled.notify_one();
+		}
+	}
+	_wake.notify_one();
+}
+
+/// Start one more worker whenever the tasks that are waiting have not
+/// moved for `grow_msec`, because every worker is stuck in a task.
+void ThreadPool::watch(void)
+{
+	set_thread_name("atoms:poolwatch");
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (true)
+	{
+		if (0 == _queued)
+		{
+			_stalled.wait(lck);
+			continue;
+		}
+		size_t taken = _taken;
+		_stalled.wait_for(lck, std::chrono::milliseconds(_grow_msec));
+		if (0 < _queued and 0 == _idle and taken == _taken and
+		    _total < _max)
+			grow();
+	}
+}
+
+/// Remove the tasks with the given tag, from wherever push() would
+/// have put them, that have not been taken yet. Those that were stolen
+/// are not looked for.
+void ThreadPool::revoke(const void* tag)
+{
+	auto tagged = [tag](const Job& job) { return job.tag == tag; };
+	size_t before, after;
+	if (_self)
+	{
+		std::lock_guard<std::mutex> lck(_self->mtx);
+		before = _self->tasks.size();
+		_self->tasks.erase(std::remove_if(_self->tasks.begin(),
+			_self->tasks.end(), tagged), _self->tasks.end());
+		after = _self->tasks.size();
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		before = _inject.size();
+		_inject.erase(std::remove_if(_inject.begin(),
+			_inject.end(), tagged), _inject.end());
+		after = _inject.size();
+	}
+	_queued -= before - after;
+}
+
+/// Our own tasks first, the newest of them; then the shared queue;
+/// then the oldest task of some other worker.
+bool ThreadPool::find_task(Worker* self, Task& task)
+{
+	{
+		std::lock_guard<std::mutex> lck(self->mtx);
+		if (not self->tasks.empty())
+		{
+			task = std::move(self->tasks.back().task);
+			self->tasks.pop_back();
+			return true;
+		}
+	}
+
+	std::vector<std::shared_ptr<Worker>> others;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		if (not _inject.empty())
+		{
+			task = std::move(_inject.front().task);
+			_inject.pop_front();
+			return true;
+		}
+		if (0 == _queued) return false;
+		others = _workers;
+	}
+
+	// Those on the same socket first. Workers that are not pinned
+	// are all on the same one.
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (const std::shared_ptr<Worker>& wrk : others)
+		{
+			if (wrk.get() == self) continue;
+			if ((wrk->package == self->package) != (0 == pass)) continue;
+			std::unique_lock<std::mutex> lck(wrk->mtx, std::try_to_lock);
+			if (not lck.owns_lock() or wrk->tasks.empty()) continue;
+			task = std::move(wrk->tasks.front().task);
+			wrk->tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::work(std::shared_ptr<Worker> self)
+{
+	set_thread_name("atoms:pool");
+	_self = self.get();
+
+#ifdef __linux__
+	if (0 <= self->cpu)
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(self->cpu, &cpus);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	}
+#endif
+
+	Clock::time_point last_busy = Clock::now();
+	Task task;
+	while (true)
+	{
+		if (find_task(self.get(), task))
+		{
+			_queued--;
+			_idle--;
+			_taken++;
+			try
+			{
+				task();
+			}
+			catch (const std::exception& ex)
+			{
+				logger().warn("Caught exception in thread pool:\n%s",
+				              ex.what());
+			}
+			task = nullptr;
+			_idle++;
+			last_busy = Clock::now();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lck(_mtx);
+		if (not _inject.empty()) continue;
+
+		// Only this worker ever pushes onto its own deque, and it is
+		// empty; so nothing is lost when it goes away.
+		if (_min < _total and
+		    std::chrono::seconds(_idle_secs) < Clock::now() - last_busy)
+		{
+			_workers.erase(std::find(_workers.begin(), _workers.end(), self));
+			_total--;
+			_idle--;
+			_self = nullptr;
+			return;
+		}
+
+		// Tasks pushed onto the deques of busy workers do not always
+		// wake us; so look again every now and then, anyway.
+		_wake.wait_for(lck, std::chrono::milliseconds(10));
+	}
+}
+
+/* ================================================================ */
+
+void ThreadPool::parallel_for(size_t n,
+                              const std::function<void(size_t)>& fn)
+{
+	if (0 == n) return;
+
+	// Tasks that start late, after all of the work has been claimed,
+	// may outlive this call; so what they touch is on the heap. They
+	// do not touch `fn`, unless they claimed some of the work, and
+	// this call does not return before that work is done.
+	struct Batch
+	{
+		std::atomic<size_t> next;
+		std::mutex mtx;
+		std::condition_variable all_done;
+		size_t done;
+		std::exception_ptr ex;
+	};
+	std::shared_ptr<Batch> batch(std::make_shared<Batch>());
+	batch->next = 0;
+	batch->done = 0;
+
+	const std::function<void(size_t)>* pfn = &fn;
+	Task run([batch, pfn, n]()
+	{
+		while (true)
+		{
+			size_t i = batch->next++;
+			if (n <= i) return;
+
+			std::exception_ptr ex;
+			try { (*pfn)(i); }
+			catch (...) { ex = std::current_exception(); }
+
+			std::lock_guard<std::mutex> lck(batch->mtx);
+			if (ex and nullptr == batch->ex) batch->ex = ex;
+			if (n == ++batch->done) batch->all_done.notify_all();
+		}
+	});
+
+	for (size_t i = 1; i < n; i++) push(Task(run), batch.get());
+	run();
+
+	// All of the work has been claimed; the helpers that have not
+	// started yet would find nothing to do.
+	revoke(batch.get());
+
+	std::unique_lock<std::mutex> lck(batch->mtx);
+	batch->all_done.wait(lck, [&]() { return n == batch->done; });
+	if (batch->ex) std::rethrow_exception(batch->ex);
+}
+
+/* ============================= END OF FILE ================= */
@@ -0,0 +1,189 @@
+/*
+ * opencog/atoms/parallel/ThreadPool.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_THREAD_POOL_H
+#define _OPENCOG_THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * The threads that the parallel links run in, shared by the whole
+ * process, so that the cost of creating a thread is not paid over and
+ * over again for each execution.
+ *
+ * Each worker has its own deque of tasks. Tasks submitted by a worker
+ * (that is, by a task that is itself running in the pool) go onto the
+ * back of that worker's deque, and it takes them from the back again,
+ * most recent first. Tasks submitted from outside of the pool go onto
+ * a shared queue. A worker that has nothing left of its own takes
+ * from the shared queue, and, failing that, steals from the front of
+ * the deques of the other workers.
+ *
+ * Tasks may sleep, block, or run for a long time; the ParallelLink
+ * relies on that. So the pool is not of a fixed size. Up to `min`
+ * workers are started as soon as there are more tasks waiting than
+ * idle workers. Beyond that, one more is started each time that tasks
+ * have been waiting for `grow_msec`, with none of them having been
+ * taken in that time, up to `max`. A flood of short tasks thus runs on
+ * `min` threads, while tasks blocked for a long time do not hold up
+ * the ones queued behind them. Workers above `min` exit after having
+ * nothing to do for `idle_secs`. Under a steady load, then, no threads
+ * are created at all.
+ *
+ * On machines with more than one socket, the workers can be pinned,
+ * each to a CPU of its own; see set_affinity(). The CPUs are handed
+ * out one socket at a time, and a worker that steals, steals from the
+ * workers on its own socket first. The tasks that a task submits, and
+ * the memory that they touch, thus tend to stay on the socket that
+ * they started on.
+ *
+ * The pool is never destroyed; tasks that are still running when the
+ * process exits are simply abandoned, as detached threads would be.
+ */
+class ThreadPool
+{
+public:
+	typedef std::function<void(void)> Task;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// The tag is used only by parallel_for(), to take back the
+	// tasks that no worker got around to.
+	struct Job
+	{
+		Task task;
+		const void* tag;
+	};
+
+	struct Worker
+	{
+		std::mutex mtx;
+		std::deque<Job> tasks;
+
+		// The CPU that the worker is pinned to, and its socket; or
+		// -1 if it is not pinned.
+		int cpu = -1;
+		int package = -1;
+	};
+
+	// Guards everything below that is not atomic.
+	std::mutex _mtx;
+	std::condition_variable _wake;
+	std::condition_variable _stalled;
+
+	std::vector<std::shared_ptr<Worker>> _workers;
+	std::deque<Job> _inject;
+	size_t _total;
+	size_t _min;
+	size_t _max;
+	unsigned int _grow_msec;
+	unsigned int _idle_secs;
+
+	// The CPUs to pin to, in socket order, and their sockets; empty,
+	// if the workers are not pinned.
+	std::vector<int> _cpus;
+	std::vector<int> _packages;
+	size_t _next_cpu;
+
+	// Tasks submitted but not yet started, and workers not running one.
+	std::atomic<size_t> _queued;
+	std::atomic<size_t> _idle;
+	std::atomic<size_t> _taken;
+	std::atomic<size_t> _started;
+
+	static thread_local Worker* _self;
+
+	ThreadPool(void);
+
+	void grow(void);
+	void watch(void);
+	void push(Task&&, const void*);
+	void revoke(const void*);
+	void work(std::shared_ptr<Worker>);
+	bool find_task(Worker*, Task&);
+
+public:
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	static ThreadPool& instance(void);
+
+	/// By default, `min` is the number of cores, `max` is 1024,
+	/// `grow_msec` is 2, and idle workers above `min` exit after
+	/// 30 seconds.
+	void set_bounds(size_t min, size_t max,
+	                unsigned int grow_msec, unsigned int idle_secs);
+
+	/// Pin each worker to a CPU, filling one socket before going on to
+	/// the next, or stop doing so. Only workers started after the call
+	/// are affected. Off by default. Does nothing where the platform
+	/// has no way of pinning threads.
+	void set_affinity(bool);
+
+	/// Run the task in some worker; return at once. Exceptions
+	/// thrown by the task are logged, and otherwise ignored.
+	void submit(Task);
+
+	/// Run the task in some worker, after `secs` seconds; return at
+	/// once. No thread waits out the delay; the task sits on the
+	/// TimerWheel until it is due, and is then submitted.
+	void submit_after(double secs, Task);
+
+	/// Call `fn(i)` for each `i` from 0 to n-1, in parallel, and
+	/// return when all of them have returned. The calling thread
+	/// takes part. If any call throws, the first exception is
+	/// rethrown here, after the rest have finished.
+	void parallel_for(size_t n, const std::function<void(size_t)>& fn);
+
+	// Statistics
+	size_t size(void);           // The number of workers.
+	size_t idle(void) const { return _idle; }
+	size_t started(void) const { return _started; }
+	size_t min(void) const { return _min; }
+	size_t max(void) const { return _max; }
+};
+
+/// The process-wide pool.
+static inline ThreadPool& thread_pool(void)
+{
+	return ThreadPool::instance();
+}
+
+/** @}*/
+}
+
+#endif // _OPENCOG_THREAD_POOL_H
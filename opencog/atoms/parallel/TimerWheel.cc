@@ -0,0 +1,199 @@
+/*
+ * opencog/atoms/parallel/TimerWheel.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <cmath>
+#include <thread>
+
+#include <opencog/util/Logger.h>
+
+#include <opencog/atoms/parallel/TimerWheel.h>
+
+using namespace opencog;
+
+static constexpr uint64_t NEVER = UINT64_MAX;
+
+TimerWheel::TimerWheel(void) :
+	_epoch(Clock::now()),
+	_now(0),
+	_sleep_until(NEVER),
+	_pending(0)
+{
+	std::thread(&TimerWheel::run, this).detach();
+}
+
+TimerWheel& TimerWheel::instance(void)
+{
+	// Never deleted; see the comment in the header.
+	static TimerWheel* wheel = new TimerWheel();
+	return *wheel;
+}
+
+uint64_t TimerWheel::ticks(Clock::time_point when) const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		when - _epoch).count();
+}
+
+// ==============================================================
+
+// Place the timer in the lowest level that can hold it. An entry at
+// level L, in the slot for tick `due`, comes down a level when the
+// ticks reach `due`, rounded down to a multiple of SLOTS^L; that is
+// never later than `due`, and, as long as `due - _now` is less than
+// SLOTS^(L+1), never before the slot has been used for the current
+// round.
+void TimerWheel::insert(Timer&& tmr)
+{
+	if (tmr.due <= _now) tmr.due = _now + 1;
+	uint64_t delta = tmr.due - _now;
+
+	unsigned int level = 0;
+	while (level < LEVELS-1 and 0 != (delta >> (SLOT_BITS * (level+1))))
+		level++;
+
+	// Too far out; park it as far out as will go, to be put back
+	// when it comes round.
+	uint64_t due = tmr.due;
+	if (0 != (delta >> (SLOT_BITS * LEVELS)))
+		due = _now + (((uint64_t) 1) << (SLOT_BITS * LEVELS)) - 1;
+
+	size_t slot = (due >> (SLOT_BITS * level)) & (SLOTS-1);
+	_slots[level][slot].emplace_back(std::move(tmr));
+}
+
+void TimerWheel::cascade(unsigned int level)
+{
+	Slot tmrs;
+	tmrs.swap(_slots[level][(_now >> (SLOT_BITS * level)) & (SLOTS-1)]);
+	for (Timer& tmr : tmrs)
+		insert(std::move(tmr));
+}
+
+// Move on by one tick, collecting the tasks that are due.
+void TimerWheel::advance(std::vector<Task>& ready)
+{
+	_now++;
+
+	// The higher levels first, so that what they hand down can fall
+	// all the way through.
+	for (unsigned int level = LEVELS-1; 0 < level; level--)
+		if (0 == (_now & ((((uint64_t) 1) << (SLOT_BITS * level)) - 1)))
+			cascade(level);
+
+	Slot& slot(_slots[0][_now & (SLOTS-1)]);
+	for (Timer& tmr : slot)
+		ready.emplace_back(std::move(tmr.task));
+	_pending -= slot.size();
+	slot.clear();
+}
+
+// The next tick that has something to run, or to cascade.
+uint64_t TimerWheel::next_due(void) const
+{
+	if (0 == _pending) return NEVER;
+
+	bool upper = false;
+	for (unsigned int level = 1; level < LEVELS and not upper; level++)
+		for (size_t i = 0; i < SLOTS and not upper; i++)
+			upper = not _slots[level][i].empty();
+
+	for (uint64_t t = _now + 1; t <= _now + SLOTS; t++)
+	{
+		if (not _slots[0][t & (SLOTS-1)].empty()) return t;
+		if (upper and 0 == (t & (SLOTS-1))) return t;
+	}
+	return NEVER;
+}
+
+void TimerWheel::run(void)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (true)
+	{
+		_sleep_until = next_due();
+		if (NEVER == _sleep_until)
+			_wake.wait(lck);
+		else
+			_wake.wait_until(lck,
+				_epoch + std::chrono::milliseconds(_sleep_until));
+		_sleep_until = NEVER;
+
+		uint64_t now = ticks(Clock::now());
+		std::vector<Task> ready;
+		while (_now < now and 0 < _pending)
+			advance(ready);
+		if (0 == _pending and _now < now) _now = now;
+
+		if (ready.empty()) continue;
+		lck.unlock();
+		for (Task& task : ready)
+		{
+			try
+			{
+				task();
+			}
+			catch (const std::exception& ex)
+			{
+				logger().warn("Caught exception in timer task:\n%s",
+				              ex.what());
+			}
+		}
+		lck.lock();
+	}
+}
+
+// ==============================================================
+
+void TimerWheel::schedule(uint64_t msec, Task task)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	uint64_t now = ticks(Clock::now());
+
+	// With nothing waiting, the timer thread does not keep count of
+	// the ticks; catch up.
+	if (0 == _pending and _now < now) _now = now;
+
+	// The current tick is already partly gone; round up, so that the
+	// task never runs early.
+	uint64_t due = now + msec + 1;
+	insert(Timer{due, std::move(task)});
+	_pending++;
+
+	// Wake the timer thread only if it would sleep past this one.
+	if (due < _sleep_until)
+		_wake.notify_one();
+}
+
+void TimerWheel::schedule(double secs, Task task)
+{
+	if (not (0.0 < secs)) secs = 0.0;
+	schedule((uint64_t) std::ceil(1000.0 * secs), std::move(task));
+}
+
+size_t TimerWheel::pending(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _pending;
+}
+
+/* ===================== END OF FILE ===================== */
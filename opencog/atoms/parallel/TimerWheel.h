@@ -0,0 +1,132 @@
+/*
+ * opencog/atoms/parallel/TimerWheel.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_TIMER_WHEEL_H
+#define _OPENCOG_TIMER_WHEEL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A hierarchical timer wheel, shared by the whole process: tasks are
+ * run after a delay, by a single timer thread, so that waiting costs a
+ * list entry, and not a thread of its own.
+ *
+ * The wheel ticks once a millisecond, and has LEVELS levels of SLOTS
+ * slots each. Level 0 holds the tasks due within SLOTS ticks, one slot
+ * per tick; each level above holds tasks SLOTS times further out, one
+ * slot per SLOTS ticks of the level below. When the lowest level comes
+ * round to its first slot, the next slot of the level above is spread
+ * out over it; and so on up. Scheduling and running a task thus cost
+ * a constant amount of work, however many are waiting. Delays longer
+ * than the wheel can hold (about four and a half hours) are parked in
+ * the top level, and put back as they come round.
+ *
+ * The timer thread sleeps until the next tick that has something due,
+ * or that has to cascade; with nothing scheduled, it does not wake at
+ * all. Tasks run in the timer thread, so they should be short; they
+ * are meant to hand the real work on elsewhere, as
+ * ThreadPool::submit_after() does. Exceptions thrown by tasks are
+ * logged, and otherwise ignored.
+ *
+ * Like the ThreadPool, the wheel is never destroyed; tasks still
+ * waiting when the process exits are simply dropped.
+ */
+class TimerWheel
+{
+public:
+	typedef std::function<void(void)> Task;
+
+	static constexpr unsigned int SLOT_BITS = 6;
+	static constexpr unsigned int SLOTS = 1 << SLOT_BITS;
+	static constexpr unsigned int LEVELS = 4;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Timer
+	{
+		uint64_t due;     // The tick to run at.
+		Task task;
+	};
+	typedef std::vector<Timer> Slot;
+
+	std::mutex _mtx;
+	std::condition_variable _wake;
+	Clock::time_point _epoch;
+
+	// The last tick that was run, and the tick that the timer thread
+	// is sleeping until.
+	uint64_t _now;
+	uint64_t _sleep_until;
+	size_t _pending;
+	Slot _slots[LEVELS][SLOTS];
+
+	TimerWheel(void);
+
+	uint64_t ticks(Clock::time_point) const;
+	void insert(Timer&&);
+	void cascade(unsigned int level);
+	void advance(std::vector<Task>&);
+	uint64_t next_due(void) const;
+	void run(void);
+
+public:
+	TimerWheel(const TimerWheel&) = delete;
+	TimerWheel& operator=(const TimerWheel&) = delete;
+
+	static TimerWheel& instance(void);
+
+	/// Run the task, in the timer thread, after `msec` milliseconds;
+	/// return at once. Tasks due on the same tick run in no
+	/// particular order.
+	void schedule(uint64_t msec, Task);
+
+	/// As above, with the delay in seconds. Negative delays are taken
+	/// to be zero; the task then runs on the next tick.
+	void schedule(double secs, Task);
+
+	/// The number of tasks waiting to run.
+	size_t pending(void);
+};
+
+/// The process-wide timer wheel.
+static inline TimerWheel& timer_wheel(void)
+{
+	return TimerWheel::instance();
+}
+
+/** @}*/
+}
+
+#endif // _OPENCOG_TIMER_WHEEL_H
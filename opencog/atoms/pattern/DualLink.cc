@@ -66,6 +66,7 @@ void DualLink::init(void)
 	// smarter, at the cost of slowing down others. So we
 	// won't do that. We'll just hack it up here.
 	clauses_get_variables(_pat.pmandatory);
+	flatten_clauses();
 }
 
 DualLink::DualLink(const HandleSeq&& hseq, Type t)
@@ -54,7 +54,19 @@ QueueValuePtr MeetLink::do_execute(AtomSpace* as, bool silent)
 	try
 	{
 		SatisfyingSet sater(as);
+
+		// Gather statistics only if asked for.
+		SearchStats stats;
+		bool want_stats = nullptr != getValue(SearchStats::key());
+		if (want_stats) sater.set_stats(&stats);
+
+		auto start = std::chrono::steady_clock::now();
 		sater.satisfy(PatternLinkCast(get_handle()));
+		if (want_stats)
+		{
+			stats.elapsed = std::chrono::steady_clock::now() - start;
+			setValue(SearchStats::key(), stats.to_value());
+		}
 		return sater.get_result_queue();
 	}
 	catch(const StandardException& ex)
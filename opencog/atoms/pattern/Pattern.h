@@ -114,6 +114,20 @@ struct Pattern
 	/// As above, but clauses that hold two or more variables.
 	HandleSet cacheable_multi;
 
+	/// Absent clauses that are plain structures: no evaluatables,
+	/// globs, choices, quotes or scopes in them. Once all of their
+	/// variables are grounded, the only grounding that a search could
+	/// find for them is the clause itself, with the groundings filled
+	/// in; so they can be checked with a single lookup.
+	HandleSet probeable_absents;
+
+	/// For each cacheable mandatory clause, its canonical form, with
+	/// the variables renamed in order of appearance, followed by the
+	/// original variables in that same order. Alpha-equivalent clauses
+	/// have the same canonical form; this is used to share groundings
+	/// across searches. See ClauseCache.
+	std::map<Handle, HandleSeq> canonical_clauses;
+
 	/// For each clause, the list of variables that appear in that clause.
 	/// Used in conjunction with the `cacheable_multi` above.
 	std::map<PatternTermPtr, HandleSeq> clause_variables;
@@ -127,6 +141,10 @@ struct Pattern
 
 	ConnectTermMap   connected_terms_map;  // setup by make_term_trees()
 
+	/// The term trees of the clauses, flattened, for the pattern
+	/// matcher to walk. The terms point into these; see FlatTerm.
+	std::vector<std::shared_ptr<const FlatTermSeq>> flat_clauses;
+
 	std::string to_string(const std::string& indent) const;
 };
 
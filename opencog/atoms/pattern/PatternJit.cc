@@ -37,10 +37,25 @@ using namespace opencog;
  */
 PatternLinkPtr PatternLink::jit_analyze(void)
 {
-	PatternLinkPtr jit = PatternLinkCast(get_handle());
+	analyze();
 
 	// If there are no definitions, there is nothing to do.
-	if (0 == _pat.defined_terms.size()) return jit;
+	if (0 == _pat.defined_terms.size())
+		return PatternLinkCast(get_handle());
+
+	// Re-use the earlier expansion, if none of the definitions
+	// that went into it have changed since. If no definition has
+	// changed anywhere, then there is no need to look.
+	std::lock_guard<std::mutex> lck(_jit_mtx);
+	size_t changes = AtomSpace::definition_changes();
+	if (_jit and (changes == _jit_changes or jit_is_current()))
+	{
+		_jit_changes = changes;
+		return _jit;
+	}
+
+	_jit_defs.clear();
+	PatternLinkPtr jit = PatternLinkCast(get_handle());
 
 	// Now is the time to look up the definitions!
 	// We loop here, so that all recursive definitions are expanded
@@ -59,6 +74,7 @@ PatternLinkPtr PatternLink::jit_analyze(void)
 		{
 			Handle defn = DefineLink::get_definition(name);
 			if (not defn) continue;
+			_jit_defs.push_back({name, defn});
 
 			// Extract the variables in the definition.
 			// Either they are given in a LambdaLink, or, if absent,
@@ -97,7 +113,23 @@ PatternLinkPtr PatternLink::jit_analyze(void)
 	jit->debug_log("JIT expanded!");
 #endif
 
+	_jit = jit;
+	_jit_changes = changes;
 	return jit;
 }
 
+/// Return true if all of the definitions used for the cached
+/// expansion are still the ones in force.
+bool PatternLink::jit_is_current(void) const
+{
+	for (const HandlePair& nd : _jit_defs)
+	{
+		Handle defn;
+		try { defn = DefineLink::get_definition(nd.first); }
+		catch (const InvalidParamException&) { return false; }
+		if (defn != nd.second) return false;
+	}
+	return true;
+}
+
 /* ===================== END OF FILE ===================== */
@@ -28,6 +28,7 @@
 #include <opencog/atoms/base/Node.h>
 #include <opencog/atoms/core/FindUtils.h>
 #include <opencog/atoms/core/FreeLink.h>
+#include <opencog/atoms/core/Replacement.h>
 
 #include "BindLink.h"
 #include "DualLink.h"
@@ -36,6 +37,8 @@
 
 using namespace opencog;
 
+std::atomic<size_t> PatternLink::_deferrals(0);
+
 void PatternLink::common_init(void)
 {
 	locate_defines(_pat.pmandatory);
@@ -104,6 +107,8 @@ void PatternLink::common_init(void)
 	locate_cacheable(_pat.pmandatory);
 	locate_cacheable(_pat.absents);
 	locate_cacheable(_pat.always);
+	make_canonical_clauses(_pat.pmandatory);
+	locate_probeable(_pat.absents);
 }
 
 
@@ -192,14 +197,14 @@ void PatternLink::init_bottom(void)
 	// the body.  Otherwise, its a no-op.
 	Type t = _body->get_type();
 	if ((CHOICE_LINK == t or OR_LINK == t) and 1 < _body->get_arity())
-	{
 		disjointed_init();
-		return;
+	else
+	{
+		unbundle_clauses(_body);
+		common_init();
+		setup_components();
 	}
-
-	unbundle_clauses(_body);
-	common_init();
-	setup_components();
+	flatten_clauses();
 }
 
 void PatternLink::init(void)
@@ -226,6 +231,14 @@ void PatternLink::init(void)
 		      to_short_string().c_str());
 	}
 
+	make_plan();
+
+	// Put off the rest, if loading; see do_analyze().
+	if (0 < _deferrals)
+	{
+		_deferred = true;
+		return;
+	}
 	init_bottom();
 
 #ifdef QDEBUG
@@ -234,6 +247,39 @@ void PatternLink::init(void)
 #endif
 }
 
+/// Run the analysis that was put off when the link was created. The
+/// results are caches, filled in only once; so this is const. If it
+/// throws, whatever was filled in is dropped (the variables, too, as
+/// validate_variables() trims them), and the next use tries again, and
+/// throws again.
+void PatternLink::do_analyze(void) const
+{
+	PatternLink* self = const_cast<PatternLink*>(this);
+	std::call_once(self->_analyzed, [self]()
+	{
+		Variables vars(self->_variables);
+		try
+		{
+			self->init_bottom();
+		}
+		catch (...)
+		{
+			self->_variables = vars;
+			std::string name(self->_pat.redex_name);
+			self->_pat = Pattern();
+			self->_pat.redex_name = name;
+			self->_fixed.clear();
+			self->_num_virts = 0;
+			self->_virtual.clear();
+			self->_num_comps = 0;
+			self->_components.clear();
+			self->_component_vars.clear();
+			self->_component_patterns.clear();
+			throw;
+		}
+	});
+}
+
 /* ================================================================= */
 
 /// Special constructor used during just-in-time pattern compilation.
@@ -250,6 +296,7 @@ PatternLink::PatternLink(const Variables& vars, const Handle& body)
 	unbundle_clauses(_body);
 	common_init();
 	setup_components();
+	flatten_clauses();
 }
 
 /* ================================================================= */
@@ -278,6 +325,7 @@ PatternLink::PatternLink(const HandleSet& vars,
 		if (it != varspec._typemap.end())
 			_variables.unpack_vartype(HandleCast(it->second));
 	}
+	_variables.init_index();
 
 	// Next, the body... there's no `_body` for lambda. The `compo` is
 	// the mandatory clauses; we have to reconstruct the optionals.
@@ -320,6 +368,8 @@ PatternLink::PatternLink(const HandleSet& vars,
 
 	clauses_get_variables(_pat.pmandatory);
 	clauses_get_variables(_pat.absents);
+	locate_probeable(_pat.absents);
+	flatten_clauses();
 }
 
 /* ================================================================= */
@@ -335,6 +385,7 @@ PatternLink::PatternLink(const HandleSet& vars,
 	: PrenexLink(HandleSeq(), PATTERN_LINK)
 {
 	_variables.varset = vars;
+	_variables.init_index();
 	for (const Handle& clause : clauses)
 	{
 		PatternTermPtr root_term(make_term_tree(clause));
@@ -342,6 +393,7 @@ PatternLink::PatternLink(const HandleSet& vars,
 	}
 	common_init();
 	setup_components();
+	flatten_clauses();
 }
 
 /* ================================================================= */
@@ -498,6 +550,7 @@ bool PatternLink::record_literal(const PatternTermPtr& clause, bool reverse)
 		// We have to erase first, else it gets duplicated.
 		_variables.erase(h->getOutgoingAtom(0));
 		_variables.validate_vardecl(h);
+		_variables.init_index();
 		return true;
 	}
 
@@ -680,6 +733,84 @@ void PatternLink::locate_cacheable(const PatternTermSeq& clauses)
 
 /* ================================================================= */
 
+/// True if the tree holds nothing but plain structure: nothing that
+/// would let a search ground it in some other way than by filling in
+/// its variables.
+static bool is_plain_structure(const Handle& h)
+{
+	Type t = h->get_type();
+	if (QUOTE_LINK == t or UNQUOTE_LINK == t or LOCAL_QUOTE_LINK == t or
+	    GLOB_NODE == t or CHOICE_LINK == t or PRESENT_LINK == t or
+	    ABSENT_LINK == t or ALWAYS_LINK == t or
+	    DEFINED_PREDICATE_NODE == t or DEFINED_SCHEMA_NODE == t or
+	    nameserver().isA(t, SCOPE_LINK))
+		return false;
+
+	if (not h->is_link()) return true;
+	for (const Handle& ho : h->getOutgoingSet())
+		if (not is_plain_structure(ho)) return false;
+	return true;
+}
+
+/// Locate the absent clauses that can be checked with a lookup,
+/// instead of a search, once their variables are grounded. See
+/// `PatternMatchEngine::probe_absent()`.
+void PatternLink::locate_probeable(const PatternTermSeq& clauses)
+{
+	for (const PatternTermPtr& ptm: clauses)
+	{
+		if (ptm->hasAnyEvaluatable() or ptm->hasAnyGlobbyVar() or
+		    ptm->isChoice() or ptm->isIdentical()) continue;
+
+		const Handle& clause = ptm->getHandle();
+		if (ptm->getQuote() != clause) continue;
+		if (not is_plain_structure(clause)) continue;
+
+		_pat.probeable_absents.insert(clause);
+	}
+}
+
+/* ================================================================= */
+
+/// Rename the variables in each cacheable clause, in order of first
+/// appearance, so that alpha-equivalent clauses, in different patterns,
+/// end up looking exactly alike. This allows their groundings to be
+/// shared, by the ClauseCache.
+void PatternLink::make_canonical_clauses(const PatternTermSeq& clauses)
+{
+	for (const PatternTermPtr& ptm: clauses)
+	{
+		if (ptm->isAbsent() or ptm->isChoice()) continue;
+
+		// The engine caches quoted clauses unquoted in some places,
+		// and quoted in others; leave them alone.
+		const Handle& clause = ptm->getHandle();
+		if (ptm->getQuote() != clause) continue;
+
+		if (_pat.cacheable_clauses.end() == _pat.cacheable_clauses.find(clause)
+		    and _pat.cacheable_multi.end() == _pat.cacheable_multi.find(clause))
+			continue;
+
+		FreeVariables fv;
+		fv.find_variables(clause);
+
+		HandleSeq cseq({Handle::UNDEFINED});
+		HandleMap alpha;
+		for (const Handle& v: fv.varseq)
+		{
+			if (_variables.varset.end() == _variables.varset.find(v))
+				continue;
+			alpha.insert({v, createNode(VARIABLE_NODE,
+				"$cc-" + std::to_string(alpha.size()))});
+			cseq.emplace_back(v);
+		}
+		cseq[0] = Replacement::replace_nocheck(clause, alpha);
+		_pat.canonical_clauses.insert({clause, cseq});
+	}
+}
+
+/* ================================================================= */
+
 /// get_clause_variables -- Make note of the variables in this term.
 /// This is used at runtime, to determine if the clause has been fully
 /// grounded (or not).
@@ -706,6 +837,19 @@ void PatternLink::clauses_get_variables(const PatternTermSeq& clauses)
 		get_clause_variables(ptm);
 }
 
+/// Compile the clauses into flat arrays, for the pattern matcher to
+/// walk. This comes last, once all of the terms have been marked up.
+void PatternLink::flatten_clauses(void)
+{
+	for (const PatternTermSeq* clauses :
+	     {&_pat.pmandatory, &_pat.absents, &_pat.always})
+	{
+		for (const PatternTermPtr& ptm : *clauses)
+			if (nullptr == ptm->getFlat())
+				_pat.flat_clauses.emplace_back(PatternTerm::flatten(ptm));
+	}
+}
+
 /* ================================================================= */
 /**
  * Make sure that each declared variable appears in some clause.
@@ -1075,6 +1219,10 @@ void PatternLink::make_term_tree_recursive(const PatternTermPtr& root,
 	{
 		ptm->addBoundVariable();
 
+		const auto& idx = _variables.index.find(h);
+		if (_variables.index.end() != idx)
+			ptm->setVarSlot(idx->second);
+
 		// It's globby, if it is explicitly a GLOB_NODE, or if
 		// it has a non-trivial matching interval.
 		if (GLOB_NODE == t or _variables.is_globby(h))
@@ -1231,13 +1379,14 @@ void PatternLink::check_connectivity(const HandleSeqSeq& components)
 
 /* ================================================================= */
 
-void PatternLink::debug_log(std::string msg) const
+void PatternLink::debug_log(const char* msg) const
 {
 	if (not logger().is_fine_enabled())
 		return;
+	analyze();
 
 	// Log the pattern ...
-	logger().fine("Pattern debug log from '%s'", msg.c_str());
+	logger().fine("Pattern debug log from '%s'", msg);
 	logger().fine("Pattern '%s' summary:",
 	              _pat.redex_name.c_str());
 	logger().fine("%lu mandatory terms", _pat.pmandatory.size());
@@ -1297,6 +1446,7 @@ DEFINE_LINK_FACTORY(PatternLink, PATTERN_LINK)
 // XXX FIXME: debug_log() above is more readable than the below.
 std::string PatternLink::to_long_string(const std::string& indent) const
 {
+	analyze();
 	std::string indent_p = indent + oc_to_string_indent;
 	std::stringstream ss;
 	ss << to_string(indent) << std::endl;
@@ -23,6 +23,8 @@
 #ifndef _OPENCOG_PATTERN_LINK_H
 #define _OPENCOG_PATTERN_LINK_H
 
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 
 #include <opencog/atoms/core/Quotation.h>
@@ -110,6 +112,27 @@ protected:
 	HandleSetSeq _component_vars;
 	HandleSeq _component_patterns;
 
+	/// The just-in-time expansion of the defined terms, kept so that
+	/// it need not be redone on every execution. The `_jit_defs` are
+	/// the (name, definition) pairs that it was expanded from; if any
+	/// of these definitions change, the expansion is redone. They need
+	/// not be looked at again, while AtomSpace::definition_changes()
+	/// stays at `_jit_changes`.
+	std::mutex _jit_mtx;
+	PatternLinkPtr _jit;
+	HandlePairSeq _jit_defs;
+	size_t _jit_changes = 0;
+	bool jit_is_current(void) const;
+
+	/// Set, if the analysis of the clauses was put off when the link
+	/// was created; it is then run when the pattern is first used.
+	bool _deferred = false;
+	std::once_flag _analyzed;
+	void analyze(void) const { if (_deferred) do_analyze(); }
+	void do_analyze(void) const;
+
+	static std::atomic<size_t> _deferrals;
+
 	PatternTermPtr make_term_tree(const Handle&);
 	void make_term_tree_recursive(const PatternTermPtr&,
 	                              PatternTermPtr&);
@@ -132,6 +155,8 @@ protected:
 	bool is_virtual(const Handle&);
 
 	void locate_cacheable(const PatternTermSeq& clauses);
+	void locate_probeable(const PatternTermSeq& clauses);
+	void make_canonical_clauses(const PatternTermSeq& clauses);
 
 	bool need_dummies(const PatternTermPtr&);
 	bool add_unaries(const PatternTermPtr&);
@@ -145,6 +170,7 @@ protected:
 
 	void get_clause_variables(const PatternTermPtr&);
 	void clauses_get_variables(const PatternTermSeq&);
+	void flatten_clauses(void);
 
 	void init(void);
 	void init_bottom(void);
@@ -179,21 +205,36 @@ public:
 	PatternLink(const HandleSet&,
 	            const HandleSeq&);
 
+	/// While any Deferral is held, anywhere, the PatternLinks that are
+	/// created find their variables, but put off the analysis of their
+	/// clauses until they are first used. This is for loading Atoms in
+	/// bulk, from storage; most of the patterns loaded are never run.
+	/// Errors in the clauses are then reported when the pattern is
+	/// run, and not when it is loaded.
+	class Deferral
+	{
+	public:
+		Deferral(void) { _deferrals++; }
+		~Deferral() { _deferrals--; }
+	};
+
 	// Runtime just-in-time analysis
 	PatternLinkPtr jit_analyze(void);
 
 	// Return the list of variables we are holding.
 	const Variables& get_variables(void) const { return _variables; }
-	const Pattern& get_pattern(void) const { return _pat; }
+	const Pattern& get_pattern(void) const { analyze(); return _pat; }
 
-	const HandleSeqSeq& get_components(void) const { return _components; }
+	const HandleSeqSeq& get_components(void) const
+		{ analyze(); return _components; }
 	const HandleSeq& get_component_patterns(void) const
-		{ return _component_patterns; }
+		{ analyze(); return _component_patterns; }
 
 	// Return the list virtual clauses we are holding.
-	const HandleSeq& get_virtual(void) const { return _virtual; }
+	const HandleSeq& get_virtual(void) const
+		{ analyze(); return _virtual; }
 
-	void debug_log(std::string) const;
+	void debug_log(const char*) const;
 
 	static Handle factory(const Handle&);
 
@@ -22,6 +22,7 @@ PatternTerm::PatternTerm(void)
 	  _has_any_bound_var(false),
 	  _has_bound_var(false),
 	  _is_bound_var(false),
+	  _var_slot(-1),
 	  _has_any_globby_var(false),
 	  _has_globby_var(false),
 	  _is_globby_var(false),
@@ -35,7 +36,8 @@ PatternTerm::PatternTerm(void)
 	  _is_absent(false),
 	  _is_choice(false),
 	  _has_choice(false),
-	  _is_always(false)
+	  _is_always(false),
+	  _flat(nullptr)
 {}
 
 PatternTerm::PatternTerm(const PatternTermPtr& parent, const Handle& h)
@@ -45,6 +47,7 @@ PatternTerm::PatternTerm(const PatternTermPtr& parent, const Handle& h)
 	  _has_any_bound_var(false),
 	  _has_bound_var(false),
 	  _is_bound_var(false),
+	  _var_slot(-1),
 	  _has_any_globby_var(false),
 	  _has_globby_var(false),
 	  _is_globby_var(false),
@@ -58,7 +61,8 @@ PatternTerm::PatternTerm(const PatternTermPtr& parent, const Handle& h)
 	  _is_absent(false),
 	  _is_choice(false),
 	  _has_choice(false),
-	  _is_always(false)
+	  _is_always(false),
+	  _flat(nullptr)
 {
 	Type t = h->get_type();
 
@@ -111,6 +115,44 @@ PatternTermPtr PatternTerm::getOutgoingTerm(Arity pos) const
 	}
 }
 
+// ==============================================================
+
+static void flatten_rec(const PatternTermPtr& ptm, FlatTermSeq& seq)
+{
+	uint16_t flags = 0;
+	if (ptm->isBoundVariable()) flags |= FlatTerm::BOUND_VAR;
+	if (ptm->hasAnyBoundVariable()) flags |= FlatTerm::ANY_BOUND_VAR;
+	if (ptm->hasGlobbyVar()) flags |= FlatTerm::GLOBBY_VAR;
+	if (ptm->hasAnyEvaluatable()) flags |= FlatTerm::ANY_EVALUATABLE;
+	if (ptm->isUnorderedLink()) flags |= FlatTerm::UNORDERED;
+	if (ptm->isChoice()) flags |= FlatTerm::CHOICE;
+	if (ptm->isQuoted()) flags |= FlatTerm::QUOTED;
+	if (ptm->isLink()) flags |= FlatTerm::LINK;
+
+	size_t at = seq.size();
+	seq.push_back({ptm, 1, (uint16_t) ptm->getArity(), flags});
+	for (const PatternTermPtr& sub : ptm->getOutgoingSet())
+		flatten_rec(sub, seq);
+	seq[at].size = seq.size() - at;
+}
+
+std::shared_ptr<const FlatTermSeq> PatternTerm::flatten(const PatternTermPtr& root)
+{
+	FlatTermSeq* seq = new FlatTermSeq();
+	flatten_rec(root, *seq);
+
+	// Only now, that the array will not move.
+	for (FlatTerm& ft : *seq)
+		ft.term->_flat = &ft;
+
+	return std::shared_ptr<const FlatTermSeq>(seq,
+		[](FlatTermSeq* s)
+		{
+			for (FlatTerm& ft : *s) ft.term->_flat = nullptr;
+			delete s;
+		});
+}
+
 /**
  * isDescendant - return true if `this` is a lineal descendant of `ptm`.
  * That is, return true if `ptm` appears as a parent somewhere in the
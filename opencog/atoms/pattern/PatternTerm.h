@@ -11,6 +11,7 @@
 #ifndef _OPENCOG_PATTERN_TERM_H
 #define _OPENCOG_PATTERN_TERM_H
 
+#include <cstdint>
 #include <vector>
 
 #include <opencog/util/Logger.h>
@@ -70,6 +71,39 @@ typedef std::vector<PatternTermPtr> PatternTermSeq;
 typedef std::vector<PatternTermWPtr> PatternTermWSeq;
 typedef std::set<PatternTermPtr> PatternTermSet;
 
+/**
+ * The term tree of a clause, compiled into one array, in preorder.
+ * The children of an entry come after it: the first one right after
+ * it, and each of the others `size` entries after the one before.
+ * The pattern matcher walks these, instead of the tree, so that it
+ * does not build outgoing sets, or lock weak pointers, as it goes.
+ * The flags are a packed copy of those of the term.
+ */
+struct FlatTerm
+{
+	enum : uint16_t
+	{
+		BOUND_VAR = 1,
+		ANY_BOUND_VAR = 2,
+		GLOBBY_VAR = 4,
+		ANY_EVALUATABLE = 8,
+		UNORDERED = 16,
+		CHOICE = 32,
+		QUOTED = 64,
+		LINK = 128,
+	};
+
+	PatternTermPtr term;
+	uint32_t size;   // This entry, and all of its descendants.
+	uint16_t arity;
+	uint16_t flags;
+
+	bool is(uint16_t f) const noexcept { return f & flags; }
+	const FlatTerm* first(void) const noexcept { return this + 1; }
+	const FlatTerm* next(void) const noexcept { return this + size; }
+};
+typedef std::vector<FlatTerm> FlatTermSeq;
+
 class PatternTerm
 	: public std::enable_shared_from_this<PatternTerm>
 {
@@ -101,6 +135,11 @@ protected:
 	// As above, but zero terms deep. This one is the variable.
 	bool _is_bound_var;
 
+	// If this is a bound variable, its ordinal in the variable
+	// declaration of the pattern; else -1. The pattern engine uses
+	// this to keep variable groundings in a flat array.
+	int _var_slot;
+
 	// True if any pattern subtree rooted in this tree node contains
 	// an GlobNode. Trees without any GlobNodes can be searched in a
 	// straight-forward manner; those with them need to have all
@@ -163,6 +202,9 @@ protected:
 	// the ALWAYS_LINK in the default interpretation.
 	bool _is_always;
 
+	// This term, in the flattened clause that holds it, if any.
+	const FlatTerm* _flat;
+
 	void addAnyBoundVar();
 	void addAnyGlobbyVar();
 	void addAnyEvaluatable();
@@ -215,6 +257,8 @@ public:
 	bool hasAnyBoundVariable() const noexcept { return _has_any_bound_var; }
 	bool hasBoundVariable() const noexcept { return _has_bound_var; }
 	bool isBoundVariable() const noexcept { return _is_bound_var; }
+	void setVarSlot(int slot) noexcept { _var_slot = slot; }
+	int getVarSlot() const noexcept { return _var_slot; }
 
 	void addGlobbyVar();
 	bool hasAnyGlobbyVar() const noexcept { return _has_any_globby_var; }
@@ -236,6 +280,12 @@ public:
 	bool isUnorderedLink() const noexcept { return _handle->is_unordered_link(); }
 	bool isLink() const noexcept { return _handle->is_link(); }
 
+	/// Compile the tree under `root` into a FlatTerm array, and point
+	/// each of its terms at their entry. The terms are pointed away
+	/// again, when the array goes.
+	static std::shared_ptr<const FlatTermSeq> flatten(const PatternTermPtr& root);
+	const FlatTerm* getFlat() const noexcept { return _flat; }
+
 	bool contained_in(const std::vector<PatternTermPtr>& vect) {
 		for (const PatternTermPtr& itm : vect)
 			if (itm->_handle == _handle) return true; // XXX maybe quote?
@@ -20,6 +20,10 @@
  * Free Software Foundation, Inc.,
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
 #include <opencog/atoms/core/FindUtils.h>
 #include "PatternUtils.h"
 
@@ -98,6 +102,17 @@ bool is_constant(const HandleSet& vars, const Handle& clause)
  * speeds up the discovery of the next ungrounded clause: it is
  * trivially just the very next clause in the connected set.  Of
  * course, users will typically never specify clauses in such order.
+ *
+ * The components, and the order of the clauses in them, are those of
+ * the simple algorithm: start a component with the last clause that
+ * is not in one yet, then sweep over the remaining clauses, over and
+ * over, adding each one that shares a variable with the component,
+ * until a sweep adds nothing. Sweeping is quadratic, though, and
+ * generated patterns can have hundreds of clauses. So, instead, the
+ * variables of each clause are found once, and the sweep that would
+ * add a clause is worked out directly: it is the first one that
+ * reaches the clause after one of its variables joined the component.
+ * Clauses are then added in that order, off of a priority queue.
  */
 
 // A clause is connected if any of the `cur_vars` appear in the clause.
@@ -115,10 +130,11 @@ bool is_connected(const Handle& cl, const HandleSet& cur_vars)
 	return false;
 }
 
-void get_connected_components(const HandleSet& vars,
-                              const HandleSeq& clauses,
-                              HandleSeqSeq& components,
-                              HandleSetSeq& component_vars)
+// Add clauses to the components already found, a clause at a time.
+static void attach_clauses(const HandleSet& vars,
+                           const HandleSeq& clauses,
+                           HandleSeqSeq& components,
+                           HandleSetSeq& component_vars)
 {
 	HandleSeq todo(clauses);
 
@@ -183,6 +199,114 @@ void get_connected_components(const HandleSet& vars,
 	}
 }
 
+void get_connected_components(const HandleSet& vars,
+                              const HandleSeq& clauses,
+                              HandleSeqSeq& components,
+                              HandleSetSeq& component_vars)
+{
+	// This is only ever used to attach one or two more clauses.
+	if (0 < components.size())
+	{
+		attach_clauses(vars, clauses, components, component_vars);
+		return;
+	}
+
+	size_t ncl = clauses.size();
+	if (0 == ncl) return;
+
+	// The variables of each clause, and the clauses of each variable.
+	// A clause with no variables at all connects to anything.
+	std::vector<HandleSet> clvars(ncl);
+	std::vector<bool> novars(ncl);
+	std::unordered_map<Handle, std::vector<size_t>> holders;
+	for (size_t i = 0; i < ncl; i++)
+	{
+		const Handle& cl(clauses[i]);
+		FindAtoms fv(vars);
+		fv.search_set(cl);
+		clvars[i].swap(fv.varset);
+		for (const Handle& v : clvars[i])
+			holders[v].push_back(i);
+		novars[i] = not contains_atomtype(cl, VARIABLE_NODE) and
+		            not contains_atomtype(cl, GLOB_NODE);
+	}
+
+	// The moment the sweep is at clause i, in sweep p, is at
+	// p * (ncl+1) + i. A component is started at the end of sweep 0.
+	const uint64_t stride = ncl + 1;
+	auto next_visit = [stride](size_t i, uint64_t now)
+	{
+		uint64_t sweep = now / stride;
+		if (i <= now % stride) sweep++;
+		return sweep * stride + i;
+	};
+
+	typedef std::pair<uint64_t, size_t> When;
+	std::priority_queue<When, std::vector<When>, std::greater<When>> queue;
+	std::vector<uint64_t> when(ncl, std::numeric_limits<uint64_t>::max());
+	std::vector<bool> placed(ncl, false);
+	UnorderedHandleSet joined;
+	size_t last = ncl;
+
+	while (true)
+	{
+		while (0 < last and placed[last-1]) last--;
+		if (0 == last) break;
+
+		HandleSeq comp;
+		HandleSet comp_vars;
+		auto place = [&](size_t i, uint64_t now)
+		{
+			placed[i] = true;
+			comp.emplace_back(clauses[i]);
+			for (const Handle& v : clvars[i])
+			{
+				comp_vars.insert(v);
+
+				// The other clauses of a variable need to be looked at
+				// only when it first joins.
+				if (not joined.insert(v).second) continue;
+				for (size_t j : holders[v])
+				{
+					if (placed[j]) continue;
+					uint64_t t = next_visit(j, now);
+					if (t < when[j])
+					{
+						when[j] = t;
+						queue.push({t, j});
+					}
+				}
+			}
+		};
+
+		uint64_t start = ncl;
+		place(last-1, start);
+
+		// The first component takes all of the clauses with no
+		// variables; they connect to it as soon as it exists.
+		if (components.empty())
+		{
+			for (size_t i = 0; i < ncl; i++)
+			{
+				if (placed[i] or not novars[i]) continue;
+				when[i] = next_visit(i, start);
+				queue.push({when[i], i});
+			}
+		}
+
+		while (not queue.empty())
+		{
+			When w(queue.top());
+			queue.pop();
+			if (placed[w.second] or w.first != when[w.second]) continue;
+			place(w.second, w.first);
+		}
+
+		components.emplace_back(std::move(comp));
+		component_vars.emplace_back(std::move(comp_vars));
+	}
+}
+
 void get_bridged_components(const HandleSet& vars,
                             const PatternTermSeq& prsnts,
                             const PatternTermSeq& absnts,
@@ -48,7 +48,14 @@ void QueryLink::init(void)
 
 	_pat.redex_name = "anonymous QueryLink";
 	extract_variables(_outgoing);
+	make_plan();
 
+	// Put off the rest, if loading; see PatternLink::do_analyze().
+	if (0 < _deferrals)
+	{
+		_deferred = true;
+		return;
+	}
 	init_bottom();
 
 #ifdef QDEBUG
@@ -164,7 +171,8 @@ QueueValuePtr QueryLink::do_execute(AtomSpace* as, bool silent)
 	 * in the URE, for doing disconnected searches.
 	 */
 	bool do_conn_check=false;
-	if (do_conn_check and 0 == _virtual.size() and 1 < _components.size())
+	if (do_conn_check and 0 == get_virtual().size() and
+	    1 < get_components().size())
 		throw InvalidParamException(TRACE_INFO,
 		                            "QueryLink consists of multiple "
 		                            "disconnected components!");
@@ -172,9 +180,20 @@ QueueValuePtr QueryLink::do_execute(AtomSpace* as, bool silent)
 	Implicator impl(as);
 	impl.implicand = this->get_implicand();
 
+	// Gather statistics only if asked for.
+	SearchStats stats;
+	bool want_stats = nullptr != getValue(SearchStats::key());
+	if (want_stats) impl.set_stats(&stats);
+
 	try
 	{
+		auto start = std::chrono::steady_clock::now();
 		impl.satisfy(PatternLinkCast(get_handle()));
+		if (want_stats)
+		{
+			stats.elapsed = std::chrono::steady_clock::now() - start;
+			setValue(SearchStats::key(), stats.to_value());
+		}
 	}
 	catch(const StandardException& ex)
 	{
@@ -210,7 +229,7 @@ QueueValuePtr QueryLink::do_execute(AtomSpace* as, bool silent)
 	TermMatchMixin* intu =
 		dynamic_cast<TermMatchMixin*>(&impl);
 	if (0 == pat.pmandatory.size() and 0 < pat.absents.size()
-	    and not intu->optionals_present())
+	    and not intu->optionals_present() and not impl.is_truncated())
 	{
 		qv->open();
 		for (const Handle& himp: impl.implicand)
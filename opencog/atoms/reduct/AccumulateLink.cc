@@ -55,41 +55,34 @@ ValuePtr AccumulateLink::execute(AtomSpace* as, bool silent)
 
 	// If its a plain number, assume it's a vector, and sum.
 	if (NUMBER_NODE == vitype)
-	{
-		const std::vector<double>& dvec(NumberNodeCast(vi)->value());
-		double acc = 0.0;
-		for (double dv : dvec)
-			acc += dv;
-		return createNumberNode(acc);
-	}
+		return createNumberNode(sum(NumberNodeCast(vi)->value()));
 
 	// If its a float value, it's a vector. Sum.
 	if (nameserver().isA(vitype, FLOAT_VALUE))
-	{
-		const std::vector<double>& dvec(FloatValueCast(vi)->value());
-		double acc = 0.0;
-		for (double dv : dvec)
-			acc += dv;
-		return createFloatValue(acc);
-	}
+		return createFloatValue(sum(FloatValueCast(vi)->value()));
 
-	// If it's a link value, assume its a list of floats. Sum.
+	// If it's a link value, assume its a list of number vectors, and
+	// sum them element by element, all into one accumulator.
 	if (nameserver().isA(vitype, LINK_VALUE))
 	{
 		const std::vector<ValuePtr>& lvec(LinkValueCast(vi)->value());
 		std::vector<double> acc;
 		for (const ValuePtr& lv : lvec)
 		{
+			const std::vector<double>* dvec;
 			Type lvtype = lv->get_type();
-			if (not nameserver().isA(lvtype, FLOAT_VALUE)) continue;
-
-			const std::vector<double>& dvec(FloatValueCast(lv)->value());
-
-			if (acc.size() < dvec.size())
-				acc.resize(dvec.size());
-			acc = plus(acc, dvec);
+			if (NUMBER_NODE == lvtype)
+				dvec = &NumberNodeCast(lv)->value();
+			else if (nameserver().isA(lvtype, FLOAT_VALUE))
+				dvec = &FloatValueCast(lv)->value();
+			else
+				continue;
+
+			if (acc.size() < dvec->size())
+				acc.resize(dvec->size());
+			acc = plus(std::move(acc), *dvec);
 		}
-		return createFloatValue(acc);
+		return createFloatValue(std::move(acc));
 	}
 
 	// If it did not fully reduce, then return the best-possible
@@ -26,7 +26,9 @@
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/NumberNode.h>
+#include <opencog/atoms/value/FloatValue.h>
 #include "ArithmeticLink.h"
+#include "NumericFunctionLink.h"
 
 using namespace opencog;
 
@@ -47,6 +49,7 @@ void ArithmeticLink::init(void)
 		throw InvalidParamException(TRACE_INFO, "Expecting an ArithmeticLink");
 
 	_commutative = false;
+	_unboxed = false;
 }
 
 // ===========================================================
@@ -88,7 +91,7 @@ ValuePtr ArithmeticLink::delta_reduce(AtomSpace* as, bool silent) const
 	Handle road(reorder());
 	ArithmeticLinkPtr alp(ArithmeticLinkCast(road));
 
-	ValuePtr red(alp->FoldLink::delta_reduce(as, silent));
+	ValuePtr red(alp->fold(as, silent));
 
 	if (nullptr == red or not red->is_atom()) return red;
 
@@ -99,6 +102,72 @@ ValuePtr ArithmeticLink::delta_reduce(AtomSpace* as, bool silent) const
 
 // ============================================================
 
+std::vector<double>
+ArithmeticLink::kons_numbers(const std::vector<double>&,
+                             std::vector<double>&&) const
+{
+	throw RuntimeException(TRACE_INFO,
+		"Not implemented for %s", to_short_string().c_str());
+}
+
+/// fold() -- same as FoldLink::delta_reduce(), except that numbers
+/// are folded together as plain vectors of doubles.
+///
+/// Having kons() do it would box each partial result into a new
+/// NumberNode or FloatValue, only to unbox it again at the next step.
+/// Here, the numbers at the end of the list are all folded first, and
+/// only the total is boxed, when the fold is done, or when something
+/// that is not a number is met, and kons() has to take over. The
+/// result has the same type that kons() would have given it: a
+/// NumberNode, unless any of the numbers was a FloatValue.
+ValuePtr ArithmeticLink::fold(AtomSpace* as, bool silent) const
+{
+	if (not _unboxed) return FoldLink::delta_reduce(as, silent);
+
+	ValuePtr expr = knil;
+	std::vector<double> acc;
+	size_t nnum = 0;
+	bool is_float = false;
+
+	auto box = [&]() -> ValuePtr
+	{
+		if (nnum < 2) return expr;
+		if (is_float) return createFloatValue(std::move(acc));
+		return createNumberNode(acc);
+	};
+
+	for (int i = _outgoing.size() - 1; 0 <= i; i--)
+	{
+		ValuePtr vi(NumericFunctionLink::get_value(as, silent, _outgoing[i]));
+		Type vt = vi->get_type();
+		bool is_nu = (NUMBER_NODE == vt);
+		bool is_fv = nameserver().isA(vt, FLOAT_VALUE);
+
+		// Not a number. Box up what has been folded so far, and let
+		// kons() deal with the rest. The argument has been executed
+		// already; hand over the result, unless kons() needs the atom.
+		if (not is_nu and not is_fv)
+		{
+			expr = kons(as, silent, vi->is_atom() ? vi : ValuePtr(_outgoing[i]), box());
+			for (i--; 0 <= i; i--)
+				expr = kons(as, silent, _outgoing[i], expr);
+			return expr;
+		}
+
+		const std::vector<double>& vec(is_nu ?
+			NumberNodeCast(vi)->value() : FloatValueCast(vi)->value());
+		if (is_fv) is_float = true;
+
+		if (0 == nnum) { expr = vi; acc = vec; }
+		else acc = kons_numbers(vec, std::move(acc));
+		nnum++;
+	}
+
+	return box();
+}
+
+// ============================================================
+
 /// re-order the contents of an ArithmeticLink into "lexicographic" order.
 /// This provides a canonical order that helps guarantee reduction.
 ///
@@ -152,6 +221,9 @@ Handle ArithmeticLink::reorder(void) const
 	for (const Handle& h : exprs) result.push_back(h);
 	for (const Handle& h : numbers) result.push_back(h);
 
+	// Already in order; no need for a copy.
+	if (result == _outgoing) return get_handle();
+
 	return Handle(createLink(std::move(result), get_type()));
 }
 
@@ -43,6 +43,13 @@ protected:
 	virtual Handle reorder(void) const;
 	bool _commutative;
 
+	// If set, then kons_numbers() is used to fold numbers together,
+	// without making an atom or value for each partial result.
+	bool _unboxed;
+	virtual std::vector<double> kons_numbers(const std::vector<double>&,
+	                                         std::vector<double>&&) const;
+	ValuePtr fold(AtomSpace*, bool) const;
+
 
 public:
 	ArithmeticLink(const HandleSeq&&, Type=ARITHMETIC_LINK);
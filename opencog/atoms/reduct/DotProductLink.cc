@@ -0,0 +1,74 @@
+/*
+ * opencog/atoms/reduct/DotProductLink.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atoms/core/NumberNode.h>
+#include "DotProductLink.h"
+
+using namespace opencog;
+
+DotProductLink::DotProductLink(const HandleSeq&& oset, Type t)
+    : NumericFunctionLink(std::move(oset), t)
+{
+	init();
+}
+
+DotProductLink::DotProductLink(const Handle& a, const Handle& b)
+    : NumericFunctionLink({a, b}, DOT_PRODUCT_LINK)
+{
+	init();
+}
+
+void DotProductLink::init(void)
+{
+	Type tscope = get_type();
+	if (not nameserver().isA(tscope, DOT_PRODUCT_LINK))
+		throw InvalidParamException(TRACE_INFO, "Expecting a DotProductLink");
+
+	size_t nargs = _outgoing.size();
+	if (2 != nargs)
+		throw InvalidParamException(TRACE_INFO,
+			"DotProductLink expects two, got %s",
+			to_string().c_str());
+}
+
+// ============================================================
+
+ValuePtr DotProductLink::execute(AtomSpace* as, bool silent)
+{
+	// get_value() causes execution to happen on the arguments
+	ValuePtr vx(get_value(as, silent, _outgoing[0]));
+	ValuePtr vy(get_value(as, silent, _outgoing[1]));
+
+	Type vxtype;
+	const std::vector<double>* xvec = get_vector(as, silent, vx, vxtype);
+
+	Type vytype;
+	const std::vector<double>* yvec = get_vector(as, silent, vy, vytype);
+
+	if (xvec and yvec)
+	{
+		double prod = dot(*xvec, *yvec);
+		if (NUMBER_NODE == vxtype and NUMBER_NODE == vytype)
+			return createNumberNode(prod);
+		return createFloatValue(prod);
+	}
+
+	// If it did not fully reduce, then return the best-possible
+	// reduction that we did get.
+	if (vx->is_atom() and vy->is_atom())
+		return createDotProductLink(HandleCast(vx), HandleCast(vy));
+
+	// Unable to reduce at all. Just return the original atom.
+	return get_handle();
+}
+
+DEFINE_LINK_FACTORY(DotProductLink, DOT_PRODUCT_LINK);
+
+// ============================================================
@@ -0,0 +1,48 @@
+/*
+ * opencog/atoms/reduct/DotProductLink.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef _OPENCOG_DOT_PRODUCT_LINK_H
+#define _OPENCOG_DOT_PRODUCT_LINK_H
+
+#include <opencog/atoms/reduct/NumericFunctionLink.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * The DotProductLink implements the inner product of two vectors.
+ *    (DotProduct (Number a b c) (Number d e f))  is just ad+be+cf.
+ * If one vector is shorter than the other, it is zero-padded.
+ */
+class DotProductLink : public NumericFunctionLink
+{
+protected:
+	void init(void);
+
+public:
+	DotProductLink(const Handle& a, const Handle& b);
+	DotProductLink(const HandleSeq&&, Type=DOT_PRODUCT_LINK);
+
+	DotProductLink(const DotProductLink&) = delete;
+	DotProductLink& operator=(const DotProductLink&) = delete;
+
+	virtual ValuePtr execute(AtomSpace*, bool);
+
+	static Handle factory(const Handle&);
+};
+
+LINK_PTR_DECL(DotProductLink)
+#define createDotProductLink CREATE_DECL(DotProductLink)
+
+/** @}*/
+}
+
+#endif // _OPENCOG_DOT_PRODUCT_LINK_H
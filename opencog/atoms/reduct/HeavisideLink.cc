@@ -46,13 +46,11 @@ void HeavisideLink::init(void)
 
 // ============================================================
 
-static double impulse(double x) {return 1-std::signbit(x); }
-
 ValuePtr HeavisideLink::execute(AtomSpace* as, bool silent)
 {
 	ValuePtr reduction;
-	ValuePtr result(apply_func(as, silent,
-		_outgoing[0], impulse, reduction));
+	ValuePtr result(apply_func(as, silent, _outgoing[0],
+		[](double x) { return 1.0 - std::signbit(x); }, reduction));
 
 	if (result) return result;
 
@@ -44,8 +44,8 @@ void Log2Link::init(void)
 ValuePtr Log2Link::execute(AtomSpace* as, bool silent)
 {
 	ValuePtr reduction;
-	ValuePtr result(apply_func(as, silent,
-		_outgoing[0], log2, reduction));
+	ValuePtr result(apply_func(as, silent, _outgoing[0],
+		[](double x) { return log2(x); }, reduction));
 
 	if (result) return result;
 
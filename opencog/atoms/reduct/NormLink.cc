@@ -0,0 +1,69 @@
+/*
+ * opencog/atoms/reduct/NormLink.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atoms/core/NumberNode.h>
+#include "NormLink.h"
+
+using namespace opencog;
+
+NormLink::NormLink(const HandleSeq&& oset, Type t)
+    : NumericFunctionLink(std::move(oset), t)
+{
+	init();
+}
+
+NormLink::NormLink(const Handle& a)
+    : NumericFunctionLink({a}, NORM_LINK)
+{
+	init();
+}
+
+void NormLink::init(void)
+{
+	Type tscope = get_type();
+	if (not nameserver().isA(tscope, NORM_LINK))
+		throw InvalidParamException(TRACE_INFO, "Expecting a NormLink");
+
+	size_t nargs = _outgoing.size();
+	if (1 != nargs)
+		throw InvalidParamException(TRACE_INFO,
+			"NormLink expects one, got %s",
+			to_string().c_str());
+}
+
+// ============================================================
+
+ValuePtr NormLink::execute(AtomSpace* as, bool silent)
+{
+	// get_value() causes execution to happen on the arguments
+	ValuePtr vi(get_value(as, silent, _outgoing[0]));
+
+	Type vitype;
+	const std::vector<double>* dvec = get_vector(as, silent, vi, vitype);
+
+	if (dvec)
+	{
+		if (NUMBER_NODE == vitype)
+			return createNumberNode(norm(*dvec));
+		return createFloatValue(norm(*dvec));
+	}
+
+	// If it did not fully reduce, then return the best-possible
+	// reduction that we did get.
+	if (vi->is_atom())
+		return createNormLink(HandleCast(vi));
+
+	// Unable to reduce at all. Just return the original atom.
+	return get_handle();
+}
+
+DEFINE_LINK_FACTORY(NormLink, NORM_LINK);
+
+// ============================================================
@@ -0,0 +1,47 @@
+/*
+ * opencog/atoms/reduct/NormLink.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#ifndef _OPENCOG_NORM_LINK_H
+#define _OPENCOG_NORM_LINK_H
+
+#include <opencog/atoms/reduct/NumericFunctionLink.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * The NormLink implements the Euclidean length of a vector.
+ *    (Norm (Number a b c))  is just sqrt(aa+bb+cc).
+ */
+class NormLink : public NumericFunctionLink
+{
+protected:
+	void init(void);
+
+public:
+	NormLink(const Handle& a);
+	NormLink(const HandleSeq&&, Type=NORM_LINK);
+
+	NormLink(const NormLink&) = delete;
+	NormLink& operator=(const NormLink&) = delete;
+
+	virtual ValuePtr execute(AtomSpace*, bool);
+
+	static Handle factory(const Handle&);
+};
+
+LINK_PTR_DECL(NormLink)
+#define createNormLink CREATE_DECL(NormLink)
+
+/** @}*/
+}
+
+#endif // _OPENCOG_NORM_LINK_H
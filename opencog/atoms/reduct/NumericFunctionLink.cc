@@ -26,6 +26,8 @@
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/NumberNode.h>
+#include <opencog/atoms/value/Float32Value.h>
+#include <opencog/atoms/value/IntValue.h>
 #include "NumericFunctionLink.h"
 
 using namespace opencog;
@@ -80,6 +82,14 @@ ValuePtr NumericFunctionLink::get_value(AtomSpace* as, bool silent, ValuePtr vpt
 				vptr = setl->getOutgoingAtom(0);
 		}
 	}
+
+	// The compact numeric values are widened, so that all of the
+	// arithmetic only ever has to deal with doubles.
+	Type t = vptr->get_type();
+	if (FLOAT32_VALUE == t)
+		return createFloatValue(Float32ValueCast(vptr)->to_doubles());
+	if (INT_VALUE == t)
+		return createFloatValue(IntValueCast(vptr)->to_doubles());
 	return vptr;
 }
 
@@ -106,98 +116,3 @@ NumericFunctionLink::get_vector(AtomSpace* as, bool silent,
 	return nullptr; // not reached
 }
 
-// ============================================================
-
-/// Generic utility -- execute the Handle, and, if that returned
-/// a vector of doubles, then apply the function to them.
-/// If there wasn't a numeric vectors, return a null pointer.
-/// In this last case, the result of reduction is returned
-/// in `reduction`
-ValuePtr
-NumericFunctionLink::apply_func(AtomSpace* as, bool silent,
-                           const Handle& arg,
-                           double (*fun)(double),
-                           ValuePtr& vx)
-{
-	// get_value() causes execution.
-	vx = get_value(as, silent, arg);
-
-	// get_vector gets numeric values, if possible.
-	Type vxtype;
-	const std::vector<double>* xvec = get_vector(as, silent, vx, vxtype);
-
-	// No numeric values available. Sorry!
-	if (nullptr == xvec or 0 == xvec->size())
-		return nullptr;
-
-	std::vector<double> funvec;
-	size_t sz = xvec->size();
-	for (size_t i=0; i<sz; i++)
-		funvec.push_back(fun(xvec->operator[](i)));
-
-	if (NUMBER_NODE == vxtype)
-		return createNumberNode(funvec);
-
-	return createFloatValue(funvec);
-}
-
-// ============================================================
-
-/// Generic utility -- execute the HandleSeq, and, if that returned
-/// vectors of doubles, then apply the function to them.
-/// If there weren't any vectors, return a null pointer.
-/// In this last case, the result of reduction is returned
-/// in `reduction`
-ValuePtr
-NumericFunctionLink::apply_func(AtomSpace* as, bool silent,
-                           const HandleSeq& args,
-                           double (*fun)(double, double),
-                           ValueSeq& reduction)
-{
-	// get_value() causes execution.
-	ValuePtr vx(get_value(as, silent, args[0]));
-	ValuePtr vy(get_value(as, silent, args[1]));
-
-	// get_vector gets numeric values, if possible.
-	Type vxtype;
-	const std::vector<double>* xvec = get_vector(as, silent, vx, vxtype);
-
-	Type vytype;
-	const std::vector<double>* yvec = get_vector(as, silent, vy, vytype);
-
-	// No numeric values available. Sorry!
-	if (nullptr == xvec or nullptr == yvec or
-	    0 == xvec->size() or 0 == yvec->size())
-	{
-		reduction.push_back(vx);
-		reduction.push_back(vy);
-		return nullptr;
-	}
-
-	std::vector<double> funvec;
-	if (1 == xvec->size())
-	{
-		double x = xvec->back();
-		for (double y : *yvec)
-			funvec.push_back(fun(x, y));
-	}
-	else if (1 == yvec->size())
-	{
-		double y = yvec->back();
-		for (double x : *xvec)
-			funvec.push_back(fun(x, y));
-	}
-	else
-	{
-		size_t sz = std::min(xvec->size(), yvec->size());
-		for (size_t i=0; i<sz; i++)
-			funvec.push_back(fun(xvec->operator[](i), yvec->operator[](i)));
-	}
-
-	if (NUMBER_NODE == vxtype and NUMBER_NODE == vytype)
-		return createNumberNode(funvec);
-
-	return createFloatValue(funvec);
-}
-
-// ===========================================================
@@ -23,7 +23,14 @@
 #ifndef _OPENCOG_NUMERIC_FUNCTION_LINK_H
 #define _OPENCOG_NUMERIC_FUNCTION_LINK_H
 
+#include <algorithm>
+#include <vector>
+
+#include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/core/FunctionLink.h>
+#include <opencog/atoms/core/NumberNode.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/LinkValue.h>
 
 namespace opencog
 {
@@ -34,6 +41,13 @@ namespace opencog
 /**
  * The NumericFunctionLink implements the simple arithmetic operations.
  * It uses FoldLink to perform delta-reduction.
+ *
+ * The numeric work is done by the elementwise kernels below. These
+ * take the function as a template parameter, and not as a pointer,
+ * so that it is inlined into the loop over the vector, which the
+ * compiler can then vectorize. What kind of Value each argument is
+ * gets looked at once per call, and not once per element. A new
+ * operator is a functor, and a call to one of these.
  */
 class NumericFunctionLink : public FunctionLink
 {
@@ -42,10 +56,40 @@ protected:
 
 	static const std::vector<double>* get_vector(AtomSpace*, bool,
 		ValuePtr, Type&);
+
+	/// Apply the function to each element.
+	template<class F>
+	static std::vector<double> map_kernel(const std::vector<double>&, F);
+
+	/// Apply the function to pairs of elements. A vector of length
+	/// one is broadcast against every element of the other; else the
+	/// result is as long as the shorter of the two.
+	template<class F>
+	static std::vector<double> zip_kernel(const std::vector<double>&,
+		const std::vector<double>&, F);
+
+	/// Fold the vector into the accumulator, element by element,
+	/// shortening the accumulator to the shorter of the two.
+	template<class F>
+	static void fold_kernel(std::vector<double>&,
+		const std::vector<double>&, F);
+
+	/// Execute the argument(s), and, if that gave numbers, apply the
+	/// function to them. If not, return null, with the results of
+	/// execution in the last argument.
+	template<class F>
 	static ValuePtr apply_func(AtomSpace*, bool, const Handle&,
-		double (*)(double), ValuePtr&);
+		F, ValuePtr&);
+	template<class F>
 	static ValuePtr apply_func(AtomSpace*, bool, const HandleSeq&,
-		double (*)(double, double), ValueSeq&);
+		F, ValueSeq&);
+
+	/// Execute all of the arguments, and fold the numbers among them
+	/// with the function. LinkValues of numbers count as that many
+	/// arguments. If only some of the arguments are numbers, return
+	/// null, with the others, and then the fold, in the last argument.
+	template<class F>
+	ValuePtr fold_func(AtomSpace*, bool, F, HandleSeq&);
 
 public:
 	NumericFunctionLink(const HandleSeq&&, Type=NUMERIC_FUNCTION_LINK);
@@ -59,6 +103,172 @@ public:
 LINK_PTR_DECL(NumericFunctionLink)
 #define createNumericFunctionLink CREATE_DECL(NumericFunctionLink)
 
+// ===========================================================
+
+template<class F>
+std::vector<double>
+NumericFunctionLink::map_kernel(const std::vector<double>& x, F fun)
+{
+	size_t sz = x.size();
+	std::vector<double> out(sz);
+	const double* xp = x.data();
+	double* op = out.data();
+	for (size_t i=0; i<sz; i++)
+		op[i] = fun(xp[i]);
+	return out;
+}
+
+template<class F>
+std::vector<double>
+NumericFunctionLink::zip_kernel(const std::vector<double>& x,
+                                const std::vector<double>& y, F fun)
+{
+	const double* xp = x.data();
+	const double* yp = y.data();
+	if (1 == x.size())
+	{
+		double xs = xp[0];
+		return map_kernel(y, [&](double yv) { return fun(xs, yv); });
+	}
+	if (1 == y.size())
+	{
+		double ys = yp[0];
+		return map_kernel(x, [&](double xv) { return fun(xv, ys); });
+	}
+
+	size_t sz = std::min(x.size(), y.size());
+	std::vector<double> out(sz);
+	double* op = out.data();
+	for (size_t i=0; i<sz; i++)
+		op[i] = fun(xp[i], yp[i]);
+	return out;
+}
+
+template<class F>
+void NumericFunctionLink::fold_kernel(std::vector<double>& acc,
+                                      const std::vector<double>& x, F fun)
+{
+	if (x.size() < acc.size()) acc.resize(x.size());
+	size_t sz = acc.size();
+	double* ap = acc.data();
+	const double* xp = x.data();
+	for (size_t i=0; i<sz; i++)
+		ap[i] = fun(ap[i], xp[i]);
+}
+
+// ===========================================================
+
+template<class F>
+ValuePtr NumericFunctionLink::apply_func(AtomSpace* as, bool silent,
+                                         const Handle& arg, F fun,
+                                         ValuePtr& vx)
+{
+	// get_value() causes execution.
+	vx = get_value(as, silent, arg);
+
+	// get_vector gets numeric values, if possible.
+	Type vxtype;
+	const std::vector<double>* xvec = get_vector(as, silent, vx, vxtype);
+
+	// No numeric values available. Sorry!
+	if (nullptr == xvec or 0 == xvec->size())
+		return nullptr;
+
+	if (NUMBER_NODE == vxtype)
+		return createNumberNode(map_kernel(*xvec, fun));
+
+	return createFloatValue(map_kernel(*xvec, fun));
+}
+
+template<class F>
+ValuePtr NumericFunctionLink::apply_func(AtomSpace* as, bool silent,
+                                         const HandleSeq& args, F fun,
+                                         ValueSeq& reduction)
+{
+	// get_value() causes execution.
+	ValuePtr vx(get_value(as, silent, args[0]));
+	ValuePtr vy(get_value(as, silent, args[1]));
+
+	// get_vector gets numeric values, if possible.
+	Type vxtype;
+	const std::vector<double>* xvec = get_vector(as, silent, vx, vxtype);
+
+	Type vytype;
+	const std::vector<double>* yvec = get_vector(as, silent, vy, vytype);
+
+	// No numeric values available. Sorry!
+	if (nullptr == xvec or nullptr == yvec or
+	    0 == xvec->size() or 0 == yvec->size())
+	{
+		reduction.push_back(vx);
+		reduction.push_back(vy);
+		return nullptr;
+	}
+
+	if (NUMBER_NODE == vxtype and NUMBER_NODE == vytype)
+		return createNumberNode(zip_kernel(*xvec, *yvec, fun));
+
+	return createFloatValue(zip_kernel(*xvec, *yvec, fun));
+}
+
+template<class F>
+ValuePtr NumericFunctionLink::fold_func(AtomSpace* as, bool silent,
+                                        F fun, HandleSeq& nan)
+{
+	Type result_type = FLOAT_VALUE;
+	std::vector<double> result;
+	bool first = true;
+
+	// Fold one number vector into the running result. Return false
+	// if it is not a number.
+	auto fold_in = [&](const ValuePtr& vi) -> bool
+	{
+		Type vitype;
+		const std::vector<double>* dvec = get_vector(as, silent, vi, vitype);
+		if (nullptr == dvec) return false;
+		if (NUMBER_NODE == vitype) result_type = NUMBER_NODE;
+
+		if (first) result = *dvec;
+		else fold_kernel(result, *dvec, fun);
+		first = false;
+		return true;
+	};
+
+	for (const Handle& arg: _outgoing)
+	{
+		ValuePtr vi(get_value(as, silent, arg));
+
+		// A LinkValue of numbers is treated as if each of them had
+		// been an argument; this avoids wrapping them up in atoms.
+		if (nameserver().isA(vi->get_type(), LINK_VALUE))
+		{
+			bool found = false;
+			for (const ValuePtr& lv : LinkValueCast(vi)->value())
+				found = fold_in(lv) or found;
+			if (not found) nan.push_back(arg);
+		}
+		else if (not fold_in(vi))
+			nan.push_back(arg);
+	}
+
+	// Unable to reduce at all. Just return the original atom.
+	if (nan.size() == _outgoing.size())
+		return get_handle();
+
+	// If it did not fully reduce, then the caller builds the
+	// best-possible reduction that we did get.
+	if (0 < nan.size())
+	{
+		nan.push_back(HandleCast(createNumberNode(std::move(result))));
+		return nullptr;
+	}
+
+	if (FLOAT_VALUE == result_type)
+		return createFloatValue(std::move(result));
+
+	return createNumberNode(std::move(result));
+}
+
 /** @}*/
 }
 
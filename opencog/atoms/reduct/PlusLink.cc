@@ -40,6 +40,7 @@ void PlusLink::init(void)
 
 	knil = zero;
 	_commutative = true;
+	_unboxed = true;
 }
 
 // ============================================================
@@ -232,6 +233,14 @@ ValuePtr PlusLink::kons(AtomSpace* as, bool silent,
 	return createPlusLink(hi, hj);
 }
 
+std::vector<double>
+PlusLink::kons_numbers(const std::vector<double>& vi,
+                       std::vector<double>&& vj) const
+{
+	// Same as plus(vi, vj), as this commutes; but reuses vj.
+	return plus(std::move(vj), vi);
+}
+
 DEFINE_LINK_FACTORY(PlusLink, PLUS_LINK);
 
 // ============================================================
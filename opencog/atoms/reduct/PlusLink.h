@@ -26,6 +26,8 @@ protected:
 	static Handle zero;
 	virtual ValuePtr kons(AtomSpace*, bool,
 	                      const ValuePtr&, const ValuePtr&) const;
+	virtual std::vector<double> kons_numbers(const std::vector<double>&,
+	                                         std::vector<double>&&) const;
 
 	void init(void);
 
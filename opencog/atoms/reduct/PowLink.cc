@@ -47,7 +47,7 @@ ValuePtr PowLink::execute(AtomSpace* as, bool silent)
 {
 	ValueSeq reduction;
 	ValuePtr result(apply_func(as, silent, _outgoing,
-		pow, reduction));
+		[](double x, double y) { return pow(x, y); }, reduction));
 
 	if (result) return result;
 
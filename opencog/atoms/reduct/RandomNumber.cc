@@ -21,15 +21,13 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <opencog/util/mt19937ar.h>
-
 #include <opencog/atoms/core/NumberNode.h>
+#include <opencog/atoms/value/RandomGen.h>
 
 #include "RandomNumber.h"
 
 using namespace opencog;
 
-static MT19937RandGen randy(616432);
 
 void RandomNumberLink::init()
 {
@@ -59,7 +57,7 @@ RandomNumberLink::RandomNumberLink(const HandleSeq&& oset, Type t)
 static double get_ran(double lb, double ub)
 {
 	// Linear algebra slope-intercept formula.
-	return (ub - lb) * randy.randdouble() + lb;
+	return (ub - lb) * thread_rand().next_double() + lb;
 }
 
 /// RandomNumberLink always returns either a NumberNode, or a
@@ -38,6 +38,7 @@ void TimesLink::init(void)
 
 	knil = one;
 	_commutative = true;
+	_unboxed = true;
 }
 
 // ============================================================
@@ -168,6 +169,14 @@ ValuePtr TimesLink::kons(AtomSpace* as, bool silent,
 	return createTimesLink(hi, hj);
 }
 
+std::vector<double>
+TimesLink::kons_numbers(const std::vector<double>& vi,
+                        std::vector<double>&& vj) const
+{
+	// Same as times(vi, vj), as this commutes; but reuses vj.
+	return times(std::move(vj), vi);
+}
+
 DEFINE_LINK_FACTORY(TimesLink, TIMES_LINK)
 
 // ============================================================
@@ -34,65 +34,58 @@
 using namespace opencog;
 
 CountTruthValue::CountTruthValue(const std::vector<double>& v)
-	: TruthValue(COUNT_TRUTH_VALUE)
+	: FixedTruthValue<3>(COUNT_TRUTH_VALUE)
 {
-    _value = v;
+    set(v);
 }
 
 CountTruthValue::CountTruthValue(strength_t m, confidence_t n, count_t c)
-	: TruthValue(COUNT_TRUTH_VALUE)
+	: FixedTruthValue<3>(COUNT_TRUTH_VALUE)
 {
-    _value.resize(3);
-    _value[MEAN] = m;
-    _value[CONFIDENCE] = n;
-    _value[COUNT] = c;
+    _fixed[MEAN] = m;
+    _fixed[CONFIDENCE] = n;
+    _fixed[COUNT] = c;
 }
 
 CountTruthValue::CountTruthValue(const TruthValue& source)
-	: TruthValue(COUNT_TRUTH_VALUE)
+	: FixedTruthValue<3>(COUNT_TRUTH_VALUE)
 {
-    _value.resize(3);
-    _value[MEAN] = source.get_mean();
-    _value[CONFIDENCE] = source.get_confidence();
-    _value[COUNT] = source.get_count();
+    _fixed[MEAN] = source.get_mean();
+    _fixed[CONFIDENCE] = source.get_confidence();
+    _fixed[COUNT] = source.get_count();
 }
 
 CountTruthValue::CountTruthValue(CountTruthValue const& source)
-	: TruthValue(COUNT_TRUTH_VALUE)
+	: FixedTruthValue<3>(COUNT_TRUTH_VALUE)
 {
-    _value.resize(3);
-    _value[MEAN] = source.get_mean();
-    _value[CONFIDENCE] = source.get_confidence();
-    _value[COUNT] = source.get_count();
+    _fixed[MEAN] = source.get_mean();
+    _fixed[CONFIDENCE] = source.get_confidence();
+    _fixed[COUNT] = source.get_count();
 }
 
 CountTruthValue::CountTruthValue(const ValuePtr& source)
-       : TruthValue(COUNT_TRUTH_VALUE)
+       : FixedTruthValue<3>(COUNT_TRUTH_VALUE)
 {
     if (source->get_type() != COUNT_TRUTH_VALUE)
         throw RuntimeException(TRACE_INFO,
             "Source must be a CountTruthValue");
 
-    FloatValuePtr fp(FloatValueCast(source));
-    _value.resize(3);
-    _value[MEAN] = fp->value()[MEAN];
-    _value[CONFIDENCE] = fp->value()[CONFIDENCE];
-    _value[COUNT] = fp->value()[COUNT];
+    set(source);
 }
 
 strength_t CountTruthValue::get_mean() const
 {
-    return _value[MEAN];
+    return _fixed[MEAN];
 }
 
 count_t CountTruthValue::get_count() const
 {
-    return  _value[COUNT];
+    return  _fixed[COUNT];
 }
 
 confidence_t CountTruthValue::get_confidence() const
 {
-    return _value[CONFIDENCE];
+    return _fixed[CONFIDENCE];
 }
 
 std::string CountTruthValue::to_string(const std::string& indent) const
@@ -107,6 +100,7 @@ std::string CountTruthValue::to_string(const std::string& indent) const
 
 bool CountTruthValue::operator==(const Value& rhs) const
 {
+    if (this == &rhs) return true;
     const CountTruthValue *ctv = dynamic_cast<const CountTruthValue *>(&rhs);
     if (NULL == ctv) return false;
 
@@ -28,6 +28,7 @@
 #define _OPENCOG_COUNT_TRUTH_VALUE_H_
 
 #include <opencog/atoms/truthvalue/TruthValue.h>
+#include <opencog/atoms/value/ValueIntern.h>
 
 namespace opencog
 {
@@ -39,7 +40,7 @@ class CountTruthValue;
 typedef std::shared_ptr<const CountTruthValue> CountTruthValuePtr;
 
 //! a TruthValue that stores a mean, a confidence and the number of observations
-class CountTruthValue : public TruthValue
+class CountTruthValue : public FixedTruthValue<3>
 {
 protected:
     enum {
@@ -71,19 +72,29 @@ public:
     // Can we get rid of some of them?
     static TruthValuePtr createTV(strength_t s, confidence_t f, count_t c)
     {
-        return std::static_pointer_cast<const TruthValue>(
-            std::make_shared<const CountTruthValue>(s, f, c));
+        return ValueIntern::intern(std::static_pointer_cast<const TruthValue>(
+            std::make_shared<const CountTruthValue>(s, f, c)));
     }
     static TruthValuePtr createTV(const ValuePtr& pap)
     {
-        return std::static_pointer_cast<const TruthValue>(
-            std::make_shared<const CountTruthValue>(pap));
+        return ValueIntern::intern(std::static_pointer_cast<const TruthValue>(
+            std::make_shared<const CountTruthValue>(pap)));
+    }
+
+    /// The TruthValue, with `delta` added to the count; the mean and
+    /// confidence are kept. Any other kind of TV becomes a CountTV,
+    /// with a count of `delta`.
+    static TruthValuePtr increment(const TruthValuePtr& tv, count_t delta)
+    {
+        if (COUNT_TRUTH_VALUE == tv->get_type())
+            delta += tv->get_count();
+        return createTV(tv->get_mean(), tv->get_confidence(), delta);
     }
 
     static TruthValuePtr createTV(const std::vector<double>& v)
     {
-        return std::static_pointer_cast<const TruthValue>(
-            std::make_shared<const CountTruthValue>(v));
+        return ValueIntern::intern(std::static_pointer_cast<const TruthValue>(
+            std::make_shared<const CountTruthValue>(v)));
     }
 };
 
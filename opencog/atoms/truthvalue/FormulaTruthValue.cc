@@ -30,22 +30,32 @@
 
 using namespace opencog;
 
+static bool cacheable(const HandleSeq& formula)
+{
+	for (const Handle& fo : formula)
+		if (not ValueReads::cacheable(fo)) return false;
+	return true;
+}
+
 FormulaTruthValue::FormulaTruthValue(const Handle& h)
-	: SimpleTruthValue(0, 0), _formula({h}), _as(h->getAtomSpace())
+	: SimpleTruthValue(0, 0), _formula({h}), _as(h->getAtomSpace()),
+	  _reads(cacheable(_formula))
 {
 	_type = FORMULA_TRUTH_VALUE;
 	update();
 }
 
 FormulaTruthValue::FormulaTruthValue(const Handle& stn, const Handle& cnf)
-	: SimpleTruthValue(0, 0), _formula({stn, cnf}), _as(stn->getAtomSpace())
+	: SimpleTruthValue(0, 0), _formula({stn, cnf}), _as(stn->getAtomSpace()),
+	  _reads(cacheable(_formula))
 {
 	_type = FORMULA_TRUTH_VALUE;
 	update();
 }
 
 FormulaTruthValue::FormulaTruthValue(const HandleSeq&& seq)
-	: SimpleTruthValue(0, 0), _formula(seq), _as(seq[0]->getAtomSpace())
+	: SimpleTruthValue(0, 0), _formula(seq), _as(seq[0]->getAtomSpace()),
+	  _reads(cacheable(_formula))
 {
 	_type = FORMULA_TRUTH_VALUE;
 	update();
@@ -56,6 +66,10 @@ FormulaTruthValue::~FormulaTruthValue()
 
 void FormulaTruthValue::update(void) const
 {
+	if (_reads.unchanged()) return;
+
+	ValueReads::Recording rec(_reads);
+
 	// If there are two formulas, they produce the strength and
 	// the confidence, respectively.  We ignore more than two formulas.
 	if (1 < _formula.size())
@@ -75,6 +89,7 @@ void FormulaTruthValue::update(void) const
 						vp->to_string().c_str());
 			_value[i] = FloatValueCast(vp)->value()[0];
 		}
+		rec.done();
 		return;
 	}
 
@@ -105,6 +120,7 @@ void FormulaTruthValue::update(void) const
 		TruthValuePtr tvp = fo->getTruthValue();
 		_value = tvp->value();
 	}
+	rec.done();
 }
 
 strength_t FormulaTruthValue::get_mean() const
@@ -24,6 +24,7 @@
 #define _OPENCOG_FORMULA_TRUTH_VALUE_H_
 
 #include <opencog/atoms/truthvalue/SimpleTruthValue.h>
+#include <opencog/atoms/value/ValueReads.h>
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/atomspace/AtomSpace.h>
 // #include <opencog/atoms/value/FormulaStream.h>
@@ -42,6 +43,9 @@ protected:
 	HandleSeq _formula;
 	AtomSpace* _as;
 
+	// The TV is recomputed only when a Value it read has changed.
+	mutable ValueReads _reads;
+
 public:
 	FormulaTruthValue(const Handle&);
 	FormulaTruthValue(const Handle&, const Handle&);
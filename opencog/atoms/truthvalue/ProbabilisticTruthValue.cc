@@ -35,59 +35,52 @@
 using namespace opencog;
 
 ProbabilisticTruthValue::ProbabilisticTruthValue(strength_t m, confidence_t n, count_t c)
-	: TruthValue(PROBABILISTIC_TRUTH_VALUE)
+	: FixedTruthValue<3>(PROBABILISTIC_TRUTH_VALUE)
 {
-    _value.resize(3);
-    _value[MEAN] = m;
-    _value[CONFIDENCE] = n;
-    _value[COUNT] = c;
+    _fixed[MEAN] = m;
+    _fixed[CONFIDENCE] = n;
+    _fixed[COUNT] = c;
 }
 
 ProbabilisticTruthValue::ProbabilisticTruthValue(const TruthValue& source)
-	: TruthValue(PROBABILISTIC_TRUTH_VALUE)
+	: FixedTruthValue<3>(PROBABILISTIC_TRUTH_VALUE)
 {
-    _value.resize(3);
-    _value[MEAN] = source.get_mean();
-    _value[CONFIDENCE] = source.get_confidence();
-    _value[COUNT] = source.get_count();
+    _fixed[MEAN] = source.get_mean();
+    _fixed[CONFIDENCE] = source.get_confidence();
+    _fixed[COUNT] = source.get_count();
 }
 
 ProbabilisticTruthValue::ProbabilisticTruthValue(ProbabilisticTruthValue const& source)
-	: TruthValue(PROBABILISTIC_TRUTH_VALUE)
+	: FixedTruthValue<3>(PROBABILISTIC_TRUTH_VALUE)
 {
-    _value.resize(3);
-    _value[MEAN] = source.get_mean();
-    _value[CONFIDENCE] = source.get_confidence();
-    _value[COUNT] = source.get_count();
+    _fixed[MEAN] = source.get_mean();
+    _fixed[CONFIDENCE] = source.get_confidence();
+    _fixed[COUNT] = source.get_count();
 }
 
 ProbabilisticTruthValue::ProbabilisticTruthValue(const ValuePtr& source)
-       : TruthValue(PROBABILISTIC_TRUTH_VALUE)
+       : FixedTruthValue<3>(PROBABILISTIC_TRUTH_VALUE)
 {
     if (source->get_type() != PROBABILISTIC_TRUTH_VALUE)
         throw RuntimeException(TRACE_INFO,
             "Source must be a ProbabilisticTruthValue");
 
-    FloatValuePtr fp(FloatValueCast(source));
-    _value.resize(3);
-    _value[MEAN] = fp->value()[MEAN];
-    _value[CONFIDENCE] = fp->value()[CONFIDENCE];
-    _value[COUNT] = fp->value()[COUNT];
+    set(source);
 }
 
 strength_t ProbabilisticTruthValue::get_mean() const
 {
-    return _value[MEAN];
+    return _fixed[MEAN];
 }
 
 count_t ProbabilisticTruthValue::get_count() const
 {
-    return  _value[COUNT];
+    return  _fixed[COUNT];
 }
 
 confidence_t ProbabilisticTruthValue::get_confidence() const
 {
-    return _value[CONFIDENCE];
+    return _fixed[CONFIDENCE];
 }
 
 std::string ProbabilisticTruthValue::to_string(const std::string& indent) const
@@ -42,7 +42,7 @@ class ProbabilisticTruthValue;
 typedef std::shared_ptr<const ProbabilisticTruthValue> ProbabilisticTruthValuePtr;
 
 //! a TruthValue that stores a mean, a confidence and the number of observations
-class ProbabilisticTruthValue : public TruthValue
+class ProbabilisticTruthValue : public FixedTruthValue<3>
 {
 protected:
     enum {
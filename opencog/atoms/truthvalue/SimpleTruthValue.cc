@@ -38,67 +38,53 @@ using namespace opencog;
 count_t SimpleTruthValue::DEFAULT_K = 800.0;
 
 SimpleTruthValue::SimpleTruthValue(const std::vector<double>& v)
-	: TruthValue(SIMPLE_TRUTH_VALUE)
+	: FixedTruthValue<2>(SIMPLE_TRUTH_VALUE)
 {
-	_value = v;
+	set(v);
 }
 
 SimpleTruthValue::SimpleTruthValue(strength_t m, confidence_t c)
-	: TruthValue(SIMPLE_TRUTH_VALUE)
+	: FixedTruthValue<2>(SIMPLE_TRUTH_VALUE)
 {
-    _value.resize(2);
-    _value[MEAN] = m;
-    _value[CONFIDENCE] = c;
+    _fixed[MEAN] = m;
+    _fixed[CONFIDENCE] = c;
 }
 
 SimpleTruthValue::SimpleTruthValue(const TruthValue& source)
-	: TruthValue(SIMPLE_TRUTH_VALUE)
+	: FixedTruthValue<2>(SIMPLE_TRUTH_VALUE)
 {
-    _value.resize(2);
-    _value[MEAN] = source.get_mean();
-    _value[CONFIDENCE] = source.get_confidence();
+    _fixed[MEAN] = source.get_mean();
+    _fixed[CONFIDENCE] = source.get_confidence();
 }
 
 SimpleTruthValue::SimpleTruthValue(const SimpleTruthValue& source)
-	: TruthValue(SIMPLE_TRUTH_VALUE)
+	: FixedTruthValue<2>(SIMPLE_TRUTH_VALUE)
 {
-    _value.resize(2);
-    _value[MEAN] = source._value[MEAN];
-    _value[CONFIDENCE] = source._value[CONFIDENCE];
+    _fixed[MEAN] = source._fixed[MEAN];
+    _fixed[CONFIDENCE] = source._fixed[CONFIDENCE];
 }
 
 SimpleTruthValue::SimpleTruthValue(const ValuePtr& source)
-	: TruthValue(SIMPLE_TRUTH_VALUE)
+	: FixedTruthValue<2>(SIMPLE_TRUTH_VALUE)
 {
-	if (not nameserver().isA(source->get_type(), FLOAT_VALUE))
-		throw RuntimeException(TRACE_INFO,
-			"Source must be a FloatValue");
-
-	FloatValuePtr fp(FloatValueCast(source));
-	if (fp->value().size() < 2)
-		throw RuntimeException(TRACE_INFO,
-			"FloatValue must have at least two elements!");
-
-	_value.resize(2);
-	_value[MEAN] = fp->value()[MEAN];
-	_value[CONFIDENCE] = fp->value()[CONFIDENCE];
+	set(source);
 }
 
 strength_t SimpleTruthValue::get_mean() const
 {
-    return _value[MEAN];
+    return _fixed[MEAN];
 }
 
 count_t SimpleTruthValue::get_count() const
 {
     // Formula from PLN book.
-    confidence_t cf = std::min(_value[CONFIDENCE], 0.9999998);
+    confidence_t cf = std::min(_fixed[CONFIDENCE], 0.9999998);
     return static_cast<count_t>(DEFAULT_K * cf / (1.0 - cf));
 }
 
 confidence_t SimpleTruthValue::get_confidence() const
 {
-    return _value[CONFIDENCE];
+    return _fixed[CONFIDENCE];
 }
 
 // This is the merge formula appropriate for PLN.
@@ -148,13 +134,14 @@ std::string SimpleTruthValue::to_string(const std::string& indent) const
 
 bool SimpleTruthValue::operator==(const Value& rhs) const
 {
+    if (this == &rhs) return true;
     const SimpleTruthValue *stv = dynamic_cast<const SimpleTruthValue *>(&rhs);
     if (NULL == stv) return false;
 
-    if (not nearly_equal(stv->_value[MEAN], _value[MEAN]))
+    if (not nearly_equal(stv->_fixed[MEAN], _fixed[MEAN]))
         return false;
 
-    if (not nearly_equal(stv->_value[CONFIDENCE], _value[CONFIDENCE])) 
+    if (not nearly_equal(stv->_fixed[CONFIDENCE], _fixed[CONFIDENCE])) 
         return false;
     return true;
 }
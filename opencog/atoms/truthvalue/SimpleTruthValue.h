@@ -28,6 +28,8 @@
 #define _OPENCOG_SIMPLE_TRUTH_VALUE_H_
 
 #include <opencog/atoms/truthvalue/TruthValue.h>
+#include <opencog/atoms/value/SlabAllocator.h>
+#include <opencog/atoms/value/ValueIntern.h>
 
 namespace opencog
 {
@@ -39,7 +41,7 @@ class SimpleTruthValue;
 typedef std::shared_ptr<const SimpleTruthValue> SimpleTruthValuePtr;
 
 //! a TruthValue that stores a strength and confidence.
-class SimpleTruthValue : public TruthValue
+class SimpleTruthValue : public FixedTruthValue<2>
 {
 protected:
     enum {
@@ -78,7 +80,8 @@ public:
     // Can we get rid of some of them?
     static SimpleTruthValuePtr createSTV(strength_t mean, confidence_t conf)
     {
-        return std::make_shared<const SimpleTruthValue>(mean, conf);
+        return ValueIntern::intern(
+            SimpleTruthValuePtr(slab_make_shared<SimpleTruthValue>(mean, conf)));
     }
     static TruthValuePtr createTV(strength_t mean, confidence_t conf)
     {
@@ -86,14 +89,14 @@ public:
     }
     static TruthValuePtr createTV(const std::vector<double>& v)
     {
-        return std::static_pointer_cast<const TruthValue>(
-            std::make_shared<const SimpleTruthValue>(v));
+        return ValueIntern::intern(std::static_pointer_cast<const TruthValue>(
+            slab_make_shared<SimpleTruthValue>(v)));
     }
 
     static TruthValuePtr createTV(const ValuePtr& pap)
     {
-        return std::static_pointer_cast<const TruthValue>(
-            std::make_shared<const SimpleTruthValue>(pap));
+        return ValueIntern::intern(std::static_pointer_cast<const TruthValue>(
+            slab_make_shared<SimpleTruthValue>(pap)));
     }
 };
 
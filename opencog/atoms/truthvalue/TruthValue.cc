@@ -35,11 +35,21 @@
 #include <opencog/atoms/truthvalue/ProbabilisticTruthValue.h>
 #include <opencog/atoms/truthvalue/SimpleTruthValue.h>
 #include <opencog/atoms/truthvalue/TruthValue.h>
+#include <opencog/atoms/value/ValueIntern.h>
 
 namespace opencog {
 
 const strength_t MAX_TRUTH  = 1.0;
 
+// The constants are always interned, so that, once interning is
+// enabled, every TV equal to one of them is that one.
+static TruthValuePtr make_constant(strength_t s, confidence_t c)
+{
+	TruthValuePtr tv(std::make_shared<SimpleTruthValue>(s, c));
+	ValueIntern::add(ValueCast(tv));
+	return tv;
+}
+
 std::string TruthValue::to_short_string(const std::string& indent) const
 {
 	return to_string(indent);
@@ -48,28 +58,28 @@ std::string TruthValue::to_short_string(const std::string& indent) const
 TruthValuePtr TruthValue::DEFAULT_TV()
 {
 	// True, but no confidence.
-	static TruthValuePtr instance(std::make_shared<SimpleTruthValue>(MAX_TRUTH, 0.0));
+	static TruthValuePtr instance(make_constant(MAX_TRUTH, 0.0));
 	return instance;
 }
 
 TruthValuePtr TruthValue::TRUE_TV()
 {
 	// True, with maximum confidence.
-	static TruthValuePtr instance(std::make_shared<SimpleTruthValue>(MAX_TRUTH, 1.0));
+	static TruthValuePtr instance(make_constant(MAX_TRUTH, 1.0));
 	return instance;
 }
 
 TruthValuePtr TruthValue::FALSE_TV()
 {
 	// False, with maximum confidence.
-	static TruthValuePtr instance(std::make_shared<SimpleTruthValue>(0.0, 1.0));
+	static TruthValuePtr instance(make_constant(0.0, 1.0));
 	return instance;
 }
 
 TruthValuePtr TruthValue::TRIVIAL_TV()
 {
 	// False, with no confidence.
-	static TruthValuePtr instance(std::make_shared<SimpleTruthValue>(0.0, 0.0));
+	static TruthValuePtr instance(make_constant(0.0, 0.0));
 	return instance;
 }
 
@@ -165,7 +175,7 @@ TruthValuePtr TruthValue::factory(Type t, const std::vector<double>& v)
 	return factory(pap);
 }
 
-TruthValuePtr TruthValue::factory(const ValuePtr& pap)
+static TruthValuePtr make_tv(const ValuePtr& pap)
 {
 	Type t = pap->get_type();
 	if (SIMPLE_TRUTH_VALUE == t)
@@ -184,6 +194,11 @@ TruthValuePtr TruthValue::factory(const ValuePtr& pap)
 	return nullptr;
 }
 
+TruthValuePtr TruthValue::factory(const ValuePtr& pap)
+{
+	return ValueIntern::intern(make_tv(pap));
+}
+
 std::string oc_to_string(TruthValuePtr tv, const std::string& indent)
 {
 	if (tv)
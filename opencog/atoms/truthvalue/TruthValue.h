@@ -27,6 +27,7 @@
 #define _OPENCOG_TRUTH_VALUE_H
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -165,6 +166,57 @@ public:
 	virtual bool isDefinedTV() const;
 };
 
+/**
+ * A TruthValue with exactly N components, kept inline, instead of in
+ * the vector inherited from FloatValue. Creating one takes a single
+ * allocation, the object itself. The vector that value() returns is
+ * filled in only the first time value() is called; the accessors,
+ * size() and data() never need it.
+ */
+template<size_t N>
+class FixedTruthValue
+	: public TruthValue
+{
+	mutable std::once_flag _filled;
+
+protected:
+	double _fixed[N];
+
+	FixedTruthValue(Type t) : TruthValue(t) {}
+
+	virtual void update() const
+	{
+		std::call_once(_filled, [this] { _value.assign(_fixed, _fixed + N); });
+	}
+
+	void set(const std::vector<double>& v)
+	{
+		if (v.size() < N)
+			throw RuntimeException(TRACE_INFO,
+				"Expecting %zu numbers, got %zu", N, v.size());
+		for (size_t i = 0; i < N; i++) _fixed[i] = v[i];
+	}
+
+	void set(const ValuePtr& src)
+	{
+		if (not nameserver().isA(src->get_type(), FLOAT_VALUE))
+			throw RuntimeException(TRACE_INFO,
+				"Source must be a FloatValue");
+
+		// Streams are sampled by data(); only then is size() right.
+		const FloatValue* fv = (const FloatValue*) src.get();
+		const double* d = fv->data();
+		if (fv->size() < N)
+			throw RuntimeException(TRACE_INFO,
+				"FloatValue must have at least %zu elements!", N);
+		for (size_t i = 0; i < N; i++) _fixed[i] = d[i];
+	}
+
+public:
+	virtual size_t size() const { return N; }
+	virtual const double* data() const { return _fixed; }
+};
+
 static inline TruthValuePtr TruthValueCast(const ValuePtr& pa)
     { return std::dynamic_pointer_cast<const TruthValue>(pa); }
 
@@ -0,0 +1,67 @@
+/*
+ * opencog/atoms/value/Float32Value.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/value/Float32Value.h>
+#include <opencog/atoms/value/ValueFactory.h>
+
+using namespace opencog;
+
+bool Float32Value::operator==(const Value& other) const
+{
+	if (FLOAT32_VALUE != other.get_type()) return false;
+
+	const Float32Value* fov = (const Float32Value*) &other;
+
+	if (_value.size() != fov->_value.size()) return false;
+	size_t len = _value.size();
+	for (size_t i=0; i<len; i++)
+		// Same ULPS comparison as in FloatValue, scaled down to the
+		// 23-bit mantissa.
+#define MAX_ULPS_32 4
+		if (MAX_ULPS_32 < labs((long) *(int32_t*) &(_value[i])
+		                       - (long) *(int32_t*) &(fov->_value[i])))
+			return false;
+	return true;
+}
+
+// ==============================================================
+
+/// Nine significant digits are enough to read back exactly the same
+/// single-precision float.
+std::string Float32Value::to_string(const std::string& indent) const
+{
+	std::string rv = indent + "(" + nameserver().getTypeName(_type);
+	for (float v :_value)
+	{
+		char buf[40];
+		snprintf(buf, 40, "%.9g", v);
+		rv += std::string(" ") + buf;
+	}
+	rv += ")";
+	return rv;
+}
+
+// Adds factory when library is loaded.
+DEFINE_VALUE_FACTORY(FLOAT32_VALUE,
+                     createFloat32Value, std::vector<double>)
+DEFINE_VALUE_FACTORY(FLOAT32_VALUE,
+                     createFloat32Value, std::vector<float>)
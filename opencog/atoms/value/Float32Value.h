@@ -0,0 +1,87 @@
+/*
+ * opencog/atoms/value/Float32Value.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_FLOAT32_VALUE_H
+#define _OPENCOG_FLOAT32_VALUE_H
+
+#include <vector>
+#include <opencog/atoms/value/Value.h>
+#include <opencog/atoms/atom_types/atom_types.h>
+
+namespace opencog
+{
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * Float32Values hold an ordered vector of single-precision floats.
+ * They take half the memory of a FloatValue, and are meant for bulky
+ * data, such as embedding vectors, where the extra precision is not
+ * needed. Arithmetic on them is done in double precision, and the
+ * results are ordinary FloatValues.
+ */
+class Float32Value
+	: public Value
+{
+protected:
+	std::vector<float> _value;
+
+public:
+	Float32Value(float v) : Value(FLOAT32_VALUE) { _value.push_back(v); }
+	Float32Value(const std::vector<float>& v)
+		: Value(FLOAT32_VALUE), _value(v) {}
+	Float32Value(std::vector<float>&& v)
+		: Value(FLOAT32_VALUE), _value(std::move(v)) {}
+	Float32Value(const std::vector<double>& v)
+		: Value(FLOAT32_VALUE), _value(v.begin(), v.end()) {}
+
+	virtual ~Float32Value() {}
+
+	const std::vector<float>& value() const { return _value; }
+	size_t size() const { return _value.size(); }
+
+	/// The values, widened to double.
+	std::vector<double> to_doubles() const
+	{ return std::vector<double>(_value.begin(), _value.end()); }
+
+	/** Returns a string representation of the value. */
+	virtual std::string to_string(const std::string& indent = "") const;
+
+	/** Returns true if two values are equal. */
+	virtual bool operator==(const Value&) const;
+};
+
+typedef std::shared_ptr<const Float32Value> Float32ValuePtr;
+static inline Float32ValuePtr Float32ValueCast(const ValuePtr& a)
+	{ return std::dynamic_pointer_cast<const Float32Value>(a); }
+
+template<typename ... Type>
+static inline std::shared_ptr<Float32Value> createFloat32Value(Type&&... args) {
+	return std::make_shared<Float32Value>(std::forward<Type>(args)...);
+}
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_FLOAT32_VALUE_H
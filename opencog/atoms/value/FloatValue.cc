@@ -20,6 +20,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <cmath>
+
 #include <opencog/util/exceptions.h>
 #include <opencog/atoms/value/FloatValue.h>
 #include <opencog/atoms/value/ValueFactory.h>
@@ -28,6 +30,7 @@ using namespace opencog;
 
 bool FloatValue::operator==(const Value& other) const
 {
+	if (this == &other) return true;
 	if (FLOAT_VALUE != other.get_type()) return false;
 
    const FloatValue* fov = (const FloatValue*) &other;
@@ -63,6 +66,18 @@ std::string FloatValue::to_string(const std::string& indent, Type t) const
 
 // ==============================================================
 
+ValuePtr opencog::increment(const ValuePtr& vp, size_t ref, double delta)
+{
+	std::vector<double> v;
+	if (nullptr != vp and FLOAT_VALUE == vp->get_type())
+		v = FloatValueCast(vp)->value();
+	if (v.size() <= ref) v.resize(ref + 1, 0.0);
+	v[ref] += delta;
+	return createFloatValue(std::move(v));
+}
+
+// ==============================================================
+
 /// Scalar addition
 std::vector<double> opencog::plus(double scalar, const std::vector<double>& fv)
 {
@@ -276,6 +291,102 @@ std::vector<double> opencog::divide(const std::vector<double>& fva,
 	return ratio;
 }
 
+/// In-place vector addition; same as above, except that the storage
+/// of `fva` is reused for the result.
+std::vector<double> opencog::plus(std::vector<double>&& fva,
+                                  const std::vector<double>& fvb)
+{
+	size_t lena = fva.size();
+	size_t lenb = fvb.size();
+
+	if (1 == lena)
+		return plus(fva[0], fvb);
+
+	if (1 == lenb)
+	{
+		double f = fvb[0];
+		for (size_t i=0; i<lena; i++)
+			fva[i] += f;
+		return std::move(fva);
+	}
+
+	if (lena < lenb)
+		fva.resize(lenb, 0.0);
+	for (size_t i=0; i<lenb; i++)
+		fva[i] += fvb[i];
+	return std::move(fva);
+}
+
+/// In-place vector multiplication; same as above, except that the
+/// storage of `fva` is reused for the result.
+std::vector<double> opencog::times(std::vector<double>&& fva,
+                                   const std::vector<double>& fvb)
+{
+	size_t lena = fva.size();
+	size_t lenb = fvb.size();
+
+	if (1 == lena)
+		return times(fva[0], fvb);
+
+	if (0 == lena)
+		return times(fva, fvb);
+
+	if (1 == lenb)
+	{
+		double f = fvb[0];
+		for (size_t i=0; i<lena; i++)
+			fva[i] *= f;
+		return std::move(fva);
+	}
+
+	if (lena < lenb)
+		fva.resize(lenb, 1.0);
+	for (size_t i=0; i<lenb; i++)
+		fva[i] *= fvb[i];
+	return std::move(fva);
+}
+
+/// Inner product.
+double opencog::dot(const std::vector<double>& fva,
+                    const std::vector<double>& fvb)
+{
+	size_t len = std::min(fva.size(), fvb.size());
+	double sum = 0.0;
+	for (size_t i=0; i<len; i++)
+		sum += fva[i] * fvb[i];
+	return sum;
+}
+
+/// Euclidean length.
+double opencog::norm(const std::vector<double>& fv)
+{
+	return sqrt(dot(fv, fv));
+}
+
+/// Sum of all of the elements. Four partial sums are kept, as these
+/// are independent of one-another, and so the compiler can keep them
+/// in one vector register. The order of the additions differs from
+/// a plain loop, and so the last bit of the result may differ, too.
+double opencog::sum(const std::vector<double>& fv)
+{
+	size_t len = fv.size();
+	const double* p = fv.data();
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+	size_t i = 0;
+	for (; i+4 <= len; i+=4)
+	{
+		s0 += p[i];
+		s1 += p[i+1];
+		s2 += p[i+2];
+		s3 += p[i+3];
+	}
+	for (; i<len; i++)
+		s0 += p[i];
+	return (s0 + s1) + (s2 + s3);
+}
+
+// ==============================================================
+
 // Adds factory when the library is loaded.
 DEFINE_VALUE_FACTORY(FLOAT_VALUE,
                      createFloatValue, std::vector<double>)
@@ -25,6 +25,7 @@
 
 #include <vector>
 #include <opencog/atoms/value/Value.h>
+#include <opencog/atoms/value/SlabAllocator.h>
 #include <opencog/atoms/atom_types/atom_types.h>
 
 namespace opencog
@@ -53,12 +54,18 @@ public:
 	FloatValue(double v) : Value(FLOAT_VALUE) { _value.push_back(v); }
 	FloatValue(const std::vector<double>& v)
 		: Value(FLOAT_VALUE), _value(v) {}
+	FloatValue(std::vector<double>&& v)
+		: Value(FLOAT_VALUE), _value(std::move(v)) {}
 
 	virtual ~FloatValue() {}
 
 	const std::vector<double>& value() const { update(); return _value; }
 	size_t size() const { return _value.size(); }
 
+	/// The same numbers as value(), for subclasses that keep them
+	/// somewhere other than the vector.
+	virtual const double* data() const { update(); return _value.data(); }
+
 	/** Returns a string representation of the value. */
 	virtual std::string to_string(const std::string& indent = "") const
 	{ return to_string(indent, _type); }
@@ -79,9 +86,14 @@ static inline const ValuePtr ValueCast(const FloatValuePtr& fv)
 
 template<typename ... Type>
 static inline std::shared_ptr<FloatValue> createFloatValue(Type&&... args) {
-	return std::make_shared<FloatValue>(std::forward<Type>(args)...);
+	return slab_make_shared<FloatValue>(std::forward<Type>(args)...);
 }
 
+/// A copy of the FloatValue, with `delta` added to entry `ref`. The
+/// copy is padded with zeros, if need be, to reach `ref`. If the Value
+/// is null, or not a plain FloatValue, the copy is all zeros but one.
+ValuePtr increment(const ValuePtr&, size_t ref, double delta);
+
 // Scalar multiplication and addition
 std::vector<double> plus(double, const std::vector<double>&);
 std::vector<double> minus(double, const std::vector<double>&);
@@ -116,6 +128,19 @@ std::vector<double> minus(const std::vector<double>&, const std::vector<double>&
 std::vector<double> times(const std::vector<double>&, const std::vector<double>&);
 std::vector<double> divide(const std::vector<double>&, const std::vector<double>&);
 
+// Same as above, except that the result is written over the first
+// argument, instead of into a freshly allocated vector.
+std::vector<double> plus(std::vector<double>&&, const std::vector<double>&);
+std::vector<double> times(std::vector<double>&&, const std::vector<double>&);
+
+// Inner product, and Euclidean length. The shorter vector in the
+// inner product is assumed to be zero-padded.
+double dot(const std::vector<double>&, const std::vector<double>&);
+double norm(const std::vector<double>&);
+
+// Sum of all of the elements.
+double sum(const std::vector<double>&);
+
 /// Vector multiplication and addition. When operating on an object
 /// times itself, take a sample first; this is needed to correctly
 /// handle streaming values, as they issue new values every time
@@ -31,8 +31,10 @@ using namespace opencog;
 // ==============================================================
 
 FormulaStream::FormulaStream(const Handle& h) :
-	StreamValue(FORMULA_STREAM), _formula(h), _as(h->getAtomSpace())
+	StreamValue(FORMULA_STREAM), _formula(h), _as(h->getAtomSpace()),
+	_reads(ValueReads::cacheable(h))
 {
+	ValueReads::Recording rec(_reads);
 	ValuePtr vp;
 	if (h->is_executable())
 	{
@@ -55,12 +57,16 @@ FormulaStream::FormulaStream(const Handle& h) :
 			vp->to_string().c_str());
 
 	_value = FloatValueCast(vp)->value();
+	rec.done();
 }
 
 // ==============================================================
 
 void FormulaStream::update() const
 {
+	if (_reads.unchanged()) return;
+
+	ValueReads::Recording rec(_reads);
 	FloatValuePtr vp;
 	if (_formula->is_evaluatable())
 	{
@@ -72,6 +78,7 @@ void FormulaStream::update() const
 	}
 
 	_value = vp->value();
+	rec.done();
 }
 
 // ==============================================================
@@ -25,6 +25,7 @@
 
 #include <vector>
 #include <opencog/atoms/value/StreamValue.h>
+#include <opencog/atoms/value/ValueReads.h>
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/atomspace/AtomSpace.h>
 
@@ -49,6 +50,9 @@ protected:
 	Handle _formula;
 	AtomSpace* _as;
 
+	// The result is recomputed only when a Value it read has changed.
+	mutable ValueReads _reads;
+
 public:
 	FormulaStream(const Handle&);
 	virtual ~FormulaStream() {}
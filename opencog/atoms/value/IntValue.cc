@@ -0,0 +1,67 @@
+/*
+ * opencog/atoms/value/IntValue.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <cmath>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/value/IntValue.h>
+#include <opencog/atoms/value/ValueFactory.h>
+
+using namespace opencog;
+
+/// Used by the generic value factory, which hands over doubles; these
+/// must be whole numbers.
+IntValue::IntValue(const std::vector<double>& v)
+	: Value(INT_VALUE)
+{
+	_value.reserve(v.size());
+	for (double d : v)
+	{
+		if (d != std::trunc(d))
+			throw InvalidParamException(TRACE_INFO,
+				"IntValue: expecting whole numbers, got %g", d);
+		_value.push_back((int64_t) d);
+	}
+}
+
+bool IntValue::operator==(const Value& other) const
+{
+	if (INT_VALUE != other.get_type()) return false;
+	return _value == ((const IntValue*) &other)->_value;
+}
+
+// ==============================================================
+
+std::string IntValue::to_string(const std::string& indent) const
+{
+	std::string rv = indent + "(" + nameserver().getTypeName(_type);
+	for (int64_t v :_value)
+		rv += " " + std::to_string(v);
+	rv += ")";
+	return rv;
+}
+
+// Adds factory when library is loaded.
+DEFINE_VALUE_FACTORY(INT_VALUE,
+                     createIntValue, std::vector<int64_t>)
+DEFINE_VALUE_FACTORY(INT_VALUE,
+                     createIntValue, std::vector<double>)
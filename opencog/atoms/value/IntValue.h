@@ -0,0 +1,87 @@
+/*
+ * opencog/atoms/value/IntValue.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_INT_VALUE_H
+#define _OPENCOG_INT_VALUE_H
+
+#include <cstdint>
+#include <vector>
+#include <opencog/atoms/value/Value.h>
+#include <opencog/atoms/atom_types/atom_types.h>
+
+namespace opencog
+{
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * IntValues hold an ordered vector of 64-bit signed integers. They are
+ * meant for counts, which stay exact no matter how large they get,
+ * unlike counts kept in a FloatValue, which stop being exact past 2^53.
+ * Arithmetic on them is done in double precision, and the results are
+ * ordinary FloatValues.
+ */
+class IntValue
+	: public Value
+{
+protected:
+	std::vector<int64_t> _value;
+
+public:
+	IntValue(int64_t v) : Value(INT_VALUE) { _value.push_back(v); }
+	IntValue(const std::vector<int64_t>& v)
+		: Value(INT_VALUE), _value(v) {}
+	IntValue(std::vector<int64_t>&& v)
+		: Value(INT_VALUE), _value(std::move(v)) {}
+	IntValue(const std::vector<double>& v);
+
+	virtual ~IntValue() {}
+
+	const std::vector<int64_t>& value() const { return _value; }
+	size_t size() const { return _value.size(); }
+
+	/// The values, converted to double.
+	std::vector<double> to_doubles() const
+	{ return std::vector<double>(_value.begin(), _value.end()); }
+
+	/** Returns a string representation of the value. */
+	virtual std::string to_string(const std::string& indent = "") const;
+
+	/** Returns true if two values are equal. */
+	virtual bool operator==(const Value&) const;
+};
+
+typedef std::shared_ptr<const IntValue> IntValuePtr;
+static inline IntValuePtr IntValueCast(const ValuePtr& a)
+	{ return std::dynamic_pointer_cast<const IntValue>(a); }
+
+template<typename ... Type>
+static inline std::shared_ptr<IntValue> createIntValue(Type&&... args) {
+	return std::make_shared<IntValue>(std::forward<Type>(args)...);
+}
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_INT_VALUE_H
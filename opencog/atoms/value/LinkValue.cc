@@ -27,6 +27,16 @@
 
 using namespace opencog;
 
+/// The Handles are moved over one by one; their reference counts are
+/// not touched.
+LinkValue::LinkValue(HandleSeq&& hseq)
+	: Value(LINK_VALUE)
+{
+	_value.reserve(hseq.size());
+	for (Handle& h : hseq)
+		_value.emplace_back(std::move(h));
+	hseq.clear();
+}
 
 HandleSeq LinkValue::to_handle_seq(void) const
 {
@@ -51,6 +51,16 @@ public:
 	LinkValue(const ValueSeq& vlist)
 		: Value(LINK_VALUE), _value(vlist) {}
 
+	/// Take over the vector, instead of copying it (and bumping the
+	/// reference count of everything in it). Results that have been
+	/// gathered up in a ValueSeq should be std::move'd in.
+	LinkValue(ValueSeq&& vlist)
+		: Value(LINK_VALUE), _value(std::move(vlist)) {}
+
+	LinkValue(const HandleSeq& hseq)
+		: Value(LINK_VALUE), _value(hseq.begin(), hseq.end()) {}
+	LinkValue(HandleSeq&&);
+
 	LinkValue(const ValueSet& vset)
 		: Value(LINK_VALUE)
 	{ for (const ValuePtr& v: vset) _value.emplace_back(v); }
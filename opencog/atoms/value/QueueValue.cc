@@ -68,7 +68,7 @@ void QueueValue::update() const
 		{
 			ValuePtr val;
 			const_cast<QueueValue*>(this) -> pop(val);
-			_value.emplace_back(val);
+			_value.emplace_back(std::move(val));
 		}
 	}
 	catch (typename concurrent_queue<ValuePtr>::Canceled& e)
@@ -81,11 +81,19 @@ void QueueValue::update() const
 	{
 		ValuePtr val;
 		const_cast<QueueValue*>(this) -> pop(val);
-		_value.emplace_back(val);
+		_value.emplace_back(std::move(val));
 	}
 	const_cast<QueueValue*>(this) -> cancel();
 }
 
+LinkValuePtr QueueValue::to_link_value(void)
+{
+	update();
+	LinkValuePtr lvp(createLinkValue(std::move(_value)));
+	_value.clear();
+	return lvp;
+}
+
 // ==============================================================
 
 bool QueueValue::operator==(const Value& other) const
@@ -50,6 +50,11 @@ public:
 	QueueValue(void) : LinkStreamValue(QUEUE_VALUE) {}
 	QueueValue(const ValueSeq&);
 	virtual ~QueueValue() {}
+
+	/// Wait for the queue to be closed, and then hand all that was
+	/// put on it over to a new LinkValue. The vector is moved, not
+	/// copied; this QueueValue is left empty.
+	LinkValuePtr to_link_value(void);
 	virtual bool operator==(const Value&) const;
 };
 
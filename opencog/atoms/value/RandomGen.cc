@@ -0,0 +1,114 @@
+/*
+ * opencog/atoms/value/RandomGen.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <mutex>
+
+#include <opencog/atoms/value/RandomGen.h>
+
+using namespace opencog;
+
+// ==============================================================
+
+/// Expand the seed with splitmix64, as recommended by the authors;
+/// this avoids the all-zero state.
+void Xoshiro256::seed(uint64_t seed)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		_s[i] = z ^ (z >> 31);
+	}
+}
+
+void Xoshiro256::jump(void)
+{
+	static const uint64_t JUMP[] = {
+		0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+		0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+	uint64_t s[4] = {0, 0, 0, 0};
+	for (uint64_t jmp : JUMP)
+		for (int b = 0; b < 64; b++)
+		{
+			if (jmp & (1ULL << b))
+				for (int i = 0; i < 4; i++) s[i] ^= _s[i];
+			next();
+		}
+
+	for (int i = 0; i < 4; i++) _s[i] = s[i];
+}
+
+/// The draws have to be made in order, but the conversion to doubles
+/// does not; doing it in a second pass, a block at a time, lets the
+/// compiler vectorize it.
+void Xoshiro256::fill(double* out, size_t n, double lb, double ub)
+{
+	static constexpr size_t BLOCK = 64;
+	uint64_t bits[BLOCK];
+
+	const double scale = (ub - lb) * 0x1.0p-53;
+	for (size_t done = 0; done < n; done += BLOCK)
+	{
+		size_t len = std::min(BLOCK, n - done);
+		for (size_t i = 0; i < len; i++)
+			bits[i] = next();
+
+		double* blk = out + done;
+		for (size_t i = 0; i < len; i++)
+			blk[i] = (bits[i] >> 11) * scale + lb;
+	}
+}
+
+// ==============================================================
+
+static std::mutex _master_mtx;
+static Xoshiro256 _master(616432);
+
+static Xoshiro256 next_from_master(void)
+{
+	std::lock_guard<std::mutex> lck(_master_mtx);
+	Xoshiro256 gen(_master);
+	_master.jump();
+	return gen;
+}
+
+Xoshiro256& opencog::thread_rand(void)
+{
+	static thread_local Xoshiro256 gen(next_from_master());
+	return gen;
+}
+
+void opencog::thread_rand_seed(uint64_t seed)
+{
+	// Make sure ours exists first, so it is not drawn twice.
+	Xoshiro256& gen = thread_rand();
+	{
+		std::lock_guard<std::mutex> lck(_master_mtx);
+		_master.seed(seed);
+	}
+	gen = next_from_master();
+}
+
+// ==============================================================
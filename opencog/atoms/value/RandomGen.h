@@ -0,0 +1,97 @@
+/*
+ * opencog/atoms/value/RandomGen.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_RANDOM_GEN_H
+#define _OPENCOG_RANDOM_GEN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace opencog
+{
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * The xoshiro256** generator of Blackman and Vigna: small, fast, and
+ * with a jump() that skips ahead 2^128 draws, so that generators
+ * handed out by jumping never overlap.
+ */
+class Xoshiro256
+{
+	uint64_t _s[4];
+
+	static inline uint64_t rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+public:
+	Xoshiro256(uint64_t seed = 0) { this->seed(seed); }
+
+	void seed(uint64_t);
+	void jump(void);
+
+	inline uint64_t next(void)
+	{
+		const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+		const uint64_t t = _s[1] << 17;
+		_s[2] ^= _s[0];
+		_s[3] ^= _s[1];
+		_s[1] ^= _s[2];
+		_s[0] ^= _s[3];
+		_s[2] ^= t;
+		_s[3] = rotl(_s[3], 45);
+		return result;
+	}
+
+	/// Uniform on [0,1), with all 53 bits of the mantissa random.
+	inline double next_double(void)
+	{
+		return (next() >> 11) * 0x1.0p-53;
+	}
+
+	/// Overwrite every element with a draw, uniform on [lb,ub).
+	void fill(double*, size_t, double lb = 0.0, double ub = 1.0);
+	void fill(std::vector<double>& v, double lb = 0.0, double ub = 1.0)
+	{
+		fill(v.data(), v.size(), lb, ub);
+	}
+};
+
+/// The generator for the calling thread. Each thread gets its own,
+/// the next jump() along from the one handed out before; the sequence
+/// a thread draws depends only on the seed, and on the order in which
+/// the threads first asked.
+Xoshiro256& thread_rand(void);
+
+/// Start over, from this seed. Threads that already have a generator
+/// keep it; the calling thread gets a fresh one.
+void thread_rand_seed(uint64_t);
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_RANDOM_GEN_H
@@ -20,7 +20,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <stdlib.h>
+#include <opencog/atoms/value/RandomGen.h>
 #include <opencog/atoms/value/RandomStream.h>
 #include <opencog/atoms/value/ValueFactory.h>
 
@@ -38,11 +38,7 @@ RandomStream::RandomStream(int len) :
 
 void RandomStream::update() const
 {
-	static thread_local unsigned short xsubi[3] = {0, 0, 0};
-	for (int i=0; i< _len; i++)
-	{
-		_value[i] = erand48(xsubi);
-	}
+	thread_rand().fill(_value);
 }
 
 // ==============================================================
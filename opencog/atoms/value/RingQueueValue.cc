@@ -0,0 +1,308 @@
+/*
+ * opencog/atoms/value/RingQueueValue.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <thread>
+
+#include <opencog/atoms/value/RingQueueValue.h>
+#include <opencog/atoms/value/ValueFactory.h>
+
+using namespace opencog;
+
+// How many times to look again, before yielding or parking.
+#define SPIN_COUNT 256
+
+// ==============================================================
+
+// The ring is the classic bounded queue of D. Vyukov. Each cell
+// carries a sequence number, telling whether it is free for the
+// producer at position `pos` (seq == pos), or holds the value for
+// the consumer at position `pos` (seq == pos + 1). Producers and
+// consumers claim positions by advancing `_tail` and `_head`, and
+// hand the cell over by bumping its sequence number.
+
+void RingQueueValue::init(size_t capacity)
+{
+	size_t sz = 2;
+	while (sz < capacity) sz <<= 1;
+
+	_cells.reset(new Cell[sz]);
+	for (size_t i = 0; i < sz; i++)
+		_cells[i].seq.store(i, std::memory_order_relaxed);
+	_mask = sz - 1;
+
+	_tail = 0;
+	_head = 0;
+	_closed = false;
+	_sleepers = 0;
+}
+
+RingQueueValue::RingQueueValue(size_t capacity, bool park)
+	: LinkStreamValue(RING_QUEUE_VALUE), _park(park)
+{
+	init(capacity);
+}
+
+RingQueueValue::RingQueueValue(const ValueSeq& vseq)
+	: LinkStreamValue(RING_QUEUE_VALUE), _park(true)
+{
+	init(vseq.size());
+	push_many(vseq);
+
+	// As with the QueueValue, we are done placing things on it.
+	close();
+}
+
+// ==============================================================
+
+/// Claim up to `n` consecutive cells at the end `end`, all of them
+/// in the state `offset` (zero: free, one: full). Return how many
+/// were claimed, and the first position, in `pos`. Return zero if
+/// the first cell is not ready.
+size_t RingQueueValue::claim(std::atomic<size_t>& end, size_t n,
+                             size_t offset, size_t& pos)
+{
+	if (n > _mask + 1) n = _mask + 1;
+
+	pos = end.load(std::memory_order_relaxed);
+	while (true)
+	{
+		size_t k = 0;
+		while (k < n)
+		{
+			const Cell& c = _cells[(pos + k) & _mask];
+			intptr_t dif = (intptr_t) c.seq.load(std::memory_order_acquire)
+				- (intptr_t) (pos + k + offset);
+			if (0 == dif) { k++; continue; }
+
+			// The first cell is not ready yet: full, or empty.
+			if (0 == k and dif < 0) return 0;
+			break;
+		}
+
+		// Someone else got there first; look again.
+		if (0 == k)
+		{
+			pos = end.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		if (end.compare_exchange_weak(pos, pos + k,
+		                              std::memory_order_relaxed))
+			return k;
+	}
+}
+
+bool RingQueueValue::can_push(void) const
+{
+	size_t pos = _tail.load(std::memory_order_relaxed);
+	return _cells[pos & _mask].seq.load(std::memory_order_acquire) == pos;
+}
+
+bool RingQueueValue::can_pop(void) const
+{
+	size_t pos = _head.load(std::memory_order_relaxed);
+	return _cells[pos & _mask].seq.load(std::memory_order_acquire) == pos + 1;
+}
+
+// ==============================================================
+
+template<typename Pred>
+void RingQueueValue::wait_until(Pred ready)
+{
+	for (size_t i = 0; i < SPIN_COUNT; i++)
+	{
+		if (ready()) return;
+		if (SPIN_COUNT/2 < i) std::this_thread::yield();
+	}
+
+	if (not _park)
+	{
+		while (not ready()) std::this_thread::yield();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lck(_mtx);
+	_sleepers.fetch_add(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	_cv.wait(lck, ready);
+	_sleepers.fetch_sub(1);
+}
+
+/// Wake up any sleepers. The fence pairs with the one taken by
+/// the sleeper: either it sees the change made just before this,
+/// or this sees it sleeping.
+void RingQueueValue::wake(void)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (0 == _sleepers.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	_cv.notify_all();
+}
+
+// ==============================================================
+
+bool RingQueueValue::try_push(ValuePtr&& vp)
+{
+	if (_closed) throw Canceled();
+
+	size_t pos;
+	if (0 == claim(_tail, 1, 0, pos)) return false;
+
+	Cell& c = _cells[pos & _mask];
+	c.data = std::move(vp);
+	c.seq.store(pos + 1, std::memory_order_release);
+	wake();
+	return true;
+}
+
+void RingQueueValue::push(ValuePtr&& vp)
+{
+	while (not try_push(std::move(vp)))
+		wait_until([&] { return _closed or can_push(); });
+}
+
+void RingQueueValue::push(const ValuePtr& vp)
+{
+	push(ValuePtr(vp));
+}
+
+void RingQueueValue::push_many(const ValueSeq& vseq)
+{
+	size_t done = 0;
+	while (done < vseq.size())
+	{
+		if (_closed) throw Canceled();
+
+		size_t pos;
+		size_t k = claim(_tail, vseq.size() - done, 0, pos);
+		if (0 == k)
+		{
+			wait_until([&] { return _closed or can_push(); });
+			continue;
+		}
+
+		for (size_t i = 0; i < k; i++)
+		{
+			Cell& c = _cells[(pos + i) & _mask];
+			c.data = vseq[done + i];
+			c.seq.store(pos + i + 1, std::memory_order_release);
+		}
+		done += k;
+		wake();
+	}
+}
+
+// ==============================================================
+
+bool RingQueueValue::try_pop(ValuePtr& vp)
+{
+	size_t pos;
+	if (0 == claim(_head, 1, 1, pos)) return false;
+
+	Cell& c = _cells[pos & _mask];
+	vp = std::move(c.data);
+	c.data = nullptr;
+	c.seq.store(pos + _mask + 1, std::memory_order_release);
+	wake();
+	return true;
+}
+
+void RingQueueValue::pop(ValuePtr& vp)
+{
+	while (not try_pop(vp))
+	{
+		if (_closed and is_empty()) throw Canceled();
+		wait_until([&] { return _closed or can_pop(); });
+	}
+}
+
+size_t RingQueueValue::pop_many(ValueSeq& vseq, size_t max)
+{
+	while (true)
+	{
+		size_t pos;
+		size_t k = claim(_head, max, 1, pos);
+		if (0 < k)
+		{
+			for (size_t i = 0; i < k; i++)
+			{
+				Cell& c = _cells[(pos + i) & _mask];
+				vseq.emplace_back(std::move(c.data));
+				c.data = nullptr;
+				c.seq.store(pos + i + _mask + 1, std::memory_order_release);
+			}
+			wake();
+			return k;
+		}
+
+		if (_closed and is_empty()) return 0;
+		wait_until([&] { return _closed or can_pop(); });
+	}
+}
+
+// ==============================================================
+
+void RingQueueValue::close(void)
+{
+	_closed = true;
+	wake();
+}
+
+size_t RingQueueValue::size(void) const
+{
+	size_t head = _head.load(std::memory_order_acquire);
+	size_t tail = _tail.load(std::memory_order_acquire);
+	return tail > head ? tail - head : 0;
+}
+
+// ==============================================================
+
+// Same as the QueueValue: block until the writers close the queue,
+// and then hand back everything they wrote.
+void RingQueueValue::update() const
+{
+	// Do nothing; we don't want to clobber the _value
+	if (is_closed() and is_empty()) return;
+
+	_value.clear();
+	RingQueueValue* self = const_cast<RingQueueValue*>(this);
+	while (0 < self->pop_many(_value)) {}
+}
+
+bool RingQueueValue::operator==(const Value& other) const
+{
+	if (get_type() != other.get_type()) return false;
+
+	if (this == &other) return true;
+
+	if (not is_closed()) return false;
+	if (not ((const RingQueueValue*) &other)->is_closed()) return false;
+
+	return LinkValue::operator==(other);
+}
+
+// ==============================================================
+
+// Adds factory when library is loaded.
+DEFINE_VALUE_FACTORY(RING_QUEUE_VALUE,
+                     createRingQueueValue, std::vector<ValuePtr>)
@@ -0,0 +1,144 @@
+/*
+ * opencog/atoms/value/RingQueueValue.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_RING_QUEUE_VALUE_H
+#define _OPENCOG_RING_QUEUE_VALUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <opencog/util/concurrent_queue.h>
+#include <opencog/atoms/value/LinkStreamValue.h>
+#include <opencog/atoms/atom_types/atom_types.h>
+
+namespace opencog
+{
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A bounded, lock-free FIFO queue of Values, for many producers and
+ * many consumers. It is meant for the same uses as the QueueValue,
+ * when so many threads push and pop that the lock on the QueueValue
+ * becomes the bottleneck.
+ *
+ * The queue is a ring of `capacity` slots, rounded up to a power of
+ * two; pushing onto a full queue waits for room. Neither push nor pop
+ * takes a lock; a thread that has to wait first spins for a while,
+ * and then, if `park` is set, sleeps until woken. Only the sleeping
+ * and the waking take a lock. Without `park`, waiting threads keep
+ * spinning, yielding the CPU in between.
+ *
+ * As with the QueueValue, producers close() the queue when they are
+ * done; value() then waits until that happens, and returns everything
+ * that was pushed. Popping from a queue that is closed and empty, and
+ * pushing onto a closed queue, throw Canceled.
+ */
+class RingQueueValue
+	: public LinkStreamValue
+{
+public:
+	typedef concurrent_queue<ValuePtr>::Canceled Canceled;
+
+protected:
+	virtual void update() const;
+
+	struct Cell
+	{
+		std::atomic<size_t> seq;
+		ValuePtr data;
+	};
+
+	std::unique_ptr<Cell[]> _cells;
+	size_t _mask;
+	bool _park;
+
+	alignas(64) std::atomic<size_t> _tail;
+	alignas(64) std::atomic<size_t> _head;
+	alignas(64) std::atomic<bool> _closed;
+
+	// For parking only.
+	std::atomic<int> _sleepers;
+	std::mutex _mtx;
+	std::condition_variable _cv;
+
+	void init(size_t);
+
+	template<typename Pred> void wait_until(Pred);
+	void wake(void);
+
+	size_t claim(std::atomic<size_t>&, size_t, size_t, size_t&);
+	bool can_push(void) const;
+	bool can_pop(void) const;
+
+public:
+	RingQueueValue(size_t capacity = 1024, bool park = true);
+	RingQueueValue(const ValueSeq&);
+	virtual ~RingQueueValue() {}
+
+	/// Push, waiting for room if the queue is full.
+	void push(const ValuePtr&);
+	void push(ValuePtr&&);
+	bool try_push(ValuePtr&&);
+
+	/// Push all of them, claiming as many slots at a time as possible.
+	void push_many(const ValueSeq&);
+
+	/// Pop, waiting if the queue is empty.
+	void pop(ValuePtr&);
+	bool try_pop(ValuePtr&);
+
+	/// Wait until there is something (or the queue was closed), and
+	/// then pop as much as is there, up to `max`, at one go. Returns
+	/// the number popped; zero, if the queue is closed and empty.
+	size_t pop_many(ValueSeq&, size_t max = SIZE_MAX);
+
+	void close(void);
+	void open(void) { _closed = false; }
+	bool is_closed(void) const { return _closed; }
+
+	/// Approximate, if others are pushing or popping.
+	size_t size(void) const;
+	bool is_empty(void) const { return 0 == size(); }
+	size_t capacity(void) const { return _mask + 1; }
+
+	virtual bool operator==(const Value&) const;
+};
+
+typedef std::shared_ptr<RingQueueValue> RingQueueValuePtr;
+static inline RingQueueValuePtr RingQueueValueCast(ValuePtr& a)
+	{ return std::dynamic_pointer_cast<RingQueueValue>(a); }
+
+template<typename ... Type>
+static inline std::shared_ptr<RingQueueValue> createRingQueueValue(Type&&... args) {
+   return std::make_shared<RingQueueValue>(std::forward<Type>(args)...);
+}
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_RING_QUEUE_VALUE_H
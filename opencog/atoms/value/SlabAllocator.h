@@ -0,0 +1,227 @@
+/*
+ * opencog/atoms/value/SlabAllocator.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SLAB_ALLOCATOR_H
+#define _OPENCOG_SLAB_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+// Allocate Nodes, Links and the most common Values out of per-thread
+// slabs, instead of one malloc each. Off by default.
+// #define USE_SLAB_ALLOCATOR 1
+
+// Number of blocks carved out of each slab.
+#ifndef SLAB_BLOCKS_PER_SLAB
+#define SLAB_BLOCKS_PER_SLAB 1024
+#endif
+
+// A thread keeps at most this many free blocks of each size, before
+// handing them back to the shared pool.
+#ifndef SLAB_THREAD_CACHE_MAX
+#define SLAB_THREAD_CACHE_MAX (4 * SLAB_BLOCKS_PER_SLAB)
+#endif
+
+/**
+ * A pool of fixed-size blocks of SZ bytes. Each thread allocates from,
+ * and frees to, its own free list, so that no lock is taken in the
+ * common case. Blocks freed in one thread that were allocated in
+ * another simply join the freeing thread's list. When a thread's list
+ * grows too long, or the thread exits, the list is handed over to a
+ * shared, locked pool, which other threads refill from before carving
+ * new slabs.
+ *
+ * Slabs are never returned to the operating system; memory, once
+ * used for atoms, stays available for atoms. This is the usual
+ * behavior of an AtomSpace anyway, which tends to grow and stay big.
+ */
+template<size_t SZ>
+class SlabPool
+{
+	struct Block { Block* next; };
+
+	static_assert(sizeof(Block) <= SZ, "Block too small");
+	static_assert(0 == SZ % alignof(std::max_align_t), "Misaligned block");
+
+	struct Shared
+	{
+		std::mutex mtx;
+		Block* head = nullptr;
+		size_t count = 0;
+	};
+
+	static Shared& shared(void)
+	{
+		// Never destroyed, so that threads exiting during
+		// program shutdown can still hand their blocks back.
+		static Shared* s = new Shared();
+		return *s;
+	}
+
+	struct Cache
+	{
+		Block* head = nullptr;
+		size_t count = 0;
+
+		void spill(void)
+		{
+			if (nullptr == head) return;
+			Block* tail = head;
+			while (tail->next) tail = tail->next;
+
+			Shared& s = shared();
+			std::lock_guard<std::mutex> lck(s.mtx);
+			tail->next = s.head;
+			s.head = head;
+			s.count += count;
+			head = nullptr;
+			count = 0;
+		}
+
+		void refill(void)
+		{
+			{
+				Shared& s = shared();
+				std::lock_guard<std::mutex> lck(s.mtx);
+				if (s.head)
+				{
+					head = s.head;
+					count = s.count;
+					s.head = nullptr;
+					s.count = 0;
+					return;
+				}
+			}
+
+			char* slab = static_cast<char*>(
+				::operator new(SZ * SLAB_BLOCKS_PER_SLAB));
+			for (size_t i = 0; i < SLAB_BLOCKS_PER_SLAB; i++)
+			{
+				Block* b = reinterpret_cast<Block*>(slab + i*SZ);
+				b->next = head;
+				head = b;
+			}
+			count = SLAB_BLOCKS_PER_SLAB;
+		}
+	};
+
+	// The cache itself has no destructor, so that it remains usable
+	// for blocks freed late in thread (or program) shutdown; a
+	// separate guard hands its contents back when the thread exits.
+	struct Guard
+	{
+		Cache* c;
+		~Guard() { c->spill(); }
+	};
+
+	static Cache& cache(void)
+	{
+		static thread_local Cache c;
+		static thread_local Guard g{&c};
+		return c;
+	}
+
+public:
+	static void* take(void)
+	{
+		Cache& c = cache();
+		if (nullptr == c.head) c.refill();
+		Block* b = c.head;
+		c.head = b->next;
+		c.count--;
+		return b;
+	}
+
+	static void give(void* p)
+	{
+		Cache& c = cache();
+		Block* b = static_cast<Block*>(p);
+		b->next = c.head;
+		c.head = b;
+		if (SLAB_THREAD_CACHE_MAX < ++c.count) c.spill();
+	}
+};
+
+/**
+ * Minimal C++ allocator, drawing single objects from a SlabPool sized
+ * for them. It is meant for std::allocate_shared, which rebinds it to
+ * the type of the combined control block plus object; so the control
+ * block comes out of the slab, too.
+ */
+template<class T>
+class SlabAllocator
+{
+	static constexpr size_t ALIGN = alignof(std::max_align_t);
+	static constexpr size_t BLOCK = (sizeof(T) + ALIGN - 1) / ALIGN * ALIGN;
+
+public:
+	typedef T value_type;
+
+	SlabAllocator() noexcept {}
+	template<class U> SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+	T* allocate(size_t n)
+	{
+		if (1 == n and alignof(T) <= ALIGN)
+			return static_cast<T*>(SlabPool<BLOCK>::take());
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, size_t n) noexcept
+	{
+		if (1 == n and alignof(T) <= ALIGN)
+			SlabPool<BLOCK>::give(p);
+		else
+			::operator delete(p);
+	}
+
+	template<class U>
+	bool operator==(const SlabAllocator<U>&) const noexcept { return true; }
+	template<class U>
+	bool operator!=(const SlabAllocator<U>&) const noexcept { return false; }
+};
+
+/// Drop-in for std::make_shared, using the slab allocator when it
+/// is enabled.
+template<class T, class... Args>
+std::shared_ptr<T> slab_make_shared(Args&&... args)
+{
+#if USE_SLAB_ALLOCATOR
+	return std::allocate_shared<T>(SlabAllocator<T>(),
+	                               std::forward<Args>(args)...);
+#else
+	return std::make_shared<T>(std::forward<Args>(args)...);
+#endif
+}
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_SLAB_ALLOCATOR_H
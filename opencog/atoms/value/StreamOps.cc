@@ -0,0 +1,207 @@
+/*
+ * opencog/atoms/value/StreamOps.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+#include <opencog/util/platform.h>
+
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/value/StreamOps.h>
+
+using namespace opencog;
+
+// ==============================================================
+
+MapStream::MapStream(const FloatValuePtr& src, const Func& fn)
+	: StreamValue(MAP_STREAM), _src(src), _fn(fn)
+{
+	if (nullptr == _src or nullptr == _fn)
+		throw InvalidParamException(TRACE_INFO,
+			"MapStream: expecting a stream and a function");
+}
+
+void MapStream::update() const
+{
+	_value = _fn(_src->value());
+}
+
+// ==============================================================
+
+FilterStream::FilterStream(const FloatValuePtr& src, const Pred& pred,
+                           size_t patience)
+	: StreamValue(FILTER_STREAM), _src(src), _pred(pred),
+	  _patience(patience)
+{
+	if (nullptr == _src or nullptr == _pred)
+		throw InvalidParamException(TRACE_INFO,
+			"FilterStream: expecting a stream and a predicate");
+}
+
+void FilterStream::update() const
+{
+	for (size_t i = 0; i < _patience; i++)
+	{
+		const std::vector<double>& sample = _src->value();
+		if (_pred(sample))
+		{
+			_value = sample;
+			return;
+		}
+	}
+	_value.clear();
+}
+
+// ==============================================================
+
+WindowStream::WindowStream(const FloatValuePtr& src,
+                           size_t width, size_t step)
+	: StreamValue(WINDOW_STREAM), _src(src), _width(width), _step(step)
+{
+	if (nullptr == _src or 0 == _width or 0 == _step)
+		throw InvalidParamException(TRACE_INFO,
+			"WindowStream: expecting a stream, and a non-zero width and step");
+}
+
+void WindowStream::update() const
+{
+	// The first read fills the window.
+	size_t n = _window.empty() ? _width : _step;
+	for (size_t i = 0; i < n; i++)
+	{
+		_window.emplace_back(_src->value());
+		if (_width < _window.size()) _window.pop_front();
+	}
+
+	_value.clear();
+	for (const std::vector<double>& sample : _window)
+		_value.insert(_value.end(), sample.begin(), sample.end());
+}
+
+// ==============================================================
+
+BufferStream::BufferStream(const FloatValuePtr& src, size_t capacity)
+	: StreamValue(BUFFER_STREAM), _src(src),
+	  _buffer(createRingQueueValue(capacity))
+{
+	if (nullptr == _src)
+		throw InvalidParamException(TRACE_INFO,
+			"BufferStream: expecting a stream");
+	_reader = std::thread(&BufferStream::run, this);
+}
+
+BufferStream::~BufferStream()
+{
+	_buffer->close();
+	_reader.join();
+}
+
+void BufferStream::run(void)
+{
+	set_thread_name("atoms:buffer");
+	try
+	{
+		while (true)
+			_buffer->push(createFloatValue(_src->value()));
+	}
+	catch (const RingQueueValue::Canceled&) {}
+	catch (...)
+	{
+		// Nothing more will come; close, so that readers see an
+		// empty sample instead of waiting forever.
+		_buffer->close();
+	}
+}
+
+void BufferStream::update() const
+{
+	ValuePtr vp;
+	try
+	{
+		_buffer->pop(vp);
+		_value = FloatValueCast(vp)->value();
+	}
+	catch (const RingQueueValue::Canceled&)
+	{
+		_value.clear();
+	}
+}
+
+// ==============================================================
+
+static std::vector<double> add(const std::vector<double>& a,
+                               const std::vector<double>& b)
+{
+	std::vector<double> s(std::max(a.size(), b.size()), 0.0);
+	for (size_t i = 0; i < a.size(); i++) s[i] += a[i];
+	for (size_t i = 0; i < b.size(); i++) s[i] += b[i];
+	return s;
+}
+
+ReduceByKeyStream::ReduceByKeyStream(const LinkValuePtr& src,
+                                     const Func& fn)
+	: LinkStreamValue(REDUCE_BY_KEY_STREAM), _src(src), _fn(fn)
+{
+	if (nullptr == _src)
+		throw InvalidParamException(TRACE_INFO,
+			"ReduceByKeyStream: expecting a stream");
+	if (nullptr == _fn) _fn = add;
+}
+
+void ReduceByKeyStream::update() const
+{
+	for (const ValuePtr& item : _src->value())
+	{
+		LinkValuePtr lv(LinkValueCast(item));
+		if (nullptr == lv or lv->size() < 2)
+			throw InvalidParamException(TRACE_INFO,
+				"ReduceByKeyStream: expecting a key and a FloatValue, got %s",
+				item->to_string().c_str());
+
+		const ValueSeq& kv = lv->value();
+		Handle key(HandleCast(kv[0]));
+		FloatValuePtr fv(FloatValueCast(kv[1]));
+		if (nullptr == key or nullptr == fv)
+			throw InvalidParamException(TRACE_INFO,
+				"ReduceByKeyStream: expecting a key and a FloatValue, got %s",
+				item->to_string().c_str());
+
+		auto it = _totals.find(key);
+		if (_totals.end() == it)
+		{
+			_keys.emplace_back(key);
+			_totals.emplace(key, fv->value());
+		}
+		else
+			it->second = _fn(it->second, fv->value());
+	}
+
+	_value.clear();
+	for (const Handle& key : _keys)
+		_value.emplace_back(createLinkValue(ValueSeq({ValuePtr(key),
+			createFloatValue(_totals.at(key))})));
+}
+
+bool ReduceByKeyStream::operator==(const Value& other) const
+{
+	return &other == this;
+}
+
+// ==============================================================
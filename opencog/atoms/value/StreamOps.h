@@ -0,0 +1,190 @@
+/*
+ * opencog/atoms/value/StreamOps.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_STREAM_OPS_H
+#define _OPENCOG_STREAM_OPS_H
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/LinkStreamValue.h>
+#include <opencog/atoms/value/RingQueueValue.h>
+#include <opencog/atoms/value/StreamValue.h>
+
+namespace opencog
+{
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * Operators for building pipelines out of streams, without going
+ * through Atomese. Each one is itself a stream, reading from the one
+ * before it. Nothing is computed until the end of the pipeline is
+ * read: each read of an operator pulls what it needs from upstream,
+ * and no more. Thus, a slow consumer never gets buried by a fast
+ * producer; the BufferStream decouples the two, up to a bound.
+ *
+ * The upstream of a FloatValue operator can be any FloatValue; a
+ * plain FloatValue is a stream that never changes.
+ */
+
+/// Each sample, passed through a function.
+class MapStream
+	: public StreamValue
+{
+public:
+	typedef std::function<std::vector<double>(const std::vector<double>&)> Func;
+
+protected:
+	FloatValuePtr _src;
+	Func _fn;
+
+	virtual void update() const;
+
+public:
+	MapStream(const FloatValuePtr&, const Func&);
+	virtual ~MapStream() {}
+};
+
+/// Only the samples for which the predicate holds. A read pulls
+/// samples until one is accepted, but no more than `patience` of
+/// them; if none is, the sample is empty.
+class FilterStream
+	: public StreamValue
+{
+public:
+	typedef std::function<bool(const std::vector<double>&)> Pred;
+
+protected:
+	FloatValuePtr _src;
+	Pred _pred;
+	size_t _patience;
+
+	virtual void update() const;
+
+public:
+	FilterStream(const FloatValuePtr&, const Pred&, size_t patience = 1000);
+	virtual ~FilterStream() {}
+};
+
+/// The last `width` samples, oldest first, one after the other. Each
+/// read slides the window by `step` samples.
+class WindowStream
+	: public StreamValue
+{
+protected:
+	FloatValuePtr _src;
+	size_t _width;
+	size_t _step;
+	mutable std::deque<std::vector<double>> _window;
+
+	virtual void update() const;
+
+public:
+	WindowStream(const FloatValuePtr&, size_t width, size_t step = 1);
+	virtual ~WindowStream() {}
+};
+
+/// Samples are read ahead, in a thread of its own, and kept until
+/// taken, up to `capacity` of them; then the reading pauses until
+/// there is room. This is the stage to put after a source that is
+/// slow, or bursty, so that downstream reads do not wait on it.
+class BufferStream
+	: public StreamValue
+{
+protected:
+	FloatValuePtr _src;
+	RingQueueValuePtr _buffer;
+	std::thread _reader;
+
+	void run(void);
+	virtual void update() const;
+
+public:
+	BufferStream(const FloatValuePtr&, size_t capacity = 16);
+	virtual ~BufferStream();
+};
+
+/// Keyed running totals. Each read, the upstream provides a batch of
+/// items, each a LinkValue holding an Atom, the key, and a FloatValue.
+/// The FloatValues are combined, key by key, with those seen so far;
+/// by default, they are summed. The value is the sequence of totals,
+/// each a LinkValue of the key and a FloatValue, in the order the
+/// keys were first seen.
+class ReduceByKeyStream
+	: public LinkStreamValue
+{
+public:
+	typedef std::function<std::vector<double>(const std::vector<double>&,
+	                                          const std::vector<double>&)> Func;
+
+protected:
+	LinkValuePtr _src;
+	Func _fn;
+	mutable HandleSeq _keys;
+	mutable std::unordered_map<Handle, std::vector<double>> _totals;
+
+	virtual void update() const;
+
+public:
+	ReduceByKeyStream(const LinkValuePtr&, const Func& = Func());
+	virtual ~ReduceByKeyStream() {}
+
+	virtual bool operator==(const Value&) const;
+};
+
+typedef std::shared_ptr<MapStream> MapStreamPtr;
+typedef std::shared_ptr<FilterStream> FilterStreamPtr;
+typedef std::shared_ptr<WindowStream> WindowStreamPtr;
+typedef std::shared_ptr<BufferStream> BufferStreamPtr;
+typedef std::shared_ptr<ReduceByKeyStream> ReduceByKeyStreamPtr;
+
+template<typename ... Type>
+static inline MapStreamPtr createMapStream(Type&&... args) {
+	return std::make_shared<MapStream>(std::forward<Type>(args)...);
+}
+template<typename ... Type>
+static inline FilterStreamPtr createFilterStream(Type&&... args) {
+	return std::make_shared<FilterStream>(std::forward<Type>(args)...);
+}
+template<typename ... Type>
+static inline WindowStreamPtr createWindowStream(Type&&... args) {
+	return std::make_shared<WindowStream>(std::forward<Type>(args)...);
+}
+template<typename ... Type>
+static inline BufferStreamPtr createBufferStream(Type&&... args) {
+	return std::make_shared<BufferStream>(std::forward<Type>(args)...);
+}
+template<typename ... Type>
+static inline ReduceByKeyStreamPtr createReduceByKeyStream(Type&&... args) {
+	return std::make_shared<ReduceByKeyStream>(std::forward<Type>(args)...);
+}
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_STREAM_OPS_H
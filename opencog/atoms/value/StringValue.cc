@@ -29,6 +29,7 @@ using namespace opencog;
 
 bool StringValue::operator==(const Value& other) const
 {
+	if (this == &other) return true;
 	if (STRING_VALUE != other.get_type()) return false;
 
 	const StringValue* sov = (const StringValue*) &other;
@@ -0,0 +1,191 @@
+/*
+ * opencog/atoms/value/TimeSeriesValue.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <chrono>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/value/TimeSeriesValue.h>
+#include <opencog/atoms/value/ValueFactory.h>
+
+using namespace opencog;
+
+// ==============================================================
+
+TimeSeriesValue::TimeSeriesValue(size_t capacity) :
+	StreamValue(TIME_SERIES_VALUE)
+{
+	init(capacity);
+}
+
+/// The inverse of to_string(): the capacity, followed by pairs of
+/// time and value.
+TimeSeriesValue::TimeSeriesValue(const std::vector<double>& v) :
+	StreamValue(TIME_SERIES_VALUE)
+{
+	if (0 == v.size() or 0 == v.size() % 2)
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a capacity, followed by time-value pairs");
+
+	init((size_t) v[0]);
+	for (size_t i = 1; i < v.size(); i += 2)
+		append(v[i], v[i+1]);
+}
+
+void TimeSeriesValue::init(size_t capacity)
+{
+	if (0 == capacity)
+		throw InvalidParamException(TRACE_INFO,
+			"TimeSeriesValue capacity must be positive");
+
+	_ring.reset(new Sample[capacity]);
+	_capacity = capacity;
+	_start = 0;
+	_count = 0;
+}
+
+// ==============================================================
+
+void TimeSeriesValue::append(double t, double v)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (_count < _capacity)
+	{
+		_ring[(_start + _count) % _capacity] = {t, v};
+		_count++;
+		return;
+	}
+	_ring[_start] = {t, v};
+	_start = (_start + 1) % _capacity;
+}
+
+void TimeSeriesValue::append(double v)
+{
+	using namespace std::chrono;
+	double now = duration<double>(
+		system_clock::now().time_since_epoch()).count();
+	append(now, v);
+}
+
+void TimeSeriesValue::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_start = 0;
+	_count = 0;
+}
+
+size_t TimeSeriesValue::size() const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _count;
+}
+
+// ==============================================================
+
+/// Index, counting from the oldest, of the first sample at or after
+/// time `t`. The timestamps are sorted, so this is a binary search.
+/// The caller holds the lock.
+size_t TimeSeriesValue::first_at(double t) const
+{
+	size_t lo = 0;
+	size_t hi = _count;
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		if (_ring[(_start + mid) % _capacity].time < t) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+void TimeSeriesValue::read(const SpanFunc& fn, double from, double to) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	size_t lo = first_at(from);
+	size_t hi = first_at(to);
+	if (hi <= lo) return;
+
+	// At most two runs: up to the end of the ring, then from its start.
+	size_t b = (_start + lo) % _capacity;
+	size_t n = hi - lo;
+	size_t run = std::min(n, _capacity - b);
+	fn(&_ring[b], run);
+	if (run < n) fn(&_ring[0], n - run);
+}
+
+TimeSeriesValue::Stats TimeSeriesValue::aggregate(double from, double to) const
+{
+	Stats st = {0, 0.0, END, BEGIN};
+	read([&](const Sample* s, size_t n) {
+		for (size_t i = 0; i < n; i++)
+		{
+			st.sum += s[i].value;
+			st.min = std::min(st.min, s[i].value);
+			st.max = std::max(st.max, s[i].value);
+		}
+		st.count += n;
+	}, from, to);
+	return st;
+}
+
+std::vector<double> TimeSeriesValue::times(void) const
+{
+	std::vector<double> ts;
+	read([&](const Sample* s, size_t n) {
+		for (size_t i = 0; i < n; i++) ts.push_back(s[i].time);
+	});
+	return ts;
+}
+
+void TimeSeriesValue::update() const
+{
+	std::vector<double> vs;
+	read([&](const Sample* s, size_t n) {
+		for (size_t i = 0; i < n; i++) vs.push_back(s[i].value);
+	});
+	std::lock_guard<std::mutex> lck(_mtx);
+	_value.swap(vs);
+}
+
+// ==============================================================
+
+std::string TimeSeriesValue::to_string(const std::string& indent) const
+{
+	std::string rv = indent + "(" + nameserver().getTypeName(_type);
+	rv += " " + std::to_string(_capacity);
+	read([&](const Sample* s, size_t n) {
+		for (size_t i = 0; i < n; i++)
+		{
+			char buf[80];
+			snprintf(buf, 80, " %.16g %.16g", s[i].time, s[i].value);
+			rv += buf;
+		}
+	});
+	rv += ")";
+	return rv;
+}
+
+// ==============================================================
+
+// Adds factory when library is loaded.
+DEFINE_VALUE_FACTORY(TIME_SERIES_VALUE, createTimeSeriesValue,
+                     std::vector<double>)
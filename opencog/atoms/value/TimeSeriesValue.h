@@ -0,0 +1,136 @@
+/*
+ * opencog/atoms/value/TimeSeriesValue.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef _OPENCOG_TIME_SERIES_VALUE_H
+#define _OPENCOG_TIME_SERIES_VALUE_H
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <opencog/atoms/value/StreamValue.h>
+#include <opencog/atoms/atom_types/atom_types.h>
+
+namespace opencog
+{
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A bounded history of timestamped readings, such as those of a
+ * sensor. The samples are kept in a ring of fixed capacity; once it
+ * is full, each append() overwrites the oldest sample. Appending is
+ * O(1), and never allocates.
+ *
+ * As a stream, the value() is the readings, oldest first; times()
+ * gives the matching timestamps. Timestamps are seconds since the
+ * epoch, and are expected to be non-decreasing.
+ *
+ * The encoding, as an s-expression, is
+ *    (TimeSeriesValue CAPACITY TIME VALUE TIME VALUE ...)
+ */
+class TimeSeriesValue
+	: public StreamValue
+{
+public:
+	struct Sample
+	{
+		double time;
+		double value;
+	};
+
+	/// Called with up to two runs of samples, oldest first.
+	typedef std::function<void(const Sample*, size_t)> SpanFunc;
+
+	/// Aggregates over a window of time.
+	struct Stats
+	{
+		size_t count;
+		double sum;
+		double min;
+		double max;
+		double mean(void) const { return count ? sum / count : 0.0; }
+	};
+
+	static constexpr double BEGIN = -std::numeric_limits<double>::infinity();
+	static constexpr double END = std::numeric_limits<double>::infinity();
+
+protected:
+	mutable std::mutex _mtx;
+	std::unique_ptr<Sample[]> _ring;
+	size_t _capacity;
+	size_t _start;
+	size_t _count;
+
+	void init(size_t);
+	size_t first_at(double) const;
+
+	virtual void update() const;
+
+public:
+	TimeSeriesValue(size_t capacity = 1024);
+	TimeSeriesValue(const std::vector<double>&);
+	virtual ~TimeSeriesValue() {}
+
+	/// Append a reading, taken at time `t`, or now.
+	void append(double t, double v);
+	void append(double v);
+
+	void clear(void);
+
+	virtual size_t size() const;
+	size_t capacity(void) const { return _capacity; }
+
+	/// The timestamps of the readings in value().
+	std::vector<double> times(void) const;
+
+	/// Call `fn` on the samples with `from <= time < to`, in place,
+	/// without copying. The lock is held while `fn` runs: it must not
+	/// append to this series.
+	void read(const SpanFunc& fn, double from = BEGIN,
+	          double to = END) const;
+
+	/// Count, sum, min and max of the readings with `from <= time < to`.
+	Stats aggregate(double from = BEGIN, double to = END) const;
+
+	/** Returns a string representation of the value.  */
+	virtual std::string to_string(const std::string& indent = "") const;
+};
+
+typedef std::shared_ptr<TimeSeriesValue> TimeSeriesValuePtr;
+static inline TimeSeriesValuePtr TimeSeriesValueCast(const ValuePtr& a)
+	{ return std::dynamic_pointer_cast<TimeSeriesValue>(a); }
+
+template<typename ... Type>
+static inline std::shared_ptr<TimeSeriesValue> createTimeSeriesValue(Type&&... args) {
+	return std::make_shared<TimeSeriesValue>(std::forward<Type>(args)...);
+}
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_TIME_SERIES_VALUE_H
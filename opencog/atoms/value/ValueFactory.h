@@ -2,6 +2,7 @@
 #define _VALUE_FACTORY_H_
 
 #include "Value.h"
+#include "ValueIntern.h"
 #include <opencog/util/exceptions.h>
 
 #include <map>
@@ -121,7 +122,7 @@ public:
         }
 
         if (fptr)
-            return (*fptr)(&arg...);
+            return ValueIntern::intern((*fptr)(&arg...));
 
         std::vector<std::type_index> expected_args =
                         to_list_of_type_indexes<ARG...>();
@@ -0,0 +1,154 @@
+/*
+ * opencog/atoms/value/ValueIntern.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/StringValue.h>
+#include <opencog/atoms/value/ValueIntern.h>
+
+using namespace opencog;
+
+// ==============================================================
+
+std::atomic<bool> ValueIntern::_enabled(false);
+
+bool ValueIntern::internable(Type t)
+{
+	if (FLOAT_VALUE == t or STRING_VALUE == t) return true;
+	return nameserver().isA(t, TRUTH_VALUE) and
+		not nameserver().isA(t, FORMULA_TRUTH_VALUE);
+}
+
+// ==============================================================
+
+static inline void mix(size_t& h, size_t v)
+{
+	h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+}
+
+static size_t hash_of(const Value* v)
+{
+	size_t h = v->get_type();
+	if (STRING_VALUE == v->get_type())
+	{
+		for (const std::string& s : ((const StringValue*) v)->value())
+			mix(h, std::hash<std::string>()(s));
+		return h;
+	}
+
+	const FloatValue* fv = (const FloatValue*) v;
+	const double* d = fv->data();
+	for (size_t i = 0; i < fv->size(); i++)
+	{
+		uint64_t bits;
+		memcpy(&bits, &d[i], sizeof(bits));
+		mix(h, bits);
+	}
+	return h;
+}
+
+// Bit for bit; operator== on TruthValues is too forgiving.
+static bool same(const Value* a, const Value* b)
+{
+	if (a->get_type() != b->get_type()) return false;
+	if (typeid(*a) != typeid(*b)) return false;
+
+	if (STRING_VALUE == a->get_type())
+		return ((const StringValue*) a)->value() ==
+		       ((const StringValue*) b)->value();
+
+	const FloatValue* fa = (const FloatValue*) a;
+	const FloatValue* fb = (const FloatValue*) b;
+	return fa->size() == fb->size() and
+		0 == memcmp(fa->data(), fb->data(), fa->size() * sizeof(double));
+}
+
+// ==============================================================
+
+#define NSHARDS 64
+
+struct Shard
+{
+	std::mutex mtx;
+	std::unordered_multimap<size_t, std::weak_ptr<Value>> table;
+
+	// Sweep out expired entries whenever the table has doubled since
+	// the last sweep.
+	size_t sweep_at = 1024;
+
+	void sweep(void)
+	{
+		for (auto it = table.begin(); it != table.end(); )
+		{
+			if (it->second.expired()) it = table.erase(it);
+			else it++;
+		}
+		sweep_at = std::max((size_t) 1024, 2 * table.size());
+	}
+};
+
+static Shard _shards[NSHARDS];
+
+ValuePtr ValueIntern::lookup(const ValuePtr& vp)
+{
+	if (not internable(vp->get_type())) return vp;
+
+	size_t h = hash_of(vp.get());
+	Shard& sh = _shards[(h >> 8) % NSHARDS];
+
+	std::lock_guard<std::mutex> lck(sh.mtx);
+	auto range = sh.table.equal_range(h);
+	for (auto it = range.first; it != range.second; )
+	{
+		ValuePtr old(it->second.lock());
+		if (nullptr == old)
+		{
+			it = sh.table.erase(it);
+			continue;
+		}
+		if (old == vp or same(old.get(), vp.get())) return old;
+		it++;
+	}
+
+	if (sh.sweep_at <= sh.table.size()) sh.sweep();
+	sh.table.emplace(h, vp);
+	return vp;
+}
+
+size_t ValueIntern::size(void)
+{
+	size_t n = 0;
+	for (Shard& sh : _shards)
+	{
+		std::lock_guard<std::mutex> lck(sh.mtx);
+		n += sh.table.size();
+	}
+	return n;
+}
+
+// ==============================================================
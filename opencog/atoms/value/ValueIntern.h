@@ -0,0 +1,97 @@
+/*
+ * opencog/atoms/value/ValueIntern.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef _OPENCOG_VALUE_INTERN_H
+#define _OPENCOG_VALUE_INTERN_H
+
+#include <atomic>
+#include <memory>
+
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A table of shared instances of immutable Values: FloatValues,
+ * StringValues, and the TruthValues other than the FormulaTruthValue.
+ * When interning is enabled, the value factories, and the TruthValue
+ * factories, hand out one instance per distinct (type, contents),
+ * instead of a new one each time. An AtomSpace where millions of atoms
+ * carry the same TruthValue then holds just one copy of it; and equal
+ * Values are usually the same pointer, which operator== checks first.
+ *
+ * Contents must match exactly, bit for bit; TruthValues that are
+ * merely nearly equal stay separate. The table does not keep Values
+ * alive: entries are dropped once the last user lets go.
+ *
+ * Interning is off by default. It costs a hash and a (sharded) lock
+ * per Value created, which pays off only when many of them are alike.
+ */
+class ValueIntern
+{
+	static std::atomic<bool> _enabled;
+
+	static ValuePtr lookup(const ValuePtr&);
+
+public:
+	static void enable(bool on = true) { _enabled = on; }
+	static bool enabled(void) { return _enabled; }
+
+	/// Return true if Values of this type are never changed, once made.
+	static bool internable(Type);
+
+	/// The shared instance equal to this Value; the Value itself, if
+	/// there is none yet, or if interning is disabled.
+	static ValuePtr intern(const ValuePtr& vp)
+	{
+		if (not _enabled or nullptr == vp) return vp;
+		return lookup(vp);
+	}
+
+	/// As above, for pointers to const subclasses, e.g. TruthValuePtr.
+	template<typename T>
+	static std::shared_ptr<const T> intern(const std::shared_ptr<const T>& p)
+	{
+		if (not _enabled or nullptr == p) return p;
+		ValuePtr vp(p, (Value*) p.get());
+		return std::static_pointer_cast<const T>(lookup(vp));
+	}
+
+	/// Enter the Value, even if interning is disabled, so that it will
+	/// be found once it is enabled. For the well-known constants, such
+	/// as TruthValue::DEFAULT_TV().
+	static ValuePtr add(const ValuePtr& vp) { return lookup(vp); }
+
+	/// Number of entries, including some that may have expired.
+	static size_t size(void);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_VALUE_INTERN_H
@@ -0,0 +1,143 @@
+/*
+ * opencog/atoms/value/ValueReads.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/value/ValueReads.h>
+
+using namespace opencog;
+
+// ==============================================================
+
+#define NSLOTS 4096
+
+thread_local ValueReads* ValueReads::_active = nullptr;
+
+// Bumped whenever any Value is changed.
+static std::atomic<uint64_t> _changes(0);
+
+// Bumped whenever a Value in the slot is changed.
+static std::atomic<uint64_t> _slots[NSLOTS];
+
+static inline size_t slot(const Atom* atom, uint64_t key)
+{
+	uint64_t h = key ^ (reinterpret_cast<uintptr_t>(atom) >> 4);
+	h *= 0x9e3779b97f4a7c15ULL;
+	return (h >> 32) % NSLOTS;
+}
+
+void ValueReads::changed(const Atom* atom, uint64_t key)
+{
+	_slots[slot(atom, key)].fetch_add(1, std::memory_order_release);
+	_changes.fetch_add(1, std::memory_order_release);
+}
+
+// The version is taken before the Value is read. If it changes in
+// between, the result is merely recomputed on the next read.
+void ValueReads::note(const Atom* atom, uint64_t key)
+{
+	size_t s = slot(atom, key);
+	_active->_seen.emplace_back(s,
+		_slots[s].load(std::memory_order_acquire));
+}
+
+void ValueReads::note(const ValuePtr& vp)
+{
+	Type t = vp->get_type();
+	if (nameserver().isA(t, STREAM_VALUE) or
+	    nameserver().isA(t, LINK_STREAM_VALUE))
+		_active->_volatile = true;
+}
+
+// ==============================================================
+
+bool ValueReads::unchanged(void) const
+{
+	if (not _valid or _volatile) return false;
+
+	uint64_t now = _changes.load(std::memory_order_acquire);
+	if (now == _epoch) return true;
+
+	for (const auto& pr : _seen)
+		if (_slots[pr.first].load(std::memory_order_acquire) != pr.second)
+			return false;
+
+	// Something else changed; not us. Skip the check next time.
+	_epoch = now;
+	return true;
+}
+
+ValueReads::Recording::Recording(ValueReads& reads) :
+	_reads(reads)
+{
+	_reads._valid = false;
+	_reads._volatile = false;
+	_reads._seen.clear();
+
+	// Take the epoch first; any change made while the formula runs
+	// forces a check of the versions seen.
+	_reads._epoch = _changes.load(std::memory_order_acquire);
+	_reads._prev = _active;
+	_active = &_reads;
+}
+
+ValueReads::Recording::~Recording()
+{
+	_active = _reads._prev;
+	_reads._prev = nullptr;
+}
+
+void ValueReads::Recording::done(void)
+{
+	_reads._valid = _reads._allowed;
+}
+
+// ==============================================================
+
+bool ValueReads::cacheable(const Handle& h)
+{
+	Type t = h->get_type();
+	if (nameserver().isA(t, SATISFYING_LINK) or
+	    nameserver().isA(t, JOIN_LINK) or
+	    nameserver().isA(t, SET_VALUE_LINK) or
+	    nameserver().isA(t, PARALLEL_LINK) or
+	    EXECUTE_THREADED_LINK == t or
+	    RANDOM_NUMBER_LINK == t or
+	    RANDOM_CHOICE_LINK == t or
+	    TIME_LINK == t or
+	    SLEEP_LINK == t or
+	    DEFINED_SCHEMA_NODE == t or
+	    DEFINED_PREDICATE_NODE == t)
+		return false;
+
+	// Pure schemas promise to depend on their arguments only.
+	if (nameserver().isA(t, GROUNDED_PROCEDURE_NODE) and
+	    not nameserver().isA(t, PURE_SCHEMA_NODE))
+		return false;
+
+	if (not h->is_link()) return true;
+	for (const Handle& ho : h->getOutgoingSet())
+		if (not cacheable(ho)) return false;
+	return true;
+}
+
+// ==============================================================
@@ -0,0 +1,115 @@
+/*
+ * opencog/atoms/value/ValueReads.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_VALUE_READS_H
+#define _OPENCOG_VALUE_READS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+class Atom;
+class Handle;
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * The (atom, key) Values read while computing a formula, so that the
+ * result can be reused until one of them changes.
+ *
+ * While a Recording is in progress, every Atom::getValue() made in
+ * that thread is noted; every Atom::setValue(), in any thread, bumps
+ * a version number for that (atom, key). The result is unchanged()
+ * for as long as none of the versions seen have moved. Versions are
+ * kept in a fixed-size table, and unrelated (atom, key) pairs may
+ * share a slot; the only harm is an occasional needless recompute.
+ *
+ * Reading a stream (including another formula) makes the result
+ * volatile: such a result is never reused. Formulas that search
+ * the AtomSpace, draw random numbers, call out to grounded functions
+ * and the like are not cacheable() at all.
+ */
+class ValueReads
+{
+	static thread_local ValueReads* _active;
+
+	std::vector<std::pair<size_t, uint64_t>> _seen;
+	mutable uint64_t _epoch;
+	bool _allowed;
+	bool _volatile;
+	bool _valid;
+	ValueReads* _prev;
+
+	static void note(const Atom*, uint64_t);
+	static void note(const ValuePtr&);
+
+public:
+	ValueReads(bool allowed = true) :
+		_epoch(0), _allowed(allowed), _volatile(false),
+		_valid(false), _prev(nullptr) {}
+
+	/// Return true if the last result recorded can still be used.
+	bool unchanged(void) const;
+
+	/// Forget the last result.
+	void reset(void) { _valid = false; }
+
+	/// Record the reads made during the life of this object. The
+	/// result is kept only if done() is called; so, not if an
+	/// exception was thrown while computing it.
+	class Recording
+	{
+		ValueReads& _reads;
+	public:
+		Recording(ValueReads&);
+		~Recording();
+		void done(void);
+	};
+
+	/// Called by the Atom just before a Value is read, just after it
+	/// was read, and just after it was changed. The key is given by
+	/// its hash.
+	static void reading(const Atom* atom, uint64_t key)
+	{
+		if (_active) note(atom, key);
+	}
+	static void read(const ValuePtr& vp)
+	{
+		if (_active and vp) note(vp);
+	}
+	static void changed(const Atom*, uint64_t);
+
+	/// Return true if the result of the formula depends only on the
+	/// Values it reads.
+	static bool cacheable(const Handle&);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_VALUE_READS_H
@@ -21,6 +21,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <climits>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -32,8 +33,10 @@
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/truthvalue/CountTruthValue.h>
 #include <opencog/atoms/value/LinkValue.h>
 #include <opencog/atoms/value/ValueFactory.h>
+#include <opencog/util/Logger.h>
 
 #include "AtomSpace.h"
 
@@ -87,6 +90,18 @@ bool AtomSpace::compare_atomspaces(const AtomSpace& space_first,
         return false;
     }
 
+    // With digests on both sides, the roots say it all; but only for
+    // single frames, as that is all that the digests cover.
+    if (check_values and space_first._environ.empty() and
+        space_second._environ.empty() and
+        space_first.tracking_digests() and space_second.tracking_digests())
+    {
+        bool same = space_first._digests->root() ==
+                    space_second._digests->root();
+        if (same or not emit_diagnostics) return same;
+        std::cout << "compare_atomspaces - digests differ" << std::endl;
+    }
+
     // If we get this far, we need to compare each individual atom.
 
     // Get the atoms in each atomspace.
@@ -215,6 +230,30 @@ bool AtomSpace::compare_atomspaces(const AtomSpace& space_first,
     return true;
 }
 
+void AtomSpace::diff_atomspaces(const AtomSpace& first,
+                                const AtomSpace& second,
+                                HandleSeq& in_first,
+                                HandleSeq& in_second)
+{
+    std::vector<MerkleTree::Node> buckets(
+        first.get_digests().diff(second.get_digests()));
+    if (buckets.empty()) return;
+
+    auto pick = [&](const AtomSpace& from, const AtomSpace& to,
+                    HandleSeq& out)
+    {
+        for (const Handle& h : MerkleTree::atoms_in(from, buckets))
+        {
+            Handle ho(to.typeIndex.findAtom(h));
+            if (nullptr == ho or
+                MerkleTree::values_digest(h) != MerkleTree::values_digest(ho))
+                out.push_back(h);
+        }
+    };
+    pick(first, second, in_first);
+    pick(second, first, in_second);
+}
+
 bool AtomSpace::operator==(const AtomSpace& other) const
 {
     return compare_atomspaces(*this, other, CHECK_VALUES,
@@ -293,21 +332,15 @@ void AtomSpace::setAtomSpace(AtomSpace* as)
 }
 
 // ====================================================================
-// XXX FIXME -- The recursive design of the two routines below make
-// them into a bottleneck, when the stack of AtomSpaces exceeds a few
-// hundred. In particular, the recursion is on the C stack, and I don't
-// beleive the compiler has optimized them to be tail-recursive. (If
-// they are tail-recursive, I guess that's OK, eh?)
+// Both of these walk the flattened frame list; see flatten_frames().
 
 int AtomSpace::depth(const Handle& atom) const
 {
     if (nullptr == atom) return -1;
-    if (atom->getAtomSpace() == this) return 0;
-
-    for (const AtomSpacePtr& base : _environ)
+    const AtomSpace* as = atom->getAtomSpace();
+    for (const EnvFrame& f : _frames)
     {
-        int d = base->depth(atom);
-        if (0 < d) return d+1;
+        if (f.space == as) return f.depth;
     }
     return -1;
 }
@@ -315,14 +348,76 @@ int AtomSpace::depth(const Handle& atom) const
 bool AtomSpace::in_environ(const Handle& atom) const
 {
     if (nullptr == atom) return false;
-    if (atom->getAtomSpace() == this) return true;
-    for (const AtomSpacePtr& base : _environ)
+    const AtomSpace* as = atom->getAtomSpace();
+    for (const EnvFrame& f : _frames)
     {
-        if (base->in_environ(atom)) return true;
+        if (f.space == as) return true;
     }
     return false;
 }
 
+// ====================================================================
+// Definitions.
+
+std::atomic<size_t> AtomSpace::_definition_changes(0);
+
+/// Only the first definition is kept; any later ones, for the same
+/// alias, can only be copies of it, that lost a race to be added.
+void AtomSpace::set_definition(const Handle& alias, const Handle& defl)
+{
+    {
+        std::unique_lock<std::shared_mutex> lck(_defs_mtx);
+        if (not _definitions.insert({alias, defl}).second) return;
+    }
+    _definition_changes++;
+    _definitionSignal.emit(alias);
+}
+
+void AtomSpace::clear_definition(const Handle& alias, const Handle& defl)
+{
+    {
+        std::unique_lock<std::shared_mutex> lck(_defs_mtx);
+        auto it = _definitions.find(alias);
+        if (_definitions.end() == it or it->second != defl) return;
+        _definitions.erase(it);
+    }
+    _definition_changes++;
+    _definitionSignal.emit(alias);
+}
+
+Handle AtomSpace::local_definition(const Handle& alias) const
+{
+    std::shared_lock<std::shared_mutex> lck(_defs_mtx);
+    auto it = _definitions.find(alias);
+    if (_definitions.end() == it) return Handle::UNDEFINED;
+    return it->second;
+}
+
+/// Walk the frames as lookupHandle() does; an absent (extracted but
+/// still present in a copy-on-write space) definition hides those
+/// below it. The frames below a definition are deeper, and cannot
+/// hold a shallower one.
+Handle AtomSpace::get_definition(const Handle& alias) const
+{
+    Handle best;
+    int depth = INT_MAX;
+    size_t i = 0;
+    size_t nframes = _frames.size();
+    while (i < nframes)
+    {
+        const EnvFrame& f(_frames[i]);
+        Handle defl(f.space->local_definition(alias));
+        if (nullptr == defl) { i++; continue; }
+        if (not defl->isAbsent() and f.depth < depth)
+        {
+            best = defl;
+            depth = f.depth;
+        }
+        i = f.next;
+    }
+    return best;
+}
+
 // ====================================================================
 
 Handle AtomSpace::add_atom(const Handle& h)
@@ -404,9 +499,76 @@ ValuePtr AtomSpace::add_atoms(const ValuePtr& vptr)
 }
 
 // Copy-on-write for setting values.
-Handle AtomSpace::set_value(const Handle& h,
-                            const Handle& key,
-                            const ValuePtr& value)
+// ====================================================================
+
+/// If this is a value-overlay space, and the atom lives in one of the
+/// bases, record the value here, and return true. Otherwise, do
+/// nothing, and return false.
+// Return true if Values set on `h` in this space go into the overlay.
+bool AtomSpace::overlays(const Handle& h) const
+{
+    if (not _value_overlay or not _copy_on_write or _read_only)
+        return false;
+
+    AtomSpace* has = h->getAtomSpace();
+    if (nullptr == has or has == this or not in_environ(h))
+        return false;
+
+    // If a copy was already made in this space, the caller must use
+    // that, instead.
+    return nullptr == typeIndex.findAtom(h);
+}
+
+bool AtomSpace::overlay_value(const Handle& h,
+                              const Handle& key,
+                              const ValuePtr& value)
+{
+    if (not overlays(h)) return false;
+
+    std::lock_guard<std::mutex> lck(_overlay_mtx);
+    // A null Value is kept, too: it hides the Value on the Atom below.
+    _overlay[h][key] = value;
+    return true;
+}
+
+bool AtomSpace::find_overlay(const Handle& h,
+                             const Handle& key,
+                             ValuePtr& value) const
+{
+    std::lock_guard<std::mutex> lck(_overlay_mtx);
+    auto ait = _overlay.find(h);
+    if (_overlay.end() == ait) return false;
+    auto kit = ait->second.find(key);
+    if (ait->second.end() == kit) return false;
+    value = kit->second;
+    return true;
+}
+
+ValuePtr AtomSpace::get_value(const Handle& h, const Handle& key) const
+{
+    // Walk down the frames, until the frame holding the Atom is
+    // reached; that frame and those below it see the Atom's own
+    // Values.
+    const AtomSpace* has = h->getAtomSpace();
+    for (const EnvFrame& f : _frames)
+    {
+        if (f.space == has) break;
+        if (not f.space->_value_overlay) continue;
+
+        ValuePtr vp;
+        if (f.space->find_overlay(h, key, vp)) return vp;
+    }
+    return h->getValue(key);
+}
+
+TruthValuePtr AtomSpace::get_truthvalue(const Handle& h) const
+{
+    ValuePtr vp(get_value(h, Atom::truth_key()));
+    if (nullptr == vp) return TruthValue::DEFAULT_TV();
+    return TruthValueCast(vp);
+}
+
+Handle AtomSpace::writable(const Handle& h, const char* what)
 {
     AtomSpace* has = h->getAtomSpace();
 
@@ -425,61 +587,92 @@ Handle AtomSpace::set_value(const Handle& h,
     if (nullptr == has or has->_read_only or _copy_on_write) {
         if (has != this and (_copy_on_write or not _read_only)) {
             // Copy the atom into this atomspace
-            Handle copy(add(h, true));
-            copy->setValue(key, value);
-            return copy;
+            return add(h, true);
         }
 
         // No copy needed. Safe to just update.
-        if (has == this and not _read_only) {
-            h->setValue(key, value);
+        if (has == this and not _read_only)
             return h;
-        }
     } else {
-        h->setValue(key, value);
         return h;
     }
     throw opencog::RuntimeException(TRACE_INFO,
-         "Value not changed; AtomSpace is readonly");
+         "%s not changed; AtomSpace is readonly", what);
     return Handle::UNDEFINED;
 }
 
+Handle AtomSpace::set_value(const Handle& h,
+                            const Handle& key,
+                            const ValuePtr& value)
+{
+    // Record the value without copying the atom, if possible.
+    if (overlay_value(h, key, value)) return h;
+
+    Handle ha(writable(h, "Value"));
+    ha->setValue(key, value);
+    return ha;
+}
+
 // Copy-on-write for setting truth values.
 Handle AtomSpace::set_truthvalue(const Handle& h, const TruthValuePtr& tvp)
 {
-    AtomSpace* has = h->getAtomSpace();
-    // Hmm. It's kind-of a user-error, if they give us a naked atom.
-    // We could throw here, and force them to fix their code, or we
-    // can silently do what they wanted!? Which will probably expose
-    // other hard-to-debug bugs in the user's code ...
-    // if (nullptr == has)
-    //     throw opencog::RuntimeException(TRACE_INFO,
-    //            "Your atom is needs to be placed in an atomspace!")
+    // Record the value without copying the atom, if possible.
+    TruthValuePtr oldtv(_value_overlay ? get_truthvalue(h) : nullptr);
+    if (overlay_value(h, Atom::truth_key(), ValueCast(tvp)))
+    {
+        emit_tv_changed(h, oldtv, tvp);
+        return h;
+    }
 
-    // If the atom is in a read-only atomspace (i.e. if the parent
-    // is read-only) and this atomspace is read-write, then make
-    // a copy of the atom, and then set the value.
-    // If this is a COW space, then always copy, no matter what.
-    if (nullptr == has or has->_read_only or _copy_on_write) {
-        if (has != this and (_copy_on_write or not _read_only)) {
-            // Copy the atom into this atomspace
-            Handle copy(add(h, true));
-            copy->setTruthValue(tvp);
-            return copy;
+    Handle ha(writable(h, "TruthValue"));
+    ha->setTruthValue(tvp);
+    return ha;
+}
+
+// Overlays are rare, and kept in a map; increments on them take the
+// slow path, under a common lock. The usual case is just the Atom's.
+static std::mutex _overlay_incr_mtx;
+
+Handle AtomSpace::increment_count(const Handle& h, const Handle& key,
+                                  size_t ref, double delta)
+{
+    if (overlays(h))
+    {
+        std::lock_guard<std::mutex> lck(_overlay_incr_mtx);
+        if (overlay_value(h, key, increment(get_value(h, key), ref, delta)))
+            return h;
+    }
+
+    Handle ha(writable(h, "Value"));
+    ha->incrementCount(key, ref, delta);
+    return ha;
+}
+
+Handle AtomSpace::increment_countTV(const Handle& h, double delta)
+{
+    if (overlays(h))
+    {
+        TruthValuePtr oldtv, newtv;
+        bool done;
+        {
+            std::lock_guard<std::mutex> lck(_overlay_incr_mtx);
+            oldtv = get_truthvalue(h);
+            newtv = CountTruthValue::increment(oldtv, delta);
+            done = overlay_value(h, Atom::truth_key(), ValueCast(newtv));
         }
 
-        // No copy needed. Safe to just update.
-        if (has == this and not _read_only) {
-            h->setTruthValue(tvp);
+        // Not under the lock: a subscriber may well increment some
+        // other overlaid Atom.
+        if (done)
+        {
+            emit_tv_changed(h, oldtv, newtv);
             return h;
         }
-    } else {
-        h->setTruthValue(tvp);
-        return h;
     }
-    throw opencog::RuntimeException(TRACE_INFO,
-         "TruthValue not changed; AtomSpace is readonly");
-    return Handle::UNDEFINED;
+
+    Handle ha(writable(h, "TruthValue"));
+    ha->incrementCountTV(delta);
+    return ha;
 }
 
 std::string AtomSpace::to_string(void) const
@@ -511,3 +704,318 @@ ostream& operator<<(ostream& out, const opencog::AtomSpace& as)
 }
 
 } // namespace std
+
+// ====================================================================
+// Asynchronous signal delivery.
+
+void AtomSpace::set_async_signals(bool on)
+{
+    std::lock_guard<std::mutex> lck(_dispatcher_mtx);
+    if (on)
+    {
+        if (_async_signals) return;
+        _dispatcher = std::thread(&AtomSpace::dispatch_loop, this);
+        _async_signals = true;
+        return;
+    }
+
+    if (not _async_signals) return;
+    _async_signals = false;
+
+    // Writers that saw the flag still set get to queue their event;
+    // all later ones deliver synchronously. The queue is never
+    // cancelled, so no writer can be caught by that. Everything
+    // queued before the stop is delivered before the dispatcher quits.
+    while (0 < _signal_writers.load()) std::this_thread::yield();
+    _signal_queue.push(SignalEvent{SignalEvent::STOP,
+                                   Handle::UNDEFINED, nullptr, nullptr, nullptr});
+    _dispatcher.join();
+}
+
+void AtomSpace::stop_dispatcher(void)
+{
+    set_async_signals(false);
+}
+
+void AtomSpace::flush_signals(void)
+{
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> fut(done->get_future());
+    {
+        // The dispatcher cannot be stopped in between; the flush is
+        // queued ahead of the stop, and so is answered.
+        std::lock_guard<std::mutex> lck(_dispatcher_mtx);
+        if (not _dispatcher.joinable()) return;
+        _signal_queue.push(SignalEvent{SignalEvent::FLUSH,
+                                       Handle::UNDEFINED, nullptr, nullptr, done});
+    }
+    fut.wait();
+}
+
+void AtomSpace::dispatch_loop(void)
+{
+    bool stop = false;
+    while (not stop)
+    {
+        std::deque<SignalEvent> evs(_signal_queue.wait_and_take_all());
+        stop = deliver(evs);
+    }
+}
+
+/// Coalesce and deliver one batch of queued events. Return true if
+/// the batch held the request to stop.
+bool AtomSpace::deliver(std::deque<SignalEvent>& evs)
+{
+    std::vector<SignalEvent> out;
+
+    // Where in `out` the last add-or-remove, and the last TV change,
+    // of each Atom is. Adds and removes are kept in order, so that
+    // the last one delivered says whether the Atom is still here.
+    std::unordered_map<const Atom*, size_t> member;
+    std::unordered_map<const Atom*, size_t> tvchg;
+    HandleSeq added;
+    HandleSeq removed;
+
+    auto emit_batch = [&]()
+    {
+        // In the batch signals, each Atom appears once, as it ended up.
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            const SignalEvent& ev(out[i]);
+            if (SignalEvent::TV == ev.kind) continue;
+            if (member[ev.atom.get()] != i) continue;
+            if (SignalEvent::ADD == ev.kind)
+                added.push_back(ev.atom);
+            else
+                removed.push_back(ev.atom);
+        }
+
+        try
+        {
+            for (const SignalEvent& ev : out)
+            {
+                if (SignalEvent::ADD == ev.kind)
+                    _addAtomSignal.emit(ev.atom);
+                else if (SignalEvent::REMOVE == ev.kind)
+                    _removeAtomSignal.emit(ev.atom);
+                else
+                    _TVChangedSignal.emit(ev.atom, ev.oldtv, ev.newtv);
+            }
+            if (0 < added.size())
+                _addAtomsSignal.emit(added);
+            if (0 < removed.size())
+                _removeAtomsSignal.emit(removed);
+        }
+        catch (const std::exception& ex)
+        {
+            logger().warn("AtomSpace: signal subscriber threw: %s",
+                          ex.what());
+        }
+        out.clear();
+        added.clear();
+        removed.clear();
+        member.clear();
+        tvchg.clear();
+    };
+
+    bool stop = false;
+    for (SignalEvent& ev : evs)
+    {
+        if (SignalEvent::FLUSH == ev.kind)
+        {
+            emit_batch();
+            ev.done->set_value();
+            continue;
+        }
+        if (SignalEvent::STOP == ev.kind)
+        {
+            stop = true;
+            continue;
+        }
+
+        const Atom* atom = ev.atom.get();
+        if (SignalEvent::TV == ev.kind)
+        {
+            // A run of TV changes is merged into the first of them.
+            auto it = tvchg.find(atom);
+            if (tvchg.end() != it)
+            {
+                out[it->second].newtv = ev.newtv;
+                continue;
+            }
+            tvchg.insert({atom, out.size()});
+        }
+        else
+        {
+            // The same change, again, says nothing new; the opposite
+            // one must be delivered after whatever came before it.
+            auto it = member.find(atom);
+            if (member.end() != it)
+            {
+                if (out[it->second].kind == ev.kind) continue;
+                it->second = out.size();
+            }
+            else
+                member.insert({atom, out.size()});
+        }
+        out.emplace_back(std::move(ev));
+    }
+    emit_batch();
+    return stop;
+}
+
+// ====================================================================
+// Version stamps, for transactions.
+
+#define NUM_STAMPS 16384
+
+std::atomic<size_t> AtomSpace::_open_transactions(0);
+
+static std::atomic<uint64_t> _stamp_clock(0);
+static std::atomic<uint64_t> _stamps[NUM_STAMPS];
+
+static inline size_t stamp_slot(const Atom* atom)
+{
+    uint64_t h = reinterpret_cast<uintptr_t>(atom) >> 4;
+    h *= 0x9e3779b97f4a7c15ULL;
+    return (h >> 32) % NUM_STAMPS;
+}
+
+void AtomSpace::stamp(const Atom* atom)
+{
+    uint64_t now = ++_stamp_clock;
+
+    // Two changes sharing a slot may race; keep the later one.
+    std::atomic<uint64_t>& slot(_stamps[stamp_slot(atom)]);
+    uint64_t was = slot.load();
+    while (was < now and not slot.compare_exchange_weak(was, now)) {}
+}
+
+uint64_t AtomSpace::stamp_of(const Atom* atom)
+{
+    return _stamps[stamp_slot(atom)].load();
+}
+
+/// Returns the time at which the transaction starts; changes stamped
+/// later than that were not seen by it.
+uint64_t AtomSpace::open_transaction(void)
+{
+    _open_transactions++;
+    return _stamp_clock.load();
+}
+
+void AtomSpace::close_transaction(void)
+{
+    _open_transactions--;
+}
+
+// ====================================================================
+// Change tracking.
+
+void AtomSpace::track_changes(bool on)
+{
+    std::lock_guard<std::mutex> lck(_changes_mtx);
+    _track_changes = on;
+    if (on) return;
+    _added_atoms.clear();
+    _removed_atoms.clear();
+    _changed_values.clear();
+}
+
+void AtomSpace::note_added(const Handle& h)
+{
+    std::lock_guard<std::mutex> lck(_changes_mtx);
+    _removed_atoms.erase(h);
+    _added_atoms.insert(h);
+}
+
+void AtomSpace::note_removed(const Handle& h)
+{
+    std::lock_guard<std::mutex> lck(_changes_mtx);
+    _added_atoms.erase(h);
+    _changed_values.erase(h);
+    _removed_atoms.insert(h);
+}
+
+void AtomSpace::log_value_change(const Handle& h, const Handle& key)
+{
+    std::lock_guard<std::mutex> lck(_changes_mtx);
+
+    // Storing an added Atom stores all of its Values, anyway.
+    if (_added_atoms.end() != _added_atoms.find(h)) return;
+    _changed_values[h].insert(key);
+}
+
+AtomSpace::Changes AtomSpace::take_changes(void)
+{
+    HandleSet added;
+    HandleSet removed;
+    std::unordered_map<Handle, HandleSet> values;
+    {
+        std::lock_guard<std::mutex> lck(_changes_mtx);
+        added.swap(_added_atoms);
+        removed.swap(_removed_atoms);
+        values.swap(_changed_values);
+    }
+
+    Changes ch;
+    ch.added.assign(added.begin(), added.end());
+    ch.removed.assign(removed.begin(), removed.end());
+    for (const auto& hk : values)
+        for (const Handle& key : hk.second)
+            ch.values.emplace_back(hk.first, key);
+    return ch;
+}
+
+void AtomSpace::clear_changes(void)
+{
+    std::lock_guard<std::mutex> lck(_changes_mtx);
+    _added_atoms.clear();
+    _removed_atoms.clear();
+    _changed_values.clear();
+}
+
+// ====================================================================
+// Content digests.
+
+void AtomSpace::track_digests(bool on)
+{
+    std::lock_guard<std::mutex> lck(_digests_mtx);
+    if (on == _track_digests) return;
+
+    if (not on)
+    {
+        _track_digests = false;
+        _digests->clear();
+        return;
+    }
+
+    // The tree is never freed once made, so that a thread that saw
+    // the flag just before it was turned off is not left holding
+    // a dangling pointer.
+    if (nullptr == _digests)
+        _digests.reset(new MerkleTree());
+    _digests->clear();
+    _track_digests = true;
+
+    HandleSeq hs;
+    get_handles_by_type(hs, ATOM, true, false);
+    for (const Handle& h : hs)
+        _digests->add(h);
+}
+
+const MerkleTree& AtomSpace::get_digests(void) const
+{
+    if (not _track_digests)
+        throw RuntimeException(TRACE_INFO,
+            "AtomSpace is not tracking digests!");
+    return *_digests;
+}
+
+// Atoms that are not in the index yet get all of their Values
+// digested when they land there.
+void AtomSpace::digest_value_change(const Handle& h)
+{
+    if (typeIndex.findAtom(h) != h) return;
+    _digests->changed(h);
+}
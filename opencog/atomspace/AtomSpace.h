@@ -25,7 +25,19 @@
 #ifndef _OPENCOG_ATOMSPACE_H
 #define _OPENCOG_ATOMSPACE_H
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 #include <opencog/util/async_method_caller.h>
+#include <opencog/util/concurrent_queue.h>
 #include <opencog/util/exceptions.h>
 #include <opencog/util/oc_omp.h>
 #include <opencog/util/RandGen.h>
@@ -35,6 +47,7 @@
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/truthvalue/TruthValue.h>
 
+#include <opencog/atomspace/MerkleTree.h>
 #include <opencog/atomspace/TypeIndex.h>
 
 class AtomTableUTest;
@@ -45,6 +58,7 @@ namespace opencog
  *  @{
  */
 typedef SigSlot<const Handle&> AtomSignal;
+typedef SigSlot<const HandleSeq&> AtomSeqSignal;
 typedef SigSlot<const Handle&,
                 const TruthValuePtr&,
                 const TruthValuePtr&> TVCHSigl;
@@ -60,6 +74,11 @@ typedef std::shared_ptr<AtomSpace> AtomSpacePtr;
  */
 class AtomSpace : public Atom
 {
+    friend class DefineLink;      // Needs to call set_definition()
+    friend class Transaction;     // Needs the overlay, and the stamps
+    friend class Snapshot;        // Needs the frames
+    friend class MemoryReport;    // Needs the TypeIndex
+
     // Debug tools
     static const bool EMIT_DIAGNOSTICS = true;
     static const bool DONT_EMIT_DIAGNOSTICS = false;
@@ -93,20 +112,150 @@ class AtomSpace : public Atom
     HandleSeq _outgoing;
     std::string _name;
 
-    /** Find out about atom type additions in the NameServer. */
+    /// The frame DAG below this space, flattened into a pre-order list,
+    /// so that lookups, `depth()` and `in_environ()` walk a vector,
+    /// instead of recursing. The first entry is this space itself.
+    /// `next` is the index just past the entries for the frames under
+    /// that one; an absent Atom in a frame hides those frames from the
+    /// lookup. Rebuilt whenever `_environ` changes.
+    struct EnvFrame
+    {
+        const AtomSpace* space;
+        int depth;
+        size_t next;
+    };
+    std::vector<EnvFrame> _frames;
+    void flatten_frames(void);
+
+    /// Values set in this space on Atoms that live in the bases; see
+    /// `set_value_overlay()`.
+    std::atomic<bool> _value_overlay;
+    mutable std::mutex _overlay_mtx;
+    std::unordered_map<Handle, std::map<Handle, ValuePtr>> _overlay;
+    bool overlays(const Handle&) const;
+    bool overlay_value(const Handle&, const Handle&, const ValuePtr&);
+    bool find_overlay(const Handle&, const Handle&, ValuePtr&) const;
+
+    /// The Atom on which to change Values for `h`: either `h`, or its
+    /// copy in this space. Throws if this space is read-only.
+    Handle writable(const Handle&, const char*);
+
+    /// The DefineLink in this space for each alias. Kept up to date
+    /// by DefineLink::install() and DefineLink::remove().
+    mutable std::shared_mutex _defs_mtx;
+    std::unordered_map<Handle, Handle> _definitions;
+    AtomSignal _definitionSignal;
+    static std::atomic<size_t> _definition_changes;
+    void set_definition(const Handle&, const Handle&);
+    void clear_definition(const Handle&, const Handle&);
+    Handle local_definition(const Handle&) const;
+
+    // The TypeIndex grows by itself, when Atoms of newly-declared
+    // types are added; there is no need to subscribe to the
+    // NameServer for type additions.
     NameServer& _nameserver;
-    int addedTypeConnection;
-    void typeAdded(Type);
 
     /** Provided signals */
     AtomSignal _addAtomSignal;
     AtomSignal _removeAtomSignal;
+    AtomSeqSignal _addAtomsSignal;
+    AtomSeqSignal _removeAtomsSignal;
 
     /** Signal emitted when the TV changes. */
     TVCHSigl _TVChangedSignal;
 
+    /// Asynchronous signal delivery; see set_async_signals().
+    struct SignalEvent
+    {
+        enum Kind { ADD, REMOVE, TV, FLUSH, STOP } kind;
+        Handle atom;
+        TruthValuePtr oldtv;
+        TruthValuePtr newtv;
+        std::shared_ptr<std::promise<void>> done;
+    };
+    std::atomic<bool> _async_signals;
+    std::atomic<size_t> _signal_writers;
+    concurrent_queue<SignalEvent> _signal_queue;
+    std::thread _dispatcher;
+    std::mutex _dispatcher_mtx;
+    void dispatch_loop(void);
+    bool deliver(std::deque<SignalEvent>&);
+    void stop_dispatcher(void);
+
+    /// Queue the event, if signals are asynchronous. Return false if
+    /// they are not; the caller then emits the signal itself. Writers
+    /// are counted, so that the dispatcher is not stopped while one
+    /// of them is still deciding which way to go.
+    bool queue_signal(SignalEvent&& ev)
+    {
+        if (not _async_signals.load(std::memory_order_relaxed))
+            return false;
+        _signal_writers++;
+        bool queued = _async_signals.load();
+        if (queued) _signal_queue.push(std::move(ev));
+        _signal_writers--;
+        return queued;
+    }
+
+    /// The change log; see track_changes().
+    std::atomic<bool> _track_changes;
+    std::mutex _changes_mtx;
+    HandleSet _added_atoms;
+    HandleSet _removed_atoms;
+    std::unordered_map<Handle, HandleSet> _changed_values;
+    void note_added(const Handle&);
+    void note_removed(const Handle&);
+    void log_value_change(const Handle&, const Handle&);
+
+    /// Content digests; see track_digests().
+    std::atomic<bool> _track_digests;
+    std::mutex _digests_mtx;
+    std::unique_ptr<MerkleTree> _digests;
+    void digest_value_change(const Handle&);
+
+    void emit_added(const Handle& h)
+    {
+        if (_track_changes.load(std::memory_order_relaxed))
+            note_added(h);
+        if (_track_digests.load(std::memory_order_acquire))
+            _digests->add(h);
+        if (not queue_signal(SignalEvent{SignalEvent::ADD, h,
+                                         nullptr, nullptr, nullptr}))
+            _addAtomSignal.emit(h);
+    }
+    void emit_removed(const Handle& h)
+    {
+        if (0 < _open_transactions.load())
+            stamp(h.get());
+        if (_track_changes.load(std::memory_order_relaxed))
+            note_removed(h);
+        if (_track_digests.load(std::memory_order_acquire))
+            _digests->remove(h);
+        if (not queue_signal(SignalEvent{SignalEvent::REMOVE, h,
+                                         nullptr, nullptr, nullptr}))
+            _removeAtomSignal.emit(h);
+    }
+
     void init();
     void clear_all_atoms();
+    bool extract_closure(const Handle&);
+
+    /// Version stamps, for transactions; see Transaction.h. While any
+    /// transaction is open, anywhere, every change to an Atom, that
+    /// is, a Value set on it or its removal, stamps it with the time
+    /// of the change. Stamps are kept in a fixed-size table, and
+    /// unrelated Atoms may share a slot; the only harm is an
+    /// occasional needless conflict. The count is read after the
+    /// change is made, so that a transaction that opens too late to be
+    /// counted is sure to see the change.
+    static std::atomic<size_t> _open_transactions;
+    static void stamp(const Atom*);
+    static uint64_t stamp_of(const Atom*);
+    static uint64_t open_transaction(void);
+    static void close_transaction(void);
+
+    // Commits of transactions on this space are made one at a time.
+    std::mutex _commit_mtx;
 
     /**
      * Private: add an atom to the table. This skips the read-only
@@ -116,11 +265,17 @@ class AtomSpace : public Atom
      * atomtable, even if it is already in a parent atomspace.
      */
     Handle add(const Handle&, bool force=false);
+    Handle prepare(const Handle&, bool force, bool& ready);
     Handle check(const Handle&, bool force=false);
 
     virtual ContentHash compute_hash() const;
 
-    // Private helper function.
+    // Private helper functions.
+    bool walk_by_type(Type type, bool subclass,
+                      const std::function<bool(const Handle&)>&,
+                      bool parent) const;
+    void collect_frames(std::vector<const AtomSpace*>&,
+                        std::unordered_set<const AtomSpace*>&) const;
     void shadow_by_type(HandleSet&,
                         Type type,
                         bool subclass,
@@ -180,6 +335,18 @@ public:
     void clear_copy_on_write(void) { _copy_on_write = false; }
     bool get_copy_on_write(void) const { return _copy_on_write; }
 
+    /// A value overlay is a lighter form of copy-on-write. When it is
+    /// set on a COW space, changing a Value on an Atom that lives in a
+    /// base space does not copy the Atom into this space. Instead, the
+    /// new Value is recorded in a per-space table, keyed by Atom and
+    /// key, and the base Atom is returned unchanged. Such Values are
+    /// visible only through `get_value()` and `get_truthvalue()` on
+    /// this space (or on spaces above it); `Atom::getValue()` on the
+    /// base Atom continues to return the base Value.
+    void set_value_overlay(void) { _value_overlay = true; }
+    void clear_value_overlay(void) { _value_overlay = false; }
+    bool get_value_overlay(void) const { return _value_overlay; }
+
     // -------------------------------------------------------
 
     /**
@@ -224,6 +391,20 @@ public:
     bool operator==(const AtomSpace& other) const;
     bool operator!=(const AtomSpace& other) const;
 
+    /**
+     * Find the Atoms in which two AtomSpaces differ: those in the
+     * first that are not in the second, or that have other Values
+     * there, and the same, the other way around. Only the Atoms in
+     * the two frames themselves are compared; not those in frames
+     * below them. Both must be tracking digests; the work done is in
+     * proportion to the number of differences, and not to the size
+     * of the AtomSpaces. See `track_digests()`.
+     */
+    static void diff_atomspaces(const AtomSpace& first,
+                                const AtomSpace& second,
+                                HandleSeq& in_first,
+                                HandleSeq& in_second);
+
     /**
      * Perform a content-based comparison of two AtomSpaces.
      * Wrapper around above.
@@ -348,12 +529,41 @@ public:
      */
     ValuePtr add_atoms(const ValuePtr&);
 
+    /**
+     * Add a batch of Atoms to the AtomSpace. This is faster than
+     * adding them one at a time: the batch is sorted by type, and
+     * the index locks are taken once per run of same-typed Atoms.
+     * Duplicates within the batch are added only once.
+     *
+     * Returns the added Atoms, in the same order as the argument.
+     * Newly-added Atoms are reported with a single emission of the
+     * atomsAddedSignal(), and NOT by the atomAddedSignal(). The
+     * exception are Atoms held by a Link in the batch, that are not
+     * yet in the AtomSpace when that Link is added. They are added
+     * as by add_atom(), and so are reported by the atomAddedSignal().
+     * These are the Atoms that are not in the batch themselves, and
+     * possibly some that are in it, with the same type as the Link
+     * that holds them.
+     */
+    HandleSeq add_atoms(HandleSeq&&);
+    HandleSeq add_atoms(const HandleSeq& hseq)
+    { return add_atoms(HandleSeq(hseq)); }
+
     /**
      * Get an atom from the AtomSpace. If the atom is not there, then
      * return Handle::UNDEFINED.
      */
     Handle get_atom(const Handle&) const;
 
+    /**
+     * Return the DefineLink for the alias that is visible from this
+     * AtomSpace: the one in the shallowest space in which the alias
+     * is defined. Returns Handle::UNDEFINED if there is none, or if
+     * it has been hidden. Unlike searching the incoming set of the
+     * alias, this is a hash lookup for each space.
+     */
+    Handle get_definition(const Handle& alias) const;
+
     /**
      * Extract an atom from the atomspace.  This only removes the atom
      * from the (local, in-RAM) AtomSpace (in this process); any copies
@@ -377,6 +587,16 @@ public:
      *       cascade of removals!  If the flag is not set, then the
      *       atom will be removed only if its incoming set is empty.
      *       By default, recursion is disabled.
+     *
+     * A recursive extraction first finds everything that is to go,
+     * walking the incoming sets a level at a time, in parallel, for
+     * wide levels; it then removes all of it from the indexes at
+     * once. Atoms removed from this AtomSpace in this way are
+     * reported one at a time by the atomRemovedSignal(), top-down,
+     * and then all together, with a single emission of the
+     * atomsRemovedSignal(). Both are sent before the Atoms are
+     * unlinked from the incoming sets of their outgoing Atoms.
+     *
      * @return True if the Atom for the given Handle was successfully
      *         removed. False, otherwise.
      */
@@ -399,6 +619,25 @@ public:
     Handle set_value(const Handle&, const Handle& key, const ValuePtr& value);
     Handle set_truthvalue(const Handle&, const TruthValuePtr&);
 
+    /**
+     * Add `delta` to entry `ref` of the FloatValue at `key`, or to the
+     * count of the TruthValue, with the same permission checking, and
+     * copy-on-write, as `set_value()`. The read and the write are one
+     * step: concurrent increments are never lost. This is the way to
+     * count things. See `Atom::incrementCount()`.
+     */
+    Handle increment_count(const Handle&, const Handle& key,
+                           size_t ref, double delta);
+    Handle increment_countTV(const Handle&, double delta);
+
+    /**
+     * Get the Value on the atom, as seen from this AtomSpace. This
+     * differs from `Atom::getValue()` only when some space in the
+     * environment holds a value overlay; see `set_value_overlay()`.
+     */
+    ValuePtr get_value(const Handle&, const Handle& key) const;
+    TruthValuePtr get_truthvalue(const Handle&) const;
+
     /**
      * Find an equivalent Atom that is exactly the same as the arg.
      * If such an atom is in the AtomSpace, or in any of it's parent
@@ -492,6 +731,25 @@ public:
                         bool parent=true,
                         const AtomSpace* = nullptr) const;
 
+    /**
+     * Call the callback on each Atom of the given type (and subtypes,
+     * if `subclass` is set). Unlike get_handles_by_type(), this does
+     * not copy all of the Atoms into a container: they are handed to
+     * the callback a chunk at a time, without holding any locks. For
+     * copy-on-write spaces, shadowing is resolved during iteration,
+     * so that only the shallowest version of each Atom is visited.
+     * StateLinks, DefineLinks and TypedAtomLinks are resolved to the
+     * state visible in this AtomSpace, and each is visited once, even
+     * if deeper frames hold other states for the same alias.
+     *
+     * The callback should return true to halt the iteration; this
+     * method returns true if the iteration was halted. Atoms added or
+     * removed during the iteration may or may not be visited.
+     */
+    bool foreach_handle_by_type(Type type, bool subclass,
+                                const std::function<bool(const Handle&)>&,
+                                bool parent=true) const;
+
     /**
      * Gets a set of handles that matches with the given type,
      * but ONLY if they have an empty incoming set! 
@@ -524,10 +782,132 @@ public:
 
     AtomSignal& atomAddedSignal() { return _addAtomSignal; }
     AtomSignal& atomRemovedSignal() { return _removeAtomSignal; }
+    AtomSeqSignal& atomsAddedSignal() { return _addAtomsSignal; }
+    AtomSeqSignal& atomsRemovedSignal() { return _removeAtomsSignal; }
+
+    /**
+     * Emitted with the alias, whenever a DefineLink is added to, or
+     * removed from, this AtomSpace. It is sent in the thread that
+     * made the change, even if other signals are asynchronous, so
+     * that caches of expanded definitions can be dropped at once.
+     */
+    AtomSignal& definitionChangedSignal() { return _definitionSignal; }
+
+    /// A count of the changes to definitions, in all AtomSpaces. If
+    /// it has not moved, then no definition has changed anywhere.
+    static size_t definition_changes(void) { return _definition_changes; }
 
     /** Provide ability for others to find out about TV changes */
     TVCHSigl& TVChangedSignal() { return _TVChangedSignal; }
 
+    /**
+     * Emit the TV-changed signal, or queue it, if signals are being
+     * delivered asynchronously. This is inline, because it is called
+     * from Atom.cc; see the note on `in_environ()`.
+     */
+    void emit_tv_changed(const Handle& h,
+                         const TruthValuePtr& oldtv,
+                         const TruthValuePtr& newtv)
+    {
+        if (not queue_signal(SignalEvent{SignalEvent::TV, h,
+                                         oldtv, newtv, nullptr}))
+            _TVChangedSignal.emit(h, oldtv, newtv);
+    }
+
+    /**
+     * Deliver the atom-added, atom-removed and TV-changed signals
+     * from a dispatcher thread, instead of from the thread that made
+     * the change. Writers then only pay for queueing the event, no
+     * matter how many subscribers there are, or how slow they are.
+     *
+     * Each time the dispatcher wakes up, it takes everything that is
+     * queued, and coalesces it by Atom: an Atom added (or removed)
+     * again, with nothing in between, is reported only once; adds and
+     * removes that alternate are all reported, in order, so that the
+     * last one matches whether the Atom is in the AtomSpace. A run of
+     * TV changes on one Atom is reported as a single change, from the
+     * first old TV to the last new TV. After the per-Atom signals,
+     * the Atoms that the batch left added are also reported on
+     * `atomsAddedSignal()`, and those it left removed on
+     * `atomsRemovedSignal()`; each of these appears in just one.
+     *
+     * Exceptions thrown by subscribers are logged, and do not reach
+     * the writer. Turning this off delivers whatever is still queued.
+     */
+    void set_async_signals(bool);
+    bool get_async_signals(void) const { return _async_signals; }
+
+    /// Block until every signal queued so far has been delivered.
+    /// Does nothing if signals are synchronous.
+    void flush_signals(void);
+
+    /* ----------------------------------------------------------- */
+    // ---- Change tracking
+
+    /**
+     * Keep a log of what changed in this AtomSpace: the Atoms added,
+     * the Atoms removed, and the (Atom, key) pairs whose Values were
+     * set. The log holds each of these once, no matter how often it
+     * changed; an Atom that is removed is dropped from the added and
+     * changed-value sets. This is what `StorageNode::sync()` uses to
+     * write out only what is new since the last time.
+     *
+     * Atoms fetched from storage are added Atoms, like any other; call
+     * `clear_changes()` after a bulk load, if they should not be
+     * written back. Values placed in a value overlay (see
+     * `set_value_overlay()`) are not logged, and neither is `clear()`.
+     */
+    void track_changes(bool);
+    bool tracking_changes(void) const { return _track_changes; }
+
+    struct Changes
+    {
+        HandleSeq added;
+        HandleSeq removed;
+        std::vector<std::pair<Handle, Handle>> values;
+    };
+
+    /// Return everything logged so far, and empty the log.
+    Changes take_changes(void);
+    void clear_changes(void);
+
+    /// Called from Atom.cc, whenever a Value is set on an Atom in this
+    /// AtomSpace. Inline, for the same reason as `emit_tv_changed()`.
+    void note_value_change(const Handle& h, const Handle& key)
+    {
+        if (0 < _open_transactions.load())
+            stamp(h.get());
+        if (_track_changes.load(std::memory_order_relaxed))
+            log_value_change(h, key);
+        if (_track_digests.load(std::memory_order_acquire))
+            digest_value_change(h);
+    }
+
+    /* ----------------------------------------------------------- */
+    // ---- Content digests
+
+    /**
+     * Keep a Merkle tree of digests of the Atoms in this frame of the
+     * AtomSpace, and of their Values, up to date as they change (see
+     * MerkleTree.h). Two AtomSpaces that both do this can be compared
+     * for equality by comparing two numbers, and can find the Atoms
+     * in which they differ by exchanging a few digests per difference
+     * (see `diff_atomspaces()`). A remote peer can walk the tree
+     * through the `cog-merkle-digests` and `cog-merkle-atoms` network
+     * commands.
+     *
+     * Turning this on digests everything already here; it should be
+     * done before other threads start changing the AtomSpace, as
+     * changes made while that runs may be counted twice, or missed.
+     * After that, every Atom added or removed, and every Value set,
+     * costs a few more hashes and sums. `clear()` empties the tree.
+     */
+    void track_digests(bool);
+    bool tracking_digests(void) const { return _track_digests; }
+
+    /// The tree; throws if digests are not being tracked.
+    const MerkleTree& get_digests(void) const;
+
     // Not for public use! Only StorageNodes get to call this!
     Handle storage_add_nocheck(const Handle& h) { return add(h); }
 };
@@ -27,8 +27,12 @@
  */
 
 #include "AtomSpace.h"
+#include "Snapshot.h"
 
+#include <algorithm>
 #include <atomic>
+#include <numeric>
+#include <unordered_set>
 
 #include <stdlib.h>
 
@@ -38,6 +42,7 @@
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/StateLink.h>
 #include <opencog/atoms/core/TypedAtomLink.h>
+#include <opencog/atoms/parallel/ThreadPool.h>
 #include <opencog/util/exceptions.h>
 #include <opencog/util/Logger.h>
 #include <opencog/util/oc_assert.h>
@@ -74,10 +79,27 @@ void AtomSpace::init(void)
 
     _name = "(uuid . " + std::to_string(_uuid) + ")";
 
-    // Connect signal to find out about type additions
-    addedTypeConnection =
-        _nameserver.typeAddedSignal().connect(
-            std::bind(&AtomSpace::typeAdded, this, std::placeholders::_1));
+    flatten_frames();
+}
+
+/// Rebuild the flattened frame list, from the (already flattened)
+/// lists of the bases. The bases of any space that is itself layered
+/// on top of something are about to be searched on lookup misses;
+/// give them a content-hash filter, so that misses are cheap.
+void AtomSpace::flatten_frames(void)
+{
+    _frames.clear();
+    _frames.push_back({this, 0, 0});
+    for (const AtomSpacePtr& base : _environ)
+    {
+        size_t off = _frames.size();
+        for (const EnvFrame& f : base->_frames)
+            _frames.push_back({f.space, f.depth + 1, f.next + off});
+
+        if (0 < base->_environ.size())
+            base->typeIndex.enable_filter();
+    }
+    _frames[0].next = _frames.size();
 }
 
 /**
@@ -89,7 +111,12 @@ AtomSpace::AtomSpace(AtomSpace* parent, bool transient) :
     _read_only(false),
     _copy_on_write(transient),
     _transient(transient),
-    _nameserver(nameserver())
+    _nameserver(nameserver()),
+    _value_overlay(false),
+    _async_signals(false),
+    _signal_writers(0),
+    _track_changes(false),
+    _track_digests(false)
 {
     if (parent) {
         // Set the COW flag by default, for any Atomspace that sits on
@@ -107,7 +134,12 @@ AtomSpace::AtomSpace(AtomSpacePtr& parent) :
     _read_only(false),
     _copy_on_write(false),
     _transient(false),
-    _nameserver(nameserver())
+    _nameserver(nameserver()),
+    _value_overlay(false),
+    _async_signals(false),
+    _signal_writers(0),
+    _track_changes(false),
+    _track_digests(false)
 {
     if (nullptr != parent) {
         // Set the COW flag by default; it seems like a simpler
@@ -125,7 +157,12 @@ AtomSpace::AtomSpace(const HandleSeq& bases) :
     _read_only(false),
     _copy_on_write(false),
     _transient(false),
-    _nameserver(nameserver())
+    _nameserver(nameserver()),
+    _value_overlay(false),
+    _async_signals(false),
+    _signal_writers(0),
+    _track_changes(false),
+    _track_digests(false)
 {
     _outgoing = bases;
     for (const Handle& base : bases)
@@ -143,7 +180,7 @@ AtomSpace::AtomSpace(const HandleSeq& bases) :
 
 AtomSpace::~AtomSpace()
 {
-    _nameserver.typeAddedSignal().disconnect(addedTypeConnection);
+    stop_dispatcher();
     clear_all_atoms();
 }
 
@@ -158,6 +195,7 @@ void AtomSpace::ready_transient(AtomSpace* parent)
     // Set the new parent environment and holder atomspace.
     _environ.push_back(AtomSpaceCast(parent));
     _outgoing.push_back(HandleCast(parent));
+    flatten_frames();
 }
 
 void AtomSpace::clear_transient()
@@ -172,11 +210,22 @@ void AtomSpace::clear_transient()
     // Clear the  parent environment and holder atomspace.
     _environ.clear();
     _outgoing.clear();
+    flatten_frames();
 }
 
 void AtomSpace::clear_all_atoms()
 {
     typeIndex.clear();
+    if (_track_digests) _digests->clear();
+
+    {
+        std::unique_lock<std::shared_mutex> lck(_defs_mtx);
+        if (not _definitions.empty()) _definition_changes++;
+        _definitions.clear();
+    }
+
+    std::lock_guard<std::mutex> lck(_overlay_mtx);
+    _overlay.clear();
 }
 
 void AtomSpace::clear()
@@ -186,18 +235,20 @@ void AtomSpace::clear()
 
 /// Find an equivalent atom that is exactly the same as the arg. If
 /// such an atom is in the table, it is returned, else return nullptr.
+/// The frames are searched in the same order as a depth-first walk of
+/// `_environ` would search them; an absent Atom hides the frames under
+/// the frame that holds it, but not those in sibling branches.
 Handle AtomSpace::lookupHandle(const Handle& a) const
 {
-    const Handle& h(typeIndex.findAtom(a));
-    if (h) {
-        if (h->isAbsent()) return Handle::UNDEFINED;
-        return h;
-    }
-
-    for (const AtomSpacePtr& base: _environ)
+    size_t i = 0;
+    size_t nframes = _frames.size();
+    while (i < nframes)
     {
-        const Handle& found = base->lookupHandle(a);
-        if (found) return found;
+        const EnvFrame& f(_frames[i]);
+        const Handle& h(f.space->typeIndex.findAtom(a));
+        if (nullptr == h) { i++; continue; }
+        if (not h->isAbsent()) return h;
+        i = f.next;
     }
 
     return Handle::UNDEFINED;
@@ -265,6 +316,38 @@ Handle AtomSpace::check(const Handle& orig, bool force)
 
 Handle AtomSpace::add(const Handle& orig, bool force)
 {
+    bool ready = false;
+    Handle atom(prepare(orig, force, ready));
+    if (not ready) return atom;
+
+    // Between the time that we last checked, and here, some other thread
+    // may have raced and inserted this atom already. So the insert does
+    // have to be an atomic test-n-set.
+    Handle oldh;
+    {
+        Snapshot::Gate gate;
+        bool noted = Snapshot::note_added(atom);
+        oldh = typeIndex.insertAtom(atom);
+        if (oldh and noted) Snapshot::unnote_added(atom);
+    }
+    if (oldh) return oldh;
+
+    // Now that we are completely done, emit the added signal.
+    // Don't emit signal until after the indexes are updated!
+    emit_added(atom);
+
+    return atom;
+}
+
+/// Private helper for add(): do everything needed to add an Atom,
+/// except for inserting it into the typeIndex. If the Atom is already
+/// present (or cannot be added), then that is returned, and `ready` is
+/// left false. Otherwise, `ready` is set to true, and the returned Atom
+/// is fully set up, and must be handed to the typeIndex by the caller.
+Handle AtomSpace::prepare(const Handle& orig, bool force, bool& ready)
+{
+    ready = false;
+
     // Can be null, if its a Value
     if (nullptr == orig) return Handle::UNDEFINED;
 
@@ -310,7 +393,12 @@ Handle AtomSpace::add(const Handle& orig, bool force)
                 if (nullptr == h.operator->()) return Handle::UNDEFINED;
                 closet.emplace_back(add(h, false));
             }
-            atom = createLink(std::move(closet), atom->get_type());
+            // The copy has the same outgoing types, and so it passes
+            // the checks that the original did.
+            if (atom->isValidated())
+                atom = createTrustedLink(std::move(closet), atom->get_type());
+            else
+                atom = createLink(std::move(closet), atom->get_type());
         } else {
             atom->unsetRemovalFlag();
         }
@@ -341,17 +429,146 @@ Handle AtomSpace::add(const Handle& orig, bool force)
     // as the atom is being deleted.
     atom->install();
 
-    // Between the time that we last checked, and here, some other thread
-    // may have raced and inserted this atom already. So the insert does
-    // have to be an atomic test-n-set.
-    const Handle& oldh(typeIndex.insertAtom(atom));
-    if (oldh) return oldh;
+    ready = true;
+    return atom;
+}
 
-    // Now that we are completely done, emit the added signal.
-    // Don't emit signal until after the indexes are updated!
-    _addAtomSignal.emit(atom);
+/// Add a batch of Atoms. The batch is sorted by type, so that Atoms
+/// landing in the same typeIndex bucket are inserted together, with
+/// the bucket lock taken once per run, instead of once per Atom.
+/// Duplicates within the batch are added only once. The result is
+/// in the same order as the argument; Atoms that could not be added
+/// are returned as Handle::UNDEFINED.
+HandleSeq AtomSpace::add_atoms(HandleSeq&& hseq)
+{
+    size_t sz = hseq.size();
+    HandleSeq result(sz);
 
-    return atom;
+    if (_read_only) {
+        for (size_t i = 0; i < sz; i++)
+            result[i] = get_atom(hseq[i]);
+        return result;
+    }
+
+    // Hash the whole batch up front; the sort below needs them all.
+    Link::compute_hashes(hseq);
+
+    // Sort by type, then by hash. Content-equal Atoms will then be
+    // adjacent to one-another.
+    std::vector<size_t> order(sz);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+        [&](size_t a, size_t b) -> bool {
+            const Handle& ha(hseq[a]);
+            const Handle& hb(hseq[b]);
+            if (nullptr == ha or nullptr == hb) return nullptr == ha and hb;
+            if (ha->get_type() != hb->get_type())
+                return ha->get_type() < hb->get_type();
+            return ha->get_hash() < hb->get_hash();
+        });
+
+    // Atoms that have been prepared, but are not yet in the typeIndex.
+    HandleSeq pending;
+    std::vector<size_t> pending_idx;
+    std::unordered_set<const Atom*> pending_set;
+
+    HandleSeq added;
+    auto flush = [&](void)
+    {
+        HandleSeq olds;
+        {
+            Snapshot::Gate gate;
+            bool noted = false;
+            for (const Handle& atom : pending)
+                noted |= Snapshot::note_added(atom);
+            olds = typeIndex.insertAtoms(pending);
+            if (noted)
+                for (size_t j = 0; j < pending.size(); j++)
+                    if (olds[j]) Snapshot::unnote_added(pending[j]);
+        }
+        for (size_t j = 0; j < pending.size(); j++)
+        {
+            const Handle& atom(pending[j]);
+            if (olds[j]) {
+                // Lost a race with some other thread. Undo the
+                // incoming-set install performed by prepare().
+                atom->remove();
+                atom->setAtomSpace(nullptr);
+                result[pending_idx[j]] = olds[j];
+                continue;
+            }
+            result[pending_idx[j]] = atom;
+            added.push_back(atom);
+        }
+        pending.clear();
+        pending_idx.clear();
+        pending_set.clear();
+    };
+
+    std::equal_to<Handle> content_eq;
+    std::vector<std::pair<size_t, size_t>> dups;
+    size_t prev = sz;
+    for (size_t i : order)
+    {
+        const Handle& h(hseq[i]);
+        if (nullptr == h) continue;
+
+        if (prev < sz and content_eq(hseq[prev], h)) {
+            dups.push_back({i, prev});
+            continue;
+        }
+
+        // Start a new run on every change of type. Also, a Link that
+        // holds a pending Atom must wait until that Atom is visible.
+        if (prev < sz and hseq[prev]->get_type() != h->get_type())
+            flush();
+        else if (h->is_link())
+        {
+            for (const Handle& ho : h->getOutgoingSet())
+                if (pending_set.find(ho.get()) != pending_set.end())
+                    { flush(); break; }
+        }
+        prev = i;
+
+        bool ready = false;
+        Handle atom;
+        try {
+            atom = prepare(h, false, ready);
+        }
+        catch (const DeleteException& ex) {
+            continue;
+        }
+
+        if (not ready) {
+            result[i] = atom;
+            continue;
+        }
+        pending.push_back(atom);
+        pending_idx.push_back(i);
+        pending_set.insert(atom.get());
+    }
+    flush();
+
+    for (const auto& pr : dups)
+        result[pr.first] = result[pr.second];
+
+    // The async branch below passes through emit_added(), which
+    // logs them; the batch signal does not. The flag is read once,
+    // as it may be flipped meanwhile.
+    bool async = _async_signals;
+    if (_track_changes and not async)
+        for (const Handle& h : added) note_added(h);
+    if (_track_digests and not async)
+        for (const Handle& h : added) _digests->add(h);
+
+    // One signal for the whole batch. The async dispatcher makes up
+    // its own batches.
+    if (async)
+        for (const Handle& h : added) emit_added(h);
+    else if (0 < added.size())
+        _addAtomsSignal.emit(added);
+
+    return result;
 }
 
 void AtomSpace::barrier()
@@ -437,32 +654,9 @@ bool AtomSpace::extract_atom(const Handle& h, bool recursive)
     }
 
     // If recursive-flag is set, also extract all the links in the atom's
-    // incoming set
-    if (recursive) {
-
-        HandleSeq is(handle->getIncomingSet());
-        for (const Handle& his : is)
-        {
-            AtomSpace* other = his->getAtomSpace();
-
-            // Something is seriously screwed up if the incoming set
-            // is not in this atomspace, and its not a child of this
-            // atomspace.
-            OC_ASSERT(nullptr == other or other == this or
-                      other->in_environ(handle),
-                "AtomSpace::extract() internal error, non-DAG membership.");
-
-            if (not his->isMarkedForRemoval()) {
-                if (other) {
-                    if (other != this) {
-                        other->extract_atom(his, true);
-                    } else {
-                        extract_atom(his, true);
-                    }
-                }
-            }
-        }
-    }
+    // incoming set, all at once.
+    if (recursive)
+        return extract_closure(handle);
 
     // This check avoids a race condition with the add() method.
     // The add() method installs the atom into the incoming set,
@@ -483,7 +677,14 @@ bool AtomSpace::extract_atom(const Handle& h, bool recursive)
     // it's added to the type index, exposing a window where it
     // briefly has broken incoming set.
     //
-    if (not typeIndex.removeAtom(handle)) {
+    bool gone;
+    {
+        Snapshot::Gate gate;
+        bool noted = Snapshot::note_removed(handle);
+        gone = typeIndex.removeAtom(handle);
+        if (noted and not gone) Snapshot::unnote_removed(handle);
+    }
+    if (not gone) {
         handle->unsetRemovalFlag();
         return false;
     }
@@ -493,7 +694,7 @@ bool AtomSpace::extract_atom(const Handle& h, bool recursive)
     // above, this does not seem to be possible. Well, we could send
     // it, but there would be spurious deliveies when racing.  This
     // should still be OK, the owning atomspace is still not blanked!
-    _removeAtomSignal.emit(handle);
+    emit_removed(handle);
 
     // Remove handle from other incoming sets.
     handle->remove();
@@ -502,10 +703,133 @@ bool AtomSpace::extract_atom(const Handle& h, bool recursive)
     return true;
 }
 
-/// This is the resize callback, when a new type is dynamically added.
-void AtomSpace::typeAdded(Type t)
+// Levels of the walk in extract_closure() with fewer than four chunks
+// of this many Atoms are walked in the calling thread.
+#define EXTRACT_CHUNK 1024
+
+/// Extract the given Atom, already marked for removal, together with
+/// everything above it. Rather than removing them one at a time, the
+/// whole of the incoming closure is found first, then removed from the
+/// TypeIndex in one go, and reported with one more signal.
+bool AtomSpace::extract_closure(const Handle& handle)
 {
-    typeIndex.resize();
+    HandleSeq closure;
+    HandleSeq level({handle});
+    HandleSeq foreign;
+    std::mutex mtx;
+
+    // Look at the incoming set of `h`. The removal mark is what keeps
+    // an Atom from being visited twice: whoever sets it, owns it.
+    auto visit = [&](const Handle& h, HandleSeq& next, HandleSeq& away)
+    {
+        for (const Handle& his : h->getIncomingSet())
+        {
+            AtomSpace* other = his->getAtomSpace();
+
+            // Something is seriously screwed up if the incoming set
+            // is not in this atomspace, and its not a child of this
+            // atomspace.
+            OC_ASSERT(nullptr == other or other == this or
+                      other->in_environ(h),
+                "AtomSpace::extract() internal error, non-DAG membership.");
+
+            if (nullptr == other) continue;
+            if (other != this)
+                away.push_back(his);
+            else if (not his->markForRemoval())
+                next.push_back(his);
+        }
+    };
+
+    // Walk up, a level at a time; wide levels are split into chunks,
+    // that are walked in parallel.
+    while (0 < level.size())
+    {
+        HandleSeq next;
+        size_t sz = level.size();
+        if (sz < 4 * EXTRACT_CHUNK)
+        {
+            for (const Handle& h : level)
+                visit(h, next, foreign);
+        }
+        else
+        {
+            size_t nchunks = (sz + EXTRACT_CHUNK - 1) / EXTRACT_CHUNK;
+            thread_pool().parallel_for(nchunks, [&](size_t c)
+            {
+                HandleSeq mine, away;
+                size_t end = std::min(sz, (c+1) * EXTRACT_CHUNK);
+                for (size_t i = c * EXTRACT_CHUNK; i < end; i++)
+                    visit(level[i], mine, away);
+
+                std::lock_guard<std::mutex> lck(mtx);
+                next.insert(next.end(), mine.begin(), mine.end());
+                foreign.insert(foreign.end(), away.begin(), away.end());
+            });
+        }
+        closure.insert(closure.end(), level.begin(), level.end());
+        level.swap(next);
+    }
+
+    // Atoms in the child spaces that hold our Atoms go first; they are
+    // the business of those spaces. An Atom may have been found more
+    // than once; the second time, it is already marked.
+    for (const Handle& his : foreign)
+        if (not his->isMarkedForRemoval())
+            his->getAtomSpace()->extract_atom(his, true);
+
+    // From the top down, as a one-at-a-time recursive removal would.
+    std::reverse(closure.begin(), closure.end());
+
+    // Those not found in the TypeIndex are racing with an add(); see
+    // the comment in extract_atom(). They are left alone.
+    HandleSeq removed;
+    bool noted = false;
+    {
+        Snapshot::Gate gate;
+        for (const Handle& h : closure)
+            noted |= Snapshot::note_removed(h);
+        removed = typeIndex.removeAtoms(closure);
+    }
+    if (removed.size() < closure.size())
+    {
+        UnorderedHandleSet gone(removed.begin(), removed.end());
+        for (const Handle& h : closure)
+        {
+            if (gone.end() != gone.find(h)) continue;
+            h->unsetRemovalFlag();
+            if (noted) Snapshot::unnote_removed(h);
+        }
+    }
+
+    // The async branch below passes through emit_removed(), which
+    // stamps and logs them; the batch signal does not.
+    bool async = _async_signals;
+    if (0 < _open_transactions.load() and not async)
+        for (const Handle& h : removed) stamp(h.get());
+    if (_track_changes and not async)
+        for (const Handle& h : removed) note_removed(h);
+    if (_track_digests and not async)
+        for (const Handle& h : removed) _digests->remove(h);
+
+    // The per-Atom signal, as for any other removal, and then one
+    // signal for the whole of it, sent while the Atoms are still
+    // linked into the incoming sets of the Atoms that they hold.
+    if (async)
+        for (const Handle& h : removed) emit_removed(h);
+    else if (0 < removed.size())
+    {
+        for (const Handle& h : removed) _removeAtomSignal.emit(h);
+        _removeAtomsSignal.emit(removed);
+    }
+
+    for (const Handle& h : removed)
+    {
+        h->remove();
+        h->setAtomSpace(nullptr);
+    }
+
+    return 0 < removed.size() and removed.back() == handle;
 }
 
 /**
@@ -579,6 +903,89 @@ void AtomSpace::get_handles_by_type(HandleSeq& hseq,
     }
 }
 
+bool AtomSpace::foreach_handle_by_type(Type type, bool subclass,
+                       const std::function<bool(const Handle&)>& cb,
+                       bool parent) const
+{
+    // UniqueLinks must be resolved to the state visible here; see
+    // get_handles_by_type() for the explanation. The states of one
+    // alias, in several frames, all resolve to the same Link; it is
+    // handed over only once. Only the resolved Links are remembered,
+    // one per alias.
+    std::function<Handle(const Handle&)> resolve;
+    if (STATE_LINK == type)
+        resolve = [&](const Handle& h) -> Handle
+            { return StateLinkCast(h)->get_link(this); };
+    else if (DEFINE_LINK == type)
+        resolve = [&](const Handle& h) -> Handle
+            { return DefineLink::get_link(
+                       UniqueLinkCast(h)->get_alias(), this); };
+    else if (TYPED_ATOM_LINK == type)
+        resolve = [&](const Handle& h) -> Handle
+            { return TypedAtomLink::get_link(
+                       UniqueLinkCast(h)->get_alias(), this); };
+    else
+        return walk_by_type(type, subclass, cb, parent);
+
+    HandleSet done;
+    return walk_by_type(type, subclass,
+        [&](const Handle& h) -> bool {
+            Handle link(resolve(h));
+            if (not done.insert(link).second) return false;
+            return cb(link);
+        }, parent);
+}
+
+bool AtomSpace::walk_by_type(Type type, bool subclass,
+                       const std::function<bool(const Handle&)>& cb,
+                       bool parent) const
+{
+    if (not _copy_on_write)
+    {
+        if (typeIndex.foreach_handle_by_type(type, subclass, cb))
+            return true;
+
+        if (not parent) return false;
+        for (const AtomSpacePtr& base : _environ)
+            if (base->walk_by_type(type, subclass, cb, parent))
+                return true;
+        return false;
+    }
+
+    // Copy-on-write spaces: visit each frame exactly once, and, in
+    // each frame, only those Atoms that are not shadowed (or hidden)
+    // by some shallower frame. An Atom is the shallowest version of
+    // itself exactly when lookupHandle() finds it, so no set of
+    // already-seen Atoms needs to be kept.
+    std::vector<const AtomSpace*> frames;
+    std::unordered_set<const AtomSpace*> seen;
+    if (parent)
+        collect_frames(frames, seen);
+    else
+        frames.push_back(this);
+
+    for (const AtomSpace* frame : frames)
+    {
+        bool halt = frame->typeIndex.foreach_handle_by_type(type, subclass,
+            [&](const Handle& h) -> bool {
+                if (lookupHandle(h) != h) return false;
+                return cb(h);
+            });
+        if (halt) return true;
+    }
+    return false;
+}
+
+// Collect this frame and all the frames below it, each exactly once.
+void AtomSpace::collect_frames(std::vector<const AtomSpace*>& frames,
+                               std::unordered_set<const AtomSpace*>& seen) const
+{
+    if (not seen.insert(this).second) return;
+    frames.push_back(this);
+    for (const AtomSpacePtr& base : _environ)
+        base->collect_frames(frames, seen);
+}
+
 // Same as above, but works with an unordered set, instead of a vector.
 // By working with a set instead of a sequence, there will not be any
 // duplicate atoms due to shadowing of child spaces by parent spaces.
@@ -0,0 +1,198 @@
+/*
+ * opencog/atomspace/MemoryReport.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/LinkValue.h>
+#include <opencog/atoms/value/StringValue.h>
+
+#include "AtomSpace.h"
+#include "MemoryReport.h"
+
+using namespace opencog;
+
+// The control block that make_shared puts in front of each object:
+// the vtable pointer, and the two counts.
+#define SHARED_BLOCK 16
+
+// A node of a std::map or std::set: the colour, and three pointers.
+#define RB_NODE 32
+
+// Heap bytes of a string; short ones fit inside the string itself.
+static size_t string_bytes(const std::string& s)
+{
+	if (s.capacity() < sizeof(std::string)) return 0;
+	return s.capacity() + 1;
+}
+
+size_t MemoryReport::value_bytes(const ValuePtr& vp)
+{
+	if (nullptr == vp or vp->is_atom()) return 0;
+
+	size_t bytes = SHARED_BLOCK;
+	Type t = vp->get_type();
+	NameServer& ns(nameserver());
+	if (ns.isA(t, FLOAT_VALUE))
+	{
+		// size() does not sample streams; this is what is stored.
+		const FloatValue* fv = (const FloatValue*) vp.get();
+		bytes += sizeof(FloatValue) + fv->size() * sizeof(double);
+	}
+	else if (ns.isA(t, STRING_VALUE))
+	{
+		bytes += sizeof(StringValue);
+		for (const std::string& s : StringValueCast(vp)->value())
+			bytes += sizeof(std::string) + string_bytes(s);
+	}
+	else if (ns.isA(t, LINK_VALUE))
+	{
+		const LinkValue* lv = (const LinkValue*) vp.get();
+		bytes += sizeof(LinkValue) + lv->size() * sizeof(ValuePtr);
+	}
+	else
+		bytes += sizeof(Value);
+
+	// Split between everyone holding it; the caller holds a reference
+	// too, but one that it borrowed from the Atom.
+	long uses = vp.use_count();
+	if (1 < uses) bytes /= uses;
+	return bytes;
+}
+
+void MemoryReport::measure(const Handle& h, TypeMemory& tm)
+{
+	tm.count++;
+	if (h->is_node())
+	{
+		tm.atoms += SHARED_BLOCK + sizeof(Node);
+		tm.names += string_bytes(h->get_name());
+	}
+	else
+	{
+		tm.atoms += SHARED_BLOCK + sizeof(Link);
+		tm.outgoing += h->getOutgoingSet().capacity() * sizeof(Handle);
+	}
+
+	std::shared_lock<AtomMutex> lck(h->_mtx());
+
+	tm.payloads += value_bytes(h->_truth_value);
+	tm.values += h->_values.bytes();
+	h->_values.foreach_value([&](const Handle& key, const ValuePtr& vp)
+		{ tm.payloads += value_bytes(vp); });
+
+	if (nullptr == h->_incoming_set) return;
+	const Atom::InSet& is(*h->_incoming_set);
+	tm.incoming += SHARED_BLOCK + sizeof(Atom::InSet);
+#if USE_FLAT_INCOMING_SET
+	size_t nbuckets = 0;
+	for (const auto& bucket : is._iset) { (void) bucket; nbuckets++; }
+	tm.incoming += is._size * sizeof(WinkPtr) +
+		nbuckets * sizeof(std::pair<Type, uint32_t>);
+#else
+	tm.incoming += is._iset.size() *
+		(RB_NODE + sizeof(std::pair<const Type, WincomingSet>));
+#if HAVE_FOLLY
+	for (const auto& pr : is._iset)
+		tm.incoming += pr.second.getAllocatedMemorySize();
+#else
+	tm.incoming += is._size * (RB_NODE + sizeof(WinkPtr));
+#endif
+#endif
+}
+
+std::vector<TypeMemory> MemoryReport::report(const AtomSpace& as)
+{
+	std::map<Type, TypeMemory> bytype;
+	as.foreach_handle_by_type(ATOM, true,
+		[&](const Handle& h)->bool
+		{
+			measure(h, bytype[h->get_type()]);
+			return false;
+		}, false);
+
+	std::vector<TypeMemory> rpt;
+	rpt.reserve(bytype.size());
+	for (auto& pr : bytype)
+	{
+		pr.second.type = pr.first;
+		pr.second.index = as.typeIndex.bytes(pr.first);
+		rpt.push_back(pr.second);
+	}
+	return rpt;
+}
+
+TypeMemory MemoryReport::total(const std::vector<TypeMemory>& rpt)
+{
+	TypeMemory sum;
+	for (const TypeMemory& tm : rpt)
+	{
+		sum.count += tm.count;
+		sum.atoms += tm.atoms;
+		sum.names += tm.names;
+		sum.outgoing += tm.outgoing;
+		sum.values += tm.values;
+		sum.payloads += tm.payloads;
+		sum.incoming += tm.incoming;
+		sum.index += tm.index;
+	}
+	return sum;
+}
+
+static void print_row(std::string& out, const std::string& name,
+                      const TypeMemory& tm)
+{
+	char buf[256];
+	snprintf(buf, sizeof(buf),
+		"%-28s %10zu %12zu %10zu %10zu %10zu %10zu %10zu %10zu %10zu\n",
+		name.c_str(), tm.count, tm.total(), tm.atoms, tm.names,
+		tm.outgoing, tm.values, tm.payloads, tm.incoming, tm.index);
+	out += buf;
+}
+
+std::string MemoryReport::to_string(const std::vector<TypeMemory>& rpt)
+{
+	std::vector<TypeMemory> sorted(rpt);
+	std::sort(sorted.begin(), sorted.end(),
+		[](const TypeMemory& a, const TypeMemory& b)
+		{ return a.total() > b.total(); });
+
+	char buf[256];
+	snprintf(buf, sizeof(buf),
+		"%-28s %10s %12s %10s %10s %10s %10s %10s %10s %10s\n",
+		"type", "count", "bytes", "atoms", "names", "outgoing",
+		"values", "payloads", "incoming", "index");
+	std::string out(buf);
+
+	NameServer& ns(nameserver());
+	for (const TypeMemory& tm : sorted)
+		print_row(out, ns.getTypeName(tm.type), tm);
+	print_row(out, "total", total(rpt));
+	return out;
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,98 @@
+/*
+ * opencog/atomspace/MemoryReport.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_MEMORY_REPORT_H
+#define _OPENCOG_MEMORY_REPORT_H
+
+#include <string>
+#include <vector>
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+class AtomSpace;
+
+/**
+ * Estimated memory use of all of the Atoms of one type, in bytes,
+ * broken down by where it goes.
+ */
+struct TypeMemory
+{
+	Type type = NOTYPE;
+	size_t count = 0;
+
+	size_t atoms = 0;     // The Atom objects, with their shared_ptr blocks
+	size_t names = 0;     // Node names, when too long for the string
+	size_t outgoing = 0;  // The outgoing vectors of Links
+	size_t values = 0;    // The key-value maps
+	size_t payloads = 0;  // The Values in the maps, and the TruthValues
+	size_t incoming = 0;  // The incoming sets
+	size_t index = 0;     // The TypeIndex tables
+
+	size_t total(void) const
+	{
+		return atoms + names + outgoing + values + payloads +
+			incoming + index;
+	}
+};
+
+/**
+ * Account for the memory used by an AtomSpace, type by type.
+ *
+ * These are estimates, made from the sizes of the containers and of
+ * the base classes, and not measurements of the heap. Atoms of types
+ * that have a C++ class of their own (such as the PatternLinks) are
+ * bigger than the plain Node or Link that they are counted as. Values
+ * that are held in more than one place are split evenly between the
+ * holders, by use count; so the shared default TruthValues cost
+ * almost nothing. Values that are Atoms are not counted again. The
+ * allocator's own overhead is not counted at all.
+ */
+class MemoryReport
+{
+	static void measure(const Handle&, TypeMemory&);
+	static size_t value_bytes(const ValuePtr&);
+
+public:
+	/// One entry per type that has Atoms in this frame of the
+	/// AtomSpace (the frames under it are not included), sorted by
+	/// type.
+	static std::vector<TypeMemory> report(const AtomSpace&);
+
+	/// The sum of all of the entries.
+	static TypeMemory total(const std::vector<TypeMemory>&);
+
+	/// The report, as a table, one line per type, largest first, and
+	/// a grand total.
+	static std::string to_string(const std::vector<TypeMemory>&);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_MEMORY_REPORT_H
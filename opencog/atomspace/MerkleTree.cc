@@ -0,0 +1,283 @@
+/*
+ * opencog/atomspace/MerkleTree.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <cstring>
+#include <map>
+#include <set>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/LinkValue.h>
+#include <opencog/atoms/value/StringValue.h>
+#include <opencog/atoms/truthvalue/TruthValue.h>
+
+#include "AtomSpace.h"
+#include "MerkleTree.h"
+
+using namespace opencog;
+
+MerkleTree::MerkleTree(void) : _root(0)
+{
+}
+
+/// The splitmix64 finalizer. Content hashes are not well spread in
+/// their top bits, and sums of them would be easy to collide.
+uint64_t MerkleTree::mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+size_t MerkleTree::bucket_of(const Handle& h)
+{
+	return mix(h->get_hash() ^ 0x5bd1e995ULL) >> (64 - DEPTH);
+}
+
+static uint64_t double_bits(double x)
+{
+	uint64_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	return bits;
+}
+
+uint64_t MerkleTree::value_digest(const ValuePtr& vp)
+{
+	if (nullptr == vp) return 0;
+	if (vp->is_atom()) return mix(HandleCast(vp)->get_hash());
+
+	Type t = vp->get_type();
+	uint64_t d = mix(t);
+	NameServer& ns(nameserver());
+	if (ns.isA(t, FLOAT_VALUE))
+	{
+		for (double x : FloatValueCast(vp)->value())
+			d = mix(d ^ double_bits(x));
+	}
+	else if (ns.isA(t, STRING_VALUE))
+	{
+		for (const std::string& s : StringValueCast(vp)->value())
+			d = mix(d ^ std::hash<std::string>{}(s));
+	}
+	else if (ns.isA(t, LINK_VALUE))
+	{
+		for (const ValuePtr& v : LinkValueCast(vp)->value())
+			d = mix(d ^ value_digest(v));
+	}
+	else if (ns.isA(t, TRUTH_VALUE))
+	{
+		TruthValuePtr tv(TruthValueCast(vp));
+		d = mix(d ^ double_bits(tv->get_mean()));
+		d = mix(d ^ double_bits(tv->get_confidence()));
+		d = mix(d ^ double_bits(tv->get_count()));
+	}
+	else
+		d = mix(d ^ std::hash<std::string>{}(vp->to_short_string()));
+	return d;
+}
+
+// A sum, so that the order of the keys does not matter.
+uint64_t MerkleTree::values_digest(const Handle& h)
+{
+	uint64_t d = 0;
+	for (const Handle& key : h->getKeys())
+		d += mix(key->get_hash() ^ value_digest(h->getValue(key)));
+	return d;
+}
+
+uint64_t MerkleTree::atom_digest(const Handle& h)
+{
+	return mix(h->get_hash()) + values_digest(h);
+}
+
+// ==============================================================
+
+void MerkleTree::update(const Handle& h, uint64_t add, uint64_t sub)
+{
+	Type t = h->get_type();
+	if (_trees.size() <= t)
+		_trees.resize(t + 1);
+	if (nullptr == _trees[t])
+		_trees[t].reset(new uint64_t[2 * LEAVES]());
+
+	uint64_t* tree = _trees[t].get();
+	for (size_t i = LEAVES + bucket_of(h); 0 < i; i >>= 1)
+		tree[i] += add - sub;
+	_root += add - sub;
+}
+
+// Values set on the Atom after it was put into the type index, but
+// before it was announced, were already counted by changed().
+void MerkleTree::add(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	uint64_t vd = values_digest(h);
+	uint64_t old = 0;
+	auto it = _values.find(h);
+	if (_values.end() != it)
+	{
+		old = it->second;
+		_values.erase(it);
+	}
+	if (vd) _values[h] = vd;
+	update(h, mix(h->get_hash()) + vd, old);
+}
+
+void MerkleTree::remove(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	uint64_t vd = 0;
+	auto it = _values.find(h);
+	if (_values.end() != it)
+	{
+		vd = it->second;
+		_values.erase(it);
+	}
+	update(h, 0, mix(h->get_hash()) + vd);
+}
+
+// The Values are read again under the lock; of two racing changes,
+// the one that comes second sees both.
+void MerkleTree::changed(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	uint64_t vd = values_digest(h);
+	uint64_t old = 0;
+	auto it = _values.find(h);
+	if (_values.end() != it) old = it->second;
+	if (vd == old) return;
+
+	if (vd) _values[h] = vd;
+	else _values.erase(it);
+	update(h, vd, old);
+}
+
+void MerkleTree::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_trees.clear();
+	_values.clear();
+	_root = 0;
+}
+
+// ==============================================================
+
+uint64_t MerkleTree::root(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _root;
+}
+
+uint64_t MerkleTree::get(const Node& n) const
+{
+	if (NOTYPE == n.first) return _root;
+	if (_trees.size() <= n.first or nullptr == _trees[n.first]) return 0;
+	if (0 == n.second or 2 * LEAVES <= n.second) return 0;
+	return _trees[n.first][n.second];
+}
+
+uint64_t MerkleTree::digest(const Node& n) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return get(n);
+}
+
+std::vector<uint64_t> MerkleTree::digests(const std::vector<Node>& ns) const
+{
+	std::vector<uint64_t> ds;
+	ds.reserve(ns.size());
+	std::lock_guard<std::mutex> lck(_mtx);
+	for (const Node& n : ns)
+		ds.push_back(get(n));
+	return ds;
+}
+
+/// Level by level, so that a remote tree is asked once per level,
+/// and not once per node.
+std::vector<MerkleTree::Node>
+MerkleTree::diff(const Digests& other, size_t* compared) const
+{
+	std::vector<Node> differ;
+	std::vector<Node> level({{NOTYPE, 1}});
+	size_t ncmp = 0;
+
+	while (0 < level.size())
+	{
+		std::vector<uint64_t> mine(digests(level));
+		std::vector<uint64_t> theirs(other(level));
+		ncmp += level.size();
+
+		std::vector<Node> next;
+		for (size_t i = 0; i < level.size(); i++)
+		{
+			if (i < theirs.size() and mine[i] == theirs[i]) continue;
+
+			const Node& n(level[i]);
+			if (NOTYPE == n.first)
+			{
+				Type ntypes = nameserver().getNumberOfClasses();
+				for (Type t = NOTYPE + 1; t < ntypes; t++)
+					next.push_back({t, 1});
+			}
+			else if (LEAVES <= n.second)
+				differ.push_back(n);
+			else
+			{
+				next.push_back({n.first, 2 * n.second});
+				next.push_back({n.first, 2 * n.second + 1});
+			}
+		}
+		level.swap(next);
+	}
+
+	if (compared) *compared += ncmp;
+	return differ;
+}
+
+std::vector<MerkleTree::Node>
+MerkleTree::diff(const MerkleTree& other, size_t* compared) const
+{
+	return diff([&](const std::vector<Node>& ns)
+		{ return other.digests(ns); }, compared);
+}
+
+HandleSeq MerkleTree::atoms_in(const AtomSpace& as,
+                               const std::vector<Node>& buckets)
+{
+	std::map<Type, std::set<size_t>> bytype;
+	for (const Node& n : buckets)
+		if (NOTYPE != n.first and LEAVES <= n.second)
+			bytype[n.first].insert(n.second - LEAVES);
+
+	HandleSeq found;
+	for (const auto& tb : bytype)
+	{
+		HandleSeq hs;
+		as.get_handles_by_type(hs, tb.first, false, false);
+		for (const Handle& h : hs)
+			if (tb.second.end() != tb.second.find(bucket_of(h)))
+				found.push_back(h);
+	}
+	return found;
+}
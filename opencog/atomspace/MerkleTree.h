@@ -0,0 +1,136 @@
+/*
+ * opencog/atomspace/MerkleTree.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_MERKLE_TREE_H
+#define _OPENCOG_MERKLE_TREE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+class AtomSpace;
+
+/**
+ * Digests of the contents of an AtomSpace, arranged so that two of
+ * them can find where they differ without looking at everything.
+ *
+ * Each Atom has a 64-bit digest, made from its content hash and from
+ * its Values. The Atoms of each type are spread over 2^DEPTH buckets,
+ * by their content hash; each type has a binary tree over its buckets,
+ * in which every node holds the sum of the digests under it. The sum
+ * of everything is the root. Sums, unlike hashes of hashes, can be
+ * updated in place: adding, removing or changing an Atom touches only
+ * the DEPTH+1 nodes over its bucket.
+ *
+ * Two trees are compared top down: the roots, then the root of each
+ * type, and then only the children of the nodes that differ. So the
+ * number of digests looked at grows with the number of differences,
+ * times DEPTH, plus the number of types; and not with the number of
+ * Atoms. The buckets that differ are what is left at the bottom.
+ *
+ * Digests are 64 bits; two different AtomSpaces have equal digests
+ * only by accident, with odds of about one in 2^64. Content hashes
+ * include the type numbers, so digests can be compared between
+ * processes only if they have the same atom types, declared in the
+ * same order. See `AtomSpace::track_digests()`.
+ */
+class MerkleTree
+{
+public:
+	static constexpr int DEPTH = 10;
+	static constexpr size_t LEAVES = 1UL << DEPTH;
+
+	/// A node in the tree of one type. Node 1 is the root; node i
+	/// has children 2i and 2i+1; nodes LEAVES and up are the buckets.
+	/// The node (NOTYPE, 1) is the root of everything.
+	typedef std::pair<Type, size_t> Node;
+
+	/// Digests of the nodes, in the same order; for comparing with
+	/// trees that are not at hand, such as ones across the network.
+	typedef std::function<std::vector<uint64_t>(const std::vector<Node>&)>
+		Digests;
+
+private:
+	mutable std::mutex _mtx;
+	std::vector<std::unique_ptr<uint64_t[]>> _trees;
+	uint64_t _root;
+
+	// The digest of the Values on each Atom that has any, as it was
+	// when last added in; it has to be taken out again when they
+	// change, or the Atom goes away.
+	std::unordered_map<Handle, uint64_t> _values;
+
+	void update(const Handle&, uint64_t add, uint64_t sub);
+	uint64_t get(const Node&) const;
+
+public:
+	MerkleTree(void);
+
+	static uint64_t mix(uint64_t);
+	static size_t bucket_of(const Handle&);
+	static uint64_t value_digest(const ValuePtr&);
+	static uint64_t values_digest(const Handle&);
+
+	/// The digest of the Atom, and of the Values on it now.
+	static uint64_t atom_digest(const Handle&);
+
+	void add(const Handle&);
+	void remove(const Handle&);
+	void changed(const Handle&);
+	void clear(void);
+
+	uint64_t root(void) const;
+	uint64_t digest(const Node&) const;
+	std::vector<uint64_t> digests(const std::vector<Node>&) const;
+
+	/// The buckets in which this tree differs from the other one.
+	/// If `compared` is given, the number of digests that had to be
+	/// looked at is added to it.
+	std::vector<Node> diff(const Digests& other,
+	                       size_t* compared = nullptr) const;
+	std::vector<Node> diff(const MerkleTree& other,
+	                       size_t* compared = nullptr) const;
+
+	/// The Atoms in the given buckets, out of this frame of the
+	/// AtomSpace only. Each type named is scanned once, no matter
+	/// how many of its buckets are asked for.
+	static HandleSeq atoms_in(const AtomSpace&, const std::vector<Node>&);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_MERKLE_TREE_H
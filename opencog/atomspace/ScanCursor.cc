@@ -0,0 +1,136 @@
+/*
+ * opencog/atomspace/ScanCursor.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/base/Atom.h>
+
+#include "AtomSpace.h"
+#include "ScanCursor.h"
+
+using namespace opencog;
+
+// Tokens are kept to 53 bits, so that they survive being read as a
+// JavaScript number.
+#define TOKEN_MASK ((1ULL << 53) - 1)
+
+namespace {
+
+typedef std::shared_ptr<ScanCursor> ScanCursorPtr;
+
+std::mutex cursor_mtx;
+std::unordered_map<uint64_t, ScanCursorPtr> cursors;
+
+// Not guessable from the ones handed out before it.
+uint64_t new_token(void)
+{
+	static std::mt19937_64 gen(std::random_device{}());
+	uint64_t tok = 0;
+	while (0 == tok or cursors.end() != cursors.find(tok))
+		tok = gen() & TOKEN_MASK;
+	return tok;
+}
+
+}
+
+uint64_t ScanCursor::open(HandleSeq&& hs)
+{
+	ScanCursorPtr cur(std::make_shared<ScanCursor>());
+	cur->_atoms = std::move(hs);
+	cur->_used = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lck(cursor_mtx);
+
+	// Close the idle ones, and, if there are still too many, the one
+	// that was used longest ago.
+	auto oldest = cursors.end();
+	for (auto it = cursors.begin(); it != cursors.end(); )
+	{
+		if (IDLE_TIMEOUT < cur->_used - it->second->_used)
+		{
+			it = cursors.erase(it);
+			continue;
+		}
+		if (cursors.end() == oldest or
+		    it->second->_used < oldest->second->_used)
+			oldest = it;
+		it++;
+	}
+	if (MAX_OPEN <= cursors.size())
+		cursors.erase(oldest);
+
+	uint64_t tok = new_token();
+	cursors.emplace(tok, cur);
+	return tok;
+}
+
+uint64_t ScanCursor::open_type(const AtomSpace* as, Type t, bool subclass)
+{
+	HandleSeq hs;
+	as->get_handles_by_type(hs, t, subclass);
+	return open(std::move(hs));
+}
+
+uint64_t ScanCursor::open_incoming(const Handle& h, Type t)
+{
+	if (NOTYPE == t)
+		return open(h->getIncomingSet());
+	return open(h->getIncomingSetByType(t));
+}
+
+uint64_t ScanCursor::next(uint64_t tok, size_t n, HandleSeq& page)
+{
+	if (0 == n) n = DEFAULT_PAGE;
+
+	std::lock_guard<std::mutex> lck(cursor_mtx);
+	auto it = cursors.find(tok);
+	if (cursors.end() == it)
+		throw RuntimeException(TRACE_INFO,
+			"No such cursor: %lu", (unsigned long) tok);
+
+	ScanCursor& cur(*it->second);
+	size_t end = std::min(cur._pos + n, cur._atoms.size());
+	for (; cur._pos < end; cur._pos++)
+	{
+		Handle& h(cur._atoms[cur._pos]);
+		if (h->getAtomSpace()) page.emplace_back(std::move(h));
+	}
+
+	if (cur._atoms.size() <= cur._pos)
+	{
+		cursors.erase(it);
+		return 0;
+	}
+	cur._used = std::chrono::steady_clock::now();
+	return tok;
+}
+
+bool ScanCursor::close(uint64_t tok)
+{
+	std::lock_guard<std::mutex> lck(cursor_mtx);
+	return 0 < cursors.erase(tok);
+}
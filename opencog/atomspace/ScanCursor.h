@@ -0,0 +1,96 @@
+/*
+ * opencog/atomspace/ScanCursor.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SCAN_CURSOR_H
+#define _OPENCOG_SCAN_CURSOR_H
+
+#include <chrono>
+#include <cstdint>
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+class AtomSpace;
+
+/**
+ * Server-side cursors over long lists of Atoms: all of the Atoms of
+ * a type, or the incoming set of an Atom. They let the network
+ * command interpreters hand such lists out a page at a time, so that
+ * neither end has to hold all of it, as text, at once.
+ *
+ * A cursor is named by an opaque token, which the client sends back
+ * to get the next page. Opening one takes a snapshot of the Handles
+ * (and only the Handles); the hash tables of the type index move
+ * things around when they grow, and so cannot be resumed from. Atoms
+ * that are extracted after the snapshot is taken are skipped, so a
+ * page may come out shorter than asked for.
+ *
+ * Cursors that run to the end are closed. Ones that are left idle
+ * for too long are closed when the next one is opened, as is the
+ * least recently used one, if too many are open.
+ */
+class ScanCursor
+{
+	HandleSeq _atoms;
+	size_t _pos = 0;
+	std::chrono::steady_clock::time_point _used;
+
+	static uint64_t open(HandleSeq&&);
+
+public:
+	/// Cursors left idle this long are closed.
+	static constexpr std::chrono::seconds IDLE_TIMEOUT{600};
+
+	/// At most this many are open at once.
+	static constexpr size_t MAX_OPEN = 1024;
+
+	/// Page size to use when the client does not say.
+	static constexpr size_t DEFAULT_PAGE = 10000;
+
+	/// Open a cursor over the Atoms of the type, and maybe of its
+	/// subtypes, as get_handles_by_type() would find them.
+	static uint64_t open_type(const AtomSpace*, Type, bool subclass);
+
+	/// Open a cursor over the incoming set of the Atom; over only
+	/// the Links of the given type, unless that is NOTYPE.
+	static uint64_t open_incoming(const Handle&, Type = NOTYPE);
+
+	/// Append up to `n` more Atoms to `page`. Returns the token for
+	/// the page after that, or zero if there is none; the cursor is
+	/// then closed. Throws if there is no such cursor (it may have
+	/// expired).
+	static uint64_t next(uint64_t token, size_t n, HandleSeq& page);
+
+	/// Close the cursor early. Returns false if it was not open.
+	static bool close(uint64_t token);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_SCAN_CURSOR_H
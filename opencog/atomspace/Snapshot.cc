@@ -0,0 +1,376 @@
+/*
+ * opencog/atomspace/Snapshot.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/util/exceptions.h>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Node.h>
+
+#include "AtomSpace.h"
+#include "Snapshot.h"
+
+using namespace opencog;
+
+// ==============================================================
+
+#define NUM_GATES 16
+#define NUM_STRIPES 64
+
+std::atomic<size_t> Snapshot::_open_snapshots(0);
+
+// Ticked by every change that is noted, and by every snapshot.
+static std::atomic<uint64_t> _clock(0);
+
+// The epochs of the open snapshots.
+static std::mutex _pin_mtx;
+static std::multiset<uint64_t> _pins;
+
+// Each thread sticks to one gate; a snapshot takes all of them.
+struct alignas(64) GateLock
+{
+	std::shared_mutex mtx;
+};
+static GateLock _gates[NUM_GATES];
+
+static std::shared_mutex& my_gate(void)
+{
+	static std::atomic<size_t> _next(0);
+	static thread_local size_t idx = _next++ % NUM_GATES;
+	return _gates[idx].mtx;
+}
+
+Snapshot::Gate::Gate(void) :
+	_mtx(my_gate())
+{
+	_mtx.lock_shared();
+}
+
+// ==============================================================
+// The history, undone by the snapshots.
+
+namespace {
+
+struct Overwritten
+{
+	uint64_t when;
+	Handle key;
+	ValuePtr old;
+};
+
+// What a snapshot must undo, for one Atom. An epoch of zero means
+// that it happened before any snapshot that is open now.
+struct Past
+{
+	uint64_t added = 0;
+	uint64_t removed = 0;
+	const AtomSpace* space = nullptr;
+	std::vector<Overwritten> values;
+};
+
+struct alignas(64) Stripe
+{
+	std::mutex mtx;
+	std::unordered_map<Handle, Past> past;
+};
+
+}
+
+static Stripe _stripes[NUM_STRIPES];
+
+// Removed Atoms, oldest first, for the searches by type.
+static std::mutex _removed_mtx;
+static std::vector<std::pair<uint64_t, Handle>> _removed;
+
+static inline Stripe& stripe_of(const Handle& h)
+{
+	uint64_t p = reinterpret_cast<uintptr_t>(h.get()) >> 4;
+	p *= 0x9e3779b97f4a7c15ULL;
+	return _stripes[(p >> 32) % NUM_STRIPES];
+}
+
+// Copy out what is known of the Atom, if anything.
+static bool lookup(const Handle& h, Past& past)
+{
+	Stripe& s(stripe_of(h));
+	std::lock_guard<std::mutex> lck(s.mtx);
+	auto it = s.past.find(h);
+	if (s.past.end() == it) return false;
+	past = it->second;
+	return true;
+}
+
+void Snapshot::changing(const Handle& h, const Handle& key,
+                        const ValuePtr& old)
+{
+	Stripe& s(stripe_of(h));
+	std::lock_guard<std::mutex> lck(s.mtx);
+	s.past[h].values.push_back({++_clock, key, old});
+}
+
+bool Snapshot::note_added(const Handle& h)
+{
+	if (not any_open()) return false;
+
+	Stripe& s(stripe_of(h));
+	std::lock_guard<std::mutex> lck(s.mtx);
+	Past& past(s.past[h]);
+	past.added = ++_clock;
+	past.removed = 0;
+	return true;
+}
+
+void Snapshot::unnote_added(const Handle& h)
+{
+	Stripe& s(stripe_of(h));
+	std::lock_guard<std::mutex> lck(s.mtx);
+	auto it = s.past.find(h);
+	if (s.past.end() == it) return;
+	it->second.added = 0;
+	if (it->second.values.empty()) s.past.erase(it);
+}
+
+bool Snapshot::note_removed(const Handle& h)
+{
+	if (not any_open()) return false;
+
+	// With both locked, so that the list stays in order.
+	Stripe& s(stripe_of(h));
+	std::lock_guard<std::mutex> lck(s.mtx);
+	std::lock_guard<std::mutex> rlck(_removed_mtx);
+	Past& past(s.past[h]);
+	past.removed = ++_clock;
+	past.space = h->getAtomSpace();
+	_removed.push_back({past.removed, h});
+	return true;
+}
+
+void Snapshot::unnote_removed(const Handle& h)
+{
+	uint64_t when = 0;
+	{
+		Stripe& s(stripe_of(h));
+		std::lock_guard<std::mutex> lck(s.mtx);
+		auto it = s.past.find(h);
+		if (s.past.end() == it) return;
+		when = it->second.removed;
+		it->second.removed = 0;
+		if (0 == it->second.added and it->second.values.empty())
+			s.past.erase(it);
+	}
+	std::lock_guard<std::mutex> lck(_removed_mtx);
+	for (auto it = _removed.rbegin(); it != _removed.rend(); it++)
+	{
+		if (it->second != h or it->first != when) continue;
+		_removed.erase(std::next(it).base());
+		break;
+	}
+}
+
+/// Drop whatever no open snapshot can see: everything that happened
+/// at, or before, the epoch of the oldest one. If there are none, then
+/// everything that happened before now; a snapshot taken later will
+/// not look at it.
+void Snapshot::reclaim(void)
+{
+	uint64_t oldest;
+	{
+		std::lock_guard<std::mutex> lck(_pin_mtx);
+		oldest = _pins.empty() ? _clock.load() : *_pins.begin();
+	}
+
+	for (Stripe& s : _stripes)
+	{
+		std::lock_guard<std::mutex> lck(s.mtx);
+		for (auto it = s.past.begin(); it != s.past.end(); )
+		{
+			Past& past(it->second);
+			if (0 != past.removed and past.removed <= oldest)
+			{
+				it = s.past.erase(it);
+				continue;
+			}
+			if (past.added <= oldest) past.added = 0;
+			past.values.erase(std::remove_if(past.values.begin(),
+				past.values.end(),
+				[oldest](const Overwritten& ow) { return ow.when <= oldest; }),
+				past.values.end());
+			if (0 == past.added and 0 == past.removed and past.values.empty())
+				it = s.past.erase(it);
+			else
+				it++;
+		}
+	}
+
+	std::lock_guard<std::mutex> lck(_removed_mtx);
+	_removed.erase(std::remove_if(_removed.begin(), _removed.end(),
+		[oldest](const std::pair<uint64_t, Handle>& pr)
+			{ return pr.first <= oldest; }),
+		_removed.end());
+}
+
+// ==============================================================
+
+Snapshot::Snapshot(const AtomSpacePtr& as) :
+	_as(as), _epoch(0), _open(false)
+{
+	if (nullptr == as)
+		throw InvalidParamException(TRACE_INFO,
+			"Snapshot: expecting an AtomSpace");
+
+	// Writers look at the count after they get through the gate; so
+	// those that are let through after the clock is read, keep the
+	// history.
+	_open_snapshots++;
+	for (GateLock& g : _gates) g.mtx.lock();
+	_epoch = ++_clock;
+	{
+		std::lock_guard<std::mutex> lck(_pin_mtx);
+		_pins.insert(_epoch);
+	}
+	for (GateLock& g : _gates) g.mtx.unlock();
+	_open = true;
+}
+
+Snapshot::~Snapshot()
+{
+	release();
+}
+
+void Snapshot::release(void)
+{
+	if (not _open) return;
+	_open = false;
+	{
+		std::lock_guard<std::mutex> lck(_pin_mtx);
+		_pins.erase(_pins.find(_epoch));
+	}
+	_open_snapshots--;
+	reclaim();
+}
+
+bool Snapshot::in_environ(const AtomSpace* as) const
+{
+	for (const AtomSpace::EnvFrame& f : _as->_frames)
+		if (f.space == as) return true;
+	return false;
+}
+
+// ==============================================================
+// The AtomSpace is read first, and the history after; anything that
+// changes in between is then found in the history.
+
+bool Snapshot::is_present(const Handle& h) const
+{
+	if (not _open)
+		throw RuntimeException(TRACE_INFO, "Snapshot: already released");
+	if (nullptr == h) return false;
+
+	bool live = _as->in_environ(h);
+	Past past;
+	if (not lookup(h, past)) return live;
+
+	if (_epoch < past.added) return false;
+	if (live) return true;
+	return _epoch < past.removed and in_environ(past.space);
+}
+
+void Snapshot::get_handles_by_type(HandleSeq& hseq, Type t,
+                                   bool subclass) const
+{
+	if (not _open)
+		throw RuntimeException(TRACE_INFO, "Snapshot: already released");
+
+	HandleSeq live;
+	_as->get_handles_by_type(live, t, subclass);
+
+	// Those that came later.
+	for (const Handle& h : live)
+	{
+		Past past;
+		if (lookup(h, past) and _epoch < past.added) continue;
+		hseq.push_back(h);
+	}
+
+	// Those that were there, and have since gone.
+	std::vector<Handle> gone;
+	{
+		std::lock_guard<std::mutex> lck(_removed_mtx);
+		auto it = std::upper_bound(_removed.begin(), _removed.end(),
+			std::make_pair(_epoch, Handle()),
+			[](const std::pair<uint64_t, Handle>& a,
+			   const std::pair<uint64_t, Handle>& b)
+				{ return a.first < b.first; });
+		for (; it != _removed.end(); it++)
+		{
+			Type ht = it->second->get_type();
+			if (ht == t or (subclass and nameserver().isA(ht, t)))
+				gone.push_back(it->second);
+		}
+	}
+	if (gone.empty()) return;
+
+	// An Atom may be in the index still, on its way out; and it may
+	// have been removed more than once.
+	UnorderedHandleSet seen(live.begin(), live.end());
+	for (const Handle& h : gone)
+	{
+		if (not seen.insert(h).second) continue;
+		Past past;
+		if (not lookup(h, past)) continue;
+		if (_epoch < past.added or past.removed <= _epoch) continue;
+		if (in_environ(past.space)) hseq.push_back(h);
+	}
+}
+
+ValuePtr Snapshot::get_value(const Handle& h, const Handle& key) const
+{
+	if (not is_present(h)) return nullptr;
+
+	ValuePtr vp(_as->in_environ(h) ?
+		_as->get_value(h, key) : h->getValue(key));
+
+	// The oldest Value overwritten, after the snapshot was taken, is
+	// the one that it saw.
+	Past past;
+	if (not lookup(h, past)) return vp;
+	for (const Overwritten& ow : past.values)
+	{
+		if (ow.when <= _epoch) continue;
+		if (ow.key == key or *ow.key == *key) return ow.old;
+	}
+	return vp;
+}
+
+TruthValuePtr Snapshot::get_truthvalue(const Handle& h) const
+{
+	ValuePtr vp(get_value(h, Atom::truth_key()));
+	if (nullptr == vp) return TruthValue::DEFAULT_TV();
+	return TruthValueCast(vp);
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,146 @@
+/*
+ * opencog/atomspace/Snapshot.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_ATOMSPACE_SNAPSHOT_H
+#define _OPENCOG_ATOMSPACE_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/truthvalue/TruthValue.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+class Atom;
+class AtomSpace;
+typedef std::shared_ptr<AtomSpace> AtomSpacePtr;
+
+/**
+ * A read-only view of an AtomSpace (and of the frames under it), as it
+ * was at the moment the snapshot was taken. Writers keep going while
+ * it is in use: they are neither blocked by it, nor do they copy the
+ * AtomSpace for it.
+ *
+ * Snapshots are stamped with an epoch, from a clock that every change
+ * ticks while any snapshot is open. For as long as one is, each write
+ * notes what it undid: the Atoms added, with the epoch they were added
+ * at, and those removed, and the Values that were overwritten. The
+ * history is kept off to the side, and holds the removed Atoms and
+ * old Values alive. Reading a snapshot is reading the AtomSpace as it
+ * is now, and then undoing whatever happened after its epoch. When a
+ * snapshot is released, whatever no remaining snapshot can see is
+ * dropped; when there are none left, the history is emptied, and the
+ * writers stop keeping it.
+ *
+ * Adds and removes pass through a striped gate, which a snapshot
+ * takes, in full, only to read the clock; Values need no gate, as
+ * they are noted under the Atom's own lock. Changes made by clear(),
+ * Values held in value overlays, and the hiding of Atoms in
+ * copy-on-write frames are not noted; snapshots see those as they
+ * are now.
+ */
+class Snapshot
+{
+	friend class Atom;
+	friend class AtomSpace;
+
+	AtomSpacePtr _as;
+	uint64_t _epoch;
+	bool _open;
+
+	static std::atomic<size_t> _open_snapshots;
+
+	// Called by the Atom, with its Values locked, just before a Value
+	// is overwritten.
+	static void changing(const Handle&, const Handle& key, const ValuePtr& old);
+
+	// Called by the AtomSpace, with the gate held, just before an Atom
+	// is put into, or taken out of, its index; and to undo that, if
+	// it turns out that it was not. They return false if there are no
+	// snapshots open.
+	static bool note_added(const Handle&);
+	static void unnote_added(const Handle&);
+	static bool note_removed(const Handle&);
+	static void unnote_removed(const Handle&);
+
+	/// Held by the AtomSpace while it adds or removes Atoms.
+	class Gate
+	{
+		std::shared_mutex& _mtx;
+	public:
+		Gate(void);
+		~Gate() { _mtx.unlock_shared(); }
+	};
+
+	static void reclaim(void);
+
+	bool in_environ(const AtomSpace*) const;
+
+public:
+	Snapshot(const AtomSpacePtr&);
+	~Snapshot();
+
+	Snapshot(const Snapshot&) = delete;
+	Snapshot& operator=(const Snapshot&) = delete;
+
+	const AtomSpacePtr& get_atomspace(void) const { return _as; }
+	uint64_t get_epoch(void) const { return _epoch; }
+	bool is_open(void) const { return _open; }
+
+	/// True, if there are any snapshots open, anywhere.
+	static bool any_open(void) { return 0 < _open_snapshots.load(); }
+
+	/// Return true if the Atom was in the AtomSpace, or in one of its
+	/// frames, when the snapshot was taken.
+	bool is_present(const Handle&) const;
+
+	/// The Atoms of the given type (and of its subtypes, if `subclass`
+	/// is set), that were in the AtomSpace when the snapshot was taken.
+	void get_handles_by_type(HandleSeq&, Type, bool subclass=false) const;
+	HandleSeq get_handles_by_type(Type t, bool subclass=false) const
+	{
+		HandleSeq hs;
+		get_handles_by_type(hs, t, subclass);
+		return hs;
+	}
+
+	/// The Values of the Atom, as they were when the snapshot was
+	/// taken. Null, or the default TruthValue, if the Atom was not
+	/// present at that time.
+	ValuePtr get_value(const Handle&, const Handle& key) const;
+	TruthValuePtr get_truthvalue(const Handle&) const;
+
+	/// Let go of the history kept for this snapshot. It is released
+	/// when it is destroyed, anyway; it cannot be read after that.
+	void release(void);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_ATOMSPACE_SNAPSHOT_H
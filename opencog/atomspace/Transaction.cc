@@ -0,0 +1,260 @@
+/*
+ * opencog/atomspace/Transaction.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+
+#include "Transaction.h"
+
+using namespace opencog;
+
+Transaction::Transaction(const AtomSpacePtr& parent) :
+	_parent(parent), _open(false)
+{
+	if (nullptr == parent)
+		throw InvalidParamException(TRACE_INFO,
+			"Transaction: expecting an AtomSpace");
+
+	// Open first, so that changes made while the frame is being set
+	// up are stamped.
+	_start = AtomSpace::open_transaction();
+	_open = true;
+
+	_frame = createAtomSpace(_parent);
+	_frame->set_copy_on_write();
+	_frame->set_value_overlay();
+}
+
+Transaction::~Transaction()
+{
+	if (_open) close();
+}
+
+void Transaction::ensure_open(const char* what) const
+{
+	if (not _open)
+		throw RuntimeException(TRACE_INFO,
+			"Transaction: cannot %s; the transaction has ended", what);
+}
+
+bool Transaction::in_frame(const Handle& h) const
+{
+	return h->getAtomSpace() == _frame.get();
+}
+
+/// Note an Atom of the parent (or of its bases), that the transaction
+/// depends on.
+void Transaction::check(const Handle& h)
+{
+	if (not in_frame(h)) _checks.insert(h);
+}
+
+/// A new Link depends on those Atoms of the parent that it holds.
+void Transaction::check_outgoing(const Handle& h)
+{
+	if (not h->is_link()) return;
+	for (const Handle& ho : h->getOutgoingSet())
+	{
+		if (in_frame(ho)) check_outgoing(ho);
+		else check(ho);
+	}
+}
+
+/// The Atom as the frame sees it; added to the frame, if it is not
+/// there, or in the parent, yet.
+Handle Transaction::find_or_add(const Handle& h)
+{
+	Handle fh(_frame->get_atom(h));
+	if (fh) return fh;
+
+	fh = _frame->add_atom(h);
+	check_outgoing(fh);
+	_adds.push_back(fh);
+	return fh;
+}
+
+/* ================================================================= */
+
+Handle Transaction::add_atom(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	ensure_open("add");
+
+	// If it is already in the parent, then only its Values are news.
+	// Adding it to the frame would copy them onto the parent's Atom.
+	Handle fh(_frame->get_atom(h));
+	if (fh and not in_frame(fh))
+	{
+		if (fh != h)
+		{
+			check(fh);
+			for (const Handle& key : h->getKeys())
+			{
+				ValuePtr vp(h->getValue(key));
+				_values[fh][key] = vp;
+				_frame->set_value(fh, key, vp);
+			}
+		}
+		return fh;
+	}
+	if (fh) return _frame->add_atom(h);
+
+	return find_or_add(h);
+}
+
+bool Transaction::extract_atom(const Handle& h, bool recursive)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	ensure_open("extract");
+
+	Handle fh(_frame->get_atom(h));
+	if (nullptr == fh) return false;
+
+	// The frame hides it.
+	if (not in_frame(fh))
+	{
+		check(fh);
+		_extracts.push_back({fh, recursive});
+	}
+	return _frame->extract_atom(fh, recursive);
+}
+
+void Transaction::set_value(const Handle& h, const Handle& key,
+                            const ValuePtr& value)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	ensure_open("set a Value");
+
+	Handle fh(find_or_add(h));
+	if (not in_frame(fh))
+	{
+		check(fh);
+		_values[fh][key] = value;
+	}
+	_frame->set_value(fh, key, value);
+}
+
+void Transaction::set_truthvalue(const Handle& h, const TruthValuePtr& tvp)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	ensure_open("set a TruthValue");
+
+	Handle fh(find_or_add(h));
+	if (not in_frame(fh))
+	{
+		check(fh);
+		_tvs[fh] = tvp;
+	}
+	_frame->set_truthvalue(fh, tvp);
+}
+
+ValuePtr Transaction::get_value(const Handle& h, const Handle& key)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	ensure_open("get a Value");
+
+	Handle fh(_frame->get_atom(h));
+	if (nullptr == fh) return nullptr;
+	check(fh);
+	return _frame->get_value(fh, key);
+}
+
+TruthValuePtr Transaction::get_truthvalue(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	ensure_open("get a TruthValue");
+
+	Handle fh(_frame->get_atom(h));
+	if (nullptr == fh) return TruthValue::DEFAULT_TV();
+	check(fh);
+	return _frame->get_truthvalue(fh);
+}
+
+/* ================================================================= */
+
+/// True, if none of the Atoms that were checked were changed after
+/// the transaction started.
+bool Transaction::validate(void) const
+{
+	for (const Handle& h : _checks)
+		if (_start < AtomSpace::stamp_of(h.get())) return false;
+	return true;
+}
+
+void Transaction::apply(void)
+{
+	// New Atoms first, so that Values can be set on them. An Atom
+	// added, and then extracted again, is no longer in the frame.
+	for (const Handle& h : _adds)
+		if (in_frame(h)) _parent->add_atom(h);
+
+	for (const auto& hv : _values)
+		for (const auto& kv : hv.second)
+			_parent->set_value(hv.first, kv.first, kv.second);
+
+	for (const auto& ht : _tvs)
+		_parent->set_truthvalue(ht.first, ht.second);
+
+	for (const auto& he : _extracts)
+		_parent->extract_atom(he.first, he.second);
+}
+
+bool Transaction::commit(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	ensure_open("commit");
+
+	bool ok = false;
+	try
+	{
+		std::lock_guard<std::mutex> clck(_parent->_commit_mtx);
+		ok = validate();
+		if (ok) apply();
+	}
+	catch (...)
+	{
+		close();
+		throw;
+	}
+	close();
+	return ok;
+}
+
+void Transaction::abort(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (_open) close();
+}
+
+/// Drop the frame, and everything recorded.
+void Transaction::close(void)
+{
+	_checks.clear();
+	_adds.clear();
+	_values.clear();
+	_tvs.clear();
+	_extracts.clear();
+	_frame = nullptr;
+	_open = false;
+	AtomSpace::close_transaction();
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,130 @@
+/*
+ * opencog/atomspace/Transaction.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_TRANSACTION_H
+#define _OPENCOG_TRANSACTION_H
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A batch of changes to an AtomSpace, made as a whole, or not at all,
+ * with optimistic concurrency control.
+ *
+ * The changes are made in a frame of their own: a copy-on-write child
+ * of the AtomSpace, with a value overlay (see
+ * `AtomSpace::set_value_overlay()`), so that nothing is copied until
+ * the commit. Reads through the transaction see the AtomSpace, with
+ * the changes made so far on top.
+ *
+ * Every Atom of the AtomSpace that the transaction reads a Value of,
+ * sets a Value on, extracts, or builds a new Link on, is checked when
+ * it commits: if some other writer changed it since the transaction
+ * started, then the commit fails, and nothing is written. Otherwise,
+ * the changes are written into the AtomSpace. Commits on one
+ * AtomSpace are made one at a time, so that transactions that commit
+ * are serializable; writers that do not use transactions take no
+ * locks, and are never held up. The caller is expected to retry, with
+ * a new transaction, on failure.
+ *
+ * Only what is done through the methods here is checked. Reading
+ * Atoms through the frame, or searching it, does not count as a read.
+ * Transactions on different AtomSpaces, that share a base, are not
+ * serialized against one another.
+ *
+ * A transaction that is neither committed nor aborted is aborted when
+ * it is destroyed.
+ */
+class Transaction
+{
+	AtomSpacePtr _parent;
+	AtomSpacePtr _frame;
+	uint64_t _start;
+	bool _open;
+
+	std::mutex _mtx;
+
+	// Atoms of the parent that must not have changed.
+	UnorderedHandleSet _checks;
+
+	// New Atoms, in the frame.
+	HandleSeq _adds;
+
+	// Changes to the Atoms of the parent.
+	std::unordered_map<Handle, std::map<Handle, ValuePtr>> _values;
+	std::unordered_map<Handle, TruthValuePtr> _tvs;
+	std::vector<std::pair<Handle, bool>> _extracts;
+
+	void ensure_open(const char*) const;
+	bool in_frame(const Handle&) const;
+	void check(const Handle&);
+	void check_outgoing(const Handle&);
+	Handle find_or_add(const Handle&);
+	bool validate(void) const;
+	void apply(void);
+	void close(void);
+
+public:
+	Transaction(const AtomSpacePtr&);
+	~Transaction();
+
+	Transaction(const Transaction&) = delete;
+	Transaction& operator=(const Transaction&) = delete;
+
+	/// The frame that the changes are made in. Searches and queries
+	/// may be run on it, to see the changes made so far. It is gone
+	/// after the transaction ends.
+	const AtomSpacePtr& get_frame(void) const { return _frame; }
+	const AtomSpacePtr& get_atomspace(void) const { return _parent; }
+	bool is_open(void) const { return _open; }
+
+	Handle add_atom(const Handle&);
+	bool extract_atom(const Handle&, bool recursive=false);
+
+	void set_value(const Handle&, const Handle& key, const ValuePtr&);
+	void set_truthvalue(const Handle&, const TruthValuePtr&);
+	ValuePtr get_value(const Handle&, const Handle& key);
+	TruthValuePtr get_truthvalue(const Handle&);
+
+	/// Write the changes into the AtomSpace, unless some Atom that was
+	/// checked has changed since the transaction started. Returns true
+	/// if the changes were written. Either way, the transaction ends.
+	bool commit(void);
+
+	/// Drop the changes, and end the transaction.
+	void abort(void);
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_TRANSACTION_H
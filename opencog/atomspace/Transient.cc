@@ -24,6 +24,7 @@
 #include <atomic>
 #include <mutex>
 #include <opencog/util/Logger.h>
+#include <opencog/atoms/base/LockStats.h>
 
 #include <opencog/atomspace/AtomSpace.h>
 #include "Transient.h"
@@ -41,11 +42,11 @@ using namespace opencog;
 /// in this section implements this.
 ///
 /// XXX The last statement may be false; using this code may offer
-/// no performance advantage whatsoever! I mean, what the heck,
-/// AtomSpaces are not fat pigs! It might be easier to just ...
-/// create new AtomSpaces as needed!  For now, we keep this code,
-/// but performance should be measured, and this code should be
-/// trashed if it offers no benefit.
+/// no performance advantage whatsoever! An empty AtomSpace allocates
+/// nothing for its TypeIndex until the first Atom is added, and does
+/// not subscribe to the NameServer. See `testFrameCreateSpeed` in
+/// `MultiSpaceUTest` for a measurement of both paths; this code should
+/// be trashed if it offers no benefit.
 
 // XXX TODO This should be changed to use an use-counting AtomSpacePtr
 // so that the transients are automatically released back to the pool.
@@ -56,7 +57,9 @@ const bool TRANSIENT_SPACE = true;
 const int MAX_CACHED_TRANSIENTS = 32;
 
 // Allocated storage for the transient atomspace cache static variables.
-static std::mutex s_transient_cache_mutex;
+static constexpr char transient_lock_site[] = "Transient cache";
+typedef LOCK_SITE_MUTEX(transient_lock_site) TransientMutex;
+static TransientMutex s_transient_cache_mutex;
 static std::vector<AtomSpacePtr> s_transient_cache;
 static std::set<AtomSpacePtr> s_issued;
 
@@ -70,7 +73,7 @@ AtomSpace* opencog::grab_transient_atomspace(AtomSpace* parent)
 	if (s_transient_cache.size() > 0)
 	{
 		// Grab the mutex lock.
-		std::unique_lock<std::mutex> cache_lock(s_transient_cache_mutex);
+		std::unique_lock<TransientMutex> cache_lock(s_transient_cache_mutex);
 
 		// Check to make sure the cache still has one now that we have
 		// the mutex.
@@ -92,6 +95,7 @@ AtomSpace* opencog::grab_transient_atomspace(AtomSpace* parent)
 	if (!tranny)
 	{
 		tranny = createAtomSpace(parent, TRANSIENT_SPACE);
+		std::unique_lock<TransientMutex> cache_lock(s_transient_cache_mutex);
 		s_issued.insert(tranny);
 		num_issued ++;
 	}
@@ -108,7 +112,7 @@ void opencog::release_transient_atomspace(AtomSpace* atomspace)
 	if (s_transient_cache.size() < MAX_CACHED_TRANSIENTS)
 	{
 		// Grab the mutex lock.
-		std::unique_lock<std::mutex> cache_lock(s_transient_cache_mutex);
+		std::unique_lock<TransientMutex> cache_lock(s_transient_cache_mutex);
 
 		// Check it again since we only now have the mutex locked.
 		if (s_transient_cache.size() < MAX_CACHED_TRANSIENTS)
@@ -19,22 +19,289 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 #include "TypeIndex.h"
 #include <opencog/atoms/atom_types/NameServer.h>
 
 using namespace opencog;
 
+// Nothing is allocated here; see reserve().
 TypeIndex::TypeIndex(void) :
-	_nameserver(nameserver())
+	_num_types(0),
+	_nameserver(nameserver()),
+	_use_filter(false)
 {
-	resize();
 }
 
 void TypeIndex::resize(void)
 {
-	_num_types = nameserver().getNumberOfClasses();
-	TYPE_INDEX_UNIQUE_LOCK;
-	_idx.resize(_num_types + 1);
+	lock_all();
+	size_t ntypes = _nameserver.getNumberOfClasses();
+	if (_num_types < ntypes)
+	{
+		_idx.resize((ntypes + 1) * TYPE_INDEX_NUM_SHARDS);
+		_num_types.store(ntypes, std::memory_order_release);
+	}
+	unlock_all();
+}
+
+// Always lock in the same order, to avoid deadlocks.
+void TypeIndex::lock_all(void) const
+{
+	for (size_t i = 0; i < TYPE_INDEX_NUM_STRIPES; i++)
+		_locks[i].lock();
+}
+
+void TypeIndex::unlock_all(void) const
+{
+	for (size_t i = TYPE_INDEX_NUM_STRIPES; 0 < i; i--)
+		_locks[i-1].unlock();
+}
+
+// ================================================================
+
+size_t TypeIndex::bytes(Type t) const
+{
+	size_t b = first_shard(t);
+	size_t total = 0;
+	for (size_t i = b; i < b + TYPE_INDEX_NUM_SHARDS; i++)
+	{
+		TYPE_INDEX_SHARED_LOCK(i);
+		const AtomSet* s = get_shard(i);
+		if (nullptr == s) continue;
+#if HAVE_FOLLY && USE_F14_ATOMSET
+		total += sizeof(AtomSet) + s->getAllocatedMemorySize();
+#else
+		// Each node holds the Handle, the next pointer, and the
+		// cached hash.
+		total += sizeof(AtomSet) + s->bucket_count() * sizeof(void*) +
+			s->size() * (sizeof(Handle) + 2 * sizeof(void*));
+#endif
+	}
+	return total;
+}
+
+// ================================================================
+
+void TypeIndex::enable_filter(void)
+{
+	if (_use_filter) return;
+
+	lock_all();
+	if (not _use_filter)
+	{
+		_filter.reset(new std::atomic<uint64_t>[TYPE_INDEX_FILTER_WORDS]);
+		for (size_t i = 0; i < TYPE_INDEX_FILTER_WORDS; i++)
+			_filter[i] = 0;
+		for (const auto& s : _idx)
+		{
+			if (nullptr == s) continue;
+			for (const Handle& h : *s)
+				filter_set(h->get_hash());
+		}
+		_use_filter.store(true, std::memory_order_release);
+	}
+	unlock_all();
+}
+
+// ================================================================
+
+HandleSeq TypeIndex::insertAtoms(const HandleSeq& hseq)
+{
+	size_t sz = hseq.size();
+	HandleSeq olds(sz);
+
+	// Group the atoms by shard.
+	std::vector<std::pair<size_t, size_t>> order;
+	order.reserve(sz);
+	for (size_t i = 0; i < sz; i++)
+	{
+		reserve(hseq[i]->get_type());
+		order.push_back({shard(hseq[i]), i});
+	}
+	std::sort(order.begin(), order.end());
+
+	size_t i = 0;
+	while (i < sz)
+	{
+		size_t b = order[i].first;
+		TYPE_INDEX_UNIQUE_LOCK(b);
+		Shard& s(make_shard(b));
+		for (; i < sz and order[i].first == b; i++)
+		{
+			const Handle& h(hseq[order[i].second]);
+			auto iter = s.find(h);
+			if (s.end() != iter)
+				olds[order[i].second] = *iter;
+			else
+			{
+				s.insert(h);
+				filter_add(h);
+			}
+		}
+		s.recount();
+	}
+	return olds;
+}
+
+HandleSeq TypeIndex::removeAtoms(const HandleSeq& hseq)
+{
+	size_t sz = hseq.size();
+	std::vector<bool> found(sz, false);
+
+	// Group the atoms by shard.
+	std::vector<std::pair<size_t, size_t>> order;
+	order.reserve(sz);
+	for (size_t i = 0; i < sz; i++)
+		order.push_back({shard(hseq[i]), i});
+	std::sort(order.begin(), order.end());
+
+	size_t i = 0;
+	while (i < sz)
+	{
+		size_t b = order[i].first;
+		TYPE_INDEX_UNIQUE_LOCK(b);
+		if (nullptr == get_shard(b))
+		{
+			for (; i < sz and order[i].first == b; i++) {}
+			continue;
+		}
+		Shard& s(*_idx[b]);
+		for (; i < sz and order[i].first == b; i++)
+		{
+			const Handle& h(hseq[order[i].second]);
+			if (1 != s.erase(h)) continue;
+			found[order[i].second] = true;
+		}
+		s.recount();
+	}
+
+	// In the order given.
+	HandleSeq gone;
+	for (size_t j = 0; j < sz; j++)
+		if (found[j]) gone.push_back(hseq[j]);
+	return gone;
+}
+
+// ================================================================
+
+// Copy all of the Atoms of exactly type t, one shard at a time.
+void TypeIndex::append_type(HandleSeq& hseq, Type t) const
+{
+	size_t b = first_shard(t);
+	for (size_t i = b; i < b + TYPE_INDEX_NUM_SHARDS; i++)
+	{
+		TYPE_INDEX_SHARED_LOCK(i);
+		const AtomSet* s = get_shard(i);
+		if (nullptr == s) continue;
+		for (const Handle& h : *s)
+			hseq.push_back(h);
+	}
+}
+
+void TypeIndex::append_type(HandleSet& hset, Type t) const
+{
+	size_t b = first_shard(t);
+	for (size_t i = b; i < b + TYPE_INDEX_NUM_SHARDS; i++)
+	{
+		TYPE_INDEX_SHARED_LOCK(i);
+		const AtomSet* s = get_shard(i);
+		if (nullptr == s) continue;
+		hset.insert(s->begin(), s->end());
+	}
+}
+
+void TypeIndex::append_roots(HandleSeq& hseq, Type t,
+                             const AtomSpace* cas) const
+{
+	size_t b = first_shard(t);
+	for (size_t i = b; i < b + TYPE_INDEX_NUM_SHARDS; i++)
+	{
+		TYPE_INDEX_SHARED_LOCK(i);
+		const AtomSet* s = get_shard(i);
+		if (nullptr == s) continue;
+		for (const Handle& h : *s)
+			if (h->isIncomingSetEmpty(cas))
+				hseq.push_back(h);
+	}
+}
+
+// ================================================================
+
+bool TypeIndex::foreach_handle_by_type(Type type, bool subclass,
+                 const std::function<bool(const Handle&)>& cb) const
+{
+	size_t ntypes = _num_types;
+	for (Type t = type; t<ntypes; t++)
+	{
+		if (t != type)
+		{
+			if (not subclass) break;
+			if (not _nameserver.isA(t, type)) continue;
+		}
+
+		size_t b = first_shard(t);
+		for (size_t i = b; i < b + TYPE_INDEX_NUM_SHARDS; i++)
+			if (foreach_in_shard(i, cb)) return true;
+	}
+	return false;
+}
+
+/// Walk one shard, a run of hash buckets at a time. The walk resumes
+/// at the bucket where the last chunk stopped. If the shard was
+/// rehashed meanwhile, the Atoms are in other buckets now; those that
+/// were in the buckets already walked are recognized by their hash,
+/// taken modulo the old bucket count, and skipped.
+bool TypeIndex::foreach_in_shard(size_t i,
+                 const std::function<bool(const Handle&)>& cb) const
+{
+	HandleSeq chunk;
+#if HAVE_FOLLY && USE_F14_ATOMSET
+	// F14 has no bucket interface; copy the whole shard.
+	{
+		TYPE_INDEX_SHARED_LOCK(i);
+		const AtomSet* s = get_shard(i);
+		if (nullptr == s) return false;
+		chunk.assign(s->begin(), s->end());
+	}
+	for (const Handle& h : chunk)
+		if (cb(h)) return true;
+	return false;
+#else
+	size_t next = 0;
+	size_t nbuckets = 0;
+	bool more = true;
+	while (more)
+	{
+		chunk.clear();
+		{
+			TYPE_INDEX_SHARED_LOCK(i);
+			const AtomSet* s = get_shard(i);
+			if (nullptr == s) return false;
+
+			if (0 < nbuckets and s->bucket_count() != nbuckets)
+			{
+				// Rare: take the rest of the shard at once.
+				auto hash(s->hash_function());
+				for (const Handle& h : *s)
+					if (next <= hash(h) % nbuckets) chunk.push_back(h);
+				more = false;
+			}
+			else
+			{
+				nbuckets = s->bucket_count();
+				for (; next < nbuckets and chunk.size() < TYPE_INDEX_CHUNK;
+				     next++)
+					chunk.insert(chunk.end(), s->begin(next), s->end(next));
+				more = next < nbuckets;
+			}
+		}
+		for (const Handle& h : chunk)
+			if (cb(h)) return true;
+	}
+	return false;
+#endif
 }
 
 // ================================================================
@@ -54,21 +321,16 @@ void TypeIndex::get_handles_by_type(HandleSeq& hseq,
 	// allocations and copies whenever the allocated size is exceeded.
 	hseq.reserve(initial_size + size_of_append);
 
-	TYPE_INDEX_SHARED_LOCK;
-	const AtomSet& s(_idx.at(type));
-	for (const Handle& h : s)
-		hseq.push_back(h);
+	append_type(hseq, type);
 
 	// Not subclassing? We are done!
 	if (not subclass) return;
 
-	for (Type t = ATOM; t<_num_types; t++)
+	size_t ntypes = _num_types;
+	for (Type t = ATOM; t<ntypes; t++)
 	{
 		if (t == type or not _nameserver.isA(t, type)) continue;
-
-		const AtomSet& s(_idx.at(t));
-		for (const Handle& h : s)
-			hseq.push_back(h);
+		append_type(hseq, t);
 	}
 }
 
@@ -77,19 +339,16 @@ void TypeIndex::get_handles_by_type(HandleSet& hset,
                                     Type type,
                                     bool subclass) const
 {
-	TYPE_INDEX_SHARED_LOCK;
-	const AtomSet& s(_idx.at(type));
-	hset.insert(s.begin(), s.end());
+	append_type(hset, type);
 
 	// Not subclassing? We are done!
 	if (not subclass) return;
 
-	for (Type t = ATOM; t<_num_types; t++)
+	size_t ntypes = _num_types;
+	for (Type t = ATOM; t<ntypes; t++)
 	{
 		if (t == type or not _nameserver.isA(t, type)) continue;
-
-		const AtomSet& s(_idx.at(t));
-	   hset.insert(s.begin(), s.end());
+		append_type(hset, t);
 	}
 }
 
@@ -111,25 +370,16 @@ void TypeIndex::get_rootset_by_type(HandleSeq& hseq,
 	// allocations and copies whenever the allocated size is exceeded.
 	hseq.reserve(initial_size + size_of_append);
 
-	TYPE_INDEX_SHARED_LOCK;
-	const AtomSet& s(_idx.at(type));
-	for (const Handle& h : s)
-	{
-		if (h->isIncomingSetEmpty(cas))
-			hseq.push_back(h);
-	}
+	append_roots(hseq, type, cas);
 
 	// Not subclassing? We are done!
 	if (not subclass) return;
 
-	for (Type t = ATOM; t<_num_types; t++)
+	size_t ntypes = _num_types;
+	for (Type t = ATOM; t<ntypes; t++)
 	{
 		if (t == type or not _nameserver.isA(t, type)) continue;
-
-		const AtomSet& s(_idx.at(t));
-		for (const Handle& h : s)
-			if (h->isIncomingSetEmpty(cas))
-				hseq.push_back(h);
+		append_roots(hseq, t, cas);
 	}
 }
 
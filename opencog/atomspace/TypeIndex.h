@@ -22,7 +22,11 @@
 #ifndef _OPENCOG_TYPEINDEX_H
 #define _OPENCOG_TYPEINDEX_H
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <vector>
 
 #if HAVE_FOLLY
@@ -33,6 +37,7 @@
 
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/base/LockStats.h>
 #include <opencog/atoms/atom_types/types.h>
 
 namespace opencog
@@ -51,19 +56,68 @@ namespace opencog
 //    sometimes reports the same result twice. Why? I dunno. This
 //    one failure is enough to say "not recommended." I don't need
 //    to be chasing obscure bugs.
-#if HAVE_FOLLY_XXX
-typedef folly::F14ValueSet<Handle> AtomSet;
+//
+// To try it anyway, build with -DUSE_F14_ATOMSET=1. The content-based
+// hash and equality functors are passed explicitly, so that F14 uses
+// exactly the same notion of Atom equality as std::unordered_set does,
+// instead of whatever its heterogeneous-access defaults resolve to.
+#if HAVE_FOLLY && USE_F14_ATOMSET
+typedef folly::F14ValueSet<Handle,
+                           std::hash<Handle>,
+                           std::equal_to<Handle>> AtomSet;
 #else
 typedef std::unordered_set<Handle> AtomSet;
 #endif
 
-#define TYPE_INDEX_SHARED_LOCK std::shared_lock<std::shared_mutex> lck(_mtx);
-#define TYPE_INDEX_UNIQUE_LOCK std::unique_lock<std::shared_mutex> lck(_mtx);
+// Each type bucket is split into TYPE_INDEX_NUM_SHARDS sub-sets,
+// selected by the content hash of the Atom. Each shard has its own
+// lock, so that lookups of Atoms of the same type only block behind
+// writers that happen to be touching the same shard. The number of
+// shards can be set at compile time; setting it to 1 restores a
+// single hash table per type.
+#ifndef TYPE_INDEX_NUM_SHARDS
+#define TYPE_INDEX_NUM_SHARDS 8
+#endif
+
+// Most Atoms that foreach_handle_by_type() copies out of a shard at
+// one time; the shard lock is dropped in between.
+#ifndef TYPE_INDEX_CHUNK
+#define TYPE_INDEX_CHUNK 4096
+#endif
+
+// The index is protected by an array of striped locks, one stripe
+// per shard (modulo the number of stripes). This allows Atoms
+// of different types to be added and removed concurrently, without
+// contending for a single global lock. Operations that touch every
+// bucket (resize, clear) take all of the stripes, in order.
+#define TYPE_INDEX_NUM_STRIPES 256
+#define TYPE_INDEX_STRIPE(b) _locks[(b) % TYPE_INDEX_NUM_STRIPES]
+
+// Size, in 64-bit words, of the optional content-hash filter; see
+// enable_filter() below. Two bits are set per Atom.
+#ifndef TYPE_INDEX_FILTER_WORDS
+#define TYPE_INDEX_FILTER_WORDS 4096
+#endif
+
+#define TYPE_INDEX_SHARED_LOCK(b) \
+	std::shared_lock<TypeIndexMutex> lck(TYPE_INDEX_STRIPE(b));
+#define TYPE_INDEX_UNIQUE_LOCK(b) \
+	std::unique_lock<TypeIndexMutex> lck(TYPE_INDEX_STRIPE(b));
+
+inline constexpr char type_index_lock_site[] = "TypeIndex";
+typedef LOCK_SITE_SHARED_MUTEX(type_index_lock_site) TypeIndexMutex;
 
 /**
  * Implements a vector of AtomSets; each AtomSet is a hash table of
  * Atom pointers.  Thus, given an Atom Type, this can quickly find
- * all of the Atoms of that Type.
+ * all of the Atoms of that Type. Each Type owns TYPE_INDEX_NUM_SHARDS
+ * consecutive AtomSets in the vector.
+ *
+ * Both the vector and the AtomSets are created lazily, on the first
+ * insertion, so that creating an empty index (and thus, an empty
+ * AtomSpace) is cheap. For the same reason, the index does not listen
+ * for new types being declared; the vector is grown when an Atom of
+ * an unknown type is inserted.
  *
  * The primary interface for this is an iterator, and that is because
  * the index will typically contain millions of atoms, and this is far
@@ -77,12 +131,112 @@ typedef std::unordered_set<Handle> AtomSet;
 class TypeIndex
 {
 	private:
-		std::vector<AtomSet> _idx;
-		size_t _num_types;
+		// A shard, and the number of Atoms in it. The count is written
+		// only under the shard lock, next to the table that the insert
+		// or remove has just written anyway, so keeping it costs no
+		// cache lines that are shared with other shards. It is atomic
+		// only so that size() can read it without that lock.
+		struct Shard : public AtomSet
+		{
+			std::atomic<size_t> count{0};
+			void recount(void)
+			{
+				count.store(AtomSet::size(), std::memory_order_relaxed);
+			}
+		};
+		std::vector<std::unique_ptr<Shard>> _idx;
+		std::atomic<size_t> _num_types;
 		NameServer& _nameserver;
 
-		// Single, global mutex for locking the index.
-		mutable std::shared_mutex _mtx;
+		// Striped locks; see TYPE_INDEX_STRIPE above.
+		mutable TypeIndexMutex _locks[TYPE_INDEX_NUM_STRIPES];
+
+		// Optional bloom filter over the content hashes of all Atoms
+		// ever inserted since the last clear(). Removals do not clear
+		// bits; a stale bit only costs a wasted lookup.
+		std::unique_ptr<std::atomic<uint64_t>[]> _filter;
+		std::atomic<bool> _use_filter;
+
+		static size_t filter_bit(ContentHash ch, int k)
+		{
+			return (ch >> (k * 24)) % (TYPE_INDEX_FILTER_WORDS * 64);
+		}
+		void filter_set(ContentHash ch)
+		{
+			for (int k = 0; k < 2; k++)
+			{
+				size_t b = filter_bit(ch, k);
+				_filter[b / 64].fetch_or(1ULL << (b % 64),
+				                         std::memory_order_relaxed);
+			}
+		}
+		void filter_add(const Handle& h)
+		{
+			if (_use_filter.load(std::memory_order_relaxed))
+				filter_set(h->get_hash());
+		}
+
+		// False if the Atom is certainly not in the index.
+		bool filter_maybe(const Handle& h) const
+		{
+			if (not _use_filter.load(std::memory_order_acquire))
+				return true;
+			ContentHash ch = h->get_hash();
+			for (int k = 0; k < 2; k++)
+			{
+				size_t b = filter_bit(ch, k);
+				uint64_t w = _filter[b / 64].load(std::memory_order_relaxed);
+				if (0 == (w & (1ULL << (b % 64)))) return false;
+			}
+			return true;
+		}
+
+		// Index of the first shard for type t.
+		static size_t first_shard(Type t)
+		{
+			return ((size_t) t) * TYPE_INDEX_NUM_SHARDS;
+		}
+
+		// Index of the shard holding h. Use the high bits of the
+		// hash; the low bits pick the bucket inside the shard.
+		static size_t shard(const Handle& h)
+		{
+			return first_shard(h->get_type()) +
+				(h->get_hash() >> 40) % TYPE_INDEX_NUM_SHARDS;
+		}
+
+		void lock_all(void) const;
+		void unlock_all(void) const;
+
+		// Make sure the index can hold Atoms of type t.
+		void reserve(Type t)
+		{
+			if (_num_types.load(std::memory_order_acquire) <= t)
+				resize();
+		}
+
+		// Return the shard b, or null if it was never created.
+		// Called with the shard lock held.
+		const Shard* get_shard(size_t b) const
+		{
+			if (_idx.size() <= b) return nullptr;
+			return _idx[b].get();
+		}
+
+		// Return the shard b, creating it if needed. Called with
+		// the unique shard lock held, after reserve().
+		Shard& make_shard(size_t b)
+		{
+			std::unique_ptr<Shard>& s(_idx[b]);
+			if (nullptr == s) s.reset(new Shard());
+			return *s;
+		}
+
+		void append_type(HandleSeq&, Type) const;
+		void append_type(HandleSet&, Type) const;
+		bool foreach_in_shard(size_t,
+		             const std::function<bool(const Handle&)>&) const;
+		void append_roots(HandleSeq&, Type, const AtomSpace*) const;
 	public:
 		TypeIndex(void);
 		void resize(void);
@@ -91,46 +245,80 @@ class TypeIndex
 		// Else, return nullptr
 		Handle insertAtom(const Handle& h)
 		{
-			AtomSet& s(_idx.at(h->get_type()));
-			TYPE_INDEX_UNIQUE_LOCK;
+			reserve(h->get_type());
+			size_t b = shard(h);
+			TYPE_INDEX_UNIQUE_LOCK(b);
+			Shard& s(make_shard(b));
 			auto iter = s.find(h);
 			if (s.end() != iter) return *iter;
 			s.insert(h);
+			s.recount();
+			filter_add(h);
 			return Handle::UNDEFINED;
 		}
 
+		// Insert a batch of atoms, taking each shard lock once.
+		// Returns a sequence of the same length; an entry is the
+		// already-present Atom, if there was one, else it is null.
+		HandleSeq insertAtoms(const HandleSeq&);
+
+		// Remove a batch of atoms, taking each shard lock once.
+		// Returns those that were found, and removed, in the order
+		// given.
+		HandleSeq removeAtoms(const HandleSeq&);
+
 		bool removeAtom(const Handle& h)
 		{
-			AtomSet& s(_idx.at(h->get_type()));
-			TYPE_INDEX_UNIQUE_LOCK;
-			return 1 == s.erase(h);
+			size_t b = shard(h);
+			TYPE_INDEX_UNIQUE_LOCK(b);
+			if (nullptr == get_shard(b)) return false;
+			Shard& s(*_idx[b]);
+			if (1 != s.erase(h)) return false;
+			s.recount();
+			return true;
 		}
 
 		Handle findAtom(const Handle& h) const
 		{
-			const AtomSet& s(_idx.at(h->get_type()));
-			TYPE_INDEX_SHARED_LOCK;
-			auto iter = s.find(h);
-			if (s.end() == iter) return Handle::UNDEFINED;
+			if (not filter_maybe(h)) return Handle::UNDEFINED;
+			size_t b = shard(h);
+			TYPE_INDEX_SHARED_LOCK(b);
+			const AtomSet* s = get_shard(b);
+			if (nullptr == s) return Handle::UNDEFINED;
+			auto iter = s->find(h);
+			if (s->end() == iter) return Handle::UNDEFINED;
 			return *iter;
 		}
 
-		// How many atoms are there of type t?
+		// How many atoms are there of type t? The sum of the shard
+		// counts. Each shard is looked up under its own lock, as it
+		// may be created meanwhile; the count itself needs no lock.
 		size_t size(Type t) const
 		{
-			const AtomSet& s(_idx.at(t));
-			TYPE_INDEX_SHARED_LOCK;
-			return s.size();
+			size_t b = first_shard(t);
+			size_t result = 0;
+			for (size_t i = b; i < b + TYPE_INDEX_NUM_SHARDS; i++)
+			{
+				TYPE_INDEX_SHARED_LOCK(i);
+				const Shard* s = get_shard(i);
+				if (s) result += s->count.load(std::memory_order_relaxed);
+			}
+			return result;
 		}
 
-		// How many atoms, grand total?
+		// How many atoms, grand total? Every shard count, without
+		// asking the NameServer about any of the types.
 		size_t size(void) const
 		{
-			size_t cnt = 0;
-			TYPE_INDEX_SHARED_LOCK;
-			for (const auto& s : _idx)
-				cnt += s.size();
-			return cnt;
+			size_t result = 0;
+			for (size_t i = 0; ; i++)
+			{
+				TYPE_INDEX_SHARED_LOCK(i);
+				if (_idx.size() <= i) break;
+				const Shard* s = _idx[i].get();
+				if (s) result += s->count.load(std::memory_order_relaxed);
+			}
+			return result;
 		}
 
 		// How many atoms, of type t, and subclasses also?
@@ -139,9 +327,12 @@ class TypeIndex
 			size_t result = size(type);
 			if (not subclass) return result;
 
-			for (Type t = ATOM; t<_num_types; t++)
+			// Subtypes are always declared after thier parents,
+			// so they always have a larger type number.
+			size_t ntypes = _num_types;
+			for (Type t = type+1; t<ntypes; t++)
 			{
-				if (t != type and _nameserver.isA(t, type))
+				if (_nameserver.isA(t, type))
 					result += size(t);
 			}
 			return result;
@@ -149,20 +340,45 @@ class TypeIndex
 
 		void clear(void)
 		{
-			TYPE_INDEX_UNIQUE_LOCK;
+			lock_all();
 			for (auto& s : _idx)
 			{
-				for (auto& h : s)
+				if (nullptr == s) continue;
+				for (auto& h : *s)
 				{
 					h->_atom_space = nullptr;
 
 					// We installed the incoming set; we remove it too.
 					h->remove();
 				}
-				s.clear();
+				s->clear();
+				s->recount();
 			}
+			if (_filter)
+				for (size_t i = 0; i < TYPE_INDEX_FILTER_WORDS; i++)
+					_filter[i] = 0;
+			unlock_all();
 		}
 
+		// Start maintaining the content-hash filter, which lets
+		// findAtom() reject most misses without taking any lock.
+		// Worthwhile for frames that are searched on the way down a
+		// deep stack of AtomSpaces. Calling this again does nothing.
+		void enable_filter(void);
+
+		// Estimated heap bytes of the shards holding type t: the
+		// tables, their buckets and their nodes, but not the Atoms.
+		size_t bytes(Type t) const;
+
+		// Call the callback on each Atom of the given type. The
+		// shards are visited one at a time, and copied out a chunk of
+		// at most TYPE_INDEX_CHUNK Atoms at a time; no lock is held
+		// during the callback. Return
+		// true from the callback to halt the iteration; the return
+		// value is true if the iteration was halted.
+		bool foreach_handle_by_type(Type, bool subclass,
+		             const std::function<bool(const Handle&)>&) const;
+
 		void get_handles_by_type(HandleSeq&, Type, bool subclass) const;
 		void get_handles_by_type(HandleSet&, Type, bool subclass) const;
 		void get_rootset_by_type(HandleSeq&, Type, bool subclass,
@@ -0,0 +1,136 @@
+/*
+ * opencog/atomspace/ValueColumns.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <opencog/util/exceptions.h>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/ValueFactory.h>
+
+#include "AtomSpace.h"
+#include "ValueColumns.h"
+
+using namespace opencog;
+
+ValueColumns opencog::export_values(const AtomSpace& as,
+                                    const HandleSeq& atoms,
+                                    const Handle& key, size_t width)
+{
+	if (nullptr == key)
+		throw InvalidParamException(TRACE_INFO,
+			"export_values: expecting a key");
+
+	ValueColumns cols;
+	size_t nrows = atoms.size();
+	cols.atoms = atoms;
+	cols.ids.resize(nrows);
+	cols.validity.assign((nrows + 7) / 8, 0);
+
+	// The Values are held on to, so that what was measured is what is
+	// copied, even if someone changes them in the meantime.
+	NameServer& ns(nameserver());
+	std::vector<ValuePtr> vals(nrows);
+	size_t longest = 0;
+	for (size_t i = 0; i < nrows; i++)
+	{
+		const Handle& h(atoms[i]);
+		if (nullptr == h)
+			throw InvalidParamException(TRACE_INFO,
+				"export_values: null Atom at row %zu", i);
+		cols.ids[i] = h->get_hash();
+
+		ValuePtr vp(as.get_value(h, key));
+		if (nullptr == vp or not ns.isA(vp->get_type(), FLOAT_VALUE))
+			continue;
+		const FloatValue* fv = (const FloatValue*) vp.get();
+
+		// Streams are sampled by data(); only then is size() right.
+		fv->data();
+		longest = std::max(longest, fv->size());
+		vals[i] = vp;
+		cols.validity[i / 8] |= (1 << (i % 8));
+	}
+
+	cols.width = (0 == width) ? longest : width;
+	cols.values.assign(nrows * cols.width, std::nan(""));
+	for (size_t i = 0; i < nrows; i++)
+	{
+		if (nullptr == vals[i]) continue;
+		const FloatValue* fv = (const FloatValue*) vals[i].get();
+		const double* d = fv->data();
+		size_t n = std::min(cols.width, fv->size());
+		if (0 < n)
+			std::memcpy(&cols.values[i * cols.width], d, n * sizeof(double));
+	}
+	return cols;
+}
+
+ValueColumns opencog::export_values(const AtomSpace& as, Type t,
+                                    bool subclass, const Handle& key,
+                                    size_t width)
+{
+	HandleSeq atoms;
+	as.get_handles_by_type(atoms, t, subclass);
+	return export_values(as, atoms, key, width);
+}
+
+void opencog::import_values(AtomSpace& as, const HandleSeq& atoms,
+                            const Handle& key, const double* values,
+                            size_t width, Type vtype,
+                            const uint8_t* validity)
+{
+	if (nullptr == key)
+		throw InvalidParamException(TRACE_INFO,
+			"import_values: expecting a key");
+
+	NameServer& ns(nameserver());
+	if (not ns.isA(vtype, FLOAT_VALUE))
+		throw InvalidParamException(TRACE_INFO,
+			"import_values: %s is not a kind of FloatValue",
+			ns.getTypeName(vtype).c_str());
+
+	for (size_t i = 0; i < atoms.size(); i++)
+	{
+		if (validity and 0 == (validity[i / 8] & (1 << (i % 8))))
+			continue;
+
+		const double* row = values + i * width;
+		std::vector<double> v(row, row + width);
+		ValuePtr vp(FLOAT_VALUE == vtype ?
+			createFloatValue(std::move(v)) :
+			valueserver().create(vtype, std::move(v)));
+		as.set_value(atoms[i], key, vp);
+	}
+}
+
+void opencog::import_values(AtomSpace& as, const ValueColumns& cols,
+                            const Handle& key, Type vtype)
+{
+	import_values(as, cols.atoms, key, cols.values.data(), cols.width,
+	              vtype, cols.validity.data());
+}
+
+/* ===================== END OF FILE ===================== */
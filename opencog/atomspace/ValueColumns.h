@@ -0,0 +1,97 @@
+/*
+ * opencog/atomspace/ValueColumns.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_VALUE_COLUMNS_H
+#define _OPENCOG_VALUE_COLUMNS_H
+
+#include <cstdint>
+#include <vector>
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+class AtomSpace;
+
+/**
+ * The FloatValues (or TruthValues) held under one key, by many Atoms,
+ * copied out into flat arrays, one row per Atom. The layout is that of
+ * an Arrow record batch with two columns: the ids, and a fixed-size
+ * list of doubles.
+ *
+ * `ids` are the 64-bit hashes of the Atoms, in row order. `values`
+ * holds `width` doubles per row, row after row. Rows of Atoms that hold
+ * no FloatValue under the key, or a shorter one, are padded with NaN.
+ * `validity` is a bitmap, one bit per row, lowest bit first: the bit is
+ * set if the Atom held a FloatValue under the key.
+ */
+struct ValueColumns
+{
+	HandleSeq atoms;
+	std::vector<uint64_t> ids;
+	size_t width = 0;
+	std::vector<double> values;
+	std::vector<uint8_t> validity;
+
+	size_t size(void) const { return atoms.size(); }
+	bool is_valid(size_t row) const
+	{
+		return validity[row / 8] & (1 << (row % 8));
+	}
+	const double* row(size_t r) const { return values.data() + r * width; }
+};
+
+/// Copy out the Values under `key`, as the AtomSpace sees them. If
+/// `width` is zero, then it is the length of the longest Value found;
+/// else longer Values are cut short. The TruthValues can be had with
+/// the key `(PredicateNode "*-TruthValueKey-*")`.
+ValueColumns export_values(const AtomSpace&, const HandleSeq&,
+                           const Handle& key, size_t width = 0);
+
+/// As above, for all of the Atoms of the type (and of its subtypes,
+/// if `subclass` is set).
+ValueColumns export_values(const AtomSpace&, Type, bool subclass,
+                           const Handle& key, size_t width = 0);
+
+/// The reverse of export_values(): set, on each Atom, a Value of type
+/// `vtype`, made from its row of `width` doubles. Rows whose bit in
+/// `validity` is clear are skipped; if there is no bitmap, then none
+/// are. With a TruthValue type, such as SIMPLE_TRUTH_VALUE, and the
+/// TruthValue key, this sets the TruthValues; the rows must then hold
+/// as many numbers as that kind of TruthValue has.
+void import_values(AtomSpace&, const HandleSeq&, const Handle& key,
+                   const double* values, size_t width,
+                   Type vtype = FLOAT_VALUE,
+                   const uint8_t* validity = nullptr);
+
+void import_values(AtomSpace&, const ValueColumns&, const Handle& key,
+                   Type vtype = FLOAT_VALUE);
+
+/** @}*/
+}
+
+#endif // _OPENCOG_VALUE_COLUMNS_H
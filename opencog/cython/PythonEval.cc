@@ -78,6 +78,23 @@ const char* NO_FUNCTION_NAME = "";
  */
 PythonEval* PythonEval::singletonInstance = NULL;
 
+struct PythonEval::PyFunction
+{
+    std::string name;
+
+    // Where the function was found: the module dictionary, and the
+    // name in it. All three are null until first found; they stay
+    // null for functions that are attributes of objects, since those
+    // may be bound methods, made anew on each lookup.
+    PyObject* func = nullptr;
+    PyObject* dict = nullptr;
+    PyObject* key = nullptr;
+    unsigned long generation = 0;
+};
+
+std::mutex PythonEval::_functions_mtx;
+std::map<std::string, PythonEval::PyFunction*> PythonEval::_functions;
+
 PythonEval::PythonEval()
 {
     // Check that this is the first and only PythonEval object.
@@ -86,6 +103,7 @@ PythonEval::PythonEval()
             "Can't create more than one PythonEval singleton instance!");
     }
     _paren_count = 0;
+    _generation = 0;
     // Initialize Python objects and imports.
     //
     // Strange but true: one can use the atomspace, and put atoms
@@ -117,6 +135,19 @@ PythonEval::~PythonEval()
     Py_DECREF(_pySysPath);
     Py_DECREF(_pyRootModule);
 
+    // Let go of the functions looked up so far.
+    {
+        std::lock_guard<std::mutex> lck(_functions_mtx);
+        for (auto& nf : _functions)
+        {
+            PyFunction* pf = nf.second;
+            Py_XDECREF(pf->func);
+            Py_XDECREF(pf->dict);
+            Py_XDECREF(pf->key);
+            pf->func = pf->dict = pf->key = nullptr;
+        }
+    }
+
     // Release the GIL. No Python API allowed beyond this point.
     PyGILState_Release(gstate);
 }
@@ -555,6 +586,23 @@ void PythonEval::add_to_sys_path(std::string path)
 
 const int ABSOLUTE_IMPORTS_ONLY = 0;
 
+/// Lock the module table. The GIL must be held; it is let go of while
+/// waiting, because the thread that holds the lock may need the GIL
+/// in order to finish what it is doing.
+class ModuleLock
+{
+    std::recursive_mutex& _m;
+public:
+    ModuleLock(std::recursive_mutex& m) : _m(m)
+    {
+        if (_m.try_lock()) return;
+        Py_BEGIN_ALLOW_THREADS
+        _m.lock();
+        Py_END_ALLOW_THREADS
+    }
+    ~ModuleLock() { _m.unlock(); }
+};
+
 void PythonEval::import_module(const boost::filesystem::path &file,
                                PyObject* pyFromList)
 {
@@ -596,6 +644,7 @@ void PythonEval::import_module(const boost::filesystem::path &file,
     // Add the module to our modules list. So don't decrement the
     // Python reference in this function.
     _modules[moduleName] = pyModule;
+    _generation++;
 }
 
 /**
@@ -755,6 +804,7 @@ void PythonEval::add_modules_from_abspath(std::string pathString)
     // Grab the GIL
     PyGILState_STATE gstate;
     gstate = PyGILState_Ensure();
+    ModuleLock mlck(_module_mtx);
 
     struct stat finfo;
     int stat_ret = stat(pathString.c_str(), &finfo);
@@ -793,7 +843,9 @@ PyObject* PythonEval::find_object(PyObject* pyModule,
  * Get the Python module and/or object and stripped function name, given
  * the identifier of the form '[module.][object.[attribute.]*]function'.
  */
-PyObject* PythonEval::get_function(const std::string& moduleFunction)
+PyObject* PythonEval::get_function(const std::string& moduleFunction,
+                                   PyObject** pyFoundIn,
+                                   std::string* key)
 {
     PyObject* pyModule = _pyRootModule;
     PyObject* pyObject = nullptr;
@@ -804,6 +856,7 @@ PyObject* PythonEval::get_function(const std::string& moduleFunction)
     if (0 < index)
     {
         std::string moduleName = moduleFunction.substr(0, index);
+        ModuleLock mlck(_module_mtx);
         PyObject* pyModuleTmp = _modules[moduleName];
 
         // If not found, first check that it is not an object.
@@ -872,6 +925,13 @@ PyObject* PythonEval::get_function(const std::string& moduleFunction)
 #endif
         PyObject* pyDict = PyModule_GetDict(pyModule);
         pyUserFunc = PyDict_GetItemString(pyDict, functionName.c_str());
+
+        // Tell the caller where it was found, if they want to know.
+        if (pyUserFunc and pyFoundIn)
+        {
+            *pyFoundIn = pyDict;
+            *key = functionName;
+        }
     }
     else
         pyUserFunc = PyObject_GetAttrString(pyObject, functionName.c_str());
@@ -911,7 +971,18 @@ PyObject* PythonEval::do_call_user_function(const std::string& moduleFunction,
 {
     // Get a reference to the user function.
     PyObject* pyUserFunc = get_function(moduleFunction);
+    return call_function(pyUserFunc, moduleFunction, pyArguments);
+}
 
+/**
+ * Call the user function, and store its return value. The references
+ * to both the function and the arguments are taken over.
+ * On error throws an exception.
+ */
+PyObject* PythonEval::call_function(PyObject* pyUserFunc,
+                                    const std::string& moduleFunction,
+                                    PyObject* pyArguments)
+{
     // Make sure the function is callable.
     if (!PyCallable_Check(pyUserFunc))
     {
@@ -956,8 +1027,6 @@ PyObject* PythonEval::call_user_function(const std::string& moduleFunction,
         throw RuntimeException(TRACE_INFO,
             "Expecting arguments to be a ListLink!");
 
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-
     // Grab the GIL.
     PyGILState_STATE gstate = PyGILState_Ensure();
 
@@ -989,7 +1058,6 @@ ValuePtr PythonEval::apply_v(AtomSpace * as,
                              const std::string& func,
                              Handle varargs)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
     push_context_atomspace(as);
     BOOST_SCOPE_EXIT(void) {
         pop_context_atomspace();
@@ -998,12 +1066,6 @@ ValuePtr PythonEval::apply_v(AtomSpace * as,
     // Get the python value object returned by this user function.
     PyObject *pyValue = call_user_function(func, varargs);
 
-    // If we got a non-null Value there were no errors.
-    if (NULL == pyValue)
-        throw RuntimeException(TRACE_INFO,
-            "Python function '%s' did not return Atomese!",
-            func.c_str());
-
     // Grab the GIL.
     PyGILState_STATE gstate = PyGILState_Ensure();
 
@@ -1011,6 +1073,21 @@ ValuePtr PythonEval::apply_v(AtomSpace * as,
         PyGILState_Release(gstate);
     } BOOST_SCOPE_EXIT_END
 
+    return to_value(pyValue, func);
+}
+
+/**
+ * Extract the Value from the python object returned by the function
+ * `func`, and let go of the object. The GIL must be held.
+ */
+ValuePtr PythonEval::to_value(PyObject* pyValue, const std::string& func)
+{
+    // If we got a non-null Value there were no errors.
+    if (NULL == pyValue)
+        throw RuntimeException(TRACE_INFO,
+            "Python function '%s' did not return Atomese!",
+            func.c_str());
+
     // Did we actually get a Value?
     // One way to do this would be to say
     //    PyObject *vtype = find_object("Value");
@@ -1048,6 +1125,93 @@ ValuePtr PythonEval::apply_v(AtomSpace * as,
     return vptr;
 }
 
+// ===========================================================
+
+void* PythonEval::lookup_function(const std::string& func)
+{
+    std::lock_guard<std::mutex> lck(_functions_mtx);
+    PyFunction*& pf = _functions[func];
+    if (nullptr == pf)
+    {
+        pf = new PyFunction();
+        pf->name = func;
+    }
+    return pf;
+}
+
+/**
+ * Return a new reference to the function, found the fast way if the
+ * module dictionary still holds the one found last time, else looked
+ * up anew. The GIL must be held.
+ */
+PyObject* PythonEval::resolve_function(PyFunction* pf)
+{
+    unsigned long gen = _generation;
+    if (pf->func and pf->generation == gen and
+        PyDict_GetItem(pf->dict, pf->key) == pf->func)
+    {
+        Py_INCREF(pf->func);
+        return pf->func;
+    }
+
+    PyObject* pyDict = nullptr;
+    std::string key;
+    PyObject* pyUserFunc = get_function(pf->name, &pyDict, &key);
+
+    // Swap in the new, before letting go of the old: the decrefs can
+    // run python code, which might let another thread in here.
+    PyObject* oldFunc = pf->func;
+    PyObject* oldDict = pf->dict;
+    PyObject* oldKey = pf->key;
+    pf->func = pf->dict = pf->key = nullptr;
+    if (pyDict)
+    {
+        Py_INCREF(pyUserFunc);
+        Py_INCREF(pyDict);
+        pf->func = pyUserFunc;
+        pf->dict = pyDict;
+        pf->key = PyUnicode_InternFromString(key.c_str());
+        pf->generation = gen;
+    }
+    Py_XDECREF(oldFunc);
+    Py_XDECREF(oldDict);
+    Py_XDECREF(oldKey);
+
+    return pyUserFunc;
+}
+
+/**
+ * Apply the function found by lookup_function() to the args, and
+ * return the extracted Value.
+ */
+ValuePtr PythonEval::apply_function(AtomSpace* as, void* func,
+                                    const HandleSeq& args)
+{
+    PyFunction* pf = (PyFunction*) func;
+
+    push_context_atomspace(as);
+    BOOST_SCOPE_EXIT(void) {
+        pop_context_atomspace();
+    } BOOST_SCOPE_EXIT_END
+
+    // Grab the GIL.
+    PyGILState_STATE gstate = PyGILState_Ensure();
+
+    BOOST_SCOPE_EXIT(&gstate) {
+        PyGILState_Release(gstate);
+    } BOOST_SCOPE_EXIT_END
+
+    PyObject* pyUserFunc = resolve_function(pf);
+
+    size_t nargs = args.size();
+    PyObject* pyArguments = PyTuple_New(nargs);
+    for (size_t i=0; i<nargs; i++)
+        PyTuple_SetItem(pyArguments, i, py_atom(args[i]));
+
+    PyObject* pyValue = call_function(pyUserFunc, pf->name, pyArguments);
+    return to_value(pyValue, pf->name);
+}
+
 /**
  * Call the user defined function with the provide atomspace argument.
  * This is a cut-n-paste of PythonEval::call_user_function but with
@@ -1058,8 +1222,6 @@ ValuePtr PythonEval::apply_v(AtomSpace * as,
 void PythonEval::apply_as(const std::string& moduleFunction,
                           AtomSpace* as_argument)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-
     // Grab the GIL.
     PyGILState_STATE gstate = PyGILState_Ensure();
 
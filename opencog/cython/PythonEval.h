@@ -40,6 +40,7 @@
 
 #include "PyIncludeWrapper.h"
 
+#include <atomic>
 #include <condition_variable>
 #include <map>
 #include <mutex>
@@ -82,9 +83,28 @@ class PythonEval : public GenericEval
         void print_dictionary(PyObject*);
         PyObject* find_object(PyObject* pyModule,
                               const std::string& objectName);
-        PyObject* get_function(const std::string& moduleFunction);
+        PyObject* get_function(const std::string& moduleFunction,
+                               PyObject** pyDict = nullptr,
+                               std::string* key = nullptr);
         PyObject* do_call_user_function(const std::string& moduleFunction,
                                         PyObject* pyArguments);
+        PyObject* call_function(PyObject* pyUserFunc,
+                                const std::string& moduleFunction,
+                                PyObject* pyArguments);
+        ValuePtr to_value(PyObject* pyValue, const std::string& func);
+
+        // Functions looked up by lookup_function(). The entries are
+        // never freed, as the runners holding them may outlive this
+        // evaluator; the python objects they hold are released by the
+        // destructor, and looked up anew by the next evaluator.
+        struct PyFunction;
+        static std::mutex _functions_mtx;
+        static std::map<std::string, PyFunction*> _functions;
+        PyObject* resolve_function(PyFunction*);
+
+        // Bumped whenever a module is (re-)imported, so that functions
+        // found in an older copy of it are looked up again.
+        std::atomic<unsigned long> _generation;
 
         // Call functions; execute scripts.
         PyObject* call_user_function(const std::string& func,
@@ -98,19 +118,30 @@ class PythonEval : public GenericEval
         // Single-threaded design.
         static PythonEval* singletonInstance;
 
-        // Single, global mutex for serializing access to the atomspace.
-        // The singleton-instance design of this class forces us to
-        // serialize access (the GIL is not enough), because there is
-        // no way to guarantee that python won't accidentally be called
-        // from multiple threads.  That's because the EvaluationLink
-        // is called from scheme and from the pattern engine, and its
-        // unknown how many threads those things might be running in.
-        // The lock is recursive, because we may need to use multiple
-        // different atomspaces with the evaluator, in some nested
-        // fashion. So this lock prevents other threads from using the
-        // wrong atomspace in some other thread.  Quite unfortunate.
+        // Single, global mutex for serializing the interactive
+        // evaluator: the shell (eval_expr, poll_result) and the
+        // execution of scripts share one set of result buffers.
+        // The lock is recursive, because a script may call back into
+        // the evaluator, in some nested fashion.
+        //
+        // Calls to grounded functions (apply_v, apply_as) do not take
+        // this lock; they need only the GIL. The context atomspace is
+        // per-thread, so several threads may each be in a different
+        // grounded function at the same time; python switches between
+        // them whenever one of them lets go of the GIL (e.g. in I/O,
+        // or in numpy).
+        //
+        // This lock is always taken before the GIL, never after. The
+        // cython wrappers for execution, evaluation and scheme release
+        // the GIL before calling in to C++, so that a python thread in
+        // there does not hold the GIL while it waits for this lock.
         static std::recursive_mutex _mtx;
 
+        // Guards _modules. Modules are loaded on demand, by whichever
+        // thread first asks for a function in them, and loading runs
+        // python code, during which the GIL may pass to other threads.
+        std::recursive_mutex _module_mtx;
+
         // Computed results are typically polled in a distinct thread.
         bool _eval_done;
         std::mutex _poll_mtx;
@@ -170,6 +201,25 @@ class PythonEval : public GenericEval
         virtual ValuePtr apply_v(AtomSpace * as, const std::string& func,
                          Handle varargs);
 
+        /**
+         * Look up the Python function `func`, for repeated calls with
+         * apply_function(). That skips the parsing of the name and the
+         * walk through the modules that apply_v() does on every call.
+         * The function itself is found on the first call. After that,
+         * it is called directly, for as long as the module dictionary
+         * still maps the name to it. Redefining or reloading it is seen,
+         * as before. Never returns null.
+         */
+        virtual void* lookup_function(const std::string& func);
+
+        /**
+         * Calls the function obtained from lookup_function(), passing
+         * it the `args`, one python Atom each, with no ListLink around
+         * them.
+         */
+        virtual ValuePtr apply_function(AtomSpace* as, void* func,
+                                        const HandleSeq& args);
+
         /**
          * Calls the Python function passed in `func`, passing it
          * the `varargs` as an argument, and returning a Handle.
@@ -3,6 +3,7 @@ from libcpp.vector cimport vector
 from libcpp.memory cimport shared_ptr
 from libcpp.set cimport set as cpp_set
 from libcpp.string cimport string
+from libc.stdint cimport uint8_t, uint64_t
 from cython.operator cimport dereference as deref
 
 
@@ -169,6 +170,13 @@ cdef extern from "opencog/atoms/base/Handle.h" namespace "opencog":
 # HandleSeq
     cdef cppclass cHandleSeq "opencog::HandleSeq"
 
+# Atoms that are not (yet) in any AtomSpace.
+cdef extern from "opencog/atoms/base/Node.h" namespace "opencog":
+    cdef cHandle c_create_node "opencog::createNode" (Type t, string s) except +
+
+cdef extern from "opencog/atoms/base/Link.h" namespace "opencog":
+    cdef cHandle c_create_link "opencog::createLink" (vector[cHandle] oset, Type t) except +
+
 cdef class Atom(Value):
     cdef cHandle* handle
     cdef object _atom_type
@@ -195,24 +203,44 @@ cdef extern from "opencog/atomspace/AtomSpace.h" namespace "opencog":
         cHandle xadd_link(Type t, vector[cHandle]) except +
         cHandle add_link(Type t, vector[cHandle], tv_ptr tvn) except +
 
+        vector[cHandle] add_atoms(const vector[cHandle]&) nogil except +
+
         cHandle get_handle(Type t, string s)
         cHandle get_handle(Type t, vector[cHandle])
 
         cHandle set_value(cHandle h, cHandle key, cValuePtr value)
         cHandle set_truthvalue(cHandle h, tv_ptr tvn)
+        cHandle increment_count(cHandle h, cHandle key, size_t ref, double delta) except +
+        cHandle increment_countTV(cHandle h, double delta) except +
         cHandle get_atom(cHandle & h)
         bint is_valid_handle(cHandle h)
         int get_size()
 
         # ==== query methods ====
         # get by type
-        void get_handles_by_type(vector[cHandle], Type t, bint subclass)
+        void get_handles_by_type(vector[cHandle], Type t, bint subclass) nogil
 
         void clear()
         bint extract_atom(cHandle h, bint recursive)
 
     cdef cValuePtr createAtomSpace(cAtomSpace *parent)
 
+cdef extern from "opencog/atomspace/ValueColumns.h" namespace "opencog":
+    cdef cppclass cValueColumns "opencog::ValueColumns":
+        vector[cHandle] atoms
+        vector[uint64_t] ids
+        size_t width
+        vector[double] values
+        vector[uint8_t] validity
+
+    cValueColumns export_values(const cAtomSpace&, const vector[cHandle]&,
+                                const cHandle& key, size_t width) nogil except +
+    cValueColumns export_values(const cAtomSpace&, Type, bint subclass,
+                                const cHandle& key, size_t width) nogil except +
+    void import_values(cAtomSpace&, const vector[cHandle]&, const cHandle& key,
+                       const double* values, size_t width, Type vtype,
+                       const uint8_t* validity) nogil except +
+
 
 cdef AtomSpace_factory(cAtomSpace *to_wrap)
 cdef AtomSpace_factoid(cValuePtr to_wrap)
@@ -233,6 +261,7 @@ cdef extern from "opencog/atoms/value/FloatValue.h" namespace "opencog":
         cFloatValue(double value)
         cFloatValue(const vector[double]& values)
         const vector[double]& value() const
+        size_t size() const
 
 
 # StringValue
@@ -2,6 +2,9 @@ from libcpp cimport bool
 from libcpp.set cimport set as cpp_set
 from libcpp.vector cimport vector
 from cython.operator cimport dereference as deref, preincrement as inc
+from libc.string cimport memcpy
+from cpython cimport array
+import array
 
 # from atomspace cimport *
 
@@ -140,6 +143,55 @@ cdef class AtomSpace(Value):
             atom.tv = tv
         return atom
 
+    def add_atoms(self, nodes, links=(), as_value=False):
+        """ Add many atoms at once, with a single call in to C++.
+        `nodes` is a list of (type, name) pairs, and `links` is a list
+        of (type, outgoing) pairs. Each entry in an outgoing list is
+        either an Atom, or an int; an int is the position of an atom
+        earlier in this same batch, counting the nodes first, and then
+        the links.
+        @returns a list of the added atoms, in the same order. With
+        as_value=True, a single LinkValue holding them is returned
+        instead, so that no Atom objects need be made at all.
+        """
+        if self.atomspace == NULL:
+            return None
+        cdef vector[cHandle] batch
+        cdef vector[cHandle] oset
+        cdef Type t
+        cdef Py_ssize_t idx
+        batch.reserve(len(nodes) + len(links))
+        for (t, name) in nodes:
+            batch.push_back(c_create_node(t, name.encode('UTF-8')))
+        for (t, outgoing) in links:
+            oset.clear()
+            for o in outgoing:
+                if isinstance(o, Atom):
+                    oset.push_back(deref((<Atom>o).handle))
+                    continue
+                idx = o
+                if idx < 0 or <size_t>idx >= batch.size():
+                    raise IndexError(
+                        "No atom at {} earlier in the batch".format(idx))
+                oset.push_back(batch[idx])
+            batch.push_back(c_create_link(oset, t))
+
+        cdef cAtomSpace* c_as = self.atomspace
+        cdef vector[cHandle] added
+        with nogil:
+            added = c_as.add_atoms(batch)
+
+        cdef shared_ptr[cLinkValue] c_ptr
+        cdef vector[cValuePtr] vals
+        cdef cHandle h
+        if as_value:
+            vals.reserve(added.size())
+            for h in added:
+                vals.push_back(<cValuePtr&>h)
+            c_ptr.reset(new cLinkValue(vals))
+            return LinkValue(PtrHolder.create(<shared_ptr[void]&>c_ptr))
+        return convert_handle_seq_to_python_list(added)
+
     def is_valid(self, atom):
         """ Check whether the passed handle refers to an actual atom
         """
@@ -190,6 +242,91 @@ cdef class AtomSpace(Value):
             return None
         self.atomspace.set_truthvalue(deref(atom.handle), deref(tv._tvptr()))
 
+    def increment_count(self, Atom atom, Atom key, double delta, size_t ref = 0):
+        """ Add delta to the ref'th number of the FloatValue at key.
+        The read and the write are done as one step, so that counts
+        kept from several threads are never lost.
+        """
+        if self.atomspace == NULL:
+            return None
+        self.atomspace.increment_count(deref(atom.handle), deref(key.handle),
+                                       ref, delta)
+
+    def increment_count_tv(self, Atom atom, double delta):
+        """ Add delta to the count of the truth value on atom, making
+        it a CountTruthValue, if it is not one already.
+        """
+        if self.atomspace == NULL:
+            return None
+        self.atomspace.increment_countTV(deref(atom.handle), delta)
+
+    def export_values(self, Atom key, atoms, size_t width = 0):
+        """ Copy out the FloatValues (or TruthValues) under key, held by
+        atoms, which is either a list of atoms, or an atom type (taken
+        with its subtypes). Returns a tuple (atoms, ids, values, width):
+        the ids are the 64-bit hashes of the atoms, as an array('Q'),
+        and values is an array('d') of len(atoms) * width doubles, one
+        row per atom, with NaN where an atom has no value, or a shorter
+        one. If width is zero, it is that of the longest value. As a
+        matrix, without a copy:
+
+            numpy.asarray(values).reshape(-1, width)
+        """
+        if self.atomspace == NULL:
+            return None
+        cdef cAtomSpace* c_as = self.atomspace
+        cdef cHandle c_key = deref(key.handle)
+        cdef vector[cHandle] handles
+        cdef Type t
+        cdef cValueColumns cols
+        if isinstance(atoms, int):
+            t = atoms
+            with nogil:
+                cols = export_values(deref(c_as), t, True, c_key, width)
+        else:
+            handles = atom_list_to_vector(list(atoms))
+            with nogil:
+                cols = export_values(deref(c_as), handles, c_key, width)
+
+        cdef array.array ids = array.clone(array.array('Q'), cols.ids.size(), False)
+        cdef array.array vals = array.clone(array.array('d'), cols.values.size(), False)
+        if 0 < cols.ids.size():
+            memcpy(ids.data.as_voidptr, cols.ids.data(),
+                   cols.ids.size() * sizeof(uint64_t))
+        if 0 < cols.values.size():
+            memcpy(vals.data.as_voidptr, cols.values.data(),
+                   cols.values.size() * sizeof(double))
+        return (convert_handle_seq_to_python_list(cols.atoms), ids, vals,
+                cols.width)
+
+    def import_values(self, Atom key, atoms, values, Type vtype = 0):
+        """ The reverse of export_values(): set, on each of the atoms, a
+        value under key, made from its row of values. The values are any
+        C-contiguous buffer of doubles, such as an array('d') or a
+        float64 numpy array, of len(atoms) rows. The value type is
+        FloatValue by default; with SimpleTruthValue, and the key
+        PredicateNode("*-TruthValueKey-*"), the truth values are set.
+        """
+        if self.atomspace == NULL:
+            return None
+        if 0 == vtype:
+            vtype = types.FloatValue
+        cdef vector[cHandle] handles = atom_list_to_vector(list(atoms))
+        if 0 == handles.size():
+            return None
+        cdef const double[::1] view = memoryview(values).cast('B').cast('d')
+        if view.shape[0] % handles.size() != 0:
+            raise ValueError("Expecting {} rows of values, got {} numbers"
+                .format(handles.size(), view.shape[0]))
+        cdef size_t width = view.shape[0] // handles.size()
+        cdef const double* data = NULL
+        if 0 < width:
+            data = &view[0]
+        cdef cAtomSpace* c_as = self.atomspace
+        cdef cHandle c_key = deref(key.handle)
+        with nogil:
+            import_values(deref(c_as), handles, c_key, data, width, vtype, NULL)
+
     # Methods to make the atomspace act more like a standard Python container
     def __contains__(self, atom):
         """ Custom checker to see if object is in AtomSpace """
@@ -226,7 +363,9 @@ cdef class AtomSpace(Value):
             return None
         cdef vector[cHandle] handle_vector
         cdef bint subt = subtype
-        self.atomspace.get_handles_by_type(handle_vector,t,subt)
+        cdef cAtomSpace* c_as = self.atomspace
+        with nogil:
+            c_as.get_handles_by_type(handle_vector,t,subt)
         return convert_handle_seq_to_python_list(handle_vector)
 
     @classmethod
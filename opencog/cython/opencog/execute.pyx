@@ -7,22 +7,31 @@ from cython.operator cimport dereference as deref
 
 from opencog.type_constructors import TruthValue
 
+# Execution and evaluation may run for a long time, and do not touch
+# any python objects, so the GIL is released while they run; other
+# python threads run meanwhile. Any python grounded functions that
+# get called will take the GIL back, in PythonEval.
+
 
 def execute_atom(AtomSpace atomspace, Atom atom):
     if atom is None:
         raise ValueError("execute_atom atom is: None")
-    cdef cValuePtr c_value_ptr = c_execute_atom(
-        atomspace.atomspace, deref(atom.handle)
-    )
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_h = deref(atom.handle)
+    cdef cValuePtr c_value_ptr
+    with nogil:
+        c_value_ptr = c_execute_atom(c_as, c_h)
     return create_python_value_from_c_value(c_value_ptr)
 
 
 def evaluate_atom(AtomSpace atomspace, Atom atom):
     if atom is None:
         raise ValueError("evaluate_atom atom is: None")
-    cdef tv_ptr result_tv_ptr = c_evaluate_atom(
-        atomspace.atomspace, deref(atom.handle)
-    )
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_h = deref(atom.handle)
+    cdef tv_ptr result_tv_ptr
+    with nogil:
+        result_tv_ptr = c_evaluate_atom(c_as, c_h)
     cdef cTruthValue* result_tv = result_tv_ptr.get()
     cdef strength_t strength = deref(result_tv).get_mean()
     cdef confidence_t confidence = deref(result_tv).get_confidence()
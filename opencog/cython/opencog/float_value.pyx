@@ -1,18 +1,63 @@
+from cpython.buffer cimport PyObject_CheckBuffer, PyBUF_WRITABLE, PyBUF_FORMAT
+from libc.stdlib cimport malloc, free
 
 def createFloatValue(arg):
     cdef shared_ptr[cFloatValue] c_ptr
     if (isinstance(arg, list)):
         c_ptr.reset(new cFloatValue(FloatValue.list_of_doubles_to_vector(arg)))
+    elif PyObject_CheckBuffer(arg) and 0 < memoryview(arg).ndim:
+        c_ptr.reset(new cFloatValue(FloatValue.buffer_of_doubles_to_vector(arg)))
     else:
         c_ptr.reset(new cFloatValue(<double>arg))
     return FloatValue(PtrHolder.create(<shared_ptr[void]&>c_ptr))
 
 cdef class FloatValue(Value):
+    """
+    A vector of doubles. Besides to_list(), the numbers may be read
+    without copying them, through the buffer protocol:
+
+        numpy.asarray(value)   # A read-only view, not a copy.
+        memoryview(value)
+
+    A FloatValue can be made from any contiguous one-dimensional
+    buffer of doubles, such as a float64 numpy array, in one copy.
+    """
 
     def to_list(self):
         return FloatValue.vector_of_doubles_to_list(
             &((<cFloatValue*>self.get_c_value_ptr().get()).value()))
 
+    # FloatValues never change, so the view can point straight at the
+    # C++ vector; the view holds a reference to this object, which
+    # keeps the vector alive for as long as the view is.
+    def __getbuffer__(self, Py_buffer* buffer, int flags):
+        if flags & PyBUF_WRITABLE:
+            raise BufferError("FloatValue is read-only")
+
+        cdef const vector[double]* vec = \
+            &((<cFloatValue*>self.get_c_value_ptr().get()).value())
+        cdef Py_ssize_t* shape = <Py_ssize_t*> malloc(sizeof(Py_ssize_t))
+        if shape == NULL:
+            raise MemoryError()
+        shape[0] = (<cFloatValue*>self.get_c_value_ptr().get()).size()
+
+        buffer.buf = <void*> vec.data()
+        buffer.obj = self
+        buffer.len = shape[0] * sizeof(double)
+        buffer.readonly = 1
+        buffer.itemsize = sizeof(double)
+        buffer.format = NULL
+        if flags & PyBUF_FORMAT:
+            buffer.format = 'd'
+        buffer.ndim = 1
+        buffer.shape = shape
+        buffer.strides = NULL
+        buffer.suboffsets = NULL
+        buffer.internal = shape
+
+    def __releasebuffer__(self, Py_buffer* buffer):
+        free(buffer.internal)
+
     @staticmethod
     cdef vector[double] list_of_doubles_to_vector(list python_list):
         cdef vector[double] cpp_vector
@@ -21,6 +66,14 @@ cdef class FloatValue(Value):
             cpp_vector.push_back(value)
         return cpp_vector
 
+    @staticmethod
+    cdef vector[double] buffer_of_doubles_to_vector(object buf):
+        cdef const double[::1] view = buf
+        cdef vector[double] cpp_vector
+        if 0 < view.shape[0]:
+            cpp_vector.assign(&view[0], &view[0] + view.shape[0])
+        return cpp_vector
+
     @staticmethod
     cdef list vector_of_doubles_to_list(const vector[double]* cpp_vector):
         list = []
@@ -29,4 +82,3 @@ cdef class FloatValue(Value):
             list.append(deref(it))
             inc(it)
         return list
-
@@ -8,6 +8,9 @@ functionality, see:
     tests/cython/guile/test_pattern.py
 
 Also refer to the list of .scm type definition files in opencog.conf
+
+The GIL is released while scheme runs, so that other python threads
+can run at the same time.
 """
 
 from cython.operator cimport dereference as deref
@@ -25,7 +28,7 @@ cdef extern from "<string>" namespace "std":
         int size()
 
 cdef extern from "opencog/cython/opencog/PyScheme.h" namespace "opencog":
-    string eval_scheme(cAtomSpace* as, const string& s) except +
+    string eval_scheme(cAtomSpace* as, const string& s) nogil except +
 
 def scheme_eval(AtomSpace a, str pys):
     """Evaluate Scheme program and return string.
@@ -41,11 +44,13 @@ def scheme_eval(AtomSpace a, str pys):
     cdef string expr
     expr = pys.encode('UTF-8')
     # print "Debug: called scheme eval with atomspace {0:x}".format(<unsigned long int>a.atomspace)
-    ret = eval_scheme(a.atomspace, expr)
+    cdef cAtomSpace* c_as = a.atomspace
+    with nogil:
+        ret = eval_scheme(c_as, expr)
     return ret.c_str()
 
 cdef extern from "opencog/cython/opencog/PyScheme.h" namespace "opencog":
-    cValuePtr eval_scheme_v(cAtomSpace* as, const string& s) except +
+    cValuePtr eval_scheme_v(cAtomSpace* as, const string& s) nogil except +
 
 def scheme_eval_v(AtomSpace a, str pys):
     """Evaluate Scheme program when expected result is Value.
@@ -60,11 +65,13 @@ def scheme_eval_v(AtomSpace a, str pys):
     cdef cValuePtr ret
     cdef string expr
     expr = pys.encode('UTF-8')
-    ret = eval_scheme_v(a.atomspace, expr)
+    cdef cAtomSpace* c_as = a.atomspace
+    with nogil:
+        ret = eval_scheme_v(c_as, expr)
     return Value.create(ret)
 
 cdef extern from "opencog/cython/opencog/PyScheme.h" namespace "opencog":
-    cHandle eval_scheme_h(cAtomSpace* as, const string& s) except +
+    cHandle eval_scheme_h(cAtomSpace* as, const string& s) nogil except +
 
 def scheme_eval_h(AtomSpace a, str pys):
     """Evaluate Scheme program when expected result is Handle.
@@ -79,11 +86,13 @@ def scheme_eval_h(AtomSpace a, str pys):
     cdef cHandle ret
     cdef string expr
     expr = pys.encode('UTF-8')
-    ret = eval_scheme_h(a.atomspace, expr)
+    cdef cAtomSpace* c_as = a.atomspace
+    with nogil:
+        ret = eval_scheme_h(c_as, expr)
     return Atom.createAtom(ret)
 
 cdef extern from "opencog/cython/opencog/PyScheme.h" namespace "opencog":
-    cAtomSpace* eval_scheme_as(const string& s) except +
+    cAtomSpace* eval_scheme_as(const string& s) nogil except +
 
 def scheme_eval_as(str pys):
     """Evaluate Scheme program when expected result is AtomSpace.
@@ -98,13 +107,18 @@ def scheme_eval_as(str pys):
     cdef cAtomSpace* ret
     cdef string expr
     expr = pys.encode('UTF-8')
-    ret = eval_scheme_as(expr)
+    with nogil:
+        ret = eval_scheme_as(expr)
     return AtomSpace_factory(ret)
 
 cdef extern from "opencog/cython/opencog/load-file.h" namespace "opencog":
-    int load_scm_file_relative (cAtomSpace& as, char* filename) except +
+    int load_scm_file_relative (cAtomSpace& as, char* filename) nogil except +
 
 def load_scm(AtomSpace a, str fname):
     fname_tmp = fname.encode('UTF-8')
-    status = load_scm_file_relative(deref(a.atomspace), fname_tmp)
+    cdef char* c_fname = fname_tmp
+    cdef cAtomSpace* c_as = a.atomspace
+    cdef int status
+    with nogil:
+        status = load_scm_file_relative(deref(c_as), c_fname)
     return status == 0
@@ -2,6 +2,9 @@ cdef class FloatValue(Value):
     @staticmethod
     cdef vector[double] list_of_doubles_to_vector(list python_list)
 
+    @staticmethod
+    cdef vector[double] buffer_of_doubles_to_vector(object buf)
+
     @staticmethod
     cdef list vector_of_doubles_to_list(const vector[double]* cpp_vector)
 
@@ -23,6 +23,7 @@
  */
 
 #include <atomic>
+#include <map>
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -85,6 +86,7 @@ void SchemeEval::init(void)
 	_captured_stack = scm_gc_protect_object(_captured_stack);
 
 	_pexpr = NULL;
+	_pproc = SCM_BOOL_F;
 	_eval_done = true;
 	_poll_done = true;
 
@@ -117,7 +119,6 @@ void SchemeEval::capture_port(void)
 	// Try again, under the lock this time.
 	if (_in_server) return;
 	_in_server = true;
-	_in_redirect = 1;
 
 	// When running in the cogserver, this pipe will become the output
 	// port.  Scheme code will be writing into one end of it, while, in a
@@ -338,6 +339,11 @@ void SchemeEval::per_thread_init(void)
 
 SchemeEval::~SchemeEval()
 {
+	if (_async_thread.joinable())
+	{
+		interrupt();
+		_async_thread.join();
+	}
 	scm_with_guile(c_wrap_finish, this);
 }
 
@@ -933,6 +939,129 @@ void * SchemeEval::c_wrap_interrupt(void* p)
 
 /* ============================================================== */
 
+namespace {
+
+/// The printed output of the evaluations started with eval_async() is
+/// collected by this one thread, shared by all evaluators. It wakes up
+/// every so often, and reads the output pipe of each running eval.
+/// The output pipes are non-blocking, so this never waits on any one
+/// of them.
+class OutputPump
+{
+	std::mutex _mtx;
+	std::condition_variable _cv;
+	std::map<void*, std::function<void(void)>> _running;
+	std::thread _thr;
+	bool _stop;
+
+	void loop(void)
+	{
+		std::unique_lock<std::mutex> lck(_mtx);
+		while (not _stop)
+		{
+			_cv.wait_for(lck, std::chrono::milliseconds(100));
+			for (auto& pr : _running) pr.second();
+		}
+	}
+
+public:
+	OutputPump(void) : _stop(false)
+	{
+		_thr = std::thread(&OutputPump::loop, this);
+	}
+	~OutputPump()
+	{
+		{
+			std::lock_guard<std::mutex> lck(_mtx);
+			_stop = true;
+		}
+		_cv.notify_all();
+		_thr.join();
+	}
+
+	void add(void* key, std::function<void(void)> pump)
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_running[key] = pump;
+	}
+
+	/// Once this returns, the pump for `key` is not running, and
+	/// it will not be run again.
+	void remove(void* key)
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_running.erase(key);
+	}
+};
+
+OutputPump& output_pump(void)
+{
+	static OutputPump pump;
+	return pump;
+}
+
+}
+
+void * SchemeEval::c_wrap_capture(void* p)
+{
+	SchemeEval* self = (SchemeEval*) p;
+	self->capture_port();
+	return self;
+}
+
+/**
+ * eval_async() - evaluate in the background, reporting by callback.
+ *
+ * Returns at once. The expression is evaluated in a new thread, just
+ * as eval_expr() would; meanwhile, any printed output is passed to
+ * `on_output`, as it shows up. When the evaluation is done, `on_done`
+ * is called with the rest of the output, and the printed value of the
+ * expression, or the error message; the flag is true if there was an
+ * error. If the expression is incomplete, `on_done` gets the empty
+ * string, and the expression is kept, to be completed by the next
+ * eval, exactly as with poll_result().
+ */
+void SchemeEval::eval_async(const std::string& expr,
+                            OutputCB on_output, DoneCB on_done)
+{
+	// Only one at a time.
+	wait_async();
+
+	// Set up the output pipe now, so that the pump has something to
+	// read from, right from the start.
+	scm_with_guile(c_wrap_capture, this);
+
+	begin_eval();
+	output_pump().add(this, [this, on_output]()
+	{
+		std::string out = poll_port();
+		if (0 < out.size()) on_output(out);
+	});
+
+	_async_thread = std::thread([this, expr, on_done]()
+	{
+		eval_expr(expr);
+
+		// The pump must be done with this evaluator, before the last
+		// of the output is collected here; else the two of them might
+		// hand it back out of order.
+		output_pump().remove(this);
+		bool err = _caught_error;
+		std::string rest = poll_result();
+		on_done(rest, err);
+	});
+}
+
+/// Block until the async evaluation, if any, has finished, and its
+/// `on_done` callback has returned.
+void SchemeEval::wait_async(void)
+{
+	if (_async_thread.joinable())
+		_async_thread.join();
+}
+
+/* ============================================================== */
+
 SCM recast_scm_eval_string(void * expr)
 {
 	return scm_eval_string((SCM)expr);
@@ -1064,6 +1193,18 @@ static SCM thunk_scm_eval(void * expr)
 SCM SchemeEval::do_apply_scm(const std::string& func, const Handle& varargs )
 {
 	SCM sfunc = scm_from_utf8_symbol(func.c_str());
+	SCM expr = scm_cons(sfunc, args_to_scm(varargs));
+
+	// TODO: it would be nice to pass exceptions on through, but
+	// this currently breaks unit tests.
+	// if (_in_eval)
+	//    return scm_eval(expr, scm_interaction_environment());
+	return do_scm_eval(expr, thunk_scm_eval);
+}
+
+/// The arguments in the ListLink, as a scheme list.
+SCM SchemeEval::args_to_scm(const Handle& varargs)
+{
 	SCM expr = SCM_EOL;
 
 	// If there were args, pass the args to the function.
@@ -1083,13 +1224,26 @@ SCM SchemeEval::do_apply_scm(const std::string& func, const Handle& varargs )
 			expr = scm_cons(sh, expr);
 		}
 	}
-	expr = scm_cons(sfunc, expr);
+	return expr;
+}
 
-	// TODO: it would be nice to pass exceptions on through, but
-	// this currently breaks unit tests.
-	// if (_in_eval)
-	//    return scm_eval(expr, scm_interaction_environment());
-	return do_scm_eval(expr, thunk_scm_eval);
+/// The car is the variable holding the procedure; the cdr, its args.
+/// The variable is dereferenced here, so that an unbound variable is
+/// caught like any other error.
+static SCM thunk_scm_apply(void * expr)
+{
+	SCM proc = scm_variable_ref(scm_car((SCM)expr));
+	return scm_apply_0(proc, scm_cdr((SCM)expr));
+}
+
+/**
+ * do_apply_proc -- like do_apply_scm(), but with the procedure already
+ * looked up, by lookup_procedure(). Nothing is evaluated; the
+ * procedure is called directly.
+ */
+SCM SchemeEval::do_apply_proc(SCM var, const Handle& varargs)
+{
+	return do_scm_eval(scm_cons(var, args_to_scm(varargs)), thunk_scm_apply);
 }
 
 /* ============================================================== */
@@ -1105,11 +1259,25 @@ SCM SchemeEval::do_apply_scm(const std::string& func, const Handle& varargs )
  */
 ValuePtr SchemeEval::apply_v(const std::string &func, Handle varargs)
 {
+	return apply_proc(nullptr, func, varargs);
+}
+
+/**
+ * apply_proc -- as apply_v(), but calling a procedure obtained from
+ * lookup_procedure(). If `proc` is null, the function is looked up by
+ * name, as apply_v() does.
+ */
+ValuePtr SchemeEval::apply_proc(void* proc, const std::string &func,
+                                Handle varargs)
+{
+	SCM var = proc ? SCM_PACK_POINTER(proc) : SCM_BOOL_F;
+
 	// If we are recursing, then we already are in the guile
 	// environment, and don't need to do any additional setup.
 	// Just go.
 	if (_in_eval) {
-		SCM smob = do_apply_scm(func, varargs);
+		SCM smob = proc ? do_apply_proc(var, varargs) :
+			do_apply_scm(func, varargs);
 		if (eval_error())
 		{
 			// Rethrow.  It would be better to just allow exceptions
@@ -1122,11 +1290,13 @@ ValuePtr SchemeEval::apply_v(const std::string &func, Handle varargs)
 	}
 
 	_pexpr = &func;
+	_pproc = var;
 	_hargs = varargs;
 	_in_eval = true;
 	scm_with_guile(c_wrap_apply_v, this);
 	_in_eval = false;
 	_hargs = nullptr;
+	_pproc = SCM_BOOL_F;
 
 	if (eval_error())
 		throw RuntimeException(TRACE_INFO, "Unable to apply `%s` to\n%s\n%s",
@@ -1144,12 +1314,44 @@ ValuePtr SchemeEval::apply_v(const std::string &func, Handle varargs)
 void * SchemeEval::c_wrap_apply_v(void * p)
 {
 	SchemeEval *self = (SchemeEval *) p;
-	SCM smob = self->do_apply_scm(*self->_pexpr, self->_hargs);
+	SCM smob = scm_is_false(self->_pproc) ?
+		self->do_apply_scm(*self->_pexpr, self->_hargs) :
+		self->do_apply_proc(self->_pproc, self->_hargs);
 	if (self->eval_error()) return self;
 	self->_retval = SchemeSmob::scm_to_protom(smob);
 	return self;
 }
 
+/// Find the variable bound to the name, in the same environment that
+/// apply_v() would evaluate the name in.
+void * SchemeEval::c_wrap_lookup(void * p)
+{
+	SchemeEval *self = (SchemeEval *) p;
+	SCM sym = scm_from_utf8_symbol(self->_pexpr->c_str());
+	SCM var = scm_module_variable(scm_interaction_environment(), sym);
+	if (scm_is_false(var) or scm_is_false(scm_variable_bound_p(var)))
+	{
+		self->_pproc = SCM_BOOL_F;
+		return self;
+	}
+	self->_pproc = scm_gc_protect_object(var);
+	return self;
+}
+
+void* SchemeEval::lookup_procedure(const std::string& func)
+{
+	_pexpr = &func;
+	if (_in_eval)
+		c_wrap_lookup(this);
+	else
+		scm_with_guile(c_wrap_lookup, this);
+
+	SCM var = _pproc;
+	_pproc = SCM_BOOL_F;
+	if (scm_is_false(var)) return nullptr;
+	return SCM_UNPACK_POINTER(var);
+}
+
 /* ============================================================== */
 
 // A pool of scheme evaluators, sitting hot and ready to go.
@@ -1158,12 +1360,14 @@ void * SchemeEval::c_wrap_apply_v(void * p)
 // delete() is because calling delete() from TLS conflicts with
 // the guile garbage collector, when the thread is destroyed. See
 // the note below.
+//
+// The stack is thread-safe by itself; no further lock is needed.
+// In particular, new evaluators are not made under a lock, as that
+// would serialize threads on the (slow) guile init.
 static concurrent_stack<SchemeEval*> pool;
-static std::mutex pool_mtx;
 
 static SchemeEval* get_from_pool(void)
 {
-	std::lock_guard<std::mutex> lock(pool_mtx);
 	SchemeEval* ev = NULL;
 	if (pool.try_pop(ev)) return ev;
 	return new SchemeEval();
@@ -1172,7 +1376,6 @@ static SchemeEval* get_from_pool(void)
 static void return_to_pool(SchemeEval* ev)
 {
 	ev->clear_pending();
-	std::lock_guard<std::mutex> lock(pool_mtx);
 
 	// try..catch is needed during library exit; the stack may
 	// already be gone. So just ignore the resulting exception.
@@ -1231,6 +1434,36 @@ SchemeEval* SchemeEval::get_evaluator(AtomSpacePtr& as)
 	return get_evaluator((AtomSpace*) as.get());
 }
 
+/// Return the evaluator for grounded functions, for this thread.
+///
+/// The pattern matcher, and others, run GroundedSchemaNodes and
+/// GroundedPredicateNodes in a fresh, transient atomspace for nearly
+/// every call. Were get_evaluator() used, each of those would need its
+/// own evaluator, and making one is slow. Instead, the one evaluator
+/// is re-pointed at the atomspace of each call. This is safe even when
+/// the calls nest, because do_scm_eval() reads `_atomspace` only on
+/// the way in, and puts back the previous one on the way out.
+///
+SchemeEval* SchemeEval::get_grounded_evaluator(AtomSpace* as)
+{
+	// See the note on the eval_dtor in get_evaluator(), above.
+	class grounded_dtor {
+		public:
+		SchemeEval* evaluator = nullptr;
+		~grounded_dtor() {
+			if (nullptr == evaluator) return;
+			evaluator->_atomspace = NULL;
+			return_to_pool(evaluator);
+		}
+	};
+	static thread_local grounded_dtor grounded;
+
+	if (nullptr == grounded.evaluator)
+		grounded.evaluator = get_from_pool();
+	grounded.evaluator->_atomspace = as;
+	return grounded.evaluator;
+}
+
 /* ============================================================== */
 
 void* SchemeEval::c_wrap_set_atomspace(void * vas)
@@ -1268,6 +1501,11 @@ opencog::SchemeEval* get_scheme_evaluator(opencog::AtomSpace* as)
 	return opencog::SchemeEval::get_evaluator(as);
 }
 
+opencog::SchemeEval* get_grounded_scheme_evaluator(opencog::AtomSpace* as)
+{
+	return opencog::SchemeEval::get_grounded_evaluator(as);
+}
+
 };
 
 
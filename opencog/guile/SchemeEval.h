@@ -25,8 +25,10 @@
 #ifdef HAVE_GUILE
 
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <sstream>
 #include <cstddef>
 #include <libguile.h>
@@ -72,6 +74,16 @@ namespace opencog {
  *      std::string eval(const std::string& expr)
  *         { begin_eval(); eval_expr(expr); return poll_result(); }
  *
+ * Lastly, there is a callback interface, eval_async(), that returns
+ * right away. The evaluation runs in a thread of its own; printed
+ * output is handed to the `on_output` callback as it appears, and,
+ * when the evaluation finishes, `on_done` gets whatever is left,
+ * together with a flag saying if there was an error. The printed
+ * output of all the evaluators running this way is collected by one
+ * shared thread, and so the caller does not need to dedicate a thread
+ * to each session; it only has to keep its callbacks short. An
+ * evaluation in progress can be cancelled with interrupt(). Only one
+ * async evaluation per evaluator may be running at a time.
  */
 
 class AtomSpace;
@@ -107,6 +119,10 @@ class SchemeEval : public GenericEval
 		static void * c_wrap_eval(void *);
 		static void * c_wrap_poll(void *);
 
+		// The callback-driven evaluation.
+		std::thread _async_thread;
+		static void * c_wrap_capture(void *);
+
 		// Support for interruption from a shell.
 		SCM _eval_thread;
 		static void * c_wrap_interrupt(void *);
@@ -131,8 +147,12 @@ class SchemeEval : public GenericEval
 		Handle _hargs;
 		ValuePtr _retval;
 		AtomSpace* _retas;
+		SCM _pproc;
+		static SCM args_to_scm(const Handle& varargs);
 		SCM do_apply_scm(const std::string& func, const Handle& varargs);
+		SCM do_apply_proc(SCM var, const Handle& varargs);
 		static void * c_wrap_apply_v(void *);
+		static void * c_wrap_lookup(void *);
 
 		// Exception and error handling stuff
 		SCM _scm_error_string;
@@ -169,12 +189,29 @@ class SchemeEval : public GenericEval
 		static SchemeEval* get_evaluator(AtomSpace* = NULL);
 		static SchemeEval* get_evaluator(AtomSpacePtr&);
 
+		// Return the per-thread evaluator for grounded functions,
+		// pointed at the given atomspace. There is only one per
+		// thread, no matter how many atomspaces it is used with, so
+		// getting it takes no locks, and it is made only once. Do
+		// not hold on to it; get it again for each call.
+		static SchemeEval* get_grounded_evaluator(AtomSpace*);
+
 		// The async-output interface.
 		void begin_eval(void);
 		void eval_expr(const std::string&);
 		std::string poll_result(void);
 		void interrupt(void);
 
+		// The callback interface. Both callbacks are called from
+		// threads other than the caller's: `on_output` from the
+		// thread that collects printed output, `on_done` from the
+		// thread that ran the evaluation.
+		typedef std::function<void(const std::string&)> OutputCB;
+		typedef std::function<void(const std::string&, bool)> DoneCB;
+		void eval_async(const std::string&, OutputCB on_output,
+		                DoneCB on_done);
+		void wait_async(void);
+
 		// The synchronous-output interfaces.
 		std::string eval(const std::string& expr)
 			{ begin_eval(); eval_expr(expr); return poll_result(); }
@@ -203,6 +240,16 @@ class SchemeEval : public GenericEval
 		TruthValuePtr apply_tv(const std::string& func, Handle varargs) {
 			return TruthValueCast(apply_v(func, varargs)); }
 
+		// Look up the named procedure once, for repeated calls with
+		// apply_proc(), which then skips the symbol lookup and eval
+		// that apply_v() does on every call. What is returned is the
+		// scheme variable bound to the name, protected from GC, so
+		// later redefinitions are seen. Returns nullptr if the name
+		// is not defined. `func` is used only for error messages.
+		virtual void* lookup_procedure(const std::string& func);
+		virtual ValuePtr apply_proc(void* proc, const std::string& func,
+		                            Handle varargs);
+
 		// Nested invocations
 		bool recursing(void) { return _in_eval; }
 };
@@ -213,6 +260,7 @@ class SchemeEval : public GenericEval
 extern "C" {
 	// For shared-library loading
 	opencog::SchemeEval* get_scheme_evaluator(opencog::AtomSpace*);
+	opencog::SchemeEval* get_grounded_scheme_evaluator(opencog::AtomSpace*);
 };
 
 #endif/* HAVE_GUILE */
@@ -300,6 +300,7 @@ void SchemeSmob::register_procs()
 	// Value API
 	register_proc("cog-value->list",       1, 0, 0, C(ss_value_to_list));
 	register_proc("cog-value-ref",         2, 0, 0, C(ss_value_ref));
+	register_proc("cog-value-size",        1, 0, 0, C(ss_value_size));
 
 	// Generic property setter on atoms
 	register_proc("cog-set-value!",        3, 0, 0, C(ss_set_value));
@@ -322,6 +323,8 @@ void SchemeSmob::register_procs()
 	register_proc("cog-outgoing-set",      1, 0, 0, C(ss_outgoing_set));
 	register_proc("cog-outgoing-by-type",  2, 0, 0, C(ss_outgoing_by_type));
 	register_proc("cog-outgoing-atom",     2, 0, 0, C(ss_outgoing_atom));
+	register_proc("cog-incoming-vector",   1, 1, 0, C(ss_incoming_vector));
+	register_proc("cog-outgoing-vector",   1, 0, 0, C(ss_outgoing_vector));
 	register_proc("cog-keys",              1, 0, 0, C(ss_keys));
 	register_proc("cog-keys->alist",       1, 0, 0, C(ss_keys_alist));
 	register_proc("cog-value",             2, 0, 0, C(ss_value));
@@ -354,7 +357,16 @@ void SchemeSmob::register_procs()
 
 	// Taking AtomSpace as optional argument
 	register_proc("cog-count-atoms",       1, 1, 0, C(ss_count));
+	register_proc("cog-report-memory",     0, 1, 0, C(ss_as_memory));
+	register_proc("cog-report-locks",      0, 1, 0, C(ss_lock_stats));
+	register_proc("cog-trace",             1, 0, 0, C(ss_trace));
+	register_proc("cog-trace-flush",       0, 1, 0, C(ss_trace_flush));
+	register_proc("cog-slow-query-log",    1, 2, 0, C(ss_slow_query_log));
+	register_proc("cog-slow-queries",      0, 0, 0, C(ss_slow_queries));
+	register_proc("cog-slow-query-export", 0, 1, 0, C(ss_slow_query_export));
 	register_proc("cog-map-type",          2, 1, 0, C(ss_map_type));
+	register_proc("cog-atoms-vector",      1, 1, 0, C(ss_atoms_vector));
+	register_proc("cog-atom-seq",          1, 1, 0, C(ss_atom_seq));
 
 	// Value types
 	register_proc("cog-get-types",         0, 0, 0, C(ss_get_types));
@@ -86,6 +86,8 @@ private:
 	static bool scm_is_protom(SCM);
 
 	static SCM handle_to_scm(const Handle&);
+	static SCM handle_seq_to_scm(const HandleSeq&);
+	static SCM handle_seq_to_vector(const HandleSeq&);
 	static SCM protom_to_scm(const ValuePtr&);
 	static Handle scm_to_handle(SCM);
 	static ValuePtr scm_to_protom(SCM);
@@ -121,6 +123,7 @@ private:
 	// Access the list encoded in a value
 	static SCM ss_value_to_list(SCM);
 	static SCM ss_value_ref(SCM, SCM);
+	static SCM ss_value_size(SCM);
 
 	// Property setters on atoms
 	static SCM ss_set_tv(SCM, SCM);
@@ -148,6 +151,10 @@ private:
 	static SCM ss_outgoing_set(SCM);
 	static SCM ss_outgoing_by_type(SCM, SCM);
 	static SCM ss_outgoing_atom(SCM, SCM);
+	static SCM ss_incoming_vector(SCM, SCM);
+	static SCM ss_outgoing_vector(SCM);
+	static SCM ss_atoms_vector(SCM, SCM);
+	static SCM ss_atom_seq(SCM, SCM);
 
 	// Type query functions
 	static SCM ss_map_type(SCM, SCM, SCM);
@@ -177,6 +184,13 @@ private:
 	static SCM ss_as_readonly_p(SCM);
 	static SCM ss_as_mark_cow(SCM, SCM);
 	static SCM ss_as_cow_p(SCM);
+	static SCM ss_as_memory(SCM);
+	static SCM ss_lock_stats(SCM);
+	static SCM ss_trace(SCM);
+	static SCM ss_trace_flush(SCM);
+	static SCM ss_slow_query_log(SCM, SCM, SCM);
+	static SCM ss_slow_queries(void);
+	static SCM ss_slow_query_export(SCM);
 	static SCM make_as(AtomSpace *);
 	static AtomSpace* ss_to_atomspace(SCM);
 
@@ -9,7 +9,12 @@
 #include <cstddef>
 #include <libguile.h>
 
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/LockStats.h>
+#include <opencog/atoms/base/Trace.h>
+#include <opencog/atoms/execution/QueryLog.h>
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspace/MemoryReport.h>
 #include <opencog/guile/SchemeSmob.h>
 #include <opencog/util/oc_assert.h>
 
@@ -142,6 +147,166 @@ SCM SchemeSmob::ss_as_cow_p(SCM sas)
 	return SCM_BOOL_F;
 }
 
+/* ============================================================== */
+/**
+ * Return an association list of the estimated memory use of the
+ * atomspace, per atom type.  If no atomspace specified, then report
+ * on the current atomspace.
+ */
+SCM SchemeSmob::ss_as_memory(SCM sas)
+{
+	AtomSpace* as = ss_to_atomspace(sas);
+	scm_remember_upto_here_1(sas);
+	if (nullptr == as) as = ss_get_env_as("cog-report-memory");
+
+	auto entry = [](const char* name, size_t n)
+	{
+		return scm_cons(scm_from_utf8_symbol(name), scm_from_size_t(n));
+	};
+
+	std::vector<TypeMemory> rpt(MemoryReport::report(*as));
+	SCM list = SCM_EOL;
+	for (size_t i = rpt.size(); i > 0; i--)
+	{
+		const TypeMemory& tm(rpt[i-1]);
+		SCM row = scm_list_n(
+			entry("count", tm.count),
+			entry("bytes", tm.total()),
+			entry("atoms", tm.atoms),
+			entry("names", tm.names),
+			entry("outgoing", tm.outgoing),
+			entry("values", tm.values),
+			entry("payloads", tm.payloads),
+			entry("incoming", tm.incoming),
+			entry("index", tm.index),
+			SCM_UNDEFINED);
+		const std::string& tname = nameserver().getTypeName(tm.type);
+		list = scm_cons(scm_cons(scm_from_utf8_symbol(tname.c_str()), row),
+		                list);
+	}
+	return list;
+}
+
+/* ============================================================== */
+/**
+ * Return the lock statistics, as a printable table, and start
+ * counting afresh, if asked to.
+ */
+SCM SchemeSmob::ss_lock_stats(SCM sreset)
+{
+	std::string rpt(LockSite::report());
+	if (not SCM_UNBNDP(sreset) and scm_is_true(sreset))
+		LockSite::reset_all();
+	return scm_from_utf8_string(rpt.c_str());
+}
+
+/* ============================================================== */
+/**
+ * Start or stop recording trace spans. Returns the previous state.
+ */
+SCM SchemeSmob::ss_trace(SCM sflag)
+{
+	bool was = Tracer::is_running();
+	if (scm_is_true(sflag))
+	{
+		if (not Tracer::compiled_in())
+			scm_misc_error("cog-trace",
+				"Tracing was not compiled in; configure with -DTRACE=ON",
+				SCM_EOL);
+		Tracer::start();
+	}
+	else
+		Tracer::stop();
+	return scm_from_bool(was);
+}
+
+/**
+ * Write out the trace spans recorded so far, and empty the buffers.
+ * With a file name, write them there and return how many there were;
+ * otherwise, return the trace itself, as a string.
+ */
+SCM SchemeSmob::ss_trace_flush(SCM sfile)
+{
+	if (SCM_UNBNDP(sfile))
+		return scm_from_utf8_string(Tracer::flush().c_str());
+
+	std::string filename(verify_string(sfile, "cog-trace-flush", 1));
+	try
+	{
+		return scm_from_size_t(Tracer::flush(filename));
+	}
+	catch (const std::exception& ex)
+	{
+		throw_exception(ex, "cog-trace-flush", sfile);
+	}
+}
+
+/* ============================================================== */
+/**
+ * Turn the slow-query log on, with a threshold in seconds, or off,
+ * if the threshold is #f.
+ */
+SCM SchemeSmob::ss_slow_query_log(SCM sthresh, SCM scap, SCM ssample)
+{
+	if (scm_is_false(sthresh))
+	{
+		query_log().disable();
+		return SCM_BOOL_T;
+	}
+
+	double thresh = scm_to_double(sthresh);
+	size_t cap = 100;
+	if (not SCM_UNBNDP(scap)) cap = scm_to_size_t(scap);
+	size_t sample = 1;
+	if (not SCM_UNBNDP(ssample)) sample = scm_to_size_t(ssample);
+
+	query_log().enable(thresh, cap, sample);
+	return SCM_BOOL_T;
+}
+
+/**
+ * Return the slow-query log, as a list of association lists, oldest
+ * first.
+ */
+SCM SchemeSmob::ss_slow_queries(void)
+{
+	auto entry = [](const char* name, SCM v)
+	{
+		return scm_cons(scm_from_utf8_symbol(name), v);
+	};
+
+	std::vector<QueryRecord> recs(query_log().records());
+	SCM list = SCM_EOL;
+	for (size_t i = recs.size(); i > 0; i--)
+	{
+		const QueryRecord& rec(recs[i-1]);
+		SCM stats = rec.stats ? protom_to_scm(rec.stats) : SCM_EOL;
+		SCM row = scm_list_n(
+			entry("query", handle_to_scm(rec.query)),
+			entry("source", scm_from_utf8_string(rec.source.c_str())),
+			entry("seconds", scm_from_double(rec.seconds)),
+			entry("results", scm_from_size_t(rec.results)),
+			entry("time", scm_from_long(rec.when)),
+			entry("stats", stats),
+			SCM_UNDEFINED);
+		list = scm_cons(row, list);
+	}
+	return list;
+}
+
+/**
+ * Move the slow-query log into the atomspace, for storage.  If no
+ * atomspace specified, then use the current atomspace.
+ */
+SCM SchemeSmob::ss_slow_query_export(SCM sas)
+{
+	AtomSpace* as = ss_to_atomspace(sas);
+	scm_remember_upto_here_1(sas);
+	if (nullptr == as) as = ss_get_env_as("cog-slow-query-export");
+
+	return handle_seq_to_scm(query_log().export_to(as));
+}
+
 /* ============================================================== */
 /**
  * Set the readonly flag of the atomspace.  If no atomspace specified,
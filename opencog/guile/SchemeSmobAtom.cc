@@ -27,6 +27,7 @@
 #include <libguile.h>
 
 #include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/value/LinkValue.h>
 #include <opencog/atoms/value/Value.h>
 #include <opencog/atoms/core/NumberNode.h>
 #include <opencog/atoms/core/FindUtils.h>
@@ -121,6 +122,10 @@ SCM SchemeSmob::ss_arity (SCM satom)
 SCM SchemeSmob::ss_tv (SCM satom)
 {
 	Handle h = verify_handle(satom, "cog-tv");
+
+	// Go through the atomspace, so that value overlays are seen.
+	AtomSpace* as = ss_get_env_as("cog-tv");
+	if (as) return protom_to_scm(ValueCast(as->get_truthvalue(h)));
 	return protom_to_scm(ValueCast(h->getTruthValue()));
 }
 
@@ -178,23 +183,11 @@ SCM SchemeSmob::ss_set_tv (SCM satom, SCM stv)
 // Converts existing truth value to a CountTruthValue.
 SCM SchemeSmob::ss_inc_count (SCM satom, SCM scnt)
 {
-	static std::mutex count_mtx;
-
 	Handle h = verify_handle(satom, "cog-inc-count!");
 	double cnt = verify_real(scnt, "cog-inc-count!", 2);
 
-	// Lock so that count updates are atomic!
-	std::lock_guard<std::mutex> lck(count_mtx);
-	TruthValuePtr tv = h->getTruthValue();
-	if (COUNT_TRUTH_VALUE == tv->get_type())
-	{
-		cnt += tv->get_count();
-	}
-	tv = CountTruthValue::createTV(
-		tv->get_mean(), tv->get_confidence(), cnt);
-
 	AtomSpace* as = ss_get_env_as("cog-inc-count!");
-	Handle ha(as->set_truthvalue(h, tv));
+	Handle ha(as->increment_countTV(h, cnt));
 	if (ha == h)
 		return satom;
 	return handle_to_scm(ha);
@@ -208,33 +201,13 @@ SCM SchemeSmob::ss_inc_count (SCM satom, SCM scnt)
 // ref == list-ref, which location to increment.
 SCM SchemeSmob::ss_inc_value (SCM satom, SCM skey, SCM scnt, SCM sref)
 {
-	static std::mutex incr_mtx;
-
 	Handle h = verify_handle(satom, "cog-inc-value!");
 	Handle key = verify_handle(skey, "cog-inc-value!", 2);
 	double cnt = verify_real(scnt, "cog-inc-value!", 3);
 	size_t ref = verify_size_t(sref, "cog-inc-value!", 4);
 
-	std::vector<double> new_value;
-
-	// Lock so that count updates are atomic!
-	std::lock_guard<std::mutex> lck(incr_mtx);
-
-	ValuePtr v = h->getValue(key);
-	if (nullptr != v and FLOAT_VALUE == v->get_type())
-	{
-		FloatValuePtr fv(FloatValueCast(v));
-		new_value = fv->value();
-		if (new_value.size() <= ref) new_value.resize(ref+1, 0.0);
-	}
-	else
-	{
-		new_value.resize(ref+1, 0.0);
-	}
-	new_value[ref] += cnt;
-
 	AtomSpace* as = ss_get_env_as("cog-inc-value!");
-	Handle ha(as->set_value(h, key, createFloatValue(new_value)));
+	Handle ha(as->increment_count(h, key, ref, cnt));
 	if (ha == h)
 		return satom;
 	return handle_to_scm(ha);
@@ -250,16 +223,19 @@ SCM SchemeSmob::ss_outgoing_set (SCM satom)
 
 	if (not h->is_link()) return SCM_EOL;
 
-	const HandleSeq& oset = h->getOutgoingSet();
+	return handle_seq_to_scm(h->getOutgoingSet());
+}
 
-	SCM list = SCM_EOL;
-	for (size_t i = oset.size(); i > 0; i--)
-	{
-		SCM smob = handle_to_scm(oset[i-1]);
-		list = scm_cons (smob, list);
-	}
+/**
+ * As above, but return a vector, instead of a list.
+ */
+SCM SchemeSmob::ss_outgoing_vector (SCM satom)
+{
+	Handle h = verify_handle(satom, "cog-outgoing-vector");
 
-	return list;
+	if (not h->is_link()) return scm_c_make_vector(0, SCM_BOOL_F);
+
+	return handle_seq_to_vector(h->getOutgoingSet());
 }
 
 /* ============================================================== */
@@ -328,6 +304,20 @@ SCM SchemeSmob::ss_incoming_set (SCM satom, SCM aspace)
 	return head;
 }
 
+/**
+ * Return the incoming set of an atom as a vector.
+ */
+SCM SchemeSmob::ss_incoming_vector (SCM satom, SCM aspace)
+{
+	Handle h = verify_handle(satom, "cog-incoming-vector");
+
+	AtomSpace* as = ss_to_atomspace(aspace);
+	if (nullptr == as)
+		as = ss_get_env_as("cog-incoming-vector");
+
+	return handle_seq_to_vector(h->getIncomingSet(as));
+}
+
 /* ============================================================== */
 /**
  * Convert the incoming set of an atom into a list; return the list.
@@ -401,27 +391,60 @@ SCM SchemeSmob::ss_map_type (SCM proc, SCM stype, SCM aspace)
 	if (nullptr == atomspace)
 		atomspace = ss_get_env_as("cog-map-type");
 
-	// Get all of the handles of the indicated type
-	HandleSeq hset;
-	atomspace->get_handles_by_type(hset, t);
-
-	// Loop over all handles in the handle set.
-	// Call proc on each handle, in turn.
+	// Loop over all handles of the indicated type, without copying
+	// them all out first. Call proc on each handle, in turn.
 	// Break out of the loop if proc returns anything other than #f
-	for (const Handle& h : hset) {
+	SCM rc = SCM_BOOL_F;
+	atomspace->foreach_handle_by_type(t, false,
+		[&](const Handle& h) -> bool {
+
+			// In case h got removed from the atomspace during the
+			// iteration. This may happen either externally or by
+			// proc itself (such as cog-extract-recursive)
+			if (not h->getAtomSpace() and not (ATOM_SPACE == h->get_type()))
+				return false;
+
+			SCM smob = handle_to_scm(h);
+			rc = scm_call_1(proc, smob);
+			return not scm_is_false(rc);
+		});
+
+	return rc;
+}
 
-		// In case h got removed from the atomspace between
-		// get_handles_by_type call and now. This may happen either
-		// externally or by proc itself (such as cog-extract-recursive)
-		if (not h->getAtomSpace() and not (ATOM_SPACE == h->get_type()))
-			continue;
+/* ============================================================== */
 
-		SCM smob = handle_to_scm(h);
-		SCM rc = scm_call_1(proc, smob);
-		if (!scm_is_false(rc)) return rc;
-	}
+/**
+ * Return all atoms of type stype, in a vector.
+ */
+SCM SchemeSmob::ss_atoms_vector (SCM stype, SCM aspace)
+{
+	Type t = verify_type (stype, "cog-atoms-vector");
 
-	return SCM_BOOL_F;
+	AtomSpace* atomspace = ss_to_atomspace(aspace);
+	if (nullptr == atomspace)
+		atomspace = ss_get_env_as("cog-atoms-vector");
+
+	HandleSeq hs;
+	atomspace->get_handles_by_type(hs, t);
+	return handle_seq_to_vector(hs);
+}
+
+/**
+ * Return all atoms of type stype, in a LinkValue. Nothing is converted
+ * into scheme until it is asked for, one at a time, with cog-value-ref.
+ */
+SCM SchemeSmob::ss_atom_seq (SCM stype, SCM aspace)
+{
+	Type t = verify_type (stype, "cog-atom-seq");
+
+	AtomSpace* atomspace = ss_to_atomspace(aspace);
+	if (nullptr == atomspace)
+		atomspace = ss_get_env_as("cog-atom-seq");
+
+	HandleSeq hs;
+	atomspace->get_handles_by_type(hs, t);
+	return protom_to_scm(createLinkValue(std::move(hs)));
 }
 
 /* ============================================================== */
@@ -82,6 +82,27 @@ SCM SchemeSmob::handle_to_scm (const Handle& h)
 	return protom_to_scm(AtomCast(h));
 }
 
+/// Convert a sequence of Atoms to a scheme list, in the same order.
+SCM SchemeSmob::handle_seq_to_scm (const HandleSeq& hs)
+{
+	SCM list = SCM_EOL;
+	for (size_t i = hs.size(); i > 0; i--)
+		list = scm_cons(handle_to_scm(hs[i-1]), list);
+	return list;
+}
+
+/// Convert a sequence of Atoms to a scheme vector. The vector is
+/// allocated once, at its full size; there are no pairs to make, nor
+/// to collect afterwards.
+SCM SchemeSmob::handle_seq_to_vector (const HandleSeq& hs)
+{
+	size_t sz = hs.size();
+	SCM vec = scm_c_make_vector(sz, SCM_BOOL_F);
+	for (size_t i = 0; i < sz; i++)
+		SCM_SIMPLE_VECTOR_SET(vec, i, handle_to_scm(hs[i]));
+	return vec;
+}
+
 SCM SchemeSmob::protom_to_scm (const ValuePtr& pa)
 {
 	if (nullptr == pa) return SCM_BOOL_F;
@@ -26,6 +26,8 @@
 
 #include <opencog/atoms/core/NumberNode.h>
 #include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/Float32Value.h>
+#include <opencog/atoms/value/IntValue.h>
 #include <opencog/atoms/value/LinkValue.h>
 #include <opencog/atoms/value/StringValue.h>
 #include <opencog/atoms/value/RandomStream.h>
@@ -227,6 +229,14 @@ ValuePtr SchemeSmob::make_value (Type t, SCM svalue_list)
 		return valueserver().create(t, valist);
 	}
 
+	// The factories narrow the list to single floats or to integers.
+	if (FLOAT32_VALUE == t or INT_VALUE == t)
+	{
+		std::vector<double> valist;
+		valist = verify_float_list(svalue_list, "cog-new-value", 2);
+		return valueserver().create(t, valist);
+	}
+
 	if (nameserver().isA(t, LINK_VALUE))
 	{
 		std::vector<ValuePtr> valist;
@@ -331,7 +341,7 @@ SCM SchemeSmob::ss_set_value (SCM satom, SCM skey, SCM svalue)
 		{
 			verify_protom(sitem, "cog-set-value!", 3);
 			std::vector<ValuePtr> fl = scm_to_protom_list(svalue);
-			pa = createLinkValue(fl);
+			pa = createLinkValue(std::move(fl));
 		}
 		else
 		{
@@ -417,6 +427,9 @@ SCM SchemeSmob::ss_value (SCM satom, SCM skey)
 
 	try
 	{
+		// Go through the atomspace, so that value overlays are seen.
+		AtomSpace* as = ss_get_env_as("cog-value");
+		if (as) return protom_to_scm(as->get_value(atom, key));
 		return protom_to_scm(atom->getValue(key));
 	}
 	catch (const std::exception& ex)
@@ -506,6 +519,18 @@ SCM SchemeSmob::ss_value_to_list (SCM svalue)
 		CPPL_TO_SCML(v, scm_from_double)
 	}
 
+	if (FLOAT32_VALUE == t)
+	{
+		const std::vector<float>& v = Float32ValueCast(pa)->value();
+		CPPL_TO_SCML(v, scm_from_double)
+	}
+
+	if (INT_VALUE == t)
+	{
+		const std::vector<int64_t>& v = IntValueCast(pa)->value();
+		CPPL_TO_SCML(v, scm_from_int64)
+	}
+
 	if (STRING_VALUE == t)
 	{
 		const std::vector<std::string>& v = StringValueCast(pa)->value();
@@ -550,6 +575,18 @@ SCM SchemeSmob::ss_value_ref (SCM svalue, SCM sindex)
 		if (index < v.size()) return scm_from_double(v[index]);
 	}
 
+	if (FLOAT32_VALUE == t)
+	{
+		const std::vector<float>& v = Float32ValueCast(pa)->value();
+		if (index < v.size()) return scm_from_double(v[index]);
+	}
+
+	if (INT_VALUE == t)
+	{
+		const std::vector<int64_t>& v = IntValueCast(pa)->value();
+		if (index < v.size()) return scm_from_int64(v[index]);
+	}
+
 	if (nameserver().isA(t, STRING_VALUE))
 	{
 		const std::vector<std::string>& v = StringValueCast(pa)->value();
@@ -594,4 +631,25 @@ SCM SchemeSmob::ss_value_ref (SCM svalue, SCM sindex)
 	return SCM_EOL;
 }
 
+/**
+ * The number of entries that cog-value-ref can get at; the same as
+ * (length (cog-value->list VALUE)), but without making the list.
+ */
+SCM SchemeSmob::ss_value_size (SCM svalue)
+{
+	ValuePtr pa(verify_protom(svalue, "cog-value-size"));
+	Type t = pa->get_type();
+
+	if (nameserver().isA(t, LINK))
+		return scm_from_size_t(AtomCast(pa)->get_arity());
+
+	if (nameserver().isA(t, NUMBER_NODE))
+		return scm_from_size_t(NumberNodeCast(pa)->value().size());
+
+	if (nameserver().isA(t, NODE))
+		return scm_from_size_t(1);
+
+	return scm_from_size_t(pa->size());
+}
+
 /* ===================== END OF FILE ============================ */
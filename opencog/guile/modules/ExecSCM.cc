@@ -31,6 +31,7 @@ void opencog_exec_init(void);
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atoms/execution/EvaluationLink.h>
 #include <opencog/atoms/execution/Instantiator.h>
+#include <opencog/atoms/execution/QueryLog.h>
 #include <opencog/guile/SchemeModule.h>
 
 // ========================================================
@@ -43,7 +44,9 @@ using namespace opencog;
 static ValuePtr ss_execute(AtomSpace* atomspace, const Handle& h)
 {
 	Instantiator inst(atomspace);
+	QueryProbe probe(h, "cog-execute!");
 	ValuePtr pap(inst.execute(h));
+	probe.done(pap);
 #if LATER
 	if (pap == h)
 	{
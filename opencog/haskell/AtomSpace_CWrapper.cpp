@@ -4,6 +4,7 @@
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/base/Node.h>
+#include <opencog/persist/sexpr/Snapshot.h>
 #include <opencog/util/exceptions.h>
 
 AtomSpace* AtomSpace_new( AtomSpace* parent_ptr )
@@ -138,6 +139,55 @@ int AtomSpace_getAtomByHandle( AtomSpace* this_ptr
     }
 }
 
+int AtomSpace_encodeAtoms( AtomSpace* this_ptr
+                         , const Handle** atoms
+                         , int size
+                         , char** buf_out
+                         , size_t* len_out)
+{
+    HandleSeq hseq;
+    for(int i=0;i<size;i++) {
+        if(!*atoms[i]) // Atom doesn't exist.
+            return -1;
+        hseq.push_back(*atoms[i]);
+    }
+
+    std::string snap(snapshot_encode(hseq));
+    *buf_out = (char*) malloc(snap.size());
+    if(! *buf_out)
+        throw RuntimeException(TRACE_INFO,"Failed malloc.");
+    std::memcpy(*buf_out, snap.data(), snap.size());
+    *len_out = snap.size();
+    return 0;
+}
+
+int AtomSpace_decodeAtoms( AtomSpace* this_ptr
+                         , const char* buf
+                         , size_t len
+                         , Handle*** out
+                         , int* out_len)
+{
+    HandleSeq hseq;
+    try {
+        hseq = snapshot_decode(std::string_view(buf, len), this_ptr);
+    }
+    catch (const IOException& ex) {
+        return -1;
+    }
+
+    *out_len = hseq.size();
+    *out = (Handle**)malloc(sizeof(Handle*) * hseq.size());
+    if(! *out)
+        throw RuntimeException(TRACE_INFO,"Failed malloc.");
+    for(size_t i=0;i<hseq.size();i++) {
+        void* hp = malloc(sizeof(Handle));
+        if(! hp)
+            throw RuntimeException(TRACE_INFO,"Failed malloc.");
+        (*out)[i] = new (hp) Handle(hseq[i]);
+    }
+    return 0;
+}
+
 void AtomSpace_debug( AtomSpace* this_ptr )
 {
     std::cerr<<(*this_ptr);
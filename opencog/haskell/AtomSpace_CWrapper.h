@@ -145,6 +145,53 @@ extern "C"
                          , size_t * size
                          , Handle* outsetp);
 
+    /**
+     * AtomSpace_encodeAtoms  Encodes atoms, all of the atoms below
+     *                        them, and all of their values, into one
+     *                        buffer, in the binary snapshot format
+     *                        (see opencog/persist/sexpr/Snapshot.h).
+     *
+     * @param      this_ptr  Pointer to AtomSpace instance.
+     * @param      atoms     List of Handle of the atoms.
+     * @param      size      Size of the list.
+     * @param[out] buf_out   The encoded atoms.
+     * @param[out] len_out   Length of buf_out, in bytes.
+     *
+     * @return  0 if success.
+     *
+     * NOTE: Memory for buf_out is allocated with malloc. The caller
+     * should free it.
+     */
+    int AtomSpace_encodeAtoms( AtomSpace* this_ptr
+                             , const Handle** atoms
+                             , int size
+                             , char** buf_out
+                             , size_t* len_out );
+
+    /**
+     * AtomSpace_decodeAtoms  Adds all of the atoms and values in a
+     *                        buffer made by AtomSpace_encodeAtoms
+     *                        to the atomspace.
+     *
+     * @param      this_ptr  Pointer to AtomSpace instance.
+     * @param      buf       The encoded atoms.
+     * @param      len       Length of buf, in bytes.
+     * @param[out] out       List of Handle of all of the atoms in buf,
+     *                       each one after the atoms in its
+     *                       outgoing set.
+     * @param[out] out_len   Size of the out list.
+     *
+     * @return  0 if success, -1 if the buffer is damaged.
+     *
+     * NOTE: Memory for output parameter is allocated with malloc. The
+     * caller should free each Handle in out, and then out itself.
+     */
+    int AtomSpace_decodeAtoms( AtomSpace* this_ptr
+                             , const char* buf
+                             , size_t len
+                             , Handle*** out
+                             , int* out_len );
+
     /**
      * AtomSpace_debug  Debug function to print the state
      *                  of the atomspace on stderr.
@@ -14,6 +14,8 @@ module OpenCog.AtomSpace.Api (
     , debug
     , getByHandle
     , getWithHandle
+    , encodeHandles
+    , decodeHandles
     , execute
     , evaluate
     , exportFunction
@@ -21,7 +23,7 @@ module OpenCog.AtomSpace.Api (
     ) where
 
 import Foreign                       (Ptr)
-import Foreign.C.Types               (CULong(..),CInt(..),CDouble(..))
+import Foreign.C.Types               (CULong(..),CInt(..),CDouble(..),CSize(..))
 import Foreign.C.String              (CString,withCString,peekCString)
 import Foreign.Marshal.Array         (withArray,allocaArray,peekArray)
 import Foreign.Marshal.Utils         (toBool)
@@ -30,6 +32,8 @@ import Foreign.Storable              (peek)
 import Data.Functor                  ((<$>))
 import Data.Typeable                 (Typeable)
 import Data.Maybe                    (fromJust)
+import qualified Data.ByteString        as BS
+import qualified Data.ByteString.Unsafe as BSU
 import Control.Monad.Trans.Reader    (ReaderT,runReaderT,ask)
 import Control.Monad.IO.Class        (liftIO)
 import OpenCog.AtomSpace.Env         (AtomSpaceObj(..),AtomSpaceRef(..),(<:),
@@ -345,6 +349,63 @@ getByHandle h = do
 
 --------------------------------------------------------------------------------
 
+foreign import ccall "AtomSpace_encodeAtoms"
+  c_atomspace_encodeAtoms :: AtomSpaceRef
+                          -> HandleSeq
+                          -> CInt
+                          -> Ptr CString
+                          -> Ptr CSize
+                          -> IO CInt
+
+-- | 'encodeHandles' returns the atoms, all of the atoms below them, and
+-- all of their values, as one buffer in the binary snapshot format.
+-- This takes one FFI call, no matter how many atoms there are.
+encodeHandles :: [Handle] -> AtomSpace (Maybe BS.ByteString)
+encodeHandles hs = do
+    asRef <- getAtomSpace
+    liftIO $ withArray hs $
+      \harr -> alloca $
+      ptr -> alloca $
+      \lptr -> do
+        res <- c_atomspace_encodeAtoms asRef harr (fromIntegral $ length hs)
+                                       bptr lptr
+        if res /= sUCCESS
+          then return Nothing
+          else do
+            buf <- peek bptr
+            len <- fromIntegral <$> peek lptr
+            Just <$> BSU.unsafePackMallocCStringLen (buf,len)
+
+foreign import ccall "AtomSpace_decodeAtoms"
+  c_atomspace_decodeAtoms :: AtomSpaceRef
+                          -> CString
+                          -> CSize
+                          -> Ptr HandleSeq
+                          -> Ptr CInt
+                          -> IO CInt
+
+-- | 'decodeHandles' adds everything in a buffer made by 'encodeHandles'
+-- to the atomspace, and returns the handles of all of the atoms in it.
+-- Each atom comes after all of the atoms in its outgoing set.
+decodeHandles :: BS.ByteString -> AtomSpace (Maybe [Handle])
+decodeHandles bs = do
+    asRef <- getAtomSpace
+    liftIO $ BSU.unsafeUseAsCStringLen bs $
+      \(buf,len) -> alloca $
+      \hptr -> alloca $
+      \iptr -> do
+        res <- c_atomspace_decodeAtoms asRef buf (fromIntegral len) hptr iptr
+        if res /= sUCCESS
+          then return Nothing
+          else do
+            n <- fromIntegral <$> peek iptr
+            harr <- peek hptr
+            hs <- peekArray n harr
+            free harr
+            return $ Just hs
+
+--------------------------------------------------------------------------------
+
 foreign import ccall "TruthValue_getFromAtom"
   c_truthvalue_getFromAtom :: Handle
                             -> Ptr CString
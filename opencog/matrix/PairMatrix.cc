@@ -0,0 +1,544 @@
+/*
+ * opencog/matrix/PairMatrix.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <numeric>
+
+#include <opencog/util/exceptions.h>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/parallel/ThreadPool.h>
+#include <opencog/atoms/value/FloatValue.h>
+
+#include "PairMatrix.h"
+
+using namespace opencog;
+
+// The number of rows (or columns) handed to a worker at a time. Small
+// matrices are done in the calling thread.
+#define PAIR_MATRIX_CHUNK 512
+
+static void for_chunks(size_t n, const std::function<void(size_t, size_t)>& fn)
+{
+	size_t nchunks = (n + PAIR_MATRIX_CHUNK - 1) / PAIR_MATRIX_CHUNK;
+	if (nchunks <= 1)
+	{
+		if (0 < n) fn(0, n);
+		return;
+	}
+	thread_pool().parallel_for(nchunks, [&](size_t c)
+	{
+		size_t start = c * PAIR_MATRIX_CHUNK;
+		fn(start, std::min(n, start + PAIR_MATRIX_CHUNK));
+	});
+}
+
+// ==============================================================
+
+PairMatrix::PairMatrix(const AtomSpacePtr& as,
+                       Type left_type, Type right_type,
+                       Type pair_type, const Handle& pred,
+                       const Handle& count_key, size_t index) :
+	_left_type(left_type), _right_type(right_type),
+	_count_key(count_key), _count_index(index)
+{
+	if (nullptr == as)
+		throw InvalidParamException(TRACE_INFO,
+			"PairMatrix: expecting an AtomSpace");
+	if (nullptr == count_key)
+		throw InvalidParamException(TRACE_INFO,
+			"PairMatrix: expecting a key for the counts");
+
+	std::vector<std::pair<size_t, size_t>> coords;
+	std::vector<double> vals;
+	HandleSeq pairs;
+
+	if (EVALUATION_LINK == pair_type)
+	{
+		if (nullptr == pred)
+			throw InvalidParamException(TRACE_INFO,
+				"PairMatrix: EvaluationLink pairs need a predicate");
+
+		Handle hp(as->get_atom(pred));
+		if (hp)
+		{
+			for (const Handle& ev : hp->getIncomingSetByType(EVALUATION_LINK,
+			                                                 as.get()))
+			{
+				if (2 != ev->get_arity() or ev->getOutgoingAtom(0) != hp)
+					continue;
+				const Handle& lst(ev->getOutgoingAtom(1));
+				if (LIST_LINK != lst->get_type() or 2 != lst->get_arity())
+					continue;
+				add_pair(as, ev, lst->getOutgoingAtom(0),
+				         lst->getOutgoingAtom(1), coords, vals, pairs);
+			}
+		}
+	}
+	else
+	{
+		HandleSeq links;
+		as->get_handles_by_type(links, pair_type);
+		for (const Handle& h : links)
+		{
+			if (not h->is_link() or 2 != h->get_arity()) continue;
+			add_pair(as, h, h->getOutgoingAtom(0), h->getOutgoingAtom(1),
+			         coords, vals, pairs);
+		}
+	}
+
+	build(coords, vals, pairs);
+}
+
+void PairMatrix::add_pair(const AtomSpacePtr& as, const Handle& pair,
+                          const Handle& left, const Handle& right,
+                          std::vector<std::pair<size_t, size_t>>& coords,
+                          std::vector<double>& vals, HandleSeq& pairs)
+{
+	NameServer& ns(nameserver());
+	if (not ns.isA(left->get_type(), _left_type) or
+	    not ns.isA(right->get_type(), _right_type))
+		return;
+
+	ValuePtr vp(as->get_value(pair, _count_key));
+	if (nullptr == vp or not ns.isA(vp->get_type(), FLOAT_VALUE)) return;
+	const std::vector<double>& cnt(FloatValueCast(vp)->value());
+	if (cnt.size() <= _count_index or 0.0 == cnt[_count_index]) return;
+
+	auto rit = _row_index.try_emplace(left, _rows.size());
+	if (rit.second) _rows.push_back(left);
+	auto cit = _col_index.try_emplace(right, _cols.size());
+	if (cit.second) _cols.push_back(right);
+
+	coords.push_back({rit.first->second, cit.first->second});
+	vals.push_back(cnt[_count_index]);
+	pairs.push_back(pair);
+}
+
+/// Bucket the entries by row; sort each row by column; and then
+/// bucket them again by column. Going down the rows in order fills
+/// each column in row order, so the columns need no sorting.
+void PairMatrix::build(const std::vector<std::pair<size_t, size_t>>& coords,
+                       const std::vector<double>& vals,
+                       const HandleSeq& pairs)
+{
+	size_t nrows = _rows.size();
+	size_t ncols = _cols.size();
+	size_t nz = vals.size();
+
+	_row_start.assign(nrows + 1, 0);
+	for (const auto& rc : coords) _row_start[rc.first + 1]++;
+	std::partial_sum(_row_start.begin(), _row_start.end(), _row_start.begin());
+
+	_row_cols.resize(nz);
+	_row_vals.resize(nz);
+	_row_pairs.resize(nz);
+	std::vector<size_t> fill(_row_start.begin(), _row_start.end() - 1);
+	for (size_t k = 0; k < nz; k++)
+	{
+		size_t at = fill[coords[k].first]++;
+		_row_cols[at] = coords[k].second;
+		_row_vals[at] = vals[k];
+		_row_pairs[at] = pairs[k];
+	}
+
+	for_chunks(nrows, [&](size_t begin, size_t end)
+	{
+		std::vector<size_t> perm;
+		std::vector<size_t> cols;
+		std::vector<double> rvals;
+		HandleSeq rpairs;
+		for (size_t i = begin; i < end; i++)
+		{
+			size_t s = _row_start[i];
+			size_t n = _row_start[i+1] - s;
+			const size_t* rc = _row_cols.data() + s;
+			if (std::is_sorted(rc, rc + n)) continue;
+
+			perm.resize(n);
+			std::iota(perm.begin(), perm.end(), 0);
+			std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b)
+				{ return rc[a] < rc[b]; });
+
+			cols.assign(rc, rc + n);
+			rvals.assign(&_row_vals[s], &_row_vals[s] + n);
+			rpairs.assign(&_row_pairs[s], &_row_pairs[s] + n);
+			for (size_t j = 0; j < n; j++)
+			{
+				_row_cols[s+j] = cols[perm[j]];
+				_row_vals[s+j] = rvals[perm[j]];
+				_row_pairs[s+j] = rpairs[perm[j]];
+			}
+		}
+	});
+
+	_col_start.assign(ncols + 1, 0);
+	for (size_t c : _row_cols) _col_start[c + 1]++;
+	std::partial_sum(_col_start.begin(), _col_start.end(), _col_start.begin());
+
+	_col_rows.resize(nz);
+	_col_vals.resize(nz);
+	fill.assign(_col_start.begin(), _col_start.end() - 1);
+	for (size_t i = 0; i < nrows; i++)
+	{
+		for (size_t k = _row_start[i]; k < _row_start[i+1]; k++)
+		{
+			size_t at = fill[_row_cols[k]]++;
+			_col_rows[at] = i;
+			_col_vals[at] = _row_vals[k];
+		}
+	}
+}
+
+// ==============================================================
+
+size_t PairMatrix::row_of(const Handle& h) const
+{
+	auto it = _row_index.find(h);
+	if (_row_index.end() == it) return npos;
+	return it->second;
+}
+
+size_t PairMatrix::col_of(const Handle& h) const
+{
+	auto it = _col_index.find(h);
+	if (_col_index.end() == it) return npos;
+	return it->second;
+}
+
+static void check_index(size_t i, size_t n, const char* what)
+{
+	if (n <= i)
+		throw InvalidParamException(TRACE_INFO,
+			"PairMatrix: %s %zu out of range; there are %zu", what, i, n);
+}
+
+double PairMatrix::get_count(size_t row, size_t col) const
+{
+	check_index(row, _rows.size(), "row");
+	const size_t* begin = _row_cols.data() + _row_start[row];
+	const size_t* end = _row_cols.data() + _row_start[row+1];
+	const size_t* it = std::lower_bound(begin, end, col);
+	if (end == it or *it != col) return 0.0;
+	return _row_vals[it - _row_cols.data()];
+}
+
+Handle PairMatrix::get_pair(size_t row, size_t col) const
+{
+	check_index(row, _rows.size(), "row");
+	const size_t* begin = _row_cols.data() + _row_start[row];
+	const size_t* end = _row_cols.data() + _row_start[row+1];
+	const size_t* it = std::lower_bound(begin, end, col);
+	if (end == it or *it != col) return Handle::UNDEFINED;
+	return _row_pairs[it - _row_cols.data()];
+}
+
+// ==============================================================
+// Marginals. The rows and the columns are done alike, over the CSR
+// and the CSC arrays.
+
+static std::vector<double> sums(const std::vector<size_t>& start,
+                                const std::vector<double>& vals,
+                                bool squares)
+{
+	size_t n = start.size() - 1;
+	std::vector<double> out(n);
+	for_chunks(n, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			double sum = 0.0;
+			for (size_t k = start[i]; k < start[i+1]; k++)
+				sum += squares ? vals[k] * vals[k] : vals[k];
+			out[i] = squares ? std::sqrt(sum) : sum;
+		}
+	});
+	return out;
+}
+
+static std::vector<size_t> supports(const std::vector<size_t>& start)
+{
+	std::vector<size_t> out(start.size() - 1);
+	for (size_t i = 0; i < out.size(); i++)
+		out[i] = start[i+1] - start[i];
+	return out;
+}
+
+std::vector<size_t> PairMatrix::row_supports(void) const
+{
+	return supports(_row_start);
+}
+
+std::vector<size_t> PairMatrix::col_supports(void) const
+{
+	return supports(_col_start);
+}
+
+std::vector<double> PairMatrix::row_counts(void) const
+{
+	return sums(_row_start, _row_vals, false);
+}
+
+std::vector<double> PairMatrix::col_counts(void) const
+{
+	return sums(_col_start, _col_vals, false);
+}
+
+std::vector<double> PairMatrix::row_norms(void) const
+{
+	return sums(_row_start, _row_vals, true);
+}
+
+std::vector<double> PairMatrix::col_norms(void) const
+{
+	return sums(_col_start, _col_vals, true);
+}
+
+double PairMatrix::total_count(void) const
+{
+	std::vector<double> rc(row_counts());
+	return std::accumulate(rc.begin(), rc.end(), 0.0);
+}
+
+// ==============================================================
+// Dot products.
+
+/// Walk the two sorted index lists in step.
+double PairMatrix::dot(const size_t* ia, const double* va, size_t na,
+                       const size_t* ib, const double* vb, size_t nb)
+{
+	double sum = 0.0;
+	size_t a = 0, b = 0;
+	while (a < na and b < nb)
+	{
+		if (ia[a] < ib[b]) a++;
+		else if (ib[b] < ia[a]) b++;
+		else sum += va[a++] * vb[b++];
+	}
+	return sum;
+}
+
+double PairMatrix::row_dot(size_t a, size_t b) const
+{
+	check_index(a, _rows.size(), "row");
+	check_index(b, _rows.size(), "row");
+	size_t sa = _row_start[a], sb = _row_start[b];
+	return dot(_row_cols.data() + sa, _row_vals.data() + sa, _row_start[a+1] - sa,
+	           _row_cols.data() + sb, _row_vals.data() + sb, _row_start[b+1] - sb);
+}
+
+double PairMatrix::col_dot(size_t a, size_t b) const
+{
+	check_index(a, _cols.size(), "column");
+	check_index(b, _cols.size(), "column");
+	size_t sa = _col_start[a], sb = _col_start[b];
+	return dot(_col_rows.data() + sa, _col_vals.data() + sa, _col_start[a+1] - sa,
+	           _col_rows.data() + sb, _col_vals.data() + sb, _col_start[b+1] - sb);
+}
+
+double PairMatrix::row_cosine(size_t a, size_t b) const
+{
+	double ab = row_dot(a, b);
+	if (0.0 == ab) return 0.0;
+	return ab / std::sqrt(row_dot(a, a) * row_dot(b, b));
+}
+
+double PairMatrix::col_cosine(size_t a, size_t b) const
+{
+	double ab = col_dot(a, b);
+	if (0.0 == ab) return 0.0;
+	return ab / std::sqrt(col_dot(a, a) * col_dot(b, b));
+}
+
+namespace {
+
+/// The dot products of one line with the others, summed up in a dense
+/// array, and the lines that were touched, so that only those need be
+/// read out and cleared. One is kept per worker, and reused.
+struct Accumulator
+{
+	std::vector<double> acc;
+	std::vector<bool> seen;
+	std::vector<size_t> touched;
+
+	Accumulator(size_t nlines) : acc(nlines, 0.0), seen(nlines, false) {}
+
+	/// The entries of line i (a row, in the CSR arrays; or a column,
+	/// in the CSC arrays) are dotted with every line that shares one
+	/// of its indices, by going down that index in the other array.
+	/// Only lines numbered `first` and up are looked at.
+	void add(size_t i, size_t first,
+	         const std::vector<size_t>& start, const std::vector<size_t>& idx,
+	         const std::vector<double>& vals,
+	         const std::vector<size_t>& ostart, const std::vector<size_t>& oidx,
+	         const std::vector<double>& ovals)
+	{
+		for (size_t k = start[i]; k < start[i+1]; k++)
+		{
+			size_t j = idx[k];
+
+			// The other index is sorted; skip to `first`.
+			const size_t* ob = oidx.data() + ostart[j];
+			const size_t* oe = oidx.data() + ostart[j+1];
+			for (const size_t* m = std::lower_bound(ob, oe, first); m < oe; m++)
+			{
+				size_t other = *m;
+				if (not seen[other])
+				{
+					seen[other] = true;
+					touched.push_back(other);
+				}
+				acc[other] += vals[k] * ovals[m - oidx.data()];
+			}
+		}
+		std::sort(touched.begin(), touched.end());
+	}
+
+	void clear(void)
+	{
+		for (size_t other : touched)
+		{
+			acc[other] = 0.0;
+			seen[other] = false;
+		}
+		touched.clear();
+	}
+};
+
+} // anonymous namespace
+
+static std::vector<std::pair<size_t, double>>
+dots(size_t i, size_t nlines,
+     const std::vector<size_t>& start, const std::vector<size_t>& idx,
+     const std::vector<double>& vals,
+     const std::vector<size_t>& ostart, const std::vector<size_t>& oidx,
+     const std::vector<double>& ovals)
+{
+	Accumulator ac(nlines);
+	ac.add(i, 0, start, idx, vals, ostart, oidx, ovals);
+
+	std::vector<std::pair<size_t, double>> out;
+	out.reserve(ac.touched.size());
+	for (size_t other : ac.touched)
+		if (0.0 != ac.acc[other]) out.push_back({other, ac.acc[other]});
+	return out;
+}
+
+/// Every pair of lines a < b with a cosine of at least `min_cosine`.
+/// Each worker takes a chunk of lines, and dots each with the lines
+/// after it, in one accumulator that it keeps for the whole chunk.
+static std::vector<PairMatrix::Similarity>
+similarities(size_t nlines,
+             const std::vector<size_t>& start, const std::vector<size_t>& idx,
+             const std::vector<double>& vals,
+             const std::vector<size_t>& ostart, const std::vector<size_t>& oidx,
+             const std::vector<double>& ovals,
+             const std::vector<double>& norms, double min_cosine)
+{
+	std::mutex mtx;
+	std::vector<PairMatrix::Similarity> out;
+	for_chunks(nlines, [&](size_t begin, size_t end)
+	{
+		Accumulator ac(nlines);
+		std::vector<PairMatrix::Similarity> found;
+		for (size_t i = begin; i < end; i++)
+		{
+			if (0.0 == norms[i]) continue;
+			ac.add(i, i + 1, start, idx, vals, ostart, oidx, ovals);
+			for (size_t other : ac.touched)
+			{
+				double ab = ac.acc[other];
+				if (0.0 == ab) continue;
+				double cos = ab / (norms[i] * norms[other]);
+				if (min_cosine <= cos) found.push_back({i, other, cos});
+			}
+			ac.clear();
+		}
+		std::lock_guard<std::mutex> lck(mtx);
+		out.insert(out.end(), found.begin(), found.end());
+	});
+
+	std::sort(out.begin(), out.end(),
+		[](const PairMatrix::Similarity& x, const PairMatrix::Similarity& y)
+		{ return x.a < y.a or (x.a == y.a and x.b < y.b); });
+	return out;
+}
+
+std::vector<std::pair<size_t, double>> PairMatrix::row_dots(size_t i) const
+{
+	check_index(i, _rows.size(), "row");
+	return dots(i, _rows.size(), _row_start, _row_cols, _row_vals,
+	            _col_start, _col_rows, _col_vals);
+}
+
+std::vector<std::pair<size_t, double>> PairMatrix::col_dots(size_t i) const
+{
+	check_index(i, _cols.size(), "column");
+	return dots(i, _cols.size(), _col_start, _col_rows, _col_vals,
+	            _row_start, _row_cols, _row_vals);
+}
+
+std::vector<PairMatrix::Similarity>
+PairMatrix::row_similarities(double min_cosine) const
+{
+	return similarities(_rows.size(), _row_start, _row_cols, _row_vals,
+	                    _col_start, _col_rows, _col_vals,
+	                    row_norms(), min_cosine);
+}
+
+std::vector<PairMatrix::Similarity>
+PairMatrix::col_similarities(double min_cosine) const
+{
+	return similarities(_cols.size(), _col_start, _col_rows, _col_vals,
+	                    _row_start, _row_cols, _row_vals,
+	                    col_norms(), min_cosine);
+}
+
+// ==============================================================
+
+void PairMatrix::store(const AtomSpacePtr& as, const HandleSeq& atoms,
+                       const Handle& key,
+                       const std::vector<size_t>& supp,
+                       const std::vector<double>& counts,
+                       const std::vector<double>& norms)
+{
+	for (size_t i = 0; i < atoms.size(); i++)
+		as->set_value(atoms[i], key, createFloatValue(
+			std::vector<double>({(double) supp[i], counts[i], norms[i]})));
+}
+
+void PairMatrix::store_row_marginals(const AtomSpacePtr& as,
+                                     const Handle& key) const
+{
+	store(as, _rows, key, row_supports(), row_counts(), row_norms());
+}
+
+void PairMatrix::store_col_marginals(const AtomSpacePtr& as,
+                                     const Handle& key) const
+{
+	store(as, _cols, key, col_supports(), col_counts(), col_norms());
+}
+
+/* ===================== END OF FILE ===================== */
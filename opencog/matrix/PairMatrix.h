@@ -0,0 +1,182 @@
+/*
+ * opencog/matrix/PairMatrix.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_PAIR_MATRIX_H
+#define _OPENCOG_PAIR_MATRIX_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+/** \addtogroup grp_matrix
+ *  @{
+ */
+
+/**
+ * A read-only, compressed view of the (left, right) pairs in the
+ * AtomSpace, as the sparse matrix N(x,y) of their counts. This is the
+ * same matrix that the scheme object API in `object-api.scm` walks
+ * over, one incoming set at a time; here, it is copied out once, into
+ * compressed-row (CSR) and compressed-column (CSC) arrays, and the
+ * marginals, norms and dot products are computed over those, in the
+ * threads of the shared pool.
+ *
+ * If the pair type is EVALUATION_LINK, then the pairs are expected to
+ * be of the form
+ *
+ *    (Evaluation PRED (List LEFT RIGHT))
+ *
+ * and only those with the given predicate are looked at. Otherwise,
+ * the pairs are Links of the pair type, holding two Atoms. The left
+ * and right Atoms must be of the left and right types (or of their
+ * subtypes); this keeps out the wild-card pairs, such as those holding
+ * an `(AnyNode "left-wild")`, on which the marginals are conventionally
+ * stored. The count is the entry at `index` of the FloatValue under
+ * `count_key`; pairs without one, or with a count of zero, are not in
+ * the matrix.
+ *
+ * The view is not updated when the AtomSpace changes; build a new one.
+ */
+class PairMatrix
+{
+	Type _left_type;
+	Type _right_type;
+	Handle _count_key;
+	size_t _count_index;
+
+	HandleSeq _rows;
+	HandleSeq _cols;
+	std::unordered_map<Handle, size_t> _row_index;
+	std::unordered_map<Handle, size_t> _col_index;
+
+	// CSR: the entries of row i are at _row_start[i] up to
+	// _row_start[i+1], in column order.
+	std::vector<size_t> _row_start;
+	std::vector<size_t> _row_cols;
+	std::vector<double> _row_vals;
+	HandleSeq _row_pairs;
+
+	// CSC: likewise, for the columns, in row order.
+	std::vector<size_t> _col_start;
+	std::vector<size_t> _col_rows;
+	std::vector<double> _col_vals;
+
+	void add_pair(const AtomSpacePtr&,
+	              const Handle&, const Handle&, const Handle&,
+	              std::vector<std::pair<size_t, size_t>>&,
+	              std::vector<double>&, HandleSeq&);
+	void build(const std::vector<std::pair<size_t, size_t>>&,
+	           const std::vector<double>&, const HandleSeq&);
+
+	static double dot(const size_t*, const double*, size_t,
+	                  const size_t*, const double*, size_t);
+	static void store(const AtomSpacePtr&, const HandleSeq&, const Handle&,
+	                  const std::vector<size_t>&,
+	                  const std::vector<double>&,
+	                  const std::vector<double>&);
+
+public:
+	static constexpr size_t npos = (size_t) -1;
+
+	/// The cosine between lines a and b, with a < b.
+	struct Similarity
+	{
+		size_t a;
+		size_t b;
+		double cosine;
+	};
+
+	PairMatrix(const AtomSpacePtr&, Type left_type, Type right_type,
+	           Type pair_type, const Handle& pred,
+	           const Handle& count_key, size_t index = 0);
+
+	PairMatrix(const PairMatrix&) = delete;
+	PairMatrix& operator=(const PairMatrix&) = delete;
+
+	size_t num_rows(void) const { return _rows.size(); }
+	size_t num_cols(void) const { return _cols.size(); }
+	size_t num_pairs(void) const { return _row_vals.size(); }
+
+	const HandleSeq& get_rows(void) const { return _rows; }
+	const HandleSeq& get_cols(void) const { return _cols; }
+
+	/// The index of the row (column) holding the Atom, or npos.
+	size_t row_of(const Handle&) const;
+	size_t col_of(const Handle&) const;
+
+	/// N(x,y); zero, if there is no such pair.
+	double get_count(size_t row, size_t col) const;
+
+	/// The pair Atom for N(x,y); null, if there is none.
+	Handle get_pair(size_t row, size_t col) const;
+
+	// Marginals, one entry per row (column): the support, that is,
+	// the number of non-zero entries; the count N(x,*) (or N(*,y));
+	// and the Euclidean length.
+	std::vector<size_t> row_supports(void) const;
+	std::vector<size_t> col_supports(void) const;
+	std::vector<double> row_counts(void) const;
+	std::vector<double> col_counts(void) const;
+	std::vector<double> row_norms(void) const;
+	std::vector<double> col_norms(void) const;
+
+	/// N(*,*)
+	double total_count(void) const;
+
+	/// sum_y N(a,y) N(b,y), and likewise for the columns.
+	double row_dot(size_t a, size_t b) const;
+	double col_dot(size_t a, size_t b) const;
+
+	/// The cosine of the angle between the two rows (columns); zero,
+	/// if either one is empty.
+	double row_cosine(size_t a, size_t b) const;
+	double col_cosine(size_t a, size_t b) const;
+
+	/// The non-zero dot products of row (column) i with all of the
+	/// rows (columns), itself included, in index order. Found by going
+	/// down the columns in which row i has entries, rather than by
+	/// comparing it with every other row.
+	std::vector<std::pair<size_t, double>> row_dots(size_t i) const;
+	std::vector<std::pair<size_t, double>> col_dots(size_t i) const;
+
+	/// All of the pairs of rows (columns) a < b whose cosine is at
+	/// least `min_cosine`, and is not zero, sorted by a, then b. This
+	/// is the whole similarity job in one call: the norms are found
+	/// once, and the rows are split over the threads of the shared
+	/// pool, each summing into one dense accumulator that it reuses.
+	std::vector<Similarity> row_similarities(double min_cosine = 0.0) const;
+	std::vector<Similarity> col_similarities(double min_cosine = 0.0) const;
+
+	/// Set, on each row (column) Atom, a FloatValue under `key`,
+	/// holding its support, its count and its length, in that order.
+	void store_row_marginals(const AtomSpacePtr&, const Handle& key) const;
+	void store_col_marginals(const AtomSpacePtr&, const Handle& key) const;
+};
+
+/** @}*/
+}
+
+#endif // _OPENCOG_PAIR_MATRIX_H
@@ -31,6 +31,7 @@
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atoms/execution/EvaluationLink.h>
 #include <opencog/atoms/execution/Instantiator.h>
+#include <opencog/persist/sexpr/Snapshot.h>
 
 #include "CamlWrap.h"
 
@@ -145,6 +146,69 @@ CAMLprim value evaluate(value vatom)
 
 // ==================================================================
 
+/// Return a string holding the Atoms in the list, everything below
+/// them, and all of their Values, in the binary snapshot format (see
+/// Snapshot.h). A whole subgraph thus crosses over in one call.
+CAMLprim value atoms_to_snapshot(value vatomlist)
+{
+	CAMLparam1(vatomlist);
+	CAMLlocal2(p, vsnap);
+	HandleSeq hseq;
+
+	p = vatomlist;
+	while (p != Val_unit)
+	{
+		hseq.emplace_back(HandleCast(value_to_tag(Field(p, 0))));
+		p = Field(p, 1);
+	}
+
+	std::string snap(snapshot_encode(hseq));
+	vsnap = caml_alloc_string(snap.size());
+	memcpy(Bytes_val(vsnap), snap.data(), snap.size());
+	CAMLreturn(vsnap);
+}
+
+/// Add everything in the snapshot to the AtomSpace, and return a list
+/// of all of the Atoms in it. Each Atom comes after all of the Atoms
+/// in its outgoing set.
+CAMLprim value snapshot_to_atoms(value vsnap)
+{
+	CAMLparam1(vsnap);
+	CAMLlocal3(lst, cell, vatom);
+
+	// No OCaml allocation happens while decoding, so the string
+	// stays put.
+	HandleSeq hseq;
+	char msg[256] = "";
+	try
+	{
+		hseq = snapshot_decode(std::string_view(String_val(vsnap),
+			caml_string_length(vsnap)), atomspace.get());
+	}
+	catch (const IOException& ex)
+	{
+		strncpy(msg, ex.get_message(), sizeof(msg) - 1);
+	}
+	if (msg[0])
+	{
+		hseq.clear();
+		caml_failwith(msg);
+	}
+
+	lst = Val_unit;
+	for (size_t i = hseq.size(); 0 < i; i--)
+	{
+		vatom = tag_to_value(hseq[i-1]);
+		cell = caml_alloc(2, 0);
+		Store_field(cell, 0, vatom);
+		Store_field(cell, 1, lst);
+		lst = cell;
+	}
+	CAMLreturn(lst);
+}
+
+// ==================================================================
+
 /// Dump to stout. For debugging only!
 CAMLprim void print_atomspace(void)
 {
@@ -40,6 +40,8 @@ CAMLprim value atom_to_sexpr(value);
 CAMLprim value atom_string_printer(value);
 CAMLprim value execute(value);
 CAMLprim value evaluate(value);
+CAMLprim value atoms_to_snapshot(value);
+CAMLprim value snapshot_to_atoms(value);
 }
 
 value tag_to_value(const ValuePtr& pa);
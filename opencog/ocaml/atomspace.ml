@@ -20,3 +20,10 @@ external atom_sexpr : Atoms.atom -> string = "atom_to_sexpr" ;;
 
 external atom_printer : atom -> string = "atom_string_printer" ;;
 external atom_printer : Atoms.atom -> string = "atom_string_printer" ;;
+
+(** Whole subgraphs, with their values, in the binary snapshot format. *)
+external atoms_to_snapshot : atom list -> string = "atoms_to_snapshot" ;;
+external atoms_to_snapshot : Atoms.atom list -> string = "atoms_to_snapshot" ;;
+
+external snapshot_to_atoms : string -> atom list = "snapshot_to_atoms" ;;
+external snapshot_to_atoms : string -> Atoms.atom list = "snapshot_to_atoms" ;;
@@ -24,6 +24,8 @@
  */
 
 #include <time.h>
+#include <mutex>
+#include <set>
 
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atomspace/Transient.h>
@@ -40,39 +42,71 @@
 namespace opencog
 {
 
+// What has been fetched from the store during one query, and what is
+// known to be missing from it. Once the incoming set of an Atom, by
+// type, has been fetched, every Link of that type holding it is in
+// the AtomSpace, and a lookup of one is answered there, instead of
+// with another round-trip. Misses are remembered, too; the engine
+// often asks about the same Link on different branches of its search.
+//
+// The search climbs from an Atom to the Links holding it, and then
+// to the Links holding those. So, when the Links holding an Atom are
+// asked for, the whole incoming sets of those Links are fetched too,
+// in one batch, rather than one round-trip each, later.
+class StoreTracker
+{
+		BackingStore* _store;
+		AtomSpace* _as;
+		std::set<std::pair<Handle, Type>> _fetched;
+		std::set<Handle> _fetched_all;
+		std::set<Handle> _expanded;
+		std::set<std::pair<Type, HandleSeq>> _missing;
+		std::mutex _mtx;
+
+		void prefetch(const IncomingSet&);
+	public:
+		StoreTracker(BackingStore* sto, AtomSpace* as) :
+			_store(sto), _as(as) {}
+		void fetch_incoming(const Handle&, Type);
+		void fetch_incoming(const Handle&);
+		Handle get_link(Type, HandleSeq&&);
+};
+
 // Callback for QueryLinks
 class BackingImplicator : public Implicator
 {
-		BackingStore* _store;
+		StoreTracker _track;
 		AtomSpace* _ras;
 	public:
 		BackingImplicator(BackingStore* sto, AtomSpace* as) :
-			Implicator(as), _store(sto), _ras(as) {}
+			Implicator(as), _track(sto, as), _ras(as) {}
 		virtual ~BackingImplicator() {}
 		virtual IncomingSet get_incoming_set(const Handle&, Type);
+		virtual void fill_incoming_set(const Handle&, Type, IncomingSet&);
 		virtual Handle get_link(const Handle&, Type, HandleSeq&&);
 };
 
 // Callback for MeetLinks
 class BackingSatisfyingSet : public SatisfyingSet
 {
-		BackingStore* _store;
+		StoreTracker _track;
 	public:
 		BackingSatisfyingSet(BackingStore* sto, AtomSpace* as) :
-			SatisfyingSet(as), _store(sto) {}
+			SatisfyingSet(as), _track(sto, as) {}
 		virtual ~BackingSatisfyingSet() {}
 		virtual IncomingSet get_incoming_set(const Handle&, Type);
+		virtual void fill_incoming_set(const Handle&, Type, IncomingSet&);
 		virtual Handle get_link(const Handle&, Type, HandleSeq&&);
 };
 
 // Callback for JoinLinks
 class BackingJoinCallback : public JoinCallback
 {
-		BackingStore* _store;
+		StoreTracker _track;
 		AtomSpace* _as;
 	public:
 		BackingJoinCallback(BackingStore* sto, AtomSpace* as)
-			: _store(sto), _as(as) {}
+			: _track(sto, as), _as(as) {}
 		virtual ~BackingJoinCallback() {}
 		virtual IncomingSet get_incoming_set(const Handle&);
 };
@@ -81,46 +115,125 @@ class BackingJoinCallback : public JoinCallback
 
 using namespace opencog;
 
+#define QUERY_CACHE_SIZE 1024
+
 // ==========================================================
 
-IncomingSet BackingImplicator::get_incoming_set(const Handle& h, Type t)
+// Fetch the whole incoming sets of the Links just fetched, all at
+// once. The caller holds the lock.
+void StoreTracker::prefetch(const IncomingSet& iset)
 {
-	_store->fetchIncomingByType(_ras, h, t);
+	HandleSeq batch;
+	for (const Handle& h : iset)
+		if (_fetched_all.insert(h).second)
+			batch.emplace_back(h);
+
+	if (batch.empty()) return;
+	_store->fetchIncomingSets(_as, batch);
 	_store->barrier();
+}
+
+void StoreTracker::fetch_incoming(const Handle& h, Type t)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+
+	// Prefetched already; climb one more level.
+	if (_fetched_all.end() != _fetched_all.find(h))
+	{
+		if (_expanded.insert(h).second)
+			prefetch(h->getIncomingSet(_as));
+		return;
+	}
+
+	if (not _fetched.insert({h, t}).second) return;
+	_store->fetchIncomingByType(_as, h, t);
+	_store->barrier();
+	prefetch(h->getIncomingSetByType(t, _as));
+}
+
+void StoreTracker::fetch_incoming(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (not _fetched_all.insert(h).second)
+	{
+		if (_expanded.insert(h).second)
+			prefetch(h->getIncomingSet(_as));
+		return;
+	}
+
+	_expanded.insert(h);
+	_store->fetchIncomingSet(_as, h);
+	_store->barrier();
+	prefetch(h->getIncomingSet(_as));
+}
+
+Handle StoreTracker::get_link(Type t, HandleSeq&& oset)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	for (const Handle& h : oset)
+		if (_fetched.end() != _fetched.find({h, t}) or
+		    _fetched_all.end() != _fetched_all.find(h))
+			return _as->get_link(t, std::move(oset));
+
+	std::pair<Type, HandleSeq> key(t, oset);
+	if (_missing.end() != _missing.find(key)) return Handle::UNDEFINED;
+
+	Handle h = _store->getLink(t, oset);
+	if (nullptr == h)
+	{
+		_missing.emplace(std::move(key));
+		return h;
+	}
+	return _as->add_atom(h);
+}
+
+// -------------
+
+IncomingSet BackingImplicator::get_incoming_set(const Handle& h, Type t)
+{
+	_track.fetch_incoming(h, t);
 	return h->getIncomingSetByType(t, _ras);
 }
 
+void BackingImplicator::fill_incoming_set(const Handle& h, Type t,
+                                           IncomingSet& iset)
+{
+	_track.fetch_incoming(h, t);
+	h->copyIncomingSetByType(iset, t, _ras);
+}
+
 Handle BackingImplicator::get_link(const Handle& hg,
                                    Type t, HandleSeq&& oset)
 {
-	Handle h = _store->getLink(t, oset);
-	if (nullptr == h) return h;
-	return _ras->add_atom(h);
+	return _track.get_link(t, std::move(oset));
 }
 
 // -------------
 
 IncomingSet BackingSatisfyingSet::get_incoming_set(const Handle& h, Type t)
 {
-	_store->fetchIncomingByType(_as, h, t);
-	_store->barrier();
+	_track.fetch_incoming(h, t);
 	return h->getIncomingSetByType(t, _as);
 }
 
+void BackingSatisfyingSet::fill_incoming_set(const Handle& h, Type t,
+                                              IncomingSet& iset)
+{
+	_track.fetch_incoming(h, t);
+	h->copyIncomingSetByType(iset, t, _as);
+}
+
 Handle BackingSatisfyingSet::get_link(const Handle& hg,
                                       Type t, HandleSeq&& oset)
 {
-	Handle h = _store->getLink(t, oset);
-	if (nullptr == h) return h;
-	return _as->add_atom(h);
+	return _track.get_link(t, std::move(oset));
 }
 
 // -------------
 
 IncomingSet BackingJoinCallback::get_incoming_set(const Handle& h)
 {
-	_store->fetchIncomingSet(_as, h);
-	_store->barrier();
+	_track.fetch_incoming(h);
 	return h->getIncomingSet(_as);
 }
 
@@ -171,6 +284,13 @@ IncomingSet BackingJoinCallback::get_incoming_set(const Handle& h)
 /// (and that compatibility should be maintained). See
 /// `opencog/scm/opencog/exec.scm` for that code.
 ///
+/// The results are also kept here, in RAM, until the next write made
+/// through this store. Until then, asking again, even for a `fresh`
+/// search, just hands back the same results, with the same timestamp,
+/// without a round-trip; the search could not have found anything
+/// else. Writes made in some other way are not seen; for those, there
+/// is `clear_query_cache()`.
+///
 void BackingStore::runQuery(const Handle& query, const Handle& key,
                             const Handle& meta, bool fresh)
 {
@@ -183,12 +303,29 @@ void BackingStore::runQuery(const Handle& query, const Handle& key,
 			"For now, only Meet, Join and Query are supported!");
 	}
 
-	if (not fresh)
+	// Return cached value, by default.
+	if (not fresh and nullptr != query->getValue(key)) return;
+
+	// Writes made while the search runs may or may not be seen by it;
+	// so the results belong to the generation before the search.
+	uint64_t gen = _write_gen;
+	AtomSpace* as = query->getAtomSpace();
+	std::pair<Handle, Handle> ckey(query, key);
 	{
-		// Return cached value, by default.
-		ValuePtr vp = query->getValue(key);
-		if (vp != nullptr) return;
+		std::lock_guard<std::mutex> lck(_query_mtx);
+		auto it = _query_cache.find(ckey);
+		if (_query_cache.end() != it and gen == it->second.gen)
+		{
+			ValuePtr qv = it->second.result;
+			if (qv and as) qv = as->add_atoms(qv);
+			query->setValue(key, qv);
+			if (meta) query->setValue(meta, createFloatValue(it->second.stamp));
+			return;
+		}
+	}
 
+	if (not fresh)
+	{
 		// Oh no! Go fetch it!
 		loadValue(query, key);
 		if (meta) loadValue(query, meta);
@@ -198,8 +335,6 @@ void BackingStore::runQuery(const Handle& query, const Handle& key,
 	}
 
 	// Still no luck. Bummer. Perform the query.
-	AtomSpace* as = query->getAtomSpace();
-
 	ValuePtr qv;
 	if (nameserver().isA(qt, QUERY_LINK))
 	{
@@ -240,6 +375,23 @@ void BackingStore::runQuery(const Handle& query, const Handle& key,
 	if (qv) qv = as->add_atoms(qv);
 	query->setValue(key, qv);
 
+	time_t now = time(0);
+	double dnow = now;
+	{
+		std::lock_guard<std::mutex> lck(_query_mtx);
+
+		// Don't let the stale ones pile up.
+		if (QUERY_CACHE_SIZE <= _query_cache.size())
+		{
+			for (auto it = _query_cache.begin(); it != _query_cache.end(); )
+				if (_write_gen != it->second.gen) it = _query_cache.erase(it);
+				else it++;
+			if (QUERY_CACHE_SIZE <= _query_cache.size())
+				_query_cache.clear();
+		}
+		_query_cache[ckey] = {gen, qv, dnow};
+	}
+
 	// And cache it in the file, as well! This caching is compatible
 	// with what `cog-execute-cache!` does. It allows the cached
 	// value to be retrieved later, without re-performing the search.
@@ -253,10 +405,14 @@ void BackingStore::runQuery(const Handle& query, const Handle& key,
 
 	if (nullptr == meta) return;
 
-	time_t now = time(0);
-	double dnow = now;
 	query->setValue(meta, createFloatValue(dnow));
 	storeValue(query, meta);
 }
 
+void BackingStore::clear_query_cache(void)
+{
+	std::lock_guard<std::mutex> lck(_query_mtx);
+	_query_cache.clear();
+}
+
 // ====================== END OF FILE =======================
@@ -57,4 +57,32 @@ void BackingStore::getAtom(const Handle& h)
 	}
 }
 
+// ==========================================================
+// Batch defaults. These just loop; backends that can do better
+// are expected to override them.
+
+void BackingStore::getAtoms(const HandleSeq& hs)
+{
+	for (const Handle& h : hs)
+		getAtom(h);
+}
+
+void BackingStore::storeAtoms(const HandleSeq& hs, bool synchronous)
+{
+	for (const Handle& h : hs)
+		storeAtom(h, synchronous);
+}
+
+void BackingStore::loadValues(const HandleSeq& hs, const Handle& key)
+{
+	for (const Handle& h : hs)
+		loadValue(h, key);
+}
+
+void BackingStore::fetchIncomingSets(AtomSpace* as, const HandleSeq& hs)
+{
+	for (const Handle& h : hs)
+		fetchIncomingSet(as, h);
+}
+
 // ====================== END OF FILE =======================
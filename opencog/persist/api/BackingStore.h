@@ -24,6 +24,10 @@
 #ifndef _OPENCOG_BACKING_STORE_H
 #define _OPENCOG_BACKING_STORE_H
 
+#include <atomic>
+#include <map>
+#include <mutex>
+
 #include <opencog/util/exceptions.h>
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/Node.h>
@@ -56,6 +60,7 @@ class BackingStore
 	friend class BackingImplicator;
 	friend class BackingSatisfyingSet;
 	friend class BackingJoinCallback;
+	friend class StoreTracker;
 	public:
 		virtual ~BackingStore() {}
 
@@ -150,6 +155,20 @@ class BackingStore
 			throw IOException(TRACE_INFO, "Not implemented!");
 		}
 
+		/**
+		 * Batch forms of the above. Each does the same as calling the
+		 * one-Atom method, once for every Atom in the sequence; the
+		 * defaults do exactly that. Backends that can move many Atoms
+		 * in one round-trip should override these.
+		 *
+		 * As above, none of these need to have completed when they
+		 * return; only `barrier()` guarantees that.
+		 */
+		virtual void getAtoms(const HandleSeq&);
+		virtual void storeAtoms(const HandleSeq&, bool synchronous = false);
+		virtual void loadValues(const HandleSeq& atoms, const Handle& key);
+		virtual void fetchIncomingSets(AtomSpace*, const HandleSeq&);
+
 		/**
 		 * Run the `query` on the remote server, and place the results
 		 * at `key` on the Atom `query`, both locally, and remotely.
@@ -202,6 +221,14 @@ class BackingStore
 		                      const Handle& metadata_key = Handle::UNDEFINED,
 		                      bool fresh=false);
 
+		/**
+		 * Forget the results of the queries run by the default
+		 * `runQuery()`. They are forgotten anyway whenever an Atom or
+		 * Value is written through this store; call this after the
+		 * data was changed in some other way, e.g. by another process.
+		 */
+		void clear_query_cache(void);
+
 		/**
 		 * Fetch *all* Atoms of the given type, and place them into the
 		 * AtomSpace. All of the associated Values are also be fetched,
@@ -259,6 +286,12 @@ class BackingStore
 		virtual void barrier() = 0;
 
 	protected:
+		/**
+		 * Note that the contents of storage have changed, so that
+		 * queries run before now may no longer give the same results.
+		 */
+		void invalidate_queries(void) { _write_gen++; }
+
 		/**
 		 * Return a Link with the indicated type and outset,
 		 * if it exists; else return nullptr. The returned atom
@@ -283,6 +316,20 @@ class BackingStore
 		virtual Handle getNode(Type, const char *) {
 			throw IOException(TRACE_INFO, "Implementation is buggy!");
 		}
+
+	private:
+		// The results of the queries run by `runQuery()`, keyed by
+		// the query and the key they are placed at, with the time
+		// at which they were found. They hold until the next write.
+		struct QueryResult
+		{
+			uint64_t gen;
+			ValuePtr result;
+			double stamp;
+		};
+		std::atomic<uint64_t> _write_gen{0};
+		std::map<std::pair<Handle, Handle>, QueryResult> _query_cache;
+		std::mutex _query_mtx;
 };
 
 /** @}*/
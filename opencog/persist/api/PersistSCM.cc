@@ -24,6 +24,7 @@
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/guile/SchemePrimitive.h>
 #include "PersistSCM.h"
+#include "ShardStorage.h"
 
 using namespace opencog;
 
@@ -62,6 +63,18 @@ void PersistSCM::init(void)
 	             &PersistSCM::sn_fetch_query2, "persist", false);
 	define_scheme_primitive("sn-fetch-query-4args",
 	             &PersistSCM::sn_fetch_query4, "persist", false);
+	define_scheme_primitive("sn-fetch-atoms",
+	             &PersistSCM::sn_fetch_atoms, "persist", false);
+	define_scheme_primitive("sn-fetch-values",
+	             &PersistSCM::sn_fetch_values, "persist", false);
+	define_scheme_primitive("sn-fetch-incoming-sets",
+	             &PersistSCM::sn_fetch_incoming_sets, "persist", false);
+	define_scheme_primitive("sn-fetch-atoms-async",
+	             &PersistSCM::sn_fetch_atoms_async, "persist", false);
+	define_scheme_primitive("sn-fetch-incoming-sets-async",
+	             &PersistSCM::sn_fetch_incoming_sets_async, "persist", false);
+	define_scheme_primitive("sn-store-atoms",
+	             &PersistSCM::sn_store_atoms, "persist", false);
 	define_scheme_primitive("sn-store-atom",
 	             &PersistSCM::sn_store_atom, "persist", false);
 	define_scheme_primitive("sn-store-value",
@@ -72,6 +85,8 @@ void PersistSCM::init(void)
 	             &PersistSCM::sn_load_atomspace, "persist", false);
 	define_scheme_primitive("sn-store-atomspace",
 	             &PersistSCM::sn_store_atomspace, "persist", false);
+	define_scheme_primitive("sn-sync",
+	             &PersistSCM::sn_sync, "persist", false);
 	define_scheme_primitive("sn-load-frames",
 	             &PersistSCM::sn_load_frames, "persist", false);
 	define_scheme_primitive("sn-delete",
@@ -82,6 +97,12 @@ void PersistSCM::init(void)
 	             &PersistSCM::sn_barrier, "persist", false);
 	define_scheme_primitive("sn-monitor",
 	             &PersistSCM::sn_monitor, "persist", false);
+	define_scheme_primitive("sn-rebalance",
+	             &PersistSCM::sn_rebalance, "persist", false);
+	define_scheme_primitive("sn-set-prefetch",
+	             &PersistSCM::sn_set_prefetch, "persist", false);
+	define_scheme_primitive("sn-prefetch-barrier",
+	             &PersistSCM::sn_prefetch_barrier, "persist", false);
 
 	define_scheme_primitive("dflt-fetch-atom",
 	             &PersistSCM::dflt_fetch_atom, this, "persist", false);
@@ -95,6 +116,18 @@ void PersistSCM::init(void)
 	             &PersistSCM::dflt_fetch_query2, this, "persist", false);
 	define_scheme_primitive("dflt-fetch-query-4args",
 	             &PersistSCM::dflt_fetch_query4, this, "persist", false);
+	define_scheme_primitive("dflt-fetch-atoms",
+	             &PersistSCM::dflt_fetch_atoms, this, "persist", false);
+	define_scheme_primitive("dflt-fetch-values",
+	             &PersistSCM::dflt_fetch_values, this, "persist", false);
+	define_scheme_primitive("dflt-fetch-incoming-sets",
+	             &PersistSCM::dflt_fetch_incoming_sets, this, "persist", false);
+	define_scheme_primitive("dflt-fetch-atoms-async",
+	             &PersistSCM::dflt_fetch_atoms_async, this, "persist", false);
+	define_scheme_primitive("dflt-fetch-incoming-sets-async",
+	             &PersistSCM::dflt_fetch_incoming_sets_async, this, "persist", false);
+	define_scheme_primitive("dflt-store-atoms",
+	             &PersistSCM::dflt_store_atoms, this, "persist", false);
 	define_scheme_primitive("dflt-store-atom",
 	             &PersistSCM::dflt_store_atom, this, "persist", false);
 	define_scheme_primitive("dflt-store-value",
@@ -105,6 +138,8 @@ void PersistSCM::init(void)
 	             &PersistSCM::dflt_load_atomspace, this, "persist", false);
 	define_scheme_primitive("dflt-store-atomspace",
 	             &PersistSCM::dflt_store_atomspace, this, "persist", false);
+	define_scheme_primitive("dflt-sync",
+	             &PersistSCM::dflt_sync, this, "persist", false);
 	define_scheme_primitive("dflt-load-frames",
 	             &PersistSCM::dflt_load_frames, this, "persist", false);
 	define_scheme_primitive("dflt-delete",
@@ -115,6 +150,10 @@ void PersistSCM::init(void)
 	             &PersistSCM::dflt_barrier, this, "persist", false);
 	define_scheme_primitive("dflt-monitor",
 	             &PersistSCM::dflt_monitor, this, "persist", false);
+	define_scheme_primitive("dflt-set-prefetch",
+	             &PersistSCM::dflt_set_prefetch, this, "persist", false);
+	define_scheme_primitive("dflt-prefetch-barrier",
+	             &PersistSCM::dflt_prefetch_barrier, this, "persist", false);
 }
 
 // =====================================================================
@@ -219,6 +258,43 @@ Handle PersistSCM::sn_fetch_query4(Handle query, Handle key,
 	return stnp->fetch_query(query, key, meta, fresh);
 }
 
+HandleSeq PersistSCM::sn_fetch_atoms(HandleSeq hs, Handle hsn)
+{
+	GET_STNP;
+	return stnp->fetch_atoms(hs);
+}
+
+HandleSeq PersistSCM::sn_fetch_values(HandleSeq hs, Handle key, Handle hsn)
+{
+	GET_STNP;
+	return stnp->fetch_values(hs, key);
+}
+
+HandleSeq PersistSCM::sn_fetch_incoming_sets(HandleSeq hs, Handle hsn)
+{
+	GET_STNP;
+	return stnp->fetch_incoming_sets(hs);
+}
+
+ValuePtr PersistSCM::sn_fetch_atoms_async(HandleSeq hs, Handle hsn)
+{
+	GET_STNP;
+	return stnp->fetch_atoms_async(hs);
+}
+
+ValuePtr PersistSCM::sn_fetch_incoming_sets_async(HandleSeq hs, Handle hsn)
+{
+	GET_STNP;
+	return stnp->fetch_incoming_sets_async(hs);
+}
+
+HandleSeq PersistSCM::sn_store_atoms(HandleSeq hs, Handle hsn)
+{
+	GET_STNP;
+	stnp->store_atoms(hs);
+	return hs;
+}
+
 /**
  * Store the single atom to the backing store hanging off the
  * atom-space.
@@ -254,6 +330,12 @@ void PersistSCM::sn_store_atomspace(Handle hsn)
 	stnp->store_atomspace();
 }
 
+size_t PersistSCM::sn_sync(Handle hsn)
+{
+	GET_STNP;
+	return stnp->sync();
+}
+
 Handle PersistSCM::sn_load_frames(Handle hsn)
 {
 	GET_STNP;
@@ -278,12 +360,55 @@ void PersistSCM::sn_barrier(Handle hsn)
 	stnp->barrier();
 }
 
+static StorageNode::PrefetchPolicy policy(bool outgoing, size_t hops,
+                                          Type t, const HandleSeq& keys)
+{
+	StorageNode::PrefetchPolicy pol;
+	pol.outgoing = outgoing;
+	pol.hops = hops;
+	pol.incoming_type = t;
+	pol.keys = keys;
+	return pol;
+}
+
+void PersistSCM::sn_set_prefetch(bool outgoing, size_t hops, Type t,
+                                 HandleSeq keys, Handle hsn)
+{
+	GET_STNP;
+	stnp->set_prefetch(policy(outgoing, hops, t, keys));
+}
+
+void PersistSCM::sn_prefetch_barrier(Handle hsn)
+{
+	GET_STNP;
+	stnp->prefetch_barrier();
+}
+
 std::string PersistSCM::sn_monitor(Handle hsn)
 {
 	GET_STNP;
 	return stnp->monitor();
 }
 
+void PersistSCM::sn_rebalance(Handle hsn, HandleSeq retired)
+{
+	ShardStorageNodePtr ssnp = ShardStorageNodeCast(hsn);
+	if (nullptr == ssnp)
+		throw RuntimeException(TRACE_INFO,
+			"Expecting ShardStorageNode, got %s", hsn->to_short_string().c_str());
+
+	std::vector<StorageNodePtr> parts;
+	for (const Handle& h : retired)
+	{
+		StorageNodePtr stnp = StorageNodeCast(h);
+		if (nullptr == stnp)
+			throw RuntimeException(TRACE_INFO,
+				"Expecting StorageNode, got %s", h->to_short_string().c_str());
+		parts.emplace_back(stnp);
+	}
+	ssnp->rebalance(parts);
+}
+
 // =====================================================================
 
 #define CHECK \
@@ -328,6 +453,43 @@ Handle PersistSCM::dflt_fetch_query4(Handle query, Handle key,
 	return _sn->fetch_query(query, key, meta, fresh);
 }
 
+HandleSeq PersistSCM::dflt_fetch_atoms(HandleSeq hs)
+{
+	CHECK;
+	return _sn->fetch_atoms(hs);
+}
+
+HandleSeq PersistSCM::dflt_fetch_values(HandleSeq hs, Handle key)
+{
+	CHECK;
+	return _sn->fetch_values(hs, key);
+}
+
+HandleSeq PersistSCM::dflt_fetch_incoming_sets(HandleSeq hs)
+{
+	CHECK;
+	return _sn->fetch_incoming_sets(hs);
+}
+
+ValuePtr PersistSCM::dflt_fetch_atoms_async(HandleSeq hs)
+{
+	CHECK;
+	return _sn->fetch_atoms_async(hs);
+}
+
+ValuePtr PersistSCM::dflt_fetch_incoming_sets_async(HandleSeq hs)
+{
+	CHECK;
+	return _sn->fetch_incoming_sets_async(hs);
+}
+
+HandleSeq PersistSCM::dflt_store_atoms(HandleSeq hs)
+{
+	CHECK;
+	_sn->store_atoms(hs);
+	return hs;
+}
+
 /**
  * Store the single atom to the backing store hanging off the
  * atom-space.
@@ -363,6 +525,12 @@ void PersistSCM::dflt_store_atomspace(void)
 	_sn->store_atomspace();
 }
 
+size_t PersistSCM::dflt_sync(void)
+{
+	CHECK;
+	return _sn->sync();
+}
+
 Handle PersistSCM::dflt_load_frames(void)
 {
 	CHECK;
@@ -394,6 +562,19 @@ std::string PersistSCM::dflt_monitor(void)
 	return _sn->monitor();
 }
 
+void PersistSCM::dflt_set_prefetch(bool outgoing, size_t hops, Type t,
+                                   HandleSeq keys)
+{
+	CHECK;
+	_sn->set_prefetch(policy(outgoing, hops, t, keys));
+}
+
+void PersistSCM::dflt_prefetch_barrier(void)
+{
+	CHECK;
+	_sn->prefetch_barrier();
+}
+
 Handle PersistSCM::current_storage(void)
 {
 	return Handle(_sn);
@@ -47,16 +47,26 @@ private:
 	static Handle sn_fetch_incoming_by_type(Handle, Type, Handle);
 	static Handle sn_fetch_query2(Handle, Handle, Handle);
 	static Handle sn_fetch_query4(Handle, Handle, Handle, bool, Handle);
+	static HandleSeq sn_fetch_atoms(HandleSeq, Handle);
+	static HandleSeq sn_fetch_values(HandleSeq, Handle, Handle);
+	static HandleSeq sn_fetch_incoming_sets(HandleSeq, Handle);
+	static ValuePtr sn_fetch_atoms_async(HandleSeq, Handle);
+	static ValuePtr sn_fetch_incoming_sets_async(HandleSeq, Handle);
+	static HandleSeq sn_store_atoms(HandleSeq, Handle);
 	static Handle sn_store_atom(Handle, Handle);
 	static void sn_store_value(Handle, Handle, Handle);
 	static void sn_load_type(Type, Handle);
 	static void sn_load_atomspace(Handle);
 	static void sn_store_atomspace(Handle);
+	static size_t sn_sync(Handle);
 	static Handle sn_load_frames(Handle);
 	static bool sn_delete(Handle, Handle);
 	static bool sn_delete_recursive(Handle, Handle);
 	static void sn_barrier(Handle);
 	static std::string sn_monitor(Handle);
+	static void sn_rebalance(Handle, HandleSeq);
+	static void sn_set_prefetch(bool, size_t, Type, HandleSeq, Handle);
+	static void sn_prefetch_barrier(Handle);
 
 	void open(Handle);
 	void close(Handle);
@@ -72,16 +82,25 @@ private:
 	Handle dflt_fetch_incoming_by_type(Handle, Type);
 	Handle dflt_fetch_query2(Handle, Handle);
 	Handle dflt_fetch_query4(Handle, Handle, Handle, bool);
+	HandleSeq dflt_fetch_atoms(HandleSeq);
+	HandleSeq dflt_fetch_values(HandleSeq, Handle);
+	HandleSeq dflt_fetch_incoming_sets(HandleSeq);
+	ValuePtr dflt_fetch_atoms_async(HandleSeq);
+	ValuePtr dflt_fetch_incoming_sets_async(HandleSeq);
+	HandleSeq dflt_store_atoms(HandleSeq);
 	Handle dflt_store_atom(Handle);
 	void dflt_store_value(Handle, Handle);
 	void dflt_load_type(Type);
 	void dflt_load_atomspace(void);
 	void dflt_store_atomspace(void);
+	size_t dflt_sync(void);
 	Handle dflt_load_frames(void);
 	bool dflt_delete(Handle);
 	bool dflt_delete_recursive(Handle);
 	void dflt_barrier(void);
 	std::string dflt_monitor(void);
+	void dflt_set_prefetch(bool, size_t, Type, HandleSeq);
+	void dflt_prefetch_barrier(void);
 	Handle current_storage(void);
 
 public:
@@ -0,0 +1,312 @@
+/*
+ * opencog/persist/api/ReplicaStorage.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/value/LinkValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "ReplicaStorage.h"
+
+using namespace opencog;
+
+ReplicaStorageNode::ReplicaStorageNode(Type t, const std::string& name)
+	: StorageNode(t, name)
+{
+	_open = false;
+	_next = 0;
+
+	if (name.empty() or 0 == name.compare("round-robin"))
+		_nearest_first = false;
+	else if (0 == name.compare("nearest-first"))
+		_nearest_first = true;
+	else
+		throw SyntaxException(TRACE_INFO,
+			"Expecting \"round-robin\" or \"nearest-first\", got \"%s\"",
+			name.c_str());
+}
+
+ReplicaStorageNode::~ReplicaStorageNode()
+{
+}
+
+// ====================================================================
+
+/// The StorageNodes listed at `key`, either in a Link, or a LinkValue.
+std::vector<StorageNodePtr> ReplicaStorageNode::get_parts(const char* key)
+{
+	ValuePtr vp = getValue(_atom_space->add_node(PREDICATE_NODE, key));
+	if (nullptr == vp) return {};
+
+	HandleSeq hs;
+	if (vp->is_atom())
+	{
+		Handle h(HandleCast(vp));
+		if (h->is_link()) hs = h->getOutgoingSet();
+		else hs.push_back(h);
+	}
+	else if (nameserver().isA(vp->get_type(), LINK_VALUE))
+		hs = LinkValueCast(vp)->to_handle_seq();
+
+	std::vector<StorageNodePtr> parts;
+	for (const Handle& h : hs)
+	{
+		StorageNodePtr stnp = StorageNodeCast(h);
+		if (nullptr == stnp or this == stnp.get())
+			throw RuntimeException(TRACE_INFO,
+				"Expecting StorageNode at %s, got %s",
+				key, h->to_short_string().c_str());
+		parts.emplace_back(stnp);
+	}
+	return parts;
+}
+
+void ReplicaStorageNode::open(void)
+{
+	if (_open)
+		throw IOException(TRACE_INFO,
+			"ReplicaStorageNode %s is already open!", get_name().c_str());
+
+	_writers = get_parts("*-write-parts-*");
+	_readers = get_parts("*-read-parts-*");
+	if (_writers.empty())
+		throw RuntimeException(TRACE_INFO,
+			"ReplicaStorageNode needs at least one of *-write-parts-*");
+
+	for (const std::vector<StorageNodePtr>* parts : {&_writers, &_readers})
+		for (const StorageNodePtr& stnp : *parts)
+		{
+			if (stnp->connected()) continue;
+			stnp->open();
+			_opened.push_back(stnp);
+		}
+
+	_open = true;
+}
+
+void ReplicaStorageNode::close(void)
+{
+	if (not _open) return;
+	barrier();
+
+	for (const StorageNodePtr& stnp : _opened)
+		stnp->close();
+
+	_opened.clear();
+	_readers.clear();
+	_writers.clear();
+	_open = false;
+}
+
+bool ReplicaStorageNode::connected(void)
+{
+	if (not _open) return false;
+	for (const std::vector<StorageNodePtr>* parts : {&_writers, &_readers})
+		for (const StorageNodePtr& stnp : *parts)
+			if (not stnp->connected()) return false;
+	return true;
+}
+
+void ReplicaStorageNode::check_open(void)
+{
+	if (not _open)
+		throw IOException(TRACE_INFO,
+			"ReplicaStorageNode %s is not open!", get_name().c_str());
+}
+
+std::string ReplicaStorageNode::monitor(void)
+{
+	std::string rpt = "ReplicaStorageNode ";
+	rpt += _nearest_first ? "nearest-first" : "round-robin";
+	rpt += "\n";
+	for (const StorageNodePtr& stnp : _writers)
+		rpt += "Write part " + stnp->to_short_string() + ":\n" +
+			stnp->monitor() + "\n";
+	for (const StorageNodePtr& stnp : _readers)
+		rpt += "Read part " + stnp->to_short_string() + ":\n" +
+			stnp->monitor() + "\n";
+	return rpt;
+}
+
+// ====================================================================
+
+/// Perform the read on one part. If it fails, try the next one; the
+/// reads change nothing in storage, so they can be tried again.
+template<typename F>
+auto ReplicaStorageNode::read(F&& fn)
+{
+	check_open();
+	const std::vector<StorageNodePtr>& parts =
+		_readers.empty() ? _writers : _readers;
+
+	size_t nparts = parts.size();
+	size_t start = _nearest_first ? 0 : _next++ % nparts;
+	for (size_t i = 0; ; i++)
+	{
+		StorageNode* stnp = parts[(start + i) % nparts].get();
+		if (i + 1 == nparts) return fn(stnp);
+		if (not stnp->connected()) continue;
+		try
+		{
+			return fn(stnp);
+		}
+		catch (const IOException& ex)
+		{
+			logger().warn("ReplicaStorageNode: read from %s failed: %s",
+				stnp->to_short_string().c_str(), ex.get_message());
+		}
+	}
+}
+
+/// Perform the write on every part.
+template<typename F>
+void ReplicaStorageNode::write(F&& fn)
+{
+	check_open();
+	for (const StorageNodePtr& stnp : _writers)
+		fn(stnp.get());
+}
+
+// ====================================================================
+
+Handle ReplicaStorageNode::getNode(Type t, const char* name)
+{
+	return read([&](StorageNode* stnp) { return stnp->getNode(t, name); });
+}
+
+Handle ReplicaStorageNode::getLink(Type t, const HandleSeq& hs)
+{
+	return read([&](StorageNode* stnp) { return stnp->getLink(t, hs); });
+}
+
+void ReplicaStorageNode::getAtom(const Handle& h)
+{
+	read([&](StorageNode* stnp) { stnp->getAtom(h); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::getAtoms(const HandleSeq& hs)
+{
+	read([&](StorageNode* stnp) { stnp->getAtoms(hs); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::fetchIncomingSet(AtomSpace* as, const Handle& h)
+{
+	read([&](StorageNode* stnp) {
+		stnp->fetchIncomingSet(as, h); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::fetchIncomingSets(AtomSpace* as, const HandleSeq& hs)
+{
+	read([&](StorageNode* stnp) {
+		stnp->fetchIncomingSets(as, hs); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::fetchIncomingByType(AtomSpace* as,
+                                             const Handle& h, Type t)
+{
+	read([&](StorageNode* stnp) {
+		stnp->fetchIncomingByType(as, h, t); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::loadValue(const Handle& h, const Handle& key)
+{
+	read([&](StorageNode* stnp) { stnp->loadValue(h, key); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::loadValues(const HandleSeq& hs, const Handle& key)
+{
+	read([&](StorageNode* stnp) {
+		stnp->loadValues(hs, key); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::loadType(AtomSpace* as, Type t)
+{
+	read([&](StorageNode* stnp) { stnp->loadType(as, t); stnp->barrier(); });
+}
+
+void ReplicaStorageNode::loadAtomSpace(AtomSpace* as)
+{
+	read([&](StorageNode* stnp) { stnp->loadAtomSpace(as); stnp->barrier(); });
+}
+
+Handle ReplicaStorageNode::loadFrameDAG(AtomSpace* as)
+{
+	return read([&](StorageNode* stnp) { return stnp->loadFrameDAG(as); });
+}
+
+// The reads above wait for their part, before returning: a failure
+// found later, at the barrier, could no longer be sent elsewhere.
+
+// ====================================================================
+
+void ReplicaStorageNode::storeAtom(const Handle& h, bool synchronous)
+{
+	write([&](StorageNode* stnp) { stnp->storeAtom(h, synchronous); });
+}
+
+void ReplicaStorageNode::storeAtoms(const HandleSeq& hs, bool synchronous)
+{
+	write([&](StorageNode* stnp) { stnp->storeAtoms(hs, synchronous); });
+}
+
+void ReplicaStorageNode::removeAtom(const Handle& h, bool recursive)
+{
+	write([&](StorageNode* stnp) { stnp->removeAtom(h, recursive); });
+}
+
+void ReplicaStorageNode::storeValue(const Handle& h, const Handle& key)
+{
+	write([&](StorageNode* stnp) { stnp->storeValue(h, key); });
+}
+
+void ReplicaStorageNode::storeAtomSpace(const AtomSpace* as)
+{
+	write([&](StorageNode* stnp) { stnp->storeAtomSpace(as); });
+}
+
+void ReplicaStorageNode::create(void)
+{
+	write([&](StorageNode* stnp) { stnp->create(); });
+}
+
+void ReplicaStorageNode::destroy(void)
+{
+	write([&](StorageNode* stnp) { stnp->destroy(); });
+}
+
+void ReplicaStorageNode::erase(void)
+{
+	write([&](StorageNode* stnp) { stnp->erase(); });
+}
+
+/// Wait for every part, not just the write parts: reads may have been
+/// sent to any of them.
+void ReplicaStorageNode::barrier(void)
+{
+	check_open();
+	for (const std::vector<StorageNodePtr>* parts : {&_writers, &_readers})
+		for (const StorageNodePtr& stnp : *parts)
+			stnp->barrier();
+}
+
+DEFINE_NODE_FACTORY(ReplicaStorageNode, REPLICA_STORAGE_NODE)
+
+/* ============================= END OF FILE ================= */
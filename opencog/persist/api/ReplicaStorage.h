@@ -0,0 +1,132 @@
+/*
+ * opencog/persist/api/ReplicaStorage.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_REPLICA_STORAGE_H
+#define _OPENCOG_REPLICA_STORAGE_H
+
+#include <atomic>
+
+#include <opencog/persist/api/StorageNode.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * A StorageNode made of other StorageNodes. Reads are sent to one of
+ * the "read parts", and writes to all of the "write parts". Thus, with
+ * a database that has read-only replicas, reads can be spread over
+ * the replicas, while writes go to the primary; or, with no database
+ * replication at all, every write can be teed to several places.
+ *
+ * The parts are given as Values on this Node, before it is opened:
+ *
+ *    (define rsn (ReplicaStorageNode "round-robin"))
+ *    (cog-set-value! rsn (Predicate "*-write-parts-*")
+ *       (List (PostgresStorageNode "postgres://primary/db")))
+ *    (cog-set-value! rsn (Predicate "*-read-parts-*")
+ *       (List (PostgresStorageNode "postgres://replica-1/db")
+ *             (PostgresStorageNode "postgres://replica-2/db")))
+ *    (cog-open rsn)
+ *
+ * The name says how a read part is picked. With "round-robin", which
+ * is the default, each read goes to the next one. With "nearest-first"
+ * they are tried in the order given. Either way, if a part fails, the
+ * read is tried on the next one. If there are no read parts, reads
+ * go to the first of the write parts.
+ *
+ * Opening this opens any part that is not yet open; closing it closes
+ * those again. `barrier()` waits on every part, so that when it
+ * returns, every write made before it has landed everywhere.
+ *
+ * Only the StorageNode interfaces are used; the parts can be any kind
+ * of StorageNode.
+ */
+class ReplicaStorageNode : public StorageNode
+{
+	private:
+		bool _nearest_first;
+		bool _open;
+		std::vector<StorageNodePtr> _readers;
+		std::vector<StorageNodePtr> _writers;
+		std::vector<StorageNodePtr> _opened;
+		std::atomic<size_t> _next;
+
+		std::vector<StorageNodePtr> get_parts(const char*);
+		void check_open(void);
+
+		template<typename F> auto read(F&&);
+		template<typename F> void write(F&&);
+
+	public:
+		ReplicaStorageNode(Type t, const std::string& name);
+		virtual ~ReplicaStorageNode();
+
+		void open(void);
+		void close(void);
+		bool connected(void);
+
+		void create(void);
+		void destroy(void);
+		void erase(void);
+
+		std::string monitor(void);
+
+		// AtomStorage interface
+		Handle getNode(Type, const char *);
+		Handle getLink(Type, const HandleSeq&);
+		void getAtom(const Handle&);
+		void getAtoms(const HandleSeq&);
+		void fetchIncomingSet(AtomSpace*, const Handle&);
+		void fetchIncomingSets(AtomSpace*, const HandleSeq&);
+		void fetchIncomingByType(AtomSpace*, const Handle&, Type t);
+		void storeAtom(const Handle&, bool synchronous = false);
+		void storeAtoms(const HandleSeq&, bool synchronous = false);
+		void removeAtom(const Handle&, bool recursive);
+		void storeValue(const Handle&, const Handle&);
+		void loadValue(const Handle&, const Handle&);
+		void loadValues(const HandleSeq&, const Handle&);
+		void loadType(AtomSpace*, Type);
+		void barrier();
+
+		// Large-scale loads and saves
+		void loadAtomSpace(AtomSpace*);
+		void storeAtomSpace(const AtomSpace*);
+		Handle loadFrameDAG(AtomSpace*);
+
+		static Handle factory(const Handle&);
+};
+
+typedef std::shared_ptr<ReplicaStorageNode> ReplicaStorageNodePtr;
+static inline ReplicaStorageNodePtr ReplicaStorageNodeCast(const Handle& h)
+   { return std::dynamic_pointer_cast<ReplicaStorageNode>(h); }
+static inline ReplicaStorageNodePtr ReplicaStorageNodeCast(AtomPtr a)
+   { return std::dynamic_pointer_cast<ReplicaStorageNode>(a); }
+
+#define createReplicaStorageNode std::make_shared<ReplicaStorageNode>
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_REPLICA_STORAGE_H
@@ -0,0 +1,512 @@
+/*
+ * opencog/persist/api/ShardStorage.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/value/LinkValue.h>
+#include <opencog/atoms/value/StringValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "ShardStorage.h"
+
+using namespace opencog;
+
+#define SHARD_MAP_KEY "*-shard-map-*"
+
+ShardStorageNode::ShardStorageNode(Type t, const std::string& name)
+	: StorageNode(t, name)
+{
+	_open = false;
+}
+
+ShardStorageNode::~ShardStorageNode()
+{
+}
+
+// ====================================================================
+
+/// The StorageNodes listed at "*-shard-parts-*", either in a Link,
+/// or in a LinkValue.
+std::vector<StorageNodePtr> ShardStorageNode::get_parts(void)
+{
+	ValuePtr vp = getValue(_atom_space->add_node(PREDICATE_NODE,
+		"*-shard-parts-*"));
+
+	HandleSeq hs;
+	if (nullptr == vp)
+		;
+	else if (vp->is_atom() and HandleCast(vp)->is_link())
+		hs = HandleCast(vp)->getOutgoingSet();
+	else if (nameserver().isA(vp->get_type(), LINK_VALUE))
+		hs = LinkValueCast(vp)->to_handle_seq();
+
+	if (hs.empty())
+		throw RuntimeException(TRACE_INFO,
+			"ShardStorageNode needs a list of StorageNodes at *-shard-parts-*");
+
+	std::vector<StorageNodePtr> parts;
+	for (const Handle& h : hs)
+	{
+		StorageNodePtr stnp = StorageNodeCast(h);
+		if (nullptr == stnp or this == stnp.get())
+			throw RuntimeException(TRACE_INFO,
+				"Expecting StorageNode, got %s", h->to_short_string().c_str());
+		parts.emplace_back(stnp);
+	}
+	return parts;
+}
+
+/// Open those that are not open yet.
+void ShardStorageNode::open_parts(const std::vector<StorageNodePtr>& parts)
+{
+	for (const StorageNodePtr& stnp : parts)
+	{
+		if (stnp->connected()) continue;
+		stnp->open();
+		_opened.push_back(stnp);
+	}
+}
+
+void ShardStorageNode::check_open(void)
+{
+	if (not _open)
+		throw IOException(TRACE_INFO,
+			"ShardStorageNode %s is not open!", get_name().c_str());
+}
+
+// ====================================================================
+// The shard map. Each shard holds, at the key, its own place in the
+// list, followed by the whole list.
+
+ValuePtr ShardStorageNode::shard_map(size_t idx)
+{
+	std::vector<std::string> names;
+	names.push_back(std::to_string(idx));
+	for (const StorageNodePtr& stnp : _parts)
+		names.push_back(stnp->to_short_string());
+	return createStringValue(names);
+}
+
+void ShardStorageNode::check_map(void)
+{
+	Handle key = _atom_space->add_node(PREDICATE_NODE, SHARD_MAP_KEY);
+	for (size_t i = 0; i < _parts.size(); i++)
+	{
+		_atom_space->set_value(key, key, nullptr);
+		_parts[i]->loadValue(key, key);
+		_parts[i]->barrier();
+		ValuePtr vp = key->getValue(key);
+		if (nullptr != vp and *vp != *shard_map(i))
+		{
+			_atom_space->set_value(key, key, nullptr);
+			throw RuntimeException(TRACE_INFO,
+				"The shards do not match the shard map in %s; "
+				"rebalance them first.",
+				_parts[i]->to_short_string().c_str());
+		}
+	}
+	write_map();
+}
+
+void ShardStorageNode::write_map(void)
+{
+	Handle key = _atom_space->add_node(PREDICATE_NODE, SHARD_MAP_KEY);
+	for (size_t i = 0; i < _parts.size(); i++)
+	{
+		_atom_space->set_value(key, key, shard_map(i));
+		_parts[i]->storeValue(key, key);
+		_parts[i]->barrier();
+	}
+	_atom_space->set_value(key, key, nullptr);
+}
+
+// ====================================================================
+
+void ShardStorageNode::open(void)
+{
+	if (_open)
+		throw IOException(TRACE_INFO,
+			"ShardStorageNode %s is already open!", get_name().c_str());
+
+	_parts = get_parts();
+	open_parts(_parts);
+	try
+	{
+		check_map();
+	}
+	catch (...)
+	{
+		for (const StorageNodePtr& stnp : _opened)
+			stnp->close();
+		_opened.clear();
+		_parts.clear();
+		throw;
+	}
+	_open = true;
+}
+
+void ShardStorageNode::close(void)
+{
+	if (not _open) return;
+	barrier();
+
+	for (const StorageNodePtr& stnp : _opened)
+		stnp->close();
+
+	_opened.clear();
+	_parts.clear();
+	_open = false;
+}
+
+bool ShardStorageNode::connected(void)
+{
+	if (not _open) return false;
+	for (const StorageNodePtr& stnp : _parts)
+		if (not stnp->connected()) return false;
+	return true;
+}
+
+std::string ShardStorageNode::monitor(void)
+{
+	std::string rpt = "ShardStorageNode with " +
+		std::to_string(_parts.size()) + " shards\n";
+	for (size_t i = 0; i < _parts.size(); i++)
+		rpt += "Shard " + std::to_string(i) + " " +
+			_parts[i]->to_short_string() + ":\n" +
+			_parts[i]->monitor() + "\n";
+	return rpt;
+}
+
+// ====================================================================
+
+/// Run `fn(i)` for every shard, each in its own thread. The first
+/// failure, if any, is rethrown once all of them are done.
+template<typename F>
+void ShardStorageNode::scatter(F&& fn)
+{
+	check_open();
+	size_t nparts = _parts.size();
+	if (1 == nparts) { fn(0); return; }
+
+	std::vector<std::exception_ptr> errs(nparts);
+	std::vector<std::thread> thrs;
+	for (size_t i = 0; i < nparts; i++)
+		thrs.emplace_back([&, i]()
+		{
+			try { fn(i); }
+			catch (...) { errs[i] = std::current_exception(); }
+		});
+
+	for (std::thread& t : thrs) t.join();
+	for (const std::exception_ptr& ep : errs)
+		if (ep) std::rethrow_exception(ep);
+}
+
+/// Split the Atoms by home shard, and run `fn(i, atoms)` on each shard
+/// that has some, in parallel.
+template<typename F>
+void ShardStorageNode::route(const HandleSeq& hs, F&& fn)
+{
+	check_open();
+	std::vector<HandleSeq> groups(_parts.size());
+	for (const Handle& h : hs)
+		groups[home(h)].push_back(h);
+
+	scatter([&](size_t i)
+	{
+		if (not groups[i].empty()) fn(i, groups[i]);
+	});
+}
+
+// ====================================================================
+// Reads: from the home shard, if there is one; else from all.
+
+Handle ShardStorageNode::getNode(Type t, const char* name)
+{
+	check_open();
+	Handle h(createNode(t, name));
+	return _parts[home(h)]->getNode(t, name);
+}
+
+Handle ShardStorageNode::getLink(Type t, const HandleSeq& hs)
+{
+	check_open();
+	Handle h(createLink(hs, t));
+	return _parts[home(h)]->getLink(t, hs);
+}
+
+void ShardStorageNode::getAtom(const Handle& h)
+{
+	check_open();
+	StorageNode* stnp = _parts[home(h)].get();
+	stnp->getAtom(h);
+	stnp->barrier();
+}
+
+void ShardStorageNode::getAtoms(const HandleSeq& hs)
+{
+	route(hs, [&](size_t i, const HandleSeq& group)
+	{
+		_parts[i]->getAtoms(group);
+		_parts[i]->barrier();
+	});
+}
+
+void ShardStorageNode::loadValue(const Handle& h, const Handle& key)
+{
+	check_open();
+	StorageNode* stnp = _parts[home(h)].get();
+	stnp->loadValue(h, key);
+	stnp->barrier();
+}
+
+void ShardStorageNode::loadValues(const HandleSeq& hs, const Handle& key)
+{
+	route(hs, [&](size_t i, const HandleSeq& group)
+	{
+		_parts[i]->loadValues(group, key);
+		_parts[i]->barrier();
+	});
+}
+
+void ShardStorageNode::fetchIncomingSet(AtomSpace* as, const Handle& h)
+{
+	scatter([&](size_t i)
+	{
+		_parts[i]->fetchIncomingSet(as, h);
+		_parts[i]->barrier();
+	});
+}
+
+void ShardStorageNode::fetchIncomingSets(AtomSpace* as, const HandleSeq& hs)
+{
+	scatter([&](size_t i)
+	{
+		_parts[i]->fetchIncomingSets(as, hs);
+		_parts[i]->barrier();
+	});
+}
+
+void ShardStorageNode::fetchIncomingByType(AtomSpace* as,
+                                           const Handle& h, Type t)
+{
+	scatter([&](size_t i)
+	{
+		_parts[i]->fetchIncomingByType(as, h, t);
+		_parts[i]->barrier();
+	});
+}
+
+void ShardStorageNode::loadType(AtomSpace* as, Type t)
+{
+	scatter([&](size_t i)
+	{
+		_parts[i]->loadType(as, t);
+		_parts[i]->barrier();
+	});
+}
+
+void ShardStorageNode::loadAtomSpace(AtomSpace* as)
+{
+	scatter([&](size_t i)
+	{
+		_parts[i]->loadAtomSpace(as);
+		_parts[i]->barrier();
+	});
+
+	// Every shard has its own map; whichever came in last means
+	// nothing here, and must not be stored back.
+	Handle key = as->get_node(PREDICATE_NODE, SHARD_MAP_KEY);
+	if (key) as->set_value(key, key, nullptr);
+}
+
+// ====================================================================
+// Writes: to the home shard. Removals go everywhere, as there may be
+// copies anywhere.
+
+void ShardStorageNode::storeAtom(const Handle& h, bool synchronous)
+{
+	check_open();
+	_parts[home(h)]->storeAtom(h, synchronous);
+}
+
+void ShardStorageNode::storeAtoms(const HandleSeq& hs, bool synchronous)
+{
+	route(hs, [&](size_t i, const HandleSeq& group)
+	{
+		_parts[i]->storeAtoms(group, synchronous);
+	});
+}
+
+void ShardStorageNode::storeValue(const Handle& h, const Handle& key)
+{
+	check_open();
+	_parts[home(h)]->storeValue(h, key);
+}
+
+void ShardStorageNode::removeAtom(const Handle& h, bool recursive)
+{
+	scatter([&](size_t i) { _parts[i]->removeAtom(h, recursive); });
+}
+
+void ShardStorageNode::storeAtomSpace(const AtomSpace* as)
+{
+	HandleSeq atoms;
+	as->get_handles_by_type(atoms, ATOM, true);
+
+	// Each shard knows its own map; don't clobber them.
+	atoms.erase(std::remove_if(atoms.begin(), atoms.end(),
+		[](const Handle& h) {
+			return PREDICATE_NODE == h->get_type() and
+				0 == h->get_name().compare(SHARD_MAP_KEY); }),
+		atoms.end());
+
+	route(atoms, [&](size_t i, const HandleSeq& group)
+	{
+		_parts[i]->storeAtoms(group);
+		_parts[i]->barrier();
+	});
+}
+
+void ShardStorageNode::create(void)
+{
+	for (const StorageNodePtr& stnp : get_parts())
+		stnp->create();
+}
+
+void ShardStorageNode::destroy(void)
+{
+	for (const StorageNodePtr& stnp : get_parts())
+		stnp->destroy();
+}
+
+void ShardStorageNode::erase(void)
+{
+	scatter([&](size_t i) { _parts[i]->erase(); });
+	write_map();
+}
+
+void ShardStorageNode::barrier(void)
+{
+	check_open();
+	for (const StorageNodePtr& stnp : _parts)
+		stnp->barrier();
+}
+
+// ====================================================================
+
+static size_t height(const Handle& h)
+{
+	size_t hi = 0;
+	for (const Handle& ho : h->getOutgoingSet())
+		hi = std::max(hi, height(ho) + 1);
+	return hi;
+}
+
+void ShardStorageNode::rebalance(const std::vector<StorageNodePtr>& retired)
+{
+	if (_open)
+		throw IOException(TRACE_INFO,
+			"ShardStorageNode %s must be closed to rebalance!",
+			get_name().c_str());
+
+	_parts = get_parts();
+	open_parts(_parts);
+	open_parts(retired);
+	_open = true;
+
+	std::vector<StorageNodePtr> sources(_parts);
+	sources.insert(sources.end(), retired.begin(), retired.end());
+
+	size_t nmoved = 0;
+	for (const StorageNodePtr& src : sources)
+	{
+		AtomSpacePtr tmp = createAtomSpace();
+		src->loadAtomSpace(tmp.get());
+		src->barrier();
+
+		// The Atoms that were at home here, under the old map, are
+		// the ones to move; the others are copies, and the Values on
+		// them may be stale. With no old map, move them all.
+		size_t oldidx = 0, oldn = 1;
+		Handle key = tmp->get_node(PREDICATE_NODE, SHARD_MAP_KEY);
+		if (key)
+		{
+			StringValuePtr svp(StringValueCast(key->getValue(key)));
+			if (svp and 1 < svp->value().size())
+			{
+				oldidx = std::stoul(svp->value()[0]);
+				oldn = svp->value().size() - 1;
+			}
+			tmp->extract_atom(key, true);
+		}
+
+		HandleSeq atoms;
+		tmp->get_handles_by_type(atoms, ATOM, true);
+
+		HandleSeq moved;
+		for (const Handle& h : atoms)
+		{
+			StorageNode* dst = _parts[home(h)].get();
+			if (dst == src.get()) continue;
+			if (h->get_hash() % oldn == oldidx)
+				dst->storeAtom(h);
+			moved.push_back(h);
+		}
+		barrier();
+
+		// Remove from the old place what now lives elsewhere, Links
+		// before the Atoms in them. Atoms still held by Links that
+		// stay are copies; they stay too.
+		std::sort(moved.begin(), moved.end(),
+			[](const Handle& a, const Handle& b)
+			{ return height(a) > height(b); });
+		for (const Handle& h : moved)
+		{
+			if (not h->isIncomingSetEmpty()) continue;
+			src->removeAtom(h, false);
+			tmp->extract_atom(h, false);
+		}
+		src->barrier();
+		nmoved += moved.size();
+	}
+
+	write_map();
+	logger().info("ShardStorageNode: moved %zu Atoms over %zu shards",
+		nmoved, _parts.size());
+
+	for (const StorageNodePtr& stnp : retired)
+	{
+		auto it = std::find(_opened.begin(), _opened.end(), stnp);
+		if (_opened.end() == it) continue;
+		stnp->close();
+		_opened.erase(it);
+	}
+}
+
+DEFINE_NODE_FACTORY(ShardStorageNode, SHARD_STORAGE_NODE)
+
+/* ============================= END OF FILE ================= */
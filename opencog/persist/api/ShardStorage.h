@@ -0,0 +1,141 @@
+/*
+ * opencog/persist/api/ShardStorage.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SHARD_STORAGE_H
+#define _OPENCOG_SHARD_STORAGE_H
+
+#include <opencog/persist/api/StorageNode.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * A StorageNode that spreads the Atoms over several other StorageNodes,
+ * the shards, for datasets too big for any one of them. Each Atom has
+ * a home shard, picked by its content hash, `Atom::get_hash()`; it is
+ * stored there, and its Values are fetched from there. Since a Link
+ * is stored along with its outgoing set, the Atoms in it have copies
+ * on the home shard of the Link, too; the Values on those copies may
+ * be older than those at home. A fetch of the Atom itself always goes
+ * home.
+ *
+ * The Links holding an Atom may be on any shard; incoming sets, loads
+ * of a type, and of the whole AtomSpace, ask every shard at once, in
+ * parallel, and gather what comes back. Queries, run by `runQuery()`,
+ * are made of such fetches.
+ *
+ * The shards are given as a Value on this Node, before it is opened:
+ *
+ *    (define ssn (ShardStorageNode "shards"))
+ *    (cog-set-value! ssn (Predicate "*-shard-parts-*")
+ *       (List (PostgresStorageNode "postgres:///shard-0")
+ *             (PostgresStorageNode "postgres:///shard-1")))
+ *    (cog-open ssn)
+ *
+ * Which shard is where is the shard map. It is written into each of
+ * the shards the first time they are opened together; opening them
+ * afterwards with another list, or in another order, fails, as the
+ * Atoms would no longer be found. To change the list, use
+ * `rebalance()`: it moves every Atom to its new home, also draining
+ * the shards that are to be retired, and records the new map.
+ */
+class ShardStorageNode : public StorageNode
+{
+	private:
+		bool _open;
+		std::vector<StorageNodePtr> _parts;
+		std::vector<StorageNodePtr> _opened;
+
+		std::vector<StorageNodePtr> get_parts(void);
+		void open_parts(const std::vector<StorageNodePtr>&);
+		void check_open(void);
+		ValuePtr shard_map(size_t);
+		void check_map(void);
+		void write_map(void);
+		size_t home(const Handle& h) const
+			{ return h->get_hash() % _parts.size(); }
+
+		template<typename F> void scatter(F&&);
+		template<typename F> void route(const HandleSeq&, F&&);
+
+	public:
+		ShardStorageNode(Type t, const std::string& name);
+		virtual ~ShardStorageNode();
+
+		void open(void);
+		void close(void);
+		bool connected(void);
+
+		void create(void);
+		void destroy(void);
+		void erase(void);
+
+		std::string monitor(void);
+
+		/**
+		 * Move every Atom to its home under the current list of
+		 * shards, draining the `retired` ones entirely, and record
+		 * the new shard map. The node must not be open; it is, when
+		 * this returns. This loads each shard into RAM in turn, so it
+		 * needs room for the biggest one.
+		 */
+		void rebalance(const std::vector<StorageNodePtr>& retired);
+
+		// AtomStorage interface
+		Handle getNode(Type, const char *);
+		Handle getLink(Type, const HandleSeq&);
+		void getAtom(const Handle&);
+		void getAtoms(const HandleSeq&);
+		void fetchIncomingSet(AtomSpace*, const Handle&);
+		void fetchIncomingSets(AtomSpace*, const HandleSeq&);
+		void fetchIncomingByType(AtomSpace*, const Handle&, Type t);
+		void storeAtom(const Handle&, bool synchronous = false);
+		void storeAtoms(const HandleSeq&, bool synchronous = false);
+		void removeAtom(const Handle&, bool recursive);
+		void storeValue(const Handle&, const Handle&);
+		void loadValue(const Handle&, const Handle&);
+		void loadValues(const HandleSeq&, const Handle&);
+		void loadType(AtomSpace*, Type);
+		void barrier();
+
+		// Large-scale loads and saves
+		void loadAtomSpace(AtomSpace*);
+		void storeAtomSpace(const AtomSpace*);
+
+		static Handle factory(const Handle&);
+};
+
+typedef std::shared_ptr<ShardStorageNode> ShardStorageNodePtr;
+static inline ShardStorageNodePtr ShardStorageNodeCast(const Handle& h)
+   { return std::dynamic_pointer_cast<ShardStorageNode>(h); }
+static inline ShardStorageNodePtr ShardStorageNodeCast(AtomPtr a)
+   { return std::dynamic_pointer_cast<ShardStorageNode>(a); }
+
+#define createShardStorageNode std::make_shared<ShardStorageNode>
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_SHARD_STORAGE_H
@@ -21,8 +21,14 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <string>
+#include <thread>
+#include <unordered_set>
 
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Trace.h>
+#include <opencog/atoms/pattern/PatternLink.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/persist/storage/storage_types.h>
 #include "StorageNode.h"
@@ -51,22 +57,37 @@ std::string StorageNode::monitor(void)
 
 void StorageNode::barrier(void)
 {
+	TRACE_SPAN("barrier", this);
 	getAtomSpace()->barrier();
 }
 
 void StorageNode::store_atom(const Handle& h)
 {
+	TRACE_SPAN("store_atom", this);
 	if (_atom_space->get_read_only())
 		throw RuntimeException(TRACE_INFO, "Read-only AtomSpace!");
 
+	invalidate_queries();
 	storeAtom(h);
 }
 
+void StorageNode::store_atoms(const HandleSeq& hs)
+{
+	TRACE_SPAN("store_atoms", this);
+	if (_atom_space->get_read_only())
+		throw RuntimeException(TRACE_INFO, "Read-only AtomSpace!");
+
+	invalidate_queries();
+	storeAtoms(hs);
+}
+
 void StorageNode::store_value(const Handle& h, const Handle& key)
 {
+	TRACE_SPAN("store_value", this);
 	if (_atom_space->get_read_only())
 		throw RuntimeException(TRACE_INFO, "Read-only AtomSpace!");
 
+	invalidate_queries();
 	storeValue(h, key);
 }
 
@@ -96,13 +117,107 @@ bool StorageNode::remove_atom(Handle h, bool recursive)
 	// it is acting as a cache for the database, and removal is used
 	// used to free up RAM storage.
 	if (not _atom_space->get_read_only())
+	{
+		invalidate_queries();
 		removeAtom(h, recursive);
+	}
 
 	return getAtomSpace()->extract_atom(h, recursive);
 }
 
+/// The length of the longest path down to a Node.
+static size_t depth(const Handle& h)
+{
+	size_t d = 0;
+	for (const Handle& ho : h->getOutgoingSet())
+		d = std::max(d, 1 + depth(ho));
+	return d;
+}
+
+/// All of the frames at and under `as`, each one after those it sits
+/// on; so that an Atom is always stored after its outgoing set.
+static void collect_frames(AtomSpace* as, std::vector<AtomSpace*>& frames,
+                           std::unordered_set<AtomSpace*>& seen)
+{
+	if (not seen.insert(as).second) return;
+	for (const Handle& base : as->getOutgoingSet())
+		collect_frames(AtomSpaceCast(base).get(), frames, seen);
+	frames.push_back(as);
+}
+
+size_t StorageNode::sync_frame(AtomSpace* frame, bool layered)
+{
+	// Start tracking before the full store, so that nothing done
+	// while it runs gets missed. Whatever is logged in the meantime
+	// is written again next time; that is harmless.
+	if (not frame->tracking_changes())
+	{
+		frame->track_changes(true);
+		if (not layered)
+		{
+			storeAtomSpace(frame);
+			return frame->get_size();
+		}
+
+		// Just the Atoms in this frame; not those below it.
+		HandleSeq own;
+		frame->get_handles_by_type(own, ATOM, true, false);
+		if (0 < own.size())
+			storeAtoms(own);
+		return own.size();
+	}
+
+	AtomSpace::Changes ch(frame->take_changes());
+
+	// Links must go before the Atoms they hold; else storage will
+	// refuse to remove those, as they still have an incoming set.
+	std::vector<std::pair<size_t, Handle>> byd;
+	for (const Handle& h : ch.removed)
+		byd.emplace_back(depth(h), h);
+	std::sort(byd.begin(), byd.end(),
+		[](const std::pair<size_t, Handle>& a,
+		   const std::pair<size_t, Handle>& b)
+		{ return a.first > b.first; });
+	for (const auto& dh : byd)
+		removeAtom(dh.second, false);
+
+	if (0 < ch.added.size())
+		storeAtoms(ch.added);
+
+	for (const auto& hk : ch.values)
+		storeValue(hk.first, hk.second);
+
+	return ch.removed.size() + ch.added.size() + ch.values.size();
+}
+
+size_t StorageNode::sync(void)
+{
+	AtomSpace* as = getAtomSpace();
+	if (as->get_read_only())
+		throw RuntimeException(TRACE_INFO, "Read-only AtomSpace!");
+
+	invalidate_queries();
+
+	std::vector<AtomSpace*> frames;
+	std::unordered_set<AtomSpace*> seen;
+	collect_frames(as, frames, seen);
+
+	// Each frame keeps its own log; frames that did not change since
+	// the last sync cost no more than looking at an empty log.
+	bool layered = 1 < frames.size();
+	size_t nchanged = 0;
+	for (AtomSpace* frame : frames)
+		nchanged += sync_frame(frame, layered);
+
+	barrier();
+	return nchanged;
+}
+
+// ====================================================================
+
 Handle StorageNode::fetch_atom(const Handle& h)
 {
+	TRACE_SPAN("fetch_atom", this);
 	if (nullptr == h) return Handle::UNDEFINED;
 
 	// Now, get the latest values from the backing store.
@@ -114,11 +229,13 @@ Handle StorageNode::fetch_atom(const Handle& h)
 	Handle ah = _atom_space->add_atom(h);
 	if (nullptr == ah) return ah; // if read-only, then cannot update.
 	getAtom(ah);
+	prefetch(ah, 0);
 	return ah;
 }
 
 Handle StorageNode::fetch_value(const Handle& h, const Handle& key)
 {
+	TRACE_SPAN("fetch_value", this);
 	// Make sure we are working with Atoms in this Atomspace.
 	// Not clear if we really have to do this, or if its enough
 	// to just assume  that they are. Could save a few CPU cycles,
@@ -129,8 +246,98 @@ Handle StorageNode::fetch_value(const Handle& h, const Handle& key)
 	return lh;
 }
 
+// The bulk loads below put off the analysis of the patterns that they
+// bring in, until those are run; most never are.
+
+HandleSeq StorageNode::fetch_atoms(const HandleSeq& hs)
+{
+	TRACE_SPAN("fetch_atoms", this);
+	PatternLink::Deferral defer;
+	HandleSeq ahs;
+	ahs.reserve(hs.size());
+	for (const Handle& h : hs)
+	{
+		if (nullptr == h) continue;
+		Handle ah = _atom_space->add_atom(h);
+		if (nullptr == ah) continue; // if read-only, then cannot update.
+		ahs.emplace_back(ah);
+	}
+	getAtoms(ahs);
+	for (const Handle& ah : ahs)
+		prefetch(ah, 0);
+	return ahs;
+}
+
+HandleSeq StorageNode::fetch_values(const HandleSeq& hs, const Handle& key)
+{
+	PatternLink::Deferral defer;
+	Handle lkey = getAtomSpace()->add_atom(key);
+	HandleSeq lhs;
+	lhs.reserve(hs.size());
+	for (const Handle& h : hs)
+		lhs.emplace_back(getAtomSpace()->add_atom(h));
+	loadValues(lhs, lkey);
+	return lhs;
+}
+
+HandleSeq StorageNode::fetch_incoming_sets(const HandleSeq& hs)
+{
+	PatternLink::Deferral defer;
+	HandleSeq lhs;
+	lhs.reserve(hs.size());
+	for (const Handle& h : hs)
+	{
+		Handle lh = _atom_space->get_atom(h);
+		if (nullptr != lh) lhs.emplace_back(lh);
+	}
+	fetchIncomingSets(_atom_space, lhs);
+	for (const Handle& lh : lhs)
+		prefetch_incoming(lh, ATOM);
+	return lhs;
+}
+
+/// Run the fetch in a thread of its own, and put what it returns
+/// into the queue. The thread holds on to this StorageNode, so that
+/// it cannot go away while the fetch is underway.
+QueueValuePtr StorageNode::run_async(
+	const std::function<HandleSeq(StorageNode*)>& fetch)
+{
+	QueueValuePtr qv(createQueueValue());
+	StorageNodePtr self(StorageNodeCast(get_handle()));
+	std::thread([self, qv, fetch]()
+	{
+		try
+		{
+			HandleSeq hs(fetch(self.get()));
+			self->barrier();
+			for (const Handle& h : hs)
+				qv->push(h);
+		}
+		catch (const std::exception& ex)
+		{
+			logger().warn("StorageNode: fetch from %s failed: %s",
+			              self->get_name().c_str(), ex.what());
+		}
+		qv->close();
+	}).detach();
+	return qv;
+}
+
+QueueValuePtr StorageNode::fetch_atoms_async(const HandleSeq& hs)
+{
+	return run_async([hs](StorageNode* stnp)
+		{ return stnp->fetch_atoms(hs); });
+}
+
+QueueValuePtr StorageNode::fetch_incoming_sets_async(const HandleSeq& hs)
+{
+	return run_async([hs](StorageNode* stnp)
+		{ return stnp->fetch_incoming_sets(hs); });
+}
+
 Handle StorageNode::fetch_incoming_set(const Handle& h, bool recursive)
 {
+	TRACE_SPAN("fetch_incoming_set", this);
 	// Make sure we are working with Atoms in this Atomspace.
 	// Not clear if we really have to do this, or if its enough
 	// to just assume  that they are. Could save a few CPU cycles,
@@ -139,7 +346,9 @@ Handle StorageNode::fetch_incoming_set(const Handle& h, bool recursive)
 	if (nullptr == lh) return lh;
 
 	// Get everything from the backing store.
+	PatternLink::Deferral defer;
 	fetchIncomingSet(_atom_space, lh);
+	prefetch_incoming(lh, ATOM);
 
 	if (not recursive) return lh;
 
@@ -152,6 +361,7 @@ Handle StorageNode::fetch_incoming_set(const Handle& h, bool recursive)
 
 Handle StorageNode::fetch_incoming_by_type(const Handle& h, Type t)
 {
+	TRACE_SPAN("fetch_incoming_by_type", this);
 	// Make sure we are working with Atoms in this Atomspace.
 	// Not clear if we really have to do this, or if its enough
 	// to just assume  that they are. Could save a few CPU cycles,
@@ -160,14 +370,182 @@ Handle StorageNode::fetch_incoming_by_type(const Handle& h, Type t)
 	if (nullptr == lh) return lh;
 
 	// Get everything from the backing store.
+	PatternLink::Deferral defer;
 	fetchIncomingByType(getAtomSpace(), lh, t);
+	prefetch_incoming(lh, t);
 
 	return lh;
 }
 
+// ====================================================================
+// Prefetching. Each Atom on the queue is at some number of hops from
+// a fetch that was asked for. Its Values, and its outgoing closure,
+// are fetched as the policy says; and, if it is fewer than the policy
+// allows hops out, so is its incoming set. The links in that set, and
+// the other Atoms in those links, are then queued up in turn. The
+// queue is worked on in batches, by a thread that runs only while
+// there is something on it, and that holds on to this StorageNode
+// while it does.
+
+static constexpr size_t PREFETCH_MEMORY = 1 << 20;
+
+void StorageNode::set_prefetch(const PrefetchPolicy& pol)
+{
+	std::lock_guard<std::mutex> lck(_pf_mtx);
+	_pf = pol;
+	_pf_seen.clear();
+	_pf_on = pol.outgoing or 0 < pol.hops or 0 < pol.keys.size();
+	if (not _pf_on) _pf_todo.clear();
+}
+
+StorageNode::PrefetchPolicy StorageNode::get_prefetch(void)
+{
+	std::lock_guard<std::mutex> lck(_pf_mtx);
+	return _pf;
+}
+
+void StorageNode::prefetch_barrier(void)
+{
+	std::unique_lock<std::mutex> lck(_pf_mtx);
+	_pf_idle.wait(lck, [this]() { return not _pf_running; });
+}
+
+void StorageNode::prefetch(const Handle& h, size_t hops)
+{
+	if (not _pf_on.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> lck(_pf_mtx);
+	if (not _pf_on) return;
+
+	// Skip what has already been looked at, as close by. The memory of
+	// that is not allowed to grow without bound; forgetting costs only
+	// some repeated prefetches.
+	if (PREFETCH_MEMORY < _pf_seen.size()) _pf_seen.clear();
+	auto it = _pf_seen.find(h);
+	if (_pf_seen.end() != it and it->second <= hops) return;
+	_pf_seen[h] = hops;
+	_pf_todo.emplace_back(h, hops);
+
+	if (_pf_running) return;
+	_pf_running = true;
+	StorageNodePtr self(StorageNodeCast(get_handle()));
+	std::thread([self]() { self->prefetch_loop(); }).detach();
+}
+
+// The incoming set of `h`, of type `t`, was just fetched; carry on
+// from there.
+void StorageNode::prefetch_incoming(const Handle& h, Type t)
+{
+	if (not _pf_on.load(std::memory_order_relaxed)) return;
+
+	size_t hops = get_prefetch().hops;
+	IncomingSet iset(ATOM == t ?
+		h->getIncomingSet(_atom_space) :
+		h->getIncomingSetByType(t, _atom_space));
+	for (const Handle& lnk : iset)
+	{
+		prefetch(lnk, hops);
+		for (const Handle& ho : lnk->getOutgoingSet())
+			if (ho != h) prefetch(ho, 1);
+	}
+}
+
+void StorageNode::prefetch_loop(void)
+{
+	while (true)
+	{
+		PrefetchPolicy pol;
+		std::vector<std::pair<Handle, size_t>> batch;
+		{
+			std::lock_guard<std::mutex> lck(_pf_mtx);
+			if (_pf_todo.empty())
+			{
+				_pf_running = false;
+				_pf_idle.notify_all();
+				return;
+			}
+			pol = _pf;
+			batch.assign(_pf_todo.begin(), _pf_todo.end());
+			_pf_todo.clear();
+		}
+
+		try
+		{
+			prefetch_batch(pol, batch);
+		}
+		catch (const std::exception& ex)
+		{
+			logger().warn("StorageNode: prefetch from %s failed: %s",
+			              get_name().c_str(), ex.what());
+		}
+	}
+}
+
+static void outgoing_closure(const Handle& h, HandleSet& closure)
+{
+	for (const Handle& ho : h->getOutgoingSet())
+		if (closure.insert(ho).second and ho->is_link())
+			outgoing_closure(ho, closure);
+}
+
+void StorageNode::prefetch_batch(const PrefetchPolicy& pol,
+               const std::vector<std::pair<Handle, size_t>>& batch)
+{
+	TRACE_SPAN("prefetch", this);
+	PatternLink::Deferral defer;
+	AtomSpace* as = getAtomSpace();
+
+	HandleSeq atoms;
+	HandleSeq expand;
+	HandleSet closure;
+	for (const auto& pr : batch)
+	{
+		atoms.push_back(pr.first);
+		if (pr.second < pol.hops) expand.push_back(pr.first);
+		if (pol.outgoing and pr.first->is_link())
+			outgoing_closure(pr.first, closure);
+	}
+
+	if (0 < closure.size())
+		getAtoms(HandleSeq(closure.begin(), closure.end()));
+
+	for (const Handle& key : pol.keys)
+	{
+		Handle lkey = as->add_atom(key);
+		if (lkey) loadValues(atoms, lkey);
+	}
+
+	if (0 == expand.size()) return;
+
+	if (ATOM == pol.incoming_type)
+		fetchIncomingSets(as, expand);
+	else
+		for (const Handle& h : expand)
+			fetchIncomingByType(as, h, pol.incoming_type);
+	barrier();
+
+	for (const auto& pr : batch)
+	{
+		if (pol.hops <= pr.second) continue;
+		const Handle& h = pr.first;
+		IncomingSet iset(ATOM == pol.incoming_type ?
+			h->getIncomingSet(as) :
+			h->getIncomingSetByType(pol.incoming_type, as));
+		for (const Handle& lnk : iset)
+		{
+			prefetch(lnk, pol.hops);
+			for (const Handle& ho : lnk->getOutgoingSet())
+				if (ho != h) prefetch(ho, pr.second + 1);
+		}
+	}
+}
+
+// ====================================================================
+
 Handle StorageNode::fetch_query(const Handle& query, const Handle& key,
 							const Handle& metadata, bool fresh)
 {
+	TRACE_SPAN("fetch_query", this);
 	// At this time, we restrict queries to be ... queries.
 	Type qt = query->get_type();
 	if (not nameserver().isA(qt, JOIN_LINK) and
@@ -189,6 +567,8 @@ Handle StorageNode::fetch_query(const Handle& query, const Handle& key,
 
 void StorageNode::load_atomspace(void)
 {
+	TRACE_SPAN("load_atomspace", this);
+	PatternLink::Deferral defer;
 	loadAtomSpace(getAtomSpace());
 }
 
@@ -197,16 +577,21 @@ void StorageNode::load_atomspace(void)
  */
 void StorageNode::store_atomspace(void)
 {
+	TRACE_SPAN("store_atomspace", this);
+	invalidate_queries();
 	storeAtomSpace(getAtomSpace());
 }
 
 void StorageNode::fetch_all_atoms_of_type(Type t)
 {
+	TRACE_SPAN("fetch_all_atoms_of_type", this);
+	PatternLink::Deferral defer;
 	loadType(getAtomSpace(), t);
 }
 
 Handle StorageNode::load_frames(void)
 {
+	PatternLink::Deferral defer;
 	return loadFrameDAG(getAtomSpace());
 }
 
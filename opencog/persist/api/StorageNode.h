@@ -25,7 +25,15 @@
 #ifndef _OPENCOG_STORAGE_NODE_H
 #define _OPENCOG_STORAGE_NODE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
 #include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/QueueValue.h>
 #include <opencog/persist/api/BackingStore.h>
 #include <opencog/persist/storage/storage_types.h>
 
@@ -36,6 +44,50 @@ namespace opencog
  */
 class StorageNode : public Node, protected BackingStore
 {
+	friend class ReplicaStorageNode;
+	friend class ShardStorageNode;
+
+	size_t sync_frame(AtomSpace*, bool);
+	QueueValuePtr run_async(const std::function<HandleSeq(StorageNode*)>&);
+
+public:
+	/**
+	 * What to fetch ahead of a walker; see `set_prefetch()`.
+	 */
+	struct PrefetchPolicy
+	{
+		/// Fetch the outgoing closure of every link brought in,
+		/// together with the Values on it.
+		bool outgoing = false;
+
+		/// Fetch the incoming sets of the Atoms brought in, and then
+		/// those of their neighbors, out to this many hops. Only links
+		/// of `incoming_type` are fetched; ATOM, for all of them.
+		size_t hops = 0;
+		Type incoming_type = ATOM;
+
+		/// Fetch the Values at these keys, on every Atom brought in.
+		HandleSeq keys;
+	};
+
+private:
+	// Prefetching. The Atoms still to be looked at, with the number
+	// of hops they are from a fetch that was asked for; and, for those
+	// already looked at, the fewest hops they were seen at.
+	std::mutex _pf_mtx;
+	std::condition_variable _pf_idle;
+	PrefetchPolicy _pf;
+	std::atomic<bool> _pf_on{false};
+	bool _pf_running = false;
+	std::deque<std::pair<Handle, size_t>> _pf_todo;
+	std::unordered_map<Handle, size_t> _pf_seen;
+
+	void prefetch(const Handle&, size_t hops);
+	void prefetch_incoming(const Handle&, Type);
+	void prefetch_loop(void);
+	void prefetch_batch(const PrefetchPolicy&,
+	                    const std::vector<std::pair<Handle, size_t>>&);
+
 public:
 	StorageNode(Type, std::string);
 	virtual ~StorageNode();
@@ -126,6 +178,15 @@ public:
 	 */
 	Handle fetch_value(const Handle& atom, const Handle& key);
 
+	/**
+	 * Batch forms of `fetch_atom()` and `fetch_value()`. Each Atom
+	 * is added to this AtomSpace, and the whole batch is handed to
+	 * storage at once. The returned sequence holds the Atoms in this
+	 * AtomSpace, in the same order.
+	 */
+	HandleSeq fetch_atoms(const HandleSeq&);
+	HandleSeq fetch_values(const HandleSeq& atoms, const Handle& key);
+
 	/**
 	 * Use the backing store to load all atoms of the given atom type.
 	 */
@@ -164,6 +225,45 @@ public:
 	 */
 	Handle fetch_incoming_set(const Handle&, bool=false);
 
+	/**
+	 * Batch form of the above, not recursive. Atoms that are not in
+	 * this AtomSpace are skipped.
+	 */
+	HandleSeq fetch_incoming_sets(const HandleSeq&);
+
+	/**
+	 * Prefetching. Graph walks over a lazily-loaded AtomSpace fetch
+	 * one hop at a time, and so pay a round-trip to storage for each
+	 * hop. With a prefetch policy in place, each `fetch_atom()`,
+	 * `fetch_atoms()`, `fetch_incoming_set()`, `fetch_incoming_sets()`
+	 * and `fetch_incoming_by_type()` also queues up, in the background,
+	 * the fetches that the walk is likely to make next, as given by
+	 * the policy. These are batched, where storage allows it, and
+	 * populate the AtomSpace ahead of the walker. Each Atom is
+	 * prefetched for only once, per policy; Values fetched for it
+	 * are not refreshed later on.
+	 *
+	 * The policy applies to the fetches made after it is set; the
+	 * prefetches already queued are carried out under the new policy.
+	 * A default-constructed policy turns prefetching off.
+	 */
+	void set_prefetch(const PrefetchPolicy&);
+	PrefetchPolicy get_prefetch(void);
+
+	/// Block until every prefetch queued so far has been done.
+	void prefetch_barrier(void);
+
+	/**
+	 * Non-blocking forms of `fetch_atoms()` and `fetch_incoming_sets()`.
+	 * These return at once; the fetch runs in a thread of its own, and
+	 * the Atoms are placed in the returned QueueValue once they are in
+	 * the AtomSpace. The queue is closed after the last one, or if the
+	 * fetch fails. A caller can thus start many fetches, on many
+	 * StorageNodes, and only then wait for all of them.
+	 */
+	QueueValuePtr fetch_atoms_async(const HandleSeq&);
+	QueueValuePtr fetch_incoming_sets_async(const HandleSeq&);
+
 	/**
 	 * Use the backing store to load the incoming set of the
 	 * atom, but only those atoms of the given type.
@@ -216,6 +316,11 @@ public:
 	 */
 	void store_atom(const Handle& h);
 
+	/**
+	 * Batch form of the above.
+	 */
+	void store_atoms(const HandleSeq&);
+
 	/**
 	 * Store the Value located at `key` on `atom` to the remote
 	 * server. If the `atom` does not yet exist on the remote
@@ -245,6 +350,28 @@ public:
 	 *         removed. False, otherwise.
 	 */
 	bool remove_atom(Handle h, bool recursive=false);
+
+	/**
+	 * Write out everything that changed in the AtomSpace since the
+	 * last sync: the Atoms added, the Atoms removed, and the Values
+	 * that were set. The first call stores the entire AtomSpace, and
+	 * starts change tracking on it; see `AtomSpace::track_changes()`.
+	 * So a checkpoint costs in proportion to the churn, and not the
+	 * size of the AtomSpace.
+	 *
+	 * If the AtomSpace sits on top of others, then every frame under
+	 * it is synced, base frames first. Each frame has its own change
+	 * log; a frame is stored in full the first time it is seen, and
+	 * after that, only if it changed. In a deep stack of frames, where
+	 * only the top few are ever written to, the frames below cost
+	 * nothing more, once they have been stored.
+	 *
+	 * The change log belongs to the AtomSpace, and is emptied by each
+	 * sync; so only one StorageNode should be syncing a given
+	 * AtomSpace. Returns how many Atoms and Values were written or
+	 * removed.
+	 */
+	size_t sync(void);
 };
 
 typedef std::shared_ptr<StorageNode> StorageNodePtr;
@@ -0,0 +1,417 @@
+/*
+ * DistExec.cc
+ * Distributed execution of Atomese, in batches, over Gearman.
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <opencog/util/Logger.h>
+#include <opencog/persist/sexpr/BinaryCommands.h>
+#include <opencog/persist/sexpr/Sexpr.h>
+
+#include "DistExec.h"
+
+using namespace opencog;
+
+const char* DistExec::FUNCTION = "atomese_batch";
+
+// ==============================================================
+// The worker end.
+
+/// Perform one job, sending back each result as it is computed.
+gearman_return_t DistExec::worker_function(gearman_job_st* job, void* context)
+{
+	AtomSpace* as = (AtomSpace*) context;
+	WireTypes types;
+
+	std::string_view in((const char*) gearman_job_workload(job),
+	                    gearman_job_workload_size(job));
+	uint8_t op = 0;
+	Handle fn;
+	HandleSeq items;
+	try
+	{
+		std::string_view frame;
+		if (not WireReader::next_frame(in, frame))
+			throw IOException(TRACE_INFO, "Job is truncated");
+
+		WireReader rd(frame, types);
+		op = rd.u8();
+		if (EXEC == op)
+		{
+			uint64_t n = rd.varint();
+			for (uint64_t i = 0; i < n; i++)
+				items.emplace_back(as->add_atom(rd.atom()));
+		}
+		else if (MAP == op)
+		{
+			fn = as->add_atom(rd.atom());
+			Type t = rd.type();
+			uint64_t part = rd.varint();
+			uint64_t nparts = rd.varint();
+			if (nparts <= part)
+				throw IOException(TRACE_INFO, "Bad partition %lu of %lu",
+					(unsigned long) part, (unsigned long) nparts);
+
+			HandleSeq all;
+			as->get_handles_by_type(all, t, true);
+			for (const Handle& h : all)
+				if (part == h->get_hash() % nparts)
+					items.push_back(h);
+
+			// The same order every time, so that a retry can pick up
+			// where the last attempt left off.
+			std::sort(items.begin(), items.end());
+		}
+		else
+			throw IOException(TRACE_INFO, "Unknown job %d", int(op));
+	}
+	catch (const std::exception& ex)
+	{
+		logger().warn("DistExec: bad job: %s", ex.what());
+		return GEARMAN_FAIL;
+	}
+
+	uint32_t total = items.size();
+	if (gearman_failed(gearman_job_send_status(job, 0, total)))
+		return GEARMAN_ERROR;
+
+	for (uint32_t i = 0; i < total; i++)
+	{
+		std::string out;
+		try
+		{
+			Handle h(items[i]);
+			if (MAP == op) h = as->add_link(PUT_LINK, fn, h);
+
+			ValuePtr vp(h);
+			if (h->is_executable()) vp = h->execute(as);
+
+			// A PutLink gives back the body, with the argument in
+			// place; that is what is to be run.
+			if (MAP == op and nullptr != vp and vp->is_atom() and
+			    HandleCast(vp)->is_executable())
+				vp = HandleCast(vp)->execute(as);
+
+			WireWriter wr(out, types);
+			wr.begin(BinaryCommands::OK);
+			wr.value(vp);
+			wr.end();
+		}
+		catch (const std::exception& ex)
+		{
+			out.clear();
+			WireWriter wr(out, types);
+			wr.begin(BinaryCommands::FAILED);
+			wr.str(ex.what());
+			wr.end();
+		}
+
+		// On error, the job goes back to the server, to be tried again.
+		if (gearman_failed(gearman_job_send_data(job, out.data(), out.size())))
+			return GEARMAN_ERROR;
+		if (gearman_failed(gearman_job_send_status(job, i+1, total)))
+			return GEARMAN_ERROR;
+	}
+
+	return GEARMAN_SUCCESS;
+}
+
+// ==============================================================
+// The client end.
+
+DistExec::DistExec(AtomSpace* as, const std::string& host,
+                   unsigned retries, unsigned timeout) :
+	_as(AtomSpaceCast(as)),
+	_retries(retries),
+	_timeout(timeout),
+	_pending(0)
+{
+	_client = gearman_client_create(nullptr);
+	if (nullptr == _client)
+		throw RuntimeException(TRACE_INFO,
+			"Gearman: Memory allocation failure on client creation");
+
+	gearman_return_t rc = gearman_client_add_server(_client,
+	                          host.c_str(), GEARMAN_DEFAULT_TCP_PORT);
+	if (gearman_failed(rc))
+	{
+		std::string err(gearman_client_error(_client));
+		gearman_client_free(_client);
+		throw RuntimeException(TRACE_INFO, "Gearman: %s", err.c_str());
+	}
+
+	// Come back from running the tasks at least once a second, to
+	// look for jobs that have gone quiet.
+	gearman_client_set_timeout(_client, 1000);
+
+	gearman_client_set_data_fn(_client, on_data);
+	gearman_client_set_status_fn(_client, on_status);
+	gearman_client_set_complete_fn(_client, on_complete);
+	gearman_client_set_fail_fn(_client, on_fail);
+
+	_results = createQueueValue();
+}
+
+/// Freeing the client frees all of its tasks, including those of
+/// attempts that were given up on, and may still be running.
+DistExec::~DistExec()
+{
+	gearman_client_free(_client);
+}
+
+QueueValuePtr DistExec::execute(const HandleSeq& atoms, size_t batch,
+                                AtomSpace* as, const std::string& host,
+                                unsigned retries, unsigned timeout)
+{
+	std::unique_ptr<DistExec> dx(new DistExec(as, host, retries, timeout));
+	if (0 == batch) batch = 1;
+
+	WireTypes types;
+	for (size_t i = 0; i < atoms.size(); i += batch)
+	{
+		size_t n = std::min(batch, atoms.size() - i);
+		Job job;
+		WireWriter wr(job.payload, types);
+		wr.begin(EXEC);
+		wr.varint(n);
+		for (size_t j = i; j < i + n; j++)
+			wr.atom(atoms[j]);
+		wr.end();
+		dx->_jobs.emplace_back(std::move(job));
+	}
+	return start(std::move(dx));
+}
+
+QueueValuePtr DistExec::map(const Handle& fn, Type t, size_t nparts,
+                            AtomSpace* as, const std::string& host,
+                            unsigned retries, unsigned timeout)
+{
+	std::unique_ptr<DistExec> dx(new DistExec(as, host, retries, timeout));
+
+	WireTypes types;
+	for (size_t i = 0; i < nparts; i++)
+	{
+		Job job;
+		WireWriter wr(job.payload, types);
+		wr.begin(MAP);
+		wr.atom(fn);
+		wr.type(t);
+		wr.varint(i);
+		wr.varint(nparts);
+		wr.end();
+		dx->_jobs.emplace_back(std::move(job));
+	}
+	return start(std::move(dx));
+}
+
+/// Hand the jobs to a thread of their own, and return the queue that
+/// the results will show up in.
+QueueValuePtr DistExec::start(std::unique_ptr<DistExec> dx)
+{
+	QueueValuePtr results(dx->_results);
+	if (dx->_jobs.empty())
+	{
+		results->close();
+		return results;
+	}
+
+	// The jobs stay put from here on; the tasks point at them.
+	for (Job& j : dx->_jobs) j.owner = dx.get();
+	dx->_pending = dx->_jobs.size();
+
+	std::thread([dx = std::move(dx)]() { dx->run(); }).detach();
+	return results;
+}
+
+// ==============================================================
+
+void DistExec::submit(Job& j)
+{
+	j.attempts++;
+	j.buf.clear();
+	j.got = 0;
+	j.started = false;
+	j.state = RUNNING;
+	j.last = time(nullptr);
+
+	// No unique ID: the server makes one up, so that an attempt is
+	// never folded into an earlier one, that is still running.
+	gearman_return_t rc;
+	j.task = gearman_client_add_task(_client, nullptr, &j, FUNCTION,
+	                                 nullptr, j.payload.data(),
+	                                 j.payload.size(), &rc);
+	if (nullptr == j.task or gearman_failed(rc))
+		throw RuntimeException(TRACE_INFO,
+			"Gearman: %s", gearman_client_error(_client));
+}
+
+void DistExec::retry(Job& j, const char* why)
+{
+	if (j.attempts <= _retries)
+	{
+		logger().warn("DistExec: job %zu %s; trying again",
+			&j - _jobs.data(), why);
+		submit(j);
+		return;
+	}
+	logger().error("DistExec: job %zu %s; giving up after %u attempts",
+		&j - _jobs.data(), why, j.attempts);
+	finish(j);
+}
+
+void DistExec::finish(Job& j)
+{
+	j.state = DONE;
+	j.task = nullptr;
+	_pending--;
+}
+
+/// Put the complete frames received so far into the queue, skipping
+/// those that an earlier attempt already delivered.
+void DistExec::receive(Job& j)
+{
+	j.buf.append((const char*) gearman_task_data(j.task),
+	             gearman_task_data_size(j.task));
+
+	WireTypes types;
+	std::string_view in(j.buf);
+	std::string_view frame;
+	while (WireReader::next_frame(in, frame))
+	{
+		size_t item = j.got++;
+		if (item < j.delivered) continue;
+		j.delivered++;
+
+		WireReader rd(frame, types);
+		if (BinaryCommands::OK == rd.u8())
+		{
+			ValuePtr vp(rd.value());
+			if (nullptr != vp) vp = Sexpr::add_atoms(_as.get(), vp);
+			_results->push(vp);
+		}
+		else
+			logger().warn("DistExec: job %zu item %zu failed: %s",
+				&j - _jobs.data(), item, std::string(rd.str()).c_str());
+	}
+	j.buf.erase(0, j.buf.size() - in.size());
+}
+
+void DistExec::run(void)
+{
+	try
+	{
+		for (Job& j : _jobs) submit(j);
+
+		while (0 < _pending)
+		{
+			gearman_return_t rc = gearman_client_run_tasks(_client);
+			bool broken = GEARMAN_TIMEOUT != rc and gearman_failed(rc);
+			if (broken)
+			{
+				logger().warn("DistExec: %s", gearman_client_error(_client));
+				std::this_thread::sleep_for(std::chrono::seconds(1));
+			}
+
+			time_t now = time(nullptr);
+			for (Job& j : _jobs)
+			{
+				if (COMPLETE == j.state)
+					finish(j);
+				else if (FAILED == j.state)
+					retry(j, "failed");
+				else if (RUNNING != j.state)
+					continue;
+				else if (broken)
+					retry(j, "was cut off");
+				else if (j.started and time_t(_timeout) < now - j.last)
+					retry(j, "went quiet");
+			}
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		logger().error("DistExec: %s", ex.what());
+	}
+	_results->close();
+}
+
+// ==============================================================
+// Callbacks, made from within gearman_client_run_tasks(). These only
+// take note; run() decides what to do next.
+
+/// The job the task is the current attempt of, or null, if it is an
+/// attempt that was given up on.
+DistExec::Job* DistExec::job_of(gearman_task_st* task)
+{
+	Job* j = (Job*) gearman_task_context(task);
+	if (RUNNING != j->state or task != j->task) return nullptr;
+	return j;
+}
+
+gearman_return_t DistExec::on_data(gearman_task_st* task)
+{
+	Job* j = job_of(task);
+	if (nullptr == j) return GEARMAN_SUCCESS;
+
+	j->started = true;
+	j->last = time(nullptr);
+	try
+	{
+		j->owner->receive(*j);
+	}
+	catch (const std::exception& ex)
+	{
+		logger().warn("DistExec: bad reply: %s", ex.what());
+		j->state = FAILED;
+	}
+	return GEARMAN_SUCCESS;
+}
+
+gearman_return_t DistExec::on_status(gearman_task_st* task)
+{
+	Job* j = job_of(task);
+	if (nullptr == j) return GEARMAN_SUCCESS;
+
+	j->started = true;
+	j->last = time(nullptr);
+	return GEARMAN_SUCCESS;
+}
+
+gearman_return_t DistExec::on_complete(gearman_task_st* task)
+{
+	Job* j = job_of(task);
+	if (nullptr == j) return GEARMAN_SUCCESS;
+
+	on_data(task);
+	if (RUNNING == j->state) j->state = COMPLETE;
+	return GEARMAN_SUCCESS;
+}
+
+gearman_return_t DistExec::on_fail(gearman_task_st* task)
+{
+	Job* j = job_of(task);
+	if (nullptr != j) j->state = FAILED;
+	return GEARMAN_SUCCESS;
+}
+
+/* ============================= END OF FILE ================= */
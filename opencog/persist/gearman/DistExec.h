@@ -0,0 +1,143 @@
+/*
+ * DistExec.h
+ * Distributed execution of Atomese, in batches, over Gearman.
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_DIST_EXEC_H
+#define _OPENCOG_DIST_EXEC_H
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+#include <libgearman/gearman.h>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/QueueValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+/**
+ * Runs Atomese on Gearman workers, and streams the results back.
+ *
+ * The work is cut into jobs. Each job is sent as frames of the binary
+ * wire format of `BinaryCommands`, so that no scheme is printed or
+ * parsed on either end. Two kinds of jobs are understood:
+ *
+ * EXEC holds a batch of Atoms. The worker executes each one, in order;
+ * Atoms that are not executable are their own result.
+ *
+ * MAP holds a function, a type, and a partition: part `k` of `n`. The
+ * worker scans its AtomSpace for the Atoms of that type (and subtypes)
+ * whose hash is `k` modulo `n`, sorts them, and executes the function
+ * applied to each one, with a PutLink. Thus `n` jobs, between them,
+ * cover the whole type index of the workers, without the client ever
+ * having to list the Atoms. This assumes all the workers hold the same
+ * Atoms; say, loaded from the same StorageNode.
+ *
+ * The worker sends each result back as soon as it has it, as one
+ * frame, followed by a status update, that says how far along it is.
+ * The updates are the heartbeat: a running job that has not been heard
+ * from in `timeout` seconds is given up on, and sent again. So is a job
+ * that the Gearman server reports as failed. Each job is tried at most
+ * `1 + retries` times. A job sent again starts over; the results that
+ * were already received are skipped, so that each result is delivered
+ * just once. (This is why the MAP scans are sorted.)
+ *
+ * The results go into a QueueValue, in whatever order they arrive; the
+ * queue is closed when every job is done, or given up on. If any item
+ * throws while being executed on the worker, there is no result for
+ * it; the error is logged.
+ */
+class DistExec
+{
+public:
+	enum Op : uint8_t
+	{
+		EXEC = 1,   // count, atoms
+		MAP,        // atom fn, type, count part, count nparts
+	};
+
+	/// The Gearman function name that the workers register.
+	static const char* FUNCTION;
+
+	/// Execute every Atom in `atoms`, `batch` of them in a job, on
+	/// the workers of the gearmand server at `host`.
+	static QueueValuePtr execute(const HandleSeq& atoms, size_t batch,
+	                             AtomSpace*, const std::string& host,
+	                             unsigned retries, unsigned timeout);
+
+	/// Apply `fn` to every Atom of type `t`, in `nparts` jobs.
+	static QueueValuePtr map(const Handle& fn, Type t, size_t nparts,
+	                         AtomSpace*, const std::string& host,
+	                         unsigned retries, unsigned timeout);
+
+	/// The worker end. The context is the AtomSpace to work in.
+	static gearman_return_t worker_function(gearman_job_st*, void*);
+
+	~DistExec();
+
+private:
+	enum State { RUNNING, COMPLETE, FAILED, DONE };
+
+	struct Job
+	{
+		DistExec* owner = nullptr;
+		std::string payload;
+		gearman_task_st* task = nullptr;  // The current attempt.
+		std::string buf;          // Reply bytes not yet split into frames.
+		size_t got = 0;           // Results received in this attempt.
+		size_t delivered = 0;     // Results put into the queue, in all.
+		unsigned attempts = 0;
+		bool started = false;     // Heard from, in this attempt.
+		State state = RUNNING;
+		time_t last = 0;
+	};
+
+	AtomSpacePtr _as;
+	unsigned _retries;
+	unsigned _timeout;
+	gearman_client_st* _client;
+	std::vector<Job> _jobs;
+	QueueValuePtr _results;
+	size_t _pending;
+
+	DistExec(AtomSpace*, const std::string& host,
+	         unsigned retries, unsigned timeout);
+
+	void submit(Job&);
+	void retry(Job&, const char*);
+	void finish(Job&);
+	void receive(Job&);
+	void run(void);
+
+	static QueueValuePtr start(std::unique_ptr<DistExec>);
+	static Job* job_of(gearman_task_st*);
+
+	static gearman_return_t on_data(gearman_task_st*);
+	static gearman_return_t on_status(gearman_task_st*);
+	static gearman_return_t on_complete(gearman_task_st*);
+	static gearman_return_t on_fail(gearman_task_st*);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_DIST_EXEC_H
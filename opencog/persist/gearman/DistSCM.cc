@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <libgearman/gearman.h>
 
@@ -29,6 +31,8 @@
 #include <opencog/guile/SchemePrimitive.h>
 #include <opencog/guile/SchemeSmob.h>
 
+#include "DistExec.h"
+
 namespace opencog {
 
 class DistSCM : public ModuleWrap
@@ -44,6 +48,12 @@ private:
 	                               const std::string& workerID);
 	std::string dist_eval(const std::string& work_string,
 	                      const std::string& clientID);
+	ValuePtr dist_execute(const HandleSeq&, int batch,
+	                      const std::string& ipaddr_string,
+	                      int retries, int timeout);
+	ValuePtr dist_map(const Handle&, Type, int nparts,
+	                  const std::string& ipaddr_string,
+	                  int retries, int timeout);
 
 	// XXX FIXME -- a single client and worker? This cannot be right!
 	gearman_client_st client;
@@ -81,6 +91,13 @@ void DistSCM::init(void)
 	// Returns resulting scheme string.
 	define_scheme_primitive("dist-eval", &DistSCM::dist_eval,
 	                        this, "dist-gearman");
+
+	// Send Atomese to the workers, in batches; the results stream
+	// back into the QueueValue returned.
+	define_scheme_primitive("dist-execute", &DistSCM::dist_execute,
+	                        this, "dist-gearman");
+	define_scheme_primitive("dist-map", &DistSCM::dist_map,
+	                        this, "dist-gearman");
 }
 
 /// This method causes all worker threads to return to their callers
@@ -188,6 +205,23 @@ std::string DistSCM::start_work_handler(const std::string& ipaddr_string,
 			"Gearman: %s", gearman_worker_error(worker));
 	}
 
+	gearman_function_t batch_fn =
+		gearman_function_create(DistExec::worker_function);
+
+	rc = gearman_worker_define_function(worker,
+	                                    DistExec::FUNCTION,
+	                                    strlen(DistExec::FUNCTION),
+	                                    batch_fn,
+	                                    0,
+	                                    atomspace);
+
+	if (gearman_failed(rc))
+	{
+		std::cerr << gearman_worker_error(worker) << std::endl;
+		throw RuntimeException(TRACE_INFO,
+			"Gearman: %s", gearman_worker_error(worker));
+	}
+
 #ifdef DEBUG
 	std::cout << "Dist start-work-handler enter main loop\n";
 #endif
@@ -285,6 +319,34 @@ std::string DistSCM::dist_eval(const std::string& scm_string,
 	return work_result;
 }
 
+/// Execute each of the `atoms` on the workers of the gearmand server
+/// at `ipaddr_string`, `batch` of them in a job. A job is tried again,
+/// up to `retries` times, if it fails, or if its worker has not been
+/// heard from in `timeout` seconds. Return at once, with a QueueValue
+/// that the results will be put into; it is closed when all is done.
+ValuePtr DistSCM::dist_execute(const HandleSeq& atoms, int batch,
+                               const std::string& ipaddr_string,
+                               int retries, int timeout)
+{
+	AtomSpace* atomspace = SchemeSmob::ss_get_env_as("dist-execute");
+	return DistExec::execute(atoms, std::max(batch, 1), atomspace,
+	                         ipaddr_string, std::max(retries, 0),
+	                         std::max(timeout, 1));
+}
+
+/// Apply `fn` to every Atom of type `t` in the AtomSpaces of the
+/// workers, split into `nparts` jobs, each a slice of the Atoms of
+/// that type. Retries and results are as for dist_execute().
+ValuePtr DistSCM::dist_map(const Handle& fn, Type t, int nparts,
+                           const std::string& ipaddr_string,
+                           int retries, int timeout)
+{
+	AtomSpace* atomspace = SchemeSmob::ss_get_env_as("dist-map");
+	return DistExec::map(fn, t, std::max(nparts, 1), atomspace,
+	                     ipaddr_string, std::max(retries, 0),
+	                     std::max(timeout, 1));
+}
+
 DistSCM::~DistSCM()
 {
 }
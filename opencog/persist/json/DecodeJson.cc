@@ -20,8 +20,6 @@
  * Free Software Foundation, Inc.,
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
-#include <iomanip>
-
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/Node.h>
 #include <opencog/atoms/base/Link.h>
@@ -41,13 +39,13 @@ using namespace opencog;
  * starting at location `pos` in `tna`.
  * Return the type and update `pos` to point after the typename.
  */
-Type Json::decode_type(const std::string& tna, size_t& pos)
+Type Json::decode_type(std::string_view tna, size_t& pos)
 {
 	// Advance past whitespace.
 	pos = tna.find_first_not_of(" \n\t", pos);
 	if (std::string::npos == pos)
 		throw SyntaxException(TRACE_INFO, "Bad Type >>%s<<",
-			tna.substr(pos).c_str());
+			std::string(tna).c_str());
 
 	// Advance to next whitespace.
 	size_t nos = tna.find_first_of(",) \n\t", pos);
@@ -57,10 +55,11 @@ Type Json::decode_type(const std::string& tna, size_t& pos)
 	size_t sos = nos;
 	if ('"' == tna[pos]) { pos++; sos--; }
 
-	Type t = nameserver().getType(tna.substr(pos, sos-pos));
+	std::string tname(tna.substr(pos, sos-pos));
+	Type t = nameserver().getType(tname);
 	if (NOTYPE == t)
 		throw SyntaxException(TRACE_INFO, "Unknown Type >>%s<<",
-			tna.substr(pos, sos-pos).c_str());
+			tname.c_str());
 
 	pos = nos;
 	return t;
@@ -75,28 +74,29 @@ Type Json::decode_type(const std::string& tna, size_t& pos)
 /// just before the last quote. In this case, escaped quotes \" are
 /// ignored (are considered to be part of the string).
 ///
-/// This returns the unescaped node name.
+/// This returns the unescaped node name. The escapes are those of
+/// std::quoted(): a backslash stands for the character after it.
 ///
-std::string Json::get_node_name(const std::string& s,
+std::string Json::get_node_name(std::string_view s,
                                 size_t& l, size_t& r)
 {
 	// Advance past whitespace.
 	while (l < r and (s[l] == ' ' or s[l] == '\t' or s[l] == '\n')) l++;
 
 	l++;
+	std::string name;
 	size_t p = l;
-	for (; p < r and (s[p] != '"' or ((0 < p) and (s[p - 1] == '\\'))); p++);
+	size_t start = l;
+	for (; p < r and s[p] != '"'; p++)
+	{
+		if ('\\' != s[p]) continue;
+		name.append(s.data() + start, p - start);
+		start = ++p;
+		if (p == r) break;
+	}
+	if (start < p) name.append(s.data() + start, p - start);
+	if (p < r) p++;   // step past trailing quote.
 	r = p;
-
-	// We use std::quoted() to unescape embedded quotes.
-	// Unescaping works ONLY if the leading character is a quote!
-	// So readjust left and right to pick those up.
-	if ('"' == s[l-1]) l--; // grab leading quote, for std::quoted().
-	if ('"' == s[r]) r++;   // step past trailing quote.
-	std::stringstream ss;
-	std::string name;
-	ss << s.substr(l, r-l);
-	ss >> std::quoted(name);
 	return name;
 }
 
@@ -115,7 +115,7 @@ std::string Json::get_node_name(const std::string& s,
 /// and also we don't need most of the features that they offer, and
 /// also I don't want more dependencies in the AtomSpace.
 ///
-Handle Json::decode_atom(const std::string& s,
+Handle Json::decode_atom(std::string_view s,
                          size_t& l, size_t& r)
 {
 	l = s.find("{", l);
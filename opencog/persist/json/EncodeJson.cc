@@ -34,57 +34,96 @@
 using namespace opencog;
 
 /* ================================================================== */
-// Atom printers that do NOT print associated Values.
+// Atom printers that do NOT print associated Values. These append to
+// the output buffer, so that long replies can be built up without
+// making and copying temporary strings. The indent is in spaces.
 
-static std::string prt_node(const Handle& h, const std::string& indent)
+static inline void prt_indent(std::string& out, size_t indent)
 {
-	std::stringstream ss;
-	ss << indent << "{\n" << indent << "  \"type\": \""
-		<< nameserver().getTypeName(h->get_type())
-		<< "\",\n" << indent << "  \"name\": ";
-	ss << std::quoted(h->get_name());
-	ss << "\n" << indent << "}";
+	out.append(indent, ' ');
+}
 
-	return ss.str();
+// The same escapes as std::quoted(), which is what the decoder uses.
+static void prt_quoted(std::string& out, const std::string& str)
+{
+	out += '"';
+	size_t start = 0;
+	size_t pos = str.find_first_of("\"\\");
+	while (std::string::npos != pos)
+	{
+		out.append(str, start, pos - start);
+		out += '\\';
+		out += str[pos];
+		start = pos + 1;
+		pos = str.find_first_of("\"\\", start);
+	}
+	out.append(str, start, std::string::npos);
+	out += '"';
 }
 
-static std::string prt_atom(const Handle&, const std::string& = "");
+static void prt_atom(std::string&, const Handle&, size_t);
 
-static std::string prt_link(const Handle& h, const std::string& indent)
+static void prt_node(std::string& out, const Handle& h, size_t indent)
 {
-	std::string idt = indent + "  ";
-	std::string txt = indent + "{\n" + idt + "\"type\": \""
-		+ nameserver().getTypeName(h->get_type()) + "\",\n"
-		+ idt + "\"outgoing\": [\n";
+	prt_indent(out, indent);
+	out += "{\n";
+	prt_indent(out, indent);
+	out += "  \"type\": \"";
+	out += nameserver().getTypeName(h->get_type());
+	out += "\",\n";
+	prt_indent(out, indent);
+	out += "  \"name\": ";
+	prt_quoted(out, h->get_name());
+	out += '\n';
+	prt_indent(out, indent);
+	out += '}';
+}
+
+static void prt_link(std::string& out, const Handle& h, size_t indent)
+{
+	prt_indent(out, indent);
+	out += "{\n";
+	prt_indent(out, indent + 2);
+	out += "\"type\": \"";
+	out += nameserver().getTypeName(h->get_type());
+	out += "\",\n";
+	prt_indent(out, indent + 2);
+	out += "\"outgoing\": [\n";
 
 	bool first = true;
 	for (const Handle& ho : h->getOutgoingSet())
 	{
-		if (not first) { txt += ",\n"; } else { first = false; }
-		txt += prt_atom(ho, idt + "  ");
+		if (not first) { out += ",\n"; } else { first = false; }
+		prt_atom(out, ho, indent + 4);
 	}
-	txt += "]}";
-	return txt;
+	out += "]}";
 }
 
-static std::string prt_atom(const Handle& h, const std::string& indent)
+static void prt_atom(std::string& out, const Handle& h, size_t indent)
 {
-	if (h->is_node()) return prt_node(h, indent);
-	return prt_link(h, indent);
+	if (h->is_node()) prt_node(out, h, indent);
+	else prt_link(out, h, indent);
 }
 
-/// Convert the Atom into a string. It does NOT print any of the
+static std::string prt_atom(const Handle& h)
+{
+	std::string out;
+	prt_atom(out, h, 0);
+	return out;
+}
+
+/// Append the Atom to `out`. It does NOT print any of the
 /// associated values; use `dump_atom()` to get those.
-std::string Json::encode_atom(const Handle& h, const std::string& indent)
+void Json::encode_atom(std::string& out, const Handle& h, size_t indent)
 {
-	return prt_atom(h, indent);
+	prt_atom(out, h, indent);
 }
 
-/// Convert value (or Atom) into a string.
-std::string Json::encode_value(const ValuePtr& v, const std::string& indent)
+/// Append the value (or Atom) to `out`.
+void Json::encode_value(std::string& out, const ValuePtr& v, size_t indent)
 {
 	// Empty values are used to erase keys from atoms.
-	if (nullptr == v) return "false";
+	if (nullptr == v) { out += "false"; return; }
 
 	if (nameserver().isA(v->get_type(), FLOAT_VALUE))
 	{
@@ -92,12 +131,33 @@ std::string Json::encode_value(const ValuePtr& v, const std::string& indent)
 		// form of the value, as compared to SimpleTruthValue, which
 		// only prints 6 digits and breaks the unit tests.
 		FloatValuePtr fv(FloatValueCast(v));
-		return fv->FloatValue::to_string();
+		out += fv->FloatValue::to_string();
+		return;
 	}
 
 	if (not v->is_atom())
-		return v->to_short_string();
-	return prt_atom(HandleCast(v));
+	{
+		out += v->to_short_string();
+		return;
+	}
+	prt_atom(out, HandleCast(v), indent);
+}
+
+/// Convert the Atom into a string. It does NOT print any of the
+/// associated values; use `dump_atom()` to get those.
+std::string Json::encode_atom(const Handle& h, const std::string& indent)
+{
+	std::string out;
+	prt_atom(out, h, indent.size());
+	return out;
+}
+
+/// Convert value (or Atom) into a string.
+std::string Json::encode_value(const ValuePtr& v, const std::string& indent)
+{
+	std::string out;
+	encode_value(out, v, indent.size());
+	return out;
 }
 
 /* ================================================================== */
@@ -20,10 +20,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <time.h>
-
 #include <functional>
-#include <iomanip>
 #include <string>
 
 #include <opencog/atoms/atom_types/NameServer.h>
@@ -32,63 +29,134 @@
 #include <opencog/atoms/value/FloatValue.h>
 #include <opencog/atoms/truthvalue/TruthValue.h>
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspace/ScanCursor.h>
 
 #include "JSCommands.h"
 #include "Json.h"
 
 using namespace opencog;
 
+// Long replies are handed over in pieces of about this size.
+#define CHUNK_SIZE (1UL << 16)
+
+namespace {
+
+// The reply, as it is built. Each time it grows past a chunk, it is
+// handed to the emitter, and started over; so long lists of Atoms
+// are never held in memory all at once.
+class Reply
+{
+	const JSCommands::Emitter& _emit;
+public:
+	std::string buf;
+
+	Reply(const JSCommands::Emitter& emit) : _emit(emit)
+		{ buf.reserve(CHUNK_SIZE + 4096); }
+
+	void check(void) { if (CHUNK_SIZE <= buf.size()) flush(); }
+	void flush(void)
+	{
+		if (buf.empty()) return;
+		_emit(buf);
+		buf.clear();
+	}
+};
+
+}
+
 static std::string reterr(const std::string& cmd)
 {
 	return "JSON/JavaScript function not supported: >>" + cmd + "<<\n";
 }
 
+// The next number, after the commas and blanks; zero if there is none.
+static uint64_t get_number(const std::string& cmd, size_t& pos)
+{
+	pos = cmd.find_first_not_of(", \n\t", pos);
+	if (std::string::npos == pos) return 0;
+	const char* start = cmd.c_str() + pos;
+	char* stop;
+	uint64_t n = strtoull(start, &stop, 10);
+	pos += stop - start;
+	return n;
+}
+
+// One page from the cursor, with the token for the next one, which
+// is zero on the last page.
+static void page(uint64_t tok, size_t n, Reply& rv)
+{
+	HandleSeq hs;
+	try {
+		tok = ScanCursor::next(tok, n, hs);
+	}
+	catch(...) {
+		rv.buf += "No such cursor: " + std::to_string(tok) + "\n";
+		return;
+	}
+
+	rv.buf += "{\n  \"cursor\": " + std::to_string(tok) + ",\n";
+	rv.buf += "  \"atoms\": [\n";
+	bool first = true;
+	for (const Handle& h : hs)
+	{
+		if (not first) { rv.buf += ",\n"; } else { first = false; }
+		Json::encode_atom(rv.buf, h, 4);
+		rv.check();
+	}
+	rv.buf += "]}\n";
+}
+
 /// The cogserver provides a network API to send/receive Atoms, encoded
 /// as JSON, over the internet. This is NOT as efficient as the
 /// s-expression API, but is more convenient for web developers.
 //
-std::string JSCommands::interpret_command(AtomSpace* as,
-                                          const std::string& cmd)
+static void interpret(AtomSpace* as, const std::string& cmd, Reply& rv)
 {
 	// Fast dispatch. There should be zero hash collisions
 	// here. If there are, we are in trouble. (Well, if there
 	// are collisions, just prepend a dot?)
-	static const size_t gtatm = std::hash<std::string>{}("getAtoms");
-	static const size_t haven = std::hash<std::string>{}("haveNode");
-	static const size_t havel = std::hash<std::string>{}("haveLink");
-	static const size_t havea = std::hash<std::string>{}("haveAtom");
-	static const size_t gtinc = std::hash<std::string>{}("getIncoming");
-	static const size_t gtval = std::hash<std::string>{}("getValues");
+	static const size_t gtatm = std::hash<std::string_view>{}("getAtoms");
+	static const size_t haven = std::hash<std::string_view>{}("haveNode");
+	static const size_t havel = std::hash<std::string_view>{}("haveLink");
+	static const size_t havea = std::hash<std::string_view>{}("haveAtom");
+	static const size_t gtinc = std::hash<std::string_view>{}("getIncoming");
+	static const size_t gtval = std::hash<std::string_view>{}("getValues");
+	static const size_t gtatp = std::hash<std::string_view>{}("getAtomsPage");
+	static const size_t gtinp = std::hash<std::string_view>{}("getIncomingPage");
+	static const size_t nxtpg = std::hash<std::string_view>{}("nextPage");
+	static const size_t clcur = std::hash<std::string_view>{}("closeCursor");
 
 	// Ignore comments, blank lines
-	if ('/' == cmd[0]) return "";
-	if ('\n' == cmd[0]) return "";
+	if ('/' == cmd[0]) return;
+	if ('\n' == cmd[0]) return;
 
 	// Find the command and dispatch
 	size_t cpos = cmd.find_first_of(".");
-	if (std::string::npos == cpos) return reterr(cmd);
+	if (std::string::npos == cpos) { rv.buf += reterr(cmd); return; }
 
 	size_t pos = cmd.find_first_not_of(". \n\t", cpos);
-	if (std::string::npos == pos) return reterr(cmd);
+	if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
 
 	size_t epos = cmd.find_first_of("( \n\t", pos);
-	if (std::string::npos == epos) return reterr(cmd);
+	if (std::string::npos == epos) { rv.buf += reterr(cmd); return; }
 
-	size_t act = std::hash<std::string>{}(cmd.substr(pos, epos-pos));
+	size_t act = std::hash<std::string_view>{}(
+		std::string_view(cmd).substr(pos, epos-pos));
 
 	// -----------------------------------------------
 	// AtomSpace.getAtoms("Node", true)
 	if (gtatm == act)
 	{
 		pos = cmd.find_first_of("(", epos);
-		if (std::string::npos == pos) return reterr(cmd);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
 		pos++;
 		Type t = NOTYPE;
 		try {
 			t = Json::decode_type(cmd, pos);
 		}
 		catch(...) {
-			return "Unknown type: " + cmd.substr(pos);
+			rv.buf += "Unknown type: " + cmd.substr(pos);
+			return;
 		}
 
 		pos = cmd.find_first_not_of(",) \n\t", pos);
@@ -98,17 +166,19 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 				0 == cmd.compare(pos, 5, "false")))
 			get_subtypes = false;
 
-		std::string rv = "[\n";
-		HandleSeq hset;
-		as->get_handles_by_type(hset, t, get_subtypes);
+		// Straight out of the type index; the reply starts going out
+		// before all of the Atoms have been looked at.
+		rv.buf += "[\n";
 		bool first = true;
-		for (const Handle& h: hset)
-		{
-			if (not first) { rv += ",\n"; } else { first = false; }
-			rv += Json::encode_atom(h, "  ");
-		}
-		rv += "]\n";
-		return rv;
+		as->foreach_handle_by_type(t, get_subtypes,
+			[&](const Handle& h) -> bool {
+				if (not first) { rv.buf += ",\n"; } else { first = false; }
+				Json::encode_atom(rv.buf, h, 2);
+				rv.check();
+				return false;
+			});
+		rv.buf += "]\n";
+		return;
 	}
 
 	// -----------------------------------------------
@@ -116,26 +186,30 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 	if (haven == act)
 	{
 		pos = cmd.find_first_of("(", epos);
-		if (std::string::npos == pos) return reterr(cmd);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
 		pos++;
 		Type t = NOTYPE;
 		try {
 			t = Json::decode_type(cmd, pos);
 		}
 		catch(...) {
-			return "Unknown type: " + cmd.substr(pos);
+			rv.buf += "Unknown type: " + cmd.substr(pos);
+			return;
 		}
 
 		if (not nameserver().isA(t, NODE))
-			return "Type is not a Node type: " + cmd.substr(epos);
+		{
+			rv.buf += "Type is not a Node type: " + cmd.substr(epos);
+			return;
+		}
 
 		pos = cmd.find_first_not_of(",) \n\t", pos);
 		epos = cmd.size();
 		std::string name = Json::get_node_name(cmd, pos, epos);
 		Handle h = as->get_node(t, std::move(name));
 
-		if (nullptr == h) return "false\n";
-		return "true\n";
+		rv.buf += (nullptr == h) ? "false\n" : "true\n";
+		return;
 	}
 
 	// -----------------------------------------------
@@ -143,18 +217,22 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 	if (havel == act)
 	{
 		pos = cmd.find_first_of("(", epos);
-		if (std::string::npos == pos) return reterr(cmd);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
 		pos++;
 		Type t = NOTYPE;
 		try {
 			t = Json::decode_type(cmd, pos);
 		}
 		catch(...) {
-			return "Unknown type: " + cmd.substr(pos);
+			rv.buf += "Unknown type: " + cmd.substr(pos);
+			return;
 		}
 
 		if (not nameserver().isA(t, LINK))
-			return "Type is not a Link type: " + cmd.substr(epos);
+		{
+			rv.buf += "Type is not a Link type: " + cmd.substr(epos);
+			return;
+		}
 
 		pos = cmd.find_first_not_of(", \n\t", pos);
 		epos = cmd.size();
@@ -166,7 +244,7 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 		while (std::string::npos != r)
 		{
 			Handle ho = Json::decode_atom(cmd, l, r);
-			if (nullptr == ho) return "false\n";
+			if (nullptr == ho) { rv.buf += "false\n"; return; }
 			hs.push_back(ho);
 
 			// Look for the comma
@@ -177,8 +255,8 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 		}
 		Handle h = as->get_link(t, std::move(hs));
 
-		if (nullptr == h) return "false\n";
-		return "true\n";
+		rv.buf += (nullptr == h) ? "false\n" : "true\n";
+		return;
 	}
 
 	// -----------------------------------------------
@@ -186,17 +264,15 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 	if (havea == act)
 	{
 		pos = cmd.find_first_of("(", epos);
-		if (std::string::npos == pos) return reterr(cmd);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
 		pos++;
 		epos = cmd.size();
 
 		Handle h = Json::decode_atom(cmd, pos, epos);
-		if (nullptr == h) return "false\n";
+		if (h) h = as->get_atom(h);
 
-		h = as->get_atom(h);
-
-		if (nullptr == h) return "false\n";
-		return "true\n";
+		rv.buf += (nullptr == h) ? "false\n" : "true\n";
+		return;
 	}
 
 	// -----------------------------------------------
@@ -204,16 +280,13 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 	if (gtinc == act)
 	{
 		pos = cmd.find_first_of("(", epos);
-		if (std::string::npos == pos) return reterr(cmd);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
 		pos++;
 		epos = cmd.size();
 
 		Handle h = Json::decode_atom(cmd, pos, epos);
-		if (nullptr == h) return "[]\n";
-
-		h = as->get_atom(h);
-
-		if (nullptr == h) return "[]\n";
+		if (h) h = as->get_atom(h);
+		if (nullptr == h) { rv.buf += "[]\n"; return; }
 
 		Type t = NOTYPE;
 		pos = cmd.find(",", epos);
@@ -224,25 +297,27 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 				t = Json::decode_type(cmd, pos);
 			}
 			catch(...) {
-				return "Unknown type: " + cmd.substr(pos);
+				rv.buf += "Unknown type: " + cmd.substr(pos);
+				return;
 			}
 		}
 
-		IncomingSet is;
+		bool first = true;
+		auto emit = [&](const Handle& hi) -> bool {
+			if (not first) { rv.buf += ",\n"; } else { first = false; }
+			Json::encode_atom(rv.buf, hi);
+			rv.check();
+			return false;
+		};
+
+		rv.buf += '[';
 		if (NOTYPE != t)
-			is = h->getIncomingSetByType(t);
+			h->foreach_incoming_by_type(t, emit);
 		else
-			is = h->getIncomingSet();
-
-		bool first = true;
-		std::string alist = "[";
-		for (const Handle& hi : is)
-		{
-			if (not first) { alist += ",\n"; } else { first = false; }
-			alist += Json::encode_atom(hi, "");
-		}
-		alist += "]\n";
-		return alist;
+			for (const Handle& hi : h->getIncomingSet())
+				emit(hi);
+		rv.buf += "]\n";
+		return;
 	}
 
 	// -----------------------------------------------
@@ -250,31 +325,143 @@ std::string JSCommands::interpret_command(AtomSpace* as,
 	if (gtval == act)
 	{
 		pos = cmd.find_first_of("(", epos);
-		if (std::string::npos == pos) return reterr(cmd);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
 		pos++;
 		epos = cmd.size();
 
 		Handle h = Json::decode_atom(cmd, pos, epos);
-		if (nullptr == h) return "[]\n";
-
-		h = as->get_atom(h);
-
-		if (nullptr == h) return "[]\n";
+		if (h) h = as->get_atom(h);
+		if (nullptr == h) { rv.buf += "[]\n"; return; }
 
 		bool first = true;
-		std::string alist = "[\n";
+		rv.buf += "[\n";
 		for (const Handle& key : h->getKeys())
 		{
-			if (not first) { alist += ",\n"; } else { first = false; }
-			alist += "  {\n";
-			alist += "    \"key\": " + Json::encode_atom(key, "    ") + ",\n";
-			alist += "    \"value\": ";
-			alist += Json::encode_value(h->getValue(key), "    ") + "}";
+			if (not first) { rv.buf += ",\n"; } else { first = false; }
+			rv.buf += "  {\n";
+			rv.buf += "    \"key\": ";
+			Json::encode_atom(rv.buf, key, 4);
+			rv.buf += ",\n";
+			rv.buf += "    \"value\": ";
+			Json::encode_value(rv.buf, h->getValue(key), 4);
+			rv.buf += '}';
+			rv.check();
+		}
+		rv.buf += "]\n";
+		return;
+	}
+
+	// -----------------------------------------------
+	// AtomSpace.getAtomsPage("Node", true, 1000)
+	if (gtatp == act)
+	{
+		pos = cmd.find_first_of("(", epos);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
+		pos++;
+		Type t = NOTYPE;
+		try {
+			t = Json::decode_type(cmd, pos);
+		}
+		catch(...) {
+			rv.buf += "Unknown type: " + cmd.substr(pos);
+			return;
+		}
+
+		pos = cmd.find_first_not_of(",) \n\t", pos);
+		bool get_subtypes = true;
+		if (std::string::npos != pos and (
+				0 == cmd.compare(pos, 1, "0") or
+				0 == cmd.compare(pos, 5, "false")))
+			get_subtypes = false;
+
+		if (std::string::npos != pos)
+			pos = cmd.find_first_of(",)", pos);
+		size_t n = (std::string::npos == pos) ? 0 : get_number(cmd, pos);
+		page(ScanCursor::open_type(as, t, get_subtypes), n, rv);
+		return;
+	}
+
+	// -----------------------------------------------
+	// AtomSpace.getIncomingPage({ "type": "ConceptNode", "name": "foo"}, 1000)
+	// AtomSpace.getIncomingPage({ "type": "ConceptNode", "name": "foo"}, "ListLink", 1000)
+	if (gtinp == act)
+	{
+		pos = cmd.find_first_of("(", epos);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
+		pos++;
+		epos = cmd.size();
+
+		Handle h = Json::decode_atom(cmd, pos, epos);
+		if (h) h = as->get_atom(h);
+		if (nullptr == h)
+		{
+			rv.buf += "{\n  \"cursor\": 0,\n  \"atoms\": []}\n";
+			return;
+		}
+
+		Type t = NOTYPE;
+		pos = cmd.find(",", epos);
+		if (std::string::npos != pos)
+			pos = cmd.find_first_not_of(", \n\t", pos);
+		if (std::string::npos != pos and '"' == cmd[pos])
+		{
+			try {
+				t = Json::decode_type(cmd, pos);
+			}
+			catch(...) {
+				rv.buf += "Unknown type: " + cmd.substr(pos);
+				return;
+			}
 		}
-		alist += "]\n";
-		return alist;
+
+		size_t n = (std::string::npos == pos) ? 0 : get_number(cmd, pos);
+		page(ScanCursor::open_incoming(h, t), n, rv);
+		return;
+	}
+
+	// -----------------------------------------------
+	// AtomSpace.nextPage(123456789, 1000)
+	if (nxtpg == act)
+	{
+		pos = cmd.find_first_of("(", epos);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
+		pos++;
+		uint64_t tok = get_number(cmd, pos);
+		size_t n = (std::string::npos == pos) ? 0 : get_number(cmd, pos);
+		page(tok, n, rv);
+		return;
+	}
+
+	// -----------------------------------------------
+	// AtomSpace.closeCursor(123456789)
+	if (clcur == act)
+	{
+		pos = cmd.find_first_of("(", epos);
+		if (std::string::npos == pos) { rv.buf += reterr(cmd); return; }
+		pos++;
+		uint64_t tok = get_number(cmd, pos);
+		rv.buf += ScanCursor::close(tok) ? "true\n" : "false\n";
+		return;
 	}
 
 	// -----------------------------------------------
-	return reterr(cmd);
+	rv.buf += reterr(cmd);
+}
+
+void JSCommands::interpret_command(AtomSpace* as,
+                                   const std::string& cmd,
+                                   const Emitter& emit)
+{
+	Reply rv(emit);
+	interpret(as, cmd, rv);
+	rv.flush();
+}
+
+std::string JSCommands::interpret_command(AtomSpace* as,
+                                          const std::string& cmd)
+{
+	std::string out;
+	interpret_command(as, cmd,
+		[&](std::string& chunk) { out += chunk; });
+	return out;
 }
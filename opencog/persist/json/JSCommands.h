@@ -23,6 +23,7 @@
 #ifndef _JS_COMMANDS_H
 #define _JS_COMMANDS_H
 
+#include <functional>
 #include <string>
 
 namespace opencog
@@ -52,12 +53,32 @@ public:
 	///    AtomSpace.getIncoming(atom, type)
 	///    AtomSpace.getValues(atom)
 	///
+	/// And, to get long lists a page at a time:
+	///    AtomSpace.getAtomsPage(type, recursive, pagesize)
+	///    AtomSpace.getIncomingPage(atom, pagesize)
+	///    AtomSpace.getIncomingPage(atom, type, pagesize)
+	///    AtomSpace.nextPage(cursor, pagesize)
+	///    AtomSpace.closeCursor(cursor)
+	///
+	/// These reply with `{"cursor": 123, "atoms": [...]}`; the cursor
+	/// is passed to `nextPage` for the next page, and is zero on the
+	/// last one. See ScanCursor.h.
+	///
 	/// So far, there aren't any commands to change the contents of
 	/// the atomspace, but there could be ... these aren't hard.
 	/// Sp far, the query command is not supported. It could be,
 	/// its really easy. See `../sexpr/Commands.cc` for examples.
 	///
 	static std::string interpret_command(AtomSpace*, const std::string&);
+
+	/// As above, but the reply is handed to the emitter a piece at a
+	/// time, as it is made, instead of all at once at the end. The
+	/// emitter may take the contents of the string it is given. Long
+	/// lists of Atoms (from getAtoms and getIncoming) are then never
+	/// held in memory all at once, and start going out right away.
+	typedef std::function<void(std::string&)> Emitter;
+	static void interpret_command(AtomSpace*, const std::string&,
+	                              const Emitter&);
 };
 
 /** @}*/
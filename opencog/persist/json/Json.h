@@ -24,6 +24,7 @@
 #define _JSON_ECODE_H
 
 #include <string>
+#include <string_view>
 #include <opencog/atoms/base/Handle.h>
 
 namespace opencog
@@ -37,28 +38,35 @@ class Json
 public:
 	/// Decode the JSON containing an atom, starting at
 	/// location `pos`. Return the Atom, and update `pos` to point
-	/// just past the end of the trailing brace.
-	static Handle decode_atom(const std::string& s, size_t& pos)
+	/// at the trailing brace.
+	///
+	/// The decoders work in place, on any buffer; nothing is copied,
+	/// except for the Node names themselves. A buffer holding many
+	/// Atoms can be decoded one Atom at a time, by passing back the
+	/// updated position.
+	static Handle decode_atom(std::string_view s, size_t& pos)
 	{
 		size_t start = pos;
 		size_t end = s.length();
-		return decode_atom(s, start, end);
+		Handle h = decode_atom(s, start, end);
+		pos = end;
+		return h;
 	}
 
-	static Handle decode_atom(const std::string& s) {
+	static Handle decode_atom(std::string_view s) {
 		size_t junk = 0;
 		return decode_atom(s, junk);
 	}
 
-	static Handle decode_atom(const std::string& s,
+	static Handle decode_atom(std::string_view s,
                              size_t& l, size_t& r);
 
-	static std::string get_node_name(const std::string&, size_t& l, size_t& r);
+	static std::string get_node_name(std::string_view, size_t& l, size_t& r);
 
 #if NOT_IMPLEMENTED_YET
 	static ValuePtr decode_value(const std::string&, size_t&);
 #endif // NOT_IMPLEMENTED_YET
-	static Type decode_type(const std::string& s, size_t& pos);
+	static Type decode_type(std::string_view s, size_t& pos);
 
 #if NOT_IMPLEMENTED_YET
 	static void decode_slist(const Handle&, const std::string&, size_t&);
@@ -73,6 +81,10 @@ public:
 	// Encoding functions
 	static std::string encode_atom(const Handle&, const std::string& = "");
 	static std::string encode_value(const ValuePtr&, const std::string& = "");
+
+	/// As above, but appending to `out`, indenting by `indent` spaces.
+	static void encode_atom(std::string& out, const Handle&, size_t indent = 0);
+	static void encode_value(std::string& out, const ValuePtr&, size_t indent = 0);
 	static std::string encode_atom_values(const Handle&);
 
 	static std::string dump_atom(const Handle&);
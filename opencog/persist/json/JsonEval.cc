@@ -21,7 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <map>
+
 #include <opencog/util/Logger.h>
+#include <opencog/util/concurrent_stack.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/persist/json/JSCommands.h>
 
@@ -29,10 +32,18 @@
 
 using namespace opencog;
 
+// How much of the reply may pile up, waiting for poll_result(),
+// before eval_expr() waits for it to be taken.
+#define MAX_QUEUED (1UL << 20)
+
 JsonEval::JsonEval(AtomSpace* as)
 	: GenericEval()
 {
 	_atomspace = as;
+	_queued = 0;
+	_done = false;
+	_polling = false;
+	_interrupted = false;
 }
 
 JsonEval::~JsonEval()
@@ -46,33 +57,77 @@ JsonEval::~JsonEval()
 void JsonEval::eval_expr(const std::string &expr)
 {
 	try {
-		std::lock_guard<std::mutex> lock(_mtx);
-		_answer = JSCommands::interpret_command(_atomspace, expr);
+		JSCommands::interpret_command(_atomspace, expr,
+			[this](std::string& chunk) { put(chunk); });
 	}
 	catch (const StandardException& ex)
 	{
+		std::lock_guard<std::mutex> lock(_mtx);
 		_error_string = ex.what();
 		_caught_error = true;
 	}
+	// Anything else, e.g. std::invalid_argument from stod() on a
+	// malformed FloatValue, must not leave poll_result() waiting.
+	catch (const std::exception& ex)
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_error_string = ex.what();
+		_caught_error = true;
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_error_string = "Unknown exception";
+		_caught_error = true;
+	}
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	_done = true;
+	_cv.notify_all();
+}
+
+/// Pass a piece of the reply to poll_result(). If someone is polling,
+/// wait until they have caught up; if not, then the eval is running in
+/// the thread that will poll, later on, and waiting would be forever.
+void JsonEval::put(std::string& chunk)
+{
+	std::unique_lock<std::mutex> lock(_mtx);
+	_cv.wait(lock, [this] {
+		return not _polling or _interrupted or _queued < MAX_QUEUED; });
+	if (_interrupted)
+		throw RuntimeException(TRACE_INFO, "Caught interrupt!");
+
+	_queued += chunk.size();
+	_chunks.emplace_back(std::move(chunk));
+	_cv.notify_all();
 }
 
 std::string JsonEval::poll_result()
 {
-	std::string ret;
-	std::lock_guard<std::mutex> lock(_mtx);
-	ret.swap(_answer);
+	std::unique_lock<std::mutex> lock(_mtx);
+	_polling = true;
+	_cv.wait(lock, [this] { return _done or not _chunks.empty(); });
+	if (_chunks.empty()) return "";
+
+	std::string ret(std::move(_chunks.front()));
+	_chunks.pop_front();
+	_queued -= ret.size();
+	_cv.notify_all();
 	return ret;
 }
 
 void JsonEval::begin_eval()
 {
 	std::lock_guard<std::mutex> lock(_mtx);
-	while (0 < _answer.size())
+	if (not _chunks.empty())
 	{
 		logger().warn("This shouldn't happen!");
-		usleep(100);
+		_chunks.clear();
 	}
-	_answer.clear();
+	_queued = 0;
+	_done = false;
+	_polling = false;
+	_interrupted = false;
 }
 
 /* ============================================================== */
@@ -82,21 +137,57 @@ void JsonEval::begin_eval()
  */
 void JsonEval::interrupt(void)
 {
+	std::lock_guard<std::mutex> lock(_mtx);
 	_caught_error = true;
 	_error_string = "Caught interrupt!";
+	_interrupted = true;
+	_cv.notify_all();
 }
 
+// Evaluators not in use, left behind by threads that have exited.
+// The network servers run a thread per connection, and would otherwise
+// make and delete an evaluator for each one. The stack is thread-safe
+// by itself; no further lock is needed.
+static concurrent_stack<JsonEval*> pool;
+
+/// Return the evaluator for this thread and AtomSpace. Each thread
+/// gets one of its own, so that requests arriving on different network
+/// connections are evaluated concurrently; they share nothing but the
+/// AtomSpace, which is thread-safe. When the thread exits, its
+/// evaluators go back to the pool, for the next thread to use.
 JsonEval* JsonEval::get_evaluator(AtomSpace* as)
 {
-	static thread_local JsonEval* evaluator = new JsonEval(as);
+	static thread_local std::map<AtomSpace*, JsonEval*> issued;
 
 	// The eval_dtor runs when this thread is destroyed.
 	class eval_dtor {
 		public:
-		~eval_dtor() { delete evaluator; }
+		~eval_dtor() {
+			for (auto& ev : issued)
+			{
+				JsonEval* evaluator = ev.second;
+				evaluator->_atomspace = nullptr;
+				evaluator->clear_pending();
+
+				// The stack may already be gone, during library exit.
+				try {
+					pool.push(evaluator);
+				}
+				catch (const concurrent_stack<JsonEval*>::Canceled&) {}
+			}
+		}
 	};
 	static thread_local eval_dtor killer;
 
+	auto ev = issued.find(as);
+	if (ev != issued.end())
+		return ev->second;
+
+	JsonEval* evaluator = nullptr;
+	if (not pool.try_pop(evaluator))
+		evaluator = new JsonEval(as);
+	evaluator->_atomspace = as;
+	issued[as] = evaluator;
 	return evaluator;
 }
 
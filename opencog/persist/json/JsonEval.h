@@ -23,6 +23,8 @@
 #ifndef _OPENCOG_JSON_EVAL_H
 #define _OPENCOG_JSON_EVAL_H
 
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <string>
 #include <opencog/eval/GenericEval.h>
@@ -32,6 +34,11 @@
  * evaluation.  It supports just enough commands to allow AtomSpaces
  * and portions there-of to be easily transported across the network.
  * It is used by the CogServer, and the atomsspace-js network backend.
+ *
+ * Each thread has its own evaluator for each AtomSpace; see
+ * get_evaluator(). The commands keep no state of their own, and so
+ * requests from different threads run concurrently, with only the
+ * AtomSpace (which is thread-safe) shared between them.
  */
 
 namespace opencog {
@@ -45,11 +52,19 @@ class JsonEval : public GenericEval
 	private:
 		AtomSpace* _atomspace;
 
-		// poll_result() is called in a different thread
-		// than eval_expr() and the result is that _answer
-		// can get clobbered. So force the reader to wait.
+		// poll_result() is called in a different thread than
+		// eval_expr(). The reply is passed from one to the other
+		// a chunk at a time, as it is made, so that long replies
+		// start going out before they are done.
 		std::mutex _mtx;
-		std::string _answer;
+		std::condition_variable _cv;
+		std::deque<std::string> _chunks;
+		size_t _queued;
+		bool _done;
+		bool _polling;
+		bool _interrupted;
+
+		void put(std::string&);
 
 		JsonEval(AtomSpace*);
 	public:
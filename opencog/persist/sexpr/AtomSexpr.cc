@@ -26,6 +26,7 @@
 #include <iomanip>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include <opencog/util/exceptions.h>
 #include <opencog/atoms/atom_types/NameServer.h>
@@ -43,7 +44,7 @@ using namespace opencog;
 /// and `r` points at the matching close-paren.  Returns parenthesis
 /// count. If zero, the parens match. If non-zero, then `r` points
 /// at the first non-valid character in the string (e.g. comment char).
-int Sexpr::get_next_expr(const std::string& s, size_t& l, size_t& r,
+int Sexpr::get_next_expr(std::string_view s, size_t& l, size_t& r,
                          size_t line_cnt)
 {
 	// Advance past whitespace.
@@ -57,24 +58,25 @@ int Sexpr::get_next_expr(const std::string& s, size_t& l, size_t& r,
 	if (s[l] != '(')
 		throw std::runtime_error(
 			"Syntax error at line " + std::to_string(line_cnt) +
-			" Unexpected text: >>" + s.substr(l) + "<<");
+			" Unexpected text: >>" + std::string(s.substr(l)) + "<<");
 
+	// Never look at s[r]; the string might not be null-terminated.
 	size_t p = l;
 	int count = 1;
 	bool quoted = false;
-	do {
-		p++;
-
+	while (++p < r)
+	{
 		// Skip over any escapes
 		if (s[p] == '\\') { p ++; continue; }
 
 		if (s[p] == '"') quoted = !quoted;
 		else if (quoted) continue;
 		else if (s[p] == '(') count++;
-		else if (s[p] == ')') count--;
+		else if (s[p] == ')') { if (0 == --count) break; }
 		else if (s[p] == ';') break;      // comments!
-	} while (p < r and count > 0);
+	}
 
+	if (r < p) p = r;
 	r = p;
 	return count;
 }
@@ -84,7 +86,7 @@ static NameServer& namer = nameserver();
 /// Extracts link or node type. Given the string `s`, this updates
 /// the `l` and `r` values such that `l` points at the first
 /// non-whitespace character of the name, and `r` points at the last.
-static Type get_typename(const std::string& s, size_t& l, size_t& r,
+static Type get_typename(std::string_view s, size_t& l, size_t& r,
                          size_t line_cnt)
 {
 	// Advance past whitespace.
@@ -93,13 +95,14 @@ static Type get_typename(const std::string& s, size_t& l, size_t& r,
 	if (s[l] != '(')
 		throw SyntaxException(TRACE_INFO,
 			"Error at line %lu unexpected content: >>%s<< in %s",
-			line_cnt, s.substr(l, r-l+1).c_str(), s.c_str());
+			line_cnt, std::string(s.substr(l, r-l+1)).c_str(),
+			std::string(s).c_str());
 
 	// Advance until whitespace.
 	l++;
 	r = s.find_first_of("( \t\n", l);
 
-	const std::string stype = s.substr(l, r-l);
+	const std::string stype(s.substr(l, r-l));
 	Type atype = namer.getType(stype);
 	if (atype == opencog::NOTYPE)
 		throw SyntaxException(TRACE_INFO,
@@ -123,8 +126,9 @@ static Type get_typename(const std::string& s, size_t& l, size_t& r,
 /// This function was originally written to allow in-place extraction
 /// of the node name. Unfortunately, node names containing escaped
 /// quotes need to be unescaped, which prevents in-place extraction.
-/// So, instead, this returns a copy of the name string.
-std::string Sexpr::get_node_name(const std::string& s,
+/// So, instead, this returns a copy of the name string. Names without
+/// any escapes are copied straight out of `s`.
+std::string Sexpr::get_node_name(std::string_view s,
                                  size_t& l, size_t& r,
                                  Type atype, size_t line_cnt)
 {
@@ -141,7 +145,8 @@ std::string Sexpr::get_node_name(const std::string& s,
 	else if (not typeNode and s[l] != '"')
 		throw std::runtime_error(
 			"Syntax error at line " + std::to_string(line_cnt) +
-			" Unexpected content: >>" + s.substr(l, r-l+1) + "<< in " + s);
+			" Unexpected content: >>" + std::string(s.substr(l, r-l+1)) +
+			"<< in " + std::string(s));
 
 	l++;
 	size_t p = l;
@@ -155,7 +160,13 @@ std::string Sexpr::get_node_name(const std::string& s,
 	// Unescaping works ONLY if the leading character is a quote!
 	// So readjust left and right to pick those up.
 	if ('"' == s[l-1]) l--; // grab leading quote, for std::quoted().
-	if ('"' == s[r]) r++;   // step past trailing quote.
+	if (r < s.size() and '"' == s[r]) r++;   // step past trailing quote.
+
+	// The common case: nothing to unescape.
+	if ('"' == s[l] and 2 <= r - l and '"' == s[r-1] and
+	    std::string_view::npos == s.substr(l, r-l).find('\\'))
+		return std::string(s.substr(l+1, r-l-2));
+
 	std::stringstream ss;
 	std::string name;
 	ss << s.substr(l, r-l);
@@ -164,17 +175,27 @@ std::string Sexpr::get_node_name(const std::string& s,
 }
 
 /// Extract SimpleTruthValue and return that, else throw an error.
-static TruthValuePtr get_stv(const std::string& s,
+static TruthValuePtr get_stv(std::string_view s,
                              size_t l, size_t r, size_t line_cnt)
 {
 	if (s.compare(l, 5, "(stv "))
 		throw std::runtime_error(
 				"Syntax error at line " + std::to_string(line_cnt) +
-				" Unsupported markup: " + s.substr(l, r-l+1) +
-				" in expr: " + s);
+				" Unsupported markup: " + std::string(s.substr(l, r-l+1)) +
+				" in expr: " + std::string(s));
 
 	return createSimpleTruthValue(
-				NumberNode::to_vector(s.substr(l+4, r-l-4)));
+				NumberNode::to_vector(std::string(s.substr(l+4, r-l-4))));
+}
+
+/// Decode the alist in [l, r] of `s`. Values are rare, compared to
+/// Atoms, and so they are copied out, and decoded by the string API.
+static void decode_values(const Handle& h, std::string_view s,
+                          size_t l, size_t r)
+{
+	std::string alist(s.substr(l, r-l+1));
+	size_t pos = 0;
+	Sexpr::decode_slist(h, alist, pos);
 }
 
 /// Convert an Atomese S-expression into a C++ Atom.
@@ -186,7 +207,7 @@ static TruthValuePtr get_stv(const std::string& s,
 /// as a hint for the end of the expression. The `line_count` is an
 /// optional argument for printing file line-numbers, in case of error.
 ///
-Handle Sexpr::decode_atom(const std::string& s,
+Handle Sexpr::decode_atom(std::string_view s,
                           size_t l, size_t r, size_t line_cnt)
 {
 	TruthValuePtr stv;
@@ -227,7 +248,7 @@ Handle Sexpr::decode_atom(const std::string& s,
 
 		// alist's occur at the end of the sexpr.
 		if (l1 != r1 and l < r)
-			decode_slist(h, s, l1);
+			decode_values(h, s, l1, r);
 
 		return h;
 	}
@@ -247,7 +268,7 @@ Handle Sexpr::decode_atom(const std::string& s,
 		if (l2 < r2)
 		{
 			if (0 == s.compare(l2, 7, "(alist "))
-				decode_slist(h, s, l2);
+				decode_values(h, s, l2, r);
 			else
 				h->setTruthValue(get_stv(s, l2, r2, line_cnt));
 		}
@@ -256,5 +277,5 @@ Handle Sexpr::decode_atom(const std::string& s,
 	}
 	throw std::runtime_error(
 		"Syntax error at line " + std::to_string(line_cnt) +
-		"Got a Value, not supported: " + s);
+		"Got a Value, not supported: " + std::string(s));
 }
@@ -0,0 +1,556 @@
+/*
+ * BinaryCommands.cc
+ * Binary framing for the network command set.
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/IntValue.h>
+#include <opencog/atoms/value/StringValue.h>
+#include <opencog/atoms/value/ValueFactory.h>
+#include <opencog/atoms/truthvalue/TruthValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "BinaryCommands.h"
+#include "Sexpr.h"
+
+using namespace opencog;
+
+// ==============================================================
+// Byte order. Everything on the wire is little-endian.
+
+static inline uint64_t little(uint64_t v)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	return __builtin_bswap64(v);
+#else
+	return v;
+#endif
+}
+
+static inline uint32_t little(uint32_t v)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	return __builtin_bswap32(v);
+#else
+	return v;
+#endif
+}
+
+static BinaryCommands::Kind kind_of(const ValuePtr& v)
+{
+	if (nullptr == v) return BinaryCommands::NONE;
+	if (v->is_atom()) return BinaryCommands::ATOM;
+
+	NameServer& ns = nameserver();
+	Type t = v->get_type();
+	if (ns.isA(t, FLOAT_VALUE) and not ns.isA(t, STREAM_VALUE) and
+	    FORMULA_TRUTH_VALUE != t)
+		return BinaryCommands::FLOATS;
+	if (ns.isA(t, INT_VALUE)) return BinaryCommands::INTS;
+	if (ns.isA(t, STRING_VALUE)) return BinaryCommands::STRINGS;
+	return BinaryCommands::SEXPR;
+}
+
+// ==============================================================
+
+void WireTypes::load(WireReader& rd)
+{
+	NameServer& ns = nameserver();
+
+	uint64_t version = rd.varint();
+	if (BinaryCommands::VERSION < version)
+		throw IOException(TRACE_INFO,
+			"Protocol version %lu is newer than this client", version);
+
+	_local.resize(rd.varint());
+	_remote.assign(ns.getNumberOfClasses(), UINT64_MAX);
+	for (size_t i = 0; i < _local.size(); i++)
+	{
+		// Types unknown here stay NOTYPE; it is an error only if
+		// one of them is actually sent.
+		std::string name(rd.str());
+		Type t = ns.getType(name);
+		_local[i] = t;
+		if (NOTYPE != t) _remote[t] = i;
+	}
+}
+
+Type WireTypes::to_local(uint64_t id) const
+{
+	if (_local.empty())
+	{
+		if (nameserver().getNumberOfClasses() <= id)
+			throw IOException(TRACE_INFO, "Unknown type number %lu", id);
+		return Type(id);
+	}
+	if (_local.size() <= id or NOTYPE == _local[id])
+		throw IOException(TRACE_INFO, "Unknown type number %lu", id);
+	return _local[id];
+}
+
+uint64_t WireTypes::to_remote(Type t) const
+{
+	if (_remote.empty()) return t;
+	if (_remote.size() <= t or UINT64_MAX == _remote[t])
+		throw IOException(TRACE_INFO,
+			"Type %s is not known to the other end",
+			nameserver().getTypeName(t).c_str());
+	return _remote[t];
+}
+
+// ==============================================================
+
+WireWriter::WireWriter(std::string& out, const WireTypes& types) :
+	_out(out), _types(types), _frame(std::string::npos)
+{
+}
+
+void WireWriter::begin(uint8_t code)
+{
+	_frame = _out.size();
+	_out.append(sizeof(uint32_t), '\0');
+	u8(code);
+}
+
+void WireWriter::end(void)
+{
+	uint32_t len = little(uint32_t(_out.size() - _frame - sizeof(uint32_t)));
+	memcpy(&_out[_frame], &len, sizeof(len));
+	_frame = std::string::npos;
+}
+
+void WireWriter::u8(uint8_t b)
+{
+	_out += char(b);
+}
+
+void WireWriter::varint(uint64_t v)
+{
+	while (0x80 <= v) { _out += char(v | 0x80); v >>= 7; }
+	_out += char(v);
+}
+
+void WireWriter::f64(double d)
+{
+	uint64_t v;
+	memcpy(&v, &d, sizeof(v));
+	v = little(v);
+	_out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void WireWriter::str(std::string_view s)
+{
+	varint(s.size());
+	_out.append(s.data(), s.size());
+}
+
+void WireWriter::type(Type t)
+{
+	varint(_types.to_remote(t));
+}
+
+void WireWriter::atom(const Handle& h)
+{
+	if (nullptr == h)
+		throw InvalidParamException(TRACE_INFO, "Cannot send a null Atom");
+
+	type(h->get_type());
+	if (h->is_node())
+	{
+		str(h->get_name());
+		return;
+	}
+	const HandleSeq& oset = h->getOutgoingSet();
+	varint(oset.size());
+	for (const Handle& ho : oset)
+		atom(ho);
+}
+
+void WireWriter::value(const ValuePtr& v)
+{
+	BinaryCommands::Kind kind = kind_of(v);
+	u8(kind);
+	switch (kind)
+	{
+		case BinaryCommands::NONE:
+			return;
+		case BinaryCommands::ATOM:
+			atom(HandleCast(v));
+			return;
+		case BinaryCommands::FLOATS:
+		{
+			type(v->get_type());
+			const std::vector<double>& fv(FloatValueCast(v)->value());
+			varint(fv.size());
+			for (double d : fv) f64(d);
+			return;
+		}
+		case BinaryCommands::INTS:
+		{
+			type(v->get_type());
+			const std::vector<int64_t>& iv(IntValueCast(v)->value());
+			varint(iv.size());
+			// Zig-zag, so that small negative numbers stay small.
+			for (int64_t i : iv)
+				varint((uint64_t(i) << 1) ^ uint64_t(i >> 63));
+			return;
+		}
+		case BinaryCommands::STRINGS:
+		{
+			type(v->get_type());
+			const std::vector<std::string>& sv(StringValueCast(v)->value());
+			varint(sv.size());
+			for (const std::string& s : sv) str(s);
+			return;
+		}
+		case BinaryCommands::SEXPR:
+			type(v->get_type());
+			str(Sexpr::encode_value(v));
+			return;
+	}
+}
+
+// ==============================================================
+
+WireReader::WireReader(std::string_view frame, const WireTypes& types) :
+	_p(frame.data()), _end(frame.data() + frame.size()), _types(types)
+{
+}
+
+bool WireReader::next_frame(std::string_view& buf, std::string_view& frame)
+{
+	if (buf.size() < sizeof(uint32_t)) return false;
+	uint32_t len;
+	memcpy(&len, buf.data(), sizeof(len));
+	len = little(len);
+	if (buf.size() - sizeof(uint32_t) < len) return false;
+	frame = buf.substr(sizeof(uint32_t), len);
+	buf.remove_prefix(sizeof(uint32_t) + len);
+	return true;
+}
+
+void WireReader::need(size_t n)
+{
+	if (size_t(_end - _p) < n)
+		throw IOException(TRACE_INFO, "Frame is truncated");
+}
+
+uint8_t WireReader::u8(void)
+{
+	need(1);
+	return uint8_t(*_p++);
+}
+
+uint64_t WireReader::varint(void)
+{
+	uint64_t v = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7)
+	{
+		uint8_t b = u8();
+		v |= uint64_t(b & 0x7f) << shift;
+		if (0 == (b & 0x80)) return v;
+	}
+	throw IOException(TRACE_INFO, "Frame has a malformed number");
+}
+
+double WireReader::f64(void)
+{
+	need(sizeof(uint64_t));
+	uint64_t v;
+	memcpy(&v, _p, sizeof(v));
+	_p += sizeof(v);
+	v = little(v);
+	double d;
+	memcpy(&d, &v, sizeof(d));
+	return d;
+}
+
+std::string_view WireReader::str(void)
+{
+	uint64_t n = varint();
+	need(n);
+	std::string_view s(_p, n);
+	_p += n;
+	return s;
+}
+
+Type WireReader::type(void)
+{
+	return _types.to_local(varint());
+}
+
+Handle WireReader::atom(void)
+{
+	NameServer& ns = nameserver();
+	Type t = type();
+	if (ns.isNode(t))
+		return createNode(t, std::string(str()));
+
+	if (not ns.isLink(t))
+		throw IOException(TRACE_INFO,
+			"Frame holds a %s where an Atom should be",
+			ns.getTypeName(t).c_str());
+
+	// Each outgoing Atom takes at least two bytes.
+	uint64_t n = varint();
+	if (size_t(_end - _p) / 2 < n)
+		throw IOException(TRACE_INFO, "Frame is truncated");
+	HandleSeq oset;
+	oset.reserve(n);
+	for (uint64_t i = 0; i < n; i++)
+		oset.emplace_back(atom());
+	return createLink(std::move(oset), t);
+}
+
+ValuePtr WireReader::value(void)
+{
+	uint8_t kind = u8();
+	switch (kind)
+	{
+		case BinaryCommands::NONE:
+			return nullptr;
+		case BinaryCommands::ATOM:
+			return atom();
+		case BinaryCommands::FLOATS:
+		{
+			Type t = type();
+			uint64_t n = varint();
+			if (size_t(_end - _p) / sizeof(double) < n)
+				throw IOException(TRACE_INFO, "Frame is truncated");
+			std::vector<double> fv(n);
+			for (double& d : fv) d = f64();
+			return valueserver().create(t, std::move(fv));
+		}
+		case BinaryCommands::INTS:
+		{
+			Type t = type();
+			uint64_t n = varint();
+			if (size_t(_end - _p) < n)
+				throw IOException(TRACE_INFO, "Frame is truncated");
+			std::vector<int64_t> iv(n);
+			for (int64_t& i : iv)
+			{
+				uint64_t z = varint();
+				i = int64_t(z >> 1) ^ -int64_t(z & 1);
+			}
+			return valueserver().create(t, std::move(iv));
+		}
+		case BinaryCommands::STRINGS:
+		{
+			Type t = type();
+			uint64_t n = varint();
+			if (size_t(_end - _p) < n)
+				throw IOException(TRACE_INFO, "Frame is truncated");
+			std::vector<std::string> sv(n);
+			for (std::string& s : sv) s = str();
+			return valueserver().create(t, std::move(sv));
+		}
+		case BinaryCommands::SEXPR:
+		{
+			type();
+			std::string sexpr(str());
+			size_t pos = 0;
+			return Sexpr::decode_value(sexpr, pos);
+		}
+	}
+	throw IOException(TRACE_INFO, "Frame holds a Value of unknown kind %d",
+		int(kind));
+}
+
+// ==============================================================
+
+// Atoms within Values need a home, too.
+static ValuePtr add_value(AtomSpace* as, const ValuePtr& vp)
+{
+	if (nullptr == vp) return vp;
+	return Sexpr::add_atoms(as, vp);
+}
+
+static void atoms(WireWriter& wr, const HandleSeq& hs)
+{
+	wr.varint(hs.size());
+	for (const Handle& h : hs)
+		wr.atom(h);
+}
+
+static void perform(AtomSpace* as, uint8_t op,
+                    WireReader& rd, WireWriter& wr)
+{
+	switch (op)
+	{
+		case BinaryCommands::HELLO:
+		{
+			NameServer& ns = nameserver();
+			Type ntypes = ns.getNumberOfClasses();
+			wr.varint(BinaryCommands::VERSION);
+			wr.varint(ntypes);
+			for (Type t = 0; t < ntypes; t++)
+				wr.str(ns.getTypeName(t));
+			return;
+		}
+		case BinaryCommands::CLEAR:
+			as->clear();
+			wr.u8(true);
+			return;
+		case BinaryCommands::EXTRACT:
+		{
+			Handle h = as->get_atom(rd.atom());
+			bool recursive = rd.u8();
+			wr.u8(nullptr == h or as->extract_atom(h, recursive));
+			return;
+		}
+		case BinaryCommands::GET_ATOMS:
+		{
+			Type t = rd.type();
+			bool subtypes = rd.u8();
+			HandleSeq hset;
+			as->get_handles_by_type(hset, t, subtypes);
+			atoms(wr, hset);
+			return;
+		}
+		case BinaryCommands::INCOMING_BY_TYPE:
+		{
+			Handle h = as->add_atom(rd.atom());
+			Type t = rd.type();
+			atoms(wr, h->getIncomingSetByType(t));
+			return;
+		}
+		case BinaryCommands::INCOMING_SET:
+		{
+			Handle h = as->add_atom(rd.atom());
+			atoms(wr, h->getIncomingSet());
+			return;
+		}
+		case BinaryCommands::KEYS_ALIST:
+		{
+			Handle h = as->add_atom(rd.atom());
+			HandleSet keys = h->getKeys();
+			wr.varint(keys.size());
+			for (const Handle& key : keys)
+			{
+				wr.atom(key);
+				wr.value(h->getValue(key));
+			}
+			return;
+		}
+		case BinaryCommands::LINK:
+		{
+			Type t = rd.type();
+			uint64_t n = rd.varint();
+			HandleSeq oset;
+			for (uint64_t i = 0; i < n; i++)
+				oset.emplace_back(rd.atom());
+			Handle h = as->get_link(t, std::move(oset));
+			wr.u8(nullptr != h);
+			if (h) wr.atom(h);
+			return;
+		}
+		case BinaryCommands::NODE:
+		{
+			Type t = rd.type();
+			Handle h = as->get_node(t, std::string(rd.str()));
+			wr.u8(nullptr != h);
+			if (h) wr.atom(h);
+			return;
+		}
+		case BinaryCommands::SET_VALUE:
+		{
+			Handle atom = as->add_atom(rd.atom());
+			Handle key = as->add_atom(rd.atom());
+			atom->setValue(key, add_value(as, rd.value()));
+			return;
+		}
+		case BinaryCommands::SET_VALUES:
+		{
+			Handle atom = as->add_atom(rd.atom());
+			uint64_t n = rd.varint();
+			for (uint64_t i = 0; i < n; i++)
+			{
+				Handle key = as->add_atom(rd.atom());
+				atom->setValue(key, add_value(as, rd.value()));
+			}
+			return;
+		}
+		case BinaryCommands::SET_TV:
+		{
+			Handle atom = as->add_atom(rd.atom());
+			ValuePtr tv = rd.value();
+			if (nullptr == atom) return; // read-only atomspace.
+			atom->setTruthValue(TruthValueCast(tv));
+			return;
+		}
+		case BinaryCommands::INC_VALUE:
+		{
+			Handle atom = as->add_atom(rd.atom());
+			Handle key = as->add_atom(rd.atom());
+			double cnt = rd.f64();
+			size_t ref = rd.varint();
+			as->increment_count(atom, key, ref, cnt);
+			return;
+		}
+		case BinaryCommands::VALUE:
+		{
+			Handle atom = as->add_atom(rd.atom());
+			Handle key = as->add_atom(rd.atom());
+			wr.value(atom->getValue(key));
+			return;
+		}
+	}
+	throw SyntaxException(TRACE_INFO, "Command not supported: %d", int(op));
+}
+
+size_t BinaryCommands::interpret(AtomSpace* as, std::string_view in,
+                                 std::string& out)
+{
+	static const WireTypes server_types;
+
+	std::string_view buf(in);
+	std::string_view frame;
+	while (WireReader::next_frame(buf, frame))
+	{
+		WireReader rd(frame, server_types);
+		WireWriter wr(out, server_types);
+		size_t mark = out.size();
+		try
+		{
+			uint8_t op = rd.u8();
+			wr.begin(OK);
+			perform(as, op, rd, wr);
+			if (not rd.done())
+				throw SyntaxException(TRACE_INFO,
+					"Unexpected bytes after command %d", int(op));
+			wr.end();
+		}
+		catch (const std::exception& ex)
+		{
+			// The other requests go on; only this one failed.
+			out.resize(mark);
+			wr.begin(FAILED);
+			wr.str(ex.what());
+			wr.end();
+		}
+	}
+	return in.size() - buf.size();
+}
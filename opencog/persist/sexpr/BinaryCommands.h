@@ -0,0 +1,174 @@
+/*
+ * BinaryCommands.h
+ * Binary framing for the network command set.
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _BINARY_COMMANDS_H
+#define _BINARY_COMMANDS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+class AtomSpace;
+
+/**
+ * The same commands as those of `Commands::interpret_command()`, but
+ * framed in binary, so that neither end has to print or parse text.
+ *
+ * Every request and every reply is one frame: a 4-byte length, and
+ * then that many bytes. The first byte of a request says which
+ * command it is; the first byte of a reply is OK or FAILED, and a
+ * FAILED reply holds only the error message. Replies come back in the
+ * order of the requests. Any number of requests may be sent at once,
+ * and their replies are returned at once; so a client with many
+ * requests to make pays for one round-trip, not many.
+ *
+ * Counts are LEB128 varints; lengths and numbers are little-endian.
+ * A string is a count and its bytes. An Atom is its type, and then
+ * either the Node name, or the arity and the outgoing Atoms. A Value
+ * is a kind (below), its type, and its contents. Values that are not
+ * Atoms, nor vectors of numbers or strings, are sent in their
+ * s-expression form.
+ *
+ * Types are sent as numbers: those of the server. The first request
+ * of a session should be HELLO; the reply lists the names of all of
+ * the server's types, and the client maps them to its own, once.
+ * This is the job of the WireTypes below.
+ */
+class BinaryCommands
+{
+public:
+	enum Op : uint8_t
+	{
+		HELLO = 1,         // -> protocol version, all type names
+		CLEAR,             // -> bool
+		EXTRACT,           // atom, bool recursive -> bool
+		GET_ATOMS,         // type, bool subtypes -> atoms
+		INCOMING_BY_TYPE,  // atom, type -> atoms
+		INCOMING_SET,      // atom -> atoms
+		KEYS_ALIST,        // atom -> count, (key, value) ...
+		LINK,              // type, count, atoms -> bool, atom
+		NODE,              // type, name -> bool, atom
+		SET_VALUE,         // atom, key, value ->
+		SET_VALUES,        // atom, count, (key, value) ... ->
+		SET_TV,            // atom, value ->
+		INC_VALUE,         // atom, key, double, count index ->
+		VALUE,             // atom, key -> value
+	};
+
+	enum Status : uint8_t { OK = 0, FAILED = 1 };
+
+	/// How a Value is laid out on the wire.
+	enum Kind : uint8_t { NONE = 0, ATOM, FLOATS, INTS, STRINGS, SEXPR };
+
+	static const uint64_t VERSION = 1;
+
+	/// Perform every complete request in `in`, and append the replies
+	/// to `out`. Return the number of bytes used up; whatever is left
+	/// over is the beginning of a request not yet fully received.
+	static size_t interpret(AtomSpace*, std::string_view in,
+	                        std::string& out);
+};
+
+class WireReader;
+
+/// The type numbers of the other end. The default maps every type to
+/// itself; that is how the server sees them.
+class WireTypes
+{
+	std::vector<Type> _local;
+	std::vector<uint64_t> _remote;
+
+public:
+	WireTypes(void) {}
+
+	/// Read the reply to a HELLO.
+	void load(WireReader&);
+
+	Type to_local(uint64_t) const;
+	uint64_t to_remote(Type) const;
+};
+
+/// Appends frames to a string.
+class WireWriter
+{
+	std::string& _out;
+	const WireTypes& _types;
+	size_t _frame;
+
+public:
+	WireWriter(std::string& out, const WireTypes&);
+
+	/// Start a frame with the command, or the status; then end it.
+	void begin(uint8_t);
+	void end(void);
+
+	void u8(uint8_t);
+	void varint(uint64_t);
+	void f64(double);
+	void str(std::string_view);
+	void type(Type);
+	void atom(const Handle&);
+	void value(const ValuePtr&);
+};
+
+/// Reads what is in one frame. Strings and Atoms are copied out; the
+/// frame need only last as long as the reader.
+class WireReader
+{
+	const char* _p;
+	const char* _end;
+	const WireTypes& _types;
+
+	void need(size_t);
+
+public:
+	WireReader(std::string_view frame, const WireTypes&);
+
+	/// Split the first complete frame off the front of `buf`. Return
+	/// false, and leave `buf` as it is, if there is none yet.
+	static bool next_frame(std::string_view& buf, std::string_view& frame);
+
+	bool done(void) const { return _p == _end; }
+
+	uint8_t u8(void);
+	uint64_t varint(void);
+	double f64(void);
+	std::string_view str(void);
+	Type type(void);
+	Handle atom(void);
+	ValuePtr value(void);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _BINARY_COMMANDS_H
@@ -0,0 +1,440 @@
+/*
+ * FUNCTION:
+ * Block compression of files of Atoms: s-expression dumps and snapshots.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <errno.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zdict.h>
+#include <zstd.h>
+#endif
+
+#include <opencog/util/exceptions.h>
+
+#include "BlockCompress.h"
+
+using namespace opencog;
+
+#define BLOCK_VERSION 1
+#define HEADER_MAGIC "ATOMBLKZ"
+#define TRAILER_MAGIC "BLKINDEX"
+
+// Magic, version, codec, dictionary length.
+#define HEADER_SIZE (8 + 4 + 4 + 8)
+
+// Number of blocks, index offset, magic.
+#define TRAILER_SIZE (8 + 8 + 8)
+
+// zlib looks no further back than this.
+#define ZLIB_WINDOW (32 * 1024)
+
+static void put64(std::string& s, uint64_t v)
+{
+	for (int i = 0; i < 8; i++) { s += char(v & 0xff); v >>= 8; }
+}
+
+static void put32(std::string& s, uint32_t v)
+{
+	for (int i = 0; i < 4; i++) { s += char(v & 0xff); v >>= 8; }
+}
+
+static uint64_t get64(const char* p)
+{
+	uint64_t v = 0;
+	for (int i = 7; 0 <= i; i--) v = (v << 8) | (unsigned char) p[i];
+	return v;
+}
+
+static uint32_t get32(const char* p)
+{
+	uint32_t v = 0;
+	for (int i = 3; 0 <= i; i--) v = (v << 8) | (unsigned char) p[i];
+	return v;
+}
+
+// ==================================================================
+
+bool opencog::block_codec_available(BlockCodec c)
+{
+	switch (c)
+	{
+		case BlockCodec::NONE: return true;
+#ifdef HAVE_ZLIB
+		case BlockCodec::ZLIB: return true;
+#endif
+#ifdef HAVE_ZSTD
+		case BlockCodec::ZSTD: return true;
+#endif
+		default: return false;
+	}
+}
+
+BlockCodec opencog::block_codec_named(const std::string& name)
+{
+	if (name == "none") return BlockCodec::NONE;
+	if (name == "zlib") return BlockCodec::ZLIB;
+	if (name == "zstd") return BlockCodec::ZSTD;
+	throw RuntimeException(TRACE_INFO,
+		"Unknown compression codec \"%s\"; expecting none, zlib or zstd",
+		name.c_str());
+}
+
+std::string opencog::train_dictionary(const std::vector<std::string>& samples,
+                                      BlockCodec c, size_t max_size)
+{
+	if (BlockCodec::ZLIB == c)
+	{
+		std::string dict;
+		size_t want = std::min(max_size, (size_t) ZLIB_WINDOW);
+		for (auto it = samples.rbegin();
+		     it != samples.rend() and dict.size() < want; it++)
+			dict.insert(0, *it);
+		if (want < dict.size()) dict.erase(0, dict.size() - want);
+		return dict;
+	}
+
+#ifdef HAVE_ZSTD
+	if (BlockCodec::ZSTD == c)
+	{
+		std::string all;
+		std::vector<size_t> sizes;
+		for (const std::string& s : samples)
+		{
+			all += s;
+			sizes.push_back(s.size());
+		}
+		std::string dict(max_size, 0);
+		size_t n = ZDICT_trainFromBuffer(&dict[0], dict.size(),
+			all.data(), sizes.data(), sizes.size());
+		if (ZDICT_isError(n)) return "";
+		dict.resize(n);
+		return dict;
+	}
+#endif
+
+	return "";
+}
+
+// ==================================================================
+
+static void no_codec(BlockCodec c)
+{
+	throw RuntimeException(TRACE_INFO,
+		"Compression codec %u is not available in this build",
+		(unsigned) c);
+}
+
+static std::string compress_block(std::string_view in, const BlockOptions& opts)
+{
+	std::string out;
+	switch (opts.codec)
+	{
+		case BlockCodec::NONE:
+			return std::string(in);
+
+#ifdef HAVE_ZLIB
+		case BlockCodec::ZLIB:
+		{
+			z_stream zs;
+			memset(&zs, 0, sizeof(zs));
+			int level = opts.level ? opts.level : Z_DEFAULT_COMPRESSION;
+			if (Z_OK != deflateInit(&zs, level))
+				throw RuntimeException(TRACE_INFO, "deflateInit failed");
+			if (0 < opts.dictionary.size())
+				deflateSetDictionary(&zs,
+					(const Bytef*) opts.dictionary.data(),
+					opts.dictionary.size());
+			out.resize(deflateBound(&zs, in.size()));
+			zs.next_in = (Bytef*) in.data();
+			zs.avail_in = in.size();
+			zs.next_out = (Bytef*) &out[0];
+			zs.avail_out = out.size();
+			int rc = deflate(&zs, Z_FINISH);
+			out.resize(zs.total_out);
+			deflateEnd(&zs);
+			if (Z_STREAM_END != rc)
+				throw RuntimeException(TRACE_INFO, "deflate failed: %d", rc);
+			return out;
+		}
+#endif
+
+#ifdef HAVE_ZSTD
+		case BlockCodec::ZSTD:
+		{
+			ZSTD_CCtx* cctx = ZSTD_createCCtx();
+			out.resize(ZSTD_compressBound(in.size()));
+			size_t n = ZSTD_compress_usingDict(cctx, &out[0], out.size(),
+				in.data(), in.size(),
+				opts.dictionary.data(), opts.dictionary.size(), opts.level);
+			ZSTD_freeCCtx(cctx);
+			if (ZSTD_isError(n))
+				throw RuntimeException(TRACE_INFO,
+					"zstd compression failed: %s", ZSTD_getErrorName(n));
+			out.resize(n);
+			return out;
+		}
+#endif
+
+		default:
+			no_codec(opts.codec);
+	}
+	return out;
+}
+
+// ==================================================================
+
+BlockWriter::BlockWriter(FILE* fh, const BlockOptions& opts)
+	: _fh(fh), _opts(opts), _off(0), _done(false)
+{
+	if (not block_codec_available(_opts.codec))
+		no_codec(_opts.codec);
+	if (0 == _opts.block_size) _opts.block_size = 1;
+	_buf.reserve(_opts.block_size);
+
+	std::string hdr(HEADER_MAGIC);
+	put32(hdr, BLOCK_VERSION);
+	put32(hdr, (uint32_t) _opts.codec);
+	put64(hdr, _opts.dictionary.size());
+	hdr += _opts.dictionary;
+	put(hdr);
+}
+
+void BlockWriter::put(const std::string& s)
+{
+	if (0 < s.size() and 1 != fwrite(s.data(), s.size(), 1, _fh))
+		throw IOException(TRACE_INFO,
+			"Block write failed: %s", strerror(errno));
+	_off += s.size();
+}
+
+void BlockWriter::cut(void)
+{
+	if (_buf.empty()) return;
+	std::string z(compress_block(_buf, _opts));
+	_index.push_back({_off, z.size(), _buf.size()});
+	put(z);
+	_buf.clear();
+}
+
+void BlockWriter::write(std::string_view s)
+{
+	if (_opts.block_size < _buf.size() + s.size()) cut();
+	_buf.append(s);
+	if (_opts.block_size <= _buf.size()) cut();
+}
+
+void BlockWriter::finish(void)
+{
+	if (_done) return;
+	cut();
+
+	std::string tail;
+	for (const BlockEntry& e : _index)
+	{
+		put64(tail, e.off);
+		put64(tail, e.len);
+		put64(tail, e.raw);
+	}
+	put64(tail, _index.size());
+	put64(tail, _off);
+	tail += TRAILER_MAGIC;
+	put(tail);
+	_done = true;
+}
+
+// ==================================================================
+
+bool BlockReader::is_blocked(std::string_view file)
+{
+	return 8 <= file.size() and 0 == file.compare(0, 8, HEADER_MAGIC);
+}
+
+static void damaged(void)
+{
+	throw IOException(TRACE_INFO, "Damaged file of compressed blocks");
+}
+
+BlockReader::BlockReader(std::string_view file)
+	: _file(file)
+{
+	if (not is_blocked(file) or file.size() < HEADER_SIZE + TRAILER_SIZE)
+		damaged();
+
+	const char* p = file.data();
+	if (BLOCK_VERSION != get32(p + 8))
+		throw IOException(TRACE_INFO,
+			"Unsupported block format version %u", get32(p + 8));
+	_codec = (BlockCodec) get32(p + 12);
+	if (not block_codec_available(_codec))
+		throw IOException(TRACE_INFO,
+			"Compression codec %u is not available in this build",
+			(unsigned) _codec);
+
+	uint64_t dlen = get64(p + 16);
+	if (file.size() - HEADER_SIZE - TRAILER_SIZE < dlen) damaged();
+	_dict = file.substr(HEADER_SIZE, dlen);
+	uint64_t start = HEADER_SIZE + dlen;
+
+	const char* t = p + file.size() - TRAILER_SIZE;
+	if (0 != memcmp(t + 16, TRAILER_MAGIC, 8)) damaged();
+	uint64_t nblocks = get64(t);
+	uint64_t ioff = get64(t + 8);
+	if (ioff < start or file.size() - TRAILER_SIZE < ioff or
+	    (file.size() - TRAILER_SIZE - ioff) / 24 != nblocks or
+	    (file.size() - TRAILER_SIZE - ioff) % 24)
+		damaged();
+
+	uint64_t at = start;
+	for (uint64_t i = 0; i < nblocks; i++)
+	{
+		const char* e = p + ioff + 24 * i;
+		BlockEntry be{get64(e), get64(e + 8), get64(e + 16)};
+		if (be.off != at or ioff - at < be.len) damaged();
+		at += be.len;
+		_index.push_back(be);
+	}
+	if (at != ioff) damaged();
+}
+
+uint64_t BlockReader::raw_size(size_t from, size_t to) const
+{
+	uint64_t n = 0;
+	for (size_t i = from; i < to and i < _index.size(); i++)
+		n += _index[i].raw;
+	return n;
+}
+
+void BlockReader::decompress(size_t i, char* out) const
+{
+	const BlockEntry& be = _index[i];
+	std::string_view in(_file.substr(be.off, be.len));
+	switch (_codec)
+	{
+		case BlockCodec::NONE:
+			if (be.len != be.raw) damaged();
+			memcpy(out, in.data(), be.raw);
+			return;
+
+#ifdef HAVE_ZLIB
+		case BlockCodec::ZLIB:
+		{
+			z_stream zs;
+			memset(&zs, 0, sizeof(zs));
+			if (Z_OK != inflateInit(&zs))
+				throw RuntimeException(TRACE_INFO, "inflateInit failed");
+			zs.next_in = (Bytef*) in.data();
+			zs.avail_in = in.size();
+			zs.next_out = (Bytef*) out;
+			zs.avail_out = be.raw;
+			int rc = inflate(&zs, Z_FINISH);
+			if (Z_NEED_DICT == rc)
+			{
+				inflateSetDictionary(&zs,
+					(const Bytef*) _dict.data(), _dict.size());
+				rc = inflate(&zs, Z_FINISH);
+			}
+			uint64_t got = zs.total_out;
+			inflateEnd(&zs);
+			if (Z_STREAM_END != rc or got != be.raw) damaged();
+			return;
+		}
+#endif
+
+#ifdef HAVE_ZSTD
+		case BlockCodec::ZSTD:
+		{
+			ZSTD_DCtx* dctx = ZSTD_createDCtx();
+			size_t n = ZSTD_decompress_usingDict(dctx, out, be.raw,
+				in.data(), in.size(), _dict.data(), _dict.size());
+			ZSTD_freeDCtx(dctx);
+			if (ZSTD_isError(n) or n != be.raw) damaged();
+			return;
+		}
+#endif
+
+		default:
+			damaged();
+	}
+}
+
+std::string BlockReader::read(size_t from, size_t to, size_t nthreads) const
+{
+	if (size() < to) to = size();
+	if (to <= from) return "";
+
+	std::vector<uint64_t> at;
+	uint64_t total = 0;
+	for (size_t i = from; i < to; i++)
+	{
+		at.push_back(total);
+		total += _index[i].raw;
+	}
+	std::string out(total, 0);
+
+	if (0 == nthreads) nthreads = std::thread::hardware_concurrency();
+	nthreads = std::max((size_t) 1, std::min(nthreads, to - from));
+	if (1 == nthreads)
+	{
+		for (size_t i = from; i < to; i++)
+			decompress(i, &out[at[i - from]]);
+		return out;
+	}
+
+	// Each thread takes the next block not yet taken.
+	std::atomic<size_t> next(from);
+	std::exception_ptr err;
+	std::mutex err_mtx;
+	auto work = [&](void)
+	{
+		for (size_t i = next++; i < to; i = next++)
+		{
+			try { decompress(i, &out[at[i - from]]); }
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lck(err_mtx);
+				if (not err) err = std::current_exception();
+				next = to;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < nthreads; i++)
+		workers.emplace_back(work);
+	for (std::thread& t : workers) t.join();
+	if (err) std::rethrow_exception(err);
+	return out;
+}
+
+/* ===================== END OF FILE ===================== */
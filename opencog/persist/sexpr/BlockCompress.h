@@ -0,0 +1,163 @@
+/*
+ * FUNCTION:
+ * Block compression of files of Atoms: s-expression dumps and snapshots.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef _OPENCOG_BLOCK_COMPRESS_H
+#define _OPENCOG_BLOCK_COMPRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * A file of compressed blocks. Each block is compressed on its own,
+ * and so can be decompressed on its own, and in parallel with the
+ * others; an index at the end of the file says where each one is.
+ * The writer never splits what it is given in one write() across two
+ * blocks: a dump written one s-expression at a time is cut only
+ * between expressions, and so each block can be parsed on its own,
+ * as well.
+ *
+ * The file holds, in order:
+ * -- a header: the magic `ATOMBLKZ`, a format version, the codec,
+ *    and the dictionary, if there is one;
+ * -- the blocks;
+ * -- the index: for each block, its offset in the file, its length,
+ *    and its length when decompressed;
+ * -- a trailer: the number of blocks, the offset of the index, and
+ *    the magic `BLKINDEX`.
+ * Numbers are 64-bit, little-endian.
+ *
+ * The dictionary is shared by all of the blocks. It helps most when
+ * the blocks are small; see train_dictionary(). The codecs other than
+ * NONE are there only if the library was found when this was built.
+ */
+enum class BlockCodec : uint32_t
+{
+	NONE = 0,
+	ZLIB = 1,
+	ZSTD = 2,
+};
+
+struct BlockOptions
+{
+	BlockCodec codec = BlockCodec::NONE;
+	int level = 0;                   // Zero means the codec's default
+	size_t block_size = 4UL << 20;   // Bytes, before compression
+	std::string dictionary;
+};
+
+/// True if this build can read and write blocks with the codec.
+bool block_codec_available(BlockCodec);
+
+/// The codec called "none", "zlib" or "zstd". Throws a
+/// RuntimeException for any other name.
+BlockCodec block_codec_named(const std::string&);
+
+/// A dictionary of up to `max_size` bytes, made from samples of what
+/// is to be compressed. For zstd, it is trained on the samples, which
+/// should number in the hundreds, at least; given too few, there is no
+/// dictionary, and the empty string is returned. For zlib, which has
+/// no training, it is the last 32KB of the samples.
+std::string train_dictionary(const std::vector<std::string>& samples,
+                             BlockCodec, size_t max_size = 110 * 1024);
+
+/// Where a block is in the file, and how long it is, there and
+/// decompressed.
+struct BlockEntry
+{
+	uint64_t off;
+	uint64_t len;
+	uint64_t raw;
+};
+
+class BlockWriter
+{
+	FILE* _fh;
+	BlockOptions _opts;
+	std::string _buf;
+	uint64_t _off;
+	std::vector<BlockEntry> _index;
+	bool _done;
+
+	void put(const std::string&);
+	void cut(void);
+
+public:
+	/// Writes the header at once; throws a RuntimeException if the
+	/// codec is not available.
+	BlockWriter(FILE*, const BlockOptions&);
+
+	void write(std::string_view);
+
+	/// Write the last block, the index and the trailer. The file is
+	/// not closed.
+	void finish(void);
+
+	size_t blocks(void) const { return _index.size(); }
+};
+
+/**
+ * The blocks of a file, as written by a BlockWriter. The file is not
+ * copied: the buffer has to outlive the reader. The reader throws an
+ * IOException if the file is damaged, or if it needs a codec that is
+ * not available.
+ */
+class BlockReader
+{
+	std::string_view _file;
+	BlockCodec _codec;
+	std::string_view _dict;
+	std::vector<BlockEntry> _index;
+
+	void decompress(size_t, char*) const;
+
+public:
+	BlockReader(std::string_view);
+
+	/// True if the buffer starts off like a file of blocks.
+	static bool is_blocked(std::string_view);
+
+	size_t size(void) const { return _index.size(); }
+	uint64_t raw_size(size_t from, size_t to) const;
+
+	/// The blocks `from` up to `to`, decompressed and joined, using
+	/// as many as `nthreads` threads; zero means one per core.
+	std::string read(size_t from, size_t to, size_t nthreads = 1) const;
+	std::string read_all(size_t nthreads = 0) const
+		{ return read(0, size(), nthreads); }
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_BLOCK_COMPRESS_H
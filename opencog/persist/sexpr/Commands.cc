@@ -20,20 +20,25 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <stdlib.h>
 #include <time.h>
 
-#include <functional>
-#include <iomanip>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/execution/QueryLog.h>
 #include <opencog/atoms/value/FloatValue.h>
 #include <opencog/atoms/truthvalue/TruthValue.h>
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspace/MemoryReport.h>
+#include <opencog/atomspace/ScanCursor.h>
 
 #include "Commands.h"
+#include "ExecCache.h"
 #include "Sexpr.h"
 
 using namespace opencog;
@@ -45,280 +50,567 @@ using namespace opencog;
 /// the code in this directory in order to make it fast.
 ///
 /// To aid in performance, a very special set of about 15 scheme
-/// functions have been hard-coded in C++, in the static function
-/// `Commands::interpret_command()` below.  The goal is to avoid the
-/// overhead of entry/exit into guile. This works because the cogserver
-/// is guaranteed to send only these commands, and no others.
+/// functions have been hard-coded in C++, in the static functions
+/// below.  The goal is to avoid the overhead of entry/exit into guile.
+/// This works because the cogserver is guaranteed to send only these
+/// commands, and no others.
+///
+/// Each command works in place, on the string it arrived in: `pos`
+/// points just past the command name, and `end` at the close-paren
+/// of the command. The reply is appended to `out`.
 //
-std::string Commands::interpret_command(AtomSpace* as,
-                                        const std::string& cmd)
+typedef void (*Command)(AtomSpace*, const std::string& cmd,
+                        size_t pos, size_t end, std::string& out);
+
+// -----------------------------------------------
+// (cog-atomspace-clear)
+static void clear(AtomSpace* as, const std::string& cmd,
+                  size_t pos, size_t end, std::string& out)
+{
+	as->clear();
+	out += "#t\n";
+}
+
+// -----------------------------------------------
+// (cog-execute-cache! (GetLink ...) (Predicate "key") ...)
+// This is complicated, and subject to change...
+// The cached result is returned only if it is not known to be stale;
+// see ExecCache for how that is decided.
+static void execute_cache(AtomSpace* as, const std::string& cmd,
+                          size_t pos, size_t end, std::string& out)
 {
-	// Fast dispatch. There should be zero hash collisions
-	// here. If there are, we are in trouble. (Well, if there
-	// are collisions, pre-pend the paren, post-pend the space.)
-	static const size_t clear = std::hash<std::string>{}("cog-atomspace-clear)");
-	static const size_t cache = std::hash<std::string>{}("cog-execute-cache!");
-	static const size_t extra = std::hash<std::string>{}("cog-extract!");
-	static const size_t recur = std::hash<std::string>{}("cog-extract-recursive!");
-	static const size_t gtatm = std::hash<std::string>{}("cog-get-atoms");
-	static const size_t incty = std::hash<std::string>{}("cog-incoming-by-type");
-	static const size_t incom = std::hash<std::string>{}("cog-incoming-set");
-	static const size_t keys = std::hash<std::string>{}("cog-keys->alist");
-	static const size_t link = std::hash<std::string>{}("cog-link");
-	static const size_t node = std::hash<std::string>{}("cog-node");
-	static const size_t stval = std::hash<std::string>{}("cog-set-value!");
-	static const size_t svals = std::hash<std::string>{}("cog-set-values!");
-	static const size_t settv = std::hash<std::string>{}("cog-set-tv!");
-	static const size_t value = std::hash<std::string>{}("cog-value");
-
-	// Find the command and dispatch
-	size_t pos = cmd.find_first_not_of(" \n\t");
-	if (std::string::npos == pos) return "";
-
-	// Ignore comments
-	if (';' == cmd[pos]) return "";
-
-	if ('(' != cmd[pos])
-		throw SyntaxException(TRACE_INFO, "Badly formed command: %s",
-			cmd.c_str());
-
-	pos ++; // Skip over the open-paren
-
-	size_t epos = cmd.find_first_of(" \n\t", pos);
-	if (std::string::npos == epos)
-		throw SyntaxException(TRACE_INFO, "Not a command: %s",
-			cmd.c_str());
-
-	size_t act = std::hash<std::string>{}(cmd.substr(pos, epos-pos));
-
-	// -----------------------------------------------
-	// (cog-atomspace-clear)
-	if (clear == act)
+	Handle query = Sexpr::decode_atom(cmd, pos);
+	query = as->add_atom(query);
+	Handle key = Sexpr::decode_atom(cmd, ++pos);
+	key = as->add_atom(key);
+
+	bool force = false;
+	pos = cmd.find_first_of('(', pos);
+	if (pos < end)
 	{
-		as->clear();
-		return "#t\n";
+		Handle meta = Sexpr::decode_atom(cmd, pos);
+		meta = as->add_atom(meta);
+
+		// XXX Hacky .. store time in float value...
+		query->setValue(meta, createFloatValue((double)time(0)));
+		size_t f = cmd.find("#t", pos);
+		if (f < end) force = true;
+	}
+	std::shared_ptr<ExecCache> cache(ExecCache::for_space(as));
+	ValuePtr rslt = query->getValue(key);
+	if (nullptr != rslt and not force and
+	    cache->is_fresh(query, key, rslt))
+	{
+		Sexpr::encode_value(out, rslt);
+		return;
 	}
 
-	// -----------------------------------------------
-	// (cog-execute-cache! (GetLink ...) (Predicate "key") ...)
-	// This is complicated, and subject to change...
-	if (cache == act)
+	// For now, prevent general execution.
+	Type qt = query->get_type();
+	if (not nameserver().isA(qt, PATTERN_LINK) and
+	    not nameserver().isA(qt, JOIN_LINK))
 	{
-		pos = epos + 1;
-		Handle query = Sexpr::decode_atom(cmd, pos);
-		query = as->add_atom(query);
-		Handle key = Sexpr::decode_atom(cmd, ++pos);
-		key = as->add_atom(key);
-
-		bool force = false;
-		pos = cmd.find_first_of('(', pos);
-		if (std::string::npos != pos)
-		{
-			Handle meta = Sexpr::decode_atom(cmd, pos);
-			meta = as->add_atom(meta);
+		out += "#f\n";
+		return;
+	}
 
-			// XXX Hacky .. store time in float value...
-			query->setValue(meta, createFloatValue((double)time(0)));
-			if (std::string::npos != cmd.find("#t", pos))
-				force = true;
-		}
-		ValuePtr rslt = query->getValue(key);
-		if (nullptr != rslt and not force)
-			return Sexpr::encode_value(rslt);
+	ExecCache::Watch watch(cache->watch(as, query));
+	QueryProbe probe(query, "cog-execute-cache!");
+	rslt = query->execute();
+	probe.done(rslt);
+	query->setValue(key, rslt);
+	cache->record(query, key, std::move(watch), rslt);
+
+	Sexpr::encode_value(out, rslt);
+}
 
-		// For now, prevent general execution.
-		Type qt = query->get_type();
-		if (not nameserver().isA(qt, PATTERN_LINK) and
-		    not nameserver().isA(qt, JOIN_LINK))
-			return "#f\n";
+// -----------------------------------------------
+// (cog-extract! (Concept "foo"))
+// (cog-extract-recursive! (Concept "foo"))
+static void do_extract(AtomSpace* as, const std::string& cmd,
+                       size_t pos, std::string& out, bool recursive)
+{
+	Handle h = as->get_atom(Sexpr::decode_atom(cmd, pos));
+	if (nullptr == h or as->extract_atom(h, recursive))
+		out += "#t\n";
+	else
+		out += "#f\n";
+}
 
-		rslt = query->execute();
-		query->setValue(key, rslt);
+static void extract(AtomSpace* as, const std::string& cmd,
+                    size_t pos, size_t end, std::string& out)
+{
+	do_extract(as, cmd, pos, out, false);
+}
 
-		return Sexpr::encode_value(rslt);
-	}
+static void extract_recursive(AtomSpace* as, const std::string& cmd,
+                              size_t pos, size_t end, std::string& out)
+{
+	do_extract(as, cmd, pos, out, true);
+}
 
-	// -----------------------------------------------
-	// (cog-extract! (Concept "foo"))
-	if (extra == act)
-	{
-		pos = epos + 1;
-		Handle h = as->get_atom(Sexpr::decode_atom(cmd, pos));
-		if (nullptr == h) return "#t\n";
-		if (as->extract_atom(h, false)) return "#t\n";
-		return "#f\n";
-	}
+// -----------------------------------------------
+// (cog-get-atoms 'Node #t)
+static void get_atoms(AtomSpace* as, const std::string& cmd,
+                      size_t pos, size_t end, std::string& out)
+{
+	Type t = Sexpr::decode_type(cmd, pos);
+
+	pos = cmd.find_first_not_of(") \n\t", pos);
+	bool get_subtypes = false;
+	if (pos < end and cmd.compare(pos, 2, "#f"))
+		get_subtypes = true;
+
+	out += '(';
+	HandleSeq hset;
+	as->get_handles_by_type(hset, t, get_subtypes);
+	for (const Handle& h: hset)
+		Sexpr::encode_atom(out, h);
+	out += ')';
+}
 
-	// -----------------------------------------------
-	// (cog-extract-recursive! (Concept "foo"))
-	if (recur == act)
+// -----------------------------------------------
+// The paged versions of the above. Each reply is a list, the token
+// for the next page first, and then the Atoms; the token is zero on
+// the last page.
+//
+// (cog-get-atoms-page 'Node #t 1000)
+// (cog-incoming-page (Concept "foo") 1000)
+// (cog-incoming-page (Concept "foo") 'ListLink 1000)
+// (cog-next-page 123456789 1000)
+// (cog-close-cursor 123456789)
+
+// The command string is null-terminated, so the numbers can be read
+// right where they are. The page size may be left out.
+static uint64_t get_number(const std::string& cmd, size_t pos, size_t end,
+                           bool required)
+{
+	uint64_t n = 0;
+	const char* start = nullptr;
+	char* stop = nullptr;
+	if (pos < end)
 	{
-		pos = epos + 1;
-		Handle h = as->get_atom(Sexpr::decode_atom(cmd, pos));
-		if (nullptr == h) return "#t\n";
-		if (as->extract_atom(h, true)) return "#t\n";
-		return "#f\n";
+		start = cmd.c_str() + pos;
+		n = strtoull(start, &stop, 10);
 	}
-
-	// -----------------------------------------------
-	// (cog-get-atoms 'Node #t)
-	if (gtatm == act)
+	if (stop == start or cmd.c_str() + end < stop)
 	{
-		pos = epos + 1;
-		Type t = Sexpr::decode_type(cmd, pos);
-
-		pos = cmd.find_first_not_of(") \n\t", pos);
-		bool get_subtypes = false;
-		if (std::string::npos != pos and cmd.compare(pos, 2, "#f"))
-			get_subtypes = true;
-
-		std::string rv = "(";
-		HandleSeq hset;
-		as->get_handles_by_type(hset, t, get_subtypes);
-		for (const Handle& h: hset)
-			rv += Sexpr::encode_atom(h);
-		rv += ")";
-		return rv;
+		if (required)
+			throw SyntaxException(TRACE_INFO, "Bad number: %s", cmd.c_str());
+		return 0;
 	}
+	return n;
+}
 
-	// -----------------------------------------------
-	// (cog-incoming-by-type (Concept "foo") 'ListLink)
-	if (incty == act)
-	{
-		pos = epos + 1;
-		Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
-		Type t = Sexpr::decode_type(cmd, pos);
+static void page(uint64_t tok, size_t n, std::string& out)
+{
+	HandleSeq hs;
+	tok = ScanCursor::next(tok, n, hs);
+	out += '(';
+	out += std::to_string(tok);
+	for (const Handle& h: hs)
+		Sexpr::encode_atom(out, h);
+	out += ")\n";
+}
 
-		std::string alist = "(";
-		for (const Handle& hi : h->getIncomingSetByType(t))
-			alist += Sexpr::encode_atom(hi);
+static void get_atoms_page(AtomSpace* as, const std::string& cmd,
+                           size_t pos, size_t end, std::string& out)
+{
+	Type t = Sexpr::decode_type(cmd, pos);
 
-		alist += ")\n";
-		return alist;
-	}
+	pos = cmd.find_first_not_of(") \n\t", pos);
+	bool get_subtypes = false;
+	if (pos < end and cmd.compare(pos, 2, "#f"))
+		get_subtypes = true;
+	if (pos < end) pos += 2;
 
-	// -----------------------------------------------
-	// (cog-incoming-set (Concept "foo"))
-	if (incom == act)
-	{
-		pos = epos + 1;
-		Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
-		std::string alist = "(";
-		for (const Handle& hi : h->getIncomingSet())
-			alist += Sexpr::encode_atom(hi);
-
-		alist += ")\n";
-		return alist;
-	}
+	size_t n = get_number(cmd, pos, end, false);
+	page(ScanCursor::open_type(as, t, get_subtypes), n, out);
+}
+
+static void incoming_page(AtomSpace* as, const std::string& cmd,
+                          size_t pos, size_t end, std::string& out)
+{
+	Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
+	pos = cmd.find_first_not_of(") \n\t", pos);
+
+	Type t = NOTYPE;
+	if (pos < end and '\'' == cmd[pos])
+		t = Sexpr::decode_type(cmd, pos);
+
+	size_t n = get_number(cmd, pos, end, false);
+	page(ScanCursor::open_incoming(h, t), n, out);
+}
+
+static void next_page(AtomSpace* as, const std::string& cmd,
+                      size_t pos, size_t end, std::string& out)
+{
+	uint64_t tok = get_number(cmd, pos, end, true);
+	pos = cmd.find_first_of(") \n\t", cmd.find_first_not_of(" \n\t", pos));
+	size_t n = get_number(cmd, pos, end, false);
+	page(tok, n, out);
+}
+
+static void close_cursor(AtomSpace* as, const std::string& cmd,
+                         size_t pos, size_t end, std::string& out)
+{
+	uint64_t tok = get_number(cmd, pos, end, true);
+	out += ScanCursor::close(tok) ? "#t\n" : "#f\n";
+}
+
+// -----------------------------------------------
+// (cog-incoming-by-type (Concept "foo") 'ListLink)
+static void incoming_by_type(AtomSpace* as, const std::string& cmd,
+                             size_t pos, size_t end, std::string& out)
+{
+	Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
+	Type t = Sexpr::decode_type(cmd, pos);
+
+	out += '(';
+	for (const Handle& hi : h->getIncomingSetByType(t))
+		Sexpr::encode_atom(out, hi);
+	out += ")\n";
+}
+
+// -----------------------------------------------
+// (cog-incoming-set (Concept "foo"))
+static void incoming_set(AtomSpace* as, const std::string& cmd,
+                         size_t pos, size_t end, std::string& out)
+{
+	Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
+	out += '(';
+	for (const Handle& hi : h->getIncomingSet())
+		Sexpr::encode_atom(out, hi);
+	out += ")\n";
+}
 
-	// -----------------------------------------------
-	// (cog-keys->alist (Concept "foo"))
-	if (keys == act)
+// -----------------------------------------------
+// (cog-keys->alist (Concept "foo"))
+static void keys_alist(AtomSpace* as, const std::string& cmd,
+                       size_t pos, size_t end, std::string& out)
+{
+	Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
+	out += '(';
+	for (const Handle& key : h->getKeys())
 	{
-		pos = epos + 1;
-		Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
-		std::string alist = "(";
-		for (const Handle& key : h->getKeys())
-		{
-			alist += "(" + Sexpr::encode_atom(key) + " . ";
-			alist += Sexpr::encode_value(h->getValue(key)) + ")";
-		}
-		alist += ")\n";
-		return alist;
+		out += '(';
+		Sexpr::encode_atom(out, key);
+		out += " . ";
+		Sexpr::encode_value(out, h->getValue(key));
+		out += ')';
 	}
+	out += ")\n";
+}
 
-	// -----------------------------------------------
-	// (cog-node 'Concept "foobar")
-	// (cog-link 'ListLink (Atom) (Atom) (Atom))
-	if (node == act or link == act)
-	{
-		pos = epos + 1;
-		Type t = Sexpr::decode_type(cmd, pos);
+// -----------------------------------------------
+// (cog-merkle-digests)
+// (cog-merkle-digests 'ConceptNode 1 2 3 'ListLink 1)
+// (cog-merkle-atoms 'ConceptNode 1030 1031)
+// For walking the content digests of the AtomSpace from afar; see
+// MerkleTree.h. Each type is followed by the numbers of nodes in its
+// tree. The first returns the root digest, or else the digests of
+// the nodes, in order; the second, the Atoms in the buckets.
+static std::vector<MerkleTree::Node> merkle_nodes(AtomSpace* as,
+                        const std::string& cmd, size_t pos, size_t end)
+{
+	if (not as->tracking_digests())
+		as->track_digests(true);
 
-		Handle h;
-		if (node == act)
-		{
-			size_t l = pos+1;
-			size_t r = cmd.size();
-			std::string name = Sexpr::get_node_name(cmd, l, r, t);
-			h = as->get_node(t, std::move(name));
-		}
-		else
-		if (link == act)
+	std::vector<MerkleTree::Node> nodes;
+	Type t = NOTYPE;
+	while (true)
+	{
+		pos = cmd.find_first_not_of(" \n\t", pos);
+		if (end <= pos) break;
+		if ('\'' == cmd[pos])
 		{
-			HandleSeq outgoing;
-			size_t l = pos+1;
-			size_t r = cmd.size();
-			while (l < r and ')' != cmd[l])
-			{
-				size_t l1 = l;
-				size_t r1 = r;
-				Sexpr::get_next_expr(cmd, l1, r1, 0);
-				if (l1 == r1) break;
-				outgoing.push_back(Sexpr::decode_atom(cmd, l1, r1, 0));
-				l = r1 + 1;
-			}
-			h = as->get_link(t, std::move(outgoing));
+			t = Sexpr::decode_type(cmd, pos);
+			continue;
 		}
-		if (nullptr == h) return "()\n";
-		return Sexpr::encode_atom(h);
+		const char* start = cmd.c_str() + pos;
+		char* stop;
+		size_t n = strtoull(start, &stop, 10);
+		if (stop == start or NOTYPE == t)
+			throw SyntaxException(TRACE_INFO, "Bad node: %s", cmd.c_str());
+		nodes.push_back({t, n});
+		pos += stop - start;
 	}
+	return nodes;
+}
 
-	// -----------------------------------------------
-	// (cog-set-value! (Concept "foo") (Predicate "key") (FloatValue 1 2 3))
-	if (stval == act)
+static void merkle_digests(AtomSpace* as, const std::string& cmd,
+                           size_t pos, size_t end, std::string& out)
+{
+	std::vector<MerkleTree::Node> nodes(merkle_nodes(as, cmd, pos, end));
+	if (nodes.empty()) nodes.push_back({NOTYPE, 1});
+
+	out += '(';
+	bool first = true;
+	for (uint64_t d : as->get_digests().digests(nodes))
 	{
-		pos = epos + 1;
-		Handle atom = Sexpr::decode_atom(cmd, pos);
-		atom = as->add_atom(atom);
-		Handle key = Sexpr::decode_atom(cmd, ++pos);
-		key = as->add_atom(key);
-		ValuePtr vp = Sexpr::decode_value(cmd, ++pos);
-		if (vp)
-			vp = Sexpr::add_atoms(as, vp);
-		atom->setValue(key, vp);
-		return "()\n";
+		if (not first) out += ' ';
+		first = false;
+		out += std::to_string(d);
 	}
+	out += ")\n";
+}
 
-	// -----------------------------------------------
-	// (cog-set-values! (Concpet "foo")
-	//     (alist (cons (Predicate "bar") (stv 0.9 0.8)) ...))
-	if (svals == act)
+static void merkle_atoms(AtomSpace* as, const std::string& cmd,
+                         size_t pos, size_t end, std::string& out)
+{
+	std::vector<MerkleTree::Node> nodes(merkle_nodes(as, cmd, pos, end));
+	out += '(';
+	for (const Handle& h : MerkleTree::atoms_in(*as, nodes))
+		Sexpr::encode_atom(out, h);
+	out += ")\n";
+}
+
+// -----------------------------------------------
+// (cog-node 'Concept "foobar")
+static void node(AtomSpace* as, const std::string& cmd,
+                 size_t pos, size_t end, std::string& out)
+{
+	Type t = Sexpr::decode_type(cmd, pos);
+
+	size_t l = pos+1;
+	size_t r = end;
+	std::string name = Sexpr::get_node_name(cmd, l, r, t);
+	Handle h = as->get_node(t, std::move(name));
+
+	if (nullptr == h) { out += "()\n"; return; }
+	Sexpr::encode_atom(out, h);
+}
+
+// -----------------------------------------------
+// (cog-link 'ListLink (Atom) (Atom) (Atom))
+static void link(AtomSpace* as, const std::string& cmd,
+                 size_t pos, size_t end, std::string& out)
+{
+	Type t = Sexpr::decode_type(cmd, pos);
+
+	HandleSeq outgoing;
+	size_t l = pos+1;
+	size_t r = end;
+	while (l < r and ')' != cmd[l])
 	{
-		pos = epos + 1;
-		Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
-		pos++; // skip past close-paren
-		Sexpr::decode_slist(h, cmd, pos);
-		return "()\n";
+		size_t l1 = l;
+		size_t r1 = r;
+		Sexpr::get_next_expr(cmd, l1, r1, 0);
+		if (l1 == r1) break;
+		outgoing.push_back(Sexpr::decode_atom(cmd, l1, r1, 0));
+		l = r1 + 1;
 	}
+	Handle h = as->get_link(t, std::move(outgoing));
 
-	// -----------------------------------------------
-	// (cog-set-tv! (Concept "foo") (stv 1 0))
-	if (settv == act)
+	if (nullptr == h) { out += "()\n"; return; }
+	Sexpr::encode_atom(out, h);
+}
+
+// -----------------------------------------------
+// (cog-set-value! (Concept "foo") (Predicate "key") (FloatValue 1 2 3))
+static void set_value(AtomSpace* as, const std::string& cmd,
+                      size_t pos, size_t end, std::string& out)
+{
+	Handle atom = Sexpr::decode_atom(cmd, pos);
+	atom = as->add_atom(atom);
+	Handle key = Sexpr::decode_atom(cmd, ++pos);
+	key = as->add_atom(key);
+	ValuePtr vp = Sexpr::decode_value(cmd, ++pos);
+	if (vp)
+		vp = Sexpr::add_atoms(as, vp);
+	atom->setValue(key, vp);
+	out += "()\n";
+}
+
+// -----------------------------------------------
+// (cog-inc-value! (Concept "foo") (Predicate "key") 1.0 0)
+static void inc_value(AtomSpace* as, const std::string& cmd,
+                      size_t pos, size_t end, std::string& out)
+{
+	Handle atom = Sexpr::decode_atom(cmd, pos);
+	atom = as->add_atom(atom);
+	Handle key = Sexpr::decode_atom(cmd, ++pos);
+	key = as->add_atom(key);
+
+	pos++; // skip past close-paren
+
+	// The command string is null-terminated, so the numbers can be
+	// read right where they are.
+	const char* start = cmd.c_str() + pos;
+	char* stop;
+	double cnt = strtod(start, &stop);
+	if (stop == start)
+		throw SyntaxException(TRACE_INFO, "Bad count: %s", cmd.c_str());
+	start = stop;
+	size_t ref = strtoul(start, &stop, 10);
+	if (stop == start)
+		throw SyntaxException(TRACE_INFO, "Bad index: %s", cmd.c_str());
+
+	as->increment_count(atom, key, ref, cnt);
+	out += "()\n";
+}
+
+// -----------------------------------------------
+// (cog-set-values! (Concpet "foo")
+//     (alist (cons (Predicate "bar") (stv 0.9 0.8)) ...))
+static void set_values(AtomSpace* as, const std::string& cmd,
+                       size_t pos, size_t end, std::string& out)
+{
+	Handle h = as->add_atom(Sexpr::decode_atom(cmd, pos));
+	pos++; // skip past close-paren
+	Sexpr::decode_slist(h, cmd, pos);
+	out += "()\n";
+}
+
+// -----------------------------------------------
+// (cog-report-memory)
+// The same association list as the scheme version returns.
+static void report_memory(AtomSpace* as, const std::string& cmd,
+                          size_t pos, size_t end, std::string& out)
+{
+	auto entry = [&](const char* name, size_t n)
+	{
+		out += " (";
+		out += name;
+		out += " . ";
+		out += std::to_string(n);
+		out += ')';
+	};
+
+	out += '(';
+	for (const TypeMemory& tm : MemoryReport::report(*as))
 	{
-		pos = epos + 1;
-		Handle h = Sexpr::decode_atom(cmd, pos);
-		Handle ha = as->add_atom(h);
-		if (nullptr == ha) return "()\n"; // read-only atomspace.
-		ValuePtr tv = Sexpr::decode_value(cmd, ++pos);
-		ha->setTruthValue(TruthValueCast(tv));
-		return "()\n";
+		out += '(';
+		out += nameserver().getTypeName(tm.type);
+		entry("count", tm.count);
+		entry("bytes", tm.total());
+		entry("atoms", tm.atoms);
+		entry("names", tm.names);
+		entry("outgoing", tm.outgoing);
+		entry("values", tm.values);
+		entry("payloads", tm.payloads);
+		entry("incoming", tm.incoming);
+		entry("index", tm.index);
+		out += ')';
 	}
+	out += ")\n";
+}
 
-	// -----------------------------------------------
-	// (cog-value (Concept "foo") (Predicate "key"))
-	if (value == act)
+// -----------------------------------------------
+// (cog-set-tv! (Concept "foo") (stv 1 0))
+static void set_tv(AtomSpace* as, const std::string& cmd,
+                   size_t pos, size_t end, std::string& out)
+{
+	Handle h = Sexpr::decode_atom(cmd, pos);
+	Handle ha = as->add_atom(h);
+	if (nullptr == ha) { out += "()\n"; return; } // read-only atomspace.
+	ValuePtr tv = Sexpr::decode_value(cmd, ++pos);
+	ha->setTruthValue(TruthValueCast(tv));
+	out += "()\n";
+}
+
+// -----------------------------------------------
+// (cog-value (Concept "foo") (Predicate "key"))
+static void value(AtomSpace* as, const std::string& cmd,
+                  size_t pos, size_t end, std::string& out)
+{
+	Handle atom = Sexpr::decode_atom(cmd, pos);
+	atom = as->add_atom(atom);
+	Handle key = Sexpr::decode_atom(cmd, ++pos);
+	key = as->add_atom(key);
+
+	ValuePtr vp = atom->getValue(key);
+	Sexpr::encode_value(out, vp);
+}
+
+// -----------------------------------------------
+// Dispatch is by the command name, looked up right where it sits in
+// the command string; nothing is copied.
+static const std::unordered_map<std::string_view, Command> commands =
+{
+	{"cog-atomspace-clear", clear},
+	{"cog-execute-cache!", execute_cache},
+	{"cog-extract!", extract},
+	{"cog-extract-recursive!", extract_recursive},
+	{"cog-close-cursor", close_cursor},
+	{"cog-get-atoms", get_atoms},
+	{"cog-get-atoms-page", get_atoms_page},
+	{"cog-incoming-by-type", incoming_by_type},
+	{"cog-inc-value!", inc_value},
+	{"cog-incoming-page", incoming_page},
+	{"cog-incoming-set", incoming_set},
+	{"cog-keys->alist", keys_alist},
+	{"cog-link", link},
+	{"cog-merkle-atoms", merkle_atoms},
+	{"cog-merkle-digests", merkle_digests},
+	{"cog-next-page", next_page},
+	{"cog-node", node},
+	{"cog-report-memory", report_memory},
+	{"cog-set-value!", set_value},
+	{"cog-set-values!", set_values},
+	{"cog-set-tv!", set_tv},
+	{"cog-value", value},
+};
+
+// ==============================================================
+
+void Commands::interpret_command(AtomSpace* as,
+                                 const std::string& cmd,
+                                 std::string& out)
+{
+	size_t len = cmd.size();
+	size_t pos = 0;
+	size_t cnt = 0;
+	while (true)
 	{
-		pos = epos + 1;
-		Handle atom = Sexpr::decode_atom(cmd, pos);
-		atom = as->add_atom(atom);
-		Handle key = Sexpr::decode_atom(cmd, ++pos);
-		key = as->add_atom(key);
-
-		ValuePtr vp = atom->getValue(key);
-		return Sexpr::encode_value(vp);
+		pos = cmd.find_first_not_of(" \n\t", pos);
+		if (std::string::npos == pos) return;
+
+		// Ignore comments, up to the end of the line.
+		if (';' == cmd[pos])
+		{
+			pos = cmd.find('\n', pos);
+			if (std::string::npos == pos) return;
+			continue;
+		}
+
+		if ('(' != cmd[pos])
+			throw SyntaxException(TRACE_INFO, "Badly formed command: %s",
+				cmd.c_str());
+
+		// Find the close-paren of this command.
+		size_t l = pos;
+		size_t end = len;
+		if (0 != Sexpr::get_next_expr(cmd, l, end, 0))
+			throw SyntaxException(TRACE_INFO, "Unbalanced command: %s",
+				cmd.c_str());
+
+		pos ++; // Skip over the open-paren
+		size_t epos = cmd.find_first_of(" \n\t)", pos);
+		if (std::string::npos == epos)
+			throw SyntaxException(TRACE_INFO, "Not a command: %s",
+				cmd.c_str());
+
+		std::string_view name(cmd.data() + pos, epos - pos);
+		auto it = commands.find(name);
+		if (commands.end() == it)
+			throw SyntaxException(TRACE_INFO, "Command not supported: >>%s<<",
+				std::string(name).c_str());
+
+		// In a batch, each reply gets a line of its own.
+		if (0 < cnt++ and 0 < out.size() and '\n' != out.back())
+			out += '\n';
+
+		it->second(as, cmd, epos + 1, end, out);
+		pos = end + 1;
+		if (len <= pos) return;
 	}
+}
 
-	throw SyntaxException(TRACE_INFO, "Command not supported: >>%s<<",
-		cmd.substr(pos, epos-pos).c_str());
+std::string Commands::interpret_command(AtomSpace* as,
+                                        const std::string& cmd)
+{
+	std::string out;
+	interpret_command(as, cmd, out);
+	return out;
 }
@@ -45,25 +45,47 @@ public:
 	///
 	/// The supported commands are:
 	///    cog-atomspace-clear
+	///    cog-close-cursor
 	///    cog-execute-cache!
 	///    cog-extract!
 	///    cog-extract-recursive!
 	///    cog-get-atoms
+	///    cog-get-atoms-page
 	///    cog-incoming-by-type
+	///    cog-incoming-page
 	///    cog-incoming-set
 	///    cog-keys->alist
 	///    cog-link
+	///    cog-merkle-atoms
+	///    cog-merkle-digests
+	///    cog-next-page
 	///    cog-node
+	///    cog-report-memory
 	///    cog-set-value!
 	///    cog-set-values!
 	///    cog-set-tv!
 	///    cog-value
-   ///
-	/// They MUST appear only once in the string, at the very beginning,
-	/// and they MUST be followed by valid Atomese s-expressions, and
-	/// nothing else.
+	///
+	/// Each command MUST be followed by valid Atomese s-expressions,
+	/// and nothing else, up to its close-paren.
+	///
+	/// Any number of commands may be sent in one string; they are
+	/// performed in order, and their replies are returned one after
+	/// the other, each on a line of its own. This saves a network
+	/// round-trip per command, when a client has many to send. If
+	/// one of the commands throws, those before it have already been
+	/// performed.
+	///
+	/// The `-page` commands, and `cog-next-page`, hand out long lists
+	/// of Atoms a page at a time, through a server-side cursor (see
+	/// ScanCursor.h). The reply starts with the token for the next
+	/// page, which is zero on the last one.
 	///
 	static std::string interpret_command(AtomSpace*, const std::string&);
+
+	/// As above, but the replies are appended to `out`.
+	static void interpret_command(AtomSpace*, const std::string&,
+	                              std::string& out);
 };
 
 /** @}*/
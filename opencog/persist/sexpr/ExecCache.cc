@@ -0,0 +1,217 @@
+/*
+ * FUNCTION:
+ * Staleness tracking for the results of cog-execute-cache!
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "ExecCache.h"
+
+using namespace opencog;
+
+/* ======================================================== */
+// One tracker per AtomSpace. The AtomSpace signals hold the only
+// strong references, so that the tracker goes away with the
+// AtomSpace, and cannot be handed to a new one made at the same
+// address.
+
+static std::mutex _registry_mtx;
+static std::map<const AtomSpace*, std::weak_ptr<ExecCache>> _registry;
+
+ExecCache::ExecCache(void)
+	: _ntypes(nameserver().getNumberOfClasses()),
+	  _gen(new std::atomic<uint64_t>[_ntypes + 1]),
+	  _all(0)
+{
+	for (Type t = 0; t <= _ntypes; t++) _gen[t] = 0;
+}
+
+std::shared_ptr<ExecCache> ExecCache::for_space(AtomSpace* as)
+{
+	std::lock_guard<std::mutex> lck(_registry_mtx);
+	std::shared_ptr<ExecCache> ec(_registry[as].lock());
+	if (ec) return ec;
+
+	for (auto it = _registry.begin(); it != _registry.end(); )
+	{
+		if (it->second.expired()) it = _registry.erase(it);
+		else it++;
+	}
+
+	ec.reset(new ExecCache());
+	as->atomAddedSignal().connect(
+		[ec](const Handle& h) { ec->bump(h); });
+	as->atomRemovedSignal().connect(
+		[ec](const Handle& h) { ec->bump(h); ec->forget(h); });
+	as->atomsAddedSignal().connect(
+		[ec](const HandleSeq& hs) { for (const Handle& h : hs) ec->bump(h); });
+	as->atomsRemovedSignal().connect(
+		[ec](const HandleSeq& hs)
+		{
+			for (const Handle& h : hs) { ec->bump(h); ec->forget(h); }
+		});
+	_registry[as] = ec;
+	return ec;
+}
+
+/* ======================================================== */
+
+void ExecCache::bump(const Handle& h)
+{
+	Type t = h->get_type();
+	_gen[std::min(t, _ntypes)].fetch_add(1, std::memory_order_relaxed);
+	_all.fetch_add(1, std::memory_order_relaxed);
+}
+
+// A query that leaves the AtomSpace takes its results with it.
+void ExecCache::forget(const Handle& h)
+{
+	if (not h->is_link()) return;
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	auto it = _watches.lower_bound({h, Handle::UNDEFINED});
+	while (it != _watches.end() and it->first.first == h)
+		it = _watches.erase(it);
+}
+
+uint64_t ExecCache::stamp(const Watch& w) const
+{
+	if (w.any) return _all.load(std::memory_order_acquire);
+
+	// The counters only ever go up, so the sum moves if any of
+	// them does.
+	uint64_t sum = 0;
+	for (Type t : w.types)
+		sum += _gen[std::min(t, _ntypes)].load(std::memory_order_acquire);
+	return sum;
+}
+
+/* ======================================================== */
+
+// The logical connectives at the top of the body are not grounded;
+// the clauses below them are. New queries bring new connectives, and
+// these should not make the results of other queries stale. Neither
+// should the variable declarations; what the variables are restricted
+// to matters only for a variable that is a clause by itself, and
+// that is tracked anyway.
+static bool is_connective(Type t)
+{
+	return nameserver().isA(t, PRESENT_LINK) or CHOICE_LINK == t or
+		AND_LINK == t or OR_LINK == t or NOT_LINK == t;
+}
+
+void ExecCache::collect(const Handle& h, Part part, Watch& w)
+{
+	NameServer& ns(nameserver());
+	Type t = h->get_type();
+
+	if (ns.isA(t, GROUNDED_PROCEDURE_NODE) or
+	    DEFINED_PREDICATE_NODE == t or DEFINED_SCHEMA_NODE == t or
+	    ns.isA(t, VALUE_OF_LINK) or TIME_LINK == t or
+	    RANDOM_NUMBER_LINK == t or RANDOM_CHOICE_LINK == t)
+		w.always = true;
+
+	if (TOP == part)
+	{
+		// A variable standing for a whole clause can be grounded by
+		// anything at all.
+		if (VARIABLE_NODE == t or GLOB_NODE == t)
+			w.any = true;
+		else if (not is_connective(t))
+		{
+			w.types.push_back(t);
+			part = CLAUSE;
+		}
+	}
+
+	// Within a clause, only new links can make for new groundings;
+	// the nodes they hold must already be there.
+	else if (CLAUSE == part and h->is_link())
+		w.types.push_back(t);
+
+	if (not h->is_link()) return;
+	for (const Handle& ho : h->getOutgoingSet())
+		collect(ho, part, w);
+}
+
+ExecCache::Watch ExecCache::watch(AtomSpace* as, const Handle& query) const
+{
+	Watch w;
+	if (0 < as->get_arity()) w.always = true;
+	if (nameserver().isA(query->get_type(), JOIN_LINK)) w.any = true;
+
+	// Nor is the query itself a part of its results.
+	const HandleSeq& oset(query->getOutgoingSet());
+	for (size_t i = 0; i < oset.size(); i++)
+	{
+		Type ot = oset[i]->get_type();
+		bool decl = 0 == i and 1 < oset.size() and
+			(VARIABLE_LIST == ot or VARIABLE_SET == ot or
+			 TYPED_VARIABLE_LINK == ot or VARIABLE_NODE == ot or
+			 GLOB_NODE == ot);
+		collect(oset[i], decl ? DECL : TOP, w);
+	}
+	std::sort(w.types.begin(), w.types.end());
+	w.types.erase(std::unique(w.types.begin(), w.types.end()),
+	              w.types.end());
+
+	w.stamp = stamp(w);
+	return w;
+}
+
+void ExecCache::record(const Handle& query, const Handle& key,
+                       Watch&& w, const ValuePtr& rslt)
+{
+	w.result = rslt;
+	std::lock_guard<std::mutex> lck(_mtx);
+	_watches[{query, key}] = std::move(w);
+}
+
+bool ExecCache::is_fresh(const Handle& query, const Handle& key,
+                         const ValuePtr& rslt)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	auto it = _watches.find({query, key});
+	if (_watches.end() == it) return true;
+
+	// Someone else put it there; it is theirs to vouch for.
+	if (it->second.result != rslt)
+	{
+		_watches.erase(it);
+		return true;
+	}
+
+	const Watch& w(it->second);
+	return not w.always and w.stamp == stamp(w);
+}
+
+size_t ExecCache::size(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _watches.size();
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,134 @@
+/*
+ * FUNCTION:
+ * Staleness tracking for the results of cog-execute-cache!
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_EXEC_CACHE_H
+#define _OPENCOG_EXEC_CACHE_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <opencog/atoms/atom_types/types.h>
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+class AtomSpace;
+
+/**
+ * Keeps track of whether the results that `cog-execute-cache!` placed
+ * on its queries still hold.
+ *
+ * When a query is run, the types of the links its clauses are made of
+ * are noted. Its results can only change if a link of one of those
+ * types is added or removed: every grounding of a clause is a link of
+ * the clause's own type, and so on down. Each type has a counter, bumped by the
+ * AtomSpace add and remove signals; the sum of the counters for the
+ * query's types is kept with the result, and if, later, the sum has
+ * moved, the result is stale.
+ *
+ * Some queries depend on Atoms of every type: JoinLinks, and queries
+ * with a bare variable as a clause. For these, the count of all
+ * changes is used. Others cannot be tracked at all, as they depend on Values, or on code: those holding
+ * grounded or defined procedures, any kind of ValueOfLink, or clocks
+ * and random numbers. Their results are always stale. So are results
+ * computed in an AtomSpace that has parents, as changes made to the
+ * parents are not seen.
+ *
+ * Results that were not placed by cog-execute-cache! itself (because
+ * they were fetched from storage, or set by hand) are not known, and
+ * are trusted, as before.
+ *
+ * There is one of these per AtomSpace, made on first use; it lives as
+ * long as the AtomSpace does. From then on, each Atom added to, or
+ * removed from, that AtomSpace costs two relaxed atomic increments.
+ */
+class ExecCache
+{
+public:
+	/// What a query depends on, and the state of that when it was run.
+	struct Watch
+	{
+		std::vector<Type> types;
+		bool any = false;       // Depends on Atoms of every type
+		bool always = false;    // Cannot be tracked; always stale
+		uint64_t stamp = 0;
+		ValuePtr result;
+	};
+
+private:
+	Type _ntypes;
+
+	// One counter per type known at creation; the last one is shared
+	// by all of the types declared since.
+	std::unique_ptr<std::atomic<uint64_t>[]> _gen;
+	std::atomic<uint64_t> _all;
+
+	std::mutex _mtx;
+	std::map<std::pair<Handle, Handle>, Watch> _watches;
+
+	ExecCache(void);
+
+	void bump(const Handle&);
+	void forget(const Handle&);
+	uint64_t stamp(const Watch&) const;
+	enum Part { DECL, TOP, CLAUSE };
+	static void collect(const Handle&, Part, Watch&);
+
+public:
+	ExecCache(const ExecCache&) = delete;
+	ExecCache& operator=(const ExecCache&) = delete;
+
+	/// The tracker for this AtomSpace; it is made, if there is none.
+	static std::shared_ptr<ExecCache> for_space(AtomSpace*);
+
+	/// True, unless `rslt`, found on `query` at `key`, is known to be
+	/// stale.
+	bool is_fresh(const Handle& query, const Handle& key,
+	              const ValuePtr& rslt);
+
+	/// Note what the query depends on. Call this just before running
+	/// it, so that changes made while it runs make the result stale.
+	Watch watch(AtomSpace*, const Handle& query) const;
+
+	/// Remember the result, placed on `query` at `key`, and how it was
+	/// come by.
+	void record(const Handle& query, const Handle& key,
+	            Watch&&, const ValuePtr& rslt);
+
+	/// The number of results tracked.
+	size_t size(void);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_EXEC_CACHE_H
@@ -0,0 +1,343 @@
+/*
+ * FileIndex.cc
+ * Index of the records in a FileStorageNode journal.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+
+#include "fast_load.h"
+#include "FileIndex.h"
+
+using namespace opencog;
+
+// ==================================================================
+
+void FileIndex::clear(void)
+{
+	_records.clear();
+	_mentions.clear();
+	_removals.clear();
+	_types.clear();
+	_covered = 0;
+}
+
+// Each Atom, Atoms under it included, is noted once per record.
+static inline void note(std::vector<uint32_t>& seq, uint32_t rec)
+{
+	if (seq.empty() or seq.back() != rec) seq.push_back(rec);
+}
+
+void FileIndex::mention(const Handle& h, uint32_t rec)
+{
+	note(_mentions[h->get_hash()], rec);
+	note(_types[h->get_type()], rec);
+	if (h->is_link())
+		for (const Handle& ho : h->getOutgoingSet())
+			mention(ho, rec);
+}
+
+void FileIndex::add(uint64_t off, size_t len, const Handle& h, bool removal)
+{
+	if (UINT32_MAX <= _records.size() or UINT32_MAX < len)
+		throw IOException(TRACE_INFO,
+			"FileIndex: too many records, or too large!");
+
+	uint32_t rec = _records.size();
+	_records.push_back({off, (uint32_t) len});
+	if (removal)
+		note(_removals[h->get_hash()], rec);
+	else
+		mention(h, rec);
+}
+
+void FileIndex::scan(std::string_view buf, uint64_t base)
+{
+	scan_buffer(buf, [&](std::string_view expr, size_t off, size_t len,
+	                     size_t line)
+	{
+		bool removal;
+		Handle h(decode_expr(expr, line, removal));
+		add(base + off, len, h, removal);
+		return true;
+	});
+	_covered = base + buf.size();
+}
+
+// ==================================================================
+
+std::vector<FileIndex::Record> FileIndex::records(const RecordSeq* seq) const
+{
+	std::vector<Record> recs;
+	if (nullptr == seq) return recs;
+	recs.reserve(seq->size());
+	for (uint32_t rec : *seq)
+		recs.push_back(_records[rec]);
+	return recs;
+}
+
+std::vector<FileIndex::Record> FileIndex::mentions(const Handle& h) const
+{
+	auto it = _mentions.find(h->get_hash());
+	return records(it == _mentions.end() ? nullptr : &it->second);
+}
+
+std::vector<FileIndex::Record> FileIndex::removals(const Handle& h) const
+{
+	auto it = _removals.find(h->get_hash());
+	return records(it == _removals.end() ? nullptr : &it->second);
+}
+
+std::vector<FileIndex::Record> FileIndex::of_type(Type t) const
+{
+	auto it = _types.find(t);
+	return records(it == _types.end() ? nullptr : &it->second);
+}
+
+// ==================================================================
+// The saved index. All numbers are in host byte order; the index is
+// not meant to be carried from one machine to another. Everything
+// that the hashes depend on is checked: the numbering of the types,
+// and the hashes of a Node and a Link.
+
+static const char MAGIC[8] = {'A', 'T', 'O', 'M', 'I', 'D', 'X', '\0'};
+
+#define INDEX_VERSION 1
+
+// The end of the file, just before the part covered, is checksummed.
+#define TAIL_CHECK 256
+
+static uint64_t tail_check(int fd, uint64_t covered)
+{
+	char buf[TAIL_CHECK];
+	uint64_t off = (covered < TAIL_CHECK) ? 0 : covered - TAIL_CHECK;
+	ssize_t n = pread(fd, buf, covered - off, off);
+	if (n != (ssize_t) (covered - off)) return 0;
+
+	// FNV-1a
+	uint64_t sum = 0xcbf29ce484222325ULL;
+	for (ssize_t i = 0; i < n; i++)
+		sum = (sum ^ (unsigned char) buf[i]) * 0x100000001b3ULL;
+	return sum;
+}
+
+static void probes(uint64_t& node, uint64_t& link)
+{
+	Handle n(createNode(CONCEPT_NODE, "FileIndex probe"));
+	node = n->get_hash();
+	link = createLink(HandleSeq({n}), LIST_LINK)->get_hash();
+}
+
+template<typename T>
+static inline void put(std::string& out, T v)
+{
+	out.append((const char*) &v, sizeof(T));
+}
+
+template<typename Map>
+static void put_map(std::string& out, const Map& map)
+{
+	put<uint64_t>(out, map.size());
+	for (const auto& pr : map)
+	{
+		put<uint64_t>(out, pr.first);
+		put<uint64_t>(out, pr.second.size());
+		out.append((const char*) pr.second.data(),
+		           pr.second.size() * sizeof(uint32_t));
+	}
+}
+
+void FileIndex::save(const std::string& fname, int fd) const
+{
+	std::string out;
+	out.append(MAGIC, sizeof(MAGIC));
+	put<uint32_t>(out, INDEX_VERSION);
+	put<uint64_t>(out, _covered);
+	put<uint64_t>(out, tail_check(fd, _covered));
+
+	uint64_t pn, pl;
+	probes(pn, pl);
+	put<uint64_t>(out, pn);
+	put<uint64_t>(out, pl);
+
+	Type ntypes = nameserver().getNumberOfClasses();
+	put<uint32_t>(out, ntypes);
+	for (Type t = 0; t < ntypes; t++)
+	{
+		const std::string& name = nameserver().getTypeName(t);
+		put<uint32_t>(out, name.size());
+		out.append(name);
+	}
+
+	put<uint64_t>(out, _records.size());
+	for (const Record& r : _records)
+	{
+		put<uint64_t>(out, r.off);
+		put<uint32_t>(out, r.len);
+	}
+	put_map(out, _mentions);
+	put_map(out, _removals);
+	put_map(out, _types);
+
+	// Written aside, and then moved into place, so that a crash never
+	// leaves half an index.
+	std::string tmpname = fname + ".tmp";
+	FILE* fh = fopen(tmpname.c_str(), "w");
+	if (nullptr == fh)
+		throw IOException(TRACE_INFO,
+			"FileIndex cannot create %s: %s",
+			tmpname.c_str(), strerror(errno));
+
+	bool ok = (1 == fwrite(out.data(), out.size(), 1, fh));
+	ok = (0 == fclose(fh)) and ok;
+	if (not ok or rename(tmpname.c_str(), fname.c_str()))
+	{
+		unlink(tmpname.c_str());
+		throw IOException(TRACE_INFO,
+			"FileIndex cannot write %s: %s",
+			fname.c_str(), strerror(errno));
+	}
+}
+
+namespace {
+struct In
+{
+	const char* p;
+	const char* end;
+
+	template<typename T> bool get(T& v)
+	{
+		if ((size_t) (end - p) < sizeof(T)) return false;
+		memcpy(&v, p, sizeof(T));
+		p += sizeof(T);
+		return true;
+	}
+
+	bool get(std::string& s, size_t len)
+	{
+		if ((size_t) (end - p) < len) return false;
+		s.assign(p, len);
+		p += len;
+		return true;
+	}
+
+	template<typename Map>
+	bool get_map(Map& map, size_t nrecords)
+	{
+		uint64_t nkeys;
+		if (not get(nkeys)) return false;
+		map.reserve(nkeys);
+		for (uint64_t i = 0; i < nkeys; i++)
+		{
+			uint64_t key, n;
+			if (not get(key) or not get(n)) return false;
+			if ((size_t) (end - p) / sizeof(uint32_t) < n) return false;
+
+			std::vector<uint32_t>& seq = map[key];
+			seq.resize(n);
+			memcpy(seq.data(), p, n * sizeof(uint32_t));
+			p += n * sizeof(uint32_t);
+			for (uint32_t rec : seq)
+				if (nrecords <= rec) return false;
+		}
+		return true;
+	}
+};
+}
+
+bool FileIndex::load(const std::string& fname, int fd)
+{
+	clear();
+
+	FILE* fh = fopen(fname.c_str(), "r");
+	if (nullptr == fh) return false;
+
+	std::string buf;
+	char blk[1<<16];
+	size_t n;
+	while (0 < (n = fread(blk, 1, sizeof(blk), fh)))
+		buf.append(blk, n);
+	fclose(fh);
+
+	In in{buf.data(), buf.data() + buf.size()};
+	std::string magic;
+	uint32_t version;
+	uint64_t covered, check, pn, pl;
+	if (not in.get(magic, sizeof(MAGIC)) or
+	    0 != memcmp(magic.data(), MAGIC, sizeof(MAGIC)) or
+	    not in.get(version) or INDEX_VERSION != version or
+	    not in.get(covered) or not in.get(check))
+		return false;
+
+	// Did the file change, other than at the end?
+	struct stat st;
+	if (fstat(fd, &st) or (uint64_t) st.st_size < covered or
+	    tail_check(fd, covered) != check)
+		return false;
+
+	uint64_t mpn, mpl;
+	probes(mpn, mpl);
+	if (not in.get(pn) or not in.get(pl) or pn != mpn or pl != mpl)
+		return false;
+
+	uint32_t ntypes;
+	if (not in.get(ntypes) or
+	    ntypes != (uint32_t) nameserver().getNumberOfClasses())
+		return false;
+	for (Type t = 0; t < ntypes; t++)
+	{
+		uint32_t len;
+		std::string name;
+		if (not in.get(len) or not in.get(name, len) or
+		    name != nameserver().getTypeName(t))
+			return false;
+	}
+
+	uint64_t nrecords;
+	if (not in.get(nrecords) or
+	    (size_t) (in.end - in.p) / 12 < nrecords)
+		return false;
+	_records.resize(nrecords);
+	for (Record& r : _records)
+		if (not in.get(r.off) or not in.get(r.len) or covered < r.off + r.len)
+		{
+			clear();
+			return false;
+		}
+
+	if (not in.get_map(_mentions, nrecords) or
+	    not in.get_map(_removals, nrecords) or
+	    not in.get_map(_types, nrecords) or in.p != in.end)
+	{
+		clear();
+		return false;
+	}
+
+	_covered = covered;
+	return true;
+}
@@ -0,0 +1,111 @@
+/*
+ * FUNCTION:
+ * Index of the records in a FileStorageNode journal.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_FILE_INDEX_H
+#define _OPENCOG_FILE_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * Where, in a file of s-expressions, each Atom appears. A record is
+ * one top-level expression: an Atom, with its Values, or the removal
+ * of one. The index gives, for each Atom, every record in which it
+ * appears, either at the top, or somewhere inside; for each type,
+ * every record in which an Atom of that type appears; and, for each
+ * Atom, the records that remove it. Atoms are looked up by their
+ * hash; records for other Atoms, with the same hash, are weeded out
+ * after they are read.
+ *
+ * The index is kept in RAM; only offsets are kept, not the Atoms. It
+ * can be saved next to the file, so that it does not have to be built
+ * again. A saved index remembers how much of the file it covers; if
+ * the file was changed in some other way than by appending to it, or
+ * if the Atom types were numbered differently, the saved index is not
+ * used.
+ */
+class FileIndex
+{
+public:
+	struct Record
+	{
+		uint64_t off;
+		uint32_t len;
+	};
+
+private:
+	typedef std::vector<uint32_t> RecordSeq;
+
+	std::vector<Record> _records;
+	std::unordered_map<ContentHash, RecordSeq> _mentions;
+	std::unordered_map<ContentHash, RecordSeq> _removals;
+	std::unordered_map<Type, RecordSeq> _types;
+	uint64_t _covered;
+
+	void mention(const Handle&, uint32_t);
+	std::vector<Record> records(const RecordSeq*) const;
+
+public:
+	FileIndex(void) : _covered(0) {}
+
+	void clear(void);
+	size_t size(void) const { return _records.size(); }
+
+	/// Index the record at `off`, holding `h`, or its removal.
+	void add(uint64_t off, size_t len, const Handle& h, bool removal);
+
+	/// Index the records in `buf`, which is the file from `base` on.
+	void scan(std::string_view buf, uint64_t base);
+
+	/// The length of the file covered by the index.
+	uint64_t covered(void) const { return _covered; }
+	void set_covered(uint64_t c) { _covered = c; }
+
+	/// The records in file order.
+	std::vector<Record> mentions(const Handle&) const;
+	std::vector<Record> removals(const Handle&) const;
+	std::vector<Record> of_type(Type) const;
+
+	/// Save to `fname`, for the file open on `fd`.
+	void save(const std::string& fname, int fd) const;
+
+	/// Load from `fname`. Returns false, leaving the index empty,
+	/// if it is missing, or is not an index of the file open on `fd`.
+	bool load(const std::string& fname, int fd);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_FILE_INDEX_H
@@ -23,26 +23,71 @@
  */
 
 //#include <error.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
 
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/persist/storage/storage_types.h>
 
+#include "BlockCompress.h"
 #include "fast_load.h"
 #include "FileStorage.h"
+#include "Mapping.h"
 #include "Sexpr.h"
 
 using namespace opencog;
 
+// Write to the file in blocks of about this size.
+#define WRITE_BLOCK (1<<20)
+
+// Stores wait for the writer, when this many are pending.
+#define MAX_PENDING (1<<18)
+
+namespace {
+// Map the first `len` bytes of the file.
+void map_file(Mapping& map, const std::string& fname, size_t len)
+{
+	if (0 == len) return;
+	int fd = ::open(fname.c_str(), O_RDONLY);
+	if (0 <= fd)
+	{
+		map.addr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+	}
+	if (MAP_FAILED == map.addr)
+		throw IOException(TRACE_INFO,
+		"FileStorageNode cannot read %s: %s",
+			fname.c_str(), strerror(errno));
+	map.len = len;
+	madvise(map.addr, len, MADV_SEQUENTIAL);
+}
+}
+
 FileStorageNode::FileStorageNode(Type t, const std::string& uri)
 	: StorageNode(t, uri)
 {
 	_fh = nullptr;
+	_sync = false;
+	_writing = false;
+	_stop = false;
+	_num_stored = 0;
+	_num_coalesced = 0;
+	_num_written = 0;
+	_compact_every = 0;
+	_since_compact = 0;
+	_end = 0;
 
 	_filename = get_name();
 
@@ -53,25 +98,199 @@ FileStorageNode::FileStorageNode(Type t, const std::string& uri)
 
 FileStorageNode::~FileStorageNode()
 {
-	if (_fh) fclose(_fh);
-	_fh = nullptr;
+	// A write error not yet seen by anyone is lost; there is no one
+	// left to tell.
+	try { close(); } catch (...) {}
+}
+
+// ==================================================================
+// The writer thread.
+
+void FileStorageNode::write_loop(void)
+{
+	std::string buf;
+	buf.reserve(WRITE_BLOCK + 4096);
+	std::vector<Pending> batch;
+
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (true)
+	{
+		_work.wait(lck, [&] { return _stop or not _pending.empty(); });
+		if (_pending.empty()) break;
+
+		// Take everything pending; from here on, a Value stored again
+		// is written again.
+		batch.swap(_pending);
+		_pending_values.clear();
+		_writing = true;
+		_done.notify_all();
+		lck.unlock();
+
+		std::exception_ptr err;
+		try { write_out(batch, buf); }
+		catch (...) { err = std::current_exception(); }
+		size_t nwrote = batch.size();
+		batch.clear();
+		buf.clear();
+
+		lck.lock();
+		if (err and not _write_error) _write_error = err;
+		_num_written += nwrote;
+		_since_compact += nwrote;
+		_writing = false;
+		_done.notify_all();
+	}
+}
+
+void FileStorageNode::write_out(const std::vector<Pending>& batch,
+                                std::string& buf)
+{
+	// Only if compact() could not reopen the file.
+	if (nullptr == _fh)
+		throw IOException(TRACE_INFO,
+		"FileStorageNode %s is not open!", _filename.c_str());
+
+	// The file offset of the start of the buffer.
+	uint64_t base = _end;
+	std::vector<FileIndex::Record> recs;
+	recs.reserve(batch.size());
+
+	for (const Pending& pr : batch)
+	{
+		size_t before = buf.size();
+		switch (pr.op)
+		{
+			case STORE_ATOM:
+			case STORE_VALUE:
+				Sexpr::dump_atom(buf, pr.atom, pr.values);
+				break;
+			case REMOVE:
+				buf += "(cog-extract! ";
+				Sexpr::encode_atom(buf, pr.atom);
+				buf += ')';
+				break;
+			case REMOVE_RECURSIVE:
+				buf += "(cog-extract-recursive! ";
+				Sexpr::encode_atom(buf, pr.atom);
+				buf += ')';
+				break;
+		}
+		recs.push_back({base + before, (uint32_t) (buf.size() - before)});
+		buf += '\n';
+
+		if (WRITE_BLOCK <= buf.size())
+		{
+			if (1 != fwrite(buf.data(), buf.size(), 1, _fh))
+				throw IOException(TRACE_INFO,
+				"FileStorageNode failed to store Atom at %s: %s",
+					_filename.c_str(), strerror(errno));
+			base += buf.size();
+			buf.clear();
+		}
+	}
+
+	if (0 < buf.size() and 1 != fwrite(buf.data(), buf.size(), 1, _fh))
+		throw IOException(TRACE_INFO,
+		"FileStorageNode failed to store Atom at %s: %s",
+			_filename.c_str(), strerror(errno));
+	base += buf.size();
+	fflush(_fh);
+
+	// Only now can the records be read back.
+	std::lock_guard<std::mutex> lck(_idx_mtx);
+	for (size_t i = 0; i < batch.size(); i++)
+		_index.add(recs[i].off, recs[i].len, batch[i].atom,
+		           REMOVE <= batch[i].op);
+	_end = base;
+	_index.set_covered(base);
+}
+
+void FileStorageNode::enqueue(Op op, const Handle& h, const Handle& key,
+                              Sexpr::KeyValues&& values)
+{
+	if (not connected())
+		throw IOException(TRACE_INFO,
+		"FileStorageNode %s is not open!", _filename.c_str());
+
+	rethrow();
+
+	std::unique_lock<std::mutex> lck(_mtx);
+	if (STORE_VALUE == op)
+	{
+		// Still queued? Then the Value stored last is the one written.
+		auto it = _pending_values.find(h);
+		if (_pending_values.end() != it)
+		{
+			auto kit = it->second.find(key);
+			if (it->second.end() != kit)
+			{
+				_pending[kit->second].values = std::move(values);
+				_num_coalesced++;
+				return;
+			}
+		}
+	}
+
+	// Don't let a fast producer run arbitrarily far ahead.
+	_done.wait(lck, [&] { return _pending.size() < MAX_PENDING; });
+
+	// The wait dropped the lock; the writer may have taken the batch.
+	// Values stored after the Atom, or after a removal, must be
+	// written after it, and not folded into a store ahead of it.
+	if (STORE_VALUE == op)
+		_pending_values[h][key] = _pending.size();
+	else if (STORE_ATOM == op)
+		_pending_values.erase(h);
+	else
+		_pending_values.clear();
+	_pending.push_back({op, h, key, std::move(values)});
+	_num_stored++;
+	_work.notify_one();
+}
+
+/// Wait until everything stored so far has been written.
+void FileStorageNode::drain(void)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	_done.wait(lck, [&] { return _pending.empty() and not _writing; });
+}
+
+/// An error in the writer thread is thrown at whoever is next to
+/// use the node.
+void FileStorageNode::rethrow(void)
+{
+	std::exception_ptr err;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		std::swap(err, _write_error);
+	}
+	if (err) std::rethrow_exception(err);
 }
 
+// ==================================================================
+
 void FileStorageNode::erase(void)
 {
 	if (not connected())
 		throw IOException(TRACE_INFO,
 		"FileStorageNode %s is not open!", _filename.c_str());
 
+	std::unique_lock<std::mutex> lck(_mtx);
+	_done.wait(lck, [&] { return _pending.empty() and not _writing; });
 	int rc = ftruncate(fileno(_fh), 0);
 	if (rc)
 		throw IOException(TRACE_INFO,
 		"FileStorageNode cannot erase %s: %s",
 			_filename.c_str(), strerror(errno));
+
+	std::lock_guard<std::mutex> ilck(_idx_mtx);
+	_index.clear();
+	_end = 0;
 }
 
 void FileStorageNode::kill_data(void)
 {
+	unlink(index_name().c_str());
 	if (_fh) erase();
 	else
 	{
@@ -83,6 +302,61 @@ void FileStorageNode::kill_data(void)
 	}
 }
 
+std::string FileStorageNode::index_name(void) const
+{
+	return _filename + ".idx";
+}
+
+/// Load the saved index, and index whatever was appended since it was
+/// saved. Without a usable saved index, index the whole file. The
+/// caller holds the index lock.
+void FileStorageNode::open_index(void)
+{
+	int fd = fileno(_fh);
+	struct stat st;
+	if (fstat(fd, &st))
+		throw IOException(TRACE_INFO,
+		"FileStorageNode cannot open %s: %s",
+			_filename.c_str(), strerror(errno));
+	uint64_t size = st.st_size;
+
+	// A compressed dump cannot be journaled onto.
+	char magic[8];
+	if ((ssize_t) sizeof(magic) == pread(fd, magic, sizeof(magic), 0) and
+	    BlockReader::is_blocked(std::string_view(magic, sizeof(magic))))
+		throw IOException(TRACE_INFO,
+		"FileStorageNode cannot open %s: it is a compressed dump; "
+		"use load_file() to read it", _filename.c_str());
+
+	_index.load(index_name(), fd);
+	if (_index.covered() < size)
+	{
+		Mapping map;
+		map_file(map, _filename, size);
+		_index.scan(map.view().substr(_index.covered()), _index.covered());
+	}
+	_end = size;
+}
+
+/// Read the records, in file order, one per line.
+std::string FileStorageNode::read_records(
+	const std::vector<FileIndex::Record>& recs)
+{
+	std::string text;
+	int fd = fileno(_fh);
+	for (const FileIndex::Record& r : recs)
+	{
+		size_t at = text.size();
+		text.resize(at + r.len + 1);
+		if ((ssize_t) r.len != pread(fd, &text[at], r.len, r.off))
+			throw IOException(TRACE_INFO,
+			"FileStorageNode cannot read %s: %s",
+				_filename.c_str(), strerror(errno));
+		text[at + r.len] = '\n';
+	}
+	return text;
+}
+
 void FileStorageNode::open(void)
 {
 	if (_fh)
@@ -94,12 +368,45 @@ void FileStorageNode::open(void)
 		throw IOException(TRACE_INFO,
 		"FileStorageNode cannot open %s: %s",
 			_filename.c_str(), strerror(errno));
+
+	try
+	{
+		std::lock_guard<std::mutex> lck(_idx_mtx);
+		open_index();
+	}
+	catch (...)
+	{
+		fclose(_fh);
+		_fh = nullptr;
+		throw;
+	}
+
+	_stop = false;
+	_writer = std::thread(&FileStorageNode::write_loop, this);
 }
 
 void FileStorageNode::close(void)
 {
-	if (_fh) fclose(_fh);
+	if (nullptr == _fh) return;
+
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_stop = true;
+	}
+	_work.notify_all();
+	_writer.join();
+
+	// Failing to save the index is not fatal; it will be rebuilt.
+	{
+		std::lock_guard<std::mutex> lck(_idx_mtx);
+		try { _index.save(index_name(), fileno(_fh)); }
+		catch (const IOException&) {}
+		_index.clear();
+	}
+
+	fclose(_fh);
 	_fh = nullptr;
+	rethrow();
 }
 
 bool FileStorageNode::connected(void)
@@ -109,85 +416,230 @@ bool FileStorageNode::connected(void)
 
 void FileStorageNode::barrier(void)
 {
-	if (_fh) fflush(_fh);
+	if (nullptr == _fh) return;
+
+	drain();
+	rethrow();
+
+	if (_sync and fdatasync(fileno(_fh)))
+		throw IOException(TRACE_INFO,
+		"FileStorageNode cannot sync %s: %s",
+			_filename.c_str(), strerror(errno));
+
+	bool due;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		due = 0 < _compact_every and _compact_every <= _since_compact;
+	}
+	if (due) compact();
+}
+
+std::string FileStorageNode::monitor(void)
+{
+	size_t pending;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		pending = _pending.size();
+	}
+
+	std::stringstream rs;
+	rs << "FileStorageNode " << _filename << "\n"
+	   << "Stores: " << _num_stored
+	   << "  Coalesced: " << _num_coalesced
+	   << "  Written: " << _num_written
+	   << "  Pending: " << pending
+	   << "  Sync on barrier: " << (_sync ? "yes" : "no") << "\n"
+	   << "Written since last compaction: " << _since_compact
+	   << "  Compact every: " << _compact_every << "\n";
+	return rs.str();
 }
 
-Handle FileStorageNode::getNode(Type, const char *)
+
+// ==================================================================
+// Fetching.
+//
+// The records that an Atom appears in are read back, and replayed
+// into a scratch AtomSpace, together with the removals of any Atom
+// appearing in them. What is then in the scratch space is what a load
+// of the whole file would have given.
+
+AtomSpacePtr FileStorageNode::replay(const Handle& h, Type t)
 {
-	throw IOException(TRACE_INFO,
-		"FileStorageNode does not support this operation!");
-	return Handle::UNDEFINED;
+	if (not connected())
+		throw IOException(TRACE_INFO,
+		"FileStorageNode %s is not open!", _filename.c_str());
+
+	// Anything stored so far has to be found.
+	drain();
+	rethrow();
+
+	std::vector<FileIndex::Record> found;
+	std::string text;
+	{
+		std::lock_guard<std::mutex> lck(_idx_mtx);
+		found = h ? _index.mentions(h) : _index.of_type(t);
+		text = read_records(found);
+	}
+
+	HandleSet inside;
+	std::function<void(const Handle&)> collect = [&](const Handle& ha)
+	{
+		if (not inside.insert(ha).second or not ha->is_link()) return;
+		for (const Handle& ho : ha->getOutgoingSet()) collect(ho);
+	};
+	scan_buffer(text, [&](std::string_view expr, size_t, size_t,
+	                      size_t line)
+	{
+		bool removal;
+		collect(decode_expr(expr, line, removal));
+		return true;
+	});
+
+	{
+		std::lock_guard<std::mutex> lck(_idx_mtx);
+		std::map<uint64_t, FileIndex::Record> recs;
+		for (const Handle& ha : inside)
+			for (const FileIndex::Record& r : _index.removals(ha))
+				recs.emplace(r.off, r);
+
+		if (not recs.empty())
+		{
+			for (const FileIndex::Record& r : found)
+				recs.emplace(r.off, r);
+			found.clear();
+			for (const auto& pr : recs)
+				found.push_back(pr.second);
+			text = read_records(found);
+		}
+	}
+
+	AtomSpacePtr scratch(createAtomSpace());
+	parseBuffer(text, *scratch, 1);
+	return scratch;
 }
 
-Handle FileStorageNode::getLink(Type, const HandleSeq&)
+/// A copy of h, in no AtomSpace, with no Values, and neither with
+/// Values on the Atoms under it.
+static Handle bare(const Handle& h)
 {
-	throw IOException(TRACE_INFO,
-		"FileStorageNode does not support this operation!");
-	return Handle::UNDEFINED;
+	if (h->is_node())
+		return createNode(h->get_type(), std::string(h->get_name()));
+
+	HandleSeq oset;
+	for (const Handle& ho : h->getOutgoingSet())
+		oset.emplace_back(bare(ho));
+	return createLink(std::move(oset), h->get_type());
 }
 
-void FileStorageNode::fetchIncomingSet(AtomSpace*, const Handle&)
+/// Put the Values on src onto dest, and their keys into the AtomSpace
+/// of dest, if it is in one.
+static void copy_values(const Handle& dest, const Handle& src)
 {
-	throw IOException(TRACE_INFO,
-		"FileStorageNode does not support this operation!");
+	AtomSpace* as = dest->getAtomSpace();
+	for (const Handle& k : src->getKeys())
+	{
+		if (nullptr == as)
+		{
+			dest->setValue(k, src->getValue(k));
+			continue;
+		}
+
+		// Read-only AtomSpaces won't allow insertion.
+		Handle ak = as->add_atom(bare(k));
+		if (nullptr == ak) continue;
+		as->set_value(dest, ak, Sexpr::add_atoms(as, src->getValue(k)));
+	}
 }
 
-void FileStorageNode::fetchIncomingByType(AtomSpace*, const Handle&, Type t)
+static void install_atom(AtomSpace* as, const Handle& src)
 {
-	throw IOException(TRACE_INFO,
-		"FileStorageNode does not support this operation!");
+	Handle h(as->add_atom(bare(src)));
+	if (h) copy_values(h, src);
 }
 
-void FileStorageNode::storeAtom(const Handle& h, bool synchronous)
+void FileStorageNode::getAtom(const Handle& h)
 {
-	if (not connected())
-		throw IOException(TRACE_INFO,
-		"FileStorageNode %s is not open!", _filename.c_str());
+	AtomSpacePtr scratch(replay(h));
+	Handle sh(scratch->get_atom(h));
+	if (sh) copy_values(h, sh);
+}
 
-	const std::string sex = Sexpr::dump_atom(h);
-	fwrite(sex.c_str(), sex.length(), 1, _fh);
-	size_t rc = fwrite("\n", 1, 1, _fh);
+Handle FileStorageNode::getNode(Type t, const char * name)
+{
+	Handle h(createNode(t, name));
+	return replay(h)->get_atom(h);
+}
 
-	if (1 != rc)
-		throw IOException(TRACE_INFO,
-		"FileStorageNode failed to store Atom at %s: %s",
-			_filename.c_str(), strerror(errno));
+Handle FileStorageNode::getLink(Type t, const HandleSeq& hs)
+{
+	Handle h(createLink(HandleSeq(hs), t));
+	return replay(h)->get_atom(h);
 }
 
-void FileStorageNode::removeAtom(const Handle&, bool recursive)
+void FileStorageNode::fetchIncomingSet(AtomSpace* as, const Handle& h)
 {
-	throw IOException(TRACE_INFO,
-		"FileStorageNode does not support this operation!");
+	AtomSpacePtr scratch(replay(h));
+	Handle sh(scratch->get_atom(h));
+	if (nullptr == sh) return;
+	for (const Handle& hi : sh->getIncomingSet())
+		install_atom(as, hi);
 }
 
-void FileStorageNode::storeValue(const Handle& h, const Handle& key)
+void FileStorageNode::fetchIncomingByType(AtomSpace* as, const Handle& h,
+                                          Type t)
 {
-	if (not connected())
-		throw IOException(TRACE_INFO,
-		"FileStorageNode %s is not open!", _filename.c_str());
+	AtomSpacePtr scratch(replay(h));
+	Handle sh(scratch->get_atom(h));
+	if (nullptr == sh) return;
+	for (const Handle& hi : sh->getIncomingSetByType(t))
+		install_atom(as, hi);
+}
 
-	const std::string sex = Sexpr::dump_vatom(h, key);
-	fwrite(sex.c_str(), sex.length(), 1, _fh);
-	size_t rc = fwrite("\n", 1, 1, _fh);
+void FileStorageNode::loadValue(const Handle& h, const Handle& key)
+{
+	AtomSpacePtr scratch(replay(h));
+	Handle sh(scratch->get_atom(h));
+	Handle sk(scratch->get_atom(key));
 
-	if (1 != rc)
-		throw IOException(TRACE_INFO,
-		"FileStorageNode failed to store Atom at %s: %s",
-			_filename.c_str(), strerror(errno));
+	// If it's not in the file, it's not anywhere.
+	ValuePtr vp;
+	if (sh and sk) vp = sh->getValue(sk);
+
+	AtomSpace* as = h->getAtomSpace();
+	if (nullptr == as)
+		h->setValue(key, vp);
+	else
+		as->set_value(h, key, vp ? Sexpr::add_atoms(as, vp) : vp);
+}
+
+void FileStorageNode::loadType(AtomSpace* as, Type t)
+{
+	AtomSpacePtr scratch(replay(Handle::UNDEFINED, t));
+	HandleSeq hs;
+	scratch->get_handles_by_type(hs, t);
+	for (const Handle& h : hs)
+		install_atom(as, h);
+}
+
+// ==================================================================
+
+void FileStorageNode::storeAtom(const Handle& h, bool synchronous)
+{
+	enqueue(STORE_ATOM, h, Handle::UNDEFINED, Sexpr::get_values(h));
+	if (synchronous) barrier();
 }
 
-void FileStorageNode::loadValue(const Handle&, const Handle&)
+void FileStorageNode::removeAtom(const Handle& h, bool recursive)
 {
-	throw IOException(TRACE_INFO,
-		"FileStorageNode does not support this operation!");
+	enqueue(recursive ? REMOVE_RECURSIVE : REMOVE, h);
 }
 
-void FileStorageNode::loadType(AtomSpace*, Type)
+void FileStorageNode::storeValue(const Handle& h, const Handle& key)
 {
-	throw IOException(TRACE_INFO,
-		"FileStorageNode does not support this operation!");
+	enqueue(STORE_VALUE, h, key, {{key, h->getValue(key)}});
 }
 
+
 void FileStorageNode::storeAtomSpace(const AtomSpace* table)
 {
 	if (not connected())
@@ -201,10 +653,10 @@ void FileStorageNode::storeAtomSpace(const AtomSpace* table)
 		// Store roots, and Atoms that have values.
 		// All other Atoms will appear in outgoing sets.
 		if (h->haveValues() or 0 == h->getIncomingSetSize())
-			storeAtom(h);
+			enqueue(STORE_ATOM, h, Handle::UNDEFINED, Sexpr::get_values(h));
 	}
 
-	fflush(_fh);
+	barrier();
 }
 
 void FileStorageNode::loadAtomSpace(AtomSpace* table)
@@ -218,9 +670,164 @@ void FileStorageNode::loadAtomSpace(AtomSpace* table)
 	if (not stream.is_open())
 		throw IOException(TRACE_INFO,
 			"FileStorageNode cannot open %s", _filename.c_str());
-
-	parseStream(stream, *table);
 	stream.close();
+
+	// Anything stored, but not yet written, is loaded too.
+	drain();
+	rethrow();
+
+	// Map it, and load it in parallel.
+	load_file(_filename, *table, 0);
+}
+
+// ==================================================================
+// Compaction.
+
+/// Write the roots, and the Atoms that have Values; all other Atoms
+/// appear in their outgoing sets.
+static void dump_atomspace(FILE* fh, const AtomSpace* as,
+                           const std::string& fname)
+{
+	HandleSeq hset;
+	as->get_handles_by_type(hset, ATOM, true);
+
+	std::string buf;
+	buf.reserve(WRITE_BLOCK + 4096);
+	for (size_t i = 0; i <= hset.size(); i++)
+	{
+		if (i < hset.size())
+		{
+			const Handle& h = hset[i];
+			if (not h->haveValues() and 0 < h->getIncomingSetSize())
+				continue;
+			Sexpr::dump_atom(buf, h);
+			buf += '\n';
+			if (buf.size() < WRITE_BLOCK) continue;
+		}
+		if (0 < buf.size() and 1 != fwrite(buf.data(), buf.size(), 1, fh))
+			throw IOException(TRACE_INFO,
+			"FileStorageNode failed to write %s: %s",
+				fname.c_str(), strerror(errno));
+		buf.clear();
+	}
+}
+
+/// Copy the bytes of `in` from `off` onwards to the end of `out`.
+static void copy_tail(int in, size_t off, FILE* out,
+                      const std::string& fname)
+{
+	std::string buf(WRITE_BLOCK, 0);
+	while (true)
+	{
+		ssize_t n = pread(in, &buf[0], buf.size(), off);
+		if (n < 0 or (0 < n and 1 != fwrite(buf.data(), n, 1, out)))
+			throw IOException(TRACE_INFO,
+			"FileStorageNode failed to compact %s: %s",
+				fname.c_str(), strerror(errno));
+		if (0 == n) break;
+		off += n;
+	}
+}
+
+// The journal is replayed into a scratch AtomSpace, which is written
+// out afresh. The node stays open while that happens; what it writes
+// in the meantime is copied over at the end, and then the new file
+// replaces the old.
+void FileStorageNode::compact(void)
+{
+	// The part of the journal that gets compacted: up to the end of
+	// the last record written.
+	size_t end;
+	if (connected())
+	{
+		std::unique_lock<std::mutex> lck(_mtx);
+		_done.wait(lck, [&] { return _pending.empty() and not _writing; });
+		struct stat st;
+		if (fstat(fileno(_fh), &st))
+			throw IOException(TRACE_INFO,
+			"FileStorageNode cannot compact %s: %s",
+				_filename.c_str(), strerror(errno));
+		end = st.st_size;
+		_since_compact = 0;
+	}
+	else
+	{
+		struct stat st;
+		if (stat(_filename.c_str(), &st))
+		{
+			if (ENOENT == errno) return;
+			throw IOException(TRACE_INFO,
+			"FileStorageNode cannot compact %s: %s",
+				_filename.c_str(), strerror(errno));
+		}
+		end = st.st_size;
+	}
+	rethrow();
+
+	AtomSpacePtr scratch(createAtomSpace());
+	{
+		Mapping map;
+		map_file(map, _filename, end);
+		parseBuffer(map.view(), *scratch, 0);
+	}
+
+	std::string tmpname = _filename + ".compact";
+	FILE* out = fopen(tmpname.c_str(), "w");
+	if (nullptr == out)
+		throw IOException(TRACE_INFO,
+		"FileStorageNode cannot create %s: %s",
+			tmpname.c_str(), strerror(errno));
+
+	try
+	{
+		dump_atomspace(out, scratch.get(), tmpname);
+		scratch = nullptr;
+
+		std::unique_lock<std::mutex> lck;
+		if (connected())
+		{
+			// Hold off the writer until the new file is in place.
+			lck = std::unique_lock<std::mutex>(_mtx);
+			_done.wait(lck, [&] { return not _writing; });
+			copy_tail(fileno(_fh), end, out, tmpname);
+		}
+
+		if (fflush(out) or (_sync and fdatasync(fileno(out))))
+			throw IOException(TRACE_INFO,
+			"FileStorageNode failed to write %s: %s",
+				tmpname.c_str(), strerror(errno));
+		fclose(out);
+		out = nullptr;
+
+		if (rename(tmpname.c_str(), _filename.c_str()))
+			throw IOException(TRACE_INFO,
+			"FileStorageNode cannot replace %s: %s",
+				_filename.c_str(), strerror(errno));
+
+		// Offsets have all changed; the index is built afresh.
+		unlink(index_name().c_str());
+		if (lck.owns_lock())
+		{
+			std::lock_guard<std::mutex> ilck(_idx_mtx);
+			fclose(_fh);
+			_index.clear();
+			_fh = fopen(_filename.c_str(), "a+");
+			if (nullptr == _fh)
+				throw IOException(TRACE_INFO,
+				"FileStorageNode cannot reopen %s: %s",
+					_filename.c_str(), strerror(errno));
+			open_index();
+		}
+	}
+	catch (...)
+	{
+		if (out)
+		{
+			fclose(out);
+			unlink(tmpname.c_str());
+		}
+		throw;
+	}
 }
 
 DEFINE_NODE_FACTORY(FileStorageNode, FILE_STORAGE_NODE)
@@ -25,19 +25,102 @@
 #ifndef _OPENCOG_FILE_STORAGE_H
 #define _OPENCOG_FILE_STORAGE_H
 
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
 #include <opencog/persist/api/StorageNode.h>
 
+#include "FileIndex.h"
+#include "Sexpr.h"
+
 namespace opencog
 {
 /** \addtogroup grp_persist
  *  @{
  */
 
+/**
+ * Atoms and Values are appended to the file as s-expressions.
+ *
+ * Stores do not wait for the file: they are queued, and written out
+ * by a thread of its own, that formats them and writes them in large
+ * blocks. Thus, journaling Atoms as they change does not slow down
+ * the threads that change them. The Values written are the ones the
+ * Atom held when it was stored, not when the writer gets to it.
+ * Storing the same Value on the same Atom, over and over, before it
+ * is written, writes it only once: the last one stored. Use
+ * barrier() to wait for everything stored so far to be
+ * written; with sync_on_barrier(), it also waits for the data to
+ * reach the disk.
+ *
+ * The file is a journal: Values stored again are appended, and Atoms
+ * removed are recorded as removals. Loading it replays the journal,
+ * in order. To keep it from growing without bound, compact() rewrites
+ * it with only the latest Value for each (atom, key), and without the
+ * Atoms removed; with compact_every(), barrier() does so periodically,
+ * and a restart replays just the compacted file and whatever was
+ * journaled since. Compacting an open file does not hold up stores
+ * for longer than it takes to copy what was written while the
+ * compaction was going on.
+ */
 class FileStorageNode : public StorageNode
 {
 	private:
 		std::string _filename;
 		FILE* _fh;
+		bool _sync;
+
+		enum Op { STORE_ATOM, STORE_VALUE, REMOVE, REMOVE_RECURSIVE };
+		struct Pending
+		{
+			Op op;
+			Handle atom;
+			Handle key;
+			// The Values as they were when stored: just the one at
+			// `key` for STORE_VALUE, all of them for STORE_ATOM.
+			Sexpr::KeyValues values;
+		};
+		std::vector<Pending> _pending;
+		// Where in _pending each queued Value store is, by Atom, then
+		// by key. Only stores queued after the last STORE_ATOM, or
+		// removal, of the Atom are here.
+		std::map<Handle, std::map<Handle, size_t>> _pending_values;
+
+		std::mutex _mtx;
+		std::condition_variable _work;
+		std::condition_variable _done;
+		std::thread _writer;
+		bool _writing;
+		bool _stop;
+		std::exception_ptr _write_error;
+
+		size_t _num_stored;
+		size_t _num_coalesced;
+		size_t _num_written;
+
+		size_t _compact_every;
+		size_t _since_compact;
+
+		// Where the records are. Updated by the writer, after a batch
+		// is written; _end is where the next batch goes.
+		FileIndex _index;
+		std::mutex _idx_mtx;
+		uint64_t _end;
+
+		std::string index_name(void) const;
+		void open_index(void);
+		std::string read_records(const std::vector<FileIndex::Record>&);
+		AtomSpacePtr replay(const Handle&, Type = NOTYPE);
+
+		void enqueue(Op, const Handle&, const Handle& = Handle::UNDEFINED,
+		             Sexpr::KeyValues&& = Sexpr::KeyValues());
+		void write_loop(void);
+		void write_out(const std::vector<Pending>&, std::string&);
+		void drain(void);
+		void rethrow(void);
 
 	public:
 		FileStorageNode(Type t, const std::string& uri);
@@ -53,6 +136,7 @@ class FileStorageNode : public StorageNode
 		void erase(void);
 
 		// AtomStorage interface
+		void getAtom(const Handle&);
 		Handle getNode(Type, const char *);
 		Handle getLink(Type, const HandleSeq&);
 		void fetchIncomingSet(AtomSpace*, const Handle&);
@@ -64,6 +148,19 @@ class FileStorageNode : public StorageNode
 		void loadType(AtomSpace*, Type);
 		void barrier();
 
+		/// If set, barrier() also waits for fdatasync().
+		void sync_on_barrier(bool s) { _sync = s; }
+
+		/// Rewrite the file, keeping only what loading it would give.
+		/// The node may be open or closed.
+		void compact(void);
+
+		/// Compact at barrier(), once this many records have been
+		/// written since the last time. Zero, the default, means never.
+		void compact_every(size_t n) { _compact_every = n; }
+
+		std::string monitor(void);
+
 		// Large-scale loads and saves
 		void loadAtomSpace(AtomSpace*); // Load entire contents of DB
 		void storeAtomSpace(const AtomSpace*); // Store all of AtomSpace
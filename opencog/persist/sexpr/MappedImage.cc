@@ -0,0 +1,638 @@
+/*
+ * MappedImage.cc
+ * A memory-mapped, directly addressable image of an AtomSpace.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <unordered_map>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+
+#include "MappedImage.h"
+#include "Sexpr.h"
+
+using namespace opencog;
+
+// ==================================================================
+// The format; see MappedImage.h
+
+static const char MAGIC[8] = {'A', 'T', 'O', 'M', 'M', 'A', 'P', '\0'};
+
+#define IMAGE_VERSION 1
+
+struct MappedImage::Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t bom;
+	uint64_t ntypes, types_off;     // name offset and length, per type
+	uint64_t natoms, atoms_off;     // one Record per Atom
+	uint64_t strings_off, strings_len;
+	uint64_t words_off, nwords;
+	uint64_t buckets_off, nbuckets; // index + 1 of the Atom; 0 if empty
+	uint64_t typeidx_off;           // word of the Atom list, per type
+	uint64_t values_off, values_len;
+	uint64_t file_len;
+};
+
+// A Node has its name at `data` in the strings, `size` bytes long; a
+// Link has its outgoing set at word `data`, `size` Atoms long. The
+// incoming set is a count and Atoms at word `incoming`; word 0 is the
+// empty set. The Values are at byte `values - 1`; zero if none.
+struct MappedImage::Record
+{
+	uint32_t tid;
+	uint32_t size;
+	uint64_t data;
+	uint64_t incoming;
+	uint64_t values;
+};
+
+namespace {
+
+uint32_t byte_order(void)
+{
+	uint32_t one = 1;
+	return *reinterpret_cast<uint8_t*>(&one);
+}
+
+// FNV-1a; it must not change between runs, as std::hash may.
+uint64_t mix(uint64_t h, const void* p, size_t n)
+{
+	const uint8_t* b = static_cast<const uint8_t*>(p);
+	for (size_t i = 0; i < n; i++)
+	{
+		h ^= b[i];
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+const uint64_t FNV_BASIS = 0xcbf29ce484222325ULL;
+
+uint64_t node_hash(uint32_t tid, std::string_view name)
+{
+	return mix(mix(FNV_BASIS, &tid, sizeof(tid)), name.data(), name.size());
+}
+
+uint64_t link_hash(uint32_t tid, const uint64_t* oset, size_t n)
+{
+	return mix(mix(FNV_BASIS, &tid, sizeof(tid)), oset, n * sizeof(uint64_t));
+}
+
+size_t pad8(size_t n) { return (n + 7) & ~size_t(7); }
+
+void put(std::string& buf, uint64_t w)
+{
+	buf.append(reinterpret_cast<const char*>(&w), sizeof(w));
+}
+
+} // anonymous namespace
+
+// ==================================================================
+
+MappedImage::MappedImage(void)
+	: _addr(MAP_FAILED), _len(0), _hdr(nullptr), _atoms(nullptr),
+	  _strings(nullptr), _words(nullptr), _buckets(nullptr),
+	  _typeidx(nullptr), _values(nullptr)
+{
+}
+
+MappedImage::~MappedImage()
+{
+	close();
+}
+
+void MappedImage::open(const std::string& filename)
+{
+	close();
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw IOException(TRACE_INFO,
+			"Cannot open image %s: %s", filename.c_str(), strerror(errno));
+
+	struct stat st;
+	if (0 == fstat(fd, &st) and sizeof(Header) <= size_t(st.st_size))
+	{
+		_len = st.st_size;
+		_addr = mmap(nullptr, _len, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	::close(fd);
+	if (MAP_FAILED == _addr)
+		throw IOException(TRACE_INFO,
+			"Cannot map image %s", filename.c_str());
+
+	try { check(); }
+	catch (...) { close(); throw; }
+}
+
+void MappedImage::close(void)
+{
+	if (MAP_FAILED != _addr) munmap(_addr, _len);
+	_addr = MAP_FAILED;
+	_len = 0;
+	_hdr = nullptr;
+	_types.clear();
+	_tids.clear();
+}
+
+// Everything that is read later is bounds-checked against what is
+// checked here; nothing else is read when the image is opened.
+void MappedImage::check(void)
+{
+	const char* base = static_cast<const char*>(_addr);
+	const Header* hdr = reinterpret_cast<const Header*>(base);
+
+	if (memcmp(hdr->magic, MAGIC, sizeof(MAGIC)))
+		throw IOException(TRACE_INFO, "Not an AtomSpace image");
+	if (IMAGE_VERSION < hdr->version)
+		throw IOException(TRACE_INFO,
+			"Image version %u is newer than this reader", hdr->version);
+	if (byte_order() != hdr->bom)
+		throw IOException(TRACE_INFO,
+			"Image was written on a machine of other byte order");
+	if (hdr->file_len != _len)
+		throw IOException(TRACE_INFO, "Image is truncated");
+
+	auto section = [&](uint64_t off, uint64_t n, size_t width)
+	{
+		if (off % 8 or _len < off or (_len - off) / width < n)
+			throw IOException(TRACE_INFO, "Image is malformed");
+		return base + off;
+	};
+	const uint64_t* names = reinterpret_cast<const uint64_t*>(
+		section(hdr->types_off, hdr->ntypes, 2 * sizeof(uint64_t)));
+	_atoms = reinterpret_cast<const Record*>(
+		section(hdr->atoms_off, hdr->natoms, sizeof(Record)));
+	_strings = section(hdr->strings_off, hdr->strings_len, 1);
+	_words = reinterpret_cast<const uint64_t*>(
+		section(hdr->words_off, hdr->nwords, sizeof(uint64_t)));
+	_buckets = reinterpret_cast<const uint64_t*>(
+		section(hdr->buckets_off, hdr->nbuckets, sizeof(uint64_t)));
+	_typeidx = reinterpret_cast<const uint64_t*>(
+		section(hdr->typeidx_off, hdr->ntypes, sizeof(uint64_t)));
+	_values = section(hdr->values_off, hdr->values_len, 1);
+
+	if (0 == hdr->nwords or 0 == hdr->nbuckets or
+	    (hdr->nbuckets & (hdr->nbuckets - 1)))
+		throw IOException(TRACE_INFO, "Image is malformed");
+
+	NameServer& ns = nameserver();
+	_tids.assign(ns.getNumberOfClasses(), UINT32_MAX);
+	for (uint64_t i = 0; i < hdr->ntypes; i++)
+	{
+		uint64_t off = names[2*i];
+		uint64_t len = names[2*i + 1];
+		if (hdr->strings_len < off or hdr->strings_len - off < len)
+			throw IOException(TRACE_INFO, "Image is malformed");
+		std::string name(_strings + off, len);
+		Type t = ns.getType(name);
+		if (NOTYPE == t)
+			throw IOException(TRACE_INFO,
+				"Image holds unknown type %s", name.c_str());
+		_types.push_back(t);
+		_tids[t] = i;
+	}
+
+	_hdr = hdr;
+}
+
+size_t MappedImage::size(void) const
+{
+	return _hdr ? _hdr->natoms : 0;
+}
+
+MappedImage::Span MappedImage::words(uint64_t w) const
+{
+	if (_hdr->nwords <= w or _hdr->nwords - w - 1 < _words[w])
+		throw IOException(TRACE_INFO, "Image is malformed");
+	return Span{_words + w + 1, _words + w + 1 + _words[w]};
+}
+
+uint64_t MappedImage::probe(uint64_t hash,
+                            const std::function<bool(uint64_t)>& same) const
+{
+	uint64_t mask = _hdr->nbuckets - 1;
+	for (uint64_t b = hash & mask, n = 0; n < _hdr->nbuckets;
+	     b = (b + 1) & mask, n++)
+	{
+		uint64_t slot = _buckets[b];
+		if (0 == slot) return NONE;
+		if (_hdr->natoms < slot)
+			throw IOException(TRACE_INFO, "Image is malformed");
+		if (same(slot - 1)) return slot - 1;
+	}
+	return NONE;
+}
+
+uint64_t MappedImage::find_node(Type t, std::string_view name) const
+{
+	if (_tids.size() <= t or UINT32_MAX == _tids[t]) return NONE;
+	uint32_t tid = _tids[t];
+	return probe(node_hash(tid, name), [&](uint64_t i)
+	{
+		const Record& r = _atoms[i];
+		return r.tid == tid and r.size == name.size() and
+			r.size <= _hdr->strings_len and
+			r.data <= _hdr->strings_len - r.size and
+			0 == memcmp(_strings + r.data, name.data(), name.size());
+	});
+}
+
+uint64_t MappedImage::find_link(Type t, const std::vector<uint64_t>& oset) const
+{
+	if (_tids.size() <= t or UINT32_MAX == _tids[t]) return NONE;
+	uint32_t tid = _tids[t];
+	return probe(link_hash(tid, oset.data(), oset.size()), [&](uint64_t i)
+	{
+		const Record& r = _atoms[i];
+		if (r.tid != tid or r.size != oset.size()) return false;
+		Span out(words(r.data));
+		return out.size() == oset.size() and
+			0 == memcmp(out.begin(), oset.data(),
+			            oset.size() * sizeof(uint64_t));
+	});
+}
+
+uint64_t MappedImage::find(const Handle& h) const
+{
+	if (h->is_node())
+		return find_node(h->get_type(), h->get_name());
+
+	std::vector<uint64_t> oset;
+	oset.reserve(h->get_arity());
+	for (const Handle& ho : h->getOutgoingSet())
+	{
+		uint64_t i = find(ho);
+		if (NONE == i) return NONE;
+		oset.push_back(i);
+	}
+	return find_link(h->get_type(), oset);
+}
+
+Handle MappedImage::atom(uint64_t idx) const
+{
+	// Shared Atoms below are built once.
+	std::unordered_map<uint64_t, Handle> built;
+	std::function<Handle(uint64_t)> build = [&](uint64_t i) -> Handle
+	{
+		auto it = built.find(i);
+		if (built.end() != it) return it->second;
+
+		if (_hdr->natoms <= i)
+			throw IOException(TRACE_INFO, "Image has a bad index");
+		const Record& r = _atoms[i];
+		if (_types.size() <= r.tid)
+			throw IOException(TRACE_INFO, "Image has a bad type");
+		Type t = _types[r.tid];
+
+		Handle h;
+		if (nameserver().isNode(t))
+		{
+			if (_hdr->strings_len < r.data or
+			    _hdr->strings_len - r.data < r.size)
+				throw IOException(TRACE_INFO, "Image is malformed");
+			h = createNode(t, std::string(_strings + r.data, r.size));
+		}
+		else
+		{
+			HandleSeq oset;
+			oset.reserve(r.size);
+			for (uint64_t o : words(r.data))
+			{
+				// Every Atom comes after its outgoing set; this
+				// also keeps a damaged image from looping.
+				if (i <= o)
+					throw IOException(TRACE_INFO, "Image is malformed");
+				oset.emplace_back(build(o));
+			}
+			h = createLink(std::move(oset), t);
+		}
+		built.emplace(i, h);
+		return h;
+	};
+	return build(idx);
+}
+
+void MappedImage::each(
+     const std::function<Handle(uint64_t, const Handle&)>& cb) const
+{
+	NameServer& ns = nameserver();
+	HandleSeq table;
+	table.reserve(_hdr->natoms);
+	for (uint64_t i = 0; i < _hdr->natoms; i++)
+	{
+		const Record& r = _atoms[i];
+		if (_types.size() <= r.tid)
+			throw IOException(TRACE_INFO, "Image has a bad type");
+		Type t = _types[r.tid];
+
+		if (ns.isNode(t))
+		{
+			if (_hdr->strings_len < r.data or
+			    _hdr->strings_len - r.data < r.size)
+				throw IOException(TRACE_INFO, "Image is malformed");
+			table.emplace_back(
+				createNode(t, std::string(_strings + r.data, r.size)));
+		}
+		else
+		{
+			HandleSeq oset;
+			oset.reserve(r.size);
+			for (uint64_t o : words(r.data))
+			{
+				if (i <= o)
+					throw IOException(TRACE_INFO, "Image is malformed");
+				oset.emplace_back(table[o]);
+			}
+			table.emplace_back(createLink(std::move(oset), t));
+		}
+		Handle kept(cb(i, table.back()));
+		if (kept) table.back() = kept;
+	}
+}
+
+MappedImage::Span MappedImage::incoming(uint64_t idx) const
+{
+	if (_hdr->natoms <= idx)
+		throw IOException(TRACE_INFO, "Image has a bad index");
+	return words(_atoms[idx].incoming);
+}
+
+MappedImage::Span MappedImage::of_type(Type t) const
+{
+	if (_tids.size() <= t or UINT32_MAX == _tids[t]) return Span();
+	return words(_typeidx[_tids[t]]);
+}
+
+void MappedImage::values(uint64_t idx,
+     const std::function<void(uint64_t, const std::string&)>& cb) const
+{
+	if (_hdr->natoms <= idx)
+		throw IOException(TRACE_INFO, "Image has a bad index");
+	uint64_t off = _atoms[idx].values;
+	if (0 == off) return;
+	off--;
+
+	auto word = [&](void)
+	{
+		if (_hdr->values_len < off + sizeof(uint64_t))
+			throw IOException(TRACE_INFO, "Image is malformed");
+		uint64_t w;
+		memcpy(&w, _values + off, sizeof(w));
+		off += sizeof(w);
+		return w;
+	};
+
+	uint64_t n = word();
+	for (uint64_t j = 0; j < n; j++)
+	{
+		uint64_t key = word();
+		uint64_t len = word();
+		if (_hdr->values_len - off < len)
+			throw IOException(TRACE_INFO, "Image is malformed");
+		cb(key, std::string(_values + off, len));
+		off += pad8(len);
+	}
+}
+
+void MappedImage::advise_sequential(void) const
+{
+	if (_hdr) madvise(_addr, _len, MADV_SEQUENTIAL);
+}
+
+void MappedImage::advise_random(void) const
+{
+	if (_hdr) madvise(_addr, _len, MADV_RANDOM);
+}
+
+// ==================================================================
+
+void MappedImage::write(FILE* fh, const HandleSeq& hset)
+{
+	NameServer& ns = nameserver();
+
+	// Number the Atoms so that each comes after all of those below it.
+	std::unordered_map<const Atom*, uint64_t> index;
+	HandleSeq order;
+	std::function<void(const Handle&)> visit = [&](const Handle& h)
+	{
+		if (index.end() != index.find(h.get())) return;
+		if (h->is_link())
+			for (const Handle& ho : h->getOutgoingSet())
+				visit(ho);
+		index.emplace(h.get(), order.size());
+		order.push_back(h);
+	};
+	index.reserve(hset.size());
+	order.reserve(hset.size());
+	for (const Handle& h : hset)
+		visit(h);
+	for (const Handle& h : hset)
+		for (const Handle& key : h->getKeys())
+			visit(key);
+
+	std::vector<uint32_t> tids(ns.getNumberOfClasses(), UINT32_MAX);
+	std::vector<Type> types;
+	std::vector<std::vector<uint64_t>> of_type;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		Type t = order[i]->get_type();
+		if (UINT32_MAX == tids[t])
+		{
+			tids[t] = types.size();
+			types.push_back(t);
+			of_type.emplace_back();
+		}
+		of_type[tids[t]].push_back(i);
+	}
+
+	std::string strings;
+	std::vector<uint64_t> names;
+	for (Type t : types)
+	{
+		const std::string& name = ns.getTypeName(t);
+		names.push_back(strings.size());
+		names.push_back(name.size());
+		strings += name;
+	}
+
+	// Word 0 is the empty incoming set.
+	std::vector<uint64_t> words(1, 0);
+	std::vector<Record> atoms(order.size());
+	std::vector<uint64_t> hashes(order.size());
+	std::vector<uint64_t> nincoming(order.size(), 0);
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const Handle& h = order[i];
+		Record& r = atoms[i];
+		r.tid = tids[h->get_type()];
+		r.incoming = 0;
+		r.values = 0;
+		if (h->is_node())
+		{
+			const std::string& name = h->get_name();
+			r.size = name.size();
+			r.data = strings.size();
+			strings += name;
+			hashes[i] = node_hash(r.tid, name);
+			continue;
+		}
+		const HandleSeq& oset = h->getOutgoingSet();
+		r.size = oset.size();
+		r.data = words.size();
+		words.push_back(oset.size());
+		for (const Handle& ho : oset)
+			words.push_back(index[ho.get()]);
+		hashes[i] = link_hash(r.tid, &words[r.data + 1], oset.size());
+
+		// An Atom that appears twice in one Link is counted once.
+		for (size_t j = 0; j < oset.size(); j++)
+		{
+			uint64_t o = words[r.data + 1 + j];
+			bool seen = false;
+			for (size_t k = 0; k < j and not seen; k++)
+				seen = (o == words[r.data + 1 + k]);
+			if (not seen) nincoming[o]++;
+		}
+	}
+
+	// The incoming sets, each filled in as the Links come by.
+	std::vector<uint64_t> fill(order.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		if (0 == nincoming[i]) continue;
+		atoms[i].incoming = words.size();
+		words.push_back(nincoming[i]);
+		fill[i] = words.size();
+		words.resize(words.size() + nincoming[i]);
+	}
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const Record& r = atoms[i];
+		if (order[i]->is_node()) continue;
+		for (size_t j = 0; j < r.size; j++)
+		{
+			uint64_t o = words[r.data + 1 + j];
+			bool seen = false;
+			for (size_t k = 0; k < j and not seen; k++)
+				seen = (o == words[r.data + 1 + k]);
+			if (not seen) words[fill[o]++] = i;
+		}
+	}
+
+	std::vector<uint64_t> typeidx;
+	for (const std::vector<uint64_t>& atl : of_type)
+	{
+		typeidx.push_back(words.size());
+		words.push_back(atl.size());
+		words.insert(words.end(), atl.begin(), atl.end());
+	}
+
+	// Open addressing, at most half full.
+	uint64_t nbuckets = 16;
+	while (nbuckets < 2 * order.size()) nbuckets <<= 1;
+	std::vector<uint64_t> buckets(nbuckets, 0);
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		uint64_t b = hashes[i] & (nbuckets - 1);
+		while (buckets[b]) b = (b + 1) & (nbuckets - 1);
+		buckets[b] = i + 1;
+	}
+
+	std::string values;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const Handle& h = order[i];
+		if (not h->haveValues()) continue;
+		HandleSet keys(h->getKeys());
+		atoms[i].values = values.size() + 1;
+		put(values, keys.size());
+		for (const Handle& key : keys)
+		{
+			std::string sexpr(Sexpr::encode_value(h->getValue(key)));
+			put(values, index[key.get()]);
+			put(values, sexpr.size());
+			values += sexpr;
+			values.resize(pad8(values.size()), '\0');
+		}
+	}
+
+	strings.resize(pad8(strings.size()), '\0');
+
+	Header hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+	hdr.version = IMAGE_VERSION;
+	hdr.bom = byte_order();
+	uint64_t off = pad8(sizeof(Header));
+	hdr.ntypes = types.size();
+	hdr.types_off = off;
+	off += names.size() * sizeof(uint64_t);
+	hdr.natoms = atoms.size();
+	hdr.atoms_off = off;
+	off += atoms.size() * sizeof(Record);
+	hdr.strings_off = off;
+	hdr.strings_len = strings.size();
+	off += strings.size();
+	hdr.words_off = off;
+	hdr.nwords = words.size();
+	off += words.size() * sizeof(uint64_t);
+	hdr.buckets_off = off;
+	hdr.nbuckets = nbuckets;
+	off += buckets.size() * sizeof(uint64_t);
+	hdr.typeidx_off = off;
+	off += typeidx.size() * sizeof(uint64_t);
+	hdr.values_off = off;
+	hdr.values_len = values.size();
+	off += values.size();
+	hdr.file_len = off;
+
+	static const char zeros[8] = {0};
+	auto out = [&](const void* p, size_t n)
+	{
+		if (0 < n and 1 != fwrite(p, n, 1, fh))
+			throw IOException(TRACE_INFO,
+				"Image write failed: %s", strerror(errno));
+	};
+	out(&hdr, sizeof(hdr));
+	out(zeros, pad8(sizeof(hdr)) - sizeof(hdr));
+	out(names.data(), names.size() * sizeof(uint64_t));
+	out(atoms.data(), atoms.size() * sizeof(Record));
+	out(strings.data(), strings.size());
+	out(words.data(), words.size() * sizeof(uint64_t));
+	out(buckets.data(), buckets.size() * sizeof(uint64_t));
+	out(typeidx.data(), typeidx.size() * sizeof(uint64_t));
+	out(values.data(), values.size());
+}
+
+/* ============================= END OF FILE ================= */
@@ -0,0 +1,157 @@
+/*
+ * FUNCTION:
+ * A memory-mapped, directly addressable image of an AtomSpace.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_MAPPED_IMAGE_H
+#define _OPENCOG_MAPPED_IMAGE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * An AtomSpace laid out in a file so that it can be used in place,
+ * once mapped, without being read in first. Unlike a snapshot, which
+ * is a stream that has to be decoded from the start, every part of an
+ * image is at a fixed offset, and Atoms refer to one another by their
+ * index in the Atom table. Opening an image reads only the header and
+ * the type names; what is looked at after that is paged in by the OS,
+ * and can be paged out again under memory pressure.
+ *
+ * An image holds, all 8-byte aligned, in the byte order of the machine
+ * that wrote it:
+ * -- a header, `ATOMMAP`, with the offsets and sizes of the sections;
+ * -- the type names;
+ * -- the Atom table: one fixed-size record per Atom, holding its type,
+ *    and either where its name is, or where its outgoing set is; where
+ *    its incoming set is, and where its Values are. Every Atom comes
+ *    after those in its outgoing set;
+ * -- the strings: the Node names;
+ * -- the words: the outgoing sets, the incoming sets and the per-type
+ *    Atom lists, as counts followed by Atom indexes;
+ * -- the hash table: an open-addressed table from the content hash of
+ *    an Atom (type and name, or type and outgoing indexes) to its
+ *    index. This is how Atoms are found by what they are;
+ * -- the type index: for each type, where its Atom list is;
+ * -- the Values, as s-expressions, with the index of their key.
+ *
+ * Images are written whole, by write(); they are not changed in place.
+ */
+class MappedImage
+{
+	public:
+		static const uint64_t NONE = UINT64_MAX;
+
+		/// A run of Atom indexes, in the mapped file.
+		struct Span
+		{
+			const uint64_t* begin_ = nullptr;
+			const uint64_t* end_ = nullptr;
+			const uint64_t* begin() const { return begin_; }
+			const uint64_t* end() const { return end_; }
+			size_t size() const { return end_ - begin_; }
+		};
+
+	private:
+		struct Header;
+		struct Record;
+
+		void* _addr;
+		size_t _len;
+
+		const Header* _hdr;
+		const Record* _atoms;
+		const char* _strings;
+		const uint64_t* _words;
+		const uint64_t* _buckets;
+		const uint64_t* _typeidx;
+		const char* _values;
+
+		// Image type ids to Types, and back.
+		std::vector<Type> _types;
+		std::vector<uint32_t> _tids;
+
+		void check(void);
+		Span words(uint64_t) const;
+		uint64_t probe(uint64_t hash,
+		               const std::function<bool(uint64_t)>&) const;
+
+	public:
+		MappedImage(void);
+		~MappedImage();
+		MappedImage(const MappedImage&) = delete;
+		MappedImage& operator=(const MappedImage&) = delete;
+
+		/// Map the image; throws an IOException if it is not one.
+		void open(const std::string& filename);
+		void close(void);
+		bool is_open(void) const { return nullptr != _hdr; }
+
+		/// The number of Atoms in the image.
+		size_t size(void) const;
+
+		/// The index of the Atom, or NONE if it is not in the image.
+		uint64_t find_node(Type, std::string_view) const;
+		uint64_t find_link(Type, const std::vector<uint64_t>&) const;
+		uint64_t find(const Handle&) const;
+
+		/// The Atom at the index, in no AtomSpace, with no Values.
+		Handle atom(uint64_t) const;
+
+		/// Call back with every Atom, in the order of the table. Each
+		/// is built out of those the callback returned before; return
+		/// the Atom that was put in an AtomSpace, or null to keep it.
+		void each(const std::function<Handle(uint64_t, const Handle&)>&) const;
+
+		Span incoming(uint64_t) const;
+		Span of_type(Type) const;
+
+		/// Call back with the index of the key, and the Value as an
+		/// s-expression, for each Value on the Atom.
+		void values(uint64_t,
+		            const std::function<void(uint64_t, const std::string&)>&) const;
+
+		/// Tell the OS how the image is about to be used.
+		void advise_sequential(void) const;
+		void advise_random(void) const;
+
+		/// Write an image of the Atoms, those below them, and their
+		/// Values (and the keys of those) to the file.
+		static void write(FILE*, const HandleSeq&);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_MAPPED_IMAGE_H
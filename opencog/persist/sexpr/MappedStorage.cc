@@ -0,0 +1,343 @@
+/*
+ * MappedStorage.cc
+ * AtomSpaces kept in memory-mapped images, used in place.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mutex>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/persist/storage/storage_types.h>
+
+#include "MappedStorage.h"
+#include "Sexpr.h"
+
+using namespace opencog;
+
+// ==================================================================
+
+MappedStorageNode::MappedStorageNode(Type t, const std::string& uri)
+	: StorageNode(t, uri)
+{
+	_open = false;
+
+	_filename = get_name();
+
+	// If the URL begins with `file://` then just strip that off.
+	if (0 == _filename.compare(0, 7, "file://"))
+		_filename = _filename.substr(7);
+}
+
+MappedStorageNode::~MappedStorageNode()
+{
+}
+
+void MappedStorageNode::not_supported(void)
+{
+	throw IOException(TRACE_INFO,
+		"MappedStorageNode images are written whole, by store-atomspace!");
+}
+
+void MappedStorageNode::check_open(void)
+{
+	if (not _open)
+		throw IOException(TRACE_INFO,
+		"MappedStorageNode %s is not open!", _filename.c_str());
+}
+
+void MappedStorageNode::kill_data(void)
+{
+	std::unique_lock<std::shared_mutex> lck(_mtx);
+	_image.close();
+	int rc = unlink(_filename.c_str());
+	if (rc and ENOENT != errno)
+		throw IOException(TRACE_INFO,
+		"MappedStorageNode cannot remove %s: %s",
+			_filename.c_str(), strerror(errno));
+}
+
+// A file that is not there yet is an empty image; it is created by
+// the first store.
+void MappedStorageNode::open(void)
+{
+	std::unique_lock<std::shared_mutex> lck(_mtx);
+	if (_open)
+		throw IOException(TRACE_INFO,
+		"MappedStorageNode %s is already open!", _filename.c_str());
+
+	if (0 == access(_filename.c_str(), F_OK))
+	{
+		_image.open(_filename);
+		_image.advise_random();
+	}
+	_open = true;
+}
+
+void MappedStorageNode::close(void)
+{
+	std::unique_lock<std::shared_mutex> lck(_mtx);
+	_image.close();
+	_open = false;
+}
+
+bool MappedStorageNode::connected(void)
+{
+	return _open;
+}
+
+// ==================================================================
+
+/// Put the Atom at the index, and its Values, into the AtomSpace.
+Handle MappedStorageNode::install(AtomSpace* as, uint64_t idx)
+{
+	// Read-only AtomSpaces won't allow insertion.
+	Handle h(as->add_atom(_image.atom(idx)));
+	if (nullptr == h) return h;
+
+	_image.values(idx, [&](uint64_t key, const std::string& sexpr)
+	{
+		Handle k(as->add_atom(_image.atom(key)));
+		if (nullptr == k) return;
+		size_t pos = 0;
+		ValuePtr vp(Sexpr::decode_value(sexpr, pos));
+		as->set_value(h, k, Sexpr::add_atoms(as, vp));
+	});
+	return h;
+}
+
+/// The Atom at the index, in no AtomSpace, with its Values.
+Handle MappedStorageNode::with_values(uint64_t idx)
+{
+	Handle h(_image.atom(idx));
+	_image.values(idx, [&](uint64_t key, const std::string& sexpr)
+	{
+		size_t pos = 0;
+		h->setValue(_image.atom(key), Sexpr::decode_value(sexpr, pos));
+	});
+	return h;
+}
+
+void MappedStorageNode::getAtom(const Handle& h)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+	if (not _image.is_open()) return;
+
+	uint64_t idx = _image.find(h);
+	if (MappedImage::NONE == idx) return;
+
+	AtomSpace* as = h->getAtomSpace();
+	_image.values(idx, [&](uint64_t key, const std::string& sexpr)
+	{
+		size_t pos = 0;
+		ValuePtr vp(Sexpr::decode_value(sexpr, pos));
+		if (nullptr == as)
+		{
+			h->setValue(_image.atom(key), vp);
+			return;
+		}
+		Handle k(as->add_atom(_image.atom(key)));
+		if (k) as->set_value(h, k, Sexpr::add_atoms(as, vp));
+	});
+}
+
+Handle MappedStorageNode::getNode(Type t, const char * name)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+	if (not _image.is_open()) return Handle::UNDEFINED;
+
+	uint64_t idx = _image.find_node(t, name);
+	if (MappedImage::NONE == idx) return Handle::UNDEFINED;
+	return with_values(idx);
+}
+
+Handle MappedStorageNode::getLink(Type t, const HandleSeq& hs)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+	if (not _image.is_open()) return Handle::UNDEFINED;
+
+	std::vector<uint64_t> oset;
+	for (const Handle& ho : hs)
+	{
+		uint64_t i = _image.find(ho);
+		if (MappedImage::NONE == i) return Handle::UNDEFINED;
+		oset.push_back(i);
+	}
+	uint64_t idx = _image.find_link(t, oset);
+	if (MappedImage::NONE == idx) return Handle::UNDEFINED;
+	return with_values(idx);
+}
+
+void MappedStorageNode::fetchIncomingSet(AtomSpace* as, const Handle& h)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+	if (not _image.is_open()) return;
+
+	uint64_t idx = _image.find(h);
+	if (MappedImage::NONE == idx) return;
+	for (uint64_t i : _image.incoming(idx))
+		install(as, i);
+}
+
+void MappedStorageNode::fetchIncomingByType(AtomSpace* as, const Handle& h,
+                                            Type t)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+	if (not _image.is_open()) return;
+
+	uint64_t idx = _image.find(h);
+	if (MappedImage::NONE == idx) return;
+	for (uint64_t i : _image.incoming(idx))
+	{
+		Handle hi(_image.atom(i));
+		if (hi->get_type() == t) install(as, i);
+	}
+}
+
+void MappedStorageNode::loadValue(const Handle& h, const Handle& key)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+
+	// If it's not in the image, it's not anywhere.
+	ValuePtr vp;
+	uint64_t idx = MappedImage::NONE;
+	uint64_t kdx = MappedImage::NONE;
+	if (_image.is_open())
+	{
+		idx = _image.find(h);
+		kdx = _image.find(key);
+	}
+	if (MappedImage::NONE != idx and MappedImage::NONE != kdx)
+		_image.values(idx, [&](uint64_t k, const std::string& sexpr)
+		{
+			if (k != kdx) return;
+			size_t pos = 0;
+			vp = Sexpr::decode_value(sexpr, pos);
+		});
+
+	AtomSpace* as = h->getAtomSpace();
+	if (nullptr == as)
+		h->setValue(key, vp);
+	else
+		as->set_value(h, key, vp ? Sexpr::add_atoms(as, vp) : vp);
+}
+
+void MappedStorageNode::loadType(AtomSpace* as, Type t)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+	if (not _image.is_open()) return;
+
+	for (uint64_t i : _image.of_type(t))
+		install(as, i);
+}
+
+// ==================================================================
+
+void MappedStorageNode::storeAtom(const Handle&, bool)
+{
+	not_supported();
+}
+
+void MappedStorageNode::removeAtom(const Handle&, bool)
+{
+	not_supported();
+}
+
+void MappedStorageNode::storeValue(const Handle&, const Handle&)
+{
+	not_supported();
+}
+
+// The image is written next to the old one, and then moved into
+// place; the old one stays mapped, and in use, until then.
+void MappedStorageNode::storeAtomSpace(const AtomSpace* table)
+{
+	check_open();
+
+	HandleSeq hset;
+	table->get_handles_by_type(hset, ATOM, true);
+
+	std::string tmpname = _filename + ".tmp";
+	FILE* fh = fopen(tmpname.c_str(), "wb");
+	if (nullptr == fh)
+		throw IOException(TRACE_INFO,
+		"MappedStorageNode cannot open %s: %s",
+			tmpname.c_str(), strerror(errno));
+
+	try
+	{
+		MappedImage::write(fh, hset);
+	}
+	catch (...)
+	{
+		fclose(fh);
+		unlink(tmpname.c_str());
+		throw;
+	}
+
+	std::unique_lock<std::shared_mutex> lck(_mtx);
+	if (fclose(fh) or rename(tmpname.c_str(), _filename.c_str()))
+	{
+		unlink(tmpname.c_str());
+		throw IOException(TRACE_INFO,
+		"MappedStorageNode cannot write %s: %s",
+			_filename.c_str(), strerror(errno));
+	}
+	_image.open(_filename);
+	_image.advise_random();
+}
+
+void MappedStorageNode::loadAtomSpace(AtomSpace* table)
+{
+	std::shared_lock<std::shared_mutex> lck(_mtx);
+	check_open();
+	if (not _image.is_open()) return;
+
+	_image.advise_sequential();
+	_image.each([&](uint64_t idx, const Handle& h) -> Handle
+	{
+		Handle ah(table->add_atom(h));
+		if (nullptr == ah) return ah;
+		_image.values(idx, [&](uint64_t key, const std::string& sexpr)
+		{
+			Handle k(table->add_atom(_image.atom(key)));
+			if (nullptr == k) return;
+			size_t pos = 0;
+			ValuePtr vp(Sexpr::decode_value(sexpr, pos));
+			table->set_value(ah, k, Sexpr::add_atoms(table, vp));
+		});
+		return ah;
+	});
+	_image.advise_random();
+}
+
+DEFINE_NODE_FACTORY(MappedStorageNode, MAPPED_STORAGE_NODE)
@@ -0,0 +1,113 @@
+/*
+ * FUNCTION:
+ * AtomSpaces kept in memory-mapped images, used in place.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_MAPPED_STORAGE_H
+#define _OPENCOG_MAPPED_STORAGE_H
+
+#include <shared_mutex>
+
+#include <opencog/persist/api/StorageNode.h>
+
+#include "MappedImage.h"
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * Serves Atoms straight out of a memory-mapped AtomSpace image (see
+ * MappedImage.h). Opening one maps the file, and nothing more; there
+ * is no load step. Atoms, their incoming sets, the Atoms of a type,
+ * and Values are then found through the indexes in the image, and
+ * only the pages that hold them are read. The image can be much
+ * larger than RAM; only what is fetched lands in the AtomSpace.
+ *
+ * `store-atomspace` writes a new image, next to the old one, which
+ * replaces it when complete, and is mapped in its place. Images are
+ * not changed in place, so single Atoms and Values cannot be stored
+ * or removed.
+ */
+class MappedStorageNode : public StorageNode
+{
+	private:
+		std::string _filename;
+		bool _open;
+
+		// Readers share the image; a store replaces it.
+		mutable std::shared_mutex _mtx;
+		MappedImage _image;
+
+		void not_supported(void);
+		void check_open(void);
+		Handle install(AtomSpace*, uint64_t);
+		Handle with_values(uint64_t);
+
+	public:
+		MappedStorageNode(Type t, const std::string& uri);
+		virtual ~MappedStorageNode();
+
+		void open(void);
+		void close(void);
+		bool connected(void); // connection to DB is alive
+
+		void kill_data(void);       // destroy DB contents
+		void create(void) {}
+		void destroy(void) { kill_data(); }
+		void erase(void) { kill_data(); }
+
+		// AtomStorage interface
+		void getAtom(const Handle&);
+		Handle getNode(Type, const char *);
+		Handle getLink(Type, const HandleSeq&);
+		void fetchIncomingSet(AtomSpace*, const Handle&);
+		void fetchIncomingByType(AtomSpace*, const Handle&, Type t);
+		void storeAtom(const Handle&, bool synchronous = false);
+		void removeAtom(const Handle&, bool recursive);
+		void storeValue(const Handle&, const Handle&);
+		void loadValue(const Handle&, const Handle&);
+		void loadType(AtomSpace*, Type);
+		void barrier() {}
+
+		// Large-scale loads and saves
+		void loadAtomSpace(AtomSpace*); // Load entire contents of DB
+		void storeAtomSpace(const AtomSpace*); // Store all of AtomSpace
+
+		static Handle factory(const Handle&);
+};
+
+typedef std::shared_ptr<MappedStorageNode> MappedStorageNodePtr;
+static inline MappedStorageNodePtr MappedStorageNodeCast(const Handle& h)
+   { return std::dynamic_pointer_cast<MappedStorageNode>(h); }
+static inline MappedStorageNodePtr MappedStorageNodeCast(AtomPtr a)
+   { return std::dynamic_pointer_cast<MappedStorageNode>(a); }
+
+#define createMappedStorageNode std::make_shared<MappedStorageNode>
+
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_MAPPED_STORAGE_H
@@ -0,0 +1,60 @@
+/*
+ * FUNCTION:
+ * A file, or part of one, mapped into memory.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SEXPR_MAPPING_H
+#define _OPENCOG_SEXPR_MAPPING_H
+
+#include <string_view>
+#include <sys/mman.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/// The bytes of a file that were mmap()ed; unmapped on the way out,
+/// also when an exception is thrown. Whoever maps it sets `addr` and
+/// `len`; `addr` stays MAP_FAILED if nothing was mapped.
+struct Mapping
+{
+	void* addr = MAP_FAILED;
+	size_t len = 0;
+
+	Mapping(void) = default;
+	Mapping(const Mapping&) = delete;
+	Mapping& operator=(const Mapping&) = delete;
+	~Mapping() { if (MAP_FAILED != addr) munmap(addr, len); }
+
+	std::string_view view(void) const
+	{
+		if (MAP_FAILED == addr) return std::string_view();
+		return std::string_view((const char*) addr, len);
+	}
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_SEXPR_MAPPING_H
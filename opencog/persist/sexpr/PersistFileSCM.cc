@@ -38,6 +38,9 @@ private:
 	void init(void);
 
 	void load_file(const std::string&);
+	void compact(const Handle&);
+	void dump_file(const std::string&, const std::string&, int, bool);
+	void compress_snapshot(const Handle&, const std::string&, int);
 public:
 	PersistFileSCM(void);
 }; // class
@@ -55,6 +58,8 @@ void opencog_persist_file_init(void);
 #include <opencog/guile/SchemePrimitive.h>
 
 #include "fast_load.h"
+#include "FileStorage.h"
+#include "SnapshotStorage.h"
 
 using namespace opencog;
 
@@ -75,6 +80,12 @@ void PersistFileSCM::init(void)
 {
 	define_scheme_primitive("load-file",
 	             &PersistFileSCM::load_file, this, "persist-file");
+	define_scheme_primitive("compact-file",
+	             &PersistFileSCM::compact, this, "persist-file");
+	define_scheme_primitive("dump-file-blocks",
+	             &PersistFileSCM::dump_file, this, "persist-file");
+	define_scheme_primitive("compress-snapshot-blocks",
+	             &PersistFileSCM::compress_snapshot, this, "persist-file");
 }
 
 // =====================================================================
@@ -85,6 +96,42 @@ void PersistFileSCM::load_file(const std::string& path)
 	opencog::load_file(path, *as);
 }
 
+void PersistFileSCM::compact(const Handle& h)
+{
+	FileStorageNodePtr fsn = FileStorageNodeCast(h);
+	if (nullptr == fsn)
+		throw RuntimeException(TRACE_INFO,
+			"compact-file: Expecting a FileStorageNode, got %s",
+			h->to_short_string().c_str());
+	fsn->compact();
+}
+
+void PersistFileSCM::dump_file(const std::string& path,
+                               const std::string& codec,
+                               int level, bool train)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("dump-file");
+	BlockOptions opts;
+	opts.codec = block_codec_named(codec);
+	opts.level = level;
+	opencog::dump_file(path, *as, opts, train);
+}
+
+void PersistFileSCM::compress_snapshot(const Handle& h,
+                                       const std::string& codec,
+                                       int level)
+{
+	SnapshotStorageNodePtr ssn = SnapshotStorageNodeCast(h);
+	if (nullptr == ssn)
+		throw RuntimeException(TRACE_INFO,
+			"compress-snapshot: Expecting a SnapshotStorageNode, got %s",
+			h->to_short_string().c_str());
+	BlockOptions opts;
+	opts.codec = block_codec_named(codec);
+	opts.level = level;
+	ssn->set_compression(opts);
+}
+
 void opencog_persist_file_init(void)
 {
 	static PersistFileSCM patty;
@@ -24,6 +24,9 @@
 #define _SEXPR_ECODE_H
 
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <opencog/atoms/base/Handle.h>
 
 namespace opencog
@@ -52,11 +55,11 @@ public:
 		return decode_atom(s, junk);
 	}
 
-	static std::string get_node_name(const std::string&, size_t& l, size_t& r,
+	static std::string get_node_name(std::string_view, size_t& l, size_t& r,
 	                                 Type, size_t line = 0);
 
 	static ValuePtr decode_value(const std::string&, size_t&);
-	static Type decode_type(const std::string& s, size_t& pos);
+	static Type decode_type(std::string_view s, size_t& pos);
 
 	static void decode_slist(const Handle&, const std::string&, size_t&);
 	static void decode_alist(const Handle&, const std::string&, size_t&);
@@ -72,10 +75,11 @@ public:
 	}
 
 	// -------------------------------------------
-	// API more suitable to very long, file-driven I/O.
-	static int get_next_expr(const std::string&,
+	// API more suitable to very long, file-driven I/O. These work in
+	// place, on any buffer, including ones that are not null-terminated.
+	static int get_next_expr(std::string_view,
                             size_t& l, size_t& r, size_t line_cnt);
-	static Handle decode_atom(const std::string& s,
+	static Handle decode_atom(std::string_view s,
                              size_t l, size_t r, size_t line_cnt);
 
 	static ValuePtr add_atoms(AtomSpace*, const ValuePtr&);
@@ -90,6 +94,20 @@ public:
 
 	static std::string dump_atom(const Handle&);
 	static std::string dump_vatom(const Handle&, const Handle&);
+
+	// As above, but appending to the end of `out`. Reusing one buffer
+	// for many Atoms avoids allocating a fresh string for each.
+	static void encode_atom(std::string& out, const Handle&);
+	static void encode_value(std::string& out, const ValuePtr&);
+	static void encode_atom_values(std::string& out, const Handle&);
+	static void dump_atom(std::string& out, const Handle&);
+	static void dump_vatom(std::string& out, const Handle&, const Handle&);
+
+	// The Values on an Atom, taken at one point in time, so that they
+	// can be printed later on, even if the Atom has changed since.
+	typedef std::vector<std::pair<Handle, ValuePtr>> KeyValues;
+	static KeyValues get_values(const Handle&);
+	static void dump_atom(std::string& out, const Handle&, const KeyValues&);
 };
 
 /** @}*/
@@ -21,7 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <map>
+
 #include <opencog/util/Logger.h>
+#include <opencog/util/concurrent_stack.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/persist/sexpr/Commands.h>
 
@@ -33,6 +36,7 @@ SexprEval::SexprEval(AtomSpace* as)
 	: GenericEval()
 {
 	_atomspace = as;
+	_done = false;
 }
 
 SexprEval::~SexprEval()
@@ -45,21 +49,45 @@ SexprEval::~SexprEval()
  */
 void SexprEval::eval_expr(const std::string &expr)
 {
+	// The answer is made in a buffer of its own, without the lock,
+	// so that poll_result() waits on the condition, and not on the
+	// whole of the command.
+	std::string answer;
 	try {
-		std::lock_guard<std::mutex> lock(_mtx);
-		_answer = Commands::interpret_command(_atomspace, expr);
+		answer = Commands::interpret_command(_atomspace, expr);
 	}
 	catch (const StandardException& ex)
 	{
+		std::lock_guard<std::mutex> lock(_mtx);
 		_error_string = ex.what();
 		_caught_error = true;
 	}
+	// Anything else, e.g. std::invalid_argument from stod() on a
+	// malformed FloatValue, must not leave poll_result() waiting.
+	catch (const std::exception& ex)
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_error_string = ex.what();
+		_caught_error = true;
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_error_string = "Unknown exception";
+		_caught_error = true;
+	}
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	_answer = std::move(answer);
+	_done = true;
+	_cv.notify_all();
 }
 
 std::string SexprEval::poll_result()
 {
 	std::string ret;
-	std::lock_guard<std::mutex> lock(_mtx);
+	std::unique_lock<std::mutex> lock(_mtx);
+	_cv.wait(lock, [this] { return _done; });
 	ret.swap(_answer);
 	return ret;
 }
@@ -68,12 +96,12 @@ std::string SexprEval::poll_result()
 void SexprEval::begin_eval()
 {
 	std::lock_guard<std::mutex> lock(_mtx);
-	while (0 < _answer.size())
+	if (0 < _answer.size())
 	{
 		logger().warn("This shouldn't happen!");
-		usleep(100);
+		_answer.clear();
 	}
-	_answer.clear();
+	_done = false;
 }
 
 /* ============================================================== */
@@ -87,17 +115,50 @@ void SexprEval::interrupt(void)
 	_error_string = "Caught interrupt!";
 }
 
+// Evaluators not in use, left behind by threads that have exited.
+// The network servers run a thread per connection, and would otherwise
+// make and delete an evaluator for each one. The stack is thread-safe
+// by itself; no further lock is needed.
+static concurrent_stack<SexprEval*> pool;
+
+/// Return the evaluator for this thread and AtomSpace. Each thread
+/// gets one of its own, so that requests arriving on different network
+/// connections are evaluated concurrently; they share nothing but the
+/// AtomSpace, which is thread-safe. When the thread exits, its
+/// evaluators go back to the pool, for the next thread to use.
 SexprEval* SexprEval::get_evaluator(AtomSpace* as)
 {
-	static thread_local SexprEval* evaluator = new SexprEval(as);
+	static thread_local std::map<AtomSpace*, SexprEval*> issued;
 
 	// The eval_dtor runs when this thread is destroyed.
 	class eval_dtor {
 		public:
-		~eval_dtor() { delete evaluator; }
+		~eval_dtor() {
+			for (auto& ev : issued)
+			{
+				SexprEval* evaluator = ev.second;
+				evaluator->_atomspace = nullptr;
+				evaluator->clear_pending();
+
+				// The stack may already be gone, during library exit.
+				try {
+					pool.push(evaluator);
+				}
+				catch (const concurrent_stack<SexprEval*>::Canceled&) {}
+			}
+		}
 	};
 	static thread_local eval_dtor killer;
 
+	auto ev = issued.find(as);
+	if (ev != issued.end())
+		return ev->second;
+
+	SexprEval* evaluator = nullptr;
+	if (not pool.try_pop(evaluator))
+		evaluator = new SexprEval(as);
+	evaluator->_atomspace = as;
+	issued[as] = evaluator;
 	return evaluator;
 }
 
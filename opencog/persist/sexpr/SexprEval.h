@@ -23,6 +23,7 @@
 #ifndef _OPENCOG_SEXPR_EVAL_H
 #define _OPENCOG_SEXPR_EVAL_H
 
+#include <condition_variable>
 #include <mutex>
 #include <string>
 #include <opencog/eval/GenericEval.h>
@@ -32,6 +33,11 @@
  * evaluation.  It supports just enough commands to allow AtomSpaces
  * and portions there-of to be easily transported across the network.
  * It is used by the CogServer, and the atomsspace-cog network backend.
+ *
+ * Each thread has its own evaluator for each AtomSpace; see
+ * get_evaluator(). The commands keep no state of their own, and so
+ * requests from different threads run concurrently, with only the
+ * AtomSpace (which is thread-safe) shared between them.
  */
 
 namespace opencog {
@@ -47,9 +53,12 @@ class SexprEval : public GenericEval
 
 		// poll_result() is called in a different thread
 		// than eval_expr() and the result is that _answer
-		// can get clobbered. So force the reader to wait.
+		// can get clobbered. So force the reader to wait,
+		// until the answer is all there.
 		std::mutex _mtx;
+		std::condition_variable _cv;
 		std::string _answer;
+		bool _done;
 
 		SexprEval(AtomSpace*);
 	public:
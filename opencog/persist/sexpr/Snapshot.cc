@@ -0,0 +1,593 @@
+/*
+ * Snapshot.cc
+ * The binary snapshot encoding of Atoms and their Values.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include <string_view>
+#include <unordered_map>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/Float32Value.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/IntValue.h>
+#include <opencog/atoms/value/StringValue.h>
+#include <opencog/atoms/value/ValueFactory.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "BlockCompress.h"
+#include "Sexpr.h"
+#include "Snapshot.h"
+
+using namespace opencog;
+
+// ==================================================================
+// The format; see Snapshot.h
+
+static const char MAGIC[8] = {'A', 'T', 'O', 'M', 'S', 'N', 'A', 'P'};
+static const char TRAILER[8] = {'S', 'N', 'A', 'P', 'E', 'N', 'D', '\0'};
+
+#define SNAPSHOT_VERSION 1
+
+// Atoms are added to the AtomSpace this many at a time.
+#define BATCH_SIZE (1UL << 20)
+
+// Output is written out in blocks of this size.
+#define BLOCK_SIZE (1UL << 20)
+
+// Compressed, it is handed over in pieces of this size; the blocks
+// are cut between them.
+#define BLOCK_CHUNK (1UL << 16)
+
+namespace {
+
+// How the contents of a group of Values are written.
+enum Kind : uint8_t { FLOATS, FLOAT32S, INTS, STRINGS, SEXPRS };
+
+Kind kind_of(Type t)
+{
+	NameServer& ns = nameserver();
+	if (ns.isA(t, FLOAT_VALUE) and not ns.isA(t, STREAM_VALUE) and
+	    FORMULA_TRUTH_VALUE != t)
+		return FLOATS;
+	if (ns.isA(t, FLOAT32_VALUE)) return FLOAT32S;
+	if (ns.isA(t, INT_VALUE)) return INTS;
+	if (ns.isA(t, STRING_VALUE)) return STRINGS;
+	return SEXPRS;
+}
+
+uint8_t byte_order(void)
+{
+	uint16_t one = 1;
+	return *reinterpret_cast<uint8_t*>(&one);
+}
+
+// ------------------------------------------------------------------
+
+// Without a file, everything stays in the buffer.
+class Writer
+{
+	FILE* _fh;
+	BlockWriter* _bw;
+	std::string _buf;
+
+public:
+	Writer(FILE* fh) : _fh(fh), _bw(nullptr)
+		{ if (_fh) _buf.reserve(BLOCK_SIZE + 64); }
+	Writer(BlockWriter& bw) : _fh(nullptr), _bw(&bw)
+		{ _buf.reserve(BLOCK_SIZE + 64); }
+
+	void flush(void)
+	{
+		if (_buf.empty()) return;
+		if (_bw)
+		{
+			_bw->write(_buf);
+			_buf.clear();
+			return;
+		}
+		if (nullptr == _fh) return;
+		if (1 != fwrite(_buf.data(), _buf.size(), 1, _fh))
+			throw IOException(TRACE_INFO,
+				"Snapshot write failed: %s", strerror(errno));
+		_buf.clear();
+	}
+
+	std::string take(void) { return std::move(_buf); }
+
+	void bytes(const void* p, size_t n)
+	{
+		_buf.append(static_cast<const char*>(p), n);
+		if (_fh and BLOCK_SIZE <= _buf.size()) flush();
+		else if (_bw and BLOCK_CHUNK <= _buf.size()) flush();
+	}
+
+	void varint(uint64_t v)
+	{
+		char b[10];
+		size_t n = 0;
+		while (0x80 <= v) { b[n++] = char(v | 0x80); v >>= 7; }
+		b[n++] = char(v);
+		bytes(b, n);
+	}
+
+	void str(std::string_view s)
+	{
+		varint(s.size());
+		bytes(s.data(), s.size());
+	}
+};
+
+class Reader
+{
+	const char* _p;
+	const char* _end;
+
+	void need(size_t n)
+	{
+		if (size_t(_end - _p) < n)
+			throw IOException(TRACE_INFO, "Snapshot is truncated");
+	}
+
+public:
+	Reader(std::string_view s) : _p(s.data()), _end(s.data() + s.size()) {}
+
+	uint64_t varint(void)
+	{
+		uint64_t v = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7)
+		{
+			need(1);
+			uint8_t b = *_p++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (0 == (b & 0x80)) return v;
+		}
+		throw IOException(TRACE_INFO, "Snapshot has a malformed number");
+	}
+
+	/// A varint that must be less than `bound`.
+	uint64_t index(uint64_t bound)
+	{
+		uint64_t v = varint();
+		if (bound <= v)
+			throw IOException(TRACE_INFO, "Snapshot has a bad index");
+		return v;
+	}
+
+	std::string_view bytes(size_t n)
+	{
+		need(n);
+		std::string_view s(_p, n);
+		_p += n;
+		return s;
+	}
+
+	std::string_view str(void) { return bytes(varint()); }
+
+	/// Raw numbers; the mapping need not be aligned.
+	template<typename T>
+	void raw(std::vector<T>& out, size_t n)
+	{
+		if (size_t(_end - _p) / sizeof(T) < n)
+			throw IOException(TRACE_INFO, "Snapshot is truncated");
+		out.resize(n);
+		memcpy(out.data(), _p, n * sizeof(T));
+		_p += n * sizeof(T);
+	}
+};
+
+// ------------------------------------------------------------------
+
+class Saver
+{
+	std::unordered_map<const Atom*, uint64_t> _index;
+	HandleSeq _order;
+
+	std::vector<uint64_t> _type_ids;
+	std::vector<Type> _types;
+
+	std::unordered_map<std::string_view, uint64_t> _string_ids;
+	std::vector<std::string_view> _strings;
+
+	struct Group
+	{
+		Type type;
+		std::vector<uint64_t> atoms;
+		std::vector<uint64_t> keys;
+		ValueSeq values;
+	};
+	std::vector<Group> _groups;
+	std::unordered_map<Type, size_t> _group_of;
+
+	void visit(const Handle&);
+	uint64_t type_id(Type);
+	uint64_t string_id(std::string_view);
+
+public:
+	Saver(void) : _type_ids(nameserver().getNumberOfClasses(), UINT64_MAX) {}
+
+	void add(const HandleSeq&);
+	void write(Writer&);
+};
+
+// Number Atoms so that each comes after all of those below it.
+void Saver::visit(const Handle& h)
+{
+	if (_index.end() != _index.find(h.get())) return;
+	if (h->is_link())
+		for (const Handle& ho : h->getOutgoingSet())
+			visit(ho);
+	_index.emplace(h.get(), _order.size());
+	_order.push_back(h);
+}
+
+uint64_t Saver::type_id(Type t)
+{
+	uint64_t& id = _type_ids[t];
+	if (UINT64_MAX == id)
+	{
+		id = _types.size();
+		_types.push_back(t);
+	}
+	return id;
+}
+
+// The strings are owned by the Atoms and Values, which outlive us.
+uint64_t Saver::string_id(std::string_view s)
+{
+	auto it = _string_ids.find(s);
+	if (_string_ids.end() != it) return it->second;
+	_string_ids.emplace(s, _strings.size());
+	_strings.push_back(s);
+	return _strings.size() - 1;
+}
+
+void Saver::add(const HandleSeq& hset)
+{
+	_index.reserve(hset.size());
+	_order.reserve(hset.size());
+	for (const Handle& h : hset)
+		visit(h);
+
+	for (const Handle& h : hset)
+	{
+		if (not h->haveValues()) continue;
+		for (const Handle& key : h->getKeys())
+		{
+			ValuePtr v(h->getValue(key));
+			if (nullptr == v) continue;
+			visit(key);
+
+			Type t = v->get_type();
+			auto it = _group_of.find(t);
+			if (_group_of.end() == it)
+			{
+				it = _group_of.emplace(t, _groups.size()).first;
+				_groups.push_back({t, {}, {}, {}});
+			}
+			Group& g = _groups[it->second];
+			g.atoms.push_back(_index[h.get()]);
+			g.keys.push_back(_index[key.get()]);
+			g.values.push_back(v);
+		}
+	}
+}
+
+void Saver::write(Writer& w)
+{
+	NameServer& ns = nameserver();
+
+	// Gather the types and the strings.
+	for (const Handle& h : _order)
+	{
+		type_id(h->get_type());
+		if (h->is_node()) string_id(h->get_name());
+	}
+	for (const Group& g : _groups)
+	{
+		type_id(g.type);
+		if (STRINGS != kind_of(g.type)) continue;
+		for (const ValuePtr& v : g.values)
+			for (const std::string& s : StringValueCast(v)->value())
+				string_id(s);
+	}
+
+	w.bytes(MAGIC, sizeof(MAGIC));
+	w.varint(SNAPSHOT_VERSION);
+	uint8_t bom = byte_order();
+	w.bytes(&bom, 1);
+
+	w.varint(_types.size());
+	for (Type t : _types)
+		w.str(ns.getTypeName(t));
+
+	w.varint(_strings.size());
+	for (const std::string_view& s : _strings)
+		w.str(s);
+
+	// Outgoing Atoms are given by how far back they are.
+	w.varint(_order.size());
+	for (size_t i = 0; i < _order.size(); i++)
+	{
+		const Handle& h = _order[i];
+		w.varint(_type_ids[h->get_type()]);
+		if (h->is_node())
+		{
+			w.varint(_string_ids[h->get_name()]);
+			continue;
+		}
+		const HandleSeq& oset = h->getOutgoingSet();
+		w.varint(oset.size());
+		for (const Handle& ho : oset)
+			w.varint(i - 1 - _index[ho.get()]);
+	}
+
+	w.varint(_groups.size());
+	for (const Group& g : _groups)
+	{
+		Kind kind = kind_of(g.type);
+		w.varint(_type_ids[g.type]);
+		w.bytes(&kind, 1);
+		w.varint(g.values.size());
+		for (uint64_t a : g.atoms) w.varint(a);
+		for (uint64_t k : g.keys) w.varint(k);
+
+		switch (kind)
+		{
+			case FLOATS:
+				for (const ValuePtr& v : g.values)
+					w.varint(FloatValueCast(v)->value().size());
+				for (const ValuePtr& v : g.values)
+				{
+					const std::vector<double>& fv(FloatValueCast(v)->value());
+					w.bytes(fv.data(), fv.size() * sizeof(double));
+				}
+				break;
+			case FLOAT32S:
+				for (const ValuePtr& v : g.values)
+					w.varint(Float32ValueCast(v)->value().size());
+				for (const ValuePtr& v : g.values)
+				{
+					const std::vector<float>& fv(Float32ValueCast(v)->value());
+					w.bytes(fv.data(), fv.size() * sizeof(float));
+				}
+				break;
+			case INTS:
+				for (const ValuePtr& v : g.values)
+					w.varint(IntValueCast(v)->value().size());
+				for (const ValuePtr& v : g.values)
+				{
+					const std::vector<int64_t>& iv(IntValueCast(v)->value());
+					w.bytes(iv.data(), iv.size() * sizeof(int64_t));
+				}
+				break;
+			case STRINGS:
+				for (const ValuePtr& v : g.values)
+					w.varint(StringValueCast(v)->value().size());
+				for (const ValuePtr& v : g.values)
+					for (const std::string& s : StringValueCast(v)->value())
+						w.varint(_string_ids[s]);
+				break;
+			case SEXPRS:
+				for (const ValuePtr& v : g.values)
+					w.str(Sexpr::encode_value(v));
+				break;
+		}
+	}
+
+	w.bytes(TRAILER, sizeof(TRAILER));
+	w.flush();
+}
+
+// ------------------------------------------------------------------
+
+HandleSeq load(Reader& rd, AtomSpace* as, bool trusted)
+{
+	NameServer& ns = nameserver();
+
+	if (rd.bytes(sizeof(MAGIC)) != std::string_view(MAGIC, sizeof(MAGIC)))
+		throw IOException(TRACE_INFO, "Not an AtomSpace snapshot");
+	uint64_t version = rd.varint();
+	if (SNAPSHOT_VERSION < version)
+		throw IOException(TRACE_INFO,
+			"Snapshot version %lu is newer than this reader", version);
+	if (byte_order() != uint8_t(rd.bytes(1)[0]))
+		throw IOException(TRACE_INFO,
+			"Snapshot was written on a machine of other byte order");
+
+	std::vector<Type> types(rd.varint());
+	for (Type& t : types)
+	{
+		std::string name(rd.str());
+		t = ns.getType(name);
+		if (NOTYPE == t)
+			throw IOException(TRACE_INFO,
+				"Snapshot holds unknown type %s", name.c_str());
+	}
+
+	std::vector<std::string_view> strings(rd.varint());
+	for (std::string_view& s : strings)
+		s = rd.str();
+
+	// Atoms go in batches; later Links then hold Atoms that are
+	// already in the AtomSpace, and are added without being copied.
+	size_t natoms = rd.varint();
+	HandleSeq table;
+	table.reserve(natoms);
+	size_t base = 0;
+	auto commit = [&](void)
+	{
+		HandleSeq batch(table.begin() + base, table.end());
+		HandleSeq added(as->add_atoms(std::move(batch)));
+		for (size_t j = 0; j < added.size(); j++)
+			if (added[j]) table[base + j] = added[j];
+		base = table.size();
+	};
+
+	for (size_t i = 0; i < natoms; i++)
+	{
+		Type t = types[rd.index(types.size())];
+		if (ns.isNode(t))
+		{
+			std::string name(strings[rd.index(strings.size())]);
+			table.emplace_back(createNode(t, std::move(name)));
+		}
+		else if (ns.isLink(t))
+		{
+			HandleSeq oset(rd.varint());
+			for (Handle& ho : oset)
+				ho = table[i - 1 - rd.index(i)];
+			if (trusted)
+				table.emplace_back(createTrustedLink(std::move(oset), t));
+			else
+				table.emplace_back(createLink(std::move(oset), t));
+		}
+		else
+			throw IOException(TRACE_INFO,
+				"Snapshot holds a Value where an Atom should be");
+
+		if (BATCH_SIZE <= table.size() - base) commit();
+	}
+	commit();
+
+	size_t ngroups = rd.varint();
+	for (size_t gi = 0; gi < ngroups; gi++)
+	{
+		Type t = types[rd.index(types.size())];
+		Kind kind = Kind(rd.bytes(1)[0]);
+		size_t n = rd.varint();
+
+		std::vector<uint64_t> atoms(n);
+		for (uint64_t& a : atoms) a = rd.index(natoms);
+		std::vector<uint64_t> keys(n);
+		for (uint64_t& k : keys) k = rd.index(natoms);
+
+		std::vector<size_t> lens(n);
+		if (SEXPRS != kind)
+			for (size_t& len : lens) len = rd.varint();
+
+		for (size_t j = 0; j < n; j++)
+		{
+			ValuePtr v;
+			switch (kind)
+			{
+				case FLOATS:
+				{
+					std::vector<double> fv;
+					rd.raw(fv, lens[j]);
+					v = valueserver().create(t, std::move(fv));
+					break;
+				}
+				case FLOAT32S:
+				{
+					std::vector<float> fv;
+					rd.raw(fv, lens[j]);
+					v = valueserver().create(t, std::move(fv));
+					break;
+				}
+				case INTS:
+				{
+					std::vector<int64_t> iv;
+					rd.raw(iv, lens[j]);
+					v = valueserver().create(t, std::move(iv));
+					break;
+				}
+				case STRINGS:
+				{
+					std::vector<std::string> sv(lens[j]);
+					for (std::string& s : sv)
+						s = strings[rd.index(strings.size())];
+					v = valueserver().create(t, std::move(sv));
+					break;
+				}
+				case SEXPRS:
+				{
+					std::string sexpr(rd.str());
+					size_t pos = 0;
+					v = Sexpr::add_atoms(as, Sexpr::decode_value(sexpr, pos));
+					break;
+				}
+				default:
+					throw IOException(TRACE_INFO,
+						"Snapshot holds Values of an unknown kind");
+			}
+
+			const Handle& h = table[atoms[j]];
+			const Handle& key = table[keys[j]];
+			if (h and key and h->getAtomSpace())
+				as->set_value(h, key, v);
+		}
+	}
+
+	if (rd.bytes(sizeof(TRAILER)) != std::string_view(TRAILER, sizeof(TRAILER)))
+		throw IOException(TRACE_INFO, "Snapshot is malformed");
+
+	return table;
+}
+
+} // anonymous namespace
+
+// ==================================================================
+
+void opencog::snapshot_write(FILE* fh, const HandleSeq& hset)
+{
+	Saver saver;
+	saver.add(hset);
+	Writer w(fh);
+	saver.write(w);
+}
+
+void opencog::snapshot_write(BlockWriter& bw, const HandleSeq& hset)
+{
+	Saver saver;
+	saver.add(hset);
+	Writer w(bw);
+	saver.write(w);
+	bw.finish();
+}
+
+std::string opencog::snapshot_encode(const HandleSeq& hset)
+{
+	Saver saver;
+	saver.add(hset);
+	Writer w(nullptr);
+	saver.write(w);
+	return w.take();
+}
+
+HandleSeq opencog::snapshot_decode(std::string_view snap, AtomSpace* as,
+                                   bool trusted)
+{
+	if (BlockReader::is_blocked(snap))
+	{
+		std::string raw(BlockReader(snap).read_all());
+		Reader rd(raw);
+		return load(rd, as, trusted);
+	}
+	Reader rd(snap);
+	return load(rd, as, trusted);
+}
+
+/* ============================= END OF FILE ================= */
@@ -0,0 +1,98 @@
+/*
+ * FUNCTION:
+ * The binary snapshot encoding of Atoms and their Values.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SNAPSHOT_H
+#define _OPENCOG_SNAPSHOT_H
+
+#include <stdio.h>
+#include <string>
+#include <string_view>
+
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+class AtomSpace;
+class BlockWriter;
+
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * A compact binary encoding of a set of Atoms, together with all of
+ * the Atoms below them, and all of their Values. It is what the
+ * SnapshotStorageNode writes to disk; it can also be handed, as a
+ * single buffer, to and from other languages.
+ *
+ * A snapshot holds, in order:
+ * -- a header: the magic `ATOMSNAP`, a format version, a byte-order
+ *    mark;
+ * -- the names of all the types used, by Atoms and by Values;
+ * -- all the strings: Node names, and those inside of StringValues,
+ *    each once;
+ * -- all the Atoms: those asked for, all those below them, and the
+ *    keys of their Values, in an order where every Atom comes after
+ *    the Atoms in its outgoing set. A Node is a type and a string; a Link is a
+ *    type and its outgoing set, each of which says how far back in
+ *    the table that Atom is;
+ * -- the Values, in groups, one per Value type. Each group has a
+ *    column of Atoms, a column of keys, and then the Values'
+ *    contents, as raw numbers, or string indexes. Values that are
+ *    not vectors of numbers or strings are written as s-expressions.
+ * -- a trailer, `SNAPEND`.
+ *
+ * Counts and indexes are LEB128 varints; raw numbers are in the byte
+ * order of the machine that wrote them. Snapshots cannot be read on
+ * a machine of the other byte order.
+ *
+ * A snapshot can also be written compressed, in blocks; see
+ * BlockCompress.h. It is decompressed, on all cores, when decoded.
+ */
+
+/// Write the snapshot of the Atoms to the file.
+void snapshot_write(FILE*, const HandleSeq&);
+
+/// As above, compressed, in blocks. The writer is finished.
+void snapshot_write(BlockWriter&, const HandleSeq&);
+
+/// Return the snapshot of the Atoms, as a string of bytes.
+std::string snapshot_encode(const HandleSeq&);
+
+/// Add everything in the snapshot, compressed or not, to the
+/// AtomSpace. Returns all of
+/// the Atoms in it, in the order in which they were written: every
+/// Atom after all of the Atoms in its outgoing set. Throws an
+/// IOException if the snapshot is damaged.
+///
+/// Snapshots are written out only from Atoms that passed their type
+/// checks. Set `trusted`, for snapshots that are known to have been
+/// written by snapshot_write(), to skip the checks for the Links in
+/// it; they are not re-checked when added to the AtomSpace, either.
+HandleSeq snapshot_decode(std::string_view, AtomSpace*, bool trusted=false);
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_SNAPSHOT_H
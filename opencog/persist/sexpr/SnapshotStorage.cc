@@ -0,0 +1,225 @@
+/*
+ * SnapshotStorage.cc
+ * Binary snapshots of entire AtomSpaces.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/persist/storage/storage_types.h>
+
+#include "Mapping.h"
+#include "Snapshot.h"
+#include "SnapshotStorage.h"
+
+using namespace opencog;
+
+// ==================================================================
+
+SnapshotStorageNode::SnapshotStorageNode(Type t, const std::string& uri)
+	: StorageNode(t, uri)
+{
+	_open = false;
+
+	_filename = get_name();
+
+	// If the URL begins with `file://` then just strip that off.
+	if (0 == _filename.compare(0, 7, "file://"))
+		_filename = _filename.substr(7);
+}
+
+SnapshotStorageNode::~SnapshotStorageNode()
+{
+}
+
+void SnapshotStorageNode::not_supported(void)
+{
+	throw IOException(TRACE_INFO,
+		"SnapshotStorageNode only loads and stores entire AtomSpaces!");
+}
+
+void SnapshotStorageNode::erase(void)
+{
+	if (not connected())
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode %s is not open!", _filename.c_str());
+
+	int rc = unlink(_filename.c_str());
+	if (rc and ENOENT != errno)
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode cannot erase %s: %s",
+			_filename.c_str(), strerror(errno));
+}
+
+void SnapshotStorageNode::kill_data(void)
+{
+	int rc = unlink(_filename.c_str());
+	if (rc and ENOENT != errno)
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode cannot remove %s: %s",
+			_filename.c_str(), strerror(errno));
+}
+
+void SnapshotStorageNode::open(void)
+{
+	if (_open)
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode %s is already open!", _filename.c_str());
+	_open = true;
+}
+
+void SnapshotStorageNode::close(void)
+{
+	_open = false;
+}
+
+bool SnapshotStorageNode::connected(void)
+{
+	return _open;
+}
+
+Handle SnapshotStorageNode::getNode(Type, const char *)
+{
+	not_supported();
+	return Handle::UNDEFINED;
+}
+
+Handle SnapshotStorageNode::getLink(Type, const HandleSeq&)
+{
+	not_supported();
+	return Handle::UNDEFINED;
+}
+
+void SnapshotStorageNode::fetchIncomingSet(AtomSpace*, const Handle&)
+{
+	not_supported();
+}
+
+void SnapshotStorageNode::fetchIncomingByType(AtomSpace*, const Handle&, Type)
+{
+	not_supported();
+}
+
+void SnapshotStorageNode::storeAtom(const Handle&, bool)
+{
+	not_supported();
+}
+
+void SnapshotStorageNode::removeAtom(const Handle&, bool)
+{
+	not_supported();
+}
+
+void SnapshotStorageNode::storeValue(const Handle&, const Handle&)
+{
+	not_supported();
+}
+
+void SnapshotStorageNode::loadValue(const Handle&, const Handle&)
+{
+	not_supported();
+}
+
+void SnapshotStorageNode::loadType(AtomSpace*, Type)
+{
+	not_supported();
+}
+
+// The snapshot is written next to the old one, and then moved into
+// place, so that a failed store leaves the old one intact.
+void SnapshotStorageNode::storeAtomSpace(const AtomSpace* table)
+{
+	if (not connected())
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode %s is not open!", _filename.c_str());
+
+	HandleSeq hset;
+	table->get_handles_by_type(hset, ATOM, true);
+
+	std::string tmpname = _filename + ".tmp";
+	FILE* fh = fopen(tmpname.c_str(), "wb");
+	if (nullptr == fh)
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode cannot open %s: %s",
+			tmpname.c_str(), strerror(errno));
+
+	try
+	{
+		if (BlockCodec::NONE == _compress.codec)
+			snapshot_write(fh, hset);
+		else
+		{
+			BlockWriter bw(fh, _compress);
+			snapshot_write(bw, hset);
+		}
+	}
+	catch (...)
+	{
+		fclose(fh);
+		unlink(tmpname.c_str());
+		throw;
+	}
+
+	if (fclose(fh) or rename(tmpname.c_str(), _filename.c_str()))
+	{
+		unlink(tmpname.c_str());
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode cannot write %s: %s",
+			_filename.c_str(), strerror(errno));
+	}
+}
+
+void SnapshotStorageNode::loadAtomSpace(AtomSpace* table)
+{
+	if (not connected())
+		throw IOException(TRACE_INFO,
+		"SnapshotStorageNode %s is not open!", _filename.c_str());
+
+	int fd = ::open(_filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw IOException(TRACE_INFO,
+			"SnapshotStorageNode cannot open %s: %s",
+			_filename.c_str(), strerror(errno));
+
+	Mapping map;
+	struct stat st;
+	if (0 == fstat(fd, &st) and 0 < st.st_size)
+	{
+		map.len = st.st_size;
+		map.addr = mmap(nullptr, map.len, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	::close(fd);
+	if (MAP_FAILED == map.addr)
+		throw IOException(TRACE_INFO,
+			"SnapshotStorageNode cannot map %s", _filename.c_str());
+
+	madvise(map.addr, map.len, MADV_SEQUENTIAL);
+	snapshot_decode(map.view(), table);
+}
+
+DEFINE_NODE_FACTORY(SnapshotStorageNode, SNAPSHOT_STORAGE_NODE)
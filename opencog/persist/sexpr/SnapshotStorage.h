@@ -0,0 +1,107 @@
+/*
+ * FUNCTION:
+ * Binary snapshots of entire AtomSpaces.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SNAPSHOT_STORAGE_H
+#define _OPENCOG_SNAPSHOT_STORAGE_H
+
+#include <opencog/persist/api/StorageNode.h>
+
+#include "BlockCompress.h"
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * Saves and restores entire AtomSpaces, in a compact binary format.
+ * This is much faster than the s-expressions of the FileStorageNode,
+ * both ways, but it can only do whole AtomSpaces: `store-atomspace`
+ * writes a snapshot, replacing whatever was in the file, and
+ * `load-atomspace` reads one. The file is mapped, when read.
+ *
+ * The format of the file is described in Snapshot.h. Snapshots can be
+ * written compressed; see set_compression(). Loading tells the two
+ * apart by themselves.
+ */
+class SnapshotStorageNode : public StorageNode
+{
+	private:
+		std::string _filename;
+		bool _open;
+		BlockOptions _compress;
+
+		void not_supported(void);
+
+	public:
+		SnapshotStorageNode(Type t, const std::string& uri);
+		virtual ~SnapshotStorageNode();
+
+		void open(void);
+		void close(void);
+		bool connected(void); // connection to DB is alive
+
+		void kill_data(void);       // destroy DB contents
+		void create(void) { erase(); }
+		void destroy(void) { erase(); }
+		void erase(void);
+
+		// AtomStorage interface
+		Handle getNode(Type, const char *);
+		Handle getLink(Type, const HandleSeq&);
+		void fetchIncomingSet(AtomSpace*, const Handle&);
+		void fetchIncomingByType(AtomSpace*, const Handle&, Type t);
+		void storeAtom(const Handle&, bool synchronous = false);
+		void removeAtom(const Handle&, bool recursive);
+		void storeValue(const Handle&, const Handle&);
+		void loadValue(const Handle&, const Handle&);
+		void loadType(AtomSpace*, Type);
+		void barrier() {}
+
+		/// Compress the snapshots stored from now on. The default
+		/// codec, NONE, writes them as they are.
+		void set_compression(const BlockOptions& opts) { _compress = opts; }
+		const BlockOptions& get_compression(void) const { return _compress; }
+
+		// Large-scale loads and saves
+		void loadAtomSpace(AtomSpace*); // Load entire contents of DB
+		void storeAtomSpace(const AtomSpace*); // Store all of AtomSpace
+
+		static Handle factory(const Handle&);
+};
+
+typedef std::shared_ptr<SnapshotStorageNode> SnapshotStorageNodePtr;
+static inline SnapshotStorageNodePtr SnapshotStorageNodeCast(const Handle& h)
+   { return std::dynamic_pointer_cast<SnapshotStorageNode>(h); }
+static inline SnapshotStorageNodePtr SnapshotStorageNodeCast(AtomPtr a)
+   { return std::dynamic_pointer_cast<SnapshotStorageNode>(a); }
+
+#define createSnapshotStorageNode std::make_shared<SnapshotStorageNode>
+
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_SNAPSHOT_STORAGE_H
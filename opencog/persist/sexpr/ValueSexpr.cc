@@ -20,6 +20,9 @@
  * Free Software Foundation, Inc.,
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
+#include <stdio.h>
+
+#include <charconv>
 #include <iomanip>
 
 #include <opencog/atoms/base/Atom.h>
@@ -39,13 +42,13 @@ using namespace opencog;
  * or 'ConceptNode (symbol) starting at location `pos` in `tna`.
  * Return the type and update `pos` to point after the typename.
  */
-Type Sexpr::decode_type(const std::string& tna, size_t& pos)
+Type Sexpr::decode_type(std::string_view tna, size_t& pos)
 {
 	// Advance past whitespace.
 	pos = tna.find_first_not_of(" \n\t", pos);
 	if (std::string::npos == pos)
 		throw SyntaxException(TRACE_INFO, "Bad Type >>%s<<",
-			tna.substr(pos).c_str());
+			std::string(tna).c_str());
 
 	// Advance to next whitespace.
 	size_t nos = tna.find_first_of(") \n\t", pos);
@@ -56,10 +59,11 @@ Type Sexpr::decode_type(const std::string& tna, size_t& pos)
 	if ('\'' == tna[pos]) pos++;
 	if ('"' == tna[pos]) { pos++; sos--; }
 
-	Type t = nameserver().getType(tna.substr(pos, sos-pos));
+	const std::string tname(tna.substr(pos, sos-pos));
+	Type t = nameserver().getType(tname);
 	if (NOTYPE == t)
 		throw SyntaxException(TRACE_INFO, "Unknown Type >>%s<<",
-			tna.substr(pos, sos-pos).c_str());
+			tname.c_str());
 
 	pos = nos;
 	return t;
@@ -189,6 +193,36 @@ ValuePtr Sexpr::decode_value(const std::string& stv, size_t& pos)
 		return valueserver().create(vtype, fv);
 	}
 
+	// Single-precision floats round-trip exactly through a double.
+	if (nameserver().isA(vtype, FLOAT32_VALUE))
+	{
+		std::vector<double> fv;
+		while (vos < totlen and stv[vos] != ')')
+		{
+			size_t epos;
+			fv.push_back(stod(stv.substr(vos), &epos));
+			vos += epos;
+		}
+		pos = vos + 1;
+
+		return valueserver().create(vtype, fv);
+	}
+
+	// Integers are parsed as integers, so that big counts stay exact.
+	if (nameserver().isA(vtype, INT_VALUE))
+	{
+		std::vector<int64_t> iv;
+		while (vos < totlen and stv[vos] != ')')
+		{
+			size_t epos;
+			iv.push_back(stoll(stv.substr(vos), &epos));
+			vos += epos;
+		}
+		pos = vos + 1;
+
+		return valueserver().create(vtype, iv);
+	}
+
 	// Unescape escaped quotes
 	if (nameserver().isA(vtype, STRING_VALUE))
 	{
@@ -320,156 +354,250 @@ void Sexpr::decode_slist(const Handle& atom,
 }
 
 /* ================================================================== */
-// Atom printers that do NOT print associated Values.
+// Printers. These all append to the end of the string they are
+// given, so that one buffer, growing to the size of the largest
+// expression, can be reused for many.
 
-static std::string prt_node(const Handle& h)
+static inline void prt_type(std::string& out, Type t)
 {
-	std::stringstream ss;
-	ss << "(" << nameserver().getTypeName(h->get_type())
-		<< " " << std::quoted(h->get_name()) << ")";
-
-	return ss.str();
+	out += '(';
+	out += nameserver().getTypeName(t);
 }
 
-static std::string prt_atom(const Handle&);
+static void prt_quoted(std::string& out, const std::string& str)
+{
+	out += '"';
+	if (std::string::npos == str.find_first_of("\"\\"))
+		out += str;
+	else
+		for (char c : str)
+		{
+			if ('"' == c or '\\' == c) out += '\\';
+			out += c;
+		}
+	out += '"';
+}
 
-static std::string prt_link(const Handle& h)
+// The shortest string that reads back as the same double.
+static inline void prt_double(std::string& out, double d)
 {
-	std::string txt = "(" + nameserver().getTypeName(h->get_type()) + " ";
-	for (const Handle& ho : h->getOutgoingSet())
-		txt += prt_atom(ho);
-	txt += ")";
-	return txt;
+	char buf[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	std::to_chars_result rc = std::to_chars(buf, buf + sizeof(buf), d);
+	out.append(buf, rc.ptr - buf);
+#else
+	int n = snprintf(buf, sizeof(buf), "%.17g", d);
+	out.append(buf, n);
+#endif
 }
 
-static std::string prt_atom(const Handle& h)
+// Atom printers that do NOT print associated Values.
+
+static void prt_atom(std::string& out, const Handle& h)
 {
-	if (h->is_node()) return prt_node(h);
-	return prt_link(h);
+	prt_type(out, h->get_type());
+	out += ' ';
+	if (h->is_node())
+		prt_quoted(out, h->get_name());
+	else
+		for (const Handle& ho : h->getOutgoingSet())
+			prt_atom(out, ho);
+	out += ')';
 }
 
 /// Convert the Atom into a string. It does NOT print any of the
 /// associated values; use `dump_atom()` to get those.
+void Sexpr::encode_atom(std::string& out, const Handle& h)
+{
+	prt_atom(out, h);
+}
+
 std::string Sexpr::encode_atom(const Handle& h)
 {
-	return prt_atom(h);
+	std::string out;
+	prt_atom(out, h);
+	return out;
 }
 
 /// Convert value (or Atom) into a string.
-std::string Sexpr::encode_value(const ValuePtr& v)
+void Sexpr::encode_value(std::string& out, const ValuePtr& v)
 {
 	// Empty values are used to erase keys from atoms.
-	if (nullptr == v) return " #f";
+	if (nullptr == v) { out += " #f"; return; }
 
-	if (nameserver().isA(v->get_type(), FLOAT_VALUE))
+	Type t = v->get_type();
+
+	// The history, not just the current readings.
+	if (TIME_SERIES_VALUE == t)
 	{
-		// The FloatValue to_string() method prints out a high-precision
-		// form of the value, as compared to SimpleTruthValue, which
-		// only prints 6 digits and breaks the unit tests.
-		FloatValuePtr fv(FloatValueCast(v));
-		return fv->FloatValue::to_string();
+		out += v->to_string();
+		return;
+	}
+
+	// Full precision, unlike the SimpleTruthValue print methods,
+	// which print only 6 digits, and break the unit tests.
+	if (nameserver().isA(t, FLOAT_VALUE))
+	{
+		prt_type(out, t);
+		for (double d : FloatValueCast(v)->value())
+		{
+			out += ' ';
+			prt_double(out, d);
+		}
+		out += ')';
+		return;
+	}
+
+	if (STRING_VALUE == t)
+	{
+		prt_type(out, t);
+		for (const std::string& str : StringValueCast(v)->value())
+		{
+			out += ' ';
+			prt_quoted(out, str);
+		}
+		out += ')';
+		return;
 	}
 
 	if (not v->is_atom())
-		return v->to_short_string();
-	return prt_atom(HandleCast(v));
+	{
+		out += v->to_short_string();
+		return;
+	}
+	prt_atom(out, HandleCast(v));
+}
+
+std::string Sexpr::encode_value(const ValuePtr& v)
+{
+	std::string out;
+	encode_value(out, v);
+	return out;
 }
 
 /* ================================================================== */
 
 /// Get all of the values on an Atom and print them as an
 /// association list.
-std::string Sexpr::encode_atom_values(const Handle& h)
+void Sexpr::encode_atom_values(std::string& out, const Handle& h)
 {
-	std::stringstream rv;
-
-	rv << "(alist ";
+	out += "(alist ";
 	for (const Handle& k: h->getKeys())
 	{
-		ValuePtr p = h->getValue(k);
-		rv << "(cons " << prt_atom(k) << encode_value(p) << ")";
+		out += "(cons ";
+		prt_atom(out, k);
+		encode_value(out, h->getValue(k));
+		out += ')';
 	}
-	rv << ")";
-	return rv.str();
+	out += ')';
 }
 
-/* ================================================================== */
-// Atom printers that encode ALL associated Values.
-
-static std::string dump_node(const Handle& h)
+std::string Sexpr::encode_atom_values(const Handle& h)
 {
-	std::stringstream ss;
-	ss << "(" << nameserver().getTypeName(h->get_type())
-		<< " " << std::quoted(h->get_name());
-
-	if (h->haveValues())
-		ss << " " << Sexpr::encode_atom_values(h);
-
-	ss << ")";
-
-	return ss.str();
+	std::string out;
+	encode_atom_values(out, h);
+	return out;
 }
 
-static std::string dump_link(const Handle& h)
+/* ================================================================== */
+// Atom printers that encode ALL associated Values.
+
+/// Print the Atom, and all of the values attached to it.
+/// Similar to `encode_atom()`, except that it also prints the values.
+/// Values on going Atoms in a Link are NOT dumped!
+/// This is in order to avoid duplication.
+void Sexpr::dump_atom(std::string& out, const Handle& h)
 {
-	std::string txt = "(" + nameserver().getTypeName(h->get_type()) + " ";
-	for (const Handle& ho : h->getOutgoingSet())
-		txt += prt_atom(ho);
+	prt_type(out, h->get_type());
+	out += ' ';
+	if (h->is_node())
+		prt_quoted(out, h->get_name());
+	else
+		for (const Handle& ho : h->getOutgoingSet())
+			prt_atom(out, ho);
 
 	if (h->haveValues())
 	{
-		txt += " ";
-		txt += Sexpr::encode_atom_values(h);
+		out += ' ';
+		encode_atom_values(out, h);
 	}
-
-	txt += ")";
-	return txt;
+	out += ')';
 }
 
-/// Print the Atom, and all of the values attached to it.
-/// Similar to `encode_atom()`, except that it also prints the values.
-/// Values on going Atoms in a Link are NOT dumped!
-/// This is in order to avoid duplication.
 std::string Sexpr::dump_atom(const Handle& h)
 {
-	if (h->is_node()) return dump_node(h);
-	return dump_link(h);
+	std::string out;
+	dump_atom(out, h);
+	return out;
 }
 
 /* ================================================================== */
 // Atom printers that encode only one associated Value.
 
-static std::string dump_vnode(const Handle& h, const Handle& key)
+/// Print the Atom, and just one of the values attached to it. If there
+/// is no value at the key, it is printed as #f.
+void Sexpr::dump_vatom(std::string& out, const Handle& h, const Handle& key)
 {
-	std::stringstream ss;
-	ss << "(" << nameserver().getTypeName(h->get_type())
-		<< " " << std::quoted(h->get_name());
-
-	ValuePtr p = h->getValue(key);
-	if (nullptr != p)
-		ss << " (alist (cons " << prt_atom(key) << Sexpr::encode_value(p) << ")))";
-
-	return ss.str();
+	prt_type(out, h->get_type());
+	out += ' ';
+	if (h->is_node())
+		prt_quoted(out, h->get_name());
+	else
+		for (const Handle& ho : h->getOutgoingSet())
+			prt_atom(out, ho);
+
+	out += " (alist (cons ";
+	prt_atom(out, key);
+	encode_value(out, h->getValue(key));
+	out += ")))";
 }
 
-static std::string dump_vlink(const Handle& h, const Handle& key)
+std::string Sexpr::dump_vatom(const Handle& h, const Handle& key)
 {
-	std::string txt = "(" + nameserver().getTypeName(h->get_type()) + " ";
-	for (const Handle& ho : h->getOutgoingSet())
-		txt += prt_atom(ho);
+	std::string out;
+	dump_vatom(out, h, key);
+	return out;
+}
 
-	ValuePtr p = h->getValue(key);
-	if (nullptr != p)
-		txt += " (alist (cons " + prt_atom(key) + Sexpr::encode_value(p) + ")))";
+/* ================================================================== */
+// Atom printers that encode Values taken earlier.
 
-	return txt;
+/// Get all of the values on an Atom, as they are right now.
+Sexpr::KeyValues Sexpr::get_values(const Handle& h)
+{
+	KeyValues kvs;
+	for (const Handle& k: h->getKeys())
+		kvs.emplace_back(k, h->getValue(k));
+	return kvs;
 }
 
-/// Print the Atom, and just one of the values attached to it.
-std::string Sexpr::dump_vatom(const Handle& h, const Handle& key)
+/// Print the Atom, and the given values, instead of the ones that it
+/// holds now. With exactly one value, this prints the same thing as
+/// `dump_vatom()`; with all of them, the same thing as `dump_atom()`.
+void Sexpr::dump_atom(std::string& out, const Handle& h,
+                      const KeyValues& kvs)
 {
-	if (h->is_node()) return dump_vnode(h, key);
-	return dump_vlink(h, key);
+	prt_type(out, h->get_type());
+	out += ' ';
+	if (h->is_node())
+		prt_quoted(out, h->get_name());
+	else
+		for (const Handle& ho : h->getOutgoingSet())
+			prt_atom(out, ho);
+
+	if (0 < kvs.size())
+	{
+		out += " (alist ";
+		for (const auto& kv: kvs)
+		{
+			out += "(cons ";
+			prt_atom(out, kv.first);
+			encode_value(out, kv.second);
+			out += ')';
+		}
+		out += ')';
+	}
+	out += ')';
 }
 
 /* ================================================================== */
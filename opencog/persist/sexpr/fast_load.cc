@@ -23,18 +23,78 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_set>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <opencog/atoms/pattern/PatternLink.h>
 #include <opencog/atomspace/AtomSpace.h>
 
+#include "BlockCompress.h"
 #include "fast_load.h"
+#include "Mapping.h"
 #include "Sexpr.h"
 
 using namespace opencog;
 
+// The FileStorageNode journals removals as `(cog-extract! ATOM)` or
+// `(cog-extract-recursive! ATOM)`, which is also what the scheme
+// shell would do with them.
+static bool is_removal(std::string_view s, size_t l)
+{
+    return 0 == s.compare(l, 13, "(cog-extract!") or
+        0 == s.compare(l, 23, "(cog-extract-recursive!");
+}
+
+// The Atom to be removed, not in any AtomSpace.
+static Handle removed_atom(std::string_view s, size_t l, size_t r,
+                           size_t line_cnt)
+{
+    size_t il = s.find('(', l + 1);
+    size_t ir = s.rfind(')', r - 1);
+    if (std::string_view::npos == il or r <= il or
+        std::string_view::npos == ir or ir < il)
+        throw std::runtime_error(
+            "Syntax error at line " + std::to_string(line_cnt) +
+            " Expecting an Atom to remove: >>" +
+            std::string(s.substr(l, r - l + 1)) + "<<");
+
+    return Sexpr::decode_atom(s.substr(il, ir - il + 1), 0, ir - il, line_cnt);
+}
+
+static void remove_atom(std::string_view s, size_t l, size_t r,
+                        size_t line_cnt, AtomSpace& as)
+{
+    bool recursive = (0 == s.compare(l, 23, "(cog-extract-recursive!"));
+    Handle h(as.get_atom(removed_atom(s, l, r, line_cnt)));
+    if (h) as.extract_atom(h, recursive);
+}
+
+Handle opencog::decode_expr(std::string_view expr, size_t line_cnt,
+                            bool& removal)
+{
+    removal = is_removal(expr, 0);
+    if (removal)
+        return removed_atom(expr, 0, expr.size() - 1, line_cnt);
+    return Sexpr::decode_atom(expr, 0, expr.size() - 1, line_cnt);
+}
+
 Handle opencog::parseStream(std::istream& in, AtomSpace& as)
 {
     Handle h;
@@ -70,7 +130,10 @@ Handle opencog::parseStream(std::istream& in, AtomSpace& as)
                 break;
 
             expr_cnt++;
-            h = as.add_atom(Sexpr::decode_atom(expr, l, r, line_cnt));
+            if (is_removal(expr, l))
+                remove_atom(expr, l, r, line_cnt, as);
+            else
+                h = as.add_atom(Sexpr::decode_atom(expr, l, r, line_cnt));
             expr = expr.substr(r + 1);
         }
     }
@@ -82,16 +145,604 @@ Handle opencog::parseStream(std::istream& in, AtomSpace& as)
     return h;
 }
 
+// ---------------------------------------------------------------
+// Parallel loading.
+//
+// A single reader finds the top-level expressions, exactly as above,
+// and hands them out in chunks. Workers decode the chunks, and add the
+// Atoms with add_atoms(). Atoms without Values can be added in any
+// order at all. Atoms that carry Values (or have Atoms under them that
+// do) are added one chunk at a time, in file order, so that, if the
+// same Atom appears more than once, the last Value read is the one
+// that sticks, as it does when loading on one thread. Removals wait
+// for everything before them to be added.
+
+#define CHUNK_SIZE (1UL << 20)
+
+namespace {
+
+// An expression is either in the text of the chunk, or, when loading
+// from a buffer, in the buffer itself.
+struct Span
+{
+    size_t l;
+    size_t r;
+    size_t line;
+    bool owned;
+};
+
+struct Chunk
+{
+    size_t seq = 0;
+    std::string text;
+    std::string_view base;
+    std::vector<Span> spans;
+    size_t bytes = 0;
+
+    Handle decode(const Span& sp) const
+    {
+        std::string_view s(sp.owned ? std::string_view(text) : base);
+        return Sexpr::decode_atom(s.substr(sp.l, sp.r - sp.l + 1),
+                                  0, sp.r - sp.l, sp.line);
+    }
+};
+
+// Collect the Atoms, at or under h, that carry Values.
+void valued_atoms(const Handle& h, HandleSeq& out)
+{
+    if (h->haveValues()) out.emplace_back(h);
+    if (not h->is_link()) return;
+    for (const Handle& ho : h->getOutgoingSet())
+        valued_atoms(ho, out);
+}
+
+class ParallelLoader
+{
+    AtomSpace& _as;
+    std::vector<std::thread> _workers;
+
+    std::mutex _mtx;
+    std::condition_variable _have_work;
+    std::condition_variable _have_room;
+    std::condition_variable _next_turn;
+
+    std::deque<Chunk> _chunks;
+    size_t _max_chunks;
+    Chunk _chunk;
+    size_t _nchunks = 0;
+
+    // The seq of the next chunk that may add its valued Atoms.
+    size_t _turn = 0;
+
+    bool _done = false;
+    bool _abort = false;
+    std::exception_ptr _error;
+    Handle _last;
+
+    void work(void);
+    void load(Chunk&);
+    void fail(std::exception_ptr);
+
+public:
+    ParallelLoader(AtomSpace&, size_t, std::string_view = std::string_view());
+    ~ParallelLoader();
+
+    bool add(std::string_view, size_t, size_t, size_t);
+    bool add_span(size_t, size_t, size_t);
+    bool flush(void);
+    bool sync(void);
+    Handle finish(void);
+};
+
+ParallelLoader::ParallelLoader(AtomSpace& as, size_t nthreads,
+                               std::string_view base) :
+    _as(as), _max_chunks(2 * nthreads)
+{
+    _chunk.base = base;
+    for (size_t i = 0; i < nthreads; i++)
+        _workers.emplace_back(&ParallelLoader::work, this);
+}
+
+ParallelLoader::~ParallelLoader()
+{
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        _abort = true;
+    }
+    _have_work.notify_all();
+    _next_turn.notify_all();
+    for (std::thread& t : _workers)
+        if (t.joinable()) t.join();
+}
+
+void ParallelLoader::fail(std::exception_ptr ex)
+{
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (nullptr == _error) _error = ex;
+        _abort = true;
+    }
+    _have_work.notify_all();
+    _have_room.notify_all();
+    _next_turn.notify_all();
+}
+
+/// Add a copy of the expression at [l, r] of s to the current chunk.
+/// Returns false if loading was stopped by an error.
+bool ParallelLoader::add(std::string_view s, size_t l, size_t r,
+                         size_t line_cnt)
+{
+    size_t off = _chunk.text.size();
+    _chunk.text.append(s.substr(l, r - l + 1));
+    _chunk.spans.push_back({off, off + r - l, line_cnt, true});
+    _chunk.bytes += r - l + 1;
+
+    if (_chunk.bytes < CHUNK_SIZE) return true;
+    return flush();
+}
+
+/// Add the expression at [l, r] of the base buffer, without copying.
+bool ParallelLoader::add_span(size_t l, size_t r, size_t line_cnt)
+{
+    _chunk.spans.push_back({l, r, line_cnt, false});
+    _chunk.bytes += r - l + 1;
+
+    if (_chunk.bytes < CHUNK_SIZE) return true;
+    return flush();
+}
+
+bool ParallelLoader::flush(void)
+{
+    if (_chunk.spans.empty()) return true;
+
+    _chunk.seq = _nchunks++;
+    {
+        std::unique_lock<std::mutex> lck(_mtx);
+        _have_room.wait(lck, [&] {
+            return _chunks.size() < _max_chunks or _abort; });
+        if (_abort) return false;
+        _chunks.emplace_back(std::move(_chunk));
+    }
+    _have_work.notify_one();
+
+    std::string_view base(_chunk.base);
+    _chunk = Chunk();
+    _chunk.base = base;
+    return true;
+}
+
+/// Wait until everything added so far is in the AtomSpace.
+/// Returns false if loading was stopped by an error.
+bool ParallelLoader::sync(void)
+{
+    if (not flush()) return false;
+
+    std::unique_lock<std::mutex> lck(_mtx);
+    _next_turn.wait(lck, [&] { return _turn == _nchunks or _abort; });
+    return not _abort;
+}
+
+Handle ParallelLoader::finish(void)
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        _done = true;
+    }
+    _have_work.notify_all();
+    for (std::thread& t : _workers) t.join();
+
+    if (_error) std::rethrow_exception(_error);
+    return _last;
+}
+
+void ParallelLoader::work(void)
+{
+    while (true)
+    {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lck(_mtx);
+            _have_work.wait(lck, [&] {
+                return not _chunks.empty() or _done or _abort; });
+            if (_abort or _chunks.empty()) return;
+            chunk = std::move(_chunks.front());
+            _chunks.pop_front();
+        }
+        _have_room.notify_one();
+
+        try { load(chunk); }
+        catch (...)
+        {
+            fail(std::current_exception());
+            return;
+        }
+    }
+}
+
+void ParallelLoader::load(Chunk& chunk)
+{
+    HandleSeq plain;
+    HandleSeq valued;
+    HandleSeq carriers;
+    bool last_plain = true;
+    for (const Span& sp : chunk.spans)
+    {
+        Handle h(chunk.decode(sp));
+
+        size_t nv = carriers.size();
+        valued_atoms(h, carriers);
+        last_plain = (nv == carriers.size());
+        if (last_plain) plain.emplace_back(h);
+        else valued.emplace_back(h);
+    }
+
+    Handle last;
+    if (not plain.empty())
+    {
+        HandleSeq added(_as.add_atoms(std::move(plain)));
+        if (last_plain) last = added.back();
+    }
+
+    // In the bulk add, Atoms are not added in order; if the same Atom
+    // carries Values more than once in this chunk, add them one by one.
+    bool repeats = false;
+    std::unordered_set<Handle> uniq;
+    for (const Handle& h : carriers)
+        if (not uniq.insert(h).second) { repeats = true; break; }
+
+    {
+        std::unique_lock<std::mutex> lck(_mtx);
+        _next_turn.wait(lck, [&] { return _turn == chunk.seq or _abort; });
+        if (_abort) return;
+    }
+
+    if (repeats)
+    {
+        for (const Handle& h : valued)
+            last = _as.add_atom(h);
+    }
+    else if (not valued.empty())
+    {
+        HandleSeq added(_as.add_atoms(std::move(valued)));
+        if (not last_plain) last = added.back();
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        _turn++;
+        _last = last;
+    }
+    _next_turn.notify_all();
+}
+
+} // anonymous namespace
+
+Handle opencog::parseStream(std::istream& in, AtomSpace& as,
+                            size_t nthreads)
+{
+    if (0 == nthreads) nthreads = std::thread::hardware_concurrency();
+    if (nthreads <= 1) return parseStream(in, as);
+
+    ParallelLoader loader(as, nthreads);
+
+    size_t line_cnt = 0;
+    int pcount = 0;
+    bool more = true;
+
+    std::string expr;
+    while (!in.eof())
+    {
+        std::string line;
+        std::getline(in, line);
+        line_cnt++;
+        expr += line;
+
+        size_t l = 0;
+        while (true)
+        {
+            size_t r = expr.length();
+            pcount = Sexpr::get_next_expr(expr, l, r, line_cnt);
+
+            // Keep the unfinished expression for the next line.
+            if (0 < pcount)
+            {
+                expr = expr.substr(l, r - l);
+                break;
+            }
+
+            if (l == r)
+            {
+                expr.clear();
+                break;
+            }
+
+            if (is_removal(expr, l))
+            {
+                more = loader.sync();
+                if (more) remove_atom(expr, l, r, line_cnt, as);
+            }
+            else
+                more = loader.add(expr, l, r, line_cnt);
+            if (not more) break;
+            l = r + 1;
+        }
+        if (not more) break;
+    }
+
+    // If a worker failed, report that, instead.
+    if (more and 0 < pcount)
+        throw std::runtime_error(
+            "Unbalanced parenthesis >>" + expr + "<<");
+
+    return loader.finish();
+}
+
+// ---------------------------------------------------------------
+// Loading from memory.
+//
+// The buffer is scanned in place. Expressions are decoded straight out
+// of it; nothing is copied, except for the names of the Nodes, when
+// the Nodes are made. The rare expression with a comment inside of it
+// is copied, minus the comment, as the decoder cannot skip comments.
+
+/// Find the end of the expression starting at `l`. Like
+/// Sexpr::get_next_expr(), except that comments are skipped, instead
+/// of ending the scan.
+static int expr_end(std::string_view buf, size_t l, size_t& r,
+                    bool& commented)
+{
+    size_t n = buf.size();
+    size_t p = l;
+    int count = 1;
+    bool quoted = false;
+    while (++p < n)
+    {
+        char c = buf[p];
+
+        // Skip over any escapes
+        if (c == '\\') { p ++; continue; }
+
+        if (c == '"') quoted = !quoted;
+        else if (quoted) continue;
+        else if (c == '(') count++;
+        else if (c == ')') { if (0 == --count) break; }
+        else if (c == ';')
+        {
+            commented = true;
+            p = buf.find('\n', p);
+            if (std::string_view::npos == p) p = n;
+        }
+    }
+    r = std::min(p, n);
+    return count;
+}
+
+/// Copy the expression in [l, r], leaving out the comments.
+static std::string uncomment(std::string_view buf, size_t l, size_t r)
+{
+    std::string expr;
+    expr.reserve(r - l + 1);
+    bool quoted = false;
+    for (size_t p = l; p <= r; p++)
+    {
+        char c = buf[p];
+        if (c == '\\' and p < r) { expr += c; expr += buf[++p]; continue; }
+        if (c == '"') quoted = !quoted;
+        else if (c == ';' and not quoted)
+        {
+            p = buf.find('\n', p);
+            if (std::string_view::npos == p or r < p) p = r;
+            continue;
+        }
+        expr += c;
+    }
+    return expr;
+}
+
+void opencog::scan_buffer(std::string_view buf, const ExprFunc& fn)
+{
+    size_t n = buf.size();
+    size_t pos = 0;
+    size_t line_cnt = 1;
+    size_t counted = 0;
+    while (pos < n)
+    {
+        // Advance past whitespace and comments.
+        char c = buf[pos];
+        if (c == ' ' or c == '\t' or c == '\n') { pos++; continue; }
+        if (c == ';')
+        {
+            pos = buf.find('\n', pos);
+            if (std::string_view::npos == pos) break;
+            continue;
+        }
+
+        line_cnt += std::count(buf.begin() + counted, buf.begin() + pos, '\n');
+        counted = pos;
+
+        if (c != '(')
+            throw std::runtime_error(
+                "Syntax error at line " + std::to_string(line_cnt) +
+                " Unexpected text: >>" + std::string(buf.substr(pos, 80)) + "<<");
+
+        size_t r;
+        bool commented = false;
+        if (0 < expr_end(buf, pos, r, commented))
+            throw std::runtime_error(
+                "Unbalanced parenthesis >>" +
+                std::string(buf.substr(pos, 80)) + "<<");
+
+        bool more;
+        if (commented)
+        {
+            std::string expr(uncomment(buf, pos, r));
+            more = fn(expr, pos, r - pos + 1, line_cnt);
+        }
+        else
+            more = fn(buf.substr(pos, r - pos + 1), pos, r - pos + 1, line_cnt);
+        if (not more) break;
+        pos = r + 1;
+    }
+}
+
+Handle opencog::parseBuffer(std::string_view buf, AtomSpace& as,
+                            size_t nthreads)
+{
+    if (0 == nthreads) nthreads = std::thread::hardware_concurrency();
+
+    std::unique_ptr<ParallelLoader> loader;
+    if (1 < nthreads)
+        loader.reset(new ParallelLoader(as, nthreads, buf));
+
+    Handle h;
+    scan_buffer(buf, [&](std::string_view expr, size_t off, size_t len,
+                         size_t line_cnt)
+    {
+        size_t r = expr.size() - 1;
+        if (is_removal(expr, 0))
+        {
+            if (loader and not loader->sync()) return false;
+            remove_atom(expr, 0, r, line_cnt, as);
+            return true;
+        }
+
+        // Expressions that were copied, to strip comments, have to be
+        // copied into the chunk; the rest can be decoded in place.
+        if (loader)
+        {
+            if (expr.data() != buf.data() + off)
+                return loader->add(expr, 0, r, line_cnt);
+            return loader->add_span(off, off + len - 1, line_cnt);
+        }
+
+        h = as.add_atom(Sexpr::decode_atom(expr, 0, r, line_cnt));
+        return true;
+    });
+
+    if (loader) return loader->finish();
+    return h;
+}
+
 /// load_file -- load the given file into the given AtomSpace.
 void opencog::load_file(const std::string& fname, AtomSpace& as)
 {
-    std::ifstream f(fname);
-    if (not f.is_open())
+    load_file(fname, as, 1);
+}
+
+void opencog::load_file(const std::string& fname, AtomSpace& as,
+                        size_t nthreads)
+{
+    // Patterns in the file are analyzed when they are run.
+    PatternLink::Deferral defer;
+
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
         throw std::runtime_error("Cannot find file >>" + fname + "<<");
 
-    parseStream(f, as);
-    
-    f.close();
+    // Pipes and the like cannot be mapped; read those.
+    struct stat st;
+    if (0 != fstat(fd, &st) or not S_ISREG(st.st_mode))
+    {
+        close(fd);
+        std::ifstream f(fname);
+        if (not f.is_open())
+            throw std::runtime_error("Cannot find file >>" + fname + "<<");
+        parseStream(f, as, nthreads);
+        return;
+    }
+
+    Mapping map;
+    map.len = st.st_size;
+    if (0 < map.len)
+        map.addr = mmap(nullptr, map.len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (0 == map.len) return;
+    if (MAP_FAILED == map.addr)
+        throw std::runtime_error("Cannot map file >>" + fname + "<<");
+
+    madvise(map.addr, map.len, MADV_SEQUENTIAL);
+    std::string_view buf((const char*) map.addr, map.len);
+    if (not BlockReader::is_blocked(buf))
+    {
+        parseBuffer(buf, as, nthreads);
+        return;
+    }
+
+    // Blocks end between expressions, so that each can be loaded on
+    // its own. They are decompressed a few at a time, in parallel,
+    // and loaded in file order.
+    BlockReader rd(buf);
+    if (0 == nthreads) nthreads = std::thread::hardware_concurrency();
+    if (0 == nthreads) nthreads = 1;
+    for (size_t i = 0; i < rd.size(); i += nthreads)
+        parseBuffer(rd.read(i, i + nthreads, nthreads), as, nthreads);
+}
+
+// Samples for training the dictionary are taken from this many of
+// the first Atoms written.
+#define DICT_SAMPLES 20000
+
+void opencog::dump_file(const std::string& fname, const AtomSpace& as,
+                        const BlockOptions& opts, bool train)
+{
+    HandleSeq hset;
+    as.get_handles_by_type(hset, ATOM, true);
+
+    // Write the roots, and the Atoms that have Values; all other Atoms
+    // appear in their outgoing sets.
+    auto wanted = [](const Handle& h)
+    {
+        return h->haveValues() or 0 == h->getIncomingSetSize();
+    };
+
+    BlockOptions bo(opts);
+    if (train)
+    {
+        std::vector<std::string> samples;
+        for (const Handle& h : hset)
+        {
+            if (DICT_SAMPLES <= samples.size()) break;
+            if (wanted(h)) samples.emplace_back(Sexpr::dump_atom(h) + '\n');
+        }
+        bo.dictionary = train_dictionary(samples, bo.codec);
+    }
+
+    // Written next to the old one, and then moved into place, so that
+    // a failed dump leaves the old one intact.
+    std::string tmpname = fname + ".tmp";
+    FILE* fh = fopen(tmpname.c_str(), "wb");
+    if (nullptr == fh)
+        throw IOException(TRACE_INFO, "Cannot open %s: %s",
+            tmpname.c_str(), strerror(errno));
+
+    try
+    {
+        BlockWriter bw(fh, bo);
+        std::string expr;
+        for (const Handle& h : hset)
+        {
+            if (not wanted(h)) continue;
+            expr.clear();
+            Sexpr::dump_atom(expr, h);
+            expr += '\n';
+            bw.write(expr);
+        }
+        bw.finish();
+    }
+    catch (...)
+    {
+        fclose(fh);
+        unlink(tmpname.c_str());
+        throw;
+    }
+
+    if (fclose(fh) or rename(tmpname.c_str(), fname.c_str()))
+    {
+        unlink(tmpname.c_str());
+        throw IOException(TRACE_INFO, "Cannot write %s: %s",
+            fname.c_str(), strerror(errno));
+    }
 }
 
 // Parse an Atomese string expression and return a Handle to the parsed atom
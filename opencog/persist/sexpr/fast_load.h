@@ -26,9 +26,12 @@
 #ifndef FAST_LOAD_H
 #define FAST_LOAD_H
 
+#include <functional>
 #include <istream>
 #include <string>
+#include <string_view>
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/persist/sexpr/BlockCompress.h>
 
 namespace opencog
 {
@@ -36,6 +39,44 @@ namespace opencog
 
     Handle parseExpression(const std::string& expr, AtomSpace&);
     Handle parseStream(std::istream&, AtomSpace&);
+
+    /// As above, but the expressions are decoded and added on
+    /// `nthreads` threads; zero means one per core. The Atoms are
+    /// added in bulk, and so are reported by the atomsAddedSignal().
+    /// Where the same Atom is given Values more than once, the last
+    /// one in the file wins, as it does when loading on one thread.
+    /// Removals, as journaled by the FileStorageNode, are applied in
+    /// file order, too.
+    void load_file(const std::string& file_name, AtomSpace&,
+                   size_t nthreads);
+    Handle parseStream(std::istream&, AtomSpace&, size_t nthreads);
+
+    /// Write the AtomSpace to the file, as s-expressions, compressed in
+    /// blocks; see BlockCompress.h. The load_file() functions read it
+    /// back, decompressing and loading the blocks in parallel. With
+    /// `train`, a dictionary is trained on a sample of what is written,
+    /// and used instead of the one in the options.
+    void dump_file(const std::string& file_name, const AtomSpace&,
+                   const BlockOptions&, bool train = false);
+
+    /// Load the expressions in the buffer, in place, without copying
+    /// it. The load_file() functions map the file, and pass it here;
+    /// or, if it is compressed, a few blocks of it at a time.
+    Handle parseBuffer(std::string_view, AtomSpace&, size_t nthreads = 1);
+
+    /// Call `fn` on each top-level expression in the buffer, with the
+    /// offset and length of the expression in the buffer, and the line
+    /// it starts on. The expression passed is the text in the buffer,
+    /// or, if it has comments inside of it, a copy without them.
+    /// Scanning stops when `fn` returns false.
+    typedef std::function<bool(std::string_view expr, size_t off,
+                               size_t len, size_t line)> ExprFunc;
+    void scan_buffer(std::string_view, const ExprFunc&);
+
+    /// Decode one top-level expression: an Atom, not placed in any
+    /// AtomSpace, or, if `removal` is set on return, a journaled
+    /// removal of that Atom.
+    Handle decode_expr(std::string_view, size_t line, bool& removal);
 }
 
 #endif // FAST_LOAD_H
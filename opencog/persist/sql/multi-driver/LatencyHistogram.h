@@ -0,0 +1,145 @@
+/*
+ * FUNCTION:
+ * Lock-free latency histogram, for performance monitoring.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_LATENCY_HISTOGRAM_H
+#define _OPENCOG_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * Histogram of durations, in microseconds, laid out the way HDR
+ * histograms are: below 16 usecs, one bucket per usec; above that,
+ * eight buckets for each power of two. So every recorded time is
+ * known to within an eighth, from a microsecond up to hours, in a
+ * few hundred counters. Recording is one atomic add; it may be done
+ * from any number of threads at once.
+ */
+class LatencyHistogram
+{
+	static const int SUB = 8;              // Buckets per power of two.
+	static const int LINEAR = 2 * SUB;     // Below this, one per usec.
+	static const int MAX_EXP = 40;         // About 12 days.
+	static const int NBUCKETS = LINEAR + (MAX_EXP - 4) * SUB;
+
+	std::atomic<uint64_t> _buckets[NBUCKETS];
+	std::atomic<uint64_t> _count;
+	std::atomic<uint64_t> _sum;
+	std::atomic<uint64_t> _max;
+
+	static int bucket_of(uint64_t usec)
+	{
+		if (usec < LINEAR) return usec;
+		int exp = 63 - __builtin_clzll(usec);
+		if (MAX_EXP <= exp) return NBUCKETS - 1;
+		int sub = (usec >> (exp - 3)) & (SUB - 1);
+		return LINEAR + (exp - 4) * SUB + sub;
+	}
+
+	/// The largest time that falls into the bucket.
+	static uint64_t bucket_top(int b)
+	{
+		if (b < LINEAR) return b;
+		int exp = 4 + (b - LINEAR) / SUB;
+		uint64_t sub = (b - LINEAR) % SUB;
+		return ((SUB + sub + 1) << (exp - 3)) - 1;
+	}
+
+public:
+	LatencyHistogram(void) { clear(); }
+
+	void clear(void)
+	{
+		for (std::atomic<uint64_t>& b : _buckets) b = 0;
+		_count = 0;
+		_sum = 0;
+		_max = 0;
+	}
+
+	void record(uint64_t usec)
+	{
+		_buckets[bucket_of(usec)]++;
+		_count++;
+		_sum += usec;
+		uint64_t prev = _max;
+		while (prev < usec and not _max.compare_exchange_weak(prev, usec));
+	}
+
+	uint64_t count(void) const { return _count; }
+
+	/// Times are reported in seconds.
+	double sum(void) const { return 1.0e-6 * _sum; }
+	double max(void) const { return 1.0e-6 * _max; }
+
+	/// The time that a fraction `q` of the recorded times are no
+	/// longer than; to within the width of a bucket.
+	double quantile(double q) const
+	{
+		uint64_t total = _count;
+		if (0 == total) return 0.0;
+		uint64_t want = q * total;
+		if (want < 1) want = 1;
+
+		uint64_t seen = 0;
+		for (int b = 0; b < NBUCKETS; b++)
+		{
+			seen += _buckets[b];
+			if (want <= seen)
+			{
+				uint64_t top = bucket_top(b);
+				uint64_t most = _max;
+				return 1.0e-6 * (most < top ? most : top);
+			}
+		}
+		return max();
+	}
+
+	/// Records the time from its creation until it goes out of scope.
+	class Timer
+	{
+		LatencyHistogram& _hist;
+		std::chrono::steady_clock::time_point _start;
+	public:
+		Timer(LatencyHistogram& h) :
+			_hist(h), _start(std::chrono::steady_clock::now()) {}
+		~Timer()
+		{
+			auto took = std::chrono::steady_clock::now() - _start;
+			_hist.record(std::chrono::duration_cast<
+				std::chrono::microseconds>(took).count());
+		}
+	};
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_LATENCY_HISTOGRAM_H
@@ -87,12 +87,12 @@ void SQLAtomStorage::deleteSingleAtom(Response& rp, UUID uuid)
 /// unless the recursive flag is set. If the recursive flag is set, then
 /// the atom, and everything in its incoming set is removed.
 ///
-/// TODO The deletion is performed synchronously, in single-threaded
-/// fashion.  It might make sense to create a queue for this, so that
-/// if could run in parallel (in the unusual case that someone has
-/// millions of atoms to delete and is impateint about it...)
+/// Recursive removes are done as sets, on the server; see
+/// removeClosure().
 void SQLAtomStorage::removeAtom(const Handle& h, bool recursive)
 {
+	LatencyHistogram::Timer tm(_latency[OP_REMOVE_ATOM]);
+
 	// Synchronize. The atom that we are deleting might be sitting
 	// in the store queue.
 	flushStoreQueue();
@@ -132,46 +132,83 @@ void SQLAtomStorage::deleteAllValuations(Response& rp, UUID uuid)
 		deleteValuation(rp, kuid, uuid);
 }
 
+/// Remove the atom, and everything that holds it, recursively, with
+/// a handful of statements, instead of several per atom. The server
+/// finds the whole of the incoming tree with one recursive query, and
+/// keeps it in a temporary table; the Valuations, the Values that
+/// they hold, and the Atoms are then each deleted as one set. This
+/// must run inside a transaction; the table goes away at the end.
+void SQLAtomStorage::removeClosure(Response& rp, UUID uuid)
+{
+	// The closure: the atom, the links holding it, the links
+	// holding those, and so on. UNION, not UNION ALL, so that an
+	// atom reached more than one way is visited only once. Each step
+	// uses the GIN index on the outgoing sets.
+	std::string qry =
+		"CREATE TEMPORARY TABLE Doomed ON COMMIT DROP AS "
+		"WITH RECURSIVE closure(uuid) AS ("
+		" SELECT CAST(" + std::to_string(uuid) + " AS BIGINT)"
+		" UNION"
+		" SELECT a.uuid FROM Atoms a, closure c"
+		" WHERE a.outgoing @> ARRAY[c.uuid]) "
+		"SELECT uuid FROM closure;";
+	rp.exec(qry);
+
+	std::vector<UUID> uset;
+	rp.uvec = &uset;
+	rp.exec("SELECT uuid FROM Doomed;");
+	rp.rs->foreach_row(&Response::get_uuid_cb, &rp);
+
+	// The Values held by LinkValues on the doomed atoms, and the
+	// Values held by those, and so on; see deleteValue().
+	rp.exec("WITH RECURSIVE vals(vuid) AS ("
+		" SELECT u FROM Valuations v, Doomed d, unnest(v.linkvalue) AS u"
+		" WHERE v.atom = d.uuid"
+		" UNION"
+		" SELECT u FROM Values w, vals, unnest(w.linkvalue) AS u"
+		" WHERE w.vuid = vals.vuid) "
+		"DELETE FROM Values WHERE vuid IN (SELECT vuid FROM vals);");
+
+	// Valuations on the atoms, and those keyed by them; see
+	// deleteSingleAtom(). Then the atoms themselves.
+	rp.exec("DELETE FROM Valuations WHERE "
+		"atom IN (SELECT uuid FROM Doomed) OR "
+		"key IN (SELECT uuid FROM Doomed);");
+	rp.exec("DELETE FROM Atoms WHERE uuid IN (SELECT uuid FROM Doomed);");
+
+	_tlbuf.removeAtoms(uset);
+	_num_atom_deletes += uset.size();
+}
+
 void SQLAtomStorage::removeAtom(Response& rp, UUID uuid, bool recursive)
 {
+	if (recursive)
+	{
+		removeClosure(rp, uuid);
+		return;
+	}
+
 	// Verify the status of the incoming set.
 	// This uses the GIN index and so it should be fast.
 	// CREATE INDEX incoming_idx on Atoms USING GIN(outgoing);
+	//
+	// For non-recursive removes, we just want to check if there
+	// any atoms at all, in the incoming set. So just check for
+	// anything greater than zero. This check is much much faster
+	// than getting all of them.
 	char buff[BUFSZ];
-	if (recursive)
-	{
-		snprintf(buff, BUFSZ,
-			"SELECT uuid FROM Atoms WHERE outgoing @> ARRAY[CAST(%lu AS BIGINT)];",
-			uuid);
-	}
-	else
-	{
-		// For non-recursive removes, we just want to check if there
-		// any atoms at all, in the incoming set. So just check for
-		// anything greater than zero. This check is much much faster
-		// than getting all of them (above).
-		snprintf(buff, BUFSZ,
-			"SELECT uuid FROM Atoms WHERE outgoing @> ARRAY[CAST(%lu AS BIGINT)] LIMIT 1;",
-			uuid);
-	}
+	snprintf(buff, BUFSZ,
+		"SELECT uuid FROM Atoms WHERE outgoing @> ARRAY[CAST(%lu AS BIGINT)] LIMIT 1;",
+		uuid);
 
 	std::vector<UUID> uset;
 	rp.uvec = &uset;
 	rp.exec(buff);
 	rp.rs->foreach_row(&Response::get_uuid_cb, &rp);
 
-	// Knock out the incoming set, first.
-	if (recursive)
-	{
-		for (UUID iud : uset)
-			removeAtom(rp, iud, recursive);
-	}
-	else if (0 < uset.size())
-	{
-		// Non-recursive deletes with non-empty incoming sets
-		// are no-ops.
-		return;
-	}
+	// Non-recursive deletes with non-empty incoming sets
+	// are no-ops.
+	if (0 < uset.size()) return;
 
 	// Next, knock out the values.
 	deleteAllValuations(rp, uuid);
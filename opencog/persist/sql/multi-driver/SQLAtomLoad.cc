@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/base/Link.h>
@@ -63,10 +65,95 @@ SQLAtomStorage::PseudoPtr SQLAtomStorage::getAtom(const char * query, int height
 SQLAtomStorage::PseudoPtr SQLAtomStorage::petAtom(UUID uuid)
 {
 	setup_typemap();
-	char buff[BUFSZ];
-	snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE uuid = %lu;", uuid);
 
-	return getAtom(buff, -1);
+	// This is called once for every Atom in every outgoing set that
+	// is not yet known; so it is worth preparing.
+	std::string suid(std::to_string(uuid));
+	const char* params[1] = { suid.c_str() };
+
+	Response rp(conn_pool);
+	rp.uuid = TLB::INVALID_UUID;
+	rp.exec_prepared("pet_atom", "SELECT * FROM Atoms WHERE uuid = $1;",
+	                 1, params);
+	rp.rs->foreach_row(&Response::create_atom_cb, &rp);
+
+	if (rp.uuid == TLB::INVALID_UUID) return nullptr;
+
+	rp.height = -1;
+	return makeAtom(rp, rp.uuid);
+}
+
+/// Fetch many atoms, by UUID, in one query (well, one per ten
+/// thousand). UUID's that are not in the database are skipped.
+/// Note that this does NOT fetch any values!
+#define PET_BATCH 10000
+std::vector<SQLAtomStorage::PseudoPtr>
+SQLAtomStorage::petAtoms(const std::vector<UUID>& uuids)
+{
+	setup_typemap();
+
+	std::vector<PseudoPtr> pvec;
+	for (size_t i = 0; i < uuids.size(); i += PET_BATCH)
+	{
+		// The UUID's go as one array parameter, so that there is
+		// one prepared statement for any number of them.
+		std::string arr = "{";
+		size_t end = std::min(uuids.size(), i + PET_BATCH);
+		for (size_t j = i; j < end; j++)
+		{
+			if (i < j) arr += ",";
+			arr += std::to_string(uuids[j]);
+		}
+		arr += "}";
+		const char* params[1] = { arr.c_str() };
+
+		Response rp(conn_pool);
+		rp.store = this;
+		rp.height = -1;
+		rp.pvec = &pvec;
+		rp.exec_prepared("pet_atoms",
+			"SELECT * FROM Atoms WHERE uuid = ANY(CAST($1 AS BIGINT[]));",
+			1, params);
+		rp.rs->foreach_row(&Response::fetch_incoming_set_cb, &rp);
+	}
+	return pvec;
+}
+
+/// Fetch everything that the outgoing sets of these atoms refer to,
+/// all the way down, that is not yet in the TLB. This takes one
+/// round-trip to the database per level of the hypergraph, instead
+/// of one per atom; which matters a lot when the database is far
+/// away.
+void SQLAtomStorage::prefetch_outgoing(const std::vector<PseudoPtr>& pset,
+                                       PseudoMap& pmap)
+{
+	std::vector<PseudoPtr> level(pset);
+	while (not level.empty())
+	{
+		std::vector<UUID> unseen;
+		for (const PseudoPtr& p: level)
+		{
+			for (UUID idu: p->oset)
+			{
+				if (not pmap.emplace(idu, nullptr).second) continue;
+				unseen.push_back(idu);
+			}
+		}
+
+		// One TLB lookup for the lot.
+		HandleSeq known(_tlbuf.getAtoms(unseen));
+		std::vector<UUID> missing;
+		for (size_t i = 0; i < unseen.size(); i++)
+		{
+			if (known[i]) pmap.erase(unseen[i]);
+			else missing.push_back(unseen[i]);
+		}
+		if (missing.empty()) break;
+
+		level = petAtoms(missing);
+		for (const PseudoPtr& p: level)
+			pmap[p->uuid] = p;
+	}
 }
 
 /// Get the full outgoing set, recursively.
@@ -76,13 +163,26 @@ SQLAtomStorage::PseudoPtr SQLAtomStorage::petAtom(UUID uuid)
 ///
 /// Note that this does NOT fetch any values!
 Handle SQLAtomStorage::get_recursive_if_not_exists(PseudoPtr p)
+{
+	PseudoMap pmap;
+	if (not nameserver().isA(p->type, NODE))
+		prefetch_outgoing({p}, pmap);
+	return get_recursive(p, pmap);
+}
+
+/// As above, with the missing atoms already fetched, by
+/// prefetch_outgoing(). Any not found there are fetched one at a
+/// time.
+Handle SQLAtomStorage::get_recursive(PseudoPtr p, const PseudoMap& pmap)
 {
 	if (nameserver().isA(p->type, NODE))
 	{
 		Handle h(_tlbuf.getAtom(p->uuid));
 		if (h) return h;
 
-		Handle node(createNode(p->type, std::move(p->name)));
+		// Copy, don't move the name: the same PseudoAtom may be
+		// shared by several threads, via the PseudoMap.
+		Handle node(createNode(p->type, p->name));
 		_tlbuf.addAtom(node, p->uuid);
 		_num_rec_nodes ++;
 		return node;
@@ -96,7 +196,11 @@ Handle SQLAtomStorage::get_recursive_if_not_exists(PseudoPtr p)
 			resolved_oset.emplace_back(h);
 			continue;
 		}
-		PseudoPtr po(petAtom(idu));
+
+		PseudoPtr po;
+		auto it = pmap.find(idu);
+		if (pmap.end() != it) po = it->second;
+		if (nullptr == po) po = petAtom(idu);
 
 		// Corrupted databases can have outoging sets that refer
 		// to non-existent atoms. This is rare, but has happened.
@@ -106,7 +210,7 @@ Handle SQLAtomStorage::get_recursive_if_not_exists(PseudoPtr p)
 				"SQLAtomStorage::get_recursive_if_not_exists: "
 				"Corrupt database; no atom for uuid=%lu", idu);
 
-		Handle ha(get_recursive_if_not_exists(po));
+		Handle ha(get_recursive(po, pmap));
 		resolved_oset.emplace_back(ha);
 	}
 	Handle link(createLink(std::move(resolved_oset), p->type));
@@ -125,7 +229,10 @@ Handle SQLAtomStorage::doGetNode(Type t, const char * str)
 	Handle node(createNode(t, str));
 	UUID uuid = _tlbuf.getUUID(node);
 	if (TLB::INVALID_UUID != uuid)
+	{
+		_num_tlb_hits++;
 		return _tlbuf.getAtom(uuid);
+	}
 
 	// If we don't know it, then go get it's UUID.
 	setup_typemap();
@@ -158,8 +265,11 @@ Handle SQLAtomStorage::doGetNode(Type t, const char * str)
 Handle SQLAtomStorage::getNode(Type t, const char * str)
 {
 	rethrow();
+	LatencyHistogram::Timer tm(_latency[OP_GET_NODE]);
 	Handle h(doGetNode(t, str));
 	if (h) get_atom_values(h);
+	ws_touch(h);
+	ws_evict();
 	return h;
 }
 
@@ -173,7 +283,10 @@ Handle SQLAtomStorage::doGetLink(Type t, const HandleSeq& hseq)
 	Handle link(createLink(std::move(HandleSeq(hseq)), t));
 	UUID uuid = _tlbuf.getUUID(link);
 	if (TLB::INVALID_UUID != uuid)
+	{
+		_num_tlb_hits++;
 		return _tlbuf.getAtom(uuid);
+	}
 
 	// If the outgoing set is not yet known, then the link
 	// itself cannot possibly be known. The oset_to_string()
@@ -205,10 +318,13 @@ Handle SQLAtomStorage::doGetLink(Type t, const HandleSeq& hseq)
 Handle SQLAtomStorage::getLink(Type t, const HandleSeq& hs)
 {
 	rethrow();
+	LatencyHistogram::Timer tm(_latency[OP_GET_LINK]);
 	try
 	{
 		Handle hg(doGetLink(t, hs));
 		get_atom_values(hg);
+		ws_touch(hg);
+		ws_evict();
 		return hg;
 	}
 	catch (const NotFoundException& ex)
@@ -243,6 +359,10 @@ SQLAtomStorage::PseudoPtr SQLAtomStorage::makeAtom(Response &rp, UUID uuid)
 	{
 		atom->name = rp.name;
 	}
+	else if (rp.typed)
+	{
+		atom->oset = rp.oset;
+	}
 	else
 	{
 		char *p = (char *) rp.outlist;
@@ -71,7 +71,14 @@ SQLAtomStorage::SQLAtomStorage(const std::string uri) :
 	// situation, to me.
 	_write_queue.set_watermarks(800, 150);
 
-	_initial_conn_pool_size = 0;
+	// Allow for one connection per database-reader, and one connection
+	// for each writer; see open() for why. More connections are opened
+	// when these are all busy for a while, up to twice as many.
+	_pool_min = NUM_WB_QUEUES + NUM_OMP_THREADS;
+	_pool_max = 2 * _pool_min;
+	_pool_grow_msec = 50;
+	_pool_idle_secs = 60;
+
 	_use_libpq = false;
 	_use_odbc = false;
 
@@ -80,13 +87,25 @@ SQLAtomStorage::SQLAtomStorage(const std::string uri) :
 		db_typename[i] = NULL;
 
 	max_height = 0;
+	_fetch_size = 10000;
 	bulk_load = false;
 	bulk_store = false;
+
+	_wb_writing = false;
+	_wb_flush = false;
+	_wb_stop = false;
+	_wb_max_dirty = 0;
+	_wb_window_msec = 0;
+
+	_ws_hand = 0;
+	_ws_max_atoms = 0;
 	clear_stats();
 }
 
 SQLAtomStorage::~SQLAtomStorage()
 {
+	// Write out whatever is still dirty.
+	try { wb_stop(); } catch (...) {}
 	close_conn_pool();
 
 	for (int i=0; i<TYPEMAP_SZ; i++)
@@ -98,39 +117,68 @@ SQLAtomStorage::~SQLAtomStorage()
 /* ================================================================ */
 // Connections and opening
 
-void SQLAtomStorage::enlarge_conn_pool(int delta, const char* uri)
+LLConnection* SQLAtomStorage::new_connection(const char* uri)
 {
-	if (0 >= delta) return;
-
-	for (int i=0; i<delta; i++)
-	{
-		LLConnection* db_conn = nullptr;
+	LLConnection* db_conn = nullptr;
 #ifdef HAVE_PGSQL_STORAGE
-		if (_use_libpq)
-			db_conn = new LLPGConnection(uri);
+	if (_use_libpq)
+		db_conn = new LLPGConnection(uri);
 #endif /* HAVE_PGSQL_STORAGE */
 
 #ifdef HAVE_ODBC_STORAGE
-		if (_use_odbc)
-			db_conn = new ODBCConnection(uri);
+	if (_use_odbc)
+		db_conn = new ODBCConnection(uri);
 #endif /* HAVE_ODBC_STORAGE */
 
-		conn_pool.push(db_conn);
+	return db_conn;
+}
+
+/// Make sure the pool has at least `min` connections to `uri`.
+void SQLAtomStorage::open_conn_pool(size_t min, const char* uri)
+{
+	if (0 == conn_pool.total())
+	{
+		std::string u(uri);
+		conn_pool.set_factory([this, u]() { return new_connection(u.c_str()); });
 	}
 
-	_initial_conn_pool_size += delta;
+	conn_pool.set_bounds(std::max(min, conn_pool.min()),
+	                     std::max(_pool_max, min),
+	                     _pool_grow_msec, _pool_idle_secs);
+	conn_pool.fill();
 }
 
 void SQLAtomStorage::close_conn_pool()
 {
 	flushStoreQueue();
+	conn_pool.close();
+	conn_pool.set_bounds(1, 1, _pool_grow_msec, _pool_idle_secs);
+}
 
-	while (not conn_pool.is_empty())
-	{
-		LLConnection* db_conn = conn_pool.value_pop();
-		delete db_conn;
-	}
-	_initial_conn_pool_size = 0;
+/// Bound the size of the connection pool. It never shrinks below
+/// `min` connections, nor grows above `max`. A thread that has waited
+/// `grow_msec` for a connection opens a new one, if there is room;
+/// connections idle for `idle_secs` are closed, down to `min`.
+///
+/// The pool must stay bigger than the number of loader threads, as
+/// each may hold two connections at once; `max` is raised to that
+/// if need be, lest they deadlock.
+void SQLAtomStorage::set_conn_pool(size_t min, size_t max,
+                                   unsigned int grow_msec,
+                                   unsigned int idle_secs)
+{
+	if (min < 1) min = 1;
+	if (max < NUM_OMP_THREADS + 1) max = NUM_OMP_THREADS + 1;
+	if (max < min) max = min;
+
+	_pool_min = min;
+	_pool_max = max;
+	_pool_grow_msec = grow_msec;
+	_pool_idle_secs = idle_secs;
+
+	if (0 == conn_pool.total()) return;
+	conn_pool.set_bounds(min, max, grow_msec, idle_secs);
+	conn_pool.fill();
 }
 
 // Public function
@@ -151,8 +199,7 @@ void SQLAtomStorage::connect(const char * uri)
 	if (not _use_libpq and not _use_odbc)
 		throw IOException(TRACE_INFO, "Unknown URI '%s'\n", uri);
 
-	if (0 == _initial_conn_pool_size)
-		enlarge_conn_pool(NUM_WB_QUEUES + 2, uri);
+	open_conn_pool(NUM_WB_QUEUES + 2, uri);
 
 	if (!connected()) return;
 
@@ -189,13 +236,14 @@ void SQLAtomStorage::open(void)
 	// concurrent SELECT statements to the same table...
 	// So, ignore the number of cores, and set things to 12.
 	//
-	// _initial_conn_pool_size = std::thread::hardware_concurrency();
-	// if (0 == _initial_conn_pool_size) _initial_conn_pool_size = 8;
-	// _initial_conn_pool_size += NUM_WB_QUEUES;
+	// _pool_min = std::thread::hardware_concurrency();
+	// if (0 == _pool_min) _pool_min = 8;
+	// _pool_min += NUM_WB_QUEUES;
 // #define NUM_OMP_THREADS 8
-
-	// minus 2 because we had a +2 in connect();
-	enlarge_conn_pool(NUM_OMP_THREADS - 2, _name.c_str());
+	//
+	// Bursts beyond this are caught by growing the pool, when it is
+	// found to be busy for a while; see SQLConnPool.h.
+	open_conn_pool(_pool_min, _name.c_str());
 
 	if (!connected()) return;
 
@@ -223,7 +271,7 @@ void SQLAtomStorage::open(void)
  */
 bool SQLAtomStorage::connected(void)
 {
-	if (0 == _initial_conn_pool_size) return false;
+	if (0 == conn_pool.total()) return false;
 
 	// This will leak a resource, if db_conn->connected() ever throws.
 	LLConnection* db_conn = conn_pool.value_pop();
@@ -281,6 +329,7 @@ void SQLAtomStorage::rethrow(void)
 void SQLAtomStorage::flushStoreQueue()
 {
 	rethrow();
+	wb_drain();
 	_write_queue.barrier();
 	rethrow();
 }
@@ -457,6 +506,15 @@ void SQLAtomStorage::clear_stats(void)
 	_value_stores = 0;
 
 	_write_queue.clear_stats();
+	conn_pool.clear_stats();
+
+	_wb_stores = 0;
+	_wb_coalesced = 0;
+	_wb_flushes = 0;
+	_wb_rows = 0;
+	_ws_evictions = 0;
+	_num_tlb_hits = 0;
+	for (LatencyHistogram& lh : _latency) lh.clear();
 
 	_num_get_nodes = 0;
 	_num_got_nodes = 0;
@@ -562,8 +620,13 @@ void SQLAtomStorage::print_stats(void)
 	       _write_queue._in_drain, _write_queue.get_busy_writers(),
 	       _write_queue.get_size());
 
-	printf("current conn_pool free=%u of %d\n", conn_pool.size(),
-	       _initial_conn_pool_size);
+	const LatencyHistogram& waits = conn_pool.wait_times();
+	printf("current conn_pool free=%zu of %zu (min=%zu max=%zu peak busy=%zu)\n",
+	       conn_pool.size(), conn_pool.total(), conn_pool.min(),
+	       conn_pool.max(), conn_pool.peak());
+	printf("conn_pool opened=%zu closed idle=%zu wait p50=%f p99=%f max=%f secs\n",
+	       conn_pool.grown(), conn_pool.reaped(), waits.quantile(0.5),
+	       waits.quantile(0.99), waits.max());
 
 	// Some basic TLB statistics; could be improved;
 	// The TLB remapping theory needs some work...
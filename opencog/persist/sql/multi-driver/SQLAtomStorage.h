@@ -26,15 +26,22 @@
 #define _OPENCOG_SQL_ATOM_STORAGE_H
 
 #include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <set>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 // #include <opencog/util/async_method_caller.h>
 #include <opencog/util/async_buffer.h>
 
 #include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/LockStats.h>
 #include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/Float32Value.h>
+#include <opencog/atoms/value/IntValue.h>
 #include <opencog/atoms/value/LinkValue.h>
 #include <opencog/atoms/value/StringValue.h>
 #include <opencog/atoms/base/Valuation.h>
@@ -43,6 +50,8 @@
 #include <opencog/persist/api/StorageNode.h>
 #include <opencog/persist/tlb/TLB.h>
 
+#include "LatencyHistogram.h"
+#include "SQLConnPool.h"
 #include "llapi.h"
 
 // See SQLAtomStorage.cc for extensive explanation of what this
@@ -59,9 +68,13 @@ class SQLAtomStorage : public StorageNode
 {
 	private:
 		// Pool of shared connections
-		concurrent_stack<LLConnection*> conn_pool;
-		int _initial_conn_pool_size;
-		void enlarge_conn_pool(int, const char*);
+		SQLConnPool conn_pool;
+		size_t _pool_min;
+		size_t _pool_max;
+		unsigned int _pool_grow_msec;
+		unsigned int _pool_idle_secs;
+		LLConnection* new_connection(const char*);
+		void open_conn_pool(size_t, const char*);
 		void close_conn_pool(void);
 
 		// Utility for handling responses (on stack).
@@ -95,8 +108,13 @@ class SQLAtomStorage : public StorageNode
 		PseudoPtr makeAtom(Response&, UUID);
 		PseudoPtr getAtom(const char *, int);
 		PseudoPtr petAtom(UUID);
+		std::vector<PseudoPtr> petAtoms(const std::vector<UUID>&);
+
+		typedef std::unordered_map<UUID, PseudoPtr> PseudoMap;
+		void prefetch_outgoing(const std::vector<PseudoPtr>&, PseudoMap&);
 
 		Handle get_recursive_if_not_exists(PseudoPtr);
+		Handle get_recursive(PseudoPtr, const PseudoMap&);
 
 		Handle doGetNode(Type, const char *);
 		Handle doGetLink(Type, const HandleSeq&);
@@ -104,16 +122,28 @@ class SQLAtomStorage : public StorageNode
 		int getMaxObservedHeight(void);
 		int max_height;
 
+		size_t _fetch_size;
+		size_t fetch_pages(Response&, const char*, const char*,
+		                   std::vector<std::string>, UUID, UUID,
+		                   bool (Response::*)(void),
+		                   const std::function<void(void)>& = nullptr);
+
 		void getIncoming(AtomSpace&, const char *);
 		// --------------------------
 		// Storing of atoms
-		std::mutex _store_mutex;
+		static constexpr char store_lock_site[] = "SQL store";
+		typedef LOCK_SITE_MUTEX(store_lock_site) StoreMutex;
+		StoreMutex _store_mutex;
 
 		int do_store_atom(const Handle&);
 		void vdo_store_atom(const Handle&);
 		void do_store_single_atom(const Handle&, int);
 
 		bool not_yet_stored(const Handle&);
+		void bulk_uuids(const AtomSpace*, HandleSeq&, std::vector<UUID>&,
+		                std::vector<bool>&, std::unordered_map<Handle, int>&);
+		bool copy_atomspace(const AtomSpace*);
+		bool batch_atomspace(const AtomSpace*);
 		std::string oset_to_string(const HandleSeq&);
 
 		bool bulk_load;
@@ -123,6 +153,7 @@ class SQLAtomStorage : public StorageNode
 		// --------------------------
 		// Atom removal
 		void removeAtom(Response&, UUID, bool recursive);
+		void removeClosure(Response&, UUID);
 		void deleteSingleAtom(Response&, UUID);
 
 		// --------------------------
@@ -133,7 +164,9 @@ class SQLAtomStorage : public StorageNode
 		// --------------------------
 		// Values
 #define NUMVMUT 16
-		std::mutex _value_mutex[NUMVMUT];
+		static constexpr char value_lock_site[] = "SQL value";
+		typedef LOCK_SITE_MUTEX(value_lock_site) ValueMutex;
+		ValueMutex _value_mutex[NUMVMUT];
 		void store_atom_values(const Handle &);
 		void get_atom_values(Handle &);
 
@@ -149,6 +182,7 @@ class SQLAtomStorage : public StorageNode
 		// --------------------------
 		// Valuations
 		std::mutex _valuation_mutex;
+		UUID stored_uuid(const Handle&);
 		void storeValuation(const ValuationPtr&);
 		void storeValuation(const Handle&, const Handle&, const ValuePtr&);
 		void deleteValuation(const Handle&, const Handle&);
@@ -156,11 +190,74 @@ class SQLAtomStorage : public StorageNode
 		void deleteAllValuations(Response&, UUID);
 
 		std::string float_to_string(const FloatValuePtr&);
+		std::string float32_to_string(const Float32ValuePtr&);
+		std::string int_to_string(const IntValuePtr&);
 		std::string string_to_string(const StringValuePtr&);
 		std::string link_to_string(const LinkValuePtr&);
 
+		// The same, in the binary format of Postgres; see pg-binary.h.
+		std::string oset_to_binary(const HandleSeq&);
+		std::string float_to_binary(const FloatValuePtr&);
+		std::string float32_to_binary(const Float32ValuePtr&);
+		std::string int_to_binary(const IntValuePtr&);
+		std::string string_to_binary(const StringValuePtr&);
+		std::string link_to_binary(const LinkValuePtr&);
+
 		Handle tvpred; // the key to a very special valuation.
 
+		// --------------------------
+		// Write-back cache of Values. When it is on, storeValue()
+		// only notes that the (atom, key) is dirty. A thread of its
+		// own writes out the dirty ones, after a while, or when
+		// there are enough of them, as a few multi-row statements.
+		// The Value written is the one current at that time; so a
+		// Value stored over and over is written only once.
+		std::set<std::pair<Handle, Handle>> _dirty;
+		std::mutex _wb_mutex;
+		std::condition_variable _wb_work;
+		std::condition_variable _wb_done;
+		std::thread _wb_writer;
+		bool _wb_writing;
+		bool _wb_flush;
+		bool _wb_stop;
+		size_t _wb_max_dirty;  // zero means no cache: write-through.
+		unsigned int _wb_window_msec;
+
+		std::atomic<size_t> _wb_stores;
+		std::atomic<size_t> _wb_coalesced;
+		std::atomic<size_t> _wb_flushes;
+		std::atomic<size_t> _wb_rows;
+
+		bool wb_enqueue(const Handle&, const Handle&);
+		void wb_loop(void);
+		void wb_write(const std::vector<std::pair<Handle, Handle>>&);
+		void wb_drain(void);
+		void wb_stop(void);
+
+		// --------------------------
+		// Working set. When it is bounded, the Atoms fetched one at
+		// a time are kept on a CLOCK, and the cold ones are extracted
+		// from the AtomSpace, when there are too many. See
+		// SQLWorkingSet.cc.
+		struct WSEntry
+		{
+			std::weak_ptr<Atom> atom;
+			const Atom* addr;
+			bool used;
+			bool free;
+		};
+		std::vector<WSEntry> _ws_ring;
+		std::vector<size_t> _ws_free;
+		std::unordered_map<const Atom*, size_t> _ws_index;
+		size_t _ws_hand;
+		size_t _ws_max_atoms;  // zero means no limit.
+		std::mutex _ws_mutex;
+		std::atomic<size_t> _ws_evictions;
+
+		void ws_touch(const Handle&);
+		size_t ws_idle_refs(const Handle&);
+		void ws_evict(void);
+
 		// --------------------------
 		// UUID management
 		UUID check_uuid(const Handle&);
@@ -211,8 +308,19 @@ class SQLAtomStorage : public StorageNode
 		std::atomic<size_t> _store_count;
 		std::atomic<size_t> _valuation_stores;
 		std::atomic<size_t> _value_stores;
+		std::atomic<size_t> _num_tlb_hits;
 		time_t _stats_time;
 
+		// Latencies, by operation. See SQLMetrics.cc.
+		enum MetricOp
+		{
+			OP_GET_NODE, OP_GET_LINK, OP_FETCH_INCOMING, OP_LOAD_VALUE,
+			OP_STORE_ATOM, OP_STORE_VALUE, OP_REMOVE_ATOM, NUM_OPS
+		};
+		static const char* _op_names[NUM_OPS];
+		LatencyHistogram _latency[NUM_OPS];
+		void gauges(std::vector<std::string>&, std::vector<double>&);
+
 		// -------------------------------
 		// Type management
 		// The typemap translates between opencog type numbers and
@@ -264,7 +372,9 @@ class SQLAtomStorage : public StorageNode
 		Handle getLink(Type, const HandleSeq&);
 		void fetchIncomingSet(AtomSpace*, const Handle&);
 		void fetchIncomingByType(AtomSpace*, const Handle&, Type t);
+		void fetchIncomingSets(AtomSpace*, const HandleSeq&);
 		void storeAtom(const Handle&, bool synchronous = false);
+		void storeAtoms(const HandleSeq&, bool synchronous = false);
 		void removeAtom(const Handle&, bool recursive);
 		void storeValue(const Handle&, const Handle&);
 		void loadValue(const Handle&, const Handle&);
@@ -281,6 +391,14 @@ class SQLAtomStorage : public StorageNode
 		void clear_stats(void); // reset stats counters.
 		void set_hilo_watermarks(int, int);
 		void set_stall_writers(bool);
+		void set_write_back(size_t max_dirty, unsigned int window_msec);
+		void set_fetch_size(size_t);
+		void set_working_set(size_t max_atoms);
+		void set_conn_pool(size_t min, size_t max,
+		                   unsigned int grow_msec, unsigned int idle_secs);
+		std::string monitor(void);
+		void update_metrics(void);
+		std::string prometheus(void);
 };
 
 class PostgresStorageNode : public SQLAtomStorage
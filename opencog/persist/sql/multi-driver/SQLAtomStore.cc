@@ -30,6 +30,7 @@
 
 #include "SQLAtomStorage.h"
 #include "SQLResponse.h"
+#include "pg-binary.h"
 
 using namespace opencog;
 
@@ -72,6 +73,7 @@ void SQLAtomStorage::storeAtom(const Handle& h, bool synchronous)
 	// If a synchronous store, avoid the queues entirely.
 	if (synchronous)
 	{
+		LatencyHistogram::Timer tm(_latency[OP_STORE_ATOM]);
 		if (not_yet_stored(h)) do_store_atom(h);
 		store_atom_values(h);
 		return;
@@ -80,6 +82,21 @@ void SQLAtomStorage::storeAtom(const Handle& h, bool synchronous)
 	_write_queue.insert(h);
 }
 
+/**
+ * Store many Atoms. Rather than storing each one in the calling thread,
+ * as storeAtom() does when asked to be synchronous, queue them all,
+ * and let the writer threads share the work; then wait for them.
+ */
+void SQLAtomStorage::storeAtoms(const HandleSeq& hs, bool synchronous)
+{
+	rethrow();
+
+	for (const Handle& h: hs)
+		_write_queue.insert(h);
+
+	if (synchronous) flushStoreQueue();
+}
+
 /**
  * Synchronously store a single atom. That is, the actual store is done
  * in the calling thread.  All values attached to the atom are also
@@ -114,6 +131,7 @@ void SQLAtomStorage::vdo_store_atom(const Handle& h)
 {
 	try
 	{
+		LatencyHistogram::Timer tm(_latency[OP_STORE_ATOM]);
 		if (not_yet_stored(h)) do_store_atom(h);
 		store_atom_values(h);
 	}
@@ -141,7 +159,7 @@ void SQLAtomStorage::vdo_store_atom(const Handle& h)
  */
 bool SQLAtomStorage::not_yet_stored(const Handle& h)
 {
-	std::lock_guard<std::mutex> create_lock(_store_mutex);
+	std::lock_guard<StoreMutex> create_lock(_store_mutex);
 	UUID uuid = _tlbuf.getUUID(h);
 	return (TLB::INVALID_UUID == uuid) and
 	       (Handle::UNDEFINED == _tlbuf.getAtom(uuid));
@@ -156,7 +174,7 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 {
 	setup_typemap();
 
-	std::unique_lock<std::mutex> create_lock(_store_mutex);
+	std::unique_lock<StoreMutex> create_lock(_store_mutex);
 
 	UUID uuid = check_uuid(h);
 	if ((TLB::INVALID_UUID != uuid) and
@@ -171,6 +189,7 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 	std::string cols;
 	std::string vals;
 	std::string coda;
+	std::string oset;
 
 	cols = "INSERT INTO Atoms (";
 	vals = ") VALUES (";
@@ -253,9 +272,15 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 					"Atom was: %s\n", h->to_string().c_str());
 			}
 
-			cols += ", outgoing";
-			vals += ", ";
-			vals += oset_to_string(h->getOutgoingSet());
+			// With libpq, this goes in binary; see below.
+			if (_use_libpq)
+				oset = oset_to_binary(h->getOutgoingSet());
+			else
+			{
+				cols += ", outgoing";
+				vals += ", ";
+				vals += oset_to_string(h->getOutgoingSet());
+			}
 		}
 	}
 
@@ -270,7 +295,28 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 	try
 	{
 		Response rp(conn_pool);
-		rp.try_exec(qry.c_str());
+		if (_use_libpq)
+		{
+			// The name and the outgoing set are parameters, and the
+			// outgoing set is in binary: the server has nothing to
+			// unquote, and no array literal to parse.
+			std::string sid(std::to_string(uuid));
+			std::string stype(std::to_string(dbtype));
+			std::string shei(std::to_string(aheight));
+			bool lnk = not oset.empty();
+			const char* params[6] = {sid.c_str(), uuidbuff.c_str(),
+				stype.c_str(), shei.c_str(),
+				lnk ? nullptr : h->get_name().c_str(),
+				lnk ? param_bytes(oset) : nullptr};
+			int lengths[6] = {0, 0, 0, 0, 0, lnk ? param_length(oset) : 0};
+			int formats[6] = {0, 0, 0, 0, 0, 1};
+			rp.exec_prepared("insert_atom",
+				"INSERT INTO Atoms (uuid, space, type, height, name, outgoing) "
+				"VALUES ($1, $2, $3, $4, $5, $6);",
+				6, params, lengths, formats, true);
+		}
+		else
+			rp.try_exec(qry.c_str());
 	}
 	catch (const SilentException& ex)
 	{
@@ -24,8 +24,16 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <iomanip>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 
 #define OC_OMP 1  // hack alert -- force over-ride!
 #include <opencog/util/oc_assert.h>
@@ -36,10 +44,13 @@
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/base/Node.h>
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/truthvalue/TruthValue.h>
 #include <opencog/persist/tlb/TLB.h>
 
 #include "SQLAtomStorage.h"
 #include "SQLResponse.h"
+#include "ll-pg-cxx.h"
+#include "pg-binary.h"
 
 using namespace opencog;
 
@@ -58,6 +69,11 @@ void SQLAtomStorage::getIncoming(AtomSpace& table, const char *buff)
 	rp.exec(buff);
 	rp.rs->foreach_row(&Response::fetch_incoming_set_cb, &rp);
 
+	// Fetch the outgoing sets of the whole lot, level by level,
+	// rather than one atom at a time, each in its own thread.
+	PseudoMap pmap;
+	prefetch_outgoing(pset, pmap);
+
 	HandleSeq iset;
 	std::mutex iset_mutex;
 
@@ -69,10 +85,11 @@ void SQLAtomStorage::getIncoming(AtomSpace& table, const char *buff)
 	OMP_ALGO::for_each(pset.begin(), pset.end(),
 		[&] (const PseudoPtr& p)
 	{
-		Handle hi(get_recursive_if_not_exists(p));
+		Handle hi(get_recursive(p, pmap));
 		hi = table.storage_add_nocheck(hi);
 		_tlbuf.addAtom(hi, p->uuid);
 		get_atom_values(hi);
+		ws_touch(hi);
 		std::lock_guard<std::mutex> lck(iset_mutex);
 		iset.emplace_back(hi);
 	});
@@ -80,6 +97,8 @@ void SQLAtomStorage::getIncoming(AtomSpace& table, const char *buff)
 	// Performance stats
 	_num_get_insets++;
 	_num_get_inlinks += iset.size();
+
+	ws_evict();
 }
 
 /**
@@ -88,6 +107,7 @@ void SQLAtomStorage::getIncoming(AtomSpace& table, const char *buff)
 void SQLAtomStorage::fetchIncomingSet(AtomSpace* table, const Handle& h)
 {
 	rethrow();
+	LatencyHistogram::Timer tm(_latency[OP_FETCH_INCOMING]);
 
 	// If the uuid is not known, then the atom is not in storage,
 	// and therefore, cannot have an incoming set.  Just return.
@@ -109,6 +129,42 @@ void SQLAtomStorage::fetchIncomingSet(AtomSpace* table, const Handle& h)
 	getIncoming(*table, buff);
 }
 
+/**
+ * Retrieve the incoming sets of many atoms at once: one query finds
+ * every link holding any one of them, instead of one query per atom.
+ */
+void SQLAtomStorage::fetchIncomingSets(AtomSpace* table, const HandleSeq& hs)
+{
+	rethrow();
+	LatencyHistogram::Timer tm(_latency[OP_FETCH_INCOMING]);
+
+	// Long arrays make long queries; send them a few at a time.
+	static const size_t MAX_ARRAY = 1000;
+
+	std::string buff;
+	size_t n = 0;
+	for (const Handle& h : hs)
+	{
+		UUID uuid = check_uuid(h);
+		if (TLB::INVALID_UUID == uuid) continue;
+
+		buff += (0 == n) ?
+			"SELECT * FROM Atoms WHERE outgoing && ARRAY[CAST(" :
+			", CAST(";
+		buff += std::to_string(uuid) + " AS BIGINT)";
+		if (MAX_ARRAY <= ++n)
+		{
+			buff += "];";
+			getIncoming(*table, buff.c_str());
+			buff.clear();
+			n = 0;
+		}
+	}
+	if (0 == n) return;
+	buff += "];";
+	getIncoming(*table, buff.c_str());
+}
+
 /**
  * Retrieve the incoming set of the indicated atom, but only those atoms
  * of type t.
@@ -116,6 +172,7 @@ void SQLAtomStorage::fetchIncomingSet(AtomSpace* table, const Handle& h)
 void SQLAtomStorage::fetchIncomingByType(AtomSpace* table, const Handle& h, Type t)
 {
 	rethrow();
+	LatencyHistogram::Timer tm(_latency[OP_FETCH_INCOMING]);
 
 	// If the uuid is not known, then the atom is not in storage,
 	// and therefore, cannot have an incoming set.  Just return.
@@ -134,6 +191,60 @@ void SQLAtomStorage::fetchIncomingByType(AtomSpace* table, const Handle& h, Type
 
 /* ================================================================ */
 
+/// Run the query over the UUID range (lo, hi], a page of at most
+/// `_fetch_size` rows at a time, calling `cb` on each row, and then
+/// `done`, if any, after each page. Thus, no more than a page of
+/// rows is held in memory at once, no matter how big the range. The
+/// query must end with "uuid > $n AND uuid <= $n+1 ORDER BY uuid
+/// LIMIT $n+2", the `params` being the ones before that. Returns the
+/// number of rows.
+///
+/// This pages by key, rather than with a cursor: a cursor would need
+/// a transaction held open for the whole of the load, and could not
+/// be a prepared statement.
+size_t SQLAtomStorage::fetch_pages(Response& rp, const char* name,
+                                   const char* stmt,
+                                   std::vector<std::string> params,
+                                   UUID lo, UUID hi,
+                                   bool (Response::*cb)(void),
+                                   const std::function<void(void)>& done)
+{
+	size_t np = params.size();
+	params.push_back("");
+	params.push_back(std::to_string(hi));
+	params.push_back(std::to_string(_fetch_size));
+
+	std::vector<const char*> pv;
+	size_t total = 0;
+	while (true)
+	{
+		params[np] = std::to_string(lo);
+		pv.clear();
+		for (const std::string& p: params) pv.push_back(p.c_str());
+
+		rp.exec_prepared(name, stmt, pv.size(), pv.data());
+		size_t nrows = 0;
+		while (rp.rs->fetch_row())
+		{
+			(rp.*cb)();
+			nrows++;
+		}
+		if (done) done();
+		total += nrows;
+
+		// The rows are in order; the last one read is where the
+		// next page begins.
+		if (nrows < _fetch_size) break;
+		lo = rp.uuid;
+	}
+	return total;
+}
+
+void SQLAtomStorage::set_fetch_size(size_t sz)
+{
+	_fetch_size = std::max((size_t) 1, sz);
+}
+
 int SQLAtomStorage::getMaxObservedHeight(void)
 {
 	Response rp(conn_pool);
@@ -158,37 +269,112 @@ void SQLAtomStorage::loadAtomSpace(AtomSpace* table)
 
 #define NCHUNKS 300
 #define MINSTEP 10123
-	std::vector<unsigned long> steps;
+// Aim for chunks that take about this long to load.
+#define CHUNK_MSEC 500
 	unsigned long stepsize = MINSTEP + max_nrec/NCHUNKS;
-	for (unsigned long rec = 0; rec <= max_nrec; rec += stepsize)
-		steps.push_back(rec);
 
 	printf("Loading all atoms: "
-		"Max Height is %d stepsize=%lu chunks=%zu\n",
-		 max_height, stepsize, steps.size());
+		"Max Height is %d initial stepsize=%lu\n",
+		 max_height, stepsize);
+
+	// Chunks are handed out to the loader threads lowest height
+	// first. Once every chunk of a height has been handed out, the
+	// threads that are free go on to the next height, instead of
+	// waiting for the last few chunks to finish. A link whose
+	// outgoing set is not loaded yet still loads: the missing atoms
+	// are not in the TLB, and so are fetched with it, by
+	// get_recursive_if_not_exists(). Thus, all the threads (and all
+	// the connections) stay busy, until the very end.
+	//
+	// The chunk size is tuned for each height separately, since the
+	// rows of a height may be sparse or dense in the UUID space: each
+	// chunk is sized after how long the one before it took.
+	struct Height
+	{
+		UUID next;
+		unsigned long step;
+		size_t active;
+		size_t loaded;
+	};
+	std::vector<Height> heights(max_height + 1, {0, stepsize, 0, 0});
+	std::mutex sched_mtx;
+	std::exception_ptr load_error;
+
+	auto get_chunk = [&](int& hei, UUID& lo, UUID& hi) -> bool
+	{
+		std::lock_guard<std::mutex> lck(sched_mtx);
+		if (load_error) return false;
+		for (hei = 0; hei <= max_height; hei++)
+		{
+			Height& ht = heights[hei];
+			if (max_nrec < ht.next) continue;
+			lo = ht.next;
+			hi = lo + ht.step;
+			ht.next = hi + 1;
+			ht.active++;
+			return true;
+		}
+		return false;
+	};
+
+	auto done_chunk = [&](int hei, unsigned long step, size_t rows,
+	                      std::chrono::milliseconds took)
+	{
+		std::lock_guard<std::mutex> lck(sched_mtx);
+		Height& ht = heights[hei];
+		ht.loaded += rows;
 
-	// Parallelize always.
-	opencog::setting_omp(NUM_OMP_THREADS, NUM_OMP_THREADS);
+		// Halfway between the old step, and the one that would
+		// have taken CHUNK_MSEC.
+		unsigned long ms = std::max((long) took.count(), 1L);
+		unsigned long ideal = (step * CHUNK_MSEC) / ms;
+		ht.step = std::max((unsigned long) MINSTEP, (ht.step + ideal) / 2);
 
-	for (int hei=0; hei<=max_height; hei++)
-	{
-		unsigned long cur = _load_count;
+		if (0 == --ht.active and max_nrec < ht.next)
+			printf("Loaded %lu atoms at height %d\n", ht.loaded, hei);
+	};
 
-		OMP_ALGO::for_each(steps.begin(), steps.end(),
-			[&](unsigned long rec)
+	auto loader = [&](void)
+	{
+		int hei;
+		UUID lo, hi;
+		while (get_chunk(hei, lo, hi))
 		{
-			Response rp(conn_pool);
-			rp.table = table;
-			rp.store = this;
-			char buff[BUFSZ];
-			snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE "
-			         "height = %d AND uuid > %lu AND uuid <= %lu;",
-			         hei, rec, rec+stepsize);
-			rp.height = hei;
-			rp.exec(buff);
-			rp.rs->foreach_row(&Response::load_all_atoms_cb, &rp);
-		});
-		printf("Loaded %lu atoms at height %d\n", _load_count - cur, hei);
+			try
+			{
+				auto start = std::chrono::steady_clock::now();
+				Response rp(conn_pool);
+				rp.table = table;
+				rp.store = this;
+				rp.height = hei;
+				size_t rows = fetch_pages(rp, "load_height",
+					"SELECT * FROM Atoms WHERE "
+					"height = $1 AND uuid > $2 AND uuid <= $3 "
+					"ORDER BY uuid LIMIT $4;",
+					{std::to_string(hei)}, lo, hi,
+					&Response::load_all_atoms_cb);
+				done_chunk(hei, hi - lo, rows,
+					std::chrono::duration_cast<std::chrono::milliseconds>(
+						std::chrono::steady_clock::now() - start));
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lck(sched_mtx);
+				if (not load_error) load_error = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> loaders;
+	for (int i = 0; i < NUM_OMP_THREADS; i++)
+		loaders.emplace_back(loader);
+	for (std::thread& t: loaders)
+		t.join();
+
+	if (load_error)
+	{
+		bulk_load = false;
+		std::rethrow_exception(load_error);
 	}
 
 	time_t secs = time(0) - bulk_start;
@@ -242,13 +428,42 @@ void SQLAtomStorage::loadType(AtomSpace* table, Type atom_type)
 			Response rp(conn_pool);
 			rp.table = table;
 			rp.store = this;
-			char buff[BUFSZ];
-			snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE type = %d "
-			         "AND height = %d AND uuid > %lu AND uuid <= %lu;",
-			         db_atom_type, hei, rec, rec+stepsize);
+			std::vector<PseudoPtr> pset;
+			rp.pvec = &pset;
 			rp.height = hei;
-			rp.exec(buff);
-			rp.rs->foreach_row(&Response::load_if_not_exists_cb, &rp);
+
+			// Links of this type might have outgoing sets of any
+			// other type, not yet loaded: get those for the whole
+			// page at once, instead of for each link.
+			auto load_page = [&](void)
+			{
+				PseudoMap pmap;
+				prefetch_outgoing(pset, pmap);
+
+				// Fetch all values on the atom, but NOT on its
+				// outgoing set!
+				for (const PseudoPtr& p: pset)
+				{
+					Handle h(_tlbuf.getAtom(p->uuid));
+					if (nullptr == h) h = get_recursive(p, pmap);
+
+					// In case it's still in the TLB, but was
+					// previously removed from the atomspace.
+					h = table->storage_add_nocheck(h);
+					_tlbuf.addAtom(h, p->uuid);
+
+					// Clobber all values, including truth values.
+					get_atom_values(h);
+				}
+				pset.clear();
+			};
+
+			fetch_pages(rp, "load_type_height", "SELECT * FROM Atoms WHERE "
+			            "type = $1 AND height = $2 AND "
+			            "uuid > $3 AND uuid <= $4 ORDER BY uuid LIMIT $5;",
+			            {std::to_string(db_atom_type), std::to_string(hei)},
+			            rec, rec+stepsize,
+			            &Response::fetch_incoming_set_cb, load_page);
 		});
 		logger().debug("SQLAtomStorage::loadType: "
 		               "Loaded %lu atoms of type %d at height %d\n",
@@ -261,6 +476,484 @@ void SQLAtomStorage::loadType(AtomSpace* table, Type atom_type)
 	table->barrier();
 }
 
+/* ================================================================ */
+
+static int atom_height(const Handle& h, std::unordered_map<Handle, int>& heights)
+{
+	if (h->is_node()) return 0;
+
+	auto it = heights.find(h);
+	if (heights.end() != it) return it->second;
+
+	int hei = 0;
+	for (const Handle& ho: h->getOutgoingSet())
+		hei = std::max(hei, atom_height(ho, heights));
+	hei ++;
+
+	heights.emplace(h, hei);
+	return hei;
+}
+
+/// Issue UUID's for all of the atoms in the atom table, nodes
+/// first, and check that their rows will fit, before anything is
+/// sent. `fresh` tells which ones were not already stored.
+void SQLAtomStorage::bulk_uuids(const AtomSpace* table, HandleSeq& atoms,
+                                std::vector<UUID>& uuids,
+                                std::vector<bool>& fresh,
+                                std::unordered_map<Handle, int>& heights)
+{
+	atoms.reserve(table->get_num_atoms_of_type(ATOM, true));
+	table->get_handles_by_type(atoms, NODE, true);
+	table->get_handles_by_type(atoms, LINK, true);
+
+	uuids.reserve(atoms.size());
+	fresh.reserve(atoms.size());
+	for (const Handle& h: atoms)
+	{
+		if (h->is_node() and 2700 < h->get_name().size())
+			throw IOException(TRACE_INFO,
+				"Error: bulk store: Maximum Node name size is 2700.\n");
+		if (h->is_link() and 330 < h->get_arity())
+			throw IOException(TRACE_INFO,
+				"Error: bulk store: Maximum Link size is 330. "
+				"Atom was: %s\n", h->to_string().c_str());
+
+		UUID uuid = _tlbuf.getUUID(h);
+		fresh.push_back(TLB::INVALID_UUID == uuid);
+		uuids.push_back(_tlbuf.addAtom(h, uuid));
+		int hei = atom_height(h, heights);
+		if (max_height < hei) max_height = hei;
+	}
+}
+
+/// Whether the Value goes in the floatvalue or stringvalue column
+/// of its Valuation; others need rows in other tables.
+static bool is_column_value(Type vtype)
+{
+	return nameserver().isA(vtype, FLOAT_VALUE) or
+	       nameserver().isA(vtype, FLOAT32_VALUE) or
+	       nameserver().isA(vtype, INT_VALUE) or
+	       nameserver().isA(vtype, STRING_VALUE);
+}
+
+/* ================================================================ */
+#ifdef HAVE_PGSQL_STORAGE
+
+// Send the rows to the server whenever this much has piled up.
+#define COPY_CHUNK (1<<20)
+
+/// One COPY, from beginning to end. The rows are sent a chunk at a
+/// time, as they are added. If it is not finished, it is abandoned.
+class CopyIn
+{
+	LLPGConnection* _conn;
+	bool _done;
+
+public:
+	std::string buf;
+
+	CopyIn(LLPGConnection* conn, const char* stmt) :
+		_conn(conn), _done(false)
+	{
+		_conn->copy_begin(stmt);
+		static const char sig[] = "PGCOPY\n\377\r\n";
+		buf.reserve(COPY_CHUNK + COPY_CHUNK/2);
+		buf.append(sig, sizeof(sig));  // including the trailing null
+		put32(buf, 0);  // flags
+		put32(buf, 0);  // no header extension
+	}
+
+	~CopyIn()
+	{
+		if (_done) return;
+		try { _conn->copy_end("bulk store abandoned"); }
+		catch (...) {}
+	}
+
+	void row(int nfields)
+	{
+		if (COPY_CHUNK < buf.size())
+		{
+			_conn->copy_data(buf);
+			buf.clear();
+		}
+		put16(buf, nfields);
+	}
+
+	void finish(void)
+	{
+		put16(buf, (uint16_t) -1);
+		_conn->copy_data(buf);
+		_done = true;
+		_conn->copy_end();
+	}
+};
+
+#endif /* HAVE_PGSQL_STORAGE */
+
+/**
+ * Store all of the atoms in the atom table with two COPY's, one for
+ * the Atoms, and one for their Valuations, instead of an INSERT for
+ * each. This is safe only when the database is empty; else rows
+ * might collide with what is already there. UUID's are issued up
+ * front, so that the Links and the Valuations can refer to them.
+ *
+ * Values that are not numbers or strings (Atoms, LinkValues) need
+ * rows in other tables, and are stored the ordinary way, at the end;
+ * so are the Values of the few Atoms that were already stored.
+ *
+ * Return false, having done nothing, if the database is not Postgres.
+ */
+bool SQLAtomStorage::copy_atomspace(const AtomSpace* table)
+{
+#ifdef HAVE_PGSQL_STORAGE
+	if (not _use_libpq) return false;
+
+	setup_typemap();
+
+	HandleSeq atoms;
+	std::vector<UUID> uuids;
+	std::vector<bool> fresh;
+	std::unordered_map<Handle, int> heights;
+	bulk_uuids(table, atoms, uuids, fresh, heights);
+
+	LLConnection* conn = conn_pool.value_pop();
+	LLPGConnection* pgconn = dynamic_cast<LLPGConnection*>(conn);
+	if (nullptr == pgconn)
+	{
+		conn_pool.push(conn);
+		return false;
+	}
+
+	// Valuations to be stored the ordinary way: key, atom, value.
+	std::vector<std::tuple<Handle, Handle, ValuePtr>> deferred;
+	try
+	{
+		CopyIn atcp(pgconn, "COPY Atoms (uuid, space, type, height, "
+		                    "name, outgoing) FROM STDIN WITH (FORMAT binary);");
+		for (size_t i = 0; i < atoms.size(); i++)
+		{
+			if (not fresh[i]) continue;
+			const Handle& h = atoms[i];
+
+			atcp.row(6);
+			put_int8(atcp.buf, uuids[i]);
+			put_int8(atcp.buf, 1);  // See do_store_single_atom()
+			put_int2(atcp.buf, storing_typemap[h->get_type()]);
+			if (h->is_node())
+			{
+				put_int2(atcp.buf, 0);
+				put_text(atcp.buf, h->get_name());
+				put_null(atcp.buf);
+				_num_node_inserts++;
+			}
+			else
+			{
+				put_int2(atcp.buf, heights[h]);
+				put_null(atcp.buf);
+				size_t at = begin_array(atcp.buf, INT8OID, h->get_arity());
+				for (const Handle& ho: h->getOutgoingSet())
+					put_int8(atcp.buf, _tlbuf.getUUID(ho));
+				end_array(atcp.buf, at);
+				_num_link_inserts++;
+			}
+			_store_count++;
+		}
+		atcp.finish();
+
+		CopyIn vacp(pgconn, "COPY Valuations (key, atom, type, "
+		                    "floatvalue, stringvalue) FROM STDIN WITH (FORMAT binary);");
+		for (size_t i = 0; i < atoms.size(); i++)
+		{
+			const Handle& h = atoms[i];
+			for (const Handle& key: h->getKeys())
+			{
+				ValuePtr pap = h->getValue(key);
+				Type vtype = pap->get_type();
+
+				// Default TV's are not stored; see store_atom_values().
+				if (key == tvpred)
+				{
+					TruthValuePtr tv(TruthValueCast(pap));
+					if (tv and tv->isDefaultTV()) continue;
+				}
+
+				UUID kuid = _tlbuf.getUUID(key);
+				if (not fresh[i] or TLB::INVALID_UUID == kuid or
+				    not is_column_value(vtype))
+				{
+					deferred.emplace_back(key, h, pap);
+					continue;
+				}
+
+				vacp.row(5);
+				put_int8(vacp.buf, kuid);
+				put_int8(vacp.buf, uuids[i]);
+				put_int2(vacp.buf, storing_typemap[vtype]);
+
+				size_t at;
+				if (nameserver().isA(vtype, FLOAT_VALUE))
+				{
+					const std::vector<double>& fv =
+						FloatValueCast(pap)->value();
+					at = begin_array(vacp.buf, FLOAT8OID, fv.size());
+					for (double d: fv) put_double(vacp.buf, d);
+					end_array(vacp.buf, at);
+					put_null(vacp.buf);
+				}
+				else if (nameserver().isA(vtype, FLOAT32_VALUE))
+				{
+					const std::vector<float>& fv =
+						Float32ValueCast(pap)->value();
+					at = begin_array(vacp.buf, FLOAT8OID, fv.size());
+					for (float f: fv) put_double(vacp.buf, f);
+					end_array(vacp.buf, at);
+					put_null(vacp.buf);
+				}
+				else if (nameserver().isA(vtype, INT_VALUE))
+				{
+					// As decimal strings; see int_to_string().
+					const std::vector<int64_t>& iv =
+						IntValueCast(pap)->value();
+					put_null(vacp.buf);
+					at = begin_array(vacp.buf, TEXTOID, iv.size());
+					for (int64_t n: iv) put_text(vacp.buf, std::to_string(n));
+					end_array(vacp.buf, at);
+				}
+				else
+				{
+					const std::vector<std::string>& sv =
+						StringValueCast(pap)->value();
+					put_null(vacp.buf);
+					at = begin_array(vacp.buf, TEXTOID, sv.size());
+					for (const std::string& str: sv) put_text(vacp.buf, str);
+					end_array(vacp.buf, at);
+				}
+				_valuation_stores++;
+			}
+		}
+		vacp.finish();
+	}
+	catch (...)
+	{
+		conn_pool.push(conn);
+		throw;
+	}
+	conn_pool.push(conn);
+
+	for (const auto& kav: deferred)
+		storeValuation(std::get<0>(kav), std::get<1>(kav), std::get<2>(kav));
+
+	return true;
+#else
+	return false;
+#endif /* HAVE_PGSQL_STORAGE */
+}
+
+/* ================================================================ */
+
+// Rows handed to the driver in one go.
+#define BATCH_CHUNK 10000
+
+/// Rows of text parameters for one INSERT statement, handed to the
+/// driver a chunk at a time, as they are added.
+class BatchIn
+{
+	LLConnection* _conn;
+	const char* _name;
+	const char* _stmt;
+	int _nparams;
+	std::vector<std::string> _text;
+	std::vector<bool> _null;
+
+public:
+	BatchIn(LLConnection* conn, const char* name,
+	        const char* stmt, int nparams) :
+		_conn(conn), _name(name), _stmt(stmt), _nparams(nparams)
+	{
+		_text.reserve(BATCH_CHUNK * nparams);
+		_null.reserve(BATCH_CHUNK * nparams);
+	}
+
+	void row(void)
+	{
+		if ((size_t) (BATCH_CHUNK * _nparams) <= _text.size()) finish();
+	}
+	void text(std::string&& str)
+	{
+		_text.emplace_back(std::move(str));
+		_null.push_back(false);
+	}
+	void null(void)
+	{
+		_text.emplace_back();
+		_null.push_back(true);
+	}
+
+	void finish(void)
+	{
+		if (_text.empty()) return;
+		std::vector<const char*> params;
+		params.reserve(_text.size());
+		for (size_t i = 0; i < _text.size(); i++)
+			params.push_back(_null[i] ? nullptr : _text[i].c_str());
+		_conn->exec_batch(_name, _stmt, _nparams,
+		                  _text.size() / _nparams, params.data());
+		_text.clear();
+		_null.clear();
+	}
+};
+
+// The quoted literals made by the *_to_string() methods, without
+// the quotes; these are bound, not pasted into the statement.
+static std::string unquote(const std::string& lit)
+{
+	return lit.substr(1, lit.size() - 2);
+}
+
+/**
+ * The same as copy_atomspace(), for drivers that cannot COPY (ODBC):
+ * the rows go as batches of INSERTs, with their parameters bound as
+ * arrays (see LLConnection::exec_batch()), instead of one INSERT,
+ * and one round-trip, per row. The same caveats apply.
+ *
+ * Return false, having done nothing, if the database is Postgres,
+ * through libpq; copy_atomspace() does that better.
+ */
+bool SQLAtomStorage::batch_atomspace(const AtomSpace* table)
+{
+	if (_use_libpq) return false;
+
+	setup_typemap();
+
+	HandleSeq atoms;
+	std::vector<UUID> uuids;
+	std::vector<bool> fresh;
+	std::unordered_map<Handle, int> heights;
+	bulk_uuids(table, atoms, uuids, fresh, heights);
+
+	// Valuations to be stored the ordinary way: key, atom, value.
+	std::vector<std::tuple<Handle, Handle, ValuePtr>> deferred;
+
+	LLConnection* conn = conn_pool.value_pop();
+	try
+	{
+		// The parameters are text, and some drivers say so; cast
+		// them, lest the server balk at text going into numbers.
+		BatchIn atbt(conn, "batch_atoms",
+			"INSERT INTO Atoms (uuid, space, type, height, name, outgoing) "
+			"VALUES (CAST($1 AS BIGINT), 1, CAST($2 AS SMALLINT), "
+			"CAST($3 AS SMALLINT), $4, CAST($5 AS BIGINT[]));", 5);
+		for (size_t i = 0; i < atoms.size(); i++)
+		{
+			if (not fresh[i]) continue;
+			const Handle& h = atoms[i];
+
+			atbt.row();
+			atbt.text(std::to_string(uuids[i]));
+			atbt.text(std::to_string(storing_typemap[h->get_type()]));
+			if (h->is_node())
+			{
+				atbt.text("0");
+				atbt.text(std::string(h->get_name()));
+				atbt.null();
+				_num_node_inserts++;
+			}
+			else
+			{
+				atbt.text(std::to_string(heights[h]));
+				atbt.null();
+				atbt.text(unquote(oset_to_string(h->getOutgoingSet())));
+				_num_link_inserts++;
+			}
+			_store_count++;
+		}
+		atbt.finish();
+
+		BatchIn vabt(conn, "batch_valuations",
+			"INSERT INTO Valuations (key, atom, type, floatvalue, stringvalue) "
+			"VALUES (CAST($1 AS BIGINT), CAST($2 AS BIGINT), "
+			"CAST($3 AS SMALLINT), CAST($4 AS DOUBLE PRECISION[]), "
+			"CAST($5 AS TEXT[]));", 5);
+		for (size_t i = 0; i < atoms.size(); i++)
+		{
+			const Handle& h = atoms[i];
+			for (const Handle& key: h->getKeys())
+			{
+				ValuePtr pap = h->getValue(key);
+				Type vtype = pap->get_type();
+
+				// Default TV's are not stored; see store_atom_values().
+				if (key == tvpred)
+				{
+					TruthValuePtr tv(TruthValueCast(pap));
+					if (tv and tv->isDefaultTV()) continue;
+				}
+
+				UUID kuid = _tlbuf.getUUID(key);
+				if (not fresh[i] or TLB::INVALID_UUID == kuid or
+				    not is_column_value(vtype))
+				{
+					deferred.emplace_back(key, h, pap);
+					continue;
+				}
+
+				vabt.row();
+				vabt.text(std::to_string(kuid));
+				vabt.text(std::to_string(uuids[i]));
+				vabt.text(std::to_string(storing_typemap[vtype]));
+
+				if (nameserver().isA(vtype, FLOAT_VALUE))
+				{
+					vabt.text(unquote(float_to_string(FloatValueCast(pap))));
+					vabt.null();
+				}
+				else if (nameserver().isA(vtype, FLOAT32_VALUE))
+				{
+					vabt.text(unquote(float32_to_string(Float32ValueCast(pap))));
+					vabt.null();
+				}
+				else if (nameserver().isA(vtype, INT_VALUE))
+				{
+					vabt.null();
+					vabt.text(unquote(int_to_string(IntValueCast(pap))));
+				}
+				else
+				{
+					// An array literal; being bound, it is quoted
+					// only for the array, and not for the statement,
+					// as string_to_string() must.
+					std::stringstream ss;
+					ss << "{";
+					bool not_first = false;
+					for (const std::string& str: StringValueCast(pap)->value())
+					{
+						if (not_first) ss << ", ";
+						not_first = true;
+						ss << std::quoted(str);
+					}
+					ss << "}";
+					vabt.null();
+					vabt.text(ss.str());
+				}
+				_valuation_stores++;
+			}
+		}
+		vabt.finish();
+	}
+	catch (...)
+	{
+		conn_pool.push(conn);
+		throw;
+	}
+	conn_pool.push(conn);
+
+	for (const auto& kav: deferred)
+		storeValuation(std::get<0>(kav), std::get<1>(kav), std::get<2>(kav));
+
+	return true;
+}
+
 /// Store all of the atoms in the atom table.
 void SQLAtomStorage::storeAtomSpace(const AtomSpace* table)
 {
@@ -291,16 +984,23 @@ void SQLAtomStorage::storeAtomSpace(const AtomSpace* table)
 
 	bulk_start = time(0);
 
-	// Try to knock out the nodes first, then the links.
-	HandleSeq atoms;
-	atoms.reserve(table->get_num_nodes());
-	table->get_handles_by_type(atoms, NODE, true);
-	for (const Handle& h: atoms) { storeAtom(h); }
-
-	atoms.clear();
-	atoms.reserve(table->get_num_links());
-	table->get_handles_by_type(atoms, LINK, true);
-	for (const Handle& h: atoms) { storeAtom(h); }
+	// An empty database is filled much faster with COPY, than with
+	// one INSERT per Atom and per Valuation. Only Postgres can; the
+	// other drivers send the INSERTs in batches.
+	if (not (bulk_store and
+	         (copy_atomspace(table) or batch_atomspace(table))))
+	{
+		// Try to knock out the nodes first, then the links.
+		HandleSeq atoms;
+		atoms.reserve(table->get_num_nodes());
+		table->get_handles_by_type(atoms, NODE, true);
+		for (const Handle& h: atoms) { storeAtom(h); }
+
+		atoms.clear();
+		atoms.reserve(table->get_num_links());
+		table->get_handles_by_type(atoms, LINK, true);
+		for (const Handle& h: atoms) { storeAtom(h); }
+	}
 
 	flushStoreQueue();
 	bulk_store = false;
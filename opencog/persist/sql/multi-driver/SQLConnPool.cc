@@ -0,0 +1,203 @@
+/*
+ * SQLConnPool.cc
+ * A pool of database connections that grows and shrinks with the load.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+
+#include "SQLConnPool.h"
+
+using namespace opencog;
+
+/* ================================================================ */
+
+SQLConnPool::SQLConnPool(void) :
+	_total(0),
+	_min(1),
+	_max(1),
+	_grow_msec(50),
+	_idle_secs(60)
+{
+	clear_stats();
+}
+
+SQLConnPool::~SQLConnPool()
+{
+	close();
+}
+
+void SQLConnPool::set_bounds(size_t min, size_t max,
+                             unsigned int grow_msec, unsigned int idle_secs)
+{
+	if (min < 1) min = 1;
+	if (max < min) max = min;
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	_min = min;
+	_max = max;
+	_grow_msec = grow_msec;
+	_idle_secs = idle_secs;
+
+	// Let those who are waiting see if they can grow the pool, now.
+	_cond.notify_all();
+}
+
+void SQLConnPool::fill(void)
+{
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lck(_mtx);
+			if (_min <= _total) return;
+			_total++;
+		}
+		LLConnection* conn = nullptr;
+		try
+		{
+			conn = _factory();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(_mtx);
+			_total--;
+			throw;
+		}
+		push(conn);
+	}
+}
+
+void SQLConnPool::close(void)
+{
+	std::deque<std::pair<LLConnection*, Clock::time_point>> idle;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		idle.swap(_idle);
+		_total -= idle.size();
+	}
+	for (auto& ic : idle) delete ic.first;
+}
+
+/* ================================================================ */
+
+void SQLConnPool::note_busy(void)
+{
+	size_t busy = _total - _idle.size();
+	if (_peak < busy) _peak = busy;
+}
+
+LLConnection* SQLConnPool::value_pop(void)
+{
+	LatencyHistogram::Timer tm(_wait);
+
+	std::unique_lock<std::mutex> lck(_mtx);
+	Clock::time_point grow_at = Clock::now() +
+		std::chrono::milliseconds(_grow_msec);
+
+	while (_idle.empty())
+	{
+		if (_max <= _total)
+		{
+			_cond.wait(lck);
+			continue;
+		}
+		if (std::cv_status::no_timeout == _cond.wait_until(lck, grow_at))
+			continue;
+		if (not _idle.empty()) break;
+		if (_max <= _total) continue;
+
+		// Waited long enough; open one more, and take it.
+		_total++;
+		note_busy();
+		lck.unlock();
+		try
+		{
+			LLConnection* conn = _factory();
+			_grown++;
+			return conn;
+		}
+		catch (...)
+		{
+			lck.lock();
+			_total--;
+			_cond.notify_one();
+			throw;
+		}
+	}
+
+	LLConnection* conn = _idle.back().first;
+	_idle.pop_back();
+	note_busy();
+	return conn;
+}
+
+void SQLConnPool::push(LLConnection* conn)
+{
+	LLConnection* stale = nullptr;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		Clock::time_point now = Clock::now();
+		_idle.emplace_back(conn, now);
+
+		// The one at the front has been idle the longest.
+		if (_min < _total and 1 < _idle.size() and
+		    std::chrono::seconds(_idle_secs) < now - _idle.front().second)
+		{
+			stale = _idle.front().first;
+			_idle.pop_front();
+			_total--;
+			_reaped++;
+		}
+	}
+	_cond.notify_one();
+
+	// Closing a connection talks to the server; do it unlocked.
+	delete stale;
+}
+
+/* ================================================================ */
+
+size_t SQLConnPool::size(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _idle.size();
+}
+
+size_t SQLConnPool::total(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _total;
+}
+
+size_t SQLConnPool::in_use(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _total - _idle.size();
+}
+
+void SQLConnPool::clear_stats(void)
+{
+	_wait.clear();
+	_grown = 0;
+	_reaped = 0;
+	_peak = 0;
+}
+
+/* ============================= END OF FILE ================= */
@@ -0,0 +1,125 @@
+/*
+ * SQLConnPool.h
+ * A pool of database connections that grows and shrinks with the load.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SQL_CONN_POOL_H
+#define _OPENCOG_SQL_CONN_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "LatencyHistogram.h"
+#include "llapi.h"
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/**
+ * The connections to the database, shared by all threads. Taking one,
+ * with value_pop(), blocks when none are free; so the size of the pool
+ * limits how many SQL requests are in flight at once.
+ *
+ * The pool holds between `min` and `max` connections. It starts with
+ * `min`. When a thread has been kept waiting for a connection for
+ * longer than `grow_msec`, and there are fewer than `max`, it opens a
+ * new one for itself, rather than wait any longer. A burst of parallel
+ * loads thus gets more connections, but only as many as it really
+ * needs, and never more than `max`. When connections are returned,
+ * the one that has sat idle for longest is closed, if it has been
+ * idle for `idle_secs`, and there are more than `min`.
+ *
+ * The time spent waiting, by every caller, is kept in a histogram.
+ */
+class SQLConnPool
+{
+	typedef std::chrono::steady_clock Clock;
+
+	std::function<LLConnection*(void)> _factory;
+
+	std::mutex _mtx;
+	std::condition_variable _cond;
+
+	// The free connections; the most recently returned at the back.
+	std::deque<std::pair<LLConnection*, Clock::time_point>> _idle;
+	size_t _total;
+	size_t _min;
+	size_t _max;
+	unsigned int _grow_msec;
+	unsigned int _idle_secs;
+
+	LatencyHistogram _wait;
+	std::atomic<size_t> _grown;
+	std::atomic<size_t> _reaped;
+	std::atomic<size_t> _peak;
+
+	void note_busy(void);
+
+public:
+	SQLConnPool(void);
+	~SQLConnPool();
+
+	/// How new connections are made. Must be set before the first
+	/// connection is asked for.
+	void set_factory(std::function<LLConnection*(void)> f)
+		{ _factory = f; }
+
+	void set_bounds(size_t min, size_t max,
+	                unsigned int grow_msec, unsigned int idle_secs);
+
+	/// Open connections until there are at least `min` of them.
+	void fill(void);
+
+	/// Close all of the connections. All of them must have been
+	/// returned to the pool.
+	void close(void);
+
+	/// Take a connection; wait, or open a new one, if none are free.
+	LLConnection* value_pop(void);
+
+	/// Give back a connection taken with value_pop().
+	void push(LLConnection*);
+
+	// Statistics
+	size_t size(void);           // The number of free connections.
+	bool is_empty(void) { return 0 == size(); }
+	size_t total(void);          // The number of open connections.
+	size_t in_use(void);
+	size_t min(void) const { return _min; }
+	size_t max(void) const { return _max; }
+	size_t grown(void) const { return _grown; }
+	size_t reaped(void) const { return _reaped; }
+	size_t peak(void) const { return _peak; }
+	const LatencyHistogram& wait_times(void) const { return _wait; }
+	void clear_stats(void);
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_SQL_CONN_POOL_H
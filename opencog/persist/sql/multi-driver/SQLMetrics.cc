@@ -0,0 +1,185 @@
+/*
+ * SQLMetrics.cc
+ * Performance metrics, for dashboards and alerting.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <sstream>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "SQLAtomStorage.h"
+
+using namespace opencog;
+
+/* ================================================================ */
+
+const char* SQLAtomStorage::_op_names[NUM_OPS] =
+{
+	"get_node",
+	"get_link",
+	"fetch_incoming",
+	"load_value",
+	"store_atom",
+	"store_value",
+	"remove_atom",
+};
+
+static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+/// A ratio that is zero, rather than NaN, before anything happened.
+static double ratio(double num, double den)
+{
+	return (0.0 < den) ? num / den : 0.0;
+}
+
+/// All of the gauges and counters, other than the latencies, in the
+/// order in which they appear in the FloatValue.
+void SQLAtomStorage::gauges(std::vector<std::string>& names,
+                            std::vector<double>& vals)
+{
+	auto add = [&](const char* name, double v)
+	{
+		names.push_back(name);
+		vals.push_back(v);
+	};
+
+	add("write_queue_depth", _write_queue.get_size());
+	add("write_queue_busy_writers", _write_queue.get_busy_writers());
+
+	// Utilization is against the most the pool may grow to.
+	size_t pool_busy = conn_pool.in_use();
+	add("conn_pool_size", conn_pool.total());
+	add("conn_pool_max", conn_pool.max());
+	add("conn_pool_in_use", pool_busy);
+	add("conn_pool_utilization", ratio(pool_busy, conn_pool.max()));
+	add("conn_pool_peak_in_use", conn_pool.peak());
+	add("conn_pool_opened", conn_pool.grown());
+	add("conn_pool_closed_idle", conn_pool.reaped());
+
+	const LatencyHistogram& waits = conn_pool.wait_times();
+	add("conn_pool_wait_p50_seconds", waits.quantile(0.5));
+	add("conn_pool_wait_p99_seconds", waits.quantile(0.99));
+	add("conn_pool_wait_max_seconds", waits.max());
+
+	// The TLB answers those lookups it can, without going to the
+	// database.
+	double lookups = _num_tlb_hits + _num_get_nodes + _num_get_links;
+	add("tlb_hit_ratio", ratio(_num_tlb_hits, lookups));
+
+	// Of those that did go to the database, how many found something.
+	add("db_found_ratio", ratio(_num_got_nodes + _num_got_links,
+	                            _num_get_nodes + _num_get_links));
+
+	// Atoms queued for the writers, that were already in the queue.
+	double items = _write_queue._item_count;
+	add("write_queue_dup_ratio", ratio(_write_queue._duplicate_count, items));
+
+	size_t dirty;
+	{
+		std::lock_guard<std::mutex> lck(_wb_mutex);
+		dirty = _dirty.size();
+	}
+	add("write_back_dirty", dirty);
+	add("write_back_coalesce_ratio", ratio(_wb_coalesced, _wb_stores));
+
+	size_t working;
+	{
+		std::lock_guard<std::mutex> lck(_ws_mutex);
+		working = _ws_ring.size() - _ws_free.size();
+	}
+	add("working_set_atoms", working);
+	add("working_set_extracted", _ws_evictions);
+
+	add("loads", _load_count);
+	add("stores", _store_count);
+	add("tlb_atoms", _tlbuf.size());
+}
+
+/// Put the metrics onto this StorageNode, as a FloatValue at the key
+/// (Predicate "*-metrics-*"). The names of the numbers in it are a
+/// StringValue at (Predicate "*-metric-names-*"). Latencies are in
+/// seconds; for each operation, there is its count, the median, the
+/// 99th percentile, and the slowest.
+void SQLAtomStorage::update_metrics(void)
+{
+	if (nullptr == _atom_space) return;
+
+	std::vector<std::string> names;
+	std::vector<double> vals;
+	for (int op = 0; op < NUM_OPS; op++)
+	{
+		const LatencyHistogram& lh = _latency[op];
+		std::string pfx = _op_names[op];
+		names.push_back(pfx + "_count");
+		vals.push_back(lh.count());
+		names.push_back(pfx + "_p50_seconds");
+		vals.push_back(lh.quantile(0.5));
+		names.push_back(pfx + "_p99_seconds");
+		vals.push_back(lh.quantile(0.99));
+		names.push_back(pfx + "_max_seconds");
+		vals.push_back(lh.max());
+	}
+	gauges(names, vals);
+
+	setValue(_atom_space->add_node(PREDICATE_NODE, "*-metrics-*"),
+	         createFloatValue(std::move(vals)));
+	setValue(_atom_space->add_node(PREDICATE_NODE, "*-metric-names-*"),
+	         createStringValue(std::move(names)));
+}
+
+/// The same metrics, in the Prometheus text exposition format, ready
+/// to be served to a scraper. The latencies are summaries; the rest
+/// are gauges. The URI is not given as a label, as it may hold a
+/// password.
+std::string SQLAtomStorage::prometheus(void)
+{
+	update_metrics();
+
+	std::stringstream ps;
+	ps << "# HELP atomspace_sql_latency_seconds "
+	      "Time taken by SQL backend operations.\n"
+	   << "# TYPE atomspace_sql_latency_seconds summary\n";
+	for (int op = 0; op < NUM_OPS; op++)
+	{
+		const LatencyHistogram& lh = _latency[op];
+		std::string lbl = std::string("op=\"") + _op_names[op] + "\"";
+		for (double q : QUANTILES)
+			ps << "atomspace_sql_latency_seconds{" << lbl
+			   << ",quantile=\"" << q << "\"} " << lh.quantile(q) << "\n";
+		ps << "atomspace_sql_latency_seconds_sum{" << lbl << "} "
+		   << lh.sum() << "\n"
+		   << "atomspace_sql_latency_seconds_count{" << lbl << "} "
+		   << lh.count() << "\n";
+	}
+
+	std::vector<std::string> names;
+	std::vector<double> vals;
+	gauges(names, vals);
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		const std::string& n = names[i];
+		ps << "# TYPE atomspace_sql_" << n << " gauge\n"
+		   << "atomspace_sql_" << n << " " << vals[i] << "\n";
+	}
+	return ps.str();
+}
+
+/* ============================= END OF FILE ================= */
@@ -67,8 +67,13 @@ void SQLPersistSCM::init(void)
     define_scheme_primitive("sql-stats", &SQLPersistSCM::do_stats, this, "persist-sql");
     define_scheme_primitive("sql-clear-cache", &SQLPersistSCM::do_clear_cache, this, "persist-sql");
     define_scheme_primitive("sql-clear-stats", &SQLPersistSCM::do_clear_stats, this, "persist-sql");
+    define_scheme_primitive("sql-metrics", &SQLPersistSCM::do_metrics, this, "persist-sql");
     define_scheme_primitive("sql-set-hilo-watermarks!", &SQLPersistSCM::do_set_hilo, this, "persist-sql");
     define_scheme_primitive("sql-set-stall-writers!", &SQLPersistSCM::do_set_stall, this, "persist-sql");
+    define_scheme_primitive("sql-set-write-back!", &SQLPersistSCM::do_set_write_back, this, "persist-sql");
+    define_scheme_primitive("sql-set-fetch-size!", &SQLPersistSCM::do_set_fetch_size, this, "persist-sql");
+    define_scheme_primitive("sql-set-working-set!", &SQLPersistSCM::do_set_working_set, this, "persist-sql");
+    define_scheme_primitive("sql-set-conn-pool!", &SQLPersistSCM::do_set_conn_pool, this, "persist-sql");
 }
 
 SQLPersistSCM::~SQLPersistSCM()
@@ -165,6 +170,16 @@ void SQLPersistSCM::do_clear_stats(void)
     _storage->clear_stats();
 }
 
+std::string SQLPersistSCM::do_metrics(void)
+{
+    if (nullptr == _storage) {
+        printf("sql-stats: Database not open\n");
+        return "";
+    }
+
+    return _storage->prometheus();
+}
+
 void SQLPersistSCM::do_set_hilo(int hi, int lo)
 {
     if (nullptr == _storage) {
@@ -185,6 +200,52 @@ void SQLPersistSCM::do_set_stall(bool stall)
     _storage->set_stall_writers(stall);
 }
 
+void SQLPersistSCM::do_set_write_back(int max_dirty, int msec)
+{
+    if (nullptr == _storage) {
+        printf("sql-stats: Database not open\n");
+        return;
+    }
+
+    if (max_dirty < 0) max_dirty = 0;
+    if (msec < 0) msec = 0;
+    _storage->set_write_back(max_dirty, msec);
+}
+
+void SQLPersistSCM::do_set_fetch_size(int sz)
+{
+    if (nullptr == _storage) {
+        printf("sql-stats: Database not open\n");
+        return;
+    }
+
+    _storage->set_fetch_size(0 < sz ? sz : 1);
+}
+
+void SQLPersistSCM::do_set_working_set(int max_atoms)
+{
+    if (nullptr == _storage) {
+        printf("sql-stats: Database not open\n");
+        return;
+    }
+
+    _storage->set_working_set(0 < max_atoms ? max_atoms : 0);
+}
+
+void SQLPersistSCM::do_set_conn_pool(int min, int max, int msec, int secs)
+{
+    if (nullptr == _storage) {
+        printf("sql-stats: Database not open\n");
+        return;
+    }
+
+    if (min < 1) min = 1;
+    if (max < 1) max = 1;
+    if (msec < 0) msec = 0;
+    if (secs < 0) secs = 0;
+    _storage->set_conn_pool(min, max, msec, secs);
+}
+
 void opencog_persist_sql_init(void)
 {
     static SQLPersistSCM patty(NULL);
@@ -59,9 +59,14 @@ public:
     void do_stats(void);
     void do_clear_cache(void);
     void do_clear_stats(void);
+    std::string do_metrics(void);
 
     void do_set_hilo(int, int);
     void do_set_stall(bool);
+    void do_set_write_back(int, int);
+    void do_set_fetch_size(int);
+    void do_set_working_set(int);
+    void do_set_conn_pool(int, int, int, int);
 
 }; // class
 
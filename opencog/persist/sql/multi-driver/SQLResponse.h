@@ -58,22 +58,27 @@ class SQLAtomStorage::Response
 		const char* outlist;
 		int height;
 
+		// Set for prepared statements, whose results might be binary.
+		bool typed;
+		std::vector<UUID> oset;
+
 		// Values
 		double *floatval;
 		const char *stringval;
 		UUID *linkval;
 
 	private:
-		concurrent_stack<LLConnection*>& _pool;
+		SQLConnPool& _pool;
 		LLConnection* _conn;
 
 	public:
-		Response(concurrent_stack<LLConnection*>& pool) :
+		Response(SQLConnPool& pool) :
 		    rs(nullptr),
 		    itype(0),
 		    name(nullptr),
 		    outlist(nullptr),
 		    height(0),
+		    typed(false),
 		    floatval(0),
 		    stringval(nullptr),
 		    linkval(nullptr),
@@ -83,6 +88,7 @@ class SQLAtomStorage::Response
 		    store(nullptr),
 		    pvec(nullptr),
 		    uvec(nullptr),
+		    kaset(nullptr),
 		    tname(""),
 		    fltval(0),
 		    strval(nullptr),
@@ -121,6 +127,30 @@ class SQLAtomStorage::Response
 		{
 			exec(str.c_str());
 		}
+
+		// The statement is prepared once per connection; the results
+		// must be read with get_atom_row() or the typed getters.
+		void exec_prepared(const char * name, const char * stmt,
+		                   int nparams, const char * const * params)
+		{
+			if (rs) rs->release();
+			if (nullptr == _conn) _conn = _pool.value_pop();
+			rs = _conn->exec_prepared(name, stmt, nparams, params);
+			typed = true;
+			col_uuid = -1;
+		}
+		void exec_prepared(const char * name, const char * stmt,
+		                   int nparams, const char * const * params,
+		                   const int * lengths, const int * formats,
+		                   bool trial_run = false)
+		{
+			if (rs) rs->release();
+			if (nullptr == _conn) _conn = _pool.value_pop();
+			rs = _conn->exec_prepared(name, stmt, nparams, params,
+			                          lengths, formats, trial_run);
+			typed = true;
+			col_uuid = -1;
+		}
 		void try_exec(const std::string& str)
 		{
 			try_exec(str.c_str());
@@ -153,10 +183,34 @@ class SQLAtomStorage::Response
 			return false;
 		}
 
+		// Read the Atom in the current row.
+		int col_uuid, col_type, col_name, col_outgoing;
+		void get_atom_row(void)
+		{
+			if (not typed)
+			{
+				rs->foreach_column(&Response::create_atom_column_cb, this);
+				return;
+			}
+
+			if (0 > col_uuid)
+			{
+				col_uuid = rs->get_column_index("uuid");
+				col_type = rs->get_column_index("type");
+				col_name = rs->get_column_index("name");
+				col_outgoing = rs->get_column_index("outgoing");
+			}
+			uuid = rs->get_column_int(col_uuid);
+			itype = rs->get_column_int(col_type);
+			name = rs->get_column_text(col_name);
+			oset.clear();
+			rs->get_column_int_array(col_outgoing, oset);
+		}
+
 		bool create_atom_cb(void)
 		{
 			// printf ("---- New atom found ----\n");
-			rs->foreach_column(&Response::create_atom_column_cb, this);
+			get_atom_row();
 
 			return true;
 		}
@@ -166,7 +220,7 @@ class SQLAtomStorage::Response
 		bool load_all_atoms_cb(void)
 		{
 			// printf ("---- New atom found ----\n");
-			rs->foreach_column(&Response::create_atom_column_cb, this);
+			get_atom_row();
 
 			// Two different throws mighht be caught here:
 			// 1) DB has an atom type that is not defined in the atomspace.
@@ -198,7 +252,7 @@ class SQLAtomStorage::Response
 		bool load_if_not_exists_cb(void)
 		{
 			// printf ("---- New atom found ----\n");
-			rs->foreach_column(&Response::create_atom_column_cb, this);
+			get_atom_row();
 
 			Handle h(store->_tlbuf.getAtom(uuid));
 			if (nullptr == h)
@@ -224,7 +278,7 @@ class SQLAtomStorage::Response
 		bool fetch_incoming_set_cb(void)
 		{
 			// printf ("---- New atom found ----\n");
-			rs->foreach_column(&Response::create_atom_column_cb, this);
+			get_atom_row();
 
 			// Note, unlike the above 'load' routines, this merely fetches
 			// the atoms, and returns a vector of them.  They are loaded
@@ -252,6 +306,15 @@ class SQLAtomStorage::Response
 			return false;
 		}
 
+		// The (key, atom) pairs of RETURNING key, atom.
+		std::set<std::pair<UUID, UUID>> *kaset;
+		bool key_atom_cb(void)
+		{
+			kaset->insert({(UUID) rs->get_column_int(0),
+			               (UUID) rs->get_column_int(1)});
+			return false;
+		}
+
 		// Types ------------------------------------------
 		// deal with the type-to-id map
 		bool type_cb(void)
@@ -204,7 +204,7 @@ void SQLAtomStorage::UUID_manager::reset_uuid_pool(UUID maxuuid)
 		"BEGIN"
 		"   IF (SELECT count(*) FROM pg_stat_activity WHERE"
 		"           datname=(SELECT current_database())) = "
-		+ std::to_string(that->_initial_conn_pool_size) +
+		+ std::to_string(that->conn_pool.total()) +
 		" THEN"
 		"      under := " + std::to_string(maxuuid + 1) +
 		"            - (" + select_increment + ");"
@@ -28,6 +28,8 @@
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/atom_types/NameServer.h>
 #include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/Float32Value.h>
+#include <opencog/atoms/value/IntValue.h>
 #include <opencog/atoms/value/LinkValue.h>
 #include <opencog/atoms/value/StringValue.h>
 #include <opencog/atoms/base/Valuation.h>
@@ -35,6 +37,7 @@
 
 #include "SQLAtomStorage.h"
 #include "SQLResponse.h"
+#include "pg-binary.h"
 
 using namespace opencog;
 
@@ -71,6 +74,42 @@ std::string SQLAtomStorage::float_to_string(const FloatValuePtr& fvle)
 	return str;
 }
 
+/// Single-precision floats share the floatvalue column with the
+/// doubles; widening them is exact, so they read back unchanged.
+std::string SQLAtomStorage::float32_to_string(const Float32ValuePtr& fvle)
+{
+	bool not_first = false;
+	std::string str = "\'{";
+	for (float v : fvle->value())
+	{
+		if (not_first) str += ", ";
+		not_first = true;
+
+		char buf[40];
+		snprintf(buf, 40, "%.9g", v);
+		str += buf;
+	}
+	str += "}\'";
+	return str;
+}
+
+/// Integers are stored as decimal strings in the stringvalue column,
+/// since the floatvalue column cannot hold them exactly past 2^53,
+/// and I don't want to change the table schema.
+std::string SQLAtomStorage::int_to_string(const IntValuePtr& ivle)
+{
+	bool not_first = false;
+	std::string str = "\'{";
+	for (int64_t v : ivle->value())
+	{
+		if (not_first) str += ", ";
+		not_first = true;
+		str += std::to_string(v);
+	}
+	str += "}\'";
+	return str;
+}
+
 std::string SQLAtomStorage::string_to_string(const StringValuePtr& svle)
 {
 	const char delim {'\\'};
@@ -111,6 +150,74 @@ std::string SQLAtomStorage::link_to_string(const LinkValuePtr& lvle)
 	return str;
 }
 
+/* ================================================================ */
+// The same arrays, in the binary format of Postgres; each is the
+// field of a COPY row, or, after the length, a binary parameter.
+// The server copies these in as they are, with nothing to parse.
+
+std::string SQLAtomStorage::oset_to_binary(const HandleSeq& out)
+{
+	std::string buf;
+	size_t at = begin_array(buf, INT8OID, out.size());
+	for (const Handle& h : out)
+		put_int8(buf, get_uuid(h));
+	end_array(buf, at);
+	return buf;
+}
+
+std::string SQLAtomStorage::float_to_binary(const FloatValuePtr& fvle)
+{
+	const std::vector<double>& fv = fvle->value();
+	std::string buf;
+	size_t at = begin_array(buf, FLOAT8OID, fv.size());
+	for (double d : fv) put_double(buf, d);
+	end_array(buf, at);
+	return buf;
+}
+
+std::string SQLAtomStorage::float32_to_binary(const Float32ValuePtr& fvle)
+{
+	const std::vector<float>& fv = fvle->value();
+	std::string buf;
+	size_t at = begin_array(buf, FLOAT8OID, fv.size());
+	for (float f : fv) put_double(buf, f);
+	end_array(buf, at);
+	return buf;
+}
+
+/// As decimal strings; see int_to_string().
+std::string SQLAtomStorage::int_to_binary(const IntValuePtr& ivle)
+{
+	const std::vector<int64_t>& iv = ivle->value();
+	std::string buf;
+	size_t at = begin_array(buf, TEXTOID, iv.size());
+	for (int64_t n : iv) put_text(buf, std::to_string(n));
+	end_array(buf, at);
+	return buf;
+}
+
+/// No escapes needed; the strings go as they are.
+std::string SQLAtomStorage::string_to_binary(const StringValuePtr& svle)
+{
+	const std::vector<std::string>& sv = svle->value();
+	std::string buf;
+	size_t at = begin_array(buf, TEXTOID, sv.size());
+	for (const std::string& str : sv) put_text(buf, str);
+	end_array(buf, at);
+	return buf;
+}
+
+std::string SQLAtomStorage::link_to_binary(const LinkValuePtr& lvle)
+{
+	const ValueSeq& vs = lvle->value();
+	std::string buf;
+	size_t at = begin_array(buf, INT8OID, vs.size());
+	for (const ValuePtr& pap : vs)
+		put_int8(buf, storeValue(pap));
+	end_array(buf, at);
+	return buf;
+}
+
 /* ================================================================ */
 #define BUFSZ 250
 
@@ -178,6 +285,28 @@ void SQLAtomStorage::deleteValuation(Response& rp, UUID key_uid, UUID atom_uid)
 	}
 }
 
+/// Return the UUID of the atom, storing the atom first, if needed.
+///
+/// We must make sure the key (and the atom) are in the database
+/// BEFORE they are used in any valuation; else a 'foreign key
+/// constraint' error will be thrown.  And to do that, we must make
+/// sure the store completes, before some other thread gets its
+/// fingers on the key.
+UUID SQLAtomStorage::stored_uuid(const Handle& h)
+{
+	std::lock_guard<std::mutex> create_lock(_valuation_mutex);
+	UUID uuid = TLB::INVALID_UUID;
+	try {
+		uuid = check_uuid(h);
+	} catch (const NotFoundException& ex) {}
+	if (TLB::INVALID_UUID == uuid)
+	{
+		do_store_atom(h);
+		uuid = check_uuid(h);
+	}
+	return uuid;
+}
+
 /**
  * Store a valuation. Return an integer ID for that valuation.
  * Thread-safe.
@@ -197,36 +326,8 @@ void SQLAtomStorage::storeValuation(const Handle& key,
 	std::string coda;
 
 	// Get UUID from the TLB.
-	UUID kuid = TLB::INVALID_UUID;
-	{
-		// We must make sure the key is in the database BEFORE it
-		// is used in any valuation; else a 'foreign key constraint'
-		// error will be thrown.  And to do that, we must make sure
-		// the store completes, before some other thread gets its
-		// fingers on the key.
-		std::lock_guard<std::mutex> create_lock(_valuation_mutex);
-		try {
-			kuid = check_uuid(key);
-		} catch (const NotFoundException& ex) {}
-		if (TLB::INVALID_UUID == kuid)
-		{
-			do_store_atom(key);
-			kuid = check_uuid(key);
-		}
-	}
-
-	UUID auid = TLB::INVALID_UUID;
-	{
-		std::lock_guard<std::mutex> create_lock(_valuation_mutex);
-		try {
-			auid = check_uuid(atom);
-		} catch (const NotFoundException& ex) {}
-		if (TLB::INVALID_UUID == auid)
-		{
-			do_store_atom(atom);
-			auid = check_uuid(atom);
-		}
-	}
+	UUID kuid = stored_uuid(key);
+	UUID auid = stored_uuid(atom);
 
 	char kidbuff[BUFSZ];
 	snprintf(kidbuff, BUFSZ, "%lu", kuid);
@@ -246,25 +347,83 @@ void SQLAtomStorage::storeValuation(const Handle& key,
 	Type vtype = pap->get_type();
 	STMTI("type", storing_typemap[vtype]);
 
+	// With libpq, the array goes as a binary parameter, instead.
+	std::string bcol;
+	std::string bval;
+
 	if (nameserver().isA(vtype, FLOAT_VALUE))
 	{
 		FloatValuePtr fvp = FloatValueCast(pap);
-		std::string fstr = float_to_string(fvp);
-		STMT("floatvalue", fstr);
+		if (_use_libpq)
+		{
+			bcol = "floatvalue";
+			bval = float_to_binary(fvp);
+		}
+		else
+		{
+			std::string fstr = float_to_string(fvp);
+			STMT("floatvalue", fstr);
+		}
+	}
+	else
+	if (nameserver().isA(vtype, FLOAT32_VALUE))
+	{
+		Float32ValuePtr fvp = Float32ValueCast(pap);
+		if (_use_libpq)
+		{
+			bcol = "floatvalue";
+			bval = float32_to_binary(fvp);
+		}
+		else
+		{
+			std::string fstr = float32_to_string(fvp);
+			STMT("floatvalue", fstr);
+		}
+	}
+	else
+	if (nameserver().isA(vtype, INT_VALUE))
+	{
+		IntValuePtr ivp = IntValueCast(pap);
+		if (_use_libpq)
+		{
+			bcol = "stringvalue";
+			bval = int_to_binary(ivp);
+		}
+		else
+		{
+			std::string istr = int_to_string(ivp);
+			STMT("stringvalue", istr);
+		}
 	}
 	else
 	if (nameserver().isA(vtype, STRING_VALUE))
 	{
 		StringValuePtr fvp = StringValueCast(pap);
-		std::string sstr = string_to_string(fvp);
-		STMT("stringvalue", sstr);
+		if (_use_libpq)
+		{
+			bcol = "stringvalue";
+			bval = string_to_binary(fvp);
+		}
+		else
+		{
+			std::string sstr = string_to_string(fvp);
+			STMT("stringvalue", sstr);
+		}
 	}
 	else
 	if (nameserver().isA(vtype, LINK_VALUE))
 	{
 		LinkValuePtr fvp = LinkValueCast(pap);
-		std::string lstr = link_to_string(fvp);
-		STMT("linkvalue", lstr);
+		if (_use_libpq)
+		{
+			bcol = "linkvalue";
+			bval = link_to_binary(fvp);
+		}
+		else
+		{
+			std::string lstr = link_to_string(fvp);
+			STMT("linkvalue", lstr);
+		}
 	}
 	else
 	if (nameserver().isA(vtype, ATOM))
@@ -287,9 +446,19 @@ void SQLAtomStorage::storeValuation(const Handle& key,
 		// Double-duty -- re-use the linkvalue field for solo atoms.
 		// This is kind-of cheating but I don't want to change
 		// the table schema.
-		char uidbuff[BUFSZ];
-		snprintf(uidbuff, BUFSZ, "\'{%lu}\'", uuid);
-		STMT("linkvalue", uidbuff);
+		if (_use_libpq)
+		{
+			bcol = "linkvalue";
+			size_t at = begin_array(bval, INT8OID, 1);
+			put_int8(bval, uuid);
+			end_array(bval, at);
+		}
+		else
+		{
+			char uidbuff[BUFSZ];
+			snprintf(uidbuff, BUFSZ, "\'{%lu}\'", uuid);
+			STMT("linkvalue", uidbuff);
+		}
 	}
 	else
 		throw IOException(TRACE_INFO,
@@ -298,7 +467,7 @@ void SQLAtomStorage::storeValuation(const Handle& key,
 
 	std::string insert = cols + vals + coda;
 
-	std::lock_guard<std::mutex> lck(_value_mutex[auid%NUMVMUT]);
+	std::lock_guard<ValueMutex> lck(_value_mutex[auid%NUMVMUT]);
 	// Use a transaction, so that other threads/users see the
 	// valuation update atomically. That is, two sets of
 	// users/threads can safely set the same valuation at the same
@@ -310,7 +479,21 @@ void SQLAtomStorage::storeValuation(const Handle& key,
 	// If there's an existing valuation, delete it.
 	deleteValuation(rp, kuid, auid);
 
-	rp.exec(insert.c_str());
+	if (bcol.empty())
+		rp.exec(insert.c_str());
+	else
+	{
+		std::string tybuff(std::to_string(storing_typemap[vtype]));
+		std::string name("insert_" + bcol);
+		std::string stmt("INSERT INTO Valuations (key, atom, type, " +
+			bcol + ") VALUES ($1, $2, $3, $4) ON CONFLICT DO NOTHING;");
+		const char* params[4] = {kidbuff, aidbuff, tybuff.c_str(),
+		                         param_bytes(bval)};
+		int lengths[4] = {0, 0, 0, param_length(bval)};
+		int formats[4] = {0, 0, 0, 1};
+		rp.exec_prepared(name.c_str(), stmt.c_str(), 4, params,
+		                 lengths, formats);
+	}
 	rp.exec("COMMIT;");
 
 	_valuation_stores++;
@@ -341,6 +524,20 @@ SQLAtomStorage::VUID SQLAtomStorage::storeValue(const ValuePtr& pap)
 		STMT("floatvalue", fstr);
 	}
 	else
+	if (nameserver().isA(vtype, FLOAT32_VALUE))
+	{
+		Float32ValuePtr fvp = Float32ValueCast(pap);
+		std::string fstr = float32_to_string(fvp);
+		STMT("floatvalue", fstr);
+	}
+	else
+	if (nameserver().isA(vtype, INT_VALUE))
+	{
+		IntValuePtr ivp = IntValueCast(pap);
+		std::string istr = int_to_string(ivp);
+		STMT("stringvalue", istr);
+	}
+	else
 	if (nameserver().isA(vtype, STRING_VALUE))
 	{
 		StringValuePtr fvp = StringValueCast(pap);
@@ -496,6 +693,36 @@ ValuePtr SQLAtomStorage::doUnpackValue(Response& rp)
 			return ValueCast(TruthValue::factory(vtype, fltarr));
 	}
 
+	// Same as above, narrowed back to single precision.
+	if (vtype == FLOAT32_VALUE)
+	{
+		std::vector<float> fltarr;
+		char *p = (char *) rp.fltval;
+		if (p and *p == '{') p++;
+		while (p)
+		{
+			if (*p == '}' or *p == '\0') break;
+			fltarr.emplace_back(strtof(p, &p));
+			p++; // skip over  comma
+		}
+		return createFloat32Value(std::move(fltarr));
+	}
+
+	// The integers are in rp.strval, of the form {1,2,3}
+	if (vtype == INT_VALUE)
+	{
+		std::vector<int64_t> intarr;
+		char *p = (char *) rp.strval;
+		if (p and *p == '{') p++;
+		while (p)
+		{
+			if (*p == '}' or *p == '\0') break;
+			intarr.emplace_back(strtoll(p, &p, 10));
+			p++; // skip over  comma
+		}
+		return createIntValue(std::move(intarr));
+	}
+
 	// We expect rp.lnkval to be a comma-separated list of
 	// vuid's, which we then fetch recursively.
 	if (vtype == LINK_VALUE)
@@ -519,7 +746,7 @@ ValuePtr SQLAtomStorage::doUnpackValue(Response& rp)
 			p = strchr(p, ',');
 			if (p) p++;
 		}
-		return createLinkValue(lnkarr);
+		return createLinkValue(std::move(lnkarr));
 	}
 
 	// Well, it could be an atom!
@@ -625,6 +852,7 @@ void SQLAtomStorage::loadValue(const Handle& atom, const Handle& key)
 {
 	rethrow();
 	if (nullptr == atom) return;
+	LatencyHistogram::Timer tm(_latency[OP_LOAD_VALUE]);
 	try
 	{
 		char buff[BUFSZ];
@@ -642,12 +870,18 @@ void SQLAtomStorage::loadValue(const Handle& atom, const Handle& key)
 		rp.atom = nullptr;
 	}
 	catch (const NotFoundException& ex) {}
+	ws_touch(atom);
+	ws_evict();
 }
 
 void SQLAtomStorage::storeValue(const Handle& atom, const Handle& key)
 {
 	rethrow();
 	if (nullptr == atom) return;
+	LatencyHistogram::Timer tm(_latency[OP_STORE_VALUE]);
+
+	// With the write-back cache on, just remember that it changed.
+	if (wb_enqueue(atom, key)) return;
 
 	ValuePtr pap = atom->getValue(key);
 	if (nullptr == pap)
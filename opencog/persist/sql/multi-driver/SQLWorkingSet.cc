@@ -0,0 +1,176 @@
+/*
+ * SQLWorkingSet.cc
+ * A bounded working set of Atoms, for on-demand use.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/persist/tlb/TLB.h>
+
+#include "SQLAtomStorage.h"
+
+using namespace opencog;
+
+/* ================================================================ */
+
+/// Keep no more than `max_atoms` of the Atoms fetched on demand in
+/// the AtomSpace; zero, the default, means no limit. Atoms brought in
+/// by loadAtomSpace() and loadType() are not counted; those loads are
+/// meant to bring in everything.
+///
+/// The Atoms fetched are kept on a CLOCK: each one is marked when it
+/// is fetched, or fetched again. When there are too many, the hand
+/// goes around, unmarking the marked ones, and extracting the first
+/// unmarked ones that nothing else holds on to: no Link in the
+/// AtomSpace contains them, and no one but the AtomSpace and the TLB
+/// has a Handle to them. Thus, Atoms in use are never pulled out from
+/// under the user; but Values changed on an Atom, and not stored, are
+/// lost when it is extracted, as with `cog-extract!`.
+void SQLAtomStorage::set_working_set(size_t max_atoms)
+{
+	std::lock_guard<std::mutex> lck(_ws_mutex);
+	_ws_max_atoms = max_atoms;
+	if (0 < max_atoms) return;
+
+	_ws_ring.clear();
+	_ws_free.clear();
+	_ws_index.clear();
+	_ws_hand = 0;
+}
+
+/// Note that the Atom was just fetched.
+void SQLAtomStorage::ws_touch(const Handle& h)
+{
+	if (nullptr == h or nullptr == h->getAtomSpace()) return;
+
+	std::lock_guard<std::mutex> lck(_ws_mutex);
+	if (0 == _ws_max_atoms) return;
+
+	const Atom* a = h.get();
+	auto it = _ws_index.find(a);
+	if (_ws_index.end() != it)
+	{
+		// The address may have been reused, by a new Atom, since the
+		// old one went away.
+		WSEntry& e = _ws_ring[it->second];
+		if (e.atom.lock() != h) e.atom = AtomPtr(h);
+		e.used = true;
+		return;
+	}
+
+	WSEntry e = {AtomPtr(h), a, true, false};
+	if (_ws_free.empty())
+	{
+		_ws_index.emplace(a, _ws_ring.size());
+		_ws_ring.push_back(e);
+		return;
+	}
+
+	size_t slot = _ws_free.back();
+	_ws_free.pop_back();
+	_ws_index.emplace(a, slot);
+	_ws_ring[slot] = e;
+}
+
+/// The references to an Atom that exist when no one is using it: the
+/// AtomSpace holds one, and the TLB holds two.
+size_t SQLAtomStorage::ws_idle_refs(const Handle& h)
+{
+	UUID uuid = _tlbuf.getUUID(h);
+	if (TLB::INVALID_UUID == uuid) return 1;
+	if (_tlbuf.getAtom(uuid).get() != h.get()) return 1;
+	return 3;
+}
+
+/// Extract cold Atoms, until there are a sixteenth fewer than the
+/// limit. The hand goes around at most twice; if everything is in
+/// use, nothing can be done, and the working set stays too big.
+void SQLAtomStorage::ws_evict(void)
+{
+	{
+		std::lock_guard<std::mutex> lck(_ws_mutex);
+		if (0 == _ws_max_atoms) return;
+		if (_ws_ring.size() - _ws_free.size() <= _ws_max_atoms) return;
+	}
+
+	// Values waiting in the write-back cache hold on to their Atoms;
+	// write them out, so that those Atoms can go.
+	wb_drain();
+
+	auto release = [&](size_t slot)
+	{
+		WSEntry& e = _ws_ring[slot];
+		_ws_index.erase(e.addr);
+		e.atom.reset();
+		e.free = true;
+		_ws_free.push_back(slot);
+	};
+
+	std::lock_guard<std::mutex> lck(_ws_mutex);
+	size_t low = _ws_max_atoms - _ws_max_atoms / 16;
+	size_t steps = 2 * _ws_ring.size();
+
+	for (; 0 < steps and low < _ws_ring.size() - _ws_free.size(); steps--)
+	{
+		if (_ws_ring.size() <= _ws_hand) _ws_hand = 0;
+		size_t slot = _ws_hand++;
+		WSEntry& e = _ws_ring[slot];
+		if (e.free) continue;
+
+		Handle h(e.atom.lock());
+		if (nullptr == h)
+		{
+			// Gone already; someone else extracted it.
+			release(slot);
+			continue;
+		}
+
+		if (e.used)
+		{
+			e.used = false;
+			continue;
+		}
+
+		// Extracted, but still in use elsewhere; not ours any more.
+		AtomSpace* as = h->getAtomSpace();
+		if (nullptr == as)
+		{
+			release(slot);
+			continue;
+		}
+		if (not h->isIncomingSetEmpty()) continue;
+
+		// One more for the `h` right here.
+		if (ws_idle_refs(h) + 1 < (size_t) h.use_count()) continue;
+
+		UUID uuid = _tlbuf.getUUID(h);
+		_tlbuf.purgeAtom(uuid);
+		if (not as->extract_atom(h))
+		{
+			if (TLB::INVALID_UUID != uuid) _tlbuf.addAtom(h, uuid);
+			continue;
+		}
+
+		release(slot);
+		_ws_evictions++;
+	}
+}
+
+/* ============================= END OF FILE ================= */
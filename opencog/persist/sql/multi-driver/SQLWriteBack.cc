@@ -0,0 +1,313 @@
+/*
+ * SQLWriteBack.cc
+ * Coalescing write-back of Values.
+ *
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <sstream>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/persist/tlb/TLB.h>
+
+#include "SQLAtomStorage.h"
+#include "SQLResponse.h"
+
+using namespace opencog;
+
+// Rows per INSERT statement.
+#define WB_ROWS 100
+
+/* ================================================================ */
+
+/// Turn the write-back cache on, or off, with a `max_dirty` of zero.
+/// Dirty Values are written `window_msec` after the first of them
+/// changed, or sooner, if there are `max_dirty` of them. Whatever was
+/// dirty under the old settings is written out first.
+void SQLAtomStorage::set_write_back(size_t max_dirty,
+                                    unsigned int window_msec)
+{
+	{
+		std::lock_guard<std::mutex> lck(_wb_mutex);
+		_wb_max_dirty = max_dirty;
+		_wb_window_msec = window_msec;
+	}
+	wb_stop();
+
+	if (0 == max_dirty) return;
+	{
+		std::lock_guard<std::mutex> lck(_wb_mutex);
+		_wb_stop = false;
+	}
+	_wb_writer = std::thread(&SQLAtomStorage::wb_loop, this);
+}
+
+void SQLAtomStorage::wb_stop(void)
+{
+	{
+		std::lock_guard<std::mutex> lck(_wb_mutex);
+		_wb_stop = true;
+	}
+	_wb_work.notify_all();
+
+	// The writer writes out everything that is dirty, before exiting.
+	if (_wb_writer.joinable()) _wb_writer.join();
+}
+
+/// Return false if there is no cache; the caller must then store
+/// the Value itself.
+bool SQLAtomStorage::wb_enqueue(const Handle& atom, const Handle& key)
+{
+	std::unique_lock<std::mutex> lck(_wb_mutex);
+	if (0 == _wb_max_dirty) return false;
+
+	if (not _dirty.insert({atom, key}).second)
+	{
+		_wb_coalesced++;
+		return true;
+	}
+	_wb_stores++;
+
+	if (_wb_max_dirty <= _dirty.size())
+	{
+		_wb_work.notify_one();
+
+		// Don't let a fast producer run arbitrarily far ahead.
+		_wb_done.wait(lck, [&] {
+			return _dirty.size() < _wb_max_dirty or _wb_stop; });
+	}
+	return true;
+}
+
+/// Wait until everything dirty so far has been written.
+void SQLAtomStorage::wb_drain(void)
+{
+	std::unique_lock<std::mutex> lck(_wb_mutex);
+	if (_dirty.empty() and not _wb_writing) return;
+
+	_wb_flush = true;
+	_wb_work.notify_all();
+	_wb_done.wait(lck, [&] { return _dirty.empty() and not _wb_writing; });
+}
+
+/* ================================================================ */
+// The writer thread.
+
+void SQLAtomStorage::wb_loop(void)
+{
+	std::vector<std::pair<Handle, Handle>> batch;
+
+	std::unique_lock<std::mutex> lck(_wb_mutex);
+	while (true)
+	{
+		_wb_work.wait(lck, [&] { return _wb_stop or not _dirty.empty(); });
+		if (_dirty.empty()) break;
+
+		// Let the updates pile up, and coalesce, for a while.
+		_wb_work.wait_for(lck, std::chrono::milliseconds(_wb_window_msec),
+			[&] { return _wb_stop or _wb_flush or
+			             _wb_max_dirty <= _dirty.size(); });
+
+		// Take everything dirty; from here on, a Value stored again
+		// is written again.
+		batch.assign(_dirty.begin(), _dirty.end());
+		_dirty.clear();
+		_wb_flush = false;
+		_wb_writing = true;
+		_wb_done.notify_all();
+		lck.unlock();
+
+		// Errors are thrown at the next user, as for the write queue.
+		try { wb_write(batch); }
+		catch (...) { _async_write_queue_exception = std::current_exception(); }
+		batch.clear();
+
+		lck.lock();
+		_wb_writing = false;
+		_wb_done.notify_all();
+	}
+}
+
+/// Write the current Values of the (atom, key) pairs. Numbers and
+/// strings are upserted, many rows per statement. Anything else, or
+/// a Valuation that used to hold a LinkValue or an Atom, goes the
+/// ordinary way, through storeValuation(), which takes care to delete
+/// the rows that an old LinkValue had in the Values table.
+void SQLAtomStorage::wb_write(const std::vector<std::pair<Handle, Handle>>& batch)
+{
+	setup_typemap();
+
+	struct Row
+	{
+		UUID kuid;
+		UUID auid;
+		const Handle* key;
+		const Handle* atom;
+		ValuePtr pap;
+	};
+	std::vector<Row> rows;
+	rows.reserve(WB_ROWS);
+
+	auto upsert = [&](void)
+	{
+		std::string qry = "INSERT INTO Valuations "
+			"(key, atom, type, floatvalue, stringvalue, linkvalue) VALUES ";
+		for (size_t i = 0; i < rows.size(); i++)
+		{
+			const Row& r = rows[i];
+			Type vtype = r.pap->get_type();
+			if (0 < i) qry += ", ";
+			qry += "(" + std::to_string(r.kuid) + ", " +
+				std::to_string(r.auid) + ", " +
+				std::to_string(storing_typemap[vtype]) + ", ";
+
+			if (nameserver().isA(vtype, FLOAT_VALUE))
+				qry += float_to_string(FloatValueCast(r.pap)) + ", NULL";
+			else if (nameserver().isA(vtype, FLOAT32_VALUE))
+				qry += float32_to_string(Float32ValueCast(r.pap)) + ", NULL";
+			else if (nameserver().isA(vtype, INT_VALUE))
+				qry += "NULL, " + int_to_string(IntValueCast(r.pap));
+			else
+				qry += "NULL, " + string_to_string(StringValueCast(r.pap));
+			qry += ", NULL)";
+		}
+		qry += " ON CONFLICT (key, atom) DO UPDATE SET "
+			"type = EXCLUDED.type, floatvalue = EXCLUDED.floatvalue, "
+			"stringvalue = EXCLUDED.stringvalue, linkvalue = NULL "
+			"WHERE Valuations.linkvalue IS NULL RETURNING key, atom;";
+
+		std::set<std::pair<UUID, UUID>> done;
+		{
+			Response rp(conn_pool);
+			rp.kaset = &done;
+			rp.exec(qry);
+			rp.rs->foreach_row(&Response::key_atom_cb, &rp);
+		}
+		_valuation_stores += done.size();
+
+		// The ones that were not updated.
+		for (const Row& r : rows)
+			if (done.end() == done.find({r.kuid, r.auid}))
+				storeValuation(*r.key, *r.atom, r.pap);
+
+		_wb_rows += rows.size();
+		rows.clear();
+	};
+
+	for (const auto& ak : batch)
+	{
+		const Handle& atom = ak.first;
+		const Handle& key = ak.second;
+		try
+		{
+			ValuePtr pap = atom->getValue(key);
+			if (nullptr == pap)
+			{
+				deleteValuation(key, atom);
+				continue;
+			}
+
+			Type vtype = pap->get_type();
+			if (not nameserver().isA(vtype, FLOAT_VALUE) and
+			    not nameserver().isA(vtype, FLOAT32_VALUE) and
+			    not nameserver().isA(vtype, INT_VALUE) and
+			    not nameserver().isA(vtype, STRING_VALUE))
+			{
+				storeValuation(key, atom, pap);
+				continue;
+			}
+
+			rows.push_back({stored_uuid(key), stored_uuid(atom),
+			                &key, &atom, pap});
+		}
+		catch (const NotFoundException& ex)
+		{
+			// No-op. The atom was deleted, after its Value was
+			// stored; see vdo_store_atom().
+		}
+		if (WB_ROWS <= rows.size()) upsert();
+	}
+	if (not rows.empty()) upsert();
+
+	_wb_flushes++;
+}
+
+/* ================================================================ */
+
+std::string SQLAtomStorage::monitor(void)
+{
+	update_metrics();
+
+	size_t dirty;
+	size_t max_dirty;
+	unsigned int window;
+	{
+		std::lock_guard<std::mutex> lck(_wb_mutex);
+		dirty = _dirty.size();
+		max_dirty = _wb_max_dirty;
+		window = _wb_window_msec;
+	}
+	size_t working;
+	size_t max_atoms;
+	{
+		std::lock_guard<std::mutex> lck(_ws_mutex);
+		working = _ws_ring.size() - _ws_free.size();
+		max_atoms = _ws_max_atoms;
+	}
+
+	std::stringstream rs;
+	rs << "SQLAtomStorage " << _name << "\n"
+	   << "Loads: " << _load_count
+	   << "  Stores: " << _store_count
+	   << "  Valuation updates: " << _valuation_stores << "\n"
+	   << "Write-back: "
+	   << (0 == max_dirty ? "off" : "on")
+	   << "  Max dirty: " << max_dirty
+	   << "  Window: " << window << " msec\n"
+	   << "Dirty: " << dirty
+	   << "  Stores: " << _wb_stores
+	   << "  Coalesced: " << _wb_coalesced
+	   << "  Flushes: " << _wb_flushes
+	   << "  Rows written: " << _wb_rows << "\n"
+	   << "Working set: " << working
+	   << "  Max atoms: " << (0 == max_atoms ? "no limit" : std::to_string(max_atoms))
+	   << "  Extracted: " << _ws_evictions << "\n"
+	   << "Connections in use: " << conn_pool.in_use()
+	   << " of " << conn_pool.total()
+	   << " (" << conn_pool.min() << " to " << conn_pool.max() << ")"
+	   << "  Wait p99: " << 1000.0 * conn_pool.wait_times().quantile(0.99)
+	   << " msec"
+	   << "  Write queue: " << _write_queue.get_size() << "\n";
+
+	rs << "Latency (msec):";
+	for (int op = 0; op < NUM_OPS; op++)
+	{
+		const LatencyHistogram& lh = _latency[op];
+		if (0 == lh.count()) continue;
+		rs << "\n  " << _op_names[op] << ": " << lh.count()
+		   << "  p50 " << 1000.0 * lh.quantile(0.5)
+		   << "  p99 " << 1000.0 * lh.quantile(0.99)
+		   << "  max " << 1000.0 * lh.max();
+	}
+	rs << "\n";
+	return rs.str();
+}
+
+/* ============================= END OF FILE ================= */
@@ -98,43 +98,154 @@ LLPGConnection::exec(const char * buff, bool trial_run)
 	LLPGRecordSet* rs = get_record_set();
 
 	rs->_result = PQexec(_pgconn, buff);
+	check_result(rs, buff, trial_run);
 
+	/* Use numbr of columns to indicate that the query hasn't
+	 * given results yet. */
+	rs->ncols = -1;
+	return rs;
+}
+
+/* =========================================================== */
+
+LLRecordSet *
+LLPGConnection::exec_prepared(const char * name, const char * stmt,
+                              int nparams, const char * const * params)
+{
+	return exec_prepared(name, stmt, nparams, params, NULL, NULL, false);
+}
+
+LLRecordSet *
+LLPGConnection::exec_prepared(const char * name, const char * stmt,
+                              int nparams, const char * const * params,
+                              const int * lengths, const int * formats,
+                              bool trial_run)
+{
+	if (!is_connected) return NULL;
+
+	// Parse and plan the statement the first time only.
+	if (_prepared.end() == _prepared.find(name))
+	{
+		LLPGRecordSet* rs = get_record_set();
+		rs->_result = PQprepare(_pgconn, name, stmt, nparams, NULL);
+		check_result(rs, stmt, false);
+		rs->release();
+		_prepared.insert(name);
+	}
+
+	LLPGRecordSet* rs = get_record_set();
+
+	// The last argument asks for the results in binary.
+	rs->_result = PQexecPrepared(_pgconn, name, nparams, params,
+	                             lengths, formats, 1);
+	check_result(rs, stmt, trial_run);
+	rs->_binary = true;
+	rs->ncols = -1;
+	return rs;
+}
+
+/* =========================================================== */
+
+void
+LLPGConnection::check_result(LLPGRecordSet* rs, const char * buff,
+                             bool trial_run)
+{
 	ExecStatusType rest = PQresultStatus(rs->_result);
-	if (rest != PGRES_COMMAND_OK and
-	    rest != PGRES_EMPTY_QUERY and
-	    rest != PGRES_TUPLES_OK)
-	{
-		// Don't log trial-run failures. Just throw.
-		if (trial_run and PGRES_FATAL_ERROR == rest)
-		{
-			rs->release();
-			throw opencog::SilentException();
-		}
-
-		std::string msg;
-		if (PQstatus(_pgconn) != CONNECTION_OK)
-		{
-			msg = "No connection to the database!";
-		}
-		else
-		{
-			msg = "PQresult message: ";
-			msg += PQresultErrorMessage(rs->_result);
-			msg += "\nPQ query was: ";
-			msg += buff;
-		}
+	if (rest == PGRES_COMMAND_OK or
+	    rest == PGRES_EMPTY_QUERY or
+	    rest == PGRES_TUPLES_OK) return;
+
+	// Don't log trial-run failures. Just throw.
+	if (trial_run and PGRES_FATAL_ERROR == rest)
+	{
 		rs->release();
+		throw opencog::SilentException();
+	}
+
+	std::string msg;
+	if (PQstatus(_pgconn) != CONNECTION_OK)
+	{
+		msg = "No connection to the database!";
+	}
+	else
+	{
+		msg = "PQresult message: ";
+		msg += PQresultErrorMessage(rs->_result);
+		msg += "\nPQ query was: ";
+		msg += buff;
+	}
+	rs->release();
+
+	opencog::logger().warn("%s", msg.c_str());
+
+	throw opencog::RuntimeException(TRACE_INFO,
+		"Failed to execute SQL command!\n%s", msg.c_str());
+}
+
+/* =========================================================== */
+
+void
+LLPGConnection::copy_begin(const char * buff)
+{
+	if (!is_connected)
+		throw opencog::RuntimeException(TRACE_INFO,
+			"No connection to the database!");
+
+	PGresult* res = PQexec(_pgconn, buff);
+	ExecStatusType rest = PQresultStatus(res);
+	if (PGRES_COPY_IN != rest)
+	{
+		std::string msg = "PQresult message: ";
+		msg += PQresultErrorMessage(res);
+		msg += "\nPQ query was: ";
+		msg += buff;
+		PQclear(res);
 
 		opencog::logger().warn("%s", msg.c_str());
+		throw opencog::RuntimeException(TRACE_INFO,
+			"Failed to start SQL copy!\n%s", msg.c_str());
+	}
+	PQclear(res);
+}
 
+void
+LLPGConnection::copy_data(const std::string& data)
+{
+	// In blocking mode, this waits until libpq has room for it.
+	if (1 != PQputCopyData(_pgconn, data.data(), data.size()))
+	{
+		std::string msg = PQerrorMessage(_pgconn);
 		throw opencog::RuntimeException(TRACE_INFO,
-			"Failed to execute SQL command!\n%s", msg.c_str());
+			"Failed to send SQL copy data!\n%s", msg.c_str());
 	}
+}
 
-	/* Use numbr of columns to indicate that the query hasn't
-	 * given results yet. */
-	rs->ncols = -1;
-	return rs;
+void
+LLPGConnection::copy_end(const char * errmsg)
+{
+	if (1 != PQputCopyEnd(_pgconn, errmsg))
+	{
+		std::string msg = PQerrorMessage(_pgconn);
+		throw opencog::RuntimeException(TRACE_INFO,
+			"Failed to end SQL copy!\n%s", msg.c_str());
+	}
+
+	// The server says how it went only now; a bad row anywhere
+	// fails the entire copy.
+	std::string msg;
+	PGresult* res;
+	while ((res = PQgetResult(_pgconn)))
+	{
+		if (PGRES_COMMAND_OK != PQresultStatus(res))
+			msg += PQresultErrorMessage(res);
+		PQclear(res);
+	}
+
+	if (errmsg or msg.empty()) return;
+
+	opencog::logger().warn("%s", msg.c_str());
+	throw opencog::RuntimeException(TRACE_INFO,
+		"Failed to copy into the database!\n%s", msg.c_str());
 }
 
 /* =========================================================== */
@@ -165,6 +276,7 @@ LLPGRecordSet::LLPGRecordSet(LLPGConnection* _conn)
 	_result = nullptr;
 	_nrows = -1;
 	_curr_row = -1;
+	_binary = false;
 }
 
 /* =========================================================== */
@@ -176,6 +288,7 @@ LLPGRecordSet::release(void)
 	_result = nullptr;
 	_nrows = -1;
 	_curr_row = -1;
+	_binary = false;
 	ncols = -1;
 	memset(column_labels, 0, arrsize * sizeof(char*));
 	memset(values, 0, arrsize * sizeof(char*));
@@ -233,5 +346,81 @@ LLPGRecordSet::fetch_row(void)
 	return true;
 }
 
+/* =========================================================== */
+// Binary results are in network byte order. Integers are as wide as
+// their column; arrays are a header (dimensions, a NULL flag and the
+// element type), the size and lower bound of each dimension, and then
+// each element, as a length and its bytes.
+
+static inline uint64_t get_be(const char * p, int len)
+{
+	uint64_t v = 0;
+	for (int i = 0; i < len; i++)
+		v = (v << 8) | (unsigned char) p[i];
+	return v;
+}
+
+long
+LLPGRecordSet::get_column_int(int column)
+{
+	if (not _binary) return LLRecordSet::get_column_int(column);
+
+	// fetch_row() has already moved past the current row.
+	int row = _curr_row - 1;
+	if (PQgetisnull(_result, row, column)) return 0;
+
+	uint64_t v = get_be(PQgetvalue(_result, row, column),
+	                    PQgetlength(_result, row, column));
+	switch (PQgetlength(_result, row, column))
+	{
+		case 2: return (int16_t) v;
+		case 4: return (int32_t) v;
+		default: return (int64_t) v;
+	}
+}
+
+const char *
+LLPGRecordSet::get_column_text(int column)
+{
+	// Binary text is just the text; libpq null-terminates it.
+	if (not _binary) return LLRecordSet::get_column_text(column);
+	return PQgetvalue(_result, _curr_row - 1, column);
+}
+
+void
+LLPGRecordSet::get_column_int_array(int column, std::vector<size_t>& vec)
+{
+	if (not _binary)
+	{
+		LLRecordSet::get_column_int_array(column, vec);
+		return;
+	}
+
+	int row = _curr_row - 1;
+	if (PQgetisnull(_result, row, column)) return;
+
+	const char * p = PQgetvalue(_result, row, column);
+	const char * end = p + PQgetlength(_result, row, column);
+	if (end - p < 12) return;
+
+	int ndim = get_be(p, 4);
+	if (0 == ndim) return;
+
+	size_t nelts = 1;
+	for (int i = 0; i < ndim; i++)
+		nelts *= get_be(p + 12 + 8*i, 4);
+	p += 12 + 8*ndim;
+
+	vec.reserve(vec.size() + nelts);
+	while (p + 4 <= end)
+	{
+		int32_t len = get_be(p, 4);
+		p += 4;
+		if (len < 0) continue;   // NULL element
+		vec.push_back(get_be(p, len));
+		p += len;
+	}
+}
+
 #endif /* HAVE_PGSQL_STORAGE */
 /* ============================= END OF FILE ================= */
@@ -29,6 +29,8 @@
 
 #include <libpq-fe.h>
 
+#include <set>
+
 #include "llapi.h"
 
 /** \addtogroup grp_persist
@@ -43,12 +45,30 @@ class LLPGConnection : public LLConnection
 	private:
 		PGconn* _pgconn;
 		LLPGRecordSet* get_record_set(void);
+		void check_result(LLPGRecordSet*, const char*, bool);
+
+		// Names of the statements prepared on this connection.
+		std::set<std::string> _prepared;
 
 	public:
 		LLPGConnection(const char * uri);
 		~LLPGConnection();
 
 		LLRecordSet *exec(const char *, bool);
+		LLRecordSet *exec_prepared(const char *, const char *,
+		                           int, const char * const *);
+		bool binary_params(void) const { return true; }
+		LLRecordSet *exec_prepared(const char *, const char *,
+		                           int, const char * const *,
+		                           const int *, const int *, bool);
+
+		// Bulk upload, with `COPY ... FROM STDIN`. Begin with the
+		// COPY statement, send the rows in as many pieces as is
+		// convenient, and then end it. Ending it with an error
+		// message abandons the upload; nothing is stored.
+		void copy_begin(const char *);
+		void copy_data(const std::string&);
+		void copy_end(const char * errmsg = nullptr);
 };
 
 class LLPGRecordSet : public LLRecordSet
@@ -58,6 +78,7 @@ class LLPGRecordSet : public LLRecordSet
 		PGresult* _result;
 		int _nrows;
 		int _curr_row;
+		bool _binary;
 
 		void setup_cols(int ncols);
 		LLPGRecordSet(LLPGConnection *);
@@ -69,6 +90,10 @@ class LLPGRecordSet : public LLRecordSet
 		// return true if there's another row.
 		bool fetch_row(void);
 
+		long get_column_int(int);
+		const char * get_column_text(int);
+		void get_column_int_array(int, std::vector<size_t>&);
+
 		// call this, instead of the destructor,
 		// when done with this instance.
 		void release(void);
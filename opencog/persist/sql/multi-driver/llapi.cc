@@ -37,7 +37,10 @@
 #include <stack>
 #include <string>
 
+#include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <opencog/util/platform.h>
 #include <opencog/util/exceptions.h>
@@ -65,6 +68,70 @@ LLConnection::~LLConnection()
     }
 }
 
+/* =========================================================== */
+
+LLRecordSet *
+LLConnection::exec_prepared(const char * name, const char * stmt,
+                            int nparams, const char * const * params)
+{
+    return exec_prepared(name, stmt, nparams, params, NULL, NULL, false);
+}
+
+LLRecordSet *
+LLConnection::exec_prepared(const char * name, const char * stmt,
+                            int nparams, const char * const * params,
+                            const int * lengths, const int * formats,
+                            bool trial_run)
+{
+    for (int i = 0; formats and i < nparams; i++)
+        if (formats[i])
+            throw opencog::RuntimeException(TRACE_INFO,
+                "This driver does not take binary parameters: %s", stmt);
+
+    std::string buff;
+    const char * p = stmt;
+    while (*p)
+    {
+        if ('$' == *p and isdigit(p[1]))
+        {
+            char * end;
+            long n = strtol(p+1, &end, 10);
+            if (0 < n and n <= nparams and nullptr == params[n-1])
+            {
+                buff += "NULL";
+                p = end;
+                continue;
+            }
+            if (0 < n and n <= nparams)
+            {
+                std::string lit(params[n-1]);
+                escape_single_quotes(lit);
+                buff += '\'';
+                buff += lit;
+                buff += '\'';
+                p = end;
+                continue;
+            }
+        }
+        buff += *p++;
+    }
+    return exec(buff.c_str(), trial_run);
+}
+
+size_t
+LLConnection::exec_batch(const char * name, const char * stmt,
+                         int nparams, size_t nrows,
+                         const char * const * params)
+{
+    for (size_t r = 0; r < nrows; r++)
+    {
+        LLRecordSet *rs = exec_prepared(name, stmt, nparams,
+                                        params + r * nparams);
+        if (rs) rs->release();
+    }
+    return nrows;
+}
+
 /* =========================================================== */
 /* pseudo-private routine */
 
@@ -172,6 +239,48 @@ LLRecordSet::get_column_value(int column)
     return values[column];
 }
 
+int
+LLRecordSet::get_column_index(const char * fieldname)
+{
+    if (0 > ncols)
+        get_column_labels();
+
+    return get_col_by_name(fieldname);
+}
+
+long
+LLRecordSet::get_column_int(int column)
+{
+    const char * v = get_column_value(column);
+    if (nullptr == v) return 0;
+    return strtol(v, nullptr, 10);
+}
+
+const char *
+LLRecordSet::get_column_text(int column)
+{
+    const char * v = get_column_value(column);
+    if (nullptr == v) return "";
+    return v;
+}
+
+void
+LLRecordSet::get_column_int_array(int column, std::vector<size_t>& vec)
+{
+    // Arrays are of the form {81,82,83}
+    const char * p = get_column_value(column);
+    if (nullptr == p or '{' != *p) return;
+    p++;
+    while (*p and '}' != *p)
+    {
+        char * end;
+        vec.push_back(strtoul(p, &end, 10));
+        if (end == p) break;
+        p = end;
+        if (',' == *p) p++;
+    }
+}
+
 /* =========================================================== */
 
 #ifdef UNIT_TEST_EXAMPLE
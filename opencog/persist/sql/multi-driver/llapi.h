@@ -30,6 +30,7 @@
 
 #include <stack>
 #include <string>
+#include <vector>
 
 /** \addtogroup grp_persist
  *  @{
@@ -52,6 +53,47 @@ class LLConnection
         bool connected(void) const { return is_connected; }
 
         virtual LLRecordSet *exec(const char *, bool=false) = 0;
+
+        // Run a statement that has parameters $1, $2, ... in it; they
+        // are given as text. Drivers that can, prepare the statement
+        // once per connection, under the given name, and fetch the
+        // results in binary; these must then be read with the typed
+        // getters of LLRecordSet, and not with foreach_column(). The
+        // default pastes the parameters into the statement, as quoted
+        // literals; the database casts them, as it would for a
+        // prepared statement.
+        virtual LLRecordSet *exec_prepared(const char * name,
+                                           const char * stmt,
+                                           int nparams,
+                                           const char * const * params);
+
+        // The same, but some of the parameters may be in binary, as
+        // the `formats` say: zero for text, one for binary; `lengths`
+        // gives the sizes of the binary ones. A NULL parameter is an
+        // SQL NULL. Pass only text parameters to drivers that cannot
+        // do binary_params(). With `trial_run`, a failure throws a
+        // SilentException, and is not logged, as for exec().
+        virtual bool binary_params(void) const { return false; }
+        virtual LLRecordSet *exec_prepared(const char * name,
+                                           const char * stmt,
+                                           int nparams,
+                                           const char * const * params,
+                                           const int * lengths,
+                                           const int * formats,
+                                           bool trial_run = false);
+
+        // Run a statement with parameters $1, $2, ... once for each
+        // of `nrows` rows, and return the number of rows done. The
+        // parameters are text, row after row: `nparams` for the first
+        // row, then `nparams` for the second, and so on. A NULL
+        // parameter is an SQL NULL. The statement must not return
+        // rows. Drivers that can, send many rows at once; the default
+        // runs exec_prepared(), with the given name, once per row.
+        virtual size_t exec_batch(const char * name,
+                                  const char * stmt,
+                                  int nparams,
+                                  size_t nrows,
+                                  const char * const * params);
 };
 
 class LLRecordSet
@@ -80,6 +122,14 @@ class LLRecordSet
         const char * get_value(const char * fieldname);
         int get_column_count();
         const char * get_column_value(int column);
+        int get_column_index(const char * fieldname);
+
+        // Typed getters for the current row; these work for text and
+        // binary results alike. A NULL column reads as zero, or as
+        // empty. The default parses the text of the column.
+        virtual long get_column_int(int column);
+        virtual const char * get_column_text(int column);
+        virtual void get_column_int_array(int column, std::vector<size_t>&);
 
         // call this, instead of the destructor,
         // when done with this instance.
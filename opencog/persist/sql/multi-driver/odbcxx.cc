@@ -54,12 +54,17 @@
 
 #ifdef HAVE_ODBC_STORAGE
 
+#include <algorithm>
 #include <stack>
 #include <string>
+#include <vector>
 
+#include <ctype.h>
 #include <sql.h>
 #include <sqlext.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <opencog/util/exceptions.h>
 #include <opencog/util/Logger.h>
@@ -243,7 +248,7 @@ ODBCRecordSet * ODBCConnection::get_record_set(void)
         rs = new ODBCRecordSet(this);
     }
 
-    rs->alloc_and_bind_cols(DEFAULT_NUM_COLS);
+    rs->alloc_cols(DEFAULT_NUM_COLS);
 
     return rs;
 }
@@ -322,6 +327,15 @@ ODBCConnection::exec(const char * buff, bool trial)
         rc = SQLExecDirect(rs->sql_hstmt, (SQLCHAR *)buff, SQL_NTS);
     }
 
+    return check_result(rs, rc, buff, trial);
+}
+
+/* =========================================================== */
+
+LLRecordSet *
+ODBCConnection::check_result(ODBCRecordSet* rs, SQLRETURN rc,
+                             const char * buff, bool trial_run)
+{
     /* If query returned no data, its not an error:
      * its simply "no data", that's all.
      */
@@ -333,6 +347,12 @@ ODBCConnection::exec(const char * buff, bool trial)
 
     if ((SQL_SUCCESS != rc) and (SQL_SUCCESS_WITH_INFO != rc))
     {
+        // Don't log trial-run failures. Just throw.
+        if (trial_run)
+        {
+            rs->release();
+            throw opencog::SilentException();
+        }
         PRINT_SQLERR (SQL_HANDLE_STMT, rs->sql_hstmt);
         rs->release();
         opencog::logger().warn("ODCB Driver: Query was: %s\n", buff);
@@ -349,11 +369,183 @@ ODBCConnection::exec(const char * buff, bool trial)
 
 /* =========================================================== */
 
+/// Rewrite the $1, $2, ... of the statement as ODBC parameter
+/// markers. A parameter may be used more than once, or out of
+/// order; `order` gets the parameter for each marker, in turn.
+std::string
+ODBCConnection::bind_markers(const char * stmt, int nparams,
+                             std::vector<int>& order)
+{
+    std::string buff;
+    const char * p = stmt;
+    while (*p)
+    {
+        if ('$' == *p and isdigit(p[1]))
+        {
+            char * end;
+            long n = strtol(p+1, &end, 10);
+            if (0 < n and n <= nparams)
+            {
+                order.push_back(n-1);
+                buff += '?';
+                p = end;
+                continue;
+            }
+        }
+        buff += *p++;
+    }
+    return buff;
+}
+
+LLRecordSet *
+ODBCConnection::exec_prepared(const char * name, const char * stmt,
+                              int nparams, const char * const * params)
+{
+    return exec_prepared(name, stmt, nparams, params, NULL, NULL, false);
+}
+
+/// The parameters are bound, and not pasted in, so nothing in them
+/// needs escaping; question marks in them are safe, too. A statement
+/// handle lasts only as long as its record set, so the statement is
+/// prepared each time; the name is not used.
+LLRecordSet *
+ODBCConnection::exec_prepared(const char *, const char * stmt,
+                              int nparams, const char * const * params,
+                              const int *, const int * formats,
+                              bool trial_run)
+{
+    for (int i = 0; formats and i < nparams; i++)
+        if (formats[i])
+            PERR("This driver does not take binary parameters: %s", stmt);
+
+    if (!is_connected) return NULL;
+
+    std::vector<int> order;
+    std::string qry(bind_markers(stmt, nparams, order));
+
+    ODBCRecordSet* rs = get_record_set();
+    SQLRETURN rc = SQLPrepare(rs->sql_hstmt, (SQLCHAR *) qry.c_str(), SQL_NTS);
+
+    // These must stay put until the statement has run.
+    std::vector<SQLLEN> ind(order.size());
+    for (size_t j = 0; SQL_SUCCEEDED(rc) and j < order.size(); j++)
+    {
+        const char * v = params[order[j]];
+        ind[j] = v ? SQL_NTS : SQL_NULL_DATA;
+        SQLULEN len = v ? strlen(v) : 0;
+        rc = SQLBindParameter(rs->sql_hstmt, j+1, SQL_PARAM_INPUT,
+                 SQL_C_CHAR, SQL_VARCHAR, std::max(len, (SQLULEN) 1), 0,
+                 (SQLPOINTER) v, 0, &ind[j]);
+    }
+    if (SQL_SUCCEEDED(rc))
+        rc = SQLExecute(rs->sql_hstmt);
+
+    return check_result(rs, rc, stmt, trial_run);
+}
+
+/* =========================================================== */
+
+// Rows sent to the server in one go, by exec_batch().
+#define BATCH_ROWS 1000
+
+/// Parameter arrays: the statement is prepared once, and then run
+/// for up to BATCH_ROWS rows at a time, the parameters bound column
+/// by column. The driver sends a whole chunk in one round-trip,
+/// instead of one round-trip for each row.
+size_t
+ODBCConnection::exec_batch(const char *, const char * stmt,
+                           int nparams, size_t nrows,
+                           const char * const * params)
+{
+    if (!is_connected) return 0;
+
+    std::vector<int> order;
+    std::string qry(bind_markers(stmt, nparams, order));
+
+    SQLHSTMT hstmt;
+    SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_STMT, sql_hdbc, &hstmt);
+    if ((SQL_SUCCESS != rc) and (SQL_SUCCESS_WITH_INFO != rc))
+    {
+        PRINT_SQLERR (SQL_HANDLE_DBC, sql_hdbc);
+        PERR("Can't allocate statement handle, rc=%d", rc);
+    }
+
+    // One array for each parameter; each element is as wide as the
+    // longest value of that parameter, in the chunk.
+    std::vector<std::vector<char>> cols(nparams);
+    std::vector<std::vector<SQLLEN>> inds(nparams);
+    std::vector<SQLLEN> widths(nparams);
+    SQLULEN nprocessed = 0;
+    size_t done = 0;
+
+    rc = SQLPrepare(hstmt, (SQLCHAR *) qry.c_str(), SQL_NTS);
+    if (SQL_SUCCEEDED(rc))
+        rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_BIND_TYPE,
+                            (SQLPOINTER) SQL_PARAM_BIND_BY_COLUMN, 0);
+    if (SQL_SUCCEEDED(rc))
+        rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                            &nprocessed, 0);
+
+    while (SQL_SUCCEEDED(rc) and done < nrows)
+    {
+        size_t chunk = std::min(nrows - done, (size_t) BATCH_ROWS);
+        const char * const * rows = params + done * nparams;
+
+        for (int i = 0; i < nparams; i++)
+        {
+            SQLLEN w = 1;
+            for (size_t r = 0; r < chunk; r++)
+            {
+                const char * v = rows[r * nparams + i];
+                if (v) w = std::max(w, (SQLLEN) strlen(v) + 1);
+            }
+            widths[i] = w;
+            cols[i].assign(chunk * w, 0);
+            inds[i].resize(chunk);
+            for (size_t r = 0; r < chunk; r++)
+            {
+                const char * v = rows[r * nparams + i];
+                inds[i][r] = v ? SQL_NTS : SQL_NULL_DATA;
+                if (v) memcpy(&cols[i][r * w], v, strlen(v));
+            }
+        }
+
+        rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE,
+                            (SQLPOINTER) chunk, 0);
+        for (size_t j = 0; SQL_SUCCEEDED(rc) and j < order.size(); j++)
+        {
+            int i = order[j];
+            rc = SQLBindParameter(hstmt, j+1, SQL_PARAM_INPUT,
+                     SQL_C_CHAR, SQL_VARCHAR,
+                     std::max(widths[i] - 1, (SQLLEN) 1), 0,
+                     cols[i].data(), widths[i], inds[i].data());
+        }
+        if (SQL_SUCCEEDED(rc))
+            rc = SQLExecute(hstmt);
+
+        // Statements that touched no rows report "no data".
+        if (SQL_NO_DATA == rc) rc = SQL_SUCCESS;
+        if (SQL_SUCCEEDED(rc)) done += chunk;
+    }
+
+    if ((SQL_SUCCESS != rc) and (SQL_SUCCESS_WITH_INFO != rc))
+    {
+        PRINT_SQLERR (SQL_HANDLE_STMT, hstmt);
+        SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+        opencog::logger().warn("ODCB Driver: Batch was: %s\n", stmt);
+        PERR ("Can't perform batch rc=%d after %zu rows", rc, done);
+    }
+    SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+    return done;
+}
+
+/* =========================================================== */
+
 #define DEFAULT_COLUMN_NAME_SIZE 121
 #define DEFAULT_VARCHAR_SIZE 4040
 
 void
-ODBCRecordSet::alloc_and_bind_cols(int new_ncols)
+ODBCRecordSet::alloc_cols(int new_ncols)
 {
     int i;
 
@@ -420,15 +612,48 @@ ODBCRecordSet::alloc_and_bind_cols(int new_ncols)
         return;
     }
 
-    // IMPORTANT! MUST NOT BE ON STACK!! Else stack corruption will result.
-    // The ODBC driver really wants to write a return value here!
-    static SQLLEN bogus;
+    // The columns are bound once the results are in, and it is
+    // known how many there are, and how wide; see bind_block().
+    nfetched = 0;
+    cur_row = 0;
+}
+
+/* =========================================================== */
+
+// Rows fetched from the server in one go, by fetch_row().
+#define BLOCK_ROWS 64
+
+// Numbers, as text, are never wider than this.
+#define NUMERIC_WIDTH 40
+
+void
+ODBCRecordSet::bind_block(void)
+{
+    nfetched = 0;
+    cur_row = 0;
+    if (0 >= ncols) return;
 
-    /* Initialize the newly realloc'ed entries */
-    for (i=0; i<new_ncols; i++)
+    block.resize(ncols);
+    block_ind.resize(ncols);
+
+    SQLRETURN rc = SQLSetStmtAttr(sql_hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                  (SQLPOINTER) BLOCK_ROWS, 0);
+    if ((SQL_SUCCESS == rc) or (SQL_SUCCESS_WITH_INFO == rc))
+        rc = SQLSetStmtAttr(sql_hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                            &nfetched, 0);
+    if ((SQL_SUCCESS != rc) and (SQL_SUCCESS_WITH_INFO != rc))
+    {
+        PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
+        PERR ("Can't set up block cursor rc=%d", rc);
+        return;
+    }
+
+    for (int i=0; i<ncols; i++)
     {
+        block[i].resize(BLOCK_ROWS * block_width[i]);
+        block_ind[i].resize(BLOCK_ROWS);
         rc = SQLBindCol(sql_hstmt, i+1, SQL_C_CHAR,
-            values[i], vsizes[i], &bogus);
+            block[i].data(), block_width[i], block_ind[i].data());
         if ((SQL_SUCCESS != rc) and (SQL_SUCCESS_WITH_INFO != rc))
         {
             PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
@@ -446,6 +671,8 @@ ODBCRecordSet::ODBCRecordSet(ODBCConnection* _conn)
     : LLRecordSet(_conn)
 {
     sql_hstmt = NULL;
+    nfetched = 0;
+    cur_row = 0;
 }
 
 /* =========================================================== */
@@ -507,6 +734,8 @@ ODBCRecordSet::get_column_labels(void)
         PERR( "screwed not enough columns !! ");
     }
 
+    block_width.resize(_ncols);
+
     for (i=0; i<_ncols; i++)
     {
         char namebuff[300];
@@ -532,9 +761,22 @@ ODBCRecordSet::get_column_labels(void)
         strncpy(column_labels[i], namebuff, DEFAULT_COLUMN_NAME_SIZE);
         column_labels[i][DEFAULT_COLUMN_NAME_SIZE-1] = 0;
         column_datatype[i] = datatype;
+
+        // Text is as wide as the value buffers; the size reported
+        // for arrays and for unbounded text is not to be trusted.
+        switch (datatype)
+        {
+            case SQL_SMALLINT: case SQL_INTEGER: case SQL_BIGINT:
+            case SQL_REAL: case SQL_FLOAT: case SQL_DOUBLE:
+                block_width[i] = NUMERIC_WIDTH;
+                break;
+            default:
+                block_width[i] = vsizes[i];
+        }
     }
 
     ncols = _ncols;
+    bind_block();
 }
 
 /* =========================================================== */
@@ -542,23 +784,45 @@ ODBCRecordSet::get_column_labels(void)
 bool
 ODBCRecordSet::fetch_row(void)
 {
-    // Columns can have null values.  In this case, the ODBC shims
-    // will neither set nor clear the value-strings. As a result,
-    // some random value from a previous query will still be sitting
-    // there, in the values, and get reported to the unlucky user.
-    for (int i=0; i<ncols; i++) values[i][0] = 0;
+    if (0 > ncols) get_column_labels();
+    if (0 == ncols) return false;
 
-    SQLRETURN rc = SQLFetch(sql_hstmt);
+    // Hand out the rows of the block; fetch the next block only
+    // when this one is used up.
+    if (++cur_row >= nfetched)
+    {
+        cur_row = 0;
+        nfetched = 0;
+        SQLRETURN rc = SQLFetch(sql_hstmt);
 
-    /* no more data */
-    if (SQL_NO_DATA == rc) return false;
-    if (SQL_NULL_DATA == rc) return false;
+        /* no more data */
+        if (SQL_NO_DATA == rc) return false;
+        if (SQL_NULL_DATA == rc) return false;
 
-    if ((SQL_SUCCESS != rc) and (SQL_SUCCESS_WITH_INFO != rc))
+        if ((SQL_SUCCESS != rc) and (SQL_SUCCESS_WITH_INFO != rc))
+        {
+            PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
+            PERR ("Can't fetch row rc=%d", rc);
+            return false;
+        }
+        if (0 == nfetched) return false;
+    }
+
+    // Columns can have null values. These read as empty strings,
+    // and not as whatever a previous row had in them. Values that
+    // were too long for the block are cut short, as before.
+    for (int i=0; i<ncols; i++)
     {
-        PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
-        PERR ("Can't fetch row rc=%d", rc);
-        return false;
+        SQLLEN len = block_ind[i][cur_row];
+        if (SQL_NULL_DATA == len)
+        {
+            values[i][0] = 0;
+            continue;
+        }
+        SQLLEN max = std::min(block_width[i], (SQLLEN) vsizes[i]) - 1;
+        if (SQL_NO_TOTAL == len or max < len) len = max;
+        memcpy(values[i], &block[i][cur_row * block_width[i]], len);
+        values[i][len] = 0;
     }
 
     return true;
@@ -30,6 +30,9 @@
 
 #ifdef HAVE_ODBC_STORAGE
 
+#include <string>
+#include <vector>
+
 #include <sql.h>
 #include <sqlext.h>
 
@@ -50,12 +53,22 @@ class ODBCConnection : public LLConnection
         SQLHDBC sql_hdbc;
 
         ODBCRecordSet *get_record_set(void);
+        LLRecordSet *check_result(ODBCRecordSet *, SQLRETURN,
+                                  const char *, bool);
+        std::string bind_markers(const char *, int, std::vector<int>&);
 
     public:
         ODBCConnection(const char * uri);
         ~ODBCConnection();
 
         LLRecordSet *exec(const char *, bool);
+        LLRecordSet *exec_prepared(const char *, const char *,
+                                   int, const char * const *);
+        LLRecordSet *exec_prepared(const char *, const char *,
+                                   int, const char * const *,
+                                   const int *, const int *, bool);
+        size_t exec_batch(const char *, const char *,
+                          int, size_t, const char * const *);
         void extract_error(const char *);
 };
 
@@ -65,7 +78,16 @@ class ODBCRecordSet : public LLRecordSet
     private:
         SQLHSTMT sql_hstmt;
 
-        void alloc_and_bind_cols(int ncols);
+        // Block cursor: rows are fetched many at a time, into one
+        // array per column, and then handed out one at a time.
+        std::vector<std::vector<char>> block;
+        std::vector<std::vector<SQLLEN>> block_ind;
+        std::vector<SQLLEN> block_width;
+        SQLULEN nfetched;
+        SQLULEN cur_row;
+
+        void alloc_cols(int ncols);
+        void bind_block(void);
         ODBCRecordSet(ODBCConnection *);
         ~ODBCRecordSet();
 
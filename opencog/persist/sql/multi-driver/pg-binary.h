@@ -0,0 +1,132 @@
+/*
+ * FUNCTION:
+ * Postgres binary encoding of rows and parameters.
+ *
+ * HISTORY:
+ * Copyright (c) 2024 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_PERSISTENT_PG_BINARY_H
+#define _OPENCOG_PERSISTENT_PG_BINARY_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+// The binary format of COPY ... FROM STDIN, which is also that of
+// binary parameters and results. Numbers are big-endian. Each row is
+// a count of fields; each field is a length, and then that many
+// bytes; a length of -1 is an SQL NULL. A binary parameter is just
+// the bytes, without the length in front. Arrays say what their
+// elements are; these are the type OID's of pg_type.h, which are
+// fixed for all time.
+#define INT8OID 20
+#define TEXTOID 25
+#define FLOAT8OID 701
+
+static inline void put16(std::string& buf, uint16_t v)
+{
+	buf += (char) (v >> 8);
+	buf += (char) v;
+}
+
+static inline void put32(std::string& buf, uint32_t v)
+{
+	put16(buf, v >> 16);
+	put16(buf, v);
+}
+
+static inline void put64(std::string& buf, uint64_t v)
+{
+	put32(buf, v >> 32);
+	put32(buf, v);
+}
+
+static inline void put_null(std::string& buf)
+{
+	put32(buf, (uint32_t) -1);
+}
+
+static inline void put_int2(std::string& buf, int v)
+{
+	put32(buf, 2);
+	put16(buf, v);
+}
+
+static inline void put_int8(std::string& buf, uint64_t v)
+{
+	put32(buf, 8);
+	put64(buf, v);
+}
+
+static inline void put_double(std::string& buf, double d)
+{
+	uint64_t v;
+	memcpy(&v, &d, sizeof(v));
+	put_int8(buf, v);
+}
+
+static inline void put_text(std::string& buf, const std::string& str)
+{
+	put32(buf, str.size());
+	buf += str;
+}
+
+/// Start a one-dimensional array of `n` elements; return where its
+/// length goes, to be filled in by end_array(), once it is known.
+static inline size_t begin_array(std::string& buf, uint32_t oid, size_t n)
+{
+	size_t at = buf.size();
+	put32(buf, 0);
+	put32(buf, 0 < n);  // dimensions; an empty array has none.
+	put32(buf, 0);      // no NULL elements
+	put32(buf, oid);
+	if (0 < n)
+	{
+		put32(buf, n);
+		put32(buf, 1);   // lower bound
+	}
+	return at;
+}
+
+static inline void end_array(std::string& buf, size_t at)
+{
+	uint32_t len = buf.size() - at - 4;
+	for (int i = 0; i < 4; i++)
+		buf[at+i] = (char) (len >> (24 - 8*i));
+}
+
+/// The bytes of a field, as a binary parameter: without its length.
+static inline const char* param_bytes(const std::string& field)
+{
+	return field.data() + 4;
+}
+
+static inline int param_length(const std::string& field)
+{
+	return field.size() - 4;
+}
+
+/** @}*/
+
+#endif // _OPENCOG_PERSISTENT_PG_BINARY_H
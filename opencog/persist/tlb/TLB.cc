@@ -34,11 +34,36 @@ TLB::TLB(uuid_pool* allocator)
 		_uuid_pool = allocator;
 }
 
+size_t TLB::size()
+{
+    size_t sz = 0;
+    for (UuidShard& us : _uuid_shard)
+    {
+        std::lock_guard<UuidMutex> lck(us.mtx);
+        sz += us.map.size();
+    }
+    return sz;
+}
+
 void TLB::clear()
 {
-    std::lock_guard<std::mutex> lck(_mtx);
-    _handle_map.clear();
-    _uuid_map.clear();
+    for (HandleShard& hs : _handle_shard)
+    {
+        std::lock_guard<HandleMutex> lck(hs.mtx);
+        hs.map.clear();
+    }
+    for (UuidShard& us : _uuid_shard)
+    {
+        std::lock_guard<UuidMutex> lck(us.mtx);
+        us.map.clear();
+    }
+}
+
+void TLB::erase_uuid(UUID uuid)
+{
+    UuidShard& us = _uuid_shard[shard_of(uuid)];
+    std::lock_guard<UuidMutex> lck(us.mtx);
+    us.map.erase(uuid);
 }
 
 // ===================================================
@@ -84,19 +109,22 @@ UUID TLB::addAtom(const Handle& h, UUID uuid)
             addAtom(ho, TLB::INVALID_UUID);
     }
 
-    std::lock_guard<std::mutex> lck(_mtx);
+    // The two versions have the same content, and thus the same hash,
+    // and thus the same shard.
+    HandleShard& hs = _handle_shard[shard_of(hr)];
+    std::lock_guard<HandleMutex> lck(hs.mtx);
 
     // If we hold something that isn't the atomspace's version,
     // then remove it. Only the atomspace's version has the
     // correct values (including the TV) on it.
     if (hr != h)
     {
-        auto pr = _handle_map.find(h);
-        if (_handle_map.end() != pr)
+        auto pr = hs.map.find(h);
+        if (hs.map.end() != pr)
         {
             UUID oid = pr->second;
-            _handle_map.erase(pr);
-            _uuid_map.erase(oid);
+            hs.map.erase(pr);
+            erase_uuid(oid);
 
             OC_ASSERT(uuid == INVALID_UUID or oid == uuid,
                      "Earlier version of atom has mis-matched UUID!");
@@ -106,10 +134,10 @@ UUID TLB::addAtom(const Handle& h, UUID uuid)
         }
     }
 
-    auto pr = _handle_map.find(hr);
+    auto pr = hs.map.find(hr);
     if (uuid == INVALID_UUID)
     {
-        if (_handle_map.end() != pr) return pr->second;
+        if (hs.map.end() != pr) return pr->second;
 
         while (true)
         {
@@ -117,13 +145,14 @@ UUID TLB::addAtom(const Handle& h, UUID uuid)
             uuid = _uuid_pool->get_uuid();
 
             // Oh wait, is it being used already?
-            auto pr = _uuid_map.find(uuid);
-            if (_uuid_map.end() == pr) break;
+            UuidShard& us = _uuid_shard[shard_of(uuid)];
+            std::lock_guard<UuidMutex> ulck(us.mtx);
+            if (us.map.end() == us.map.find(uuid)) break;
         }
     }
     else
     {
-        if (_handle_map.end() != pr)
+        if (hs.map.end() != pr)
         {
             OC_ASSERT(uuid == pr->second,
                      "Atom is already in the TLB, and UUID's don't match!");
@@ -139,38 +168,103 @@ UUID TLB::addAtom(const Handle& h, UUID uuid)
             if (pas and has and pas == has)
                 return uuid;
 
-            _handle_map.erase(pr);
-            _uuid_map.erase(uuid);
+            hs.map.erase(pr);
+            erase_uuid(uuid);
         }
     }
 
-    _uuid_map.emplace(std::make_pair(uuid, hr));
-    _handle_map.emplace(std::make_pair(hr, uuid));
+    {
+        UuidShard& us = _uuid_shard[shard_of(uuid)];
+        std::lock_guard<UuidMutex> ulck(us.mtx);
+        us.map.emplace(std::make_pair(uuid, hr));
+    }
+    hs.map.emplace(std::make_pair(hr, uuid));
 
     return uuid;
 }
 
+std::vector<UUID> TLB::addAtoms(const HandleSeq& hs,
+                                const std::vector<UUID>& uuids)
+{
+    OC_ASSERT(hs.size() == uuids.size(),
+             "Need as many UUID's as Atoms!");
+
+    std::vector<UUID> added;
+    added.reserve(hs.size());
+    for (size_t i = 0; i < hs.size(); i++)
+        added.push_back(addAtom(hs[i], uuids[i]));
+    return added;
+}
+
 Handle TLB::getAtom(UUID uuid)
 {
     if (INVALID_UUID == uuid) return Handle::UNDEFINED;
-    std::lock_guard<std::mutex> lck(_mtx);
-    auto pr = _uuid_map.find(uuid);
+    UuidShard& us = _uuid_shard[shard_of(uuid)];
+    std::lock_guard<UuidMutex> lck(us.mtx);
+    auto pr = us.map.find(uuid);
 
-    if (_uuid_map.end() == pr) return Handle::UNDEFINED;
+    if (us.map.end() == pr) return Handle::UNDEFINED;
 
     return pr->second;
 }
 
+HandleSeq TLB::getAtoms(const std::vector<UUID>& uuids)
+{
+    HandleSeq atoms(uuids.size());
+
+    // Bucket the positions by shard, then visit each shard once.
+    std::vector<size_t> bucket[NSHARDS];
+    for (size_t i = 0; i < uuids.size(); i++)
+        if (INVALID_UUID != uuids[i])
+            bucket[shard_of(uuids[i])].push_back(i);
+
+    for (size_t s = 0; s < NSHARDS; s++)
+    {
+        if (bucket[s].empty()) continue;
+        UuidShard& us = _uuid_shard[s];
+        std::lock_guard<UuidMutex> lck(us.mtx);
+        for (size_t i : bucket[s])
+        {
+            auto pr = us.map.find(uuids[i]);
+            if (us.map.end() != pr) atoms[i] = pr->second;
+        }
+    }
+    return atoms;
+}
+
 UUID TLB::getUUID(const Handle& h)
 {
-    std::lock_guard<std::mutex> lck(_mtx);
-    auto pr = _handle_map.find(h);
-    if (_handle_map.end() != pr)
+    HandleShard& hs = _handle_shard[shard_of(h)];
+    std::lock_guard<HandleMutex> lck(hs.mtx);
+    auto pr = hs.map.find(h);
+    if (hs.map.end() != pr)
         return pr->second;
 
     return INVALID_UUID;
 }
 
+std::vector<UUID> TLB::getUUIDs(const HandleSeq& hseq)
+{
+    std::vector<UUID> uuids(hseq.size(), INVALID_UUID);
+
+    std::vector<size_t> bucket[NSHARDS];
+    for (size_t i = 0; i < hseq.size(); i++)
+        bucket[shard_of(hseq[i])].push_back(i);
+
+    for (size_t s = 0; s < NSHARDS; s++)
+    {
+        if (bucket[s].empty()) continue;
+        HandleShard& hs = _handle_shard[s];
+        std::lock_guard<HandleMutex> lck(hs.mtx);
+        for (size_t i : bucket[s])
+        {
+            auto pr = hs.map.find(hseq[i]);
+            if (hs.map.end() != pr) uuids[i] = pr->second;
+        }
+    }
+    return uuids;
+}
+
 /// The two remove functions below erase the uuid from the uuid-to-handle
 /// lookup. This means that getAtom() will not be able to find the Atom,
 /// which is what we want for something deleted. However, we do keep the
@@ -186,25 +280,39 @@ UUID TLB::getUUID(const Handle& h)
 void TLB::removeAtom(UUID uuid)
 {
     if (INVALID_UUID == uuid) return;
-    std::lock_guard<std::mutex> lck(_mtx);
 
-    auto pr = _uuid_map.find(uuid);
-    if (_uuid_map.end() == pr) return;
+    // Do NOT remove from the handle_map. See note above.
+    erase_uuid(uuid);
+}
+
+void TLB::removeAtoms(const std::vector<UUID>& uuids)
+{
+    std::vector<UUID> bucket[NSHARDS];
+    for (UUID uuid : uuids)
+        if (INVALID_UUID != uuid)
+            bucket[shard_of(uuid)].push_back(uuid);
 
-    _uuid_map.erase(uuid);
     // Do NOT remove from the handle_map. See note above.
-    // _handle_map.erase(pr->second);
+    for (size_t s = 0; s < NSHARDS; s++)
+    {
+        if (bucket[s].empty()) continue;
+        UuidShard& us = _uuid_shard[s];
+        std::lock_guard<UuidMutex> lck(us.mtx);
+        for (UUID uuid : bucket[s])
+            us.map.erase(uuid);
+    }
 }
 
 void TLB::removeAtom(const Handle& h)
 {
-    std::lock_guard<std::mutex> lck(_mtx);
-    auto pr = _handle_map.find(h);
-    if (_handle_map.end() != pr)
+    HandleShard& hs = _handle_shard[shard_of(h)];
+    std::lock_guard<HandleMutex> lck(hs.mtx);
+    auto pr = hs.map.find(h);
+    if (hs.map.end() != pr)
     {
-        _uuid_map.erase(pr->second);
+        erase_uuid(pr->second);
         // Do NOT remove from the handle_map. See note above.
-        // _handle_map.erase(pr);
+        // hs.map.erase(pr);
     }
 }
 
@@ -216,11 +324,20 @@ void TLB::removeAtom(const Handle& h)
 void TLB::purgeAtom(UUID uuid)
 {
     if (INVALID_UUID == uuid) return;
-    std::lock_guard<std::mutex> lck(_mtx);
 
-    auto pr = _uuid_map.find(uuid);
-    if (_uuid_map.end() == pr) return;
+    Handle h(getAtom(uuid));
+    if (nullptr == h) return;
 
-    _uuid_map.erase(uuid);
-    _handle_map.erase(pr->second);
+    // Lock the Handle shard first, as everywhere else; then check that
+    // the uuid still belongs to the same atom.
+    HandleShard& hs = _handle_shard[shard_of(h)];
+    std::lock_guard<HandleMutex> lck(hs.mtx);
+    {
+        UuidShard& us = _uuid_shard[shard_of(uuid)];
+        std::lock_guard<UuidMutex> ulck(us.mtx);
+        auto pr = us.map.find(uuid);
+        if (us.map.end() == pr or pr->second != h) return;
+        us.map.erase(pr);
+    }
+    hs.map.erase(h);
 }
@@ -28,9 +28,11 @@
 #include <atomic>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <opencog/atoms/base/Atom.h>
 #include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/base/LockStats.h>
 
 namespace opencog
 {
@@ -70,6 +72,14 @@ class AtomSpace;
  *
  * Atomspaces are also issued UUID's. This allows atomspaces to be
  * uniquely identified as well.
+ *
+ * The TLB is used from many threads at once, by the parallel loads
+ * and stores of the storage backends. Thus, both maps are split into
+ * shards, each with its own lock: the UUID map by UUID, and the Handle
+ * map by the hash of the Atom. Threads working on different Atoms
+ * rarely contend. All changes made to any one Atom are made holding
+ * the lock of its Handle shard; the lock of a UUID shard is taken
+ * only after that, and only ever one at a time.
  */
 class TLB
 {
@@ -77,11 +87,33 @@ private:
     local_uuid_pool _local_pool;
     uuid_pool* _uuid_pool;
 
-    std::mutex _mtx;
-    std::unordered_map<UUID, Handle> _uuid_map;
-    std::unordered_map<Handle, UUID,
-                      std::hash<opencog::Handle>,
-                      std::equal_to<opencog::Handle> > _handle_map;
+    static const size_t NSHARDS = 64;
+
+    static constexpr char uuid_lock_site[] = "TLB UUID shard";
+    static constexpr char handle_lock_site[] = "TLB Handle shard";
+    typedef LOCK_SITE_MUTEX(uuid_lock_site) UuidMutex;
+    typedef LOCK_SITE_MUTEX(handle_lock_site) HandleMutex;
+
+    struct alignas(64) UuidShard
+    {
+        UuidMutex mtx;
+        std::unordered_map<UUID, Handle> map;
+    };
+    struct alignas(64) HandleShard
+    {
+        HandleMutex mtx;
+        std::unordered_map<Handle, UUID,
+                           std::hash<opencog::Handle>,
+                           std::equal_to<opencog::Handle> > map;
+    };
+    UuidShard _uuid_shard[NSHARDS];
+    HandleShard _handle_shard[NSHARDS];
+
+    static size_t shard_of(UUID uuid) { return uuid % NSHARDS; }
+    static size_t shard_of(const Handle& h)
+        { return std::hash<opencog::Handle>()(h) % NSHARDS; }
+
+    void erase_uuid(UUID);
 
     // Its a vector, not a set, because it's priority ranked.
     std::vector<const AtomSpace*> _resolver;
@@ -95,7 +127,7 @@ public:
     void set_resolver(const AtomSpace*);
     void clear_resolver(const AtomSpace*);
 
-    size_t size() { return _uuid_map.size(); }
+    size_t size();
     void clear();
 
     /**
@@ -110,12 +142,29 @@ public:
     }
     UUID addAtom(const Handle&, UUID);
 
+    /**
+     * Adds many atoms; the same as calling addAtom() on each, in turn.
+     * The UUID's may be INVALID_UUID, to have them issued.
+     *
+     * @return UUID's of the atoms, in the same order.
+     */
+    std::vector<UUID> addAtoms(const HandleSeq&, const std::vector<UUID>&);
+
     /** Look up atom corresponding to the UUID. */
     Handle getAtom(UUID);
 
+    /**
+     * Look up many atoms. Each shard is locked once, instead of once
+     * per UUID. Unknown UUID's give Handle::UNDEFINED.
+     */
+    HandleSeq getAtoms(const std::vector<UUID>&);
+
     /** Look up UUID corresponding to the atom. */
     UUID getUUID(const Handle&);
 
+    /** Look up many UUID's, a shard at a time. */
+    std::vector<UUID> getUUIDs(const HandleSeq&);
+
     /** Remove the atom. */
     void removeAtom(const AtomPtr& a) {
         return removeAtom(a->get_handle());
@@ -123,6 +172,9 @@ public:
     void removeAtom(const Handle&);
     void removeAtom(UUID);
     void purgeAtom(UUID);
+
+    /** Remove many atoms, locking each shard once. */
+    void removeAtoms(const std::vector<UUID>&);
 };
 
 } // namespace opencog
@@ -0,0 +1,61 @@
+/*
+ * BatchQuery.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <memory>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "BatchQuery.h"
+#include "ClauseCache.h"
+
+using namespace opencog;
+
+ValueSeq opencog::execute_batch(AtomSpace* as, const HandleSeq& queries)
+{
+	if (nullptr == as)
+		throw InvalidParamException(TRACE_INFO,
+			"execute_batch: expecting an AtomSpace");
+
+	for (const Handle& q : queries)
+	{
+		Type t = q->get_type();
+		if (not nameserver().isA(t, MEET_LINK) and
+		    not nameserver().isA(t, QUERY_LINK))
+			throw InvalidParamException(TRACE_INFO,
+				"execute_batch: expecting a MeetLink or a QueryLink, got %s",
+				q->to_short_string().c_str());
+	}
+
+	// Keep the cache that is already there, if any; its owner
+	// decides how long it lives.
+	std::unique_ptr<ClauseCache> cache;
+	if (nullptr == ClauseCache::find(as))
+		cache.reset(new ClauseCache(as));
+
+	ValueSeq results;
+	for (const Handle& q : queries)
+		results.push_back(q->execute(as));
+	return results;
+}
@@ -0,0 +1,62 @@
+/*
+ * BatchQuery.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_BATCH_QUERY_H
+#define _OPENCOG_BATCH_QUERY_H
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+
+class AtomSpace;
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * Execute a batch of MeetLinks and QueryLinks on one AtomSpace, one
+ * after the other, in the given order, and return their results, in
+ * that same order. Each result is exactly what executing that query
+ * by itself, at that point, would have given; in particular, a query
+ * sees the Atoms created by the rewrites of the queries before it.
+ *
+ * Queries run together tend to have clauses in common, up to the
+ * naming of their variables, and to start from the same atoms. For
+ * the duration of the batch, the AtomSpace is given a ClauseCache,
+ * if it does not already have one, so that a clause grounded (or
+ * found to be ungroundable) by one query is not searched for again
+ * by the next; the later query picks up right away from there, with
+ * the rest of its clauses. See ClauseCache for the caveats. Since
+ * that cache is dropped when the batch is done, batches should not
+ * run concurrently on the same AtomSpace, unless it has a ClauseCache
+ * of its own.
+ */
+ValueSeq execute_batch(AtomSpace*, const HandleSeq&);
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_BATCH_QUERY_H
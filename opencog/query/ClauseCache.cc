@@ -0,0 +1,196 @@
+/*
+ * ClauseCache.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <map>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "ClauseCache.h"
+
+using namespace opencog;
+
+/* ======================================================== */
+// One cache per AtomSpace.
+
+static std::mutex _registry_mtx;
+static std::map<const AtomSpace*, ClauseCache*> _registry;
+
+ClauseCache* ClauseCache::find(const AtomSpace* as)
+{
+	std::lock_guard<std::mutex> lck(_registry_mtx);
+	const auto& it = _registry.find(as);
+	if (_registry.end() == it) return nullptr;
+	return it->second;
+}
+
+ClauseCache::ClauseCache(AtomSpace* as, size_t max_entries)
+	: _as(as), _max(max_entries)
+{
+	if (nullptr == as)
+		throw InvalidParamException(TRACE_INFO,
+			"ClauseCache: expecting an AtomSpace");
+
+	{
+		std::lock_guard<std::mutex> lck(_registry_mtx);
+		if (_registry.end() != _registry.find(as))
+			throw InvalidParamException(TRACE_INFO,
+				"ClauseCache: this AtomSpace already has a cache");
+		_registry[as] = this;
+	}
+
+	_add_sig = as->atomAddedSignal().connect(
+		[this](const Handle& h) { bump(h); });
+	_remove_sig = as->atomRemovedSignal().connect(
+		[this](const Handle& h) { bump(h); });
+	_adds_sig = as->atomsAddedSignal().connect(
+		[this](const HandleSeq& hs) { for (const Handle& h : hs) bump(h); });
+	_removes_sig = as->atomsRemovedSignal().connect(
+		[this](const HandleSeq& hs) { for (const Handle& h : hs) bump(h); });
+}
+
+ClauseCache::~ClauseCache()
+{
+	_as->atomAddedSignal().disconnect(_add_sig);
+	_as->atomRemovedSignal().disconnect(_remove_sig);
+	_as->atomsAddedSignal().disconnect(_adds_sig);
+	_as->atomsRemovedSignal().disconnect(_removes_sig);
+
+	std::lock_guard<std::mutex> lck(_registry_mtx);
+	_registry.erase(_as);
+}
+
+/* ======================================================== */
+
+size_t ClauseCache::KeyHash::operator()(const Key& k) const
+{
+	size_t hsh = k.clause->get_hash();
+	for (const Handle& h : k.gnds)
+		hsh = hsh * 31 + std::hash<const Atom*>()(h.get());
+	return hsh ^ k.cbt->hash_code();
+}
+
+bool ClauseCache::KeyEqual::operator()(const Key& a, const Key& b) const
+{
+	return *a.cbt == *b.cbt and a.gnds == b.gnds and
+		(a.clause == b.clause or *a.clause == *b.clause);
+}
+
+/// Must be called with the lock held.
+uint64_t ClauseCache::generation(Type t)
+{
+	if (_gen.size() <= t) return 0;
+	return _gen[t];
+}
+
+void ClauseCache::bump(const Handle& h)
+{
+	if (not h->is_link()) return;
+
+	Type t = h->get_type();
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (_gen.size() <= t) _gen.resize(t+1, 0);
+	_gen[t]++;
+}
+
+/// Must be called with the lock held.
+void ClauseCache::erase(
+	std::unordered_map<Key, Entry, KeyHash, KeyEqual>::iterator it)
+{
+	_lru.erase(it->second.lru);
+	_map.erase(it);
+}
+
+/* ======================================================== */
+
+uint64_t ClauseCache::stamp(const Handle& clause)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return generation(clause->get_type());
+}
+
+bool ClauseCache::lookup(const Handle& clause, const HandleSeq& gnds,
+                         const std::type_info& cbt, Handle& result,
+                         uint64_t& gen)
+{
+	Key k{clause, gnds, &cbt};
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	gen = generation(clause->get_type());
+	const auto& it = _map.find(k);
+	if (_map.end() == it) return false;
+
+	if (it->second.gen != gen)
+	{
+		erase(it);
+		return false;
+	}
+
+	_lru.splice(_lru.begin(), _lru, it->second.lru);
+	result = it->second.result;
+	return true;
+}
+
+void ClauseCache::insert(const Handle& clause, const HandleSeq& gnds,
+                         const std::type_info& cbt, const Handle& result,
+                         uint64_t gen)
+{
+	if (0 == _max) return;
+
+	Key k{clause, gnds, &cbt};
+
+	std::lock_guard<std::mutex> lck(_mtx);
+
+	const auto& it = _map.find(k);
+	if (_map.end() != it)
+	{
+		it->second.result = result;
+		it->second.gen = gen;
+		_lru.splice(_lru.begin(), _lru, it->second.lru);
+		return;
+	}
+
+	while (_max <= _map.size())
+	{
+		_map.erase(_lru.back());
+		_lru.pop_back();
+	}
+
+	_lru.push_front(k);
+	_map.emplace(std::move(k), Entry{result, gen, _lru.begin()});
+}
+
+void ClauseCache::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_map.clear();
+	_lru.clear();
+}
+
+size_t ClauseCache::size(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _map.size();
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,159 @@
+/*
+ * ClauseCache.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_CLAUSE_CACHE_H
+#define _OPENCOG_CLAUSE_CACHE_H
+
+#include <list>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atoms/atom_types/types.h>
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog {
+
+class AtomSpace;
+
+/**
+ * Clause groundings, shared by all of the searches made on one
+ * AtomSpace.
+ *
+ * Within a single search, the PatternMatchEngine already remembers
+ * how each cacheable clause was grounded (or that it could not be),
+ * for a given grounding of the variables in it. That memory is lost
+ * when the search ends. Workloads that run many similar queries, one
+ * after the other, end up grounding the same clauses over and over.
+ * This cache keeps those results around, across searches.
+ *
+ * Entries are keyed on the clause, with its variables renamed into
+ * a canonical form, so that alpha-equivalent clauses in different
+ * queries share entries, together with the groundings of those
+ * variables, in canonical order. The result is either the grounding
+ * of the clause, or the fact that there is none. Only clauses that the
+ * engine deems cacheable are stored; these have no evaluatable parts.
+ *
+ * Once the variables are grounded, the grounding of the clause is a
+ * link of the same type as the top of the clause. Thus, entries can
+ * only go stale when a link of that type is added or removed; the
+ * cache tracks this with one counter per type, bumped by the
+ * AtomSpace signals, and drops stale entries when they are next
+ * looked up. Entries are also evicted, least recently used first,
+ * once there are more than the given maximum.
+ *
+ * Caching is off unless a ClauseCache has been created for the
+ * AtomSpace being searched; it stays on for as long as that object
+ * lives (which must be longer than any search using it). Caveats:
+ *
+ * -- Only the given AtomSpace is watched. Atoms added to, or removed
+ *    from, a parent AtomSpace are not noticed.
+ * -- If the AtomSpace delivers signals asynchronously, a search
+ *    started right after a change might not yet see it.
+ * -- Results depend on the callback class, so entries are kept apart
+ *    for each; but callbacks whose decisions depend on state other
+ *    than the atoms themselves should not be used with this cache.
+ */
+class ClauseCache
+{
+	struct Key
+	{
+		Handle clause;              // canonical form; compared by content
+		HandleSeq gnds;             // compared by pointer
+		const std::type_info* cbt;  // callback class
+	};
+	struct KeyHash
+	{
+		size_t operator()(const Key&) const;
+	};
+	struct KeyEqual
+	{
+		bool operator()(const Key&, const Key&) const;
+	};
+
+	typedef std::list<Key> LruList;
+	struct Entry
+	{
+		Handle result;    // Handle::UNDEFINED if there is no grounding.
+		uint64_t gen;
+		LruList::iterator lru;
+	};
+
+	AtomSpace* _as;
+	size_t _max;
+
+	mutable std::mutex _mtx;
+	std::unordered_map<Key, Entry, KeyHash, KeyEqual> _map;
+	LruList _lru;       // Most recently used at the front.
+	std::vector<uint64_t> _gen;
+
+	int _add_sig;
+	int _remove_sig;
+	int _adds_sig;
+	int _removes_sig;
+
+	uint64_t generation(Type);
+	void bump(const Handle&);
+	void erase(std::unordered_map<Key, Entry, KeyHash, KeyEqual>::iterator);
+
+public:
+	ClauseCache(AtomSpace*, size_t max_entries = 100000);
+	~ClauseCache();
+
+	ClauseCache(const ClauseCache&) = delete;
+	ClauseCache& operator=(const ClauseCache&) = delete;
+
+	/// Return the cache created for this AtomSpace, or nullptr
+	/// if there is none.
+	static ClauseCache* find(const AtomSpace*);
+
+	/// The generation of Links of the clause's type, as of now. A
+	/// search that is about to start records it, and passes it to
+	/// insert(), once it is done.
+	uint64_t stamp(const Handle& clause);
+
+	/// Return true if there is a (current) entry for the canonical
+	/// clause, with the variables grounded in the given way. The
+	/// `result` is set to the grounding of the clause, or to
+	/// Handle::UNDEFINED, if it is known to have none. Whether or not
+	/// there is one, `gen` is set to the stamp() of the clause.
+	bool lookup(const Handle& clause, const HandleSeq& gnds,
+	            const std::type_info&, Handle& result, uint64_t& gen);
+
+	/// Record how the canonical clause was grounded; pass
+	/// Handle::UNDEFINED to record that it cannot be. The `gen` is
+	/// the stamp() taken before the search for it began; if Links
+	/// were added or removed since, the entry is stale as soon as
+	/// it is made.
+	void insert(const Handle& clause, const HandleSeq& gnds,
+	            const std::type_info&, const Handle& result,
+	            uint64_t gen);
+
+	void clear(void);
+	size_t size(void) const;
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_CLAUSE_CACHE_H
@@ -24,6 +24,8 @@
 #ifndef _OPENCOG_IMPLICATOR_H
 #define _OPENCOG_IMPLICATOR_H
 
+#include <typeinfo>
+
 #include "InitiateSearchMixin.h"
 #include "RewriteMixin.h"
 #include "SatisfyMixin.h"
@@ -49,6 +51,14 @@ class Implicator:
 				InitiateSearchMixin::set_pattern(vars, pat);
 				TermMatchMixin::set_pattern(vars, pat);
 			}
+
+			// Derived classes may search differently; they don't
+			// get copies, unless they say how.
+			virtual std::unique_ptr<PatternMatchCallback> branch_callback(void)
+			{
+				if (typeid(*this) != typeid(Implicator)) return nullptr;
+				return std::make_unique<Implicator>(RewriteMixin::_as);
+			}
 };
 
 }; // namespace opencog
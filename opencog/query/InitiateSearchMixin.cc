@@ -21,7 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/base/Trace.h>
 
 #include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/LambdaLink.h>
@@ -30,16 +33,24 @@
 #include <opencog/atoms/core/FindUtils.h>
 
 #include "InitiateSearchMixin.h"
+#include "MultiwayJoin.h"
 #include "PatternMatchEngine.h"
 
 #ifdef USE_THREADED_PATTERN_ENGINE
 	// #include <algorithm>
 	// #include <execution>
-	#include <opencog/util/oc_omp.h>
+	#include <atomic>
+	#include <thread>
+	#include <opencog/atoms/parallel/ThreadPool.h>
 #endif // USE_THREADED_PATTERN_ENGINE
 
 using namespace opencog;
 
+#ifdef USE_THREADED_PATTERN_ENGINE
+std::atomic<size_t>
+InitiateSearchMixin::parallel_min_search_set(PM_PARALLEL_MIN_SEARCH_SET);
+#endif // USE_THREADED_PATTERN_ENGINE
+
 // #define QDEBUG 1
 #ifdef QDEBUG
 #define DO_LOG(STUFF) STUFF
@@ -58,17 +69,58 @@ InitiateSearchMixin::InitiateSearchMixin(AtomSpace* as) :
 
 	_root = PatternTerm::UNDEFINED;
 	_starter_term = PatternTerm::UNDEFINED;
+	_search_type = NOTYPE;
 
 	_curr_clause = PatternTerm::UNDEFINED;
 	_start_choices.clear();
 	_as = as;
 }
 
+InitiateSearchMixin::~InitiateSearchMixin()
+{
+}
+
+/* ======================================================== */
+
+InitiateSearchMixin::EngineLease::EngineLease(InitiateSearchMixin* ism,
+                                              PatternMatchCallback& pmc)
+	: _ism(ism), _pme(nullptr)
+{
+	{
+		std::lock_guard<std::mutex> lck(_ism->_engine_mtx);
+		if (not _ism->_engines.empty())
+		{
+			_pme = _ism->_engines.back().release();
+			_ism->_engines.pop_back();
+		}
+	}
+
+	if (_pme)
+		_pme->reset(pmc);
+	else
+		_pme = new PatternMatchEngine(pmc);
+	_pme->set_pattern(*_ism->_variables, *_ism->_pattern);
+}
+
+InitiateSearchMixin::EngineLease::~EngineLease()
+{
+	std::lock_guard<std::mutex> lck(_ism->_engine_mtx);
+	_ism->_engines.emplace_back(_pme);
+}
+
 void InitiateSearchMixin::set_pattern(const Variables& vars,
                                       const Pattern& pat)
 {
 	_variables = &vars;
 	_pattern = &pat;
+
+	_clause_costs.clear();
+	for (const PatternTermPtr& root : pat.pmandatory)
+		_clause_costs[root.get()];
+	for (const PatternTermPtr& root : pat.absents)
+		_clause_costs[root.get()];
+	for (const PatternTermPtr& root : pat.always)
+		_clause_costs[root.get()];
 }
 
 
@@ -114,7 +166,8 @@ void InitiateSearchMixin::set_pattern(const Variables& vars,
 // size_t& depth will be set to the depth of the thinnest constant found.
 // Handle& start will be set to the link containing that constant.
 // size_t& width will be set to the incoming-set size of the thinnest
-//               constant found.
+//               constant found, counting only links of the type of
+//               the term that holds it.
 // The returned value will be the constant at which to start the search.
 // If no constant is found, then the returned value is the undefined
 // handle.
@@ -158,7 +211,14 @@ InitiateSearchMixin::find_starter_recursive(const PatternTermPtr& ptm,
 	{
 		if (VARIABLE_NODE != t and GLOB_NODE != t)
 		{
-			width = h->getIncomingSetSize();
+			// The search will be over the incoming set of the node,
+			// restricted to the type of the term holding it; so that
+			// is the width that matters. The by-type size is O(1).
+			const Handle& sth = startrm->getHandle();
+			if (sth and sth->is_link())
+				width = h->getIncomingSetSizeByType(sth->get_type());
+			else
+				width = h->getIncomingSetSize();
 			return h;
 		}
 		return Handle::UNDEFINED;
@@ -205,6 +265,7 @@ InitiateSearchMixin::find_starter_recursive(const PatternTermPtr& ptm,
 				ch.clause = _curr_clause;
 				ch.start_term = sbr;
 				ch.search_set = get_incoming_set(s, sbr->getQuote()->get_type());
+				narrow_search_set(sbr, ch.search_set);
 				_start_choices.push_back(ch);
 			}
 			else
@@ -273,6 +334,61 @@ Handle InitiateSearchMixin::find_thinnest(const PatternTermSeq& clauses,
 	return best_start;
 }
 
+/* ======================================================== */
+/**
+ * The search set for a start term is the incoming set of the start
+ * atom, restricted to the type of the term. When the start atom sits
+ * under a common predicate, say, as in
+ *
+ *    EvaluationLink
+ *       PredicateNode "foo"
+ *       ListLink ...
+ *
+ * that is every EvaluationLink holding "foo" anywhere, including those
+ * where it is not the predicate. Keep only those links that have the
+ * arity of the term, and the term's constant nodes at the very same
+ * positions; the rest cannot possibly be grounded by it. This is the
+ * intersection of the (link type, position, atom) index entries for
+ * all of the constants in the term, taken starting from the thinnest
+ * one, which is already at hand.
+ *
+ * As elsewhere in this file, this assumes that `node_match()` and
+ * `link_match()` are not lenient: nodes match only themselves, and
+ * links only links of the same arity.
+ */
+void InitiateSearchMixin::narrow_search_set(const PatternTermPtr& term,
+                                            HandleSeq& sset)
+{
+	const Handle& h = term->getHandle();
+	if (not h->is_link() or term->isUnorderedLink() or
+	    term->hasGlobbyVar() or term->getQuote() != h)
+		return;
+
+	std::vector<std::pair<Arity, Handle>> fixed;
+	Arity arity = term->getArity();
+	for (Arity i = 0; i < arity; i++)
+	{
+		const PatternTermPtr& sub = term->getOutgoingTerm(i);
+		const Handle& sh = sub->getHandle();
+		Type st = sh->get_type();
+		if (not sh->is_node() or sub->getQuote() != sh or
+		    sub->isBoundVariable() or
+		    VARIABLE_NODE == st or GLOB_NODE == st)
+			continue;
+		fixed.push_back({i, sh});
+	}
+
+	auto misfit = [&](const Handle& cand) -> bool
+	{
+		if (cand->get_arity() != arity) return true;
+		for (const auto& fx : fixed)
+			if (cand->getOutgoingAtom(fx.first) != fx.second) return true;
+		return false;
+	};
+	sset.erase(std::remove_if(sset.begin(), sset.end(), misfit),
+	           sset.end());
+}
+
 /* ======================================================== */
 
 const PatternTermSeq& InitiateSearchMixin::get_clause_list(void)
@@ -368,6 +484,7 @@ bool InitiateSearchMixin::setup_neighbor_search(const PatternTermSeq& clauses)
 			// XXX ?? Why incoming set ???
 			ch.search_set = get_incoming_set(best_start,
 			                              _starter_term->getHandle()->get_type());
+			narrow_search_set(_starter_term, ch.search_set);
 		}
 		else
 		{
@@ -401,6 +518,7 @@ bool InitiateSearchMixin::choice_loop(PatternMatchCallback& pmc,
 		bool found = search_loop(pmc, dbg_banner);
 		// Terminate search if satisfied.
 		if (found) return true;
+		if (pmc.search_halted()) return false;
 	}
 
 	// If we are here, we have searched the entire neighborhood, and
@@ -499,6 +617,8 @@ bool InitiateSearchMixin::choice_loop(PatternMatchCallback& pmc,
  */
 bool InitiateSearchMixin::perform_search(PatternMatchCallback& pmc)
 {
+	TRACE_SPAN("search");
+
 	// Start with a clean slate. This might be called multiple
 	// times, for groundings of different components.
 	_root = PatternTerm::UNDEFINED;
@@ -507,6 +627,16 @@ bool InitiateSearchMixin::perform_search(PatternMatchCallback& pmc)
 	_search_set.clear();
 	_start_choices.clear();
 
+#ifdef USE_MULTIWAY_JOIN
+	// Cyclic, purely structural patterns are better joined one
+	// variable at a time, than one clause at a time.
+	if (_as and MultiwayJoin::is_eligible(*_variables, *_pattern))
+	{
+		MultiwayJoin mwj(pmc, *_pattern, _as);
+		return mwj.search();
+	}
+#endif
+
 	// Fallback to the legacy mode.
 	if (1 != _pattern->pmandatory.size())
 		return legacy_search(pmc);
@@ -583,9 +713,8 @@ bool InitiateSearchMixin::legacy_search(PatternMatchCallback& pmc)
 	DO_LOG({logger().fine("Cannot use node-neighbor search, use no-var search");})
 	if (setup_no_search())
 	{
-		PatternMatchEngine pme(pmc);
-		pme.set_pattern(*_variables, *_pattern);
-		return pme.explore_constant_evaluatables(_pattern->pmandatory);
+		EngineLease pme(this, pmc);
+		return pme->explore_constant_evaluatables(_pattern->pmandatory);
 	}
 
 	DO_LOG({logger().fine("Cannot use no-var search, use deep-type search");})
@@ -914,10 +1043,9 @@ bool InitiateSearchMixin::setup_link_type_search(const PatternTermSeq& clauses)
 	DO_LOG({LAZY_LOG_FINE << "Start term is:\n"
 	                      << _starter_term->to_short_string();})
 
-	// Get type of the rarest link
-	Type ptype = _starter_term->getHandle()->get_type();
-
-	_as->get_handles_by_type(_search_set, ptype);
+	// Get type of the rarest link. The search loop will walk over
+	// all of the Atoms of this type; they are not copied out here.
+	_search_type = _starter_term->getHandle()->get_type();
 	return true;
 }
 
@@ -1130,39 +1258,90 @@ bool InitiateSearchMixin::search_loop(PatternMatchCallback& pmc,
 	// then the extra cost might be worth it. However, this is NOT
 	// always the bottleneck! Be careful not to penalize small users!
 	// See the benchmark `nano-en.scm` in the opencog/benchmark GitHub
-	// repo, for example.
+	// repo, for example. Search sets smaller than
+	// `parallel_min_search_set` are always searched sequentially.
 	//
 #ifndef USE_THREADED_PATTERN_ENGINE
 	// See explanation below for the `_recursing` flag.
 	_recursing = true;
 #endif
 
-	if (_recursing)
+	SearchStats* stats = pmc.get_stats();
+	if (stats and _starter_term) stats->add_start(_starter_term->getHandle());
+
+	// The link-type search does not fill in the search set.
+	Type stype = _search_type;
+	_search_type = NOTYPE;
+	if (NOTYPE != stype)
+	{
+		if (not _recursing)
+		{
+			_search_set.clear();
+			_as->get_handles_by_type(_search_set, stype);
+		}
+		else
+		{
+			EngineLease pme(this, pmc);
+
+			while (0 < _issued_stack.size()) _issued_stack.pop();
+			_issued.clear();
+			_issued.insert(_root);
+			// Stop walking the bucket once the search is halted, too,
+			// but report only an actual grounding as found.
+			bool found = false;
+			_as->foreach_handle_by_type(stype, false,
+				[&](const Handle& h) -> bool {
+					DO_LOG({LAZY_LOG_FINE << dbg_banner
+					             << "\n       Loop candidate:\n"
+					             << h->to_string("       ");})
+					found = pme->explore_neighborhood(_starter_term, h, _root);
+					return found or pmc.search_halted();
+				});
+			return found;
+		}
+	}
+
+#ifdef USE_THREADED_PATTERN_ENGINE
+	bool sequential = _recursing or
+		_search_set.size() < parallel_min_search_set;
+#else
+	bool sequential = _recursing;
+#endif
+
+	if (sequential)
 	{
 		// Plain-old, olde-fashioned sequential search loop.
 		// This works.
 #ifdef QDEBUG
 		size_t i = 0, hsz = _search_set.size();
 #endif
+#ifdef USE_THREADED_PATTERN_ENGINE
+		// Same as the unthreaded build: the components of this search
+		// are searched from within this loop, and must not go parallel.
+		bool was_recursing = _recursing;
+		_recursing = true;
+#endif
 
-		PatternMatchEngine pme(pmc);
-		pme.set_pattern(*_variables, *_pattern);
+		EngineLease pme(this, pmc);
 
 		while (0 < _issued_stack.size()) _issued_stack.pop();
 		_issued.clear();
 		_issued.insert(_root);
+		bool found = false;
 		for (const Handle& h : _search_set)
 		{
 			DO_LOG({LAZY_LOG_FINE << dbg_banner
 			             << "\n       Loop candidate ("
 			             << ++i << "/" << hsz << "):\n"
 			             << h->to_string("       ");})
-			bool found = pme.explore_neighborhood(_starter_term,
-			                                      h, _root);
-			if (found) return true;
+			found = pme->explore_neighborhood(_starter_term, h, _root);
+			if (found or pmc.search_halted()) break;
 		}
 
-		return false;
+#ifdef USE_THREADED_PATTERN_ENGINE
+		_recursing = was_recursing;
+#endif
+		return found;
 	}
 
 	// Note also: for multi-component patterns, this entire class
@@ -1191,10 +1370,9 @@ bool InitiateSearchMixin::search_loop(PatternMatchCallback& pmc,
 		_search_set.end(),
 		[&](auto&& h)
 		{
-			PatternMatchEngine pme(pmc);
-			pme.set_pattern(*_variables, *_pattern);
+			EngineLease pme(this, pmc);
 
-			if (pme.explore_neighborhood(_starter_term, h, _root)) nfnd++;
+			if (pme->explore_neighborhood(_starter_term, h, _root)) nfnd++;
 		});
 
 	_recursing = false;
@@ -1203,37 +1381,54 @@ bool InitiateSearchMixin::search_loop(PatternMatchCallback& pmc,
 #endif
 
 #ifdef USE_THREADED_PATTERN_ENGINE
-	#define OMP_PM_PARALLEL 1
-#endif
-#ifdef OMP_PM_PARALLEL
-	// Parallel loop. This requires OpenMP to work.
+	// Parallel loop. Each worker thread leases its own engine, and
+	// pulls chunks of the search set until it is used up, or until
+	// some worker reports that the search is done. The callbacks are
+	// shared; those that collect groundings do so under a mutex, see
+	// `LOCK_PE_MUTEX` in `PatternMatchCallback.h`. The workers are
+	// those of the shared pool; if it is pinned (see
+	// `ThreadPool::set_affinity()`), then a search started from within
+	// the pool is spread over the workers of the same socket first.
 	_recursing = true;
-	_issued_stack.clear();
+	while (0 < _issued_stack.size()) _issued_stack.pop();
 	_issued.clear();
 	_issued.insert(_root);
 
-#ifdef QDEBUG
-	size_t i = 0;
-#endif
-
-	std::atomic<size_t> nfnd = 0;
 	size_t hsz = _search_set.size();
-	#pragma omp parallel for
-	for (size_t j=0; j<hsz; j++)
+	size_t nchunks = (hsz + PM_PARALLEL_CHUNK - 1) / PM_PARALLEL_CHUNK;
+	size_t nthreads = std::thread::hardware_concurrency();
+	if (0 == nthreads) nthreads = 1;
+	if (nchunks < nthreads) nthreads = nchunks;
+
+	std::atomic<size_t> next_chunk(0);
+	std::atomic<bool> found(false);
+	auto worker = [&]()
 	{
-		PatternMatchEngine pme(pmc);
-		pme.set_pattern(*_variables, *_pattern);
+		EngineLease pme(this, pmc);
 
-		Handle h(_search_set[j]);
-		DO_LOG({LAZY_LOG_FINE << dbg_banner
-		             << "\n       Loop candidate ("
-		             << ++i << "/" << hsz << "):\n"
-		             << h->to_short_string("       ");})
+		while (not found and not pmc.search_halted())
+		{
+			size_t start = PM_PARALLEL_CHUNK * next_chunk++;
+			if (hsz <= start) break;
+			size_t end = std::min(hsz, start + PM_PARALLEL_CHUNK);
+			for (size_t j = start; j < end and not found; j++)
+			{
+				const Handle& h(_search_set[j]);
+				DO_LOG({LAZY_LOG_FINE << dbg_banner
+				             << "\n       Loop candidate ("
+				             << j+1 << "/" << hsz << "):\n"
+				             << h->to_short_string("       ");})
+
+				if (pme->explore_neighborhood(_starter_term, h, _root))
+					found = true;
+			}
+		}
+	};
+
+	thread_pool().parallel_for(nthreads, [&](size_t) { worker(); });
 
-		if (pme.explore_neighborhood(_starter_term, h, _root)) nfnd++;
-	}
 	_recursing = false;
-	return 0 < nfnd;
+	return found;
 #endif
 
 	return false;
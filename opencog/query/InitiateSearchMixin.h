@@ -25,6 +25,12 @@
 #ifndef _OPENCOG_INITIATE_SEARCH_H
 #define _OPENCOG_INITIATE_SEARCH_H
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <opencog/util/empty_string.h>
 #include <opencog/atoms/atom_types/types.h>
 #include <opencog/atoms/core/Quotation.h>
@@ -34,6 +40,7 @@
 namespace opencog {
 
 class AtomSpace;
+class PatternMatchEngine;
 
 /**
  * Callback mixin class, used to provide a default atomspace search.
@@ -46,6 +53,7 @@ class InitiateSearchMixin : public virtual PatternMatchCallback
 {
 public:
 	InitiateSearchMixin(AtomSpace*);
+	virtual ~InitiateSearchMixin();
 
 	/**
 	 * Called to perform the actual search. This makes some default
@@ -59,9 +67,16 @@ public:
 	virtual void pop(void);
 	virtual void next_connections(const GroundingMap&);
 	virtual bool get_next_clause(PatternTermPtr&, PatternTermPtr&);
+	virtual void note_branches(const PatternTermPtr&, size_t);
 
 	std::string to_string(const std::string& indent=empty_string) const;
 
+#ifdef USE_THREADED_PATTERN_ENGINE
+	/// Search sets smaller than this are searched sequentially.
+	/// Defaults to `PM_PARALLEL_MIN_SEARCH_SET`.
+	static std::atomic<size_t> parallel_min_search_set;
+#endif
+
 protected:
 
 	NameServer& _nameserver;
@@ -74,6 +89,10 @@ protected:
 	PatternTermPtr _starter_term;
 	HandleSeq _search_set;
 
+	// If not NOTYPE, then the search loop visits all of the Atoms of
+	// this type, directly from the AtomSpace, instead of `_search_set`.
+	Type _search_type;
+
 	struct Choice
 	{
 		PatternTermPtr clause;
@@ -93,6 +112,7 @@ protected:
 	                         size_t&, Quotation quotation=Quotation());
 
 	const PatternTermSeq& get_clause_list(void);
+	void narrow_search_set(const PatternTermPtr&, HandleSeq&);
 
 	bool setup_neighbor_search(const PatternTermSeq&);
 	bool setup_no_search(void);
@@ -106,6 +126,27 @@ protected:
 	bool choice_loop(PatternMatchCallback&, const std::string);
 	bool search_loop(PatternMatchCallback&, const std::string);
 
+	// Engines that are done with, kept for the next search loop, so
+	// that their state does not have to be allocated again. Leases
+	// are handed out under a lock, so that each worker thread of a
+	// threaded search gets an engine of its own.
+	std::mutex _engine_mtx;
+	std::vector<std::unique_ptr<PatternMatchEngine>> _engines;
+
+	/// An engine from the pool, set up for the current pattern, and
+	/// handed back when it goes out of scope.
+	struct EngineLease
+	{
+		InitiateSearchMixin* _ism;
+		PatternMatchEngine* _pme;
+
+		EngineLease(InitiateSearchMixin*, PatternMatchCallback&);
+		~EngineLease();
+		EngineLease(const EngineLease&) = delete;
+		EngineLease& operator=(const EngineLease&) = delete;
+		PatternMatchEngine* operator->() const { return _pme; }
+	};
+
 	static PatternTermPtr term_of_handle(const Handle&, const PatternTermPtr&);
 	static PatternTermSeq term_choices_of_handle(const Handle&, const PatternTermPtr&);
 
@@ -124,6 +165,20 @@ protected:
 	Handle get_glob_embedding(const GroundingMap&, const Handle&);
 	bool get_next_thinnest_clause(const GroundingMap&, bool, bool);
 	unsigned int thickness(const PatternTermPtr&, const HandleSet&);
+	size_t join_width(const Handle&, const Handle&, const PatternTermPtr&);
+
+	// The cost of each clause, as estimated by join_width() each
+	// time it was chosen, and as seen by the engine while grounding
+	// it. They are set up, for all clauses, in set_pattern(), and
+	// only counted up during the search, from any thread.
+	struct ClauseCost
+	{
+		std::atomic<size_t> chosen{0};
+		std::atomic<size_t> estimated{0};
+		std::atomic<size_t> observed{0};
+	};
+	std::unordered_map<const PatternTerm*, ClauseCost> _clause_costs;
+	size_t join_cost(const PatternTermPtr&, size_t);
 
 	AtomSpace *_as;
 };
@@ -0,0 +1,416 @@
+/*
+ * MultiwayJoin.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "MultiwayJoin.h"
+
+using namespace opencog;
+
+/* ======================================================== */
+
+MultiwayJoin::MultiwayJoin(PatternMatchCallback& pmc,
+                           const Pattern& pat,
+                           AtomSpace* as)
+	: _pmc(pmc), _pat(pat), _as(as),
+	  _clauses(pat.pmandatory)
+{
+	make_order();
+}
+
+/// Return true if the term is made only of ordered links, constant
+/// nodes and plain variables.
+bool MultiwayJoin::is_structural(const PatternTerm* ptm)
+{
+	if (ptm->isQuoted() or ptm->isChoice() or ptm->isPresent()
+	    or ptm->isAbsent() or ptm->isAlways()
+	    or ptm->hasAnyEvaluatable() or ptm->hasAnyGlobbyVar()
+	    or ptm->hasUnorderedLink())
+		return false;
+
+	const Handle& h = ptm->getHandle();
+	if (h->is_node())
+		return not ptm->isBoundVariable() or VARIABLE_NODE == h->get_type();
+
+	Type t = h->get_type();
+	if (CHOICE_LINK == t or nameserver().isA(t, SCOPE_LINK))
+		return false;
+
+	if (ptm->getArity() != h->get_arity()) return false;
+	for (Arity i = 0; i < ptm->getArity(); i++)
+		if (not is_structural(ptm->getOutgoingTerm(i).get())) return false;
+
+	return true;
+}
+
+bool MultiwayJoin::is_eligible(const Variables& vars, const Pattern& pat)
+{
+	if (not pat.absents.empty() or not pat.always.empty()) return false;
+	if (pat.have_evaluatables or not pat.defined_terms.empty()) return false;
+	if (pat.pmandatory.size() < 2) return false;
+
+	HandleSet seen;
+	size_t edges = 0;
+	for (const PatternTermPtr& clause : pat.pmandatory)
+	{
+		if (not clause->isLink() or not is_structural(clause.get()))
+			return false;
+
+		const auto& cv = pat.clause_variables.find(clause);
+		if (pat.clause_variables.end() == cv or cv->second.empty())
+			return false;
+
+		HandleSet cvars(cv->second.begin(), cv->second.end());
+		edges += cvars.size();
+		seen.insert(cvars.begin(), cvars.end());
+	}
+
+	// Every variable must be pinned down by some clause.
+	if (seen.size() != vars.varset.size()) return false;
+
+	// Clauses and variables, joined whenever a variable appears in a
+	// clause, form a graph. If it were a forest, it would have fewer
+	// edges than nodes; so if it does not, there is a cycle.
+	return edges >= pat.pmandatory.size() + seen.size();
+}
+
+/* ======================================================== */
+
+/// Pick an order in which to ground the variables: start with the
+/// one in the most clauses, and then always take the one that is
+/// most tightly tied to those already chosen. This puts the variables
+/// that close off a cycle as early as possible.
+void MultiwayJoin::make_order(void)
+{
+	for (size_t ic = 0; ic < _clauses.size(); ic++)
+	{
+		for (const Handle& v : _pat.clause_variables.at(_clauses[ic]))
+		{
+			std::vector<size_t>& cls = _var_clauses[v];
+			if (cls.empty() or cls.back() != ic) cls.push_back(ic);
+		}
+	}
+
+	std::vector<bool> touched(_clauses.size(), false);
+	HandleSet chosen;
+	while (_order.size() < _var_clauses.size())
+	{
+		Handle best;
+		size_t best_conn = 0;
+		size_t best_deg = 0;
+		for (const auto& vc : _var_clauses)
+		{
+			if (chosen.end() != chosen.find(vc.first)) continue;
+
+			size_t conn = 0;
+			for (size_t ic : vc.second)
+				if (touched[ic]) conn++;
+
+			size_t deg = vc.second.size();
+			if (nullptr == best or best_conn < conn or
+			    (best_conn == conn and best_deg < deg))
+			{
+				best = vc.first;
+				best_conn = conn;
+				best_deg = deg;
+			}
+		}
+
+		chosen.insert(best);
+		_order.push_back(best);
+		for (size_t ic : _var_clauses[best])
+			touched[ic] = true;
+	}
+}
+
+/* ======================================================== */
+
+/// Find the grounded atom in the clause (a constant, or a variable
+/// that already has a grounding) with the fewest links above it, of
+/// the type of the term that holds it.
+void MultiwayJoin::find_anchor(const PatternTermPtr& ptm,
+                               PatternTermPtr& anchor,
+                               Handle& agnd,
+                               size_t& width)
+{
+	const Handle& h = ptm->getHandle();
+	if (h->is_link())
+	{
+		for (Arity i = 0; i < ptm->getArity(); i++)
+			find_anchor(ptm->getOutgoingTerm(i), anchor, agnd, width);
+		return;
+	}
+
+	Handle g(h);
+	if (ptm->isBoundVariable())
+	{
+		const auto& gnd = _var_gnd.find(h);
+		if (_var_gnd.end() == gnd) return;
+		g = gnd->second;
+	}
+
+	Type pt = ptm->getParent()->getHandle()->get_type();
+	size_t w = g->getIncomingSetSizeByType(pt);
+	if (w < width)
+	{
+		width = w;
+		anchor = ptm;
+		agnd = g;
+	}
+}
+
+/// Estimate how many candidate groundings the clause has, given the
+/// variables grounded so far.
+size_t MultiwayJoin::anchor_width(const PatternTermPtr& clause)
+{
+	PatternTermPtr anchor;
+	Handle agnd;
+	size_t width = SIZE_MAX;
+	find_anchor(clause, anchor, agnd, width);
+	if (anchor) return width;
+
+	return _as->get_num_atoms_of_type(clause->getHandle()->get_type());
+}
+
+/// Fill `roots` with the links that might ground the clause. These
+/// have the right shape along the path from the anchor up to the top
+/// of the clause, but must still be checked with match().
+void MultiwayJoin::candidates(const PatternTermPtr& clause,
+                              HandleSeq& roots)
+{
+	roots.clear();
+
+	PatternTermPtr anchor;
+	Handle agnd;
+	size_t width = SIZE_MAX;
+	find_anchor(clause, anchor, agnd, width);
+
+	// Nothing in the clause is grounded yet; every link of the
+	// right type is a candidate.
+	if (nullptr == anchor)
+	{
+		_as->get_handles_by_type(roots, clause->getHandle()->get_type());
+		return;
+	}
+
+	// Walk upwards from the anchor to the top of the clause, keeping
+	// only those links that hold the grounding below at the same
+	// position as the pattern does.
+	roots.push_back(agnd);
+	HandleSeq above;
+	IncomingSet iset;
+	for (PatternTermPtr term(anchor); term != clause; term = term->getParent())
+	{
+		PatternTermPtr parent(term->getParent());
+		const Handle& hp = parent->getHandle();
+		Arity pos = 0;
+		while (parent->getOutgoingTerm(pos) != term) pos++;
+
+		above.clear();
+		for (const Handle& below : roots)
+		{
+			_pmc.fill_incoming_set(below, hp->get_type(), iset);
+			for (const Handle& hl : iset)
+			{
+				if (hl->get_arity() == hp->get_arity() and
+				    hl->getOutgoingSet()[pos] == below)
+					above.push_back(hl);
+			}
+		}
+		roots.swap(above);
+	}
+}
+
+/// Compare the pattern term to a proposed grounding. Variables that
+/// are not yet grounded are recorded in `local`. If `terms` is given,
+/// the groundings of all links holding variables are recorded there.
+bool MultiwayJoin::match(const PatternTermPtr& ptm,
+                         const Handle& g,
+                         GroundingMap& local,
+                         GroundingMap* terms)
+{
+	const Handle& hp = ptm->getHandle();
+	if (ptm->isBoundVariable())
+	{
+		const auto& gnd = _var_gnd.find(hp);
+		if (_var_gnd.end() != gnd) return gnd->second == g;
+
+		const auto& lgnd = local.find(hp);
+		if (local.end() != lgnd) return lgnd->second == g;
+
+		if (not _pmc.variable_match(hp, g)) return false;
+		local.emplace(hp, g);
+		return true;
+	}
+
+	if (hp->is_node()) return _pmc.node_match(hp, g);
+
+	if (hp->get_type() != g->get_type() or
+	    hp->get_arity() != g->get_arity())
+		return false;
+
+	if (not _pmc.link_match(ptm, g)) return false;
+
+	const HandleSeq& osg = g->getOutgoingSet();
+	for (Arity i = 0; i < ptm->getArity(); i++)
+	{
+		if (not match(ptm->getOutgoingTerm(i), osg[i], local, terms))
+		{
+			_pmc.post_link_mismatch(hp, g);
+			return false;
+		}
+	}
+
+	if (not _pmc.post_link_match(hp, g)) return false;
+
+	if (terms and ptm->hasAnyBoundVariable())
+		terms->emplace(hp, g);
+	return true;
+}
+
+/// Return true if the clause can still be grounded, given the
+/// variables grounded so far.
+bool MultiwayJoin::satisfiable(const PatternTermPtr& clause)
+{
+	HandleSeq roots;
+	candidates(clause, roots);
+	for (const Handle& r : roots)
+	{
+		GroundingMap local;
+		if (match(clause, r, local)) return true;
+	}
+	return false;
+}
+
+/* ======================================================== */
+
+/// Ground the variable at `level` in the order, and recurse.
+bool MultiwayJoin::join(size_t level)
+{
+	if (_order.size() == level) return report();
+
+	const Handle& var = _order[level];
+	const std::vector<size_t>& cls = _var_clauses[var];
+
+	// Take the candidates from the most selective clause.
+	size_t best = cls[0];
+	size_t width = SIZE_MAX;
+	for (size_t ic : cls)
+	{
+		size_t w = anchor_width(_clauses[ic]);
+		if (w < width)
+		{
+			width = w;
+			best = ic;
+		}
+	}
+
+	const PatternTermPtr& bcl = _clauses[best];
+	HandleSeq roots;
+	candidates(bcl, roots);
+
+	HandleSeq values;
+	for (const Handle& r : roots)
+	{
+		GroundingMap local;
+		if (match(bcl, r, local))
+			values.push_back(local.at(var));
+	}
+	std::sort(values.begin(), values.end(),
+		[](const Handle& a, const Handle& b) { return a.get() < b.get(); });
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+
+	// Keep only those candidates that every other clause holding
+	// this variable can agree with.
+	for (const Handle& val : values)
+	{
+		_var_gnd[var] = val;
+
+		bool ok = true;
+		for (size_t ic : cls)
+		{
+			if (ic == best) continue;
+			if (not satisfiable(_clauses[ic]))
+			{
+				ok = false;
+				break;
+			}
+		}
+
+		if (ok and join(level+1))
+		{
+			_var_gnd.erase(var);
+			return true;
+		}
+	}
+	_var_gnd.erase(var);
+	return false;
+}
+
+/// All variables are grounded; find the clause groundings, and
+/// hand the whole thing to the callback.
+bool MultiwayJoin::report(void)
+{
+	GroundingMap var_soln(_var_gnd);
+	GroundingMap term_soln;
+
+	HandleSeq roots;
+	for (const PatternTermPtr& clause : _clauses)
+	{
+		candidates(clause, roots);
+
+		// The first root that matches, and that the callback accepts.
+		// Others may be accepted, where the first one is not.
+		const Handle& hcl = clause->getHandle();
+		Handle gnd;
+		for (const Handle& r : roots)
+		{
+			GroundingMap local;
+			GroundingMap terms;
+			if (not match(clause, r, local, &terms)) continue;
+
+			GroundingMap tried(var_soln);
+			tried.insert(terms.begin(), terms.end());
+			if (not _pmc.clause_match(hcl, r, tried)) continue;
+
+			gnd = r;
+			var_soln.swap(tried);
+			break;
+		}
+		if (nullptr == gnd) return false;
+		term_soln[hcl] = gnd;
+	}
+
+	return _pmc.grounding(var_soln, term_soln);
+}
+
+bool MultiwayJoin::search(void)
+{
+	_var_gnd.clear();
+	return join(0);
+}
+
+/* ===================== END OF FILE ===================== */
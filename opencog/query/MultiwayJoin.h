@@ -0,0 +1,107 @@
+/*
+ * MultiwayJoin.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_MULTIWAY_JOIN_H
+#define _OPENCOG_MULTIWAY_JOIN_H
+
+#include <map>
+#include <vector>
+
+#include <opencog/atoms/core/Variables.h>
+#include <opencog/atoms/pattern/Pattern.h>
+#include <opencog/query/PatternMatchCallback.h>
+
+namespace opencog {
+
+class AtomSpace;
+
+/**
+ * Variable-at-a-time ("generic join") search, for cyclic patterns.
+ *
+ * The PatternMatchEngine grounds a pattern one clause at a time,
+ * walking from a grounded clause into the next one. For patterns
+ * with cycles in them (triangles, cliques, and the like) this is the
+ * worst possible way to do it: the partial groundings of a path
+ * through the cycle are enumerated in full, before the clause that
+ * closes the cycle gets to reject almost all of them.
+ *
+ * Here, instead, the variables are grounded one at a time. For each
+ * variable, the candidate groundings are taken from the clause that
+ * offers the fewest of them (given what has been grounded so far),
+ * and every candidate is then checked against all the other clauses
+ * that the variable appears in, before going on to the next variable.
+ * Each clause is consulted through the (type-restricted) incoming set
+ * of its most selective grounded atom. Thus, the work done is bounded
+ * by the smallest of the clauses, at each step, rather than by the
+ * product of the clauses on a path.
+ *
+ * Only purely structural patterns are handled: mandatory clauses made
+ * of ordered links, constants and plain variables. Anything else
+ * (evaluatables, globs, unordered links, quotes, scopes, choices,
+ * absent or always clauses) is left to the PatternMatchEngine.
+ */
+class MultiwayJoin
+{
+	PatternMatchCallback& _pmc;
+	const Pattern& _pat;
+	AtomSpace* _as;
+
+	const PatternTermSeq& _clauses;
+
+	// The order in which variables are grounded, and, for each
+	// variable, the (indexes of the) clauses that it appears in.
+	HandleSeq _order;
+	std::map<Handle, std::vector<size_t>> _var_clauses;
+
+	// The groundings found so far.
+	GroundingMap _var_gnd;
+
+	void make_order(void);
+	bool join(size_t);
+	bool report(void);
+
+	void find_anchor(const PatternTermPtr&,
+	                 PatternTermPtr&, Handle&, size_t&);
+	size_t anchor_width(const PatternTermPtr&);
+	void candidates(const PatternTermPtr&, HandleSeq&);
+	bool satisfiable(const PatternTermPtr&);
+	bool match(const PatternTermPtr&, const Handle&,
+	           GroundingMap&, GroundingMap* = nullptr);
+
+	static bool is_structural(const PatternTerm*);
+
+public:
+	MultiwayJoin(PatternMatchCallback&, const Pattern&, AtomSpace*);
+
+	/// Return true if the pattern has cycles, and can be searched
+	/// by this class.
+	static bool is_eligible(const Variables&, const Pattern&);
+
+	/// Report every grounding to the callback; return true if the
+	/// callback asked that the search be halted.
+	bool search(void);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_MULTIWAY_JOIN_H
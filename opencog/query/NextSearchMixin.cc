@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 #include <opencog/util/oc_assert.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atoms/core/FindUtils.h>
@@ -193,6 +195,75 @@ unsigned int InitiateSearchMixin::thickness(const PatternTermPtr& clause,
 	return count;
 }
 
+/// join_width() -- estimate the cost of moving from the grounded
+/// term `pursue` (with grounding `gnd`) into the ungrounded clause
+/// `root`. That move walks the incoming set of the grounding, but
+/// only those links of the same type as the term holding `pursue`
+/// in the clause; so it is the size of that part of the incoming set
+/// that matters, and not the whole thing. If `pursue` appears more
+/// than once in the clause, each place will be tried.
+///
+/// When the holding term is not a plain link (a choice, or something
+/// evaluatable), assume the worst, and use the full incoming set.
+size_t InitiateSearchMixin::join_width(const Handle& pursue,
+                                       const Handle& gnd,
+                                       const PatternTermPtr& root)
+{
+	const auto& ptms = _pattern->connected_terms_map.find({pursue, root});
+	if (_pattern->connected_terms_map.end() == ptms)
+		return gnd->getIncomingSetSize();
+
+	size_t width = 0;
+	for (const PatternTermPtr& ptm : ptms->second)
+	{
+		const PatternTermPtr& parent = ptm->getParent();
+		const Handle& ph = parent->getHandle();
+		if (nullptr == ph or parent->isChoice() or parent->isPresent()
+		    or parent->hasEvaluatable())
+			return gnd->getIncomingSetSize();
+		width += gnd->getIncomingSetSizeByType(ph->get_type());
+	}
+	return width;
+}
+
+/// Re-planning: join_width() is only an estimate, taken at the first
+/// step up from the joint. If, when a clause was grounded before, the
+/// engine had to walk many more branches than that (the incoming sets
+/// further up exploded), then the clause is charged for it: its width
+/// is scaled by how far off the estimates were, so far, in this
+/// search. Below the threshold, the estimate is left as it is, so
+/// that the order only changes when it was clearly wrong.
+#define REPLAN_RATIO 4
+#define REPLAN_MIN_CHOSEN 2
+
+size_t InitiateSearchMixin::join_cost(const PatternTermPtr& root,
+                                      size_t width)
+{
+	const auto& cc = _clause_costs.find(root.get());
+	if (_clause_costs.end() == cc) return width;
+
+	const ClauseCost& cost = cc->second;
+	if (cost.chosen.load(std::memory_order_relaxed) < REPLAN_MIN_CHOSEN)
+		return width;
+
+	size_t est = std::max<size_t>(1,
+		cost.estimated.load(std::memory_order_relaxed));
+	size_t obs = cost.observed.load(std::memory_order_relaxed);
+	if (obs <= REPLAN_RATIO * est) return width;
+
+	double scaled = double(std::max<size_t>(1, width)) * obs / est;
+	if (double(SIZE_MAX / 2) < scaled) return SIZE_MAX / 2;
+	return scaled;
+}
+
+void InitiateSearchMixin::note_branches(const PatternTermPtr& clause,
+                                        size_t nbranches)
+{
+	const auto& cc = _clause_costs.find(clause.get());
+	if (_clause_costs.end() == cc) return;
+	cc->second.observed.fetch_add(nbranches, std::memory_order_relaxed);
+}
+
 /// get_glob_embedding() -- given glob node, return term that it grounds.
 ///
 /// If a GlobNode has a grounding, then there is always some
@@ -261,11 +332,8 @@ bool InitiateSearchMixin::get_next_thinnest_clause(const GroundingMap& var_groun
 	// Make a list of the as-yet ungrounded variables.
 	HandleSet ungrounded_vars;
 
-	// Grounded variables ordered by the size of their grounding
-	// incoming set. Ideally, we should look only at the incoming
-	// set that matches the type of the parent term. But for now,
-	// this simpler code is good enough. XXX FIXME someday?
-	std::multimap<std::size_t, Handle> thick_vars;
+	// Grounded variables (or glob-holding terms), and their groundings.
+	HandlePairSeq thick_vars;
 
 	for (const Handle &v : _variables->varset)
 	{
@@ -280,13 +348,11 @@ bool InitiateSearchMixin::get_next_thinnest_clause(const GroundingMap& var_groun
 			{
 				Handle embed = get_glob_embedding(var_grounding, v);
 				const Handle& tg = var_grounding.find(embed)->second;
-				std::size_t incoming_set_size = tg->getIncomingSetSize();
-				thick_vars.insert(std::make_pair(incoming_set_size, embed));
+				thick_vars.push_back({embed, tg});
 			}
 			else
 			{
-				std::size_t incoming_set_size = gnd->second->getIncomingSetSize();
-				thick_vars.insert(std::make_pair(incoming_set_size, v));
+				thick_vars.push_back({v, gnd->second});
 			}
 		}
 		else ungrounded_vars.insert(v);
@@ -299,23 +365,23 @@ bool InitiateSearchMixin::get_next_thinnest_clause(const GroundingMap& var_groun
 	// the root is grounded.  If its not, start working on that.
 	Handle joint(Handle::UNDEFINED);
 	PatternTermPtr unsolved_clause(PatternTerm::UNDEFINED);
-	unsigned int thinnest_joint = UINT_MAX;
+	size_t thinnest_joint = SIZE_MAX;
+	size_t thinnest_width = 0;
 	unsigned int thinnest_clause = UINT_MAX;
 	bool unsolved = false;
 
 	// We are looking for a joining atom, one that is shared in common
 	// with the a fully grounded clause, and an as-yet ungrounded clause.
 	// The joint is called "pursue", and the unsolved clause that it
-	// joins will become our next untried clause. We choose joining atom
-	// with smallest size of its incoming set. If there are many such
-	// atoms we choose one from clauses with minimal number of ungrounded
-	// yet variables.
-	for (const auto& tckvar : thick_vars)
+	// joins will become our next untried clause. We choose the joint
+	// and clause that need the fewest links to be examined, as given
+	// by join_width(), and corrected by join_cost() for what has been
+	// seen so far. If there are many such, we choose the clause with
+	// the fewest as-yet ungrounded variables.
+	for (const HandlePair& tckvar : thick_vars)
 	{
-		std::size_t pursue_thickness = tckvar.first;
-		const Handle& pursue = tckvar.second;
-
-		if (pursue_thickness > thinnest_joint) break;
+		const Handle& pursue = tckvar.first;
+		const Handle& pgnd = tckvar.second;
 
 		const auto& root_list = _pattern->connectivity_map.equal_range(pursue);
 		for (auto it = root_list.first; it != root_list.second; it++)
@@ -325,11 +391,17 @@ bool InitiateSearchMixin::get_next_thinnest_clause(const GroundingMap& var_groun
 			     and (search_eval or not root->hasAnyEvaluatable())
 			     and (search_absents or not root->isAbsent()))
 			{
+				size_t width = join_width(pursue, pgnd, root);
+				size_t pursue_thickness = join_cost(root, width);
+				if (pursue_thickness > thinnest_joint) continue;
+
 				unsigned int root_thickness = thickness(root, ungrounded_vars);
-				if (root_thickness < thinnest_clause)
+				if (pursue_thickness < thinnest_joint or
+				    root_thickness < thinnest_clause)
 				{
 					thinnest_clause = root_thickness;
 					thinnest_joint = pursue_thickness;
+					thinnest_width = width;
 					unsolved_clause = root;
 					joint = pursue;
 					unsolved = true;
@@ -365,6 +437,14 @@ bool InitiateSearchMixin::get_next_thinnest_clause(const GroundingMap& var_groun
 	// Did not find anything.
 	if (not unsolved or PatternTerm::UNDEFINED == unsolved_clause) return false;
 
+	const auto& cc = _clause_costs.find(unsolved_clause.get());
+	if (_clause_costs.end() != cc)
+	{
+		cc->second.chosen.fetch_add(1, std::memory_order_relaxed);
+		cc->second.estimated.fetch_add(thinnest_width,
+		                               std::memory_order_relaxed);
+	}
+
 	// Return what we found.
 	if (unsolved_clause->isChoice())
 	{
@@ -24,21 +24,37 @@
 #ifndef _OPENCOG_PATTERN_MATCH_CALLBACK_H
 #define _OPENCOG_PATTERN_MATCH_CALLBACK_H
 
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <mutex>
 #include <set>
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/pattern/PatternLink.h>
 #include <opencog/atoms/pattern/PatternTerm.h> // for pattern context
+#include <opencog/query/SearchStats.h>
 
 namespace opencog {
 
+class ClauseCache;
+
 /**
  * Callback interface, used to implement specifics of hypergraph
  * matching, and also, to report solutions when found.
  */
 class PatternMatchCallback
 {
+	protected:
+		// Search limits; see search_halted().
+		std::chrono::steady_clock::time_point _deadline =
+			std::chrono::steady_clock::time_point::max();
+		std::atomic<bool> _truncated{false};
+		std::atomic<unsigned int> _halt_ticks{0};
+
+		// Search statistics; only gathered if set.
+		SearchStats* _stats = nullptr;
+
 	public:
 		virtual ~PatternMatchCallback() {};
 
@@ -241,6 +257,27 @@ class PatternMatchCallback
 		                                   const Handle& grnd,
 		                                   const GroundingMap& term_gnds) = 0;
 
+		/**
+		 * Called in place of the search for an optional clause, when
+		 * every variable in it is grounded already, and the clause is
+		 * plain structure: no evaluatables, globs, choices, quotes or
+		 * scopes in it. A search could then ground it only with the
+		 * clause itself, with the groundings filled in; so it is
+		 * enough to look for that.
+		 *
+		 * Return true if the lookup was made, with grnd set to what was
+		 * found, or left undefined, if nothing was. That is then handed
+		 * to optional_clause_match(), as if the search had found it.
+		 * Return false to have the search done as usual. That is the
+		 * default, as what counts as a match is up to the callback.
+		 */
+		virtual bool probe_optional_clause(const Handle& pattrn,
+		                                   const GroundingMap& term_gnds,
+		                                   Handle& grnd)
+		{
+			return false;
+		}
+
 		/**
 		 * Called when the search for a top-level for-all clause
 		 * has been completed. The clause may or may not have been
@@ -292,6 +329,18 @@ class PatternMatchCallback
 			return h->getIncomingSetByType(t);
 		}
 
+		/**
+		 * Same as above, but the result is placed into `iset`, which
+		 * the engine recycles, so that the innermost search loops do
+		 * not allocate. The default forwards to get_incoming_set();
+		 * callbacks that override one should override both.
+		 */
+		virtual void fill_incoming_set(const Handle& h, Type t,
+		                               IncomingSet& iset)
+		{
+			iset = get_incoming_set(h, t);
+		}
+
 		/**
 		 * Called whenever there is a need to verify that the given
 		 * Link(t, oset) appears in the incoming set of `hg`. That is,
@@ -304,9 +353,84 @@ class PatternMatchCallback
 		virtual Handle get_link(const Handle& hg,
 		                        Type t, HandleSeq&& oset) = 0;
 
+		/**
+		 * Called each time the engine walks up from a grounded term of
+		 * `clause`, with the number of Links in the incoming set that
+		 * it is about to try. This is the fan-out actually seen while
+		 * grounding the clause, at every depth; the clause order may
+		 * be revised with it. See InitiateSearchMixin::join_cost().
+		 */
+		virtual void note_branches(const PatternTermPtr& clause,
+		                           size_t nbranches) {}
+
 		virtual const TypeSet& get_connectives(void)
 		{ static const TypeSet _empty; return _empty; }
 
+		/**
+		 * Return the cache of clause groundings that is shared with
+		 * other searches, or nullptr, if there is none. Only clauses
+		 * that the engine would have cached anyway are looked up.
+		 * See ClauseCache for details.
+		 */
+		virtual ClauseCache* get_clause_cache(void) { return nullptr; }
+
+		/**
+		 * Return a new callback that searches exactly as this one
+		 * does, but has state of its own, so that the independent
+		 * branches of an OrLink, or the disconnected components of
+		 * a pattern, can be searched at the same time.
+		 * Its groundings are collected, and then passed on to this
+		 * callback, as usual. Return nullptr (the default) if the
+		 * branches must be searched one after another. This is only
+		 * used if USE_PARALLEL_DISJUNCTS is defined, below.
+		 */
+		virtual std::unique_ptr<PatternMatchCallback> branch_callback(void)
+		{ return nullptr; }
+
+		/**
+		 * Called from the inner loops of the engine: for each candidate
+		 * grounding of a term, each permutation of an unordered link,
+		 * each choice and each glob width that is tried. Return true to
+		 * abandon the search; the engine then unwinds, as if nothing
+		 * more could be found. This is called very often, and so must
+		 * be cheap.
+		 *
+		 * The default gives up once the deadline has passed, or once
+		 * truncate() was called, e.g. because `max_results` were found.
+		 * The clock is only read every so often.
+		 */
+		virtual bool search_halted(void)
+		{
+			if (_truncated.load(std::memory_order_relaxed)) return true;
+			if (std::chrono::steady_clock::time_point::max() == _deadline)
+				return false;
+			if (0 != (_halt_ticks.fetch_add(1, std::memory_order_relaxed) & 0x3f))
+				return false;
+			if (std::chrono::steady_clock::now() < _deadline) return false;
+			truncate();
+			return true;
+		}
+
+		/// Give up searching after the given amount of time.
+		void set_time_limit(std::chrono::steady_clock::duration d)
+		{ _deadline = std::chrono::steady_clock::now() + d; }
+
+		void set_deadline(std::chrono::steady_clock::time_point t)
+		{ _deadline = t; }
+
+		/// Stop the search, and record that the results are incomplete.
+		void truncate(void) { _truncated = true; }
+
+		/// Return true if the search stopped at a limit, so that there
+		/// may be results that were not reported.
+		bool is_truncated(void) const { return _truncated; }
+
+		/// Gather statistics about the search into `st`; pass null to
+		/// stop. Wrappers forward `get_stats()` to the callback they
+		/// wrap, so that all engines add to the same counters.
+		void set_stats(SearchStats* st) { _stats = st; }
+		virtual SearchStats* get_stats(void) { return _stats; }
+
 		/**
 		 * Called before when the search is started. This gives the system
 		 * a chance to perform needed intializations before the actual
@@ -391,9 +515,18 @@ class PatternMatchCallback
 };
 
 // See notes in `InitiateSearchMixin.cc` for an explanation of the
-// threading code and its status.
+// threading code and its status. Enabled with the top-level
+// THREADED_PATTERN_ENGINE CMake option.
 // #define USE_THREADED_PATTERN_ENGINE
 #ifdef USE_THREADED_PATTERN_ENGINE
+	// Search sets smaller than this are not worth the thread startup.
+	#ifndef PM_PARALLEL_MIN_SEARCH_SET
+	#define PM_PARALLEL_MIN_SEARCH_SET 256
+	#endif
+	// Number of search-set entries a worker thread takes at a time.
+	#ifndef PM_PARALLEL_CHUNK
+	#define PM_PARALLEL_CHUNK 16
+	#endif
 	#define DECLARE_PE_MUTEX std::mutex _mtx;
 	#define LOCK_PE_MUTEX std::lock_guard<std::mutex> lck(_mtx);
 #else
@@ -401,6 +534,18 @@ class PatternMatchCallback
 	#define LOCK_PE_MUTEX
 #endif // USE_THREADED_PATTERN_ENGINE
 
+// Search the branches of an OrLink, and the disconnected components of
+// a pattern, concurrently, one thread per branch, up to the number of
+// cores. See `SatisfyMixin::branch_search()`. Enabled with the top-level
+// PARALLEL_DISJUNCTS CMake option.
+// #define USE_PARALLEL_DISJUNCTS
+#ifdef USE_PARALLEL_DISJUNCTS
+	// OrLinks with fewer branches than this are searched serially.
+	#ifndef PM_PARALLEL_MIN_BRANCHES
+	#define PM_PARALLEL_MIN_BRANCHES 2
+	#endif
+#endif // USE_PARALLEL_DISJUNCTS
+
 } // namespace opencog
 
 #endif // _OPENCOG_PATTERN_MATCH_CALLBACK_H
@@ -29,6 +29,7 @@
 #include <opencog/atoms/core/FindUtils.h>
 #include <opencog/atomspace/AtomSpace.h>
 
+#include "ClauseCache.h"
 #include "PatternMatchEngine.h"
 
 using namespace opencog;
@@ -124,6 +125,31 @@ static inline void logmsg(const char*) {}
 
 /* ======================================================== */
 
+/// Charge the time spent exploring a clause to it, on the way out.
+/// Does nothing, unless statistics are being gathered.
+struct ClauseTimer
+{
+	SearchStats* _st;
+	const PatternTermPtr& _clause;
+	std::chrono::steady_clock::time_point _start;
+
+	ClauseTimer(SearchStats* st, const PatternTermPtr& clause)
+		: _st(st), _clause(clause)
+	{
+		if (nullptr == _st) return;
+		_st->clauses++;
+		_start = std::chrono::steady_clock::now();
+	}
+	~ClauseTimer()
+	{
+		if (nullptr == _st) return;
+		_st->add_clause(_clause->getHandle(),
+			std::chrono::steady_clock::now() - _start);
+	}
+};
+
+/* ======================================================== */
+
 /// Compare a VariableNode in the pattern to the proposed grounding.
 ///
 /// Handle hp is from the pattern clause.  By default, the code here
@@ -133,14 +159,15 @@ static inline void logmsg(const char*) {}
 /// entire clause. (The clause_match() callback, to be specific).
 ///
 bool PatternMatchEngine::variable_compare(const Handle& hp,
-                                          const Handle& hg)
+                                          const Handle& hg,
+                                          int slot)
 {
 	// If we already have a grounding for this variable, the new
 	// proposed grounding must match the existing one. Such multiple
 	// groundings can occur when traversing graphs with loops in them.
-	auto gnd = var_grounding.find(hp);
-	if (var_grounding.end() != gnd)
-		return (gnd->second == hg);
+	const Handle& gnd = find_grounding(hp, slot);
+	if (gnd)
+		return (gnd == hg);
 
 	// VariableNode had better be an actual node!
 	// If it's not then we are very very confused ...
@@ -152,7 +179,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 	// The variable_match() callback may implement some tighter
 	// variable check, e.g. to make sure that the grounding is
 	// of some certain type.
-	if (not _pmc.variable_match(hp, hg)) return false;
+	if (not _pmc->variable_match(hp, hg)) return false;
 
 	// Make a record of it. Cannot record GlobNodes here; they're
 	// variadic.
@@ -161,7 +188,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 		logmsg("Found grounding of variable:");
 		logmsg("$$ variable:", hp);
 		logmsg("$$ ground term:", hg);
-		var_grounding[hp] = hg;
+		set_grounding(var_grounding, hp, hg, slot);
 	}
 	return true;
 }
@@ -173,7 +200,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 bool PatternMatchEngine::self_compare(const PatternTermPtr& ptm)
 {
 	const Handle& hp = ptm->getHandle();
-	if (not ptm->isQuoted()) var_grounding[hp] = hp;
+	if (not ptm->isQuoted()) set_grounding(var_grounding, hp, hp);
 
 	logmsg("Compare atom to itself:", ptm->getQuote());
 	return true;
@@ -187,13 +214,13 @@ bool PatternMatchEngine::node_compare(const Handle& hp,
                                       const Handle& hg)
 {
 	// Call the callback to make the final determination.
-	bool match = _pmc.node_match(hp, hg);
+	bool match = _pmc->node_match(hp, hg);
 	if (match)
 	{
 		logmsg("Found matching nodes");
 		logmsg("# pattern:", hp);
 		logmsg("# match:", hg);
-		if (hp != hg) var_grounding[hp] = hg;
+		if (hp != hg) set_grounding(var_grounding, hp, hg);
 	}
 	return match;
 }
@@ -206,7 +233,6 @@ bool PatternMatchEngine::node_compare(const Handle& hp,
 bool PatternMatchEngine::ordered_compare(const PatternTermPtr& ptm,
                                          const Handle& hg)
 {
-	const PatternTermSeq& osp = ptm->getOutgoingSet();
 	const HandleSeq& osg = hg->getOutgoingSet();
 
 	// The recursion step: traverse down the tree.
@@ -220,23 +246,40 @@ bool PatternMatchEngine::ordered_compare(const PatternTermPtr& ptm,
 
 	bool match = true;
 	const Handle &hp = ptm->getHandle();
+	const FlatTerm* ft = ptm->getFlat();
 	if (ptm->hasGlobbyVar())
 	{
-		match = glob_compare(osp, osg);
+		match = glob_compare(ptm->getOutgoingSet(), osg);
 	}
 	else
 	{
 		size_t osg_size = osg.size();
-		size_t osp_size = osp.size();
+		size_t osp_size = ptm->getArity();
 
 		// If the arities are mis-matched, do a fuzzy compare instead.
 		if (osp_size != osg_size)
 		{
-			match = _pmc.fuzzy_match(ptm->getHandle(), hg);
+			match = _pmc->fuzzy_match(ptm->getHandle(), hg);
+		}
+		else if (ft)
+		{
+			// Side-by-side recursive compare, walking the flattened
+			// clause; the children follow one after the other.
+			const FlatTerm* sub = ft->first();
+			for (size_t i=0; i<osp_size; i++, sub = sub->next())
+			{
+				if (not tree_compare(sub->term, osg[i], CALL_ORDER))
+				{
+					match = false;
+					break;
+				}
+			}
 		}
 		else
 		{
-			// Side-by-side recursive compare.
+			// Terms made after the pattern was compiled have no
+			// flattened form; walk the tree.
+			const PatternTermSeq& osp = ptm->getOutgoingSet();
 			for (size_t i=0; i<osp_size; i++)
 			{
 				if (not tree_compare(osp[i], osg[i], CALL_ORDER))
@@ -253,13 +296,13 @@ bool PatternMatchEngine::ordered_compare(const PatternTermPtr& ptm,
 
 	if (not match)
 	{
-		_pmc.post_link_mismatch(hp, hg);
+		_pmc->post_link_mismatch(hp, hg);
 		return false;
 	}
 
 	// If we've found a grounding, lets see if the
 	// post-match callback likes this grounding.
-	match = _pmc.post_link_match(hp, hg);
+	match = _pmc->post_link_match(hp, hg);
 	if (not match) return false;
 
 	// If we've found a grounding, record it.
@@ -333,7 +376,7 @@ bool PatternMatchEngine::choice_compare(const PatternTermPtr& ptm,
 		_choose_next = false; // we are taking a step, so clear the flag.
 	}
 
-	while (icurr<iend)
+	while (icurr<iend and not _pmc->search_halted())
 	{
 		solution_push();
 		const PatternTermPtr& hop = osp[icurr];
@@ -351,7 +394,7 @@ bool PatternMatchEngine::choice_compare(const PatternTermPtr& ptm,
 		{
 			// If we've found a grounding, lets see if the
 			// post-match callback likes this grounding.
-			match = _pmc.post_link_match(hp, hg);
+			match = _pmc->post_link_match(hp, hg);
 			if (match)
 			{
 				// Even the stack, *without* erasing the discovered grounding.
@@ -366,7 +409,7 @@ bool PatternMatchEngine::choice_compare(const PatternTermPtr& ptm,
 		}
 		else
 		{
-			_pmc.post_link_mismatch(hp, hg);
+			_pmc->post_link_mismatch(hp, hg);
 		}
 		solution_pop();
 		_choose_next = false; // we are taking a step, so clear the flag.
@@ -399,7 +442,7 @@ bool PatternMatchEngine::have_choice(const PatternTermPtr& ptm,
 }
 
 /* ======================================================== */
-static int facto (int n) { return (n==1)? 1 : n * facto(n-1); };
+static int facto (int n) { return (n<=1)? 1 : n * facto(n-1); };
 
 /// Unordered link comparison
 ///
@@ -497,7 +540,19 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 	// They've got to be the same size, at the least!
 	// unless there are globs in the pattern
 	if (osg.size() != arity and not has_glob)
-		return _pmc.fuzzy_match(hp, hg);
+		return _pmc->fuzzy_match(hp, hg);
+
+	// Pair up the constants, and only permute what is left over.
+	// This also rejects most mismatches before any permuting is done.
+	PatternTermSeq pinned;
+	PatternTermSeq unpinned;
+	HandleSeq rest;
+	if (has_glob)
+		unpinned = osp;
+	else if (not unorder_pin(ptm, osg, pinned, unpinned, rest))
+		return _pmc->fuzzy_match(hp, hg);
+	const HandleSeq& osr(has_glob ? osg : rest);
+	size_t nfree = unpinned.size();
 
 	// Either we're going to take a step; or we aren't.
 	// If we're not taking a step, then there are unexplored
@@ -511,7 +566,7 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 	_perm_podo = _perm_odo;
 
 	// _perm_state lets use resume where we last left off.
-	Permutation mutation = curr_perm(ptm, hg);
+	Permutation mutation = curr_perm(ptm, unpinned);
 
 	// Likewise, pick up the odometer state where we last left off.
 	if (_perm_odo_state.find(ptm) != _perm_odo_state.end())
@@ -546,6 +601,7 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 		DO_LOG({LAZY_LOG_FINE << "tree_comp explore unordered perm "
 		              << _perm_count[ptm] +1 << " of " << num_perms
 		              << " of term=" << ptm->to_string();})
+		if (_stats) _stats->permutations++;
 
 		if (has_glob)
 		{
@@ -558,9 +614,17 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 		}
 		else
 		{
-			for (size_t i=0; i<arity; i++)
+			for (const PatternTermPtr& pin : pinned)
+			{
+				if (not tree_compare(pin, pin->getHandle(), CALL_UNORDER))
+				{
+					match = false;
+					break;
+				}
+			}
+			for (size_t i=0; match and i<nfree; i++)
 			{
-				if (not tree_compare(mutation[i], osg[i], CALL_UNORDER))
+				if (not tree_compare(mutation[i], osr[i], CALL_UNORDER))
 				{
 					match = false;
 					break;
@@ -593,7 +657,7 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 		{
 			// If we've found a grounding, lets see if the
 			// post-match callback likes this grounding.
-			match = _pmc.post_link_match(hp, hg);
+			match = _pmc->post_link_match(hp, hg);
 			if (match)
 			{
 				// Even the stack, *without* erasing the discovered grounding.
@@ -618,7 +682,7 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 		}
 		else
 		{
-			_pmc.post_link_mismatch(hp, hg);
+			_pmc->post_link_mismatch(hp, hg);
 		}
 
 		// Odometer code. If there are multiple unordered links,
@@ -703,7 +767,8 @@ take_next_step:
 			_perm_count[ptm] ++;
 #endif
 	} while (std::next_permutation(mutation.begin(), mutation.end(),
-	         std::less<PatternTermPtr>()));
+	         std::less<PatternTermPtr>()) and
+	         not _pmc->search_halted());
 
 	// If we are here, we've explored all the possibilities already
 	DO_LOG({LAZY_LOG_FINE << "Exhausted all permutations of term="
@@ -729,19 +794,67 @@ take_next_step:
 	return false;
 }
 
+/// Split the outgoing set of the unordered link `ptm` into the
+/// constant terms, which can only be grounded by themselves, and the
+/// rest, which must be permuted.  The constants are found in `osg`,
+/// and whatever is left is placed in `rest`. Return false if `osg`
+/// cannot possibly match: if it is missing one of the constants, or
+/// if it does not have enough links of the types of the unpinned link
+/// terms. This assumes that `node_match()` and `link_match()` are no
+/// more lenient than the defaults; see the notes in
+/// `InitiateSearchMixin.cc` on why that is already assumed.
+bool PatternMatchEngine::unorder_pin(const PatternTermPtr& ptm,
+                                     const HandleSeq& osg,
+                                     PatternTermSeq& pinned,
+                                     PatternTermSeq& unpinned,
+                                     HandleSeq& rest)
+{
+	rest = osg;
+	std::vector<Type> need;
+	for (const PatternTermPtr& sub : ptm->getOutgoingSet())
+	{
+		const Handle& h = sub->getHandle();
+		if (h->is_node() and not sub->isBoundVariable() and
+		    not sub->hasAnyEvaluatable() and
+		    (VARIABLE_NODE != h->get_type() or sub->isQuoted()))
+		{
+			auto it = std::find(rest.begin(), rest.end(), h);
+			if (rest.end() == it) return false;
+			rest.erase(it);
+			pinned.push_back(sub);
+			continue;
+		}
+
+		if (h->is_link() and not sub->isChoice())
+			need.push_back(h->get_type());
+		unpinned.push_back(sub);
+	}
+
+	if (need.empty()) return true;
+
+	std::vector<Type> have;
+	for (const Handle& h : rest)
+		if (h->is_link()) have.push_back(h->get_type());
+
+	std::sort(need.begin(), need.end());
+	std::sort(have.begin(), have.end());
+	return std::includes(have.begin(), have.end(), need.begin(), need.end());
+}
+
 /// Return the saved unordered-link permutation for this
 /// particular point in the tree comparison (i.e. for the
-/// particular unordered link hp in the pattern.)
+/// particular unordered link hp in the pattern.) A fresh
+/// permutation is made of the terms in `osp`.
 PatternMatchEngine::Permutation
 PatternMatchEngine::curr_perm(const PatternTermPtr& ptm,
-                              const Handle& hg)
+                              const PatternTermSeq& osp)
 {
 	auto ps = _perm_state.find(ptm);
 	if (_perm_state.end() == ps)
 	{
 		DO_LOG({LAZY_LOG_FINE << "tree_comp FRESH START unordered term="
 		              << ptm->to_string();})
-		Permutation perm = ptm->getOutgoingSet();
+		Permutation perm = osp;
 		// Sort into explicit std::less<PatternTermPtr>() order, as
 		// otherwise std::next_permutation() will miss some perms.
 		sort(perm.begin(), perm.end(), std::less<PatternTermPtr>());
@@ -828,6 +941,76 @@ bool PatternMatchEngine::glob_compare(const PatternTermSeq& osp,
 	GlobGrd glob_grd;
 	GlobPosStack glob_pos_stack;
 
+	// The fewest and the most atoms that osp[ip..] can take up, as
+	// allowed by the glob intervals. A partition that leaves too few,
+	// or too many atoms for the rest of the pattern cannot succeed.
+	std::vector<size_t> min_rest(osp_size+1, 0);
+	std::vector<size_t> max_rest(osp_size+1, 0);
+	size_t nglobs = 0;
+	bool memo_ok = true;
+	for (size_t k = osp_size; 0 < k; k--)
+	{
+		const PatternTermPtr& pt(osp[k-1]);
+		size_t lo = 1, hi = 1;
+		if (pt->isGlobbyVar())
+		{
+			const GlobInterval& gi(_variables->get_interval(pt->getHandle()));
+			lo = gi.first;
+			hi = gi.second;
+			nglobs++;
+		}
+		else if (pt->hasUnorderedLink() or pt->hasAnyEvaluatable() or
+		         contains_atomtype(pt->getHandle(), CHOICE_LINK))
+			memo_ok = false;
+
+		min_rest[k-1] = min_rest[k] + lo;
+		max_rest[k-1] = (SIZE_MAX - max_rest[k] < hi) ?
+			SIZE_MAX : max_rest[k] + hi;
+	}
+
+	// Sub-partitions that are known to fail. Once every way of
+	// grounding osp[ip..] to osg[jg..] has been tried, and failed, it
+	// will fail again, no matter how the earlier globs were grounded,
+	// provided that osp[..ip) and osp[ip..] have no variables in
+	// common. Without this, several globs in a row take exponential
+	// time. Terms that carry state of their own (permutations,
+	// choices) or have side effects are not memoized.
+	std::vector<bool> can_cut;
+	std::vector<bool> dead;
+	if (1 < nglobs and memo_ok)
+	{
+		can_cut.assign(osp_size+1, true);
+		std::map<Handle, std::pair<size_t, size_t>> span;
+		for (size_t k = 0; k < osp_size; k++)
+		{
+			HandleSet vars(unquoted_unscoped_in_tree(osp[k]->getHandle(),
+			                                         _variables->varset));
+			for (const Handle& v : vars)
+			{
+				auto sp = span.emplace(v, std::make_pair(k, k));
+				sp.first->second.second = k;
+			}
+		}
+		for (const auto& sp : span)
+			for (size_t c = sp.second.first + 1; c <= sp.second.second; c++)
+				can_cut[c] = false;
+
+		dead.assign((osp_size+1) * (osg_size+1), false);
+	}
+
+	auto is_dead = [&](size_t p, size_t g) -> bool
+	{
+		if (osg_size < g) return true;
+		size_t left = osg_size - g;
+		if (left < min_rest[p] or max_rest[p] < left) return true;
+		return not dead.empty() and dead[p * (osg_size+1) + g];
+	};
+
+	// Globs resumed from an earlier call skip the groundings that
+	// were already reported; their failure proves nothing. Only those
+	// above this depth on the stack were started afresh.
+	size_t resumed = 0;
+
 	// Common things that need to be done when backtracking.
 	bool backtracking = false;
 	bool cannot_backtrack_anymore = false;
@@ -840,12 +1023,21 @@ bool PatternMatchEngine::glob_compare(const PatternTermSeq& osp,
 		// previous one and try again.
 		if (is_glob)
 		{
+			// Every grounding of this glob, from where it started,
+			// has now been tried.
+			const GlobPos& gpos(glob_pos_stack.top());
+			size_t gp = gpos.second.first;
+			if (not dead.empty() and can_cut[gp] and
+			    resumed < glob_pos_stack.size())
+				dead[gp * (osg_size+1) + gpos.second.second] = true;
+
 			// Erase the grounding record of the glob before
 			// popping it out from the stack.
 			glob_grd.erase(glob_pos_stack.top().first);
 
 			glob_pos_stack.pop();
 			_glob_state[osp] = {glob_grd, glob_pos_stack};
+			resumed = std::min(resumed, glob_pos_stack.size());
 		}
 
 		// See where the previous glob is and try again
@@ -872,7 +1064,7 @@ bool PatternMatchEngine::glob_compare(const PatternTermSeq& osp,
 		_glob_state[osp] = {glob_grd, glob_pos_stack};
 
 		Handle glp(createLink(std::move(glob_seq), LIST_LINK));
-		var_grounding[glob->getHandle()] = glp;
+		set_grounding(var_grounding, glob->getHandle(), glp);
 
 		logmsg("Found grounding of glob:");
 		logmsg("$$ glob:", glob->getQuote());
@@ -899,6 +1091,7 @@ bool PatternMatchEngine::glob_compare(const PatternTermSeq& osp,
 		solution_pop();
 		glob_grd = r->second.first;
 		glob_pos_stack = r->second.second;
+		resumed = glob_pos_stack.size();
 		ip = glob_pos_stack.top().second.first;
 		jg = glob_pos_stack.top().second.second;
 	}
@@ -912,8 +1105,16 @@ bool PatternMatchEngine::glob_compare(const PatternTermSeq& osp,
 			break;
 		}
 
+		// Don't bother with what is known to fail.
+		if (not backtracking and is_dead(ip, jg))
+		{
+			backtrack(false);
+			continue;
+		}
+
 		if (osp[ip]->isGlobbyVar())
 		{
+			if (_stats) _stats->glob_states++;
 			HandleSeq glob_seq;
 			const PatternTermPtr& glob(osp[ip]);
 			const Handle& ohp(glob->getHandle());
@@ -1143,13 +1344,15 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
                                       const Handle& hg,
                                       Caller caller)
 {
+	if (_stats) _stats->tree_compares++;
 	const Handle& hp = ptm->getHandle();
 
 	// Do we already have a grounding for this? If we do, and the
 	// proposed grounding is the same as before, then there is
 	// nothing more to do.
-	auto gnd = var_grounding.find(hp);
-	if (gnd != var_grounding.end()) return (gnd->second == hg);
+	int slot = ptm->getVarSlot();
+	const Handle& gnd = find_grounding(hp, slot);
+	if (gnd) return (gnd == hg);
 
 	Type tp = hp->get_type();
 
@@ -1160,7 +1363,7 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
 		throw RuntimeException(TRACE_INFO, "Not implemented!!");
 
 	if (ptm->isBoundVariable())
-		return variable_compare(hp, hg);
+		return variable_compare(hp, hg, slot);
 
 	// If they're the same atom, then clearly they match....
 	// if it doesn't contain variables, and if it isn't evaluatable.
@@ -1180,7 +1383,7 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
 	// this. Right now, the scope_match() callback uses a rather
 	// screwy and indirect trick to check alpha conversion.
 	if (VARIABLE_NODE == tp and not ptm->isQuoted())
-		return _pmc.scope_match(hp, hg);
+		return _pmc->scope_match(hp, hg);
 
 	// If both are nodes, compare them as such.
 	if (hp->is_node() and hg->is_node())
@@ -1196,10 +1399,10 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
 		return choice_compare(ptm, hg);
 
 	// If they're not both links, then it is clearly a mismatch.
-	if (not (hp->is_link() and hg->is_link())) return _pmc.fuzzy_match(hp, hg);
+	if (not (hp->is_link() and hg->is_link())) return _pmc->fuzzy_match(hp, hg);
 
 	// Let the callback perform basic checking.
-	bool match = _pmc.link_match(ptm, hg);
+	bool match = _pmc->link_match(ptm, hg);
 	if (not match) return false;
 
 	logmsg("tree depth:", depth);
@@ -1207,8 +1410,10 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
 	logmsg("to:", hg);
 
 	// If the two links are both ordered, its enough to compare
-	// them "side-by-side".
-	if (2 > ptm->getArity() or not ptm->isUnorderedLink())
+	// them "side-by-side". The flattened clause saves a virtual call.
+	const FlatTerm* ft = ptm->getFlat();
+	bool unordered = ft ? ft->is(FlatTerm::UNORDERED) : ptm->isUnorderedLink();
+	if (2 > ptm->getArity() or not unordered)
 		return ordered_compare(ptm, hg);
 
 	// If we are here, we are dealing with an unordered link.
@@ -1333,7 +1538,7 @@ bool PatternMatchEngine::explore_upvar_branches(const PatternTermPtr& ptm,
 			// Yuck. What we really want to do here is to find out
 			// if `Link(t, oset)` is in the incoming set of `hg`. But
 			// there isn't any direct way of doing this (at this time).
-			Handle hup(_pmc.get_link(hg, t, std::move(oset)));
+			Handle hup(_pmc->get_link(hg, t, std::move(oset)));
 			if (nullptr == hup) return false;
 			return explore_type_branches(parent, hup, clause);
 		}
@@ -1353,8 +1558,13 @@ bool PatternMatchEngine::explore_upvar_branches(const PatternTermPtr& ptm,
 	// we have to explore the incoming set of the ground to see which
 	// (if any) of the incoming set satsisfies the parent term.
 
-	IncomingSet iset = _pmc.get_incoming_set(hg, t);
+	// The incoming set is copied into a recycled buffer, so that
+	// this, the innermost loop of the search, does not allocate.
+	IncomingScratch scratch;
+	IncomingSet& iset(scratch.get());
+	_pmc->fill_incoming_set(hg, t, iset);
 	size_t sz = iset.size();
+	_pmc->note_branches(clause, sz);
 	DO_LOG({LAZY_LOG_FINE << "Looking upward at term = "
 	                      << parent->getQuote()->to_string() << std::endl
 	                      << "The grounded pivot point " << hg->to_string()
@@ -1372,7 +1582,7 @@ bool PatternMatchEngine::explore_upvar_branches(const PatternTermPtr& ptm,
 			                      << " propose=" << iset[i]->to_string();})
 
 			found = explore_type_branches(parent, iset[i], clause);
-			if (found) break;
+			if (found or _pmc->search_halted()) break;
 		}
 
 		logmsg("Found upward soln =", found);
@@ -1398,7 +1608,7 @@ bool PatternMatchEngine::explore_upvar_branches(const PatternTermPtr& ptm,
 		found = explore_odometer(parent, iset[i], clause);
 		perm_pop();
 
-		if (found) break;
+		if (found or _pmc->search_halted()) break;
 	}
 	_perm_breakout = nullptr;
 
@@ -1416,18 +1626,28 @@ bool PatternMatchEngine::explore_upglob_branches(const PatternTermPtr& ptm,
 {
 	const PatternTermPtr& parent(ptm->getParent());
 	Type t = parent->getHandle()->get_type();
-	IncomingSet iset;
+	IncomingScratch scratch;
+	IncomingSet& iset(scratch.get());
 	if (nullptr == hg->getAtomSpace())
-		iset = _pmc.get_incoming_set(hg->getOutgoingAtom(0), t);
+		_pmc->fill_incoming_set(hg->getOutgoingAtom(0), t, iset);
 	else
-		iset = _pmc.get_incoming_set(hg, t);
+		_pmc->fill_incoming_set(hg, t, iset);
 
 	size_t sz = iset.size();
+	_pmc->note_branches(clause, sz);
 	DO_LOG({LAZY_LOG_FINE << "Looking globby upward for term = "
 	                      << parent->getQuote()->to_string() << std::endl
 	                      << "It's grounding " << hg->to_short_string()
 	                      << " has " << sz << " branches";})
 
+	// Before exploring the link branches, record the current
+	// _glob_state.  The idea is, if the parent & iset[i] is a match,
+	// their state will be recorded in _glob_state, so that one can,
+	// if needed, resume and try to ground those globs again in a
+	// different way (e.g. backtracking from another branchpoint).
+	// Every branch starts from the same state, so one copy will do.
+	const auto saved_glob_state = _glob_state;
+
 	// Move up the solution graph, looking for a match.
 	bool found = false;
 	for (size_t i = 0; i < sz; i++)
@@ -1436,19 +1656,12 @@ bool PatternMatchEngine::explore_upglob_branches(const PatternTermPtr& ptm,
 		                      << " for glob term=" << parent->to_string()
 		                      << " propose=" << iset[i]->id_to_string();})
 
-		// Before exploring the link branches, record the current
-		// _glob_state size.  The idea is, if the parent & iset[i] is a match,
-		// their state will be recorded in _glob_state, so that one can,
-		// if needed, resume and try to ground those globs again in a
-		// different way (e.g. backtracking from another branchpoint).
-		auto saved_glob_state = _glob_state;
-
 		found = explore_glob_branches(parent, iset[i], clause);
 
 		// Restore the saved state, for the next go-around.
 		_glob_state = saved_glob_state;
 
-		if (found) break;
+		if (found or _pmc->search_halted()) break;
 	}
 	logmsg("Found upward soln =", found);
 	return found;
@@ -1488,7 +1701,7 @@ bool PatternMatchEngine::explore_glob_branches(const PatternTermPtr& ptm,
 			return true;
 		logmsg("Globby clause not grounded; try again");
 	}
-	while (_glob_state.size() > gstate_size);
+	while (_glob_state.size() > gstate_size and not _pmc->search_halted());
 
 	return false;
 }
@@ -1515,6 +1728,14 @@ bool PatternMatchEngine::explore_odometer(const PatternTermPtr& ptm,
 		logmsg("ODO STEP unordered beneath term:", ptm);
 		if (explore_type_branches(ptm, hg, clause))
 			return true;
+
+		// Out of time; leave the odometer as if it had run down.
+		if (_pmc->search_halted())
+		{
+			_perm_take_step = false;
+			_perm_have_more = false;
+			break;
+		}
 	}
 	return false;
 }
@@ -1551,7 +1772,7 @@ bool PatternMatchEngine::explore_unordered_branches(const PatternTermPtr& ptm,
 		_perm_take_step = true;
 		_perm_have_more = false;
 	}
-	while (have_perm(ptm, hg));
+	while (have_perm(ptm, hg) and not _pmc->search_halted());
 
 	_perm_take_step = false;
 	_perm_have_more = false;
@@ -1635,7 +1856,7 @@ bool PatternMatchEngine::explore_choice_branches(const PatternTermPtr& ptm,
 		// If we are here, there was no match.
 		// On the next go-around, take a step.
 		_choose_next = true;
-	} while (have_choice(ptm, hg));
+	} while (have_choice(ptm, hg) and not _pmc->search_halted());
 
 	logmsg("Exhausted all choice possibilities"
 	       "\n----------------------------------");
@@ -1889,7 +2110,7 @@ bool PatternMatchEngine::do_term_up(const PatternTermPtr& ptm,
 		// been grounded!  If they're not, something is badly wrong!
 		logmsg("Term inside evaluatable, move up to it's top:",
 			       clause->getQuote());
-		bool found = _pmc.evaluate_sentence(clause->getHandle(), var_grounding);
+		bool found = _pmc->evaluate_sentence(clause->getHandle(), var_grounding);
 		logmsg("After evaluating clause, found = ", found);
 		if (found)
 			return clause_accept(clause, hg);
@@ -1946,7 +2167,7 @@ bool PatternMatchEngine::clause_accept(const PatternTermPtr& clause,
 	if (clause->isAbsent())
 	{
 		clause_accepted = true;
-		match = _pmc.optional_clause_match(clause_root, hg, var_grounding);
+		match = _pmc->optional_clause_match(clause_root, hg, var_grounding);
 		logmsg("Optional clause match callback match=", match);
 	}
 	else
@@ -1954,26 +2175,27 @@ bool PatternMatchEngine::clause_accept(const PatternTermPtr& clause,
 	{
 		_did_check_forall = true;
 		if (hg == clause_root) return false;
-		match = _pmc.always_clause_match(clause_root, hg, var_grounding);
+		match = _pmc->always_clause_match(clause_root, hg, var_grounding);
 		_forall_state = _forall_state and match;
 		logmsg("For-all clause match callback match=", match);
 	}
 	else
 	{
-		match = _pmc.clause_match(clause_root, hg, var_grounding);
+		match = _pmc->clause_match(clause_root, hg, var_grounding);
 		logmsg("clause match callback match=", match);
 	}
 	if (not match) return false;
+	if (_stats) _stats->accept_clause(clause->getHandle());
 
 	if (not clause->hasAnyEvaluatable())
 	{
-		clause_grounding[clause_root] = hg;
+		set_grounding(clause_grounding, clause_root, hg);
 
 		// Handle the highly unusual case of the top-most clause
 		// being a GlobNode. We were unable to record this earlier,
 		// in variable_compare(), so we do it here.
 		if (clause_root->get_type() == GLOB_NODE)
-			var_grounding[clause_root] = hg;
+			set_grounding(var_grounding, clause_root, hg);
 
 		logmsg("---------------------\nclause:", clause_root);
 		logmsg("ground:", hg);
@@ -2012,6 +2234,19 @@ bool PatternMatchEngine::clause_accept(const PatternTermPtr& clause,
 				OC_ASSERT(prev->second == hg, "Internal Error");
 #endif
 			_gnd_cache.insert({key, hg});
+
+			// Share it with later searches, too.
+			HandleSeq gnds;
+			const HandleSeq* canon = nullptr;
+			if (_clause_cache and not clause->isAbsent() and
+			    not clause->isAlways())
+				canon = shared_cache_key(clause->getHandle(), gnds);
+			// Stamped as of when the search for the clause began;
+			// Links added since may not have been seen.
+			const auto& cg = _cache_gens.find(clause.get());
+			if (canon and _cache_gens.end() != cg)
+				_clause_cache->insert(canon->at(0), gnds, typeid(*_pmc),
+				                      hg, cg->second);
 		}
 	}
 
@@ -2028,8 +2263,8 @@ bool PatternMatchEngine::do_next_clause(void)
 	PatternTermPtr joiner;
 
 	clause_stacks_push();
-	_pmc.next_connections(var_grounding);
-	bool have_more = _pmc.get_next_clause(do_clause, joiner);
+	_pmc->next_connections(var_grounding);
+	bool have_more = _pmc->get_next_clause(do_clause, joiner);
 
 	// If there are no further clauses to solve,
 	// we are really done! Report the solution via callback.
@@ -2052,7 +2287,9 @@ bool PatternMatchEngine::do_next_clause(void)
 			              << (do_clause->hasAnyEvaluatable()?
 			                  "dynamically evaluatable" : "non-dynamic");
 		logmsg("Joining variable is", joiner->getQuote());
-		logmsg("Joining grounding is", var_grounding[joiner->getQuote()]); })
+		auto jg = var_grounding.find(joiner->getQuote());
+		logmsg("Joining grounding is", var_grounding.end() == jg ?
+			Handle::UNDEFINED : jg->second); })
 
 		// Start solving the next unsolved clause. Note: this is a
 		// recursive call, and not a loop. Recursion is halted when
@@ -2064,18 +2301,21 @@ bool PatternMatchEngine::do_next_clause(void)
 
 		clause_stacks_push();
 		clause_accepted = false;
-		Handle hgnd(var_grounding[joiner->getHandle()]);
+		auto jgnd = var_grounding.find(joiner->getHandle());
+		Handle hgnd(var_grounding.end() == jgnd ?
+			Handle::UNDEFINED : jgnd->second);
 		if (nullptr == hgnd)
 		{
 			// Hack for clauses with no variables...
 			const Handle& j(joiner->getHandle());
-			var_grounding[j] = j;
+			set_grounding(var_grounding, j, j);
 			hgnd = j;
 		}
 		found |= explore_clause(joiner, hgnd, do_clause);
 		clause_stacks_pop();
 
-		if (not _pmc.get_next_clause(do_clause, joiner)) break;
+		if (_pmc->search_halted()) break;
+		if (not _pmc->get_next_clause(do_clause, joiner)) break;
 		logmsg("This was a multiple-choice clause; looping around.");
 	}
 
@@ -2089,23 +2329,25 @@ bool PatternMatchEngine::do_next_clause(void)
 	// Note that lack of a match halts recursion; thus, we can't
 	// depend on recursion to find additional unmatched optional
 	// clauses; thus we have to explicitly loop over all optional
-	// clauses that don't have matches.
+	// clauses that don't have matches. An abandoned search did not
+	// exhaust anything, and so proves nothing about them.
 	while ((false == found) and
 	       (false == clause_accepted) and
-	       (do_clause->isAbsent()))
+	       (do_clause->isAbsent()) and
+	       not _pmc->search_halted())
 	{
 		const Handle& curr_root(do_clause->getHandle());
 		static Handle undef(Handle::UNDEFINED);
-		bool match = _pmc.optional_clause_match(curr_root, undef, var_grounding);
+		bool match = _pmc->optional_clause_match(curr_root, undef, var_grounding);
 		logmsg("Exhausted search for optional clause, cb=", match);
 		if (not match) {
 			clause_stacks_pop();
 			return false;
 		}
 
-		clause_grounding[curr_root] = Handle::UNDEFINED;
-		_pmc.next_connections(var_grounding);
-		have_more = _pmc.get_next_clause(do_clause, joiner);
+		set_grounding(clause_grounding, curr_root, Handle::UNDEFINED);
+		_pmc->next_connections(var_grounding);
+		have_more = _pmc->get_next_clause(do_clause, joiner);
 		if (not have_more)
 		{
 			logmsg("==================== FINITO BANDITO!");
@@ -2121,9 +2363,12 @@ bool PatternMatchEngine::do_next_clause(void)
 		// or not. If it does, we'll recurse. If it does not,
 		// we'll loop around back to here again.
 		clause_accepted = false;
-		const Handle& hgnd(var_grounding[joiner->getHandle()]);
+		auto jgnd = var_grounding.find(joiner->getHandle());
+		Handle hgnd(var_grounding.end() == jgnd ?
+			Handle::UNDEFINED : jgnd->second);
 
-		found = explore_term_branches(joiner, hgnd, do_clause);
+		if (not probe_absent(do_clause, found))
+			found = explore_term_branches(joiner, hgnd, do_clause);
 	}
 
 	// If we failed to find anything at this level, we need to
@@ -2154,8 +2399,7 @@ void PatternMatchEngine::clause_stacks_push(void)
 	_clause_stack_depth++;
 	logmsg("--- CLAUSE stack push to depth=", _clause_stack_depth);
 
-	var_solutn_stack.push(var_grounding);
-	_clause_solutn_stack.push(clause_grounding);
+	undo_push();
 
 	choice_stack.push(_choice_state);
 
@@ -2172,7 +2416,7 @@ void PatternMatchEngine::clause_stacks_push(void)
 	_perm_podo.clear();
 	// _perm_odo_state.clear();
 
-	_pmc.push();
+	_pmc->push();
 }
 
 /**
@@ -2183,11 +2427,10 @@ void PatternMatchEngine::clause_stacks_push(void)
  */
 void PatternMatchEngine::clause_stacks_pop(void)
 {
-	_pmc.pop();
+	_pmc->pop();
 
 	// The grounding stacks are handled differently.
-	POPSTK(_clause_solutn_stack, clause_grounding);
-	POPSTK(var_solutn_stack, var_grounding);
+	undo_pop();
 
 	POPSTK(choice_stack, _choice_state);
 
@@ -2209,14 +2452,12 @@ void PatternMatchEngine::clause_stacks_clear(void)
 	_clause_stack_depth = 0;
 #if 0
 	// Currently, only GlobUTest fails when this is uncommented.
-	OC_ASSERT(0 == _clause_solutn_stack.size());
-	OC_ASSERT(0 == var_solutn_stack.size());
+	OC_ASSERT(0 == _undo_marks.size());
 	OC_ASSERT(0 == choice_stack.size());
 	OC_ASSERT(0 == _perm_stack.size());
 	OC_ASSERT(0 == _perm_stepper_stack.size());
 #else
-	while (!_clause_solutn_stack.empty()) _clause_solutn_stack.pop();
-	while (!var_solutn_stack.empty()) var_solutn_stack.pop();
+	undo_clear();
 	while (!choice_stack.empty()) choice_stack.pop();
 	while (!_perm_stack.empty()) _perm_stack.pop();
 	while (!_perm_stepper_stack.empty()) _perm_stepper_stack.pop();
@@ -2226,20 +2467,137 @@ void PatternMatchEngine::clause_stacks_clear(void)
 
 void PatternMatchEngine::solution_push(void)
 {
-	var_solutn_stack.push(var_grounding);
-	_clause_solutn_stack.push(clause_grounding);
+	undo_push();
 }
 
 void PatternMatchEngine::solution_pop(void)
 {
-	POPSTK(var_solutn_stack, var_grounding);
-	POPSTK(_clause_solutn_stack, clause_grounding);
+	undo_pop();
 }
 
 void PatternMatchEngine::solution_drop(void)
 {
-	var_solutn_stack.pop();
-	_clause_solutn_stack.pop();
+	undo_drop();
+}
+
+/* ======================================================== */
+/* Undo log for the grounding maps. */
+
+/// Set `key` to `val` in the grounding map, remembering what was
+/// there before, so that undo_pop() can put it back. If nothing has
+/// been pushed, there is nothing to go back to, and so nothing is
+/// remembered.
+void PatternMatchEngine::set_grounding(GroundingMap& map,
+                                       const Handle& key,
+                                       const Handle& val,
+                                       int slot)
+{
+	if (&map == &var_grounding)
+	{
+		if (not valid_slot(key, slot)) slot = var_slot(key);
+	}
+	else slot = -1;
+
+	auto it = map.find(key);
+	if (map.end() == it)
+	{
+		it = map.emplace(key, val).first;
+		if (not _undo_marks.empty())
+			_undo_log.push_back({&map, it, Handle::UNDEFINED, slot, false});
+	}
+	else if (it->second != val)
+	{
+		// The old grounding is moved into the log, not copied.
+		if (not _undo_marks.empty())
+			_undo_log.push_back({&map, it, std::move(it->second), slot, true});
+		it->second = val;
+	}
+
+	// Keep the flat array of variable groundings in sync.
+	if (0 <= slot) _var_gnd[slot] = &it->second;
+}
+
+/// Return the slot of the variable in the flat array, or -1 if `h`
+/// is not one of the bound variables of the pattern.
+int PatternMatchEngine::var_slot(const Handle& h) const
+{
+	// Only nodes can be variables; don't bother searching for links.
+	if (_var_gnd.empty() or not h->is_node()) return -1;
+	int slot = _variables->find_slot(h);
+	if (_var_gnd.size() <= (size_t) slot) return -1;
+	return slot;
+}
+
+/// Return true if `slot` is the place of the variable `h` in the
+/// flat array. The check is cheap, and guards against being handed
+/// a PatternTerm that was numbered against some other declaration.
+bool PatternMatchEngine::valid_slot(const Handle& h, int slot) const
+{
+	if (0 > slot or _var_gnd.size() <= (size_t) slot) return false;
+	const Handle& v = _variables->varseq[slot];
+	return v == h or *v == *h;
+}
+
+/// Return the grounding of the pattern `hp`, or the undefined handle,
+/// if it is not (yet) grounded. If `hp` is a bound variable, `slot`
+/// may give its place in the flat array, to avoid searching the map.
+const Handle& PatternMatchEngine::find_grounding(const Handle& hp,
+                                                 int slot) const
+{
+	if (valid_slot(hp, slot))
+	{
+		const Handle* gnd = _var_gnd[slot];
+		return gnd ? *gnd : Handle::UNDEFINED;
+	}
+
+	auto gnd = var_grounding.find(hp);
+	if (var_grounding.end() == gnd) return Handle::UNDEFINED;
+	return gnd->second;
+}
+
+void PatternMatchEngine::undo_push(void)
+{
+	_undo_marks.push_back(_undo_log.size());
+}
+
+/// Revert all grounding changes made since the matching undo_push().
+void PatternMatchEngine::undo_pop(void)
+{
+#ifdef QDEBUG
+	OC_ASSERT(not _undo_marks.empty(), "Unbalanced undo log");
+#endif
+	size_t mark = _undo_marks.back();
+	_undo_marks.pop_back();
+
+	while (mark < _undo_log.size())
+	{
+		Undo& u = _undo_log.back();
+		if (u.had)
+		{
+			u.it->second = std::move(u.old);
+			if (0 <= u.slot) _var_gnd[u.slot] = &u.it->second;
+		}
+		else
+		{
+			u.map->erase(u.it);
+			if (0 <= u.slot) _var_gnd[u.slot] = nullptr;
+		}
+		_undo_log.pop_back();
+	}
+}
+
+/// Keep all grounding changes made since the matching undo_push().
+/// They remain in the log, so that an enclosing pop still undoes them.
+void PatternMatchEngine::undo_drop(void)
+{
+	_undo_marks.pop_back();
+	if (_undo_marks.empty()) _undo_log.clear();
+}
+
+void PatternMatchEngine::undo_clear(void)
+{
+	_undo_log.clear();
+	_undo_marks.clear();
 }
 
 /* ======================================================== */
@@ -2250,10 +2608,12 @@ void PatternMatchEngine::solution_drop(void)
 bool PatternMatchEngine::report_grounding(const GroundingMap &var_soln,
                                           const GroundingMap &term_soln)
 {
+	if (_stats) _stats->groundings++;
+
 	// If there is no for-all clause (no AlwaysLink clause)
 	// then report groundings as they are found.
 	if (_pat->always.size() == 0)
-		return _pmc.grounding(var_soln, term_soln);
+		return _pmc->grounding(var_soln, term_soln);
 
 	// Don't even bother caching, if we know we are losing.
 	if (not _forall_state) return false;
@@ -2272,15 +2632,16 @@ bool PatternMatchEngine::report_forall(void)
 	// Nothing to do.
 	if (_pat->always.size() == 0) return false;
 
-	// If its OK to report, then report them now.
+	// If its OK to report, then report them now. A search that was
+	// cut short has not checked them all.
 	bool halt = false;
-	if (_forall_state)
+	if (_forall_state and not _pmc->search_halted())
 	{
 		size_t nitems = _var_ground_cache.size();
 		OC_ASSERT(_term_ground_cache.size() == nitems);
 		for (size_t i=0; i<nitems; i++)
 		{
-			halt = _pmc.grounding(_var_ground_cache[i],
+			halt = _pmc->grounding(_var_ground_cache[i],
 			                      _term_ground_cache[i]);
 			if (halt) break;
 		}
@@ -2322,10 +2683,18 @@ bool PatternMatchEngine::explore_neighborhood(const PatternTermPtr& term,
                                               const Handle& grnd,
                                               const PatternTermPtr& clause)
 {
+	if (_pmc->search_halted()) return false;
+	if (_stats) _stats->neighborhoods++;
+
 	clause_stacks_clear();
 	clear_current_state();
 	_nack_cache.clear();
 
+	// The starting clause is not looked up; stamp it here.
+	_cache_gens.clear();
+	if (_clause_cache)
+		_cache_gens[clause.get()] = _clause_cache->stamp(clause->getHandle());
+
 	bool halt = explore_clause(term, grnd, clause);
 	bool stop = report_forall();
 	return halt or stop;
@@ -2346,6 +2715,29 @@ bool PatternMatchEngine::is_clause_grounded(const PatternTermPtr& clause) const
 	return true;
 }
 
+/// An absent clause that is plain structure, and has every variable
+/// in it grounded already, can only be grounded by itself, with the
+/// groundings filled in. So, instead of searching for it, just look
+/// for that, if the callback knows how. Returns true if it did; then
+/// `found` is what the search would have returned.
+bool PatternMatchEngine::probe_absent(const PatternTermPtr& clause,
+                                      bool& found)
+{
+	if (not clause->isAbsent()) return false;
+	const Handle& root(clause->getHandle());
+	if (_pat->probeable_absents.end() == _pat->probeable_absents.find(root))
+		return false;
+	if (not is_clause_grounded(clause)) return false;
+
+	Handle hg;
+	if (not _pmc->probe_optional_clause(root, var_grounding, hg))
+		return false;
+
+	logmsg("Probed for absent clause, found:", hg);
+	found = (nullptr != hg) and clause_accept(clause, hg);
+	return true;
+}
+
 /// Return a lookup key for this clause.
 /// The `varseq` should be the variables in this clause
 /// as recorded in `_pat->clause_variables.find(clause)`
@@ -2364,6 +2756,27 @@ HandleSeq PatternMatchEngine::clause_grounding_key(const Handle& clause,
 	return key;
 }
 
+/// Return the canonical form of the clause, if it has one, and
+/// place the groundings of its variables, in canonical order, into
+/// `gnds`. Return nullptr if not all of them are grounded.
+/// See make_canonical_clauses() in PatternLink.cc.
+const HandleSeq* PatternMatchEngine::shared_cache_key(const Handle& clause,
+                                                      HandleSeq& gnds) const
+{
+	const auto& cc = _pat->canonical_clauses.find(clause);
+	if (_pat->canonical_clauses.end() == cc) return nullptr;
+
+	const HandleSeq& cseq = cc->second;
+	gnds.clear();
+	for (size_t i = 1; i < cseq.size(); i++)
+	{
+		const auto& gv = var_grounding.find(cseq[i]);
+		if (var_grounding.end() == gv) return nullptr;
+		gnds.push_back(gv->second);
+	}
+	return &cseq;
+}
+
 /**
  * Every clause in a pattern is one of two types:  it either
  * specifies a pattern to be matched, or it specifies an evaluatable
@@ -2392,7 +2805,7 @@ bool PatternMatchEngine::explore_clause_direct(const PatternTermPtr& term,
 		// We need to record failures for the AlwaysLink
 		Handle empty;
 		_forall_state = _forall_state and
-			_pmc.always_clause_match(clause->getHandle(), empty, var_grounding);
+			_pmc->always_clause_match(clause->getHandle(), empty, var_grounding);
 	}
 
 	return found;
@@ -2409,12 +2822,12 @@ bool PatternMatchEngine::explore_clause_evaluatable(const PatternTermPtr& term,
 	// happy, and record the suggested grounding. There's nowhere
 	// else to do this, so we do it here.
 	if (term->isBoundVariable() or term->isGlobbyVar())
-		var_grounding[term->getHandle()] = grnd;
+		set_grounding(var_grounding, term->getHandle(), grnd);
 
 	// All variables in the clause had better be grounded!
 	OC_ASSERT(is_clause_grounded(clause), "Internal error!");
 
-	bool found = _pmc.evaluate_sentence(clause->getHandle(), var_grounding);
+	bool found = _pmc->evaluate_sentence(clause->getHandle(), var_grounding);
 	logmsg("Post evaluating clause, found = ", found);
 	if (found)
 	{
@@ -2425,7 +2838,7 @@ bool PatternMatchEngine::explore_clause_evaluatable(const PatternTermPtr& term,
 		// We need to record failures for the AlwaysLink
 		Handle empty;
 		_forall_state = _forall_state and
-			_pmc.always_clause_match(clause->getHandle(), empty, var_grounding);
+			_pmc->always_clause_match(clause->getHandle(), empty, var_grounding);
 	}
 
 	return false;
@@ -2562,6 +2975,12 @@ bool PatternMatchEngine::explore_clause(const PatternTermPtr& term,
                                         const Handle& grnd,
                                         const PatternTermPtr& pclause)
 {
+	ClauseTimer timer(_stats, pclause);
+
+	// There's nothing to search for, if it is enough to look.
+	bool found;
+	if (probe_absent(pclause, found)) return found;
+
 	// The two sides of an identity can be equated directly.
 	if (pclause->isIdentical())
 		return explore_clause_identical(term, grnd, pclause);
@@ -2600,22 +3019,8 @@ bool PatternMatchEngine::explore_clause(const PatternTermPtr& term,
 	const auto& cac = _gnd_cache.find(key);
 	if (cac != _gnd_cache.end())
 	{
-		logmsg("Cache hit!");
-
-		// Record the clause grounding.
-		var_grounding[clause] = cac->second;
-
-		// Copy variable groundings, which were stored in the key.
-		// Usually, this is not needed; however, if the variable
-		// is in the outgoing set of the clause, then the grounding
-		// won't have been recorded yet, and so we have to do it here.
-		// Tested by `CacheHitUTest`.
-		const HandleSeq& clvars(_pat->clause_variables.at(pclause));
-		size_t cvsz = clvars.size();
-		for (size_t iv=0; iv<cvsz; iv++)
-			var_grounding[clvars[iv]] = key[iv+1];
-
-		return do_next_clause();
+		if (_stats) _stats->cache_hits++;
+		return explore_cached_clause(pclause, key, cac->second);
 	}
 
 	// Do we have a negative cache? If so, it will always fail.
@@ -2623,15 +3028,97 @@ bool PatternMatchEngine::explore_clause(const PatternTermPtr& term,
 	if (nac != _nack_cache.end())
 	{
 		logmsg("NAC Cache hit!", key);
+		if (_stats) _stats->cache_hits++;
 		return false;
 	}
 
+	// Perhaps an earlier search already grounded this clause.
+	HandleSeq gnds;
+	const HandleSeq* canon = nullptr;
+	if (_clause_cache)
+	{
+		if (_pat->cacheable_clauses.find(clause) != _pat->cacheable_clauses.end())
+		{
+			// The variable is not grounded yet; it will be `grnd`.
+			// Entries are made only once the variable has passed the
+			// type checks, and so we have to check, too.
+			const auto& cc = _pat->canonical_clauses.find(clause);
+			if (_pat->canonical_clauses.end() != cc and 2 == cc->second.size())
+			{
+				if (not _pmc->variable_match(cc->second[1], grnd))
+					return false;
+				canon = &cc->second;
+				gnds.push_back(grnd);
+			}
+		}
+		else
+			canon = shared_cache_key(clause, gnds);
+	}
+
+	Handle shared;
+	uint64_t gen = 0;
+	if (canon and
+	    _clause_cache->lookup(canon->at(0), gnds, typeid(*_pmc), shared, gen))
+	{
+		if (nullptr == shared)
+		{
+			logmsg("Shared NAC Cache hit!", key);
+			if (_stats) _stats->cache_hits++;
+			_nack_cache.insert(key);
+			return false;
+		}
+
+		// The callback gets the last word, as always.
+		if (_pmc->clause_match(pclause->getQuote(), shared, var_grounding))
+		{
+			logmsg("Shared cache hit!");
+			if (_stats) _stats->cache_hits++;
+			_gnd_cache.insert({key, shared});
+			return explore_cached_clause(pclause, key, shared);
+		}
+	}
+
+	// An abandoned search is not a failure, and must not be cached.
+	if (_stats) _stats->cache_misses++;
+	if (canon) _cache_gens[pclause.get()] = gen;
 	bool okay = explore_clause_direct(term, grnd, pclause);
-	if (not okay)
+	if (not okay and not _pmc->search_halted())
+	{
 		_nack_cache.insert(key);
+
+		// A failure means no more than that the rest of this search
+		// failed, unless the clause itself was never grounded.
+		if (canon and _gnd_cache.end() == _gnd_cache.find(key))
+			_clause_cache->insert(canon->at(0), gnds, typeid(*_pmc),
+			                      Handle::UNDEFINED, gen);
+	}
 	return okay;
 }
 
+/// Use a grounding for the clause that was found before, and move on
+/// to the next clause.
+bool PatternMatchEngine::explore_cached_clause(const PatternTermPtr& pclause,
+                                               const HandleSeq& key,
+                                               const Handle& hg)
+{
+	logmsg("Cache hit!");
+
+	// Record the clause grounding.
+	set_grounding(var_grounding, pclause->getHandle(), hg);
+
+	// Copy variable groundings, which were stored in the key.
+	// Usually, this is not needed; however, if the variable
+	// is in the outgoing set of the clause, then the grounding
+	// won't have been recorded yet, and so we have to do it here.
+	// Tested by `CacheHitUTest`.
+	const HandleSeq& clvars(_pat->clause_variables.at(pclause));
+	size_t cvsz = clvars.size();
+	for (size_t iv=0; iv<cvsz; iv++)
+		set_grounding(var_grounding, clvars[iv], key[iv+1]);
+
+	return do_next_clause();
+}
+
 void PatternMatchEngine::record_grounding(const PatternTermPtr& ptm,
                                           const Handle& hg)
 {
@@ -2647,11 +3134,11 @@ void PatternMatchEngine::record_grounding(const PatternTermPtr& ptm,
 	// Otherwise, just record the raw grounding.
 	// Tested in UnorderedUTest::test_quote() and elsewhere.
 	if (not ptm->isQuoted())
-		var_grounding[hp] = hg;
+		set_grounding(var_grounding, hp, hg);
 	else if (const Handle& quote = ptm->getQuote())
-		var_grounding[quote] = hg;
+		set_grounding(var_grounding, quote, hg);
 	else
-		var_grounding[hp] = hg;
+		set_grounding(var_grounding, hp, hg);
 }
 
 /**
@@ -2663,6 +3150,8 @@ void PatternMatchEngine::clear_current_state(void)
 	// Clear all state.
 	var_grounding.clear();
 	clause_grounding.clear();
+	undo_clear();
+	_var_gnd.assign(_variables ? _variables->varseq.size() : 0, nullptr);
 
 	depth = 0;
 
@@ -2693,7 +3182,7 @@ bool PatternMatchEngine::explore_constant_evaluatables(const PatternTermSeq& cla
 	{
 		if (clause->hasAnyEvaluatable())
 		{
-			found = _pmc.evaluate_sentence(clause->getHandle(), GroundingMap());
+			found = _pmc->evaluate_sentence(clause->getHandle(), GroundingMap());
 			if (not found)
 				break;
 		}
@@ -2705,12 +3194,15 @@ bool PatternMatchEngine::explore_constant_evaluatables(const PatternTermSeq& cla
 }
 
 PatternMatchEngine::PatternMatchEngine(PatternMatchCallback& pmcb)
-	: _pmc(pmcb),
+	: _pmc(&pmcb),
 	_nameserver(nameserver()),
 	_variables(nullptr),
 	_pat(nullptr),
 	clause_accepted(false)
 {
+	_clause_cache = _pmc->get_clause_cache();
+	_stats = _pmc->get_stats();
+
 	// current state
 	depth = 0;
 
@@ -2732,6 +3224,41 @@ PatternMatchEngine::PatternMatchEngine(PatternMatchCallback& pmcb)
 	_perm_odo_state.clear();
 }
 
+/// Make this engine ready for another search, possibly for another
+/// pattern, and on behalf of another callback. Everything left over
+/// from the last search is cleared, but the containers keep whatever
+/// memory they had already grown into, so that a reused engine does
+/// not have to allocate it all over again.
+void PatternMatchEngine::reset(PatternMatchCallback& pmcb)
+{
+	_pmc = &pmcb;
+	_clause_cache = _pmc->get_clause_cache();
+	_stats = _pmc->get_stats();
+
+	_variables = nullptr;
+	_pat = nullptr;
+	while (not _stack_variables.empty()) _stack_variables.pop();
+	while (not _stack_pattern.empty()) _stack_pattern.pop();
+
+	clause_stacks_clear();
+	clear_current_state();
+	while (not _perm_take_stack.empty()) _perm_take_stack.pop();
+	while (not _perm_more_stack.empty()) _perm_more_stack.pop();
+	while (not _perm_breakout_stack.empty()) _perm_breakout_stack.pop();
+	while (not _perm_odo_stack.empty()) _perm_odo_stack.pop();
+	while (not _perm_count_stack.empty()) _perm_count_stack.pop();
+	_perm_count.clear();
+
+	issued_present.clear();
+	_gnd_cache.clear();
+	_nack_cache.clear();
+	_cache_gens.clear();
+	_var_ground_cache.clear();
+	_term_ground_cache.clear();
+	_forall_state = true;
+	clause_accepted = false;
+}
+
 void PatternMatchEngine::set_pattern(const Variables& v,
                                      const Pattern& p)
 {
@@ -39,7 +39,7 @@ class PatternMatchEngine
 {
 	// -------------------------------------------
 	// Callback to whom the results are reported.
-	PatternMatchCallback &_pmc;
+	PatternMatchCallback* _pmc;
 	NameServer& _nameserver;
 
 	// Private, locally scoped typedefs, not used outside of this class.
@@ -73,6 +73,24 @@ private:
 	// Also contains grounds of subclauses (not sure why, this seems
 	// to be needed)
 	GroundingMap var_grounding;
+
+	// The groundings of the bound variables, again, but indexed by
+	// PatternTerm::getVarSlot(). This is kept in sync with
+	// var_grounding by set_grounding(), and is used for the lookups
+	// in the inner loops of the compare routines, which would
+	// otherwise have to search the map. The map is still needed,
+	// as that is what is handed to the callbacks.
+	//
+	// These are borrowed: they point at the groundings held in the
+	// map, so that keeping the two in sync does not touch reference
+	// counts. A std::map does not move its entries, and the entries
+	// are erased only by undo_pop(), which nulls the pointer. Null
+	// means not grounded.
+	std::vector<const Handle*> _var_gnd;
+	const Handle& find_grounding(const Handle&, int slot) const;
+	int var_slot(const Handle&) const;
+	bool valid_slot(const Handle&, int slot) const;
+
 	// Map of clauses to their current groundings
 	GroundingMap clause_grounding;
 
@@ -113,7 +131,9 @@ private:
 	typedef std::map<PatternTermPtr, PermOdo> PermOdoState;
 
 	PermState _perm_state;
-	Permutation curr_perm(const PatternTermPtr&, const Handle&);
+	Permutation curr_perm(const PatternTermPtr&, const PatternTermSeq&);
+	bool unorder_pin(const PatternTermPtr&, const HandleSeq&,
+	                 PatternTermSeq&, PatternTermSeq&, HandleSeq&);
 	bool have_perm(const PatternTermPtr&, const Handle&);
 
 	// Iteration control for unordered links. Branchpoint advances
@@ -181,6 +201,7 @@ private:
 	// -------------------------------------------
 	// Methods that help avoid pointless searches
 	bool is_clause_grounded(const PatternTermPtr&) const;
+	bool probe_absent(const PatternTermPtr&, bool&);
 	HandleSeq clause_grounding_key(const Handle&,
 	                               const HandleSeq&) const;
 
@@ -188,6 +209,17 @@ private:
 	std::unordered_map<HandleSeq, Handle> _gnd_cache;
 	std::unordered_set<HandleSeq> _nack_cache;
 
+	// Clause groundings shared with other searches, if any, and the
+	// ClauseCache::stamp() of each clause, taken as its search began.
+	ClauseCache* _clause_cache;
+	std::unordered_map<const PatternTerm*, uint64_t> _cache_gens;
+	const HandleSeq* shared_cache_key(const Handle&, HandleSeq&) const;
+
+	// Search statistics, if they are being gathered.
+	SearchStats* _stats;
+	bool explore_cached_clause(const PatternTermPtr&,
+	                           const HandleSeq&, const Handle&);
+
 	// -------------------------------------------
 	// Stack used to store current traversal state for a single
 	// clause. These are pushed when a clause is fully grounded,
@@ -198,9 +230,35 @@ private:
 	void solution_pop(void);
 	void solution_drop(void);
 
-	// Stacks containing partial groundings.
-	std::stack<GroundingMap> var_solutn_stack;
-	std::stack<GroundingMap> _clause_solutn_stack;
+	// Partial groundings are not copied onto a stack; instead, every
+	// change made to var_grounding or clause_grounding is recorded in
+	// an undo log, and a push just marks the current end of the log.
+	// A pop replays the log backwards, down to the mark. This makes
+	// the cost of backtracking proportional to the number of
+	// groundings made since the push, instead of the size of the maps.
+	//
+	// The entry is named by its iterator, and not by a copy of its
+	// key; a std::map keeps iterators valid until the entry is erased,
+	// and entries are erased only by undo_pop(), in the reverse of
+	// the order that they were made in.
+	struct Undo
+	{
+		GroundingMap* map;
+		GroundingMap::iterator it;
+		Handle old;
+		int slot;
+		bool had;
+	};
+	std::vector<Undo> _undo_log;
+	std::vector<size_t> _undo_marks;
+
+	// All changes to the grounding maps must go through here.
+	void set_grounding(GroundingMap&, const Handle&, const Handle&,
+	                   int slot = -1);
+	void undo_push(void);
+	void undo_pop(void);
+	void undo_drop(void);
+	void undo_clear(void);
 
 	std::stack<ChoiceState> choice_stack;
 
@@ -238,7 +296,7 @@ private:
 
 	bool tree_compare(const PatternTermPtr&, const Handle&, Caller);
 
-	bool variable_compare(const Handle&, const Handle&);
+	bool variable_compare(const Handle&, const Handle&, int slot);
 	bool self_compare(const PatternTermPtr&);
 	bool node_compare(const Handle&, const Handle&);
 	bool present_compare(const PatternTermPtr&, const Handle&);
@@ -288,6 +346,13 @@ public:
 	PatternMatchEngine(PatternMatchCallback&);
 	void set_pattern(const Variables&, const Pattern&);
 
+	// An engine holds the state of one search, and so can only be
+	// used by one thread at a time. It is not tied to the search,
+	// though: once done, it can be reset, and used again, e.g. by
+	// way of the pool in InitiateSearchMixin. Threaded searches take
+	// one engine per worker.
+	void reset(PatternMatchCallback&);
+
 	// Examine the locally connected neighborhood for possible
 	// matches.
 	bool explore_neighborhood(const PatternTermPtr&, const Handle&,
@@ -0,0 +1,251 @@
+/*
+ * QueryStream.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/atom_types/NameServer.h>
+#include <opencog/atoms/pattern/QueryLink.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "Implicator.h"
+#include "QueryStream.h"
+#include "Satisfier.h"
+
+namespace opencog
+{
+
+/// The usual callbacks, except that, after each result, the search
+/// waits until the consumer has made room for more.
+template<class CB>
+class Throttled : public CB
+{
+	QueryStream* _qs;
+
+public:
+	Throttled(AtomSpace* as, QueryStream* qs) : CB(as), _qs(qs) {}
+
+	virtual bool start_search(void)
+	{
+		bool done = CB::start_search();
+		_qs->attach(CB::get_result_queue());
+		return done;
+	}
+
+	virtual bool grounding(const GroundingMap& var_soln,
+	                       const GroundingMap& term_soln)
+	{
+		bool done = CB::grounding(var_soln, term_soln);
+		_qs->made_result();
+		if (done) return true;
+		return _qs->wait_for_room();
+	}
+};
+
+}
+
+using namespace opencog;
+
+// ==============================================================
+
+QueryStream::QueryStream(AtomSpace* as, const Handle& query,
+                         size_t capacity) :
+	LinkStreamValue(QUERY_STREAM), _query(query), _as(as),
+	_capacity(capacity), _done(false), _cancel(false)
+{
+	if (nullptr == _as) _as = query->getAtomSpace();
+	if (nullptr == _as)
+		throw InvalidParamException(TRACE_INFO,
+			"QueryStream: expecting an AtomSpace to search");
+	if (0 == _capacity) _capacity = 1;
+
+	Type t = query->get_type();
+	if (nameserver().isA(t, QUERY_LINK))
+	{
+		Throttled<Implicator>* impl = new Throttled<Implicator>(_as, this);
+		impl->implicand = QueryLinkCast(query)->get_implicand();
+		_cb.reset(impl);
+	}
+	else if (nameserver().isA(t, MEET_LINK))
+		_cb.reset(new Throttled<SatisfyingSet>(_as, this));
+	else
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a MeetLink or a QueryLink, got %s",
+			query->to_short_string().c_str());
+
+	_producer = std::thread(&QueryStream::run, this);
+}
+
+QueryStream::~QueryStream()
+{
+	cancel();
+	_producer.join();
+}
+
+void QueryStream::run(void)
+{
+	try
+	{
+		_cb->satisfy(PatternLinkCast(_query));
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_error = std::current_exception();
+	}
+
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_done = true;
+		if (_queue) _queue->close();
+	}
+	_cv.notify_all();
+}
+
+void QueryStream::cancel(void)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_cancel = true;
+	}
+	_cv.notify_all();
+}
+
+// ==============================================================
+// Producer side.
+
+void QueryStream::attach(const QueueValuePtr& qv)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_queue = qv;
+	}
+	_cv.notify_all();
+}
+
+/// Wake up the consumer. As in made_room(), the lock is taken, so that
+/// the wake-up cannot slip in between its check for a result, and its
+/// wait.
+void QueryStream::made_result(void) const
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+	}
+	_cv.notify_all();
+}
+
+/// Block until there is room for another result. Return true if the
+/// search should stop.
+bool QueryStream::wait_for_room(void)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	_cv.wait(lck, [&] {
+		return _cancel or
+			_queue->concurrent_queue<ValuePtr>::size() < _capacity; });
+	return _cancel;
+}
+
+// ==============================================================
+// Consumer side.
+
+QueueValuePtr QueryStream::wait_for_queue(void) const
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	_cv.wait(lck, [&] { return _queue or _done; });
+	return _queue;
+}
+
+/// Wake up the producer. The lock is taken, so that the wake-up
+/// cannot slip in between its check for room, and its wait.
+void QueryStream::made_room(void) const
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+	}
+	_cv.notify_all();
+}
+
+bool QueryStream::next(ValuePtr& val)
+{
+	// The queue is never popped with a blocking pop(); that throws
+	// once the queue is closed, and the closing would have to be
+	// undone to drain it, behind the back of any other consumer.
+	// Instead, wait here until there is a result, or the search is
+	// done, and take the result without blocking. Another consumer
+	// may have taken it first; then wait again.
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (true)
+	{
+		_cv.wait(lck, [&] {
+			return _done or (_queue and not _queue->is_empty()); });
+
+		if (_queue and _queue->try_get(val))
+		{
+			// Taken under the lock, so the producer cannot miss this.
+			lck.unlock();
+			_cv.notify_all();
+			return true;
+		}
+		if (_done) break;
+	}
+
+	if (_error)
+	{
+		std::exception_ptr err(_error);
+		_error = nullptr;
+		std::rethrow_exception(err);
+	}
+	return false;
+}
+
+/// Hand out what has been found so far, waiting for at least one,
+/// but no more than a buffer-full; the search keeps going meanwhile.
+void QueryStream::update() const
+{
+	_value.clear();
+
+	QueryStream* self = const_cast<QueryStream*>(this);
+	ValuePtr val;
+	if (not self->next(val)) return;
+	_value.emplace_back(val);
+
+	QueueValuePtr qv(wait_for_queue());
+	while (_value.size() < _capacity and not qv->is_empty() and
+	       self->next(val))
+		_value.emplace_back(val);
+}
+
+// ==============================================================
+
+std::string QueryStream::to_string(const std::string& indent) const
+{
+	std::string rv = indent + "(" + nameserver().getTypeName(_type);
+	rv += "\n" + _query->to_string(indent + "   ");
+	rv += "\n)";
+	return rv;
+}
+
+bool QueryStream::operator==(const Value& other) const
+{
+	return &other == this;
+}
+
+// ==============================================================
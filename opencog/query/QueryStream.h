@@ -0,0 +1,125 @@
+/*
+ * QueryStream.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_QUERY_STREAM_H
+#define _OPENCOG_QUERY_STREAM_H
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <opencog/atoms/value/LinkStreamValue.h>
+#include <opencog/atoms/value/QueueValue.h>
+
+namespace opencog
+{
+
+class AtomSpace;
+class PatternMatchCallback;
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * The results of a MeetLink or QueryLink, produced on demand.
+ *
+ * Executing a query runs the search to completion, and holds every
+ * result in memory, even if only the first few are wanted. Here, the
+ * search runs in a thread of its own, and pauses whenever `capacity`
+ * results are waiting to be taken. Memory stays bounded, no matter
+ * how many results there are, and the first ones arrive quickly.
+ * Dropping the stream stops the search.
+ *
+ * Results are taken one at a time with next(), or a batch at a time,
+ * through value(): each call returns whatever has been found since
+ * the last one (waiting for at least one), and an empty sequence
+ * once the search is done. Several threads may call next() on the
+ * same stream; each result goes to one of them.
+ *
+ * The results are the same as those put on the QueueValue by
+ * execute(), except for the special case of a QueryLink made only
+ * of absent clauses, which is not handled.
+ */
+class QueryStream
+	: public LinkStreamValue
+{
+	template<class CB> friend class Throttled;
+
+protected:
+	virtual void update() const;
+
+	Handle _query;
+	AtomSpace* _as;
+	size_t _capacity;
+
+	std::unique_ptr<PatternMatchCallback> _cb;
+	std::thread _producer;
+
+	mutable std::mutex _mtx;
+	mutable std::condition_variable _cv;
+	QueueValuePtr _queue;
+	bool _done;
+	bool _cancel;
+	std::exception_ptr _error;
+
+	void run(void);
+	void attach(const QueueValuePtr&);
+	bool wait_for_room(void);
+	QueueValuePtr wait_for_queue(void) const;
+	void made_result(void) const;
+	void made_room(void) const;
+
+public:
+	QueryStream(AtomSpace*, const Handle&, size_t capacity = 1000);
+	virtual ~QueryStream();
+
+	/// Wait for the next result; return false if there are no more.
+	bool next(ValuePtr&);
+
+	/// Stop the search; results already found can still be taken.
+	void cancel(void);
+
+	/** Returns a string representation of the value.  */
+	virtual std::string to_string(const std::string& indent = "") const;
+
+	/** Returns true if two values are equal. */
+	virtual bool operator==(const Value&) const;
+};
+
+typedef std::shared_ptr<QueryStream> QueryStreamPtr;
+static inline QueryStreamPtr QueryStreamCast(ValuePtr& a)
+	{ return std::dynamic_pointer_cast<QueryStream>(a); }
+
+template<typename ... Type>
+static inline std::shared_ptr<QueryStream> createQueryStream(Type&&... args)
+{
+	return std::make_shared<QueryStream>(std::forward<Type>(args)...);
+}
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_QUERY_STREAM_H
@@ -39,6 +39,17 @@ using namespace opencog;
 
 /* ======================================================== */
 
+/// Can `cand` possibly be a rule for the input term `sth`? Without a
+/// glob directly under it, a rule has to have the same arity, else
+/// link_match() and fuzzy_match() would reject it anyway.
+static bool may_fit(const Handle& sth, const Handle& cand)
+{
+	if (cand->get_arity() == sth->get_arity()) return true;
+	for (const Handle& h : cand->getOutgoingSet())
+		if (GLOB_NODE == h->get_type()) return true;
+	return false;
+}
+
 bool Recognizer::do_search(PatternMatchCallback& pmc, const Handle& top)
 {
 	if (top->is_link())
@@ -46,10 +57,11 @@ bool Recognizer::do_search(PatternMatchCallback& pmc, const Handle& top)
 		// Recursively drill down and explore every possible node as
 		// a search starting point. This is needed, as the patterns we
 		// compare against might not be connected.
+		auto pl = _pattern->connected_terms_map.find({top, _root});
+		const PatternTermPtr starter(pl->second[0]);
 		for (const Handle& h : top->getOutgoingSet())
 		{
-			auto pl = _pattern->connected_terms_map.find({top, _root});
-			_starter_term = pl->second[0];
+			_starter_term = starter;
 			bool found = do_search(pmc, h);
 			if (found) return true;
 		}
@@ -59,12 +71,22 @@ bool Recognizer::do_search(PatternMatchCallback& pmc, const Handle& top)
 	PatternMatchEngine pme(pmc);
 	pme.set_pattern(*_vars, *_pattern);
 
-	// IncomingSet iset = get_incoming_set(top);
-	IncomingSet iset = top->getIncomingSet(_as);
+	// A rule holding several of the nodes of the same input term shows
+	// up in the incoming set of each of them; it only needs to be
+	// explored once. Rules of some other type cannot match the term,
+	// so only those of its type are looked at.
+	if (nullptr == _starter_term) return false;
+	const Handle& sth = _starter_term->getHandle();
+	HandleSet& explored = _explored[_starter_term];
+
+	IncomingSet iset = top->getIncomingSetByType(sth->get_type(), _as);
 	size_t sz = iset.size();
 	for (size_t i = 0; i < sz; i++)
 	{
 		Handle h(iset[i]);
+		if (not may_fit(sth, h)) continue;
+		if (not explored.insert(h).second) continue;
+
 		dbgprt("rrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrr\n");
 		dbgprt("Loop candidate (%lu - %s):\n%s\n", _cnt++,
 		       top->to_short_string().c_str(),
@@ -83,6 +105,7 @@ bool Recognizer::perform_search(PatternMatchCallback& pmc)
 	const PatternTermSeq& clauses = _pattern->pmandatory;
 
 	_cnt = 0;
+	_explored.clear();
 	for (const PatternTermPtr& ptm: clauses)
 	{
 		_root = ptm;
@@ -59,6 +59,7 @@ class Recognizer :
 		PatternTermPtr _root;
 		PatternTermPtr _starter_term;
 		size_t _cnt;
+		std::map<PatternTermPtr, HandleSet> _explored;
 		bool do_search(PatternMatchCallback&, const Handle&);
 		bool loose_match(const Handle&, const Handle&);
 
@@ -81,6 +82,10 @@ class Recognizer :
 		virtual bool node_match(const Handle&, const Handle&);
 		virtual bool link_match(const PatternTermPtr&, const Handle&);
 		virtual bool fuzzy_match(const Handle&, const Handle&);
+		virtual bool probe_optional_clause(const Handle&,
+		                                   const GroundingMap&,
+		                                   Handle&)
+		{ return false; }
 		virtual bool grounding(const GroundingMap &var_soln,
 		                       const GroundingMap &term_soln);
 		virtual bool perform_search(PatternMatchCallback&);
@@ -67,7 +67,9 @@ bool RewriteMixin::grounding(const GroundingMap &var_soln,
 	} catch (const SilentException& ex) {}
 
 	// If we found as many as we want, then stop looking for more.
-	return (_result_set.size() >= max_results);
+	if (_result_set.size() < max_results) return false;
+	truncate();
+	return true;
 }
 
 void RewriteMixin::insert_result(ValuePtr v)
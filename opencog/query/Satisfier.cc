@@ -134,8 +134,11 @@ bool SatisfyingSet::grounding(const GroundingMap &var_soln,
 	// PatternMatchEngine::log_solution(var_soln, term_soln);
 
 	// Do not accept new solution if maximum number has been already reached
-	if (_result_queue->concurrent_queue<ValuePtr>::size() >= max_results)
+	if (_num_results >= max_results)
+	{
+		truncate();
 		return true;
+	}
 
 	if (1 == _varseq.size())
 	{
@@ -152,12 +155,16 @@ bool SatisfyingSet::grounding(const GroundingMap &var_soln,
 		}
 
 		// If we found as many as we want, then stop looking for more.
-		return (_result_queue->concurrent_queue<ValuePtr>::size() >= max_results);
+		if (++_num_results < max_results)
+			return false;
+		truncate();
+		return true;
 	}
 
 	// If more than one variable, encapsulate in sequential order,
 	// in a ListLink.
 	std::vector<ValuePtr> vargnds;
+	vargnds.reserve(_varseq.size());
 	for (const Handle& hv : _varseq)
 	{
 		// Optional clauses (e.g. AbsentLink) may have variables
@@ -177,7 +184,10 @@ bool SatisfyingSet::grounding(const GroundingMap &var_soln,
 	_result_queue->push(std::move(gnds));
 
 	// If we found as many as we want, then stop looking for more.
-	return (_result_queue->concurrent_queue<ValuePtr>::size() >= max_results);
+	if (++_num_results < max_results)
+		return false;
+	truncate();
+	return true;
 }
 
 bool SatisfyingSet::start_search(void)
@@ -186,6 +196,7 @@ bool SatisfyingSet::start_search(void)
 	// This allows users to hang on to the old queue, holding
 	// previous results, if they need to.
 	_result_queue = createQueueValue();
+	_num_results = 0;
 	return false;
 }
 
@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_SATISFIER_H
 #define _OPENCOG_SATISFIER_H
 
+#include <typeinfo>
 #include <vector>
 
 #include <opencog/atoms/truthvalue/TruthValue.h>
@@ -104,10 +105,14 @@ class SatisfyingSet :
 		HandleSeq _varseq;
 		QueueValuePtr _result_queue;
 
+		// Results found so far. Not the size of the queue: a
+		// consumer may be taking them off as they are found.
+		size_t _num_results;
+
 	public:
 		SatisfyingSet(AtomSpace* as) :
 			ContinuationMixin(as),
-			_as(as), max_results(SIZE_MAX) {}
+			_as(as), _num_results(0), max_results(SIZE_MAX) {}
 
 		size_t max_results;
 
@@ -131,6 +136,14 @@ class SatisfyingSet :
 
 		virtual QueueValuePtr get_result_queue()
 		{ return _result_queue; }
+
+		// Derived classes may search differently; they don't
+		// get copies, unless they say how.
+		virtual std::unique_ptr<PatternMatchCallback> branch_callback(void)
+		{
+			if (typeid(*this) != typeid(SatisfyingSet)) return nullptr;
+			return std::make_unique<SatisfyingSet>(_as);
+		}
 };
 
 }; // namespace opencog
@@ -21,9 +21,14 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <atomic>
+#include <thread>
+
 #include <opencog/util/oc_assert.h>
 #include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Trace.h>
 
+#include <opencog/atoms/core/FindUtils.h>
 #include <opencog/atomspace/AtomSpace.h>
 
 #include <opencog/query/SatisfyMixin.h>
@@ -32,6 +37,11 @@
 
 using namespace opencog;
 
+#ifdef USE_PARALLEL_DISJUNCTS
+std::atomic<size_t>
+SatisfyMixin::parallel_min_branches(PM_PARALLEL_MIN_BRANCHES);
+#endif // USE_PARALLEL_DISJUNCTS
+
 // #define QDEBUG 1
 
 /* ================================================================= */
@@ -95,10 +105,18 @@ class PMCGroundings : public SatisfyMixin
 		{
 			return _cb.get_incoming_set(h, t);
 		}
+		void fill_incoming_set(const Handle& h, Type t, IncomingSet& iset)
+		{
+			_cb.fill_incoming_set(h, t, iset);
+		}
 		Handle get_link(const Handle& hg, Type t, HandleSeq&& oset)
 		{
 			return _cb.get_link(hg, t, std::move(oset));
 		}
+		void note_branches(const PatternTermPtr& clause, size_t n)
+		{
+			_cb.note_branches(clause, n);
+		}
 		void push(void) { _cb.push(); }
 		void pop(void) { _cb.pop(); }
 		void next_connections(const GroundingMap& var_grounding)
@@ -129,6 +147,16 @@ class PMCGroundings : public SatisfyMixin
 			return _cb.search_finished(done);
 		}
 
+		bool search_halted(void)
+		{
+			return _cb.search_halted();
+		}
+
+		SearchStats* get_stats(void)
+		{
+			return _cb.get_stats();
+		}
+
 		// This one we don't pass through. Instead, we collect the
 		// groundings.
 		bool grounding(const GroundingMap &var_soln,
@@ -175,18 +203,16 @@ class PMCGroundings : public SatisfyMixin
  * Return false if no solution is found, true otherwise.
  * (As always, 'false' means 'search some more' and 'true' means 'halt'.
  *
- * XXX FIXME: A major performance optimization is possible, to handle
- * the truly explosive combinatorial case. The optimization is to first
- * locate all of the variables in the virtual clauses, and perform the
- * recursion in the order of these variables. Once all of the variables
- * in a particular virtual clause have been found, that clause can be
- * evaluated on the spot. If it rejects the match, then one does not
- * have to recurse to the bitter end. This basically prunes the search
- * space. (Similar to how SAT solving works).
+ * Virtual clauses that always give the same answer for the same
+ * groundings are evaluated as soon as all of their variables are
+ * grounded, so that a rejected partial product is not recursed into;
+ * and the answer is remembered, so that each is evaluated only once
+ * per distinct grounding of its variables, no matter how many elements
+ * of the product share it. See `virtual_accept()`.
  *
- * This perf optimization has not been done because basically no one
- * uses the pattern engine to explore large, complex cartesian products
- * in this way.
+ * XXX FIXME: More pruning is possible, by performing the recursion in
+ * the order of the variables in the virtual clauses, so that they can
+ * be evaluated as early as possible. (Similar to how SAT solving works).
  */
 bool SatisfyMixin::cartesian_product(
             const HandleSeq& virtuals,
@@ -240,7 +266,7 @@ bool SatisfyMixin::cartesian_product(
 			// in the Arg atoms. So, we ground the args, and pass that
 			// to the callback.
 
-			bool match = evaluate_sentence(virt, var_gnds);
+			bool match = virtual_accept(virt, var_gnds, false);
 
 			if (not match) return false;
 		}
@@ -277,6 +303,8 @@ bool SatisfyMixin::cartesian_product(
 	size_t ngnds = vg.size();
 	for (size_t i=0; i<ngnds; i++)
 	{
+		if (search_halted()) return false;
+
 		// Given a set of groundings, tack on those for this component,
 		// and recurse, with one less component. We need to make a copy,
 		// of course.
@@ -288,6 +316,19 @@ bool SatisfyMixin::cartesian_product(
 		rvg.insert(cand_vg.begin(), cand_vg.end());
 		rpg.insert(cand_pg.begin(), cand_pg.end());
 
+		// Don't bother with the rest of the product, if a virtual
+		// clause already says no.
+		bool reject = false;
+		for (const Handle& virt : virtuals)
+		{
+			if (not virtual_accept(virt, rvg, true))
+			{
+				reject = true;
+				break;
+			}
+		}
+		if (reject) continue;
+
 		bool accept = cartesian_product(virtuals, absents, rvg, rpg,
 		                                comp_var_gnds, comp_term_gnds);
 
@@ -297,6 +338,149 @@ bool SatisfyMixin::cartesian_product(
 	return false;
 }
 
+/* ================================================================= */
+/**
+ * Find the variables in each of the virtual clauses. Those clauses
+ * that might have side effects, or might not give the same answer
+ * twice, are left out; they are evaluated afresh, on every element
+ * of the Cartesian product, as always.
+ */
+void SatisfyMixin::setup_virtuals(const HandleSeq& virtuals,
+                                  const HandleSet& varset)
+{
+	_virt_vars.clear();
+	_virt_cache.clear();
+	for (const Handle& virt : virtuals)
+	{
+		if (contains_atomtype(virt, GROUNDED_PROCEDURE_NODE) or
+		    contains_atomtype(virt, DEFINED_PREDICATE_NODE) or
+		    contains_atomtype(virt, DEFINED_SCHEMA_NODE) or
+		    contains_atomtype(virt, EXECUTION_OUTPUT_LINK) or
+		    contains_atomtype(virt, RANDOM_NUMBER_LINK) or
+		    contains_atomtype(virt, RANDOM_CHOICE_LINK))
+			continue;
+
+		HandleSeq vs;
+		for (const Handle& v : varset)
+			if (is_unquoted_unscoped_in_tree(virt, v))
+				vs.push_back(v);
+		_virt_vars.emplace(virt, vs);
+	}
+}
+
+/**
+ * Does the virtual clause accept the groundings? If `early` is set,
+ * then not all of the variables might be grounded yet; the clause is
+ * only asked if it has all of its own, and otherwise, accepts.
+ *
+ * The answers of clauses found by `setup_virtuals()` are remembered,
+ * and looked up by the groundings of their variables.
+ */
+bool SatisfyMixin::virtual_accept(const Handle& virt,
+                                  const GroundingMap& var_gnds,
+                                  bool early)
+{
+	const auto& vit = _virt_vars.find(virt);
+	if (_virt_vars.end() == vit)
+		return early or evaluate_sentence(virt, var_gnds);
+
+	HandleSeq key;
+	for (const Handle& v : vit->second)
+	{
+		const auto& git = var_gnds.find(v);
+		if (var_gnds.end() == git)
+		{
+			if (early) return true;
+			return evaluate_sentence(virt, var_gnds);
+		}
+		key.push_back(git->second);
+	}
+
+	const auto& ins = _virt_cache.emplace(std::make_pair(virt, key), false);
+	if (ins.second)
+		ins.first->second = evaluate_sentence(virt, var_gnds);
+	return ins.first->second;
+}
+
+/* ================================================================= */
+/**
+ * Search the branches of an OrLink all at once, each with a callback
+ * of its own, as given by `branch_callback()`. The groundings of each
+ * branch are collected, exactly as in the serial loop in `satisfy()`,
+ * and reported to this callback once all branches are done. The same
+ * goes for the disconnected components of a Cartesian product; their
+ * groundings are then combined as before, one product at a time.
+ *
+ * Return false, having searched nothing, if this is not possible:
+ * if there are too few branches, if the callback cannot make copies
+ * of itself, or if one of the branches is made of absent clauses
+ * only (its outcome is decided by the state of the callback).
+ */
+bool SatisfyMixin::branch_search(const HandleSeq& comp_patterns,
+                                 GroundingMapSeqSeq& comp_var_gnds,
+                                 GroundingMapSeqSeq& comp_term_gnds)
+{
+#ifdef USE_PARALLEL_DISJUNCTS
+	size_t num_comps = comp_patterns.size();
+	if (num_comps < parallel_min_branches) return false;
+
+	std::vector<std::unique_ptr<PatternMatchCallback>> branches;
+	for (const Handle& cp : comp_patterns)
+	{
+		if (PatternLinkCast(cp)->get_pattern().pmandatory.empty())
+			return false;
+
+		std::unique_ptr<PatternMatchCallback> b(branch_callback());
+		if (nullptr == b) return false;
+		b->set_deadline(_deadline);
+		b->set_stats(get_stats());
+		branches.emplace_back(std::move(b));
+	}
+
+	std::vector<std::unique_ptr<PMCGroundings>> gcbs;
+	for (const auto& b : branches)
+		gcbs.emplace_back(new PMCGroundings(*b));
+
+	std::vector<std::exception_ptr> errs(num_comps);
+	std::atomic<size_t> next_branch(0);
+	auto worker = [&]()
+	{
+		for (size_t i = next_branch++; i < num_comps; i = next_branch++)
+		{
+			try
+			{
+				gcbs[i]->satisfy(PatternLinkCast(comp_patterns[i]));
+			}
+			catch (...)
+			{
+				errs[i] = std::current_exception();
+			}
+		}
+	};
+
+	size_t nthreads = std::thread::hardware_concurrency();
+	if (0 == nthreads) nthreads = 1;
+	if (num_comps < nthreads) nthreads = num_comps;
+
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < nthreads; t++)
+		pool.push_back(std::thread(worker));
+	worker();
+	for (std::thread& t : pool) t.join();
+
+	for (size_t i = 0; i < num_comps; i++)
+	{
+		if (errs[i]) std::rethrow_exception(errs[i]);
+		if (branches[i]->is_truncated()) truncate();
+		comp_var_gnds.push_back(std::move(gcbs[i]->_var_groundings));
+		comp_term_gnds.push_back(std::move(gcbs[i]->_term_groundings));
+	}
+	return true;
+#else
+	return false;
+#endif // USE_PARALLEL_DISJUNCTS
+}
+
 /* ================================================================= */
 /**
  * Ground (solve) a pattern; perform unification. That is, find one
@@ -363,6 +547,7 @@ bool SatisfyMixin::cartesian_product(
  */
 bool SatisfyMixin::satisfy(const PatternLinkPtr& form)
 {
+	TRACE_SPAN("query", form.get());
 	PatternLinkPtr jit = form->jit_analyze();
 
 	const Variables& vars = jit->get_variables();
@@ -444,7 +629,20 @@ bool SatisfyMixin::satisfy(const PatternLinkPtr& form)
 	GroundingMapSeqSeq comp_var_gnds;
 	const HandleSeq& comp_patterns = jit->get_component_patterns();
 
-	for (size_t i = 0; i < num_comps; i++)
+	bool branched = false;
+#ifdef USE_PARALLEL_DISJUNCTS
+	branched = branch_search(comp_patterns, comp_var_gnds, comp_term_gnds);
+
+	// As below: a component without groundings has an empty product.
+	// The others were searched anyway; they ran at the same time.
+	if (branched and not have_orlink)
+	{
+		for (const GroundingMapSeq& gnds : comp_term_gnds)
+			if (gnds.empty()) return false;
+	}
+#endif
+
+	for (size_t i = 0; not branched and i < num_comps; i++)
 	{
 #ifdef QDEBUG
 		LAZY_LOG_FINE << "BEGIN COMPONENT GROUNDING " << i+1
@@ -524,9 +722,11 @@ bool SatisfyMixin::satisfy(const PatternLinkPtr& form)
 	GroundingMap empty_pg;
 	bool done = start_search();
 	if (done) return done;
+	setup_virtuals(virts, vars.varset);
 	done = cartesian_product(virts, pat.absents,
 	                         empty_vg, empty_pg,
 	                         comp_var_gnds, comp_term_gnds);
+	_virt_cache.clear();
 	done = search_finished(done);
 	return done;
 }
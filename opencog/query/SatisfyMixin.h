@@ -24,6 +24,9 @@
 #ifndef _OPENCOG_SATISFY_MIXIN_H
 #define _OPENCOG_SATISFY_MIXIN_H
 
+#include <atomic>
+#include <map>
+
 #include "PatternMatchCallback.h"
 
 namespace opencog {
@@ -39,8 +42,26 @@ class SatisfyMixin:
 	                       GroundingMapSeqSeq comp_var_gnds,
 	                       GroundingMapSeqSeq comp_term_gnds);
 
+	// The variables in each virtual clause that gives the same answer
+	// every time it is asked, and the answers given so far.
+	std::map<Handle, HandleSeq> _virt_vars;
+	std::map<std::pair<Handle, HandleSeq>, bool> _virt_cache;
+	void setup_virtuals(const HandleSeq&, const HandleSet&);
+	bool virtual_accept(const Handle&, const GroundingMap&, bool early);
+
+	bool branch_search(const HandleSeq& comp_patterns,
+	                   GroundingMapSeqSeq& comp_var_gnds,
+	                   GroundingMapSeqSeq& comp_term_gnds);
+
 	public:
 		virtual bool satisfy(const PatternLinkPtr&);
+
+#ifdef USE_PARALLEL_DISJUNCTS
+		/// OrLinks, and Cartesian products, with fewer branches than
+		/// this are searched serially. Defaults to
+		/// `PM_PARALLEL_MIN_BRANCHES`.
+		static std::atomic<size_t> parallel_min_branches;
+#endif
 };
 
 }; // namespace opencog
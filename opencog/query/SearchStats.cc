@@ -0,0 +1,90 @@
+/*
+ * SearchStats.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/LinkValue.h>
+
+#include "SearchStats.h"
+
+using namespace opencog;
+
+static double seconds(SearchStats::Duration d)
+{
+	return std::chrono::duration<double>(d).count();
+}
+
+void SearchStats::add_start(const Handle& h)
+{
+	if (nullptr == h) return;
+	std::lock_guard<std::mutex> lck(_mtx);
+	for (const Handle& s : _starts)
+		if (s == h) return;
+	_starts.push_back(h);
+}
+
+void SearchStats::add_clause(const Handle& clause, Duration d)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	PerClause& pc = _per_clause[clause];
+	pc.explored++;
+	pc.time += d;
+}
+
+void SearchStats::accept_clause(const Handle& clause)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_per_clause[clause].accepted++;
+}
+
+ValuePtr SearchStats::to_value(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+
+	ValuePtr totals(createFloatValue(std::vector<double>({
+		(double) neighborhoods, (double) clauses,
+		(double) tree_compares, (double) permutations,
+		(double) glob_states, (double) cache_hits,
+		(double) cache_misses, (double) groundings,
+		seconds(elapsed)})));
+
+	ValueSeq starts(_starts.begin(), _starts.end());
+
+	ValueSeq per;
+	for (const auto& pc : _per_clause)
+		per.push_back(createLinkValue(ValueSeq({pc.first,
+			createFloatValue(std::vector<double>({
+				(double) pc.second.explored,
+				(double) pc.second.accepted,
+				seconds(pc.second.time)}))})));
+
+	return createLinkValue(ValueSeq({totals,
+		createLinkValue(std::move(starts)),
+		createLinkValue(std::move(per))}));
+}
+
+const Handle& SearchStats::key(void)
+{
+	static Handle sk(createNode(PREDICATE_NODE, "*-query-stats-*"));
+	return sk;
+}
@@ -0,0 +1,100 @@
+/*
+ * SearchStats.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SEARCH_STATS_H
+#define _OPENCOG_SEARCH_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/value/Value.h>
+
+namespace opencog
+{
+
+/**
+ * Counters that tell where a search spent its effort: how many
+ * starting points were tried, how many clauses explored, how many
+ * terms compared, permutations and glob widths tried, how often the
+ * clause-grounding cache helped, and, for each clause, how often it
+ * was explored and accepted, and for how long. The time for a clause
+ * includes the time spent on the clauses explored below it.
+ *
+ * They are gathered only when asked for, with
+ * `PatternMatchCallback::set_stats()`; otherwise the engine does not
+ * touch them. MeetLink and QueryLink gather them, if the query has a
+ * Value at `key()`, and place them there when done; see `to_value()`
+ * for the format.
+ */
+struct SearchStats
+{
+	typedef std::chrono::steady_clock::duration Duration;
+
+	std::atomic<size_t> neighborhoods{0};
+	std::atomic<size_t> clauses{0};
+	std::atomic<size_t> tree_compares{0};
+	std::atomic<size_t> permutations{0};
+	std::atomic<size_t> glob_states{0};
+	std::atomic<size_t> cache_hits{0};
+	std::atomic<size_t> cache_misses{0};
+	std::atomic<size_t> groundings{0};
+	Duration elapsed{0};
+
+	struct PerClause
+	{
+		size_t explored = 0;
+		size_t accepted = 0;
+		Duration time{0};
+	};
+
+	void add_start(const Handle&);
+	void add_clause(const Handle&, Duration);
+	void accept_clause(const Handle&);
+
+	/// The statistics, as
+	///
+	///    LinkValue
+	///       FloatValue neighborhoods clauses tree-compares permutations
+	///                  glob-states cache-hits cache-misses groundings
+	///                  seconds
+	///       LinkValue <start terms>
+	///       LinkValue
+	///          LinkValue <clause> (FloatValue explored accepted seconds)
+	///          ...
+	ValuePtr to_value(void) const;
+
+	/// The key under which MeetLink and QueryLink place the statistics.
+	static const Handle& key(void);
+
+private:
+	mutable std::mutex _mtx;
+	HandleSeq _starts;
+	std::map<Handle, PerClause> _per_clause;
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_SEARCH_STATS_H
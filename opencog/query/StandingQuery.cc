@@ -0,0 +1,331 @@
+/*
+ * StandingQuery.cc
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atoms/value/LinkValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "PatternMatchEngine.h"
+#include "StandingQuery.h"
+
+using namespace opencog;
+
+/* ======================================================== */
+
+StandingQuery::StandingQuery(AtomSpace* as, const Handle& query)
+	: ContinuationMixin(as),
+	  _as(as), _query(PatternLinkCast(query)), _busy(true)
+{
+	if (nullptr == _query)
+		throw InvalidParamException(TRACE_INFO,
+			"StandingQuery: expecting a query, got %s",
+			query->to_short_string().c_str());
+
+	_seedable = is_seedable(_query->jit_analyze());
+	_added = createQueueValue();
+	_removed = createQueueValue();
+
+	// Listen first, so that nothing is missed; changes made while
+	// the first search runs are queued up, until it is done.
+	_add_sig = as->atomAddedSignal().connect(
+		[this](const Handle& h) { changed(h, true); });
+	_remove_sig = as->atomRemovedSignal().connect(
+		[this](const Handle& h) { changed(h, false); });
+	_adds_sig = as->atomsAddedSignal().connect(
+		[this](const HandleSeq& hs) { for (const Handle& h : hs) changed(h, true); });
+	_removes_sig = as->atomsRemovedSignal().connect(
+		[this](const HandleSeq& hs) { for (const Handle& h : hs) changed(h, false); });
+
+	try
+	{
+		if (_seedable)
+		{
+			search(Handle::UNDEFINED);
+			for (const auto& f : _found)
+				record(f.first, f.second);
+			_found.clear();
+		}
+		else
+			rerun();
+
+		drain();
+	}
+	catch (...)
+	{
+		as->atomAddedSignal().disconnect(_add_sig);
+		as->atomRemovedSignal().disconnect(_remove_sig);
+		as->atomsAddedSignal().disconnect(_adds_sig);
+		as->atomsRemovedSignal().disconnect(_removes_sig);
+		throw;
+	}
+}
+
+StandingQuery::~StandingQuery()
+{
+	_as->atomAddedSignal().disconnect(_add_sig);
+	_as->atomRemovedSignal().disconnect(_remove_sig);
+	_as->atomsAddedSignal().disconnect(_adds_sig);
+	_as->atomsRemovedSignal().disconnect(_removes_sig);
+}
+
+/// Can every new grounding be found by seeding the search with the
+/// link that was just added? This is so if every grounding of the
+/// pattern is made of the groundings of its mandatory clauses, and
+/// nothing else, and if each of those is a link.
+bool StandingQuery::is_seedable(const PatternLinkPtr& jit)
+{
+	const Pattern& pat = jit->get_pattern();
+	if (1 < jit->get_components().size()) return false;
+	if (not jit->get_virtual().empty()) return false;
+	if (not pat.absents.empty() or not pat.always.empty()) return false;
+	if (pat.have_evaluatables or not pat.defined_terms.empty()) return false;
+	if (pat.pmandatory.empty()) return false;
+
+	for (const PatternTermPtr& root : pat.pmandatory)
+	{
+		const Handle& h = root->getHandle();
+		if (root->isChoice() or root->getQuote() != h or not h->is_link())
+			return false;
+	}
+	return true;
+}
+
+ValuePtr StandingQuery::make_value(const HandleSeq& key) const
+{
+	if (1 == key.size()) return key[0];
+
+	std::vector<ValuePtr> vargnds(key.begin(), key.end());
+	return createLinkValue(std::move(vargnds));
+}
+
+/* ======================================================== */
+
+void StandingQuery::changed(const Handle& h, bool added)
+{
+	// Clause groundings are links; nodes come and go without
+	// changing anything, unless the pattern has to be re-run.
+	if (_seedable and not h->is_link()) return;
+
+	{
+		std::lock_guard<std::mutex> lck(_pend_mtx);
+		_pending.push_back({h, added});
+		if (_busy) return;
+		_busy = true;
+	}
+	drain();
+}
+
+/// Handle the pending changes, until there are none left.
+void StandingQuery::drain(void)
+{
+	try
+	{
+		while (true)
+		{
+			std::pair<Handle, bool> chg;
+			{
+				std::lock_guard<std::mutex> lck(_pend_mtx);
+				if (_pending.empty())
+				{
+					_busy = false;
+					return;
+				}
+				chg = _pending.front();
+				_pending.pop_front();
+
+				// One re-run covers any number of changes.
+				if (not _seedable)
+				{
+					if (not chg.second) _leaving.insert(chg.first);
+					for (const auto& p : _pending)
+						if (not p.second) _leaving.insert(p.first);
+					_pending.clear();
+				}
+			}
+
+			if (not _seedable)
+			{
+				rerun();
+				_leaving.clear();
+			}
+			else if (chg.second)
+				link_added(chg.first);
+			else
+				link_removed(chg.first);
+		}
+	}
+	catch (...)
+	{
+		_leaving.clear();
+		std::lock_guard<std::mutex> lck(_pend_mtx);
+		_busy = false;
+		throw;
+	}
+}
+
+/// Run the query, seeded with the given link, or in full, if none.
+void StandingQuery::search(const Handle& seed)
+{
+	_found.clear();
+	_seed = seed;
+	satisfy(_query);
+	_seed = Handle::UNDEFINED;
+}
+
+void StandingQuery::link_added(const Handle& h)
+{
+	search(h);
+	for (const auto& f : _found)
+		record(f.first, f.second);
+	_found.clear();
+}
+
+void StandingQuery::link_removed(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_res_mtx);
+	const auto& sit = _supported.find(h);
+	if (_supported.end() == sit) return;
+
+	std::set<HandleSeq> gone;
+	gone.swap(sit->second);
+	_supported.erase(sit);
+
+	for (const HandleSeq& key : gone)
+	{
+		const auto& rit = _results.find(key);
+		if (_results.end() == rit) continue;
+
+		for (const Handle& s : rit->second)
+		{
+			if (s == h) continue;
+			const auto& other = _supported.find(s);
+			if (_supported.end() == other) continue;
+			other->second.erase(key);
+			if (other->second.empty()) _supported.erase(other);
+		}
+		_results.erase(rit);
+		_removed->push(make_value(key));
+	}
+}
+
+/// Run the query in full, and report the difference from last time.
+void StandingQuery::rerun(void)
+{
+	search(Handle::UNDEFINED);
+
+	std::map<HandleSeq, Support> now;
+	for (const auto& f : _found)
+		now[f.first].insert(f.second.begin(), f.second.end());
+	_found.clear();
+
+	std::lock_guard<std::mutex> lck(_res_mtx);
+	for (const auto& r : _results)
+		if (now.end() == now.find(r.first))
+			_removed->push(make_value(r.first));
+	for (const auto& n : now)
+		if (_results.end() == _results.find(n.first))
+			_added->push(make_value(n.first));
+	_results.swap(now);
+}
+
+void StandingQuery::record(const HandleSeq& key, const Support& sup)
+{
+	std::lock_guard<std::mutex> lck(_res_mtx);
+	const auto& ins = _results.emplace(key, Support());
+	ins.first->second.insert(sup.begin(), sup.end());
+	for (const Handle& s : sup)
+		_supported[s].insert(key);
+
+	if (ins.second)
+		_added->push(make_value(key));
+}
+
+std::vector<HandleSeq> StandingQuery::get_results(void)
+{
+	std::lock_guard<std::mutex> lck(_res_mtx);
+	std::vector<HandleSeq> res;
+	for (const auto& r : _results)
+		res.push_back(r.first);
+	return res;
+}
+
+/* ======================================================== */
+
+void StandingQuery::set_pattern(const Variables& vars,
+                                const Pattern& pat)
+{
+	_varseq = vars.varseq;
+	ContinuationMixin::set_pattern(vars, pat);
+}
+
+bool StandingQuery::grounding(const GroundingMap& var_soln,
+                              const GroundingMap& term_soln)
+{
+	LOCK_PE_MUTEX;
+
+	// As in SatisfyingSet, variables in optional clauses may be
+	// left ungrounded; they stand for themselves.
+	HandleSeq key;
+	for (const Handle& hv : _varseq)
+	{
+		const auto& gv = var_soln.find(hv);
+		key.push_back(var_soln.end() == gv ? hv : gv->second);
+	}
+
+	// Links on their way out are still visible, for a moment, in the
+	// incoming sets of the atoms they hold.
+	Support sup;
+	for (const auto& ts : term_soln)
+	{
+		if (_leaving.end() != _leaving.find(ts.second)) return false;
+		sup.insert(ts.second);
+	}
+
+	_found.push_back({key, sup});
+	return false;
+}
+
+/// With no seed, this is the usual search. With one, only those
+/// groundings in which it grounds one of the clauses are looked for.
+bool StandingQuery::perform_search(PatternMatchCallback& pmc)
+{
+	if (nullptr == _seed)
+		return InitiateSearchMixin::perform_search(pmc);
+
+	EngineLease pme(this, pmc);
+
+	for (const PatternTermPtr& root : _pattern->pmandatory)
+	{
+		if (root->getHandle()->get_type() != _seed->get_type()) continue;
+
+		while (0 < _issued_stack.size()) _issued_stack.pop();
+		_issued.clear();
+		_issued.insert(root);
+		_root = root;
+		_starter_term = root;
+		if (pme->explore_neighborhood(root, _seed, root)) return true;
+	}
+	return false;
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,143 @@
+/*
+ * StandingQuery.h
+ *
+ * Copyright (C) 2024 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the
+ * exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public
+ * License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_STANDING_QUERY_H
+#define _OPENCOG_STANDING_QUERY_H
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include <opencog/atoms/pattern/PatternLink.h>
+#include <opencog/atoms/value/QueueValue.h>
+#include <opencog/query/ContinuationMixin.h>
+
+namespace opencog {
+
+/**
+ * A query that stays up to date as the AtomSpace changes.
+ *
+ * Re-running a query every so often, to see what has changed, costs
+ * as much as the AtomSpace is large, no matter how little changed.
+ * A StandingQuery instead runs the query once, and then listens to
+ * the AtomSpace signals. When a link is added, the search is re-run,
+ * but seeded only with that link, as the grounding of each clause it
+ * could ground in turn; any new groundings must go through it. When
+ * a link is removed, the groundings that it took part in are dropped.
+ * Thus, the cost tracks the rate of change, and not the size of the
+ * AtomSpace. A grounding is dropped as soon as any of the links it
+ * was found through goes away, even if it could also have been found
+ * through others.
+ *
+ * The results are the groundings of the variables, in order, as for
+ * MeetLink. (They are never rewritten; for a QueryLink, only the
+ * variables are reported.) Every grounding that comes into being is
+ * pushed onto the `added` queue; every one that goes away is pushed
+ * onto the `removed` queue. The groundings found by the first run of
+ * the query are reported as added. A single variable is reported as
+ * its grounding; several are wrapped in a LinkValue.
+ *
+ * Patterns that do not lend themselves to this (those with absent,
+ * always or evaluatable clauses, defined terms, or several components)
+ * are run in full on every change, and the results compared to the
+ * previous ones. This gives the same deltas, at the old cost.
+ *
+ * Changes are handled in the thread that makes them, one at a time;
+ * changes made while a search is running (by that search, or by other
+ * threads) are queued up, and handled after it. Only the given
+ * AtomSpace is watched, not its parents. The object must not be
+ * destroyed while a change is being handled.
+ */
+class StandingQuery :
+	public ContinuationMixin
+{
+	typedef std::set<Handle> Support;
+
+	AtomSpace* _as;
+	PatternLinkPtr _query;
+	HandleSeq _varseq;
+	bool _seedable;
+
+	QueueValuePtr _added;
+	QueueValuePtr _removed;
+
+	// Each grounding of the variables, together with the clause
+	// groundings it rests on; and, for each clause grounding, the
+	// variable groundings that rest on it.
+	std::mutex _res_mtx;
+	std::map<HandleSeq, Support> _results;
+	std::map<Handle, std::set<HandleSeq>> _supported;
+
+	// The groundings found by the search that is running.
+	DECLARE_PE_MUTEX;
+	std::vector<std::pair<HandleSeq, Support>> _found;
+
+	// The link to seed the search with, if any; and the atoms that
+	// are being removed, and must not be found.
+	Handle _seed;
+	HandleSet _leaving;
+
+	// Pending changes; true for an addition.
+	std::mutex _pend_mtx;
+	std::deque<std::pair<Handle, bool>> _pending;
+	bool _busy;
+
+	int _add_sig;
+	int _remove_sig;
+	int _adds_sig;
+	int _removes_sig;
+
+	static bool is_seedable(const PatternLinkPtr&);
+	ValuePtr make_value(const HandleSeq&) const;
+
+	void changed(const Handle&, bool);
+	void drain(void);
+	void search(const Handle&);
+	void link_added(const Handle&);
+	void link_removed(const Handle&);
+	void rerun(void);
+	void record(const HandleSeq&, const Support&);
+
+public:
+	StandingQuery(AtomSpace*, const Handle&);
+	virtual ~StandingQuery();
+
+	StandingQuery(const StandingQuery&) = delete;
+	StandingQuery& operator=(const StandingQuery&) = delete;
+
+	QueueValuePtr get_added(void) const { return _added; }
+	QueueValuePtr get_removed(void) const { return _removed; }
+
+	/// The groundings that hold right now.
+	std::vector<HandleSeq> get_results(void);
+
+	// Callbacks
+	virtual void set_pattern(const Variables&, const Pattern&);
+	virtual bool grounding(const GroundingMap&, const GroundingMap&);
+	virtual bool perform_search(PatternMatchCallback&);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_STANDING_QUERY_H
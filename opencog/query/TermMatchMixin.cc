@@ -449,6 +449,19 @@ bool TermMatchMixin::optional_clause_match(const Handle& ptrn,
 	return true;
 }
 
+/**
+ * The matches here are structural; so the only grounding for a plain
+ * clause with all of its variables grounded is the clause itself,
+ * with them filled in. If that is in the atomspace, it is there.
+ */
+bool TermMatchMixin::probe_optional_clause(const Handle& ptrn,
+                                           const GroundingMap& term_gnds,
+                                           Handle& grnd)
+{
+	grnd = _as->get_atom(Replacement::replace_nocheck(ptrn, term_gnds));
+	return true;
+}
+
 /* ======================================================== */
 
 /* This implements AlwaysLink (the non-scoped version of ForAllLink
@@ -475,6 +488,12 @@ IncomingSet TermMatchMixin::get_incoming_set(const Handle& h, Type t)
 	return h->getIncomingSetByType(t, _as);
 }
 
+void TermMatchMixin::fill_incoming_set(const Handle& h, Type t,
+                                       IncomingSet& iset)
+{
+	h->copyIncomingSetByType(iset, t, _as);
+}
+
 Handle TermMatchMixin::get_link(const Handle& hg,
                                 Type t, HandleSeq&& oset)
 {
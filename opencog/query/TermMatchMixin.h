@@ -28,6 +28,7 @@
 #include <opencog/atoms/atom_types/types.h>
 #include <opencog/atoms/core/Quotation.h>
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/ClauseCache.h>
 #include <opencog/query/PatternMatchCallback.h>
 
 namespace opencog {
@@ -72,6 +73,9 @@ class TermMatchMixin : public virtual PatternMatchCallback
 		virtual bool optional_clause_match(const Handle& pattrn,
 		                                   const Handle& grnd,
 		                                   const GroundingMap&);
+		virtual bool probe_optional_clause(const Handle& pattrn,
+		                                   const GroundingMap&,
+		                                   Handle& grnd);
 
 		/** Called for AlwaysLink */
 		virtual bool always_clause_match(const Handle& pattrn,
@@ -79,6 +83,7 @@ class TermMatchMixin : public virtual PatternMatchCallback
 		                                 const GroundingMap&);
 
 		virtual IncomingSet get_incoming_set(const Handle&, Type);
+		virtual void fill_incoming_set(const Handle&, Type, IncomingSet&);
 		virtual Handle get_link(const Handle&, Type, HandleSeq&&);
 
 		/**
@@ -93,6 +98,11 @@ class TermMatchMixin : public virtual PatternMatchCallback
 			return _connectives;
 		}
 
+		virtual ClauseCache* get_clause_cache(void)
+		{
+			return ClauseCache::find(_as);
+		}
+
 		// Remarks:
 		// 1) This could be made virtual, if someone wants to over-load.
 		// 2) End-users should stop depending on this, and should start
@@ -492,6 +492,24 @@
     ordinary scheme list.
 ")
 
+(set-procedure-property! cog-outgoing-vector 'documentation
+"
+ cog-outgoing-vector ATOM
+    Return the outgoing set of ATOM, as a scheme vector. This is the
+    same as (list->vector (cog-outgoing-set ATOM)), but does not make
+    the list first.
+")
+
+(set-procedure-property! cog-incoming-vector 'documentation
+"
+ cog-incoming-vector ATOM [ATOMSPACE]
+    Return the incoming set of ATOM, as a scheme vector. For large
+    incoming sets, this makes less garbage than `cog-incoming-set`,
+    and the vector can be indexed directly.
+
+    See also: cog-incoming-set
+")
+
 (set-procedure-property! cog-outgoing-by-type 'documentation
 "
  cog-outgoing-by-type ATOM TYPE
@@ -539,6 +557,8 @@
   then the truth value is replaced by a CountTruthValue, with the
   count set to CNT.
 
+  The increment is atomic, as for cog-inc-value!.
+
   Example usage:
      (cog-inc-count! (Concept \"Answer\") 42.0)
 
@@ -560,6 +580,9 @@
   created. If the existing FloatValue is too short, it is extended
   until it is at least (REF+1) in length.
 
+  The increment is atomic: increments made at the same time, from
+  different threads, are never lost.
+
   Example usage:
      (cog-inc-value!
          (Concept \"Question\")
@@ -834,6 +857,18 @@
        3.0
 ")
 
+(set-procedure-property! cog-value-size 'documentation
+"
+ cog-value-size VALUE
+    Return the number of entries in VALUE; that is, the largest N that
+    `cog-value-ref` accepts, plus one. This is the same as
+    (length (cog-value->list VALUE)), but does not make the list.
+
+    Example:
+       guile> (cog-value-size (FloatValue 0.1 0.2 0.3))
+       3
+")
+
 (set-procedure-property! cog-get-types 'documentation
 "
  cog-get-types
@@ -903,6 +938,37 @@
   See also: cog-get-atoms TYPE - returns a list of atoms of TYPE.
 ")
 
+(set-procedure-property! cog-atoms-vector 'documentation
+"
+ cog-atoms-vector TYPE [ATOMSPACE]
+    Return a vector holding all of the atoms of type TYPE. As with
+    `cog-map-type`, subtypes are not included. The vector is made in
+    one go; unlike `cog-get-atoms`, no list is consed up.
+
+  See also: cog-atom-seq TYPE - for when not all of them are needed.
+")
+
+(set-procedure-property! cog-atom-seq 'documentation
+"
+ cog-atom-seq TYPE [ATOMSPACE]
+    Return a LinkValue holding all of the atoms of type TYPE. Nothing
+    is converted to scheme until it is asked for: use `cog-value-size`
+    and `cog-value-ref` to walk through it. When only a few of a great
+    many atoms are wanted, this makes far less garbage than getting
+    all of them as a list.
+
+    Example:
+       ; Find the first ConceptNode with a long name.
+       guile> (define seq (cog-atom-seq 'ConceptNode))
+       guile> (let loop ((i 0))
+                 (cond ((= i (cog-value-size seq)) #f)
+                       ((< 20 (string-length (cog-name (cog-value-ref seq i))))
+                        (cog-value-ref seq i))
+                       (else (loop (+ i 1)))))
+
+  See also: cog-atoms-vector TYPE - to get them all at once.
+")
+
 (set-procedure-property! cog-count-atoms 'documentation
 "
   cog-count-atoms ATOM-TYPE [ATOMSPACE] -- Count of number of atoms
@@ -921,6 +987,139 @@
      cog-report-counts -- return a report of counts of all atom types.
 ")
 
+(set-procedure-property! cog-report-memory 'documentation
+"
+  cog-report-memory [ATOMSPACE] -- Estimated memory use, per atom type
+
+  Return an association list, with one entry for each atom type that
+  has atoms in the ATOMSPACE (atomspaces under it are not included).
+  Each entry is itself an association list: the `count` of atoms, the
+  total `bytes`, and then those bytes broken down into the `atoms`
+  themselves, the node `names`, the `outgoing` sets of links, the
+  `values` maps, the `payloads` of the values in them, the `incoming`
+  sets, and the `index` tables of the atomspace.
+
+  These are estimates, made from the sizes of the C++ containers, not
+  measurements of the heap. Values held by several atoms are split
+  evenly between them.
+
+  If the optional argument ATOMSPACE is absent, the current atomspace
+  is used.
+
+  Example usage:
+     (assoc-ref (assoc-ref (cog-report-memory) 'ConceptNode) 'bytes)
+
+  See also:
+     cog-report-counts -- return a report of counts of all atom types.
+")
+
+(set-procedure-property! cog-report-locks 'documentation
+"
+  cog-report-locks [RESET] -- Lock contention statistics
+
+  Return a printable table of how often each of the major locks was
+  taken, how often a thread had to wait for it, how long the waits
+  were, and how long the lock was held. Shared (reader) acquisitions
+  are counted apart. If RESET is #t, then the counts are zeroed, once
+  the report is made.
+
+  The statistics are gathered only if the AtomSpace was configured
+  with `cmake -DLOCK_STATS=ON`; otherwise, the report says so.
+
+  Example usage:
+     (display (cog-report-locks #t))
+")
+
+(set-procedure-property! cog-trace 'documentation
+"
+  cog-trace FLAG -- Start or stop recording execution trace spans
+
+  If FLAG is #t, then start recording a timed span for every query,
+  pattern search, evaluation, instantiation, call to a grounded
+  schema or predicate, and StorageNode operation; if it is #f, then
+  stop. Spans nest; each thread keeps its most recent 16384 of them.
+  Returns #t if spans were being recorded before this call.
+
+  The spans exist only if the AtomSpace was configured with
+  `cmake -DTRACE=ON`; otherwise, asking to start is an error.
+
+  See also: cog-trace-flush
+")
+
+(set-procedure-property! cog-trace-flush 'documentation
+"
+  cog-trace-flush [FILENAME] -- Write out the recorded trace spans
+
+  Write all of the spans recorded since the last flush, in the Chrome
+  trace-event format, and forget them. If FILENAME is given, the trace
+  is written there, and the number of spans is returned; otherwise,
+  the trace is returned as a string. The file can be opened with
+  Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+
+  Example usage:
+     (cog-trace #t)
+     (cog-execute! (Query ...))
+     (cog-trace #f)
+     (cog-trace-flush \"/tmp/query-trace.json\")
+")
+
+(set-procedure-property! cog-slow-query-log 'documentation
+"
+  cog-slow-query-log SECONDS [CAPACITY [SAMPLE]] -- Log slow queries
+
+  Start keeping a log of the queries and other executions that take
+  longer than SECONDS to run; if SECONDS is #f, stop. The requests
+  logged are those made with `cog-execute!`, and with the
+  `cog-execute-cache!` command of the network shells. The latest
+  CAPACITY of them are kept; the default is 100.
+
+  Search statistics (see `cog-query-stats`) are gathered for one in
+  every SAMPLE MeetLinks and QueryLinks run; the default is 1, that
+  is, for all of them. Use 0 to not gather them at all.
+
+  See also: cog-slow-queries, cog-slow-query-export
+")
+
+(set-procedure-property! cog-slow-queries 'documentation
+"
+  cog-slow-queries -- The slow-query log
+
+  Return the requests kept in the slow-query log, oldest first. Each
+  is an association list, with the entries `query` (the Atom that was
+  run), `source` (the primitive or command that ran it), `seconds`,
+  `results` (the number of results), `time` (when it finished, in
+  seconds since the epoch) and `stats` (the search statistics, or '()
+  if they were not gathered).
+
+  Example usage:
+     (cog-slow-query-log 0.5)
+     ...
+     (for-each
+        (lambda (rec) (format #t \"~A ~A~%\"
+           (assoc-ref rec 'seconds) (assoc-ref rec 'query)))
+        (cog-slow-queries))
+")
+
+(set-procedure-property! cog-slow-query-export 'documentation
+"
+  cog-slow-query-export [ATOMSPACE] -- Move the slow-query log to storage
+
+  Empty the slow-query log into ATOMSPACE (or the current AtomSpace, if
+  none is given): each query recorded is added to it, and its records
+  are appended to the LinkValue on it at the key
+  (Predicate \"*-slow-query-*\"). Each record is a LinkValue of a
+  FloatValue of the seconds, results and finishing time, a StringValue
+  naming the source, and the search statistics, if any. Returns the
+  list of queries; save them with `store-value`.
+
+  Example usage, exporting every ten minutes:
+     (define key (Predicate \"*-slow-query-*\"))
+     (call-with-new-thread (lambda () (while #t
+        (sleep 600)
+        (for-each (lambda (q) (store-value q key))
+           (cog-slow-query-export)))))
+")
+
 (set-procedure-property! cog-atomspace 'documentation
 "
  cog-atomspace [ATOM]
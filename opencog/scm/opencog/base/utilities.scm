@@ -247,6 +247,8 @@
      cog-count-atoms -- count atoms of a given type.
      cog-report-counts -- provide a report of the different atom types.
 "
+	; cog-map-type walks the AtomSpace a chunk at a time; the list
+	; that is returned is the only full copy that is made.
 	(let ((lst '()))
 		(define (mklist atom)
 			(set! lst (cons atom lst))
@@ -7,4 +7,5 @@
 (use-modules (opencog as-config))
 (load-extension (string-append opencog-ext-path-dist-gearman "libdist-gearman") "opencog_dist_init")
 
-(export start-work-handler dist-eval exit-all-workers)
+(export start-work-handler dist-eval exit-all-workers
+	dist-execute dist-map)
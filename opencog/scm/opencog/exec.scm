@@ -49,4 +49,36 @@
 		))
 )
 
+; --------------------------------------------------------------------
+
+(define-public query-stats-key (PredicateNode "*-query-stats-*"))
+
+(define-public (cog-query-stats QUERY)
+"
+ cog-query-stats QUERY
+
+   Return the search statistics gathered during the last execution of
+   the MeetLink or QueryLink QUERY, or '() if there are none.
+
+   Statistics are gathered only when asked for. To ask, place any
+   Value on QUERY at `query-stats-key`, before executing it:
+
+      (cog-set-value! QUERY query-stats-key (FloatValue 0))
+      (cog-execute! QUERY)
+      (cog-query-stats QUERY)
+
+   The statistics are a LinkValue holding, in order:
+   -- a FloatValue with the number of starting points tried, clauses
+      explored, terms compared, unordered-link permutations tried,
+      glob groundings tried, clause-cache hits and misses, groundings
+      found, and the search time, in seconds;
+   -- a LinkValue with the terms the search started from;
+   -- a LinkValue holding, for each clause explored, a LinkValue with
+      the clause, and a FloatValue of the number of times it was
+      explored, the number of times it was grounded, and the time, in
+      seconds, spent exploring it (including the clauses after it).
+"
+	(cog-value QUERY query-stats-key)
+)
+
 ; ------------------ THE END -------------------
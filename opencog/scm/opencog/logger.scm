@@ -287,9 +287,11 @@
 "
  cog-logger-error LOGGER MSG ARGS
     Print MSG into the log file, at the \"error\" logging level.
-    The MSG can be in any ice-9 printing format.
+    The MSG can be in any ice-9 printing format. It is formatted
+    only if the \"error\" level is enabled.
 "
-  (cog-logger-error-of-logger logger (apply format #f msg args)))
+  (if (cog-logger-error-enabled-of-logger? logger)
+    (cog-logger-error-of-logger logger (apply format #f msg args))))
 
 (define (cog-logger-warn . args)
 "
@@ -304,9 +306,11 @@
 "
  cog-logger-warn LOGGER MSG ARGS
     Print MSG into the log file, at the \"warn\" logging level.
-    The MSG can be in any ice-9 printing format.
+    The MSG can be in any ice-9 printing format. It is formatted
+    only if the \"warn\" level is enabled.
 "
-  (cog-logger-warn-of-logger logger (apply format #f msg args)))
+  (if (cog-logger-warn-enabled-of-logger? logger)
+    (cog-logger-warn-of-logger logger (apply format #f msg args))))
 
 (define (cog-logger-info . args)
 "
@@ -321,9 +325,11 @@
 "
  cog-logger-info LOGGER MSG ARGS
     Print MSG into the log file, at the \"info\" logging level.
-    The MSG can be in any ice-9 printing format.
+    The MSG can be in any ice-9 printing format. It is formatted
+    only if the \"info\" level is enabled.
 "
-  (cog-logger-info-of-logger logger (apply format #f msg args)))
+  (if (cog-logger-info-enabled-of-logger? logger)
+    (cog-logger-info-of-logger logger (apply format #f msg args))))
 
 (define (cog-logger-debug . args)
 "
@@ -338,9 +344,11 @@
 "
  cog-logger-debug LOGGER MSG ARGS
     Print MSG into the log file, at the \"debug\" logging level.
-    The MSG can be in any ice-9 printing format.
+    The MSG can be in any ice-9 printing format. It is formatted
+    only if the \"debug\" level is enabled.
 "
-  (cog-logger-debug-of-logger logger (apply format #f msg args)))
+  (if (cog-logger-debug-enabled-of-logger? logger)
+    (cog-logger-debug-of-logger logger (apply format #f msg args))))
 
 (define (cog-logger-fine . args)
 "
@@ -355,9 +363,11 @@
 "
  cog-logger-fine LOGGER MSG ARGS
     Print MSG into the log file, at the \"fine\" logging level.
-    The MSG can be in any ice-9 printing format.
+    The MSG can be in any ice-9 printing format. It is formatted
+    only if the \"fine\" level is enabled.
 "
-  (cog-logger-fine-of-logger logger (apply format #f msg args)))
+  (if (cog-logger-fine-enabled-of-logger? logger)
+    (cog-logger-fine-of-logger logger (apply format #f msg args))))
 
 (define (cog-logger-flush . args)
 "
@@ -11,7 +11,7 @@
 	(string-append opencog-ext-path-persist-file "libpersist-file")
 	"opencog_persist_file_init")
 
-(export load-file)
+(export load-file compact-file dump-file compress-snapshot)
 
 (set-procedure-property! load-file 'documentation
 "
@@ -20,4 +20,46 @@
     Throws error if FILE does not exist.
 ")
 
+(set-procedure-property! compact-file 'documentation
+"
+ compact-file FSN -- Rewrite the file of the FileStorageNode FSN.
+
+    The file of a FileStorageNode is a journal: Values stored more
+    than once appear more than once, and Atoms deleted are recorded
+    as deletions. This rewrites it, keeping only the latest Value for
+    each key, and leaving out the Atoms that were deleted. Loading
+    the file gives the same AtomSpace as before, only faster.
+
+    FSN may be open or closed; if open, it can still be written to
+    while the file is being compacted.
+")
+
+(define* (dump-file FILE #:optional (CODEC "zstd") (LEVEL 0) (TRAIN #f))
+"
+ dump-file FILE [CODEC [LEVEL [TRAIN]]]
+
+    Write the current AtomSpace to FILE, as s-expressions, compressed
+    in blocks that can each be decompressed on their own. CODEC is
+    \"zstd\" (the default), \"zlib\" or \"none\"; LEVEL is the
+    compression level, zero meaning the codec's default. If TRAIN is
+    #t, a dictionary is trained on a sample of the Atoms, and stored in
+    the file.
+
+    `load-file` reads the file back, decompressing and loading the
+    blocks in parallel. A FileStorageNode cannot be opened on it.
+    Throws error if the codec was not available when this was built.
+")
+	(dump-file-blocks FILE CODEC LEVEL TRAIN))
+
+(define* (compress-snapshot SNAP #:optional (CODEC "zstd") (LEVEL 0))
+"
+ compress-snapshot SNAP [CODEC [LEVEL]]
+
+    Compress the snapshots that the SnapshotStorageNode SNAP stores
+    from now on. CODEC is \"zstd\" (the default), \"zlib\" or
+    \"none\", which turns compression off again. Compressed snapshots
+    are loaded the same way as the others.
+")
+	(compress-snapshot-blocks SNAP CODEC LEVEL))
+
 ; --------------------------------------------------------------------
@@ -9,8 +9,10 @@
 (use-modules (opencog as-config))
 (load-extension (string-append opencog-ext-path-persist-sql "libpersist-sql") "opencog_persist_sql_init")
 
-(export sql-clear-cache sql-clear-stats sql-close sql-create sql-open
-	sql-stats sql-set-hilo-watermarks! sql-set-stall-writers!)
+(export sql-clear-cache sql-clear-stats sql-close sql-create sql-metrics
+	sql-open sql-stats sql-set-hilo-watermarks! sql-set-stall-writers!
+	sql-set-write-back! sql-set-fetch-size! sql-set-working-set!
+	sql-set-conn-pool!)
 
 (set-procedure-property! sql-clear-cache 'documentation
 "
@@ -29,6 +31,23 @@
     be accumulated.
 ")
 
+(set-procedure-property! sql-metrics 'documentation
+"
+ sql-metrics - performance metrics, in the Prometheus text format.
+    Returns a string with the latencies of the SQL backend operations
+    (median, 90th, 99th and 99.9th percentile, total and count), the
+    depth of the write queue, how many database connections are in
+    use, and the hit ratios of the caches. Serve it to a Prometheus
+    scraper, to watch for, and alert on, a slow or overloaded backend.
+
+    The same numbers, less the extra percentiles, are also placed on
+    the PostgresStorageNode itself, as a FloatValue at the key
+    (Predicate \"*-metrics-*\"); their names are a StringValue at
+    (Predicate \"*-metric-names-*\"). These are refreshed whenever
+    this, or `monitor-storage`, is called. The counts go back to
+    zero with `sql-clear-stats`.
+")
+
 (set-procedure-property! sql-close 'documentation
 "
  sql-close - close the currently open SQL backend.
@@ -101,6 +120,58 @@
     at least the low-watermark pending writes in them.
 ")
 
+(set-procedure-property! sql-set-write-back! 'documentation
+"
+ sql-set-write-back! MAX-DIRTY MSEC - Hold back Value stores, so that
+    repeated stores of the same Value on the same Atom are coalesced.
+    A stored Value is written MSEC milliseconds after the first store,
+    or sooner, once MAX-DIRTY distinct (Atom, key) pairs are waiting;
+    the Value written is the one current at that time. Many are
+    written with each SQL statement. A MAX-DIRTY of zero turns this
+    off, which is the default. `barrier` writes out everything held
+    back. See `sn-monitor` for the counts of dirty and coalesced stores.
+
+    Example:
+       (sql-set-write-back! 100000 500)
+")
+
+(set-procedure-property! sql-set-fetch-size! 'documentation
+"
+ sql-set-fetch-size! N - Fetch at most N rows per query, when loading
+    the whole AtomSpace, or all Atoms of a type. Larger loads are done
+    a page at a time, so that client memory stays bounded, no matter
+    how big the database. The default is 10000.
+")
+
+(set-procedure-property! sql-set-conn-pool! 'documentation
+"
+ sql-set-conn-pool! MIN MAX MSEC SECS - Bound the connection pool.
+    Keep between MIN and MAX connections open to the database. When
+    a request has waited MSEC milliseconds for a free connection, and
+    there are fewer than MAX, a new one is opened for it. Connections
+    that have been idle for SECS seconds are closed, down to MIN.
+    The defaults are 14, 28, 50 and 60. MAX is never less than the
+    number of loader threads plus one, as each loader may hold two
+    connections at once.
+
+    The time spent waiting for connections is reported by
+    `sql-stats` and `sql-metrics`; if it is high, raise MAX, unless
+    the database server is itself the bottleneck.
+")
+
+(set-procedure-property! sql-set-working-set! 'documentation
+"
+ sql-set-working-set! N - Keep at most N of the Atoms fetched on
+    demand in the AtomSpace. When there are more, the least recently
+    fetched ones that are not in use are extracted; they are fetched
+    again, from the database, when next asked for. An Atom is in use
+    if some Link in the AtomSpace contains it, or if anyone holds on
+    to it. Values held in the write-back cache are written out first;
+    Values that were changed but never stored are lost. Atoms loaded
+    with `load-atomspace` or `load-atoms-of-type` are not counted.
+    An N of zero means no limit, which is the default.
+")
+
 (set-procedure-property! sql-stats 'documentation
 "
  sql-stats - report performance statistics.
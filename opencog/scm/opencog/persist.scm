@@ -26,13 +26,23 @@
 	fetch-query
 	store-atom
 	store-value
+	fetch-atoms
+	fetch-values
+	fetch-incoming-sets
+	fetch-atoms-async
+	fetch-incoming-sets-async
+	store-atoms
 	load-atoms-of-type
 	cog-delete!
 	cog-delete-recursive!
 	barrier
+	set-prefetch!
+	prefetch-barrier
 	monitor-storage
+	rebalance-shards
 	load-atomspace
 	store-atomspace
+	sync-storage
 	load-frames)
 
 ;; -----------------------------------------------------
@@ -178,7 +188,7 @@
       `fetch-incoming-set` to fetch all of the incoming set.
       `fetch-query` to fetch a query-defined collection of Atoms.
 "
-	(if STORAGE (sn-fetch-incoming-by-type TYPE STORAGE)
+	(if STORAGE (sn-fetch-incoming-by-type ATOM TYPE STORAGE)
 		(dflt-fetch-incoming-by-type ATOM TYPE))
 )
 
@@ -218,6 +228,133 @@
 	(if STORAGE (sn-store-value ATOM KEY STORAGE) (dflt-store-value ATOM KEY))
 )
 
+(define*-public (fetch-atoms ATOM-LIST #:optional (STORAGE #f))
+"
+ fetch-atoms ATOM-LIST [STORAGE]
+
+    Fetch all of the Values on each of the Atoms in ATOM-LIST from
+    storage, as `fetch-atom` does for one. The whole list is handed
+    to storage at once; backends that can do so will fetch it in
+    fewer round-trips. Returns the list of Atoms.
+
+    If the optional STORAGE argument is provided, then it will be
+    used as the source of the fetch. It must be a StorageNode.
+
+    See also:
+       `fetch-atom` to fetch just one Atom.
+       `store-atoms` to store a list of Atoms.
+"
+	(if STORAGE (sn-fetch-atoms ATOM-LIST STORAGE)
+		(dflt-fetch-atoms ATOM-LIST))
+)
+
+(define*-public (fetch-values ATOM-LIST KEY #:optional (STORAGE #f))
+"
+ fetch-values ATOM-LIST KEY [STORAGE]
+
+    Fetch the Value located at KEY on each of the Atoms in ATOM-LIST,
+    as `fetch-value` does for one. Returns the list of Atoms.
+
+    If the optional STORAGE argument is provided, then it will be
+    used as the source of the fetch. It must be a StorageNode.
+
+    See also:
+       `fetch-value` to fetch the Value on just one Atom.
+       `fetch-atoms` to fetch all Values on a list of Atoms.
+"
+	(if STORAGE (sn-fetch-values ATOM-LIST KEY STORAGE)
+		(dflt-fetch-values ATOM-LIST KEY))
+)
+
+(define*-public (fetch-incoming-sets ATOM-LIST #:optional (STORAGE #f))
+"
+ fetch-incoming-sets ATOM-LIST [STORAGE]
+
+    Fetch the incoming sets of each of the Atoms in ATOM-LIST, as
+    `fetch-incoming-set` does for one. The fetch is NOT recursive.
+    Atoms not in the AtomSpace are skipped; the list of those that
+    are is returned.
+
+    If the optional STORAGE argument is provided, then it will be
+    used as the source of the fetch. It must be a StorageNode.
+
+    See also:
+      `fetch-incoming-set` to fetch the incoming set of one Atom.
+      `load-referrers` to get every graph that contains an Atom.
+"
+	(if STORAGE (sn-fetch-incoming-sets ATOM-LIST STORAGE)
+		(dflt-fetch-incoming-sets ATOM-LIST))
+)
+
+(define*-public (fetch-atoms-async ATOM-LIST #:optional (STORAGE #f))
+"
+ fetch-atoms-async ATOM-LIST [STORAGE]
+
+    Start fetching all of the Values on the Atoms in ATOM-LIST, as
+    `fetch-atoms` does, but return at once, without waiting. Returns
+    a QueueValue; the Atoms are placed on it once they have been
+    fetched, and it is closed when the fetch is done. Asking for the
+    contents of the queue waits until then.
+
+    Many fetches, from many StorageNodes, can be started this way,
+    and all of them waited on afterwards.
+
+    If the optional STORAGE argument is provided, then it will be
+    used as the source of the fetch. It must be a StorageNode.
+
+    Example:
+       (define qa (fetch-atoms-async (list (Concept \"a\")) sto-a))
+       (define qb (fetch-atoms-async (list (Concept \"b\")) sto-b))
+       (cog-value->list qa)
+       (cog-value->list qb)
+
+    See also:
+       `fetch-atoms` to fetch a list of Atoms, and wait for them.
+       `fetch-incoming-sets-async` to fetch incoming sets this way.
+"
+	(if STORAGE (sn-fetch-atoms-async ATOM-LIST STORAGE)
+		(dflt-fetch-atoms-async ATOM-LIST))
+)
+
+(define*-public (fetch-incoming-sets-async ATOM-LIST #:optional (STORAGE #f))
+"
+ fetch-incoming-sets-async ATOM-LIST [STORAGE]
+
+    Start fetching the incoming sets of the Atoms in ATOM-LIST, as
+    `fetch-incoming-sets` does, but return at once, without waiting.
+    Returns a QueueValue, which is closed once the fetch is done; it
+    holds those Atoms of ATOM-LIST that are in the AtomSpace.
+
+    If the optional STORAGE argument is provided, then it will be
+    used as the source of the fetch. It must be a StorageNode.
+
+    See also:
+       `fetch-incoming-sets` to fetch incoming sets, and wait for them.
+       `fetch-atoms-async` to fetch Atoms this way.
+"
+	(if STORAGE (sn-fetch-incoming-sets-async ATOM-LIST STORAGE)
+		(dflt-fetch-incoming-sets-async ATOM-LIST))
+)
+
+(define*-public (store-atoms ATOM-LIST #:optional (STORAGE #f))
+"
+ store-atoms ATOM-LIST [STORAGE]
+
+    Store each of the Atoms in ATOM-LIST, and all of their keys and
+    values, as `store-atom` does for one. The whole list is handed
+    to storage at once. Returns the list of Atoms.
+
+    If the optional STORAGE argument is provided, then it will be
+    used as the target of the store. It must be a StorageNode.
+
+    See also:
+       `store-atom` to store just one Atom.
+       `fetch-atoms` to fetch a list of Atoms.
+"
+	(if STORAGE (sn-store-atoms ATOM-LIST STORAGE)
+		(dflt-store-atoms ATOM-LIST))
+)
+
 (define*-public (load-atoms-of-type TYPE #:optional (STORAGE #f))
 "
  load-atoms-of-type TYPE [STORAGE]
@@ -253,6 +390,55 @@
 	(if STORAGE (sn-barrier STORAGE) (dflt-barrier))
 )
 
+(define*-public (set-prefetch! OUTGOING HOPS
+	#:optional (TYPE 'Atom) (KEYS '()) (STORAGE #f))
+"
+ set-prefetch! OUTGOING HOPS [TYPE [KEYS [STORAGE]]]
+
+    Fetch ahead of a graph walk. After this, each `fetch-atom`,
+    `fetch-atoms`, `fetch-incoming-set`, `fetch-incoming-sets` and
+    `fetch-incoming-by-type` also starts fetching, in the background,
+    what the walk is likely to ask for next:
+
+    -- If OUTGOING is #t, the outgoing closure of every link brought
+       in, with the Values on it.
+    -- If HOPS is more than zero, the incoming sets of the Atoms
+       brought in, and of their neighbors, out to HOPS hops. Only
+       links of TYPE are fetched; the default, 'Atom, fetches all of
+       them.
+    -- The Values at each key in the list KEYS, on every Atom brought
+       in.
+
+    Each Atom is prefetched for only once. `(set-prefetch! #f 0)`
+    turns prefetching off.
+
+    If the optional STORAGE argument is provided, then the policy is
+    set on it. It must be a StorageNode.
+
+    Example:
+       ; Walking EvaluationLinks, 2 hops ahead, with their counts.
+       (set-prefetch! #f 2 'EvaluationLink (list (Predicate \"count\")))
+
+    See also:
+       `prefetch-barrier` to wait for the prefetches to finish.
+"
+	(if STORAGE (sn-set-prefetch OUTGOING HOPS TYPE KEYS STORAGE)
+		(dflt-set-prefetch OUTGOING HOPS TYPE KEYS))
+)
+
+(define*-public (prefetch-barrier #:optional (STORAGE #f))
+"
+ prefetch-barrier [STORAGE]
+
+    Block until every prefetch started so far has been done. See
+    `set-prefetch!`.
+
+    If the optional STORAGE argument is provided, then it is the one
+    waited on. It must be a StorageNode.
+"
+	(if STORAGE (sn-prefetch-barrier STORAGE) (dflt-prefetch-barrier))
+)
+
 (define*-public (monitor-storage #:optional (STORAGE #f))
 "
  monitor-storage [STORAGE]
@@ -273,6 +459,31 @@
 	(if STORAGE (sn-monitor STORAGE) (dflt-monitor))
 )
 
+(define*-public (rebalance-shards STORAGE #:optional (RETIRED '()))
+"
+ rebalance-shards STORAGE [RETIRED]
+
+    Move the Atoms held by the ShardStorageNode STORAGE to their homes
+    under its current list of shards, and record the new shard map.
+    Use this after adding shards to the list, or reordering it. The
+    optional RETIRED is a list of StorageNodes that used to be shards,
+    and are no longer; everything in them is moved out.
+
+    STORAGE must not be open; it is open when this returns.
+
+    Example:
+       (define ssn (ShardStorageNode \"shards\"))
+       (cog-set-value! ssn (Predicate \"*-shard-parts-*\")
+          (List (FileStorageNode \"/tmp/s0\") (FileStorageNode \"/tmp/s1\")))
+       (rebalance-shards ssn)
+
+    See also:
+       `cog-open` to open a connection.
+       `monitor-storage` to see the list of shards.
+"
+	(sn-rebalance STORAGE RETIRED)
+)
+
 (define*-public (load-atomspace #:optional (STORAGE #f))
 "
  load-atomspace [STORAGE] - load all atoms from storage.
@@ -320,6 +531,32 @@
 	(if STORAGE (sn-store-atomspace STORAGE) (dflt-store-atomspace))
 )
 
+(define*-public (sync-storage #:optional (STORAGE #f))
+"
+ sync-storage [STORAGE] - Store what changed since the last sync.
+
+    The first time, this stores the entire AtomSpace, exactly as
+    `store-atomspace` does, and starts keeping a log of changes to
+    it. After that, only the Atoms added, the Atoms deleted, and the
+    Values changed since the previous sync are written. Periodic
+    checkpoints of a large AtomSpace are cheap, when little changes
+    between them.
+
+    Atoms fetched from storage are logged as changes, too; they are
+    written back on the next sync. Only one StorageNode should be
+    synced with any given AtomSpace, as each sync empties the log.
+
+    Returns the number of Atoms and Values written or deleted.
+
+    If the optional STORAGE argument is provided, then it will be
+    used as the target of the store. It must be a StorageNode.
+
+    See also:
+    store-atomspace -- store all Atoms in the AtomSpace.
+"
+	(if STORAGE (sn-sync STORAGE) (dflt-sync))
+)
+
 (define*-public (load-frames #:optional (STORAGE #f))
 "
  load-frames [STORAGE] - load the DAG of AtomSpaces from storage.
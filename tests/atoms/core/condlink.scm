@@ -101,4 +101,26 @@
 (define put-10 (Put (DefinedSchema "rep") (List (Number 1) (Number 0))))
 (define put-11 (Put (DefinedSchema "rep") (List (Number 1) (Number 1))))
 
+;; ---------------------------------
+;; Branches that are not taken must never be run.
+
+(define ncalls 0)
+(define (count-call x) (set! ncalls (+ 1 ncalls)) x)
+
+(Inheritance (Concept "lazy-a") (Concept "lazy"))
+
+(define lazy-query
+	(Query (Variable "$x")
+		(Inheritance (Variable "$x") (Concept "lazy"))
+		(List
+			(Cond
+				(Equal (Variable "$x") (Concept "lazy-a"))
+				(Concept "taken")
+				(ExecutionOutput (GroundedSchema "scm: count-call")
+					(List (Variable "$x"))))
+			(SequentialAnd
+				(Equal (Variable "$x") (Concept "lazy-b"))
+				(True (ExecutionOutput (GroundedSchema "scm: count-call")
+					(List (Variable "$x"))))))))
+
 *unspecified*
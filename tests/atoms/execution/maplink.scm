@@ -241,6 +241,13 @@
 		))
 )
 
+;; Same as above, run in four threads.
+(define imply-map-threaded
+	(MapLink
+		(cog-outgoing-atom imply-map 0)
+		(cog-outgoing-atom imply-map 1)
+		(Number 4)))
+
 (define imply-expected
 	(SetLink
 		(EvaluationLink
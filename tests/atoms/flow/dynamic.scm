@@ -89,4 +89,14 @@
 (define fstream (FormulaStream (Plus (Number 10) (ValueOf foo akey))))
 (cog-set-value! bar bkey fstream)
 
+; -------------------------------------------------------------
+; for DynamicUTest::test_formula_cache()
+(define ncalls 0)
+(define (counted-value v) (set! ncalls (+ 1 ncalls)) (cog-execute! v))
+
+(define counted-stream
+	(FormulaStream
+		(ExecutionOutput (PureSchema "scm: counted-value")
+			(List (ValueOf foo akey)))))
+
 ; ------- THE END -------
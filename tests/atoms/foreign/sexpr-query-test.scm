@@ -44,6 +44,14 @@
 (test-assert "list query" (equal? 4
 	(length (cog-value->list (cog-execute! qry-list)))))
 
+; Nested lists, with odd spacing, parse to the same tree as when
+; built by hand.
+(test-assert "nested parse" (equal?
+	(SexprAst "  (a\t((b c)  d)\n(e) )  ")
+	(SexprAst (SexprAst 'a)
+		(SexprAst (SexprAst (SexprAst 'b) (SexprAst 'c)) (SexprAst 'd))
+		(SexprAst (SexprAst 'e)))))
+
 (test-end tname)
 
 (opencog-test-end)
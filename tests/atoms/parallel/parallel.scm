@@ -40,6 +40,19 @@
 				(GroundedPredicate "scm:incr") (List)))
 	))
 
+; The first true answer wins; the slow one is not waited for.
+(define race
+	(ThreadJoin (Number 1)
+		(True (Sleep (Number 1)))
+		(True (Sleep (Number 3)))))
+
+; All three must be true; the early false settles it.
+(define race-lost
+	(ThreadJoin (Number 3)
+		(False (Sleep (Number 1)))
+		(True (Sleep (Number 3)))
+		(True (Sleep (Number 3)))))
+
 ; throw exception
 (define pllel-bad
 	(Parallel (SequentialAnd
@@ -1,3 +1,4 @@
+import array
 from unittest import TestCase
 
 import opencog.atomspace
@@ -81,6 +82,28 @@ class AtomSpaceTest(TestCase):
             caught = True
         self.assertEquals(caught, True)
 
+    def test_add_atoms(self):
+        a = ConceptNode("a")
+        atoms = self.space.add_atoms(
+            [(types.ConceptNode, "b"), (types.ConceptNode, "c")],
+            [(types.ListLink, [0, 1]), (types.ListLink, [a, 2])])
+        self.assertEqual(4, len(atoms))
+        self.assertEqual(ConceptNode("b"), atoms[0])
+        self.assertEqual(ListLink(ConceptNode("b"), ConceptNode("c")),
+                         atoms[2])
+        self.assertEqual(ListLink(a, atoms[2]), atoms[3])
+        self.assertTrue(self.space.is_valid(atoms[3]))
+
+        # Duplicates, and atoms already there, come back as the same atom.
+        again = self.space.add_atoms([(types.ConceptNode, "a")] * 2)
+        self.assertEqual([a, a], again)
+
+        lv = self.space.add_atoms([(types.ConceptNode, "d")], as_value=True)
+        self.assertEqual(LinkValue([ConceptNode("d")]), lv)
+
+        self.assertRaises(IndexError, self.space.add_atoms,
+                          [(types.ConceptNode, "e")], [(types.ListLink, [1])])
+
     def test_is_valid(self):
         a1 = Node("test1")
         # check with Atom object
@@ -361,3 +384,36 @@ class TypeTest(TestCase):
         # XXX FIXME is testing the name of the bottom type
         # a sane thing to do?
         self.assertEqual(get_type_name(types.NO_TYPE), "*** Bottom Type! ***")
+
+    def test_export_import_values(self):
+        key = PredicateNode("key")
+        a = ConceptNode("a")
+        b = ConceptNode("b")
+        c = ConceptNode("c")
+        a.set_value(key, FloatValue([1.0, 2.0]))
+        c.set_value(key, FloatValue([3.0]))
+
+        atoms, ids, values, width = self.space.export_values(key, [a, b, c])
+        self.assertEqual(atoms, [a, b, c])
+        self.assertEqual(len(ids), 3)
+        self.assertEqual(width, 2)
+        self.assertEqual(values[0:2].tolist(), [1.0, 2.0])
+        self.assertTrue(values[2] != values[2])
+        self.assertEqual(values[4], 3.0)
+        self.assertTrue(values[5] != values[5])
+
+        atoms, ids, values, width = \
+            self.space.export_values(key, types.ConceptNode)
+        self.assertEqual(len(atoms), 3)
+
+        self.space.import_values(key, [a, b], array.array('d', [5, 6, 7, 8]))
+        self.assertEqual(a.get_value(key).to_list(), [5.0, 6.0])
+        self.assertEqual(b.get_value(key).to_list(), [7.0, 8.0])
+        self.assertRaises(ValueError, self.space.import_values, key, [a, b],
+                          array.array('d', [1, 2, 3]))
+
+        tvkey = PredicateNode("*-TruthValueKey-*")
+        self.space.import_values(tvkey, [c], array.array('d', [0.25, 0.5]),
+                                 types.SimpleTruthValue)
+        self.assertEqual(c.tv.mean, 0.25)
+        self.assertEqual(c.tv.confidence, 0.5)
@@ -60,6 +60,16 @@ class DoExecuteTest(unittest.TestCase):
             [test_as.add_node(types.ConceptNode, "cat"),
             test_as.add_node(types.ConceptNode, "animal")]))
 
+    def test_redefined_grounded_schema_node(self):
+        """the function is looked up once, but redefining it is seen"""
+        link = ExecutionOutputLink(
+                   GroundedSchemaNode("py:pick_one"),
+                   ListLink(ConceptNode("a"), ConceptNode("b")))
+        self.assertEqual(ConceptNode("a"), execute_atom(self.atomspace, link))
+        __main__.pick_one = lambda x, y: y
+        self.assertEqual(ConceptNode("b"), execute_atom(self.atomspace, link))
+        __main__.pick_one = pick_one
+
     def test_threaded(self):
         """push default atomspace in different thread and check the behaviour"""
         test_as = AtomSpace()
@@ -85,8 +95,13 @@ def add_new_link():
     return InheritanceLink(ConceptNode("cat"), ConceptNode("animal"))
 
 
+def pick_one(x, y):
+    return x
+
+
 import __main__
 __main__.add_new_link = add_new_link
+__main__.pick_one = pick_one
 
 
 if __name__ == '__main__':
@@ -1,3 +1,4 @@
+import array
 import unittest
 
 from opencog.type_constructors import *
@@ -41,6 +42,20 @@ class FloatValueTest(unittest.TestCase):
         value = FloatValue([1.0, 2.0, 3.0])
         self.assertEqual([1.0, 2.0, 3.0], value.to_list())
 
+    def test_buffer_view(self):
+        value = FloatValue([1.0, 2.0, 3.0])
+        view = memoryview(value)
+        self.assertTrue(view.readonly)
+        self.assertEqual('d', view.format)
+        self.assertEqual((3,), view.shape)
+        self.assertEqual([1.0, 2.0, 3.0], view.tolist())
+
+    def test_create_from_buffer(self):
+        data = array.array('d', [0.5, 1.5, 2.5])
+        self.assertEqual(FloatValue([0.5, 1.5, 2.5]), FloatValue(data))
+        self.assertEqual(FloatValue([0.5, 1.5, 2.5]),
+                         FloatValue(memoryview(FloatValue(data))))
+
     def test_str(self):
         value = FloatValue(1.234)
         self.assertEqual('(FloatValue 1.234)', str(value))
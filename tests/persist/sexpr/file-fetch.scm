@@ -0,0 +1,111 @@
+;
+; file-fetch.scm -- Unit test for fetching single Atoms from a
+; FileStorageNode.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+
+; ---------------------------------------------------------------------
+; Create a unique file name.
+(set! *random-state* (random-state-from-platform))
+(define fname (format #f "/tmp/opencog-fetch-~D.scm" (random 1000000000)))
+
+(format #t "Using file ~A\n" fname)
+
+; Forget everything about these, without clearing away the
+; StorageNode itself.
+(define (forget)
+	(for-each cog-extract-recursive!
+		(list (Concept "a") (Concept "b") (Concept "c") (Concept "d")
+			(Concept "e") (Predicate "p"))))
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "fetch_from_file")
+(test-begin tname)
+
+; Populate the file, and forget everything.
+(define wfsn (FileStorageNode fname))
+(cog-open wfsn)
+
+(cog-set-value! (Concept "a") (Predicate "num") (FloatValue 1 2 3))
+(store-atom (Concept "a") wfsn)
+(cog-set-value! (Concept "a") (Predicate "num") (FloatValue 4 5 6))
+(store-value (Concept "a") (Predicate "num") wfsn)
+
+(define lab (List (Concept "a") (Concept "b")))
+(cog-set-value! lab (Predicate "str") (StringValue "x" "y"))
+(store-atom lab wfsn)
+(store-atom (Evaluation (Predicate "p") (Concept "a")) wfsn)
+(store-atom (List (Concept "a") (Concept "c")) wfsn)
+(cog-delete! (List (Concept "a") (Concept "c")) wfsn)
+(store-atom (Concept "d") wfsn)
+(cog-close wfsn)
+
+(cog-atomspace-clear)
+
+; Fetch from a freshly opened node; the saved index is used.
+(test-assert "Index saved" (file-exists? (string-append fname ".idx")))
+
+(define rfsn (FileStorageNode fname))
+(cog-open rfsn)
+
+(fetch-atom (Concept "a") rfsn)
+(test-assert "Latest value"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 4 5 6)))
+
+; Only what was asked for was fetched.
+(test-assert "Nothing else" (not (cog-link 'List (Concept "a") (Concept "b"))))
+
+(fetch-incoming-set (Concept "a") rfsn)
+(define flab (cog-link 'List (Concept "a") (Concept "b")))
+(test-assert "Incoming fetched" flab)
+(test-assert "Incoming values"
+	(equal? (cog-value flab (Predicate "str")) (StringValue "x" "y")))
+(test-assert "Removed stays removed"
+	(not (cog-link 'List (Concept "a") (Concept "c"))))
+(test-assert "Other type too"
+	(cog-link 'Evaluation (Predicate "p") (Concept "a")))
+
+(forget)
+(fetch-incoming-by-type (Concept "a") 'EvaluationLink rfsn)
+(test-assert "By type"
+	(cog-link 'Evaluation (Predicate "p") (Concept "a")))
+(test-assert "Not other types"
+	(not (cog-link 'List (Concept "a") (Concept "b"))))
+
+(forget)
+(load-atoms-of-type 'ConceptNode rfsn)
+(test-assert "Concept d" (cog-node 'Concept "d"))
+(test-assert "Concept a values"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 4 5 6)))
+
+; Atoms stored while open can be fetched right away.
+(cog-set-value! (Concept "e") (Predicate "num") (FloatValue 7))
+(store-atom (Concept "e") rfsn)
+(forget)
+(fetch-atom (Concept "e") rfsn)
+(test-assert "Fetch after store"
+	(equal? (cog-value (Concept "e") (Predicate "num")) (FloatValue 7)))
+
+; Fetches that do not wait.
+(forget)
+(define qa (fetch-atoms-async (list (Concept "a") (Concept "e")) rfsn))
+(define qi (fetch-incoming-sets-async (list (Concept "a")) rfsn))
+(test-assert "Async atoms"
+	(equal? (cog-value->list qa) (list (Concept "a") (Concept "e"))))
+(test-assert "Async incoming" (equal? (cog-value->list qi) (list (Concept "a"))))
+(test-assert "Async value"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 4 5 6)))
+(test-assert "Async incoming fetched"
+	(cog-link 'List (Concept "a") (Concept "b")))
+(cog-close rfsn)
+
+; --------------------------
+; Clean up.
+(delete-file fname)
+(delete-file (string-append fname ".idx"))
+
+(test-end tname)
+
+(opencog-test-end)
@@ -0,0 +1,93 @@
+;
+; file-journal.scm -- Unit test for FileStorageNode journal compaction.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+(use-modules (ice-9 rdelim))
+
+; ---------------------------------------------------------------------
+; Create a unique file name.
+(set! *random-state* (random-state-from-platform))
+(define fname (format #f "/tmp/opencog-journal-~D.scm" (random 1000000000)))
+
+(format #t "Using file ~A\n" fname)
+
+(define (count-lines)
+	(with-input-from-file fname
+		(lambda ()
+			(let loop ((n 0))
+				(if (eof-object? (read-line)) n (loop (+ n 1)))))))
+
+(define (reload)
+	(cog-atomspace-clear)
+	(let ((rfsn (FileStorageNode fname)))
+		(cog-open rfsn)
+		(load-atomspace rfsn)
+		(cog-close rfsn)))
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "journal_compaction")
+(test-begin tname)
+
+(define wfsn (FileStorageNode fname))
+(cog-open wfsn)
+
+; Journal many updates of one Value, waiting for each to be written.
+(define a (Concept "a"))
+(define b (Concept "b"))
+(for-each
+	(lambda (i)
+		(cog-set-value! a (Predicate "num") (FloatValue i))
+		(store-value a (Predicate "num") wfsn)
+		(barrier wfsn))
+	(iota 20))
+
+; Store an Atom, and then delete it.
+(cog-set-value! b (Predicate "num") (FloatValue 42))
+(store-atom b wfsn)
+(barrier wfsn)
+(cog-delete! b wfsn)
+(barrier wfsn)
+
+(test-assert "Journal length" (equal? 22 (count-lines)))
+
+; Compact while still open; then keep on writing.
+; What's left is Concept "a", with its Value, and the key.
+(compact-file wfsn)
+(define compacted (count-lines))
+(test-assert "Compacted length" (< compacted 4))
+
+(cog-set-value! a (Predicate "str") (StringValue "after"))
+(store-value a (Predicate "str") wfsn)
+(cog-close wfsn)
+
+(test-assert "Journal tail" (equal? (+ 1 compacted) (count-lines)))
+
+(reload)
+(define ra (Concept "a"))
+(test-assert "Latest num"
+	(equal? (cog-value ra (Predicate "num")) (FloatValue 19)))
+(test-assert "Tail str"
+	(equal? (cog-value ra (Predicate "str")) (StringValue "after")))
+(test-assert "Deleted" (not (cog-node 'Concept "b")))
+
+; Compact the closed file; nothing changes on reload.
+(compact-file (FileStorageNode fname))
+(test-assert "Offline length" (< (count-lines) 5))
+
+(reload)
+(define oa (Concept "a"))
+(test-assert "Offline num"
+	(equal? (cog-value oa (Predicate "num")) (FloatValue 19)))
+(test-assert "Offline str"
+	(equal? (cog-value oa (Predicate "str")) (StringValue "after")))
+(test-assert "Still deleted" (not (cog-node 'Concept "b")))
+
+; --------------------------
+; Clean up.
+(delete-file fname)
+
+(test-end tname)
+
+(opencog-test-end)
@@ -0,0 +1,78 @@
+;
+; file-prefetch.scm -- Unit test for prefetching from a
+; FileStorageNode.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+
+; ---------------------------------------------------------------------
+; Create a unique file name.
+(set! *random-state* (random-state-from-platform))
+(define fname (format #f "/tmp/opencog-prefetch-~D.scm" (random 1000000000)))
+
+(format #t "Using file ~A\n" fname)
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "prefetch_from_file")
+(test-begin tname)
+
+; A chain a - b - c - d, with Values along it.
+(define wfsn (FileStorageNode fname))
+(cog-open wfsn)
+
+(cog-set-value! (Concept "a") (Predicate "num") (FloatValue 1))
+(cog-set-value! (Concept "c") (Predicate "num") (FloatValue 3))
+(store-atom (Evaluation (Predicate "p") (List (Concept "a") (Concept "b"))) wfsn)
+(store-atom (List (Concept "b") (Concept "c")) wfsn)
+(store-atom (List (Concept "c") (Concept "d")) wfsn)
+(store-atom (Concept "a") wfsn)
+(store-atom (Concept "c") wfsn)
+(cog-close wfsn)
+
+(cog-atomspace-clear)
+
+(define rfsn (FileStorageNode fname))
+(cog-open rfsn)
+
+; Without a policy, only what was asked for is fetched.
+(fetch-incoming-set (Concept "a") rfsn)
+(prefetch-barrier rfsn)
+(test-assert "First hop" (cog-link 'List (Concept "a") (Concept "b")))
+(test-assert "No second hop"
+	(not (cog-link 'List (Concept "b") (Concept "c"))))
+
+(cog-extract-recursive! (Concept "a"))
+(cog-extract-recursive! (Concept "b"))
+
+; Two hops out, with the Values at "num".
+(set-prefetch! #f 2 'ListLink (list (Predicate "num")) rfsn)
+(fetch-incoming-set (Concept "a") rfsn)
+(prefetch-barrier rfsn)
+(test-assert "Second hop" (cog-link 'List (Concept "b") (Concept "c")))
+(test-assert "Not a third hop"
+	(not (cog-link 'List (Concept "c") (Concept "d"))))
+(test-assert "Value two hops out"
+	(equal? (cog-value (Concept "c") (Predicate "num")) (FloatValue 3)))
+
+(cog-extract-recursive! (Concept "a"))
+
+; The outgoing closure, with its Values.
+(set-prefetch! #t 0 'Atom '() rfsn)
+(fetch-atom (Evaluation (Predicate "p") (List (Concept "a") (Concept "b")))
+	rfsn)
+(prefetch-barrier rfsn)
+(test-assert "Outgoing value"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 1)))
+
+(set-prefetch! #f 0 'Atom '() rfsn)
+(cog-close rfsn)
+
+; --------------------------
+; Clean up.
+(delete-file fname)
+(delete-file (string-append fname ".idx"))
+
+(test-end tname)
+
+(opencog-test-end)
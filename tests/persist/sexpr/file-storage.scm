@@ -43,7 +43,7 @@
 (store-value wa (Predicate "num") wfsn)
 
 ; The file write might not occur until after the `barrier` call.
-; File writes are buffered by the operating system.
+; File writes are done by a thread of their own.
 (barrier wfsn)
 
 ; Now store everything. This will appear after the writes above,
@@ -87,4 +87,59 @@
 
 (test-end tname)
 
+; ---------------------------------------------------------------------
+(define lname "last_stored_wins")
+(test-begin lname)
+
+; What gets written is the Value as it was when it was stored, and
+; not whatever the Atom holds when the writer gets to it. Of several
+; stores of the same Value, the last one wins.
+(cog-atomspace-clear)
+(define la (Concept "last"))
+(define lb (Concept "atom"))
+(cog-set-value! lb (Predicate "num") (FloatValue 1 1 1))
+
+(define lfsn (FileStorageNode fname))
+(cog-open lfsn)
+(cog-set-value! la (Predicate "num") (FloatValue 1 2 3))
+(store-value la (Predicate "num") lfsn)
+(cog-set-value! la (Predicate "num") (FloatValue 4 5 6))
+(store-value la (Predicate "num") lfsn)
+(store-atom lb lfsn)
+
+; A Value stored after the Atom is written after it, even if the
+; same Value was stored, and is still queued, from before.
+(define lc (Concept "interleaved"))
+(cog-set-value! lc (Predicate "num") (FloatValue 1 0 0))
+(store-value lc (Predicate "num") lfsn)
+(cog-set-value! lc (Predicate "num") (FloatValue 2 0 0))
+(store-atom lc lfsn)
+(cog-set-value! lc (Predicate "num") (FloatValue 3 0 0))
+(store-value lc (Predicate "num") lfsn)
+
+; Changed, but not stored again.
+(cog-set-value! la (Predicate "num") (FloatValue 7 8 9))
+(cog-set-value! lb (Predicate "num") (FloatValue 2 2 2))
+(barrier lfsn)
+(cog-close lfsn)
+
+(cog-atomspace-clear)
+
+(define rlfsn (FileStorageNode fname))
+(cog-open rlfsn)
+(load-atomspace rlfsn)
+(cog-close rlfsn)
+
+(test-assert "Last stored Value"
+	(equal? (cog-value (Concept "last") (Predicate "num")) (FloatValue 4 5 6)))
+(test-assert "Stored Atom Value"
+	(equal? (cog-value (Concept "atom") (Predicate "num")) (FloatValue 1 1 1)))
+(test-assert "Value stored after Atom"
+	(equal? (cog-value (Concept "interleaved") (Predicate "num"))
+		(FloatValue 3 0 0)))
+
+(delete-file fname)
+
+(test-end lname)
+
 (opencog-test-end)
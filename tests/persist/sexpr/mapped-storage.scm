@@ -0,0 +1,102 @@
+;
+; mapped-storage.scm -- Unit test for the MappedStorageNode
+;
+; An image is stored whole, and then used in place: single Atoms,
+; incoming sets and types are fetched from it without loading it.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+
+; ---------------------------------------------------------------------
+; Create a unique file name.
+(set! *random-state* (random-state-from-platform))
+(define fname (format #f "/tmp/opencog-test-~D.img" (random 1000000000)))
+
+(format #t "Using file ~A\n" fname)
+
+; Forget everything about these, without clearing away the
+; StorageNode itself.
+(define (forget)
+	(for-each cog-extract-recursive!
+		(list (Concept "a") (Concept "b") (Concept "c") (Concept "d")
+			(Predicate "p") (Predicate "num") (Predicate "str"))))
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "store_fetch_image")
+(test-begin tname)
+
+(cog-set-value! (Concept "a") (Predicate "num") (FloatValue 1 2 3))
+(define lab (List (Concept "a") (Concept "b")))
+(cog-set-value! lab (Predicate "str") (StringValue "x" "y"))
+(Evaluation (Predicate "p") (Concept "a"))
+(List (Concept "a") (Concept "a") (Concept "c"))
+(Concept "d")
+
+(define wmsn (MappedStorageNode fname))
+(cog-open wmsn)
+(store-atomspace wmsn)
+(cog-close wmsn)
+
+(forget)
+(test-assert "Forgotten" (not (cog-node 'Concept "d")))
+
+(define rmsn (MappedStorageNode fname))
+(cog-open rmsn)
+
+(fetch-atom (Concept "a") rmsn)
+(test-assert "Value"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 1 2 3)))
+
+; Only what was asked for was fetched.
+(test-assert "Nothing else" (not (cog-link 'List (Concept "a") (Concept "b"))))
+
+(fetch-incoming-set (Concept "a") rmsn)
+(define flab (cog-link 'List (Concept "a") (Concept "b")))
+(test-assert "Incoming fetched" flab)
+(test-assert "Incoming values"
+	(equal? (cog-value flab (Predicate "str")) (StringValue "x" "y")))
+(test-assert "Repeated Atom"
+	(cog-link 'List (Concept "a") (Concept "a") (Concept "c")))
+(test-assert "Other type too"
+	(cog-link 'Evaluation (Predicate "p") (Concept "a")))
+
+(forget)
+(fetch-incoming-by-type (Concept "a") 'EvaluationLink rmsn)
+(test-assert "By type"
+	(cog-link 'Evaluation (Predicate "p") (Concept "a")))
+(test-assert "Not other types"
+	(not (cog-link 'List (Concept "a") (Concept "b"))))
+
+(forget)
+(load-atoms-of-type 'ConceptNode rmsn)
+(test-assert "Concept d" (cog-node 'Concept "d"))
+(test-assert "Concept a values"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 1 2 3)))
+
+(forget)
+(fetch-value (Concept "a") (Predicate "num") rmsn)
+(test-assert "Single value"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 1 2 3)))
+
+; Not in the image at all.
+(fetch-incoming-set (Concept "zzz") rmsn)
+(test-assert "Absent" (equal? 0 (cog-incoming-size (Concept "zzz"))))
+
+(forget)
+(load-atomspace rmsn)
+(test-assert "Everything"
+	(cog-link 'List (Concept "a") (Concept "a") (Concept "c")))
+(test-assert "Everything values"
+	(equal? (cog-value (cog-link 'List (Concept "a") (Concept "b"))
+		(Predicate "str")) (StringValue "x" "y")))
+
+(cog-close rmsn)
+
+; --------------------------
+; Clean up.
+(delete-file fname)
+
+(test-end tname)
+
+(opencog-test-end)
@@ -0,0 +1,91 @@
+;
+; replica-storage.scm -- Unit test for the ReplicaStorageNode
+;
+; Writes are teed to two files; reads come from either one.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+
+; ---------------------------------------------------------------------
+; Create unique file names.
+(set! *random-state* (random-state-from-platform))
+(define fa (format #f "/tmp/opencog-replica-a-~D.scm" (random 1000000000)))
+(define fb (format #f "/tmp/opencog-replica-b-~D.scm" (random 1000000000)))
+
+(format #t "Using files ~A ~A\n" fa fb)
+
+(define (forget)
+	(for-each cog-extract-recursive!
+		(list (Concept "a") (Concept "b"))))
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "replica_tee")
+(test-begin tname)
+
+; Tee every write to both files.
+(define tee (ReplicaStorageNode "round-robin"))
+(cog-set-value! tee (Predicate "*-write-parts-*")
+	(List (FileStorageNode fa) (FileStorageNode fb)))
+(cog-open tee)
+(test-assert "Parts opened" (cog-connected? (FileStorageNode fa)))
+
+(cog-set-value! (Concept "a") (Predicate "num") (FloatValue 1 2 3))
+(store-atom (Concept "a") tee)
+(store-atom (List (Concept "a") (Concept "b")) tee)
+(barrier tee)
+(cog-close tee)
+(test-assert "Parts closed" (not (cog-connected? (FileStorageNode fa))))
+
+; Each file got everything.
+(for-each
+	(lambda (fname)
+		(forget)
+		(let ((fsn (FileStorageNode fname)))
+			(cog-open fsn)
+			(fetch-atom (Concept "a") fsn)
+			(fetch-incoming-set (Concept "a") fsn)
+			(cog-close fsn))
+		(test-assert (string-append "Value in " fname)
+			(equal? (cog-value (Concept "a") (Predicate "num"))
+				(FloatValue 1 2 3)))
+		(test-assert (string-append "Link in " fname)
+			(cog-link 'List (Concept "a") (Concept "b"))))
+	(list fa fb))
+
+(test-end tname)
+
+; ---------------------------------------------------------------------
+(define tname "replica_reads")
+(test-begin tname)
+
+; Reads go to the first replica that works.
+(define rep (ReplicaStorageNode "nearest-first"))
+(cog-set-value! rep (Predicate "*-write-parts-*")
+	(List (FileStorageNode fa)))
+(cog-set-value! rep (Predicate "*-read-parts-*")
+	(List (FileStorageNode fb) (FileStorageNode fa)))
+(cog-open rep)
+
+(forget)
+(fetch-atoms (list (Concept "a") (Concept "b")) rep)
+(test-assert "Fetched through replica"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 1 2 3)))
+
+(fetch-incoming-sets (list (Concept "a")) rep)
+(test-assert "Incoming through replica"
+	(cog-link 'List (Concept "a") (Concept "b")))
+(cog-close rep)
+
+; --------------------------
+; Clean up.
+(for-each
+	(lambda (f)
+		(when (file-exists? f) (delete-file f))
+		(when (file-exists? (string-append f ".idx"))
+			(delete-file (string-append f ".idx"))))
+	(list fa fb))
+
+(test-end tname)
+
+(opencog-test-end)
@@ -0,0 +1,114 @@
+;
+; shard-storage.scm -- Unit test for the ShardStorageNode
+;
+; Atoms are spread over FileStorageNodes, and found again.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+(use-modules (srfi srfi-1))
+
+; ---------------------------------------------------------------------
+; Create unique file names.
+(set! *random-state* (random-state-from-platform))
+(define base (format #f "/tmp/opencog-shard-~D" (random 1000000000)))
+(define (shard n) (FileStorageNode (format #f "~A-~D.scm" base n)))
+
+(define names (list "a" "b" "c" "d" "e" "f" "g" "h"))
+(define (forget)
+	(for-each (lambda (n) (cog-extract-recursive! (Concept n))) names))
+
+(define (make-shards . parts)
+	(define ssn (ShardStorageNode "shards"))
+	(cog-set-value! ssn (Predicate "*-shard-parts-*") (apply List parts))
+	ssn)
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "shard_store_fetch")
+(test-begin tname)
+
+(define ssn (make-shards (shard 0) (shard 1)))
+(cog-open ssn)
+(for-each
+	(lambda (n)
+		(cog-set-value! (Concept n) (Predicate "name") (StringValue n))
+		(store-atom (Concept n) ssn)
+		(store-atom (List (Concept n) (Concept "a")) ssn))
+	names)
+(cog-close ssn)
+
+; The Atoms were spread out.
+(define (count-in part)
+	(cog-atomspace-clear)
+	(cog-open part)
+	(load-atoms-of-type 'ConceptNode part)
+	(cog-close part)
+	(length (cog-get-atoms 'ConceptNode)))
+
+(define n0 (count-in (shard 0)))
+(define n1 (count-in (shard 1)))
+(format #t "Shard sizes ~A ~A\n" n0 n1)
+(test-assert "Spread" (and (< 0 n0) (< 0 n1)))
+
+; Everything is found through the shards.
+(set! ssn (make-shards (shard 0) (shard 1)))
+(cog-open ssn)
+(forget)
+(for-each (lambda (n) (fetch-atom (Concept n) ssn)) names)
+(test-assert "All values"
+	(every (lambda (n)
+		(equal? (cog-value (Concept n) (Predicate "name")) (StringValue n)))
+		names))
+
+(fetch-incoming-set (Concept "a") ssn)
+(test-equal "Scatter-gather" (length names)
+	(length (cog-incoming-by-type (Concept "a") 'ListLink)))
+(cog-close ssn)
+
+(test-end tname)
+
+; ---------------------------------------------------------------------
+(define tname "shard_rebalance")
+(test-begin tname)
+
+; A new list of shards will not open until rebalanced.
+(define bigger (make-shards (shard 0) (shard 1) (shard 2)))
+(test-assert "Map checked"
+	(catch #t (lambda () (cog-open bigger) #f) (lambda (k . a) #t)))
+
+(rebalance-shards bigger)
+(forget)
+(for-each (lambda (n) (fetch-atom (Concept n) bigger)) names)
+(test-assert "Values after rebalance"
+	(every (lambda (n)
+		(equal? (cog-value (Concept n) (Predicate "name")) (StringValue n)))
+		names))
+(fetch-incoming-set (Concept "a") bigger)
+(test-equal "Links after rebalance" (length names)
+	(length (cog-incoming-by-type (Concept "a") 'ListLink)))
+(cog-close bigger)
+
+; Shrink back down, retiring the third shard.
+(define smaller (make-shards (shard 0) (shard 1)))
+(rebalance-shards smaller (list (shard 2)))
+(forget)
+(for-each (lambda (n) (fetch-atom (Concept n) smaller)) names)
+(test-assert "Values after retiring"
+	(every (lambda (n)
+		(equal? (cog-value (Concept n) (Predicate "name")) (StringValue n)))
+		names))
+(cog-close smaller)
+
+; --------------------------
+; Clean up.
+(for-each
+	(lambda (n)
+		(define f (format #f "~A-~D.scm" base n))
+		(when (file-exists? f) (delete-file f))
+		(when (file-exists? (string-append f ".idx"))
+			(delete-file (string-append f ".idx"))))
+	(list 0 1 2))
+
+(test-end tname)
+
+(opencog-test-end)
@@ -0,0 +1,82 @@
+;
+; snapshot-storage.scm -- Unit test for the SnapshotStorageNode
+;
+; Like file-storage.scm, but whole AtomSpaces only, and binary.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+
+; ---------------------------------------------------------------------
+; Create a unique file name.
+(set! *random-state* (random-state-from-platform))
+(define fname (format #f "/tmp/opencog-test-~D.snap" (random 1000000000)))
+
+(format #t "Using file ~A\n" fname)
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "store_load_snapshot")
+(test-begin tname)
+
+; Populate the AtomSpace with some data.
+(define wa (Concept "foo"))
+(cog-set-value! wa (Predicate "num") (FloatValue 1 2 3))
+(cog-set-value! wa (Predicate "str") (StringValue "p" "q" "foo"))
+(cog-set-tv! wa (stv 0.3 0.7))
+
+(define wli (Link (Concept "foo") (Concept "bar")))
+(cog-set-value! wli (Predicate "num") (FloatValue 4 5 6))
+(cog-set-value! wli (Predicate "lnk")
+	(LinkValue (Concept "baz") (FloatValue 7 8)))
+
+(define wev (Evaluation (Predicate "deep")
+	(List (Concept "foo") (List (Concept "bar") (Number 42)))))
+(cog-set-value! wev (Predicate "int") (IntValue 1 -2 3000000000))
+
+(define natoms (length (cog-get-atoms 'Atom #t)))
+
+(define wsn (SnapshotStorageNode fname))
+(cog-open wsn)
+(store-atomspace wsn)
+(cog-close wsn)
+
+(cog-atomspace-clear)
+(test-assert "Cleared" (equal? 0 (length (cog-get-atoms 'Atom #t))))
+
+; ---------------------------------------------------------------------
+
+; Load everything from the file.
+(define rsn (SnapshotStorageNode fname))
+(cog-open rsn)
+(load-atomspace rsn)
+(cog-close rsn)
+
+; The keys come back too, as they do with the FileStorageNode.
+(test-assert "Atom count" (<= natoms (length (cog-get-atoms 'Atom #t))))
+
+(define ra (Concept "foo"))
+(test-assert "Concept Num"
+	(equal? (cog-value ra (Predicate "num")) (FloatValue 1 2 3)))
+(test-assert "Concept Str"
+	(equal? (cog-value ra (Predicate "str")) (StringValue "p" "q" "foo")))
+(test-assert "Concept TV" (equal? (cog-tv ra) (stv 0.3 0.7)))
+
+(define rli (Link (Concept "foo") (Concept "bar")))
+(test-assert "Link Num"
+	(equal? (cog-value rli (Predicate "num")) (FloatValue 4 5 6)))
+(test-assert "Link Lnk"
+	(equal? (cog-value rli (Predicate "lnk"))
+		(LinkValue (Concept "baz") (FloatValue 7 8))))
+
+(define rev (Evaluation (Predicate "deep")
+	(List (Concept "foo") (List (Concept "bar") (Number 42)))))
+(test-assert "Deep Int"
+	(equal? (cog-value rev (Predicate "int")) (IntValue 1 -2 3000000000)))
+
+; --------------------------
+; Clean up.
+(delete-file fname)
+
+(test-end tname)
+
+(opencog-test-end)
@@ -0,0 +1,78 @@
+;
+; sync-storage.scm -- Unit test for delta sync to a StorageNode.
+;
+(use-modules (opencog) (opencog persist) (opencog persist-file))
+(use-modules (opencog test-runner))
+
+; ---------------------------------------------------------------------
+; Create a unique file name.
+(set! *random-state* (random-state-from-platform))
+(define fname (format #f "/tmp/opencog-sync-~D.scm" (random 1000000000)))
+
+(format #t "Using file ~A\n" fname)
+
+(define (reload)
+	(cog-atomspace-clear)
+	(let ((rfsn (FileStorageNode fname)))
+		(cog-open rfsn)
+		(load-atomspace rfsn)
+		(cog-close rfsn)))
+
+; ---------------------------------------------------------------------
+(opencog-test-runner)
+(define tname "delta_sync")
+(test-begin tname)
+
+(define wfsn (FileStorageNode fname))
+(cog-open wfsn)
+
+(for-each (lambda (i) (Concept (format #f "bulk-~D" i))) (iota 100))
+(cog-set-value! (Concept "a") (Predicate "num") (FloatValue 1))
+(Concept "b")
+
+; The first sync writes everything.
+(test-assert "Full sync" (< 100 (sync-storage wfsn)))
+
+; Nothing changed, nothing to write.
+(test-assert "Empty sync" (equal? 0 (sync-storage wfsn)))
+
+; One Value changed, one Atom added, one deleted.
+(cog-set-value! (Concept "a") (Predicate "num") (FloatValue 2))
+(Inheritance (Concept "c") (Concept "a"))
+(cog-delete! (Concept "b"))
+(define delta (sync-storage wfsn))
+(test-assert "Delta sync" (and (<= 3 delta) (< delta 10)))
+(cog-close wfsn)
+
+(reload)
+(test-assert "Changed value"
+	(equal? (cog-value (Concept "a") (Predicate "num")) (FloatValue 2)))
+(test-assert "Added link"
+	(cog-link 'Inheritance (Concept "c") (Concept "a")))
+(test-assert "Deleted" (not (cog-node 'Concept "b")))
+(test-assert "Kept bulk" (cog-node 'Concept "bulk-42"))
+
+(delete-file fname)
+
+; ---------------------------------------------------------------------
+; Frames. Only the frame that changed gets written.
+(define fname2 (format #f "/tmp/opencog-sync-frames-~D.scm" (random 1000000000)))
+(define base-space (cog-atomspace))
+(define top-space (cog-new-atomspace base-space))
+(cog-set-atomspace! top-space)
+
+(define tfsn (FileStorageNode fname2))
+(cog-open tfsn)
+(Concept "top")
+(test-assert "Layered full sync" (< 100 (sync-storage tfsn)))
+
+(cog-set-value! (Concept "top") (Predicate "num") (FloatValue 3))
+(test-assert "Layered delta" (< (sync-storage tfsn) 5))
+(cog-close tfsn)
+
+(cog-set-atomspace! base-space)
+(delete-file fname2)
+
+(test-end tname)
+
+(opencog-test-end)
@@ -0,0 +1,35 @@
+;
+; glob-memo.scm
+;
+; Many globs in a row, over a long sequence that does not match.
+; Trying every way of splitting the sequence among the globs takes
+; exponential time; each split of the tail is hopeless no matter how
+; the head was split, and need only be tried once.
+
+(use-modules (opencog) (opencog exec))
+
+(define (xs n) (if (= 0 n) '() (cons (Concept "x") (xs (- n 1)))))
+
+(Evaluation (Predicate "seq") (List (xs 40)))
+
+(define glob-memo
+	(Get
+		(VariableList
+			(Glob "$a") (Glob "$b") (Glob "$c")
+			(Glob "$d") (Glob "$e") (Glob "$f"))
+		(Present
+			(Evaluation (Predicate "seq")
+				(List
+					(Glob "$a") (Concept "x") (Glob "$b") (Concept "x")
+					(Glob "$c") (Concept "x") (Glob "$d") (Concept "x")
+					(Glob "$e") (Concept "x") (Glob "$f") (Concept "y"))))))
+
+; The sequence is too long for the glob.
+(define glob-bounded
+	(Get
+		(TypedVariable (Glob "$a") (Interval (Number 1) (Number 3)))
+		(Present
+			(Evaluation (Predicate "seq")
+				(List (Glob "$a") (Concept "x"))))))
+
+; (cog-execute! glob-memo)
@@ -0,0 +1,39 @@
+;
+; unordered-pinned.scm
+;
+; UnorderedLinks holding many constants. Only the variables need to
+; be permuted; without that, the searches below would have to step
+; through 10! = 3628800 permutations.
+
+(use-modules (opencog) (opencog exec))
+
+(Set
+	(Concept "A") (Concept "B") (Concept "C") (Concept "D")
+	(Concept "E") (Concept "F") (Concept "G") (Concept "H")
+	(Predicate "P") (Predicate "Q"))
+
+(define pinned
+	(Bind
+		(Present (Set
+			(Concept "A") (Concept "B") (Concept "C") (Concept "D")
+			(Concept "E") (Concept "F") (Concept "G") (Concept "H")
+			(Variable "$X") (Variable "$Y")))
+		(Implication (Variable "$X") (Variable "$Y"))))
+
+; (cog-execute! pinned)
+
+(define expect-pinned
+	(Set
+		(Implication (Predicate "P") (Predicate "Q"))
+		(Implication (Predicate "Q") (Predicate "P"))))
+
+; One of the constants is missing; nothing matches.
+(define pin-missing
+	(Bind
+		(Present (Set
+			(Concept "A") (Concept "B") (Concept "C") (Concept "D")
+			(Concept "E") (Concept "F") (Concept "G") (Concept "Z")
+			(Variable "$X") (Variable "$Y")))
+		(Implication (Variable "$X") (Variable "$Y"))))
+
+; (cog-execute! pin-missing)
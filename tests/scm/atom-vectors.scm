@@ -0,0 +1,50 @@
+;
+; atom-vectors.scm
+; Check that the vector and sequence forms agree with the list forms.
+;
+(use-modules (srfi srfi-1))
+(use-modules (opencog))
+(use-modules (opencog test-runner))
+
+(opencog-test-runner)
+
+(define tname "atom-vectors")
+(test-begin tname)
+
+(define lnk (List (Concept "A") (Concept "B") (Concept "C")))
+(Inheritance (Concept "A") (Concept "D"))
+(Inheritance (Concept "A") (Concept "E"))
+
+(test-equal "outgoing vector"
+	(list->vector (cog-outgoing-set lnk)) (cog-outgoing-vector lnk))
+(test-equal "node has empty outgoing vector"
+	#() (cog-outgoing-vector (Concept "A")))
+
+(define (same-set? LA LB)
+	(lset= equal? LA LB))
+
+(test-assert "incoming vector"
+	(same-set? (cog-incoming-set (Concept "A"))
+		(vector->list (cog-incoming-vector (Concept "A")))))
+(test-equal "incoming vector size" 3
+	(vector-length (cog-incoming-vector (Concept "A"))))
+
+(test-assert "atoms vector"
+	(same-set? (cog-get-atoms 'Concept)
+		(vector->list (cog-atoms-vector 'Concept))))
+
+; The sequence is walked with cog-value-ref.
+(define seq (cog-atom-seq 'Inheritance))
+(test-equal "atom seq size" 2 (cog-value-size seq))
+(test-assert "atom seq contents"
+	(same-set? (cog-get-atoms 'Inheritance)
+		(map (lambda (i) (cog-value-ref seq i))
+			(iota (cog-value-size seq)))))
+
+(test-equal "float value size" 3 (cog-value-size (FloatValue 1 2 3)))
+(test-equal "link value size" 3 (cog-value-size lnk))
+(test-equal "node value size" 1 (cog-value-size (Concept "A")))
+
+(test-end tname)
+
+(opencog-test-end)